@@ -0,0 +1,11 @@
+#version 450
+
+layout (location = 0) in float Age;
+
+layout (location = 0) out vec4 FragColor;
+
+void main()
+{
+    // NOTE[joe] Cools from orange to grey over a particle's life.
+    FragColor = mix(vec4(1.0, 0.6, 0.1, 1.0), vec4(0.4, 0.4, 0.4, 1.0), Age);
+}
@@ -0,0 +1,57 @@
+#version 450
+
+// NOTE[joe] Has to match particle.
+struct particle
+{
+    vec3  Position;
+    float Age;
+    vec3  Velocity;
+    float Lifetime;
+};
+
+layout (std430, set = 0, binding = 0) readonly buffer Pool
+{
+    particle Particles[];
+} pool;
+
+// NOTE[joe] Both alive lists, one after the other.
+layout (std430, set = 0, binding = 2) readonly buffer Alive
+{
+    uint Indices[];
+} alive;
+
+// NOTE[joe] Has to match particle_draw_constants.
+layout (push_constant) uniform Draw
+{
+    mat4 Transform;
+    vec2 Size;
+    uint Frame;
+} draw;
+
+layout (location = 0) out float Age;
+
+// NOTE[joe] Two triangles, each counter clockwise.
+const vec2 Corners[6] = vec2[](
+    vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+    vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0)
+);
+
+void main()
+{
+    // NOTE[joe] One instance per live particle, which this frame's passes
+    // left in the list they appended to.
+    uint Next = (draw.Frame & 1u) ^ 1u;
+    uint MaxCount = uint(alive.Indices.length()) / 2u;
+
+    uint Index = alive.Indices[Next * MaxCount + uint(gl_InstanceIndex)];
+    particle Particle = pool.Particles[Index];
+
+    // NOTE[joe] Offsetting in clip space always faces the camera, and since
+    // the offset isn't scaled by w, particles shrink with distance like
+    // everything else.
+    vec4 Clip = draw.Transform * vec4(Particle.Position, 1.0);
+    Clip.xy += Corners[gl_VertexIndex] * draw.Size;
+
+    gl_Position = Clip;
+    Age = Particle.Age / Particle.Lifetime;
+}
@@ -4,7 +4,12 @@
 
 layout (location = 0) in vec4 pos;
 
+layout (push_constant) uniform Transform
+{
+    mat4 World;
+} transform;
+
 void main()
 {
-    gl_Position = pos;
+    gl_Position = transform.World * pos;
 }
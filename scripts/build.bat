@@ -17,7 +17,7 @@ if not exist data\spirv\ (
 )
 
 pushd data\spirv\
-for /F %%f in ('dir /B ..\shaders') do glslangValidator -V ..\shaders\%%f
+for /F %%f in ('dir /B ..\shaders') do glslangValidator -V ..\shaders\%%f -o %%f.spv
 popd
 
 echo Building game binary...
@@ -33,5 +33,5 @@ if %1.==release. (
 )
 
 pushd build\
-clang-cl %debug% /Zi ..\src\win32_main.cpp user32.lib /I ..\include /o fullmetaljacket.exe
+clang-cl %debug% /std:c++20 /Zi ..\src\win32_main.cpp user32.lib /I ..\include /o fullmetaljacket.exe
 popd
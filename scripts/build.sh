@@ -0,0 +1,46 @@
+#!/bin/sh
+
+#
+# @file build.sh
+# @author Joseph Miles <josephmiles2015@gmail.com>
+# @date 2026-10-18
+#
+# This is the build script for Linux, using g++ (or $CXX). Run it from the
+# project root, the same as build.bat.
+#
+
+set -e
+
+CXX=${CXX:-g++}
+
+echo Building shaders...
+
+mkdir -p data/spirv
+
+if command -v glslangValidator > /dev/null; then
+    cd data/spirv
+    # NOTE[joe] Named after the source file, since glslangValidator names
+    # them after the stage by default and we have more than one of a stage.
+    for f in ../shaders/*; do
+        glslangValidator -V "$f" -o "$(basename "$f").spv"
+    done
+    cd ../..
+else
+    echo glslangValidator not found, keeping existing shaders.
+fi
+
+echo Building game binary...
+
+mkdir -p build
+
+if [ "$1" = "release" ]; then
+    flags="-O2"
+else
+    flags="-DDEBUG -O0"
+fi
+
+# NOTE[joe] libvulkan is opened with dlopen(), so we don't link against it.
+cd build
+$CXX -std=c++20 $flags -g ../src/linux_main.cpp -I ../include \
+    -o fullmetaljacket -ldl -lxcb -lpthread
+cd ..
@@ -0,0 +1,551 @@
+/**
+ * @file anim_bench.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the animation benchmarks, and the checks that keep
+ * clip compression honest. A set of made up clips is compressed, and then
+ * every kernel the build can run samples them at every frame and between
+ * frames, against sampling the raw clips; no track may be further off than
+ * the error it recorded when it was compressed. Then each kernel is timed
+ * sampling and blending on one thread, and whole characters (a blend tree
+ * through to a skinning palette) are timed on one thread and across the job
+ * system. Platform layers run them with --bench-anim, instead of the game,
+ * and exit with an error if any track is out of bounds.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "job.h"
+#include "animation.h"
+
+#define ANIM_BENCH_JOINTS 64
+#define ANIM_BENCH_CLIPS 8
+// NOTE[joe] Four seconds, with the last frame the same as the first.
+#define ANIM_BENCH_FRAMES (4 * ANIM_SAMPLE_RATE + 1)
+#define ANIM_BENCH_CHARACTERS 1024
+#define ANIM_BENCH_SAMPLES 256
+#define ANIM_BENCH_RUNS 16
+
+// NOTE[joe] Checked four times a frame, so half of the samples fall
+// between frames.
+#define ANIM_BENCH_SUBFRAMES 4
+
+// NOTE[joe] About 0.06 degrees, a millimetre if units are metres, and a
+// hundredth of a percent.
+#define ANIM_BENCH_ROTATION_TOLERANCE 1e-3f
+#define ANIM_BENCH_TRANSLATION_TOLERANCE 1e-3f
+#define ANIM_BENCH_SCALE_TOLERANCE 1e-4f
+
+// NOTE[joe] How far past its recorded error a track may go. Tracks only
+// record their error at frames; in between, a blend of two rotations isn't
+// quite the blend of their errors. Kernels also round differently.
+#define ANIM_BENCH_SLACK 1e-4
+
+typedef struct {
+    memory_arena    Arena;
+    anim_skeleton   Skeleton;
+    anim_raw_clip   Raw[ANIM_BENCH_CLIPS];
+    anim_clip       Clips[ANIM_BENCH_CLIPS];
+    anim_pose       Reference;
+    anim_pose       Pose;
+    anim_pose       Other;
+    unsigned short *Cursors[ANIM_BENCH_CLIPS];
+    unsigned int    Random;
+} anim_bench_data;
+
+static
+float AnimBenchRandom(anim_bench_data *Data, float Low, float High)
+{
+    Data->Random ^= Data->Random << 13;
+    Data->Random ^= Data->Random >> 17;
+    Data->Random ^= Data->Random << 5;
+
+    return Low + (High - Low) * (float)(Data->Random & 0xFFFFFF) / 16777216.0f;
+}
+
+static
+vec3 AnimBenchDirection(anim_bench_data *Data)
+{
+    vec3 Direction = {
+        AnimBenchRandom(Data, -1.0f, 1.0f),
+        AnimBenchRandom(Data, -1.0f, 1.0f),
+        AnimBenchRandom(Data, 0.1f, 1.0f)
+    };
+
+    return Normalize(Direction);
+}
+
+/** A skeleton of bones 10 to 30cm long, each one hanging off one of the
+ * few joints before it, like limbs off a spine. */
+static
+void BuildAnimBenchSkeleton(anim_bench_data *Data, vec3 *Offsets)
+{
+    anim_skeleton *Skeleton = &Data->Skeleton;
+
+    InitializeSkeleton(Skeleton, &Data->Arena, ANIM_BENCH_JOINTS);
+
+    mat4 *Binds = PushArray(&Data->Arena, mat4, ANIM_BENCH_JOINTS);
+
+    for (unsigned int i = 0; i < ANIM_BENCH_JOINTS; i++)
+    {
+        Offsets[i] = { 0.0f, 0.0f, 0.0f };
+        Binds[i] = Mat4Identity();
+
+        if (i > 0)
+        {
+            unsigned int Back = 1 + (Data->Random >> 8) % (i < 4 ? i : 4);
+            Skeleton->Parents[i] = i - Back;
+
+            Offsets[i] = AnimBenchDirection(Data) *
+                         AnimBenchRandom(Data, 0.1f, 0.3f);
+
+            mat4 Local = Mat4Translation(Offsets[i]);
+            Multiply(&Binds[Skeleton->Parents[i]], &Local, &Binds[i]);
+        }
+
+        Skeleton->InverseBinds[i] = Inverse(Binds[i]);
+    }
+}
+
+/** A looping clip where most joints swing about an axis with a couple of
+ * sine waves, some hold a pose, the root bobs up and down and one joint
+ * pulses in size. */
+static
+void BuildAnimBenchClip(anim_bench_data *Data,
+                        const vec3 *Offsets,
+                        anim_raw_clip *Clip)
+{
+    InitializeRawClip(Clip,
+                      &Data->Arena,
+                      ANIM_BENCH_JOINTS,
+                      ANIM_BENCH_FRAMES);
+
+    float Length = (float)(ANIM_BENCH_FRAMES - 1);
+
+    for (unsigned int Joint = 0; Joint < ANIM_BENCH_JOINTS; Joint++)
+    {
+        vec3 Axis = AnimBenchDirection(Data);
+        bool IsHeld = Joint % 4 == 3;
+
+        // NOTE[joe] Whole numbers of cycles, so the clip loops.
+        float Cycles[2] = {
+            (float)(1 + (Data->Random >> 4) % 3),
+            (float)(2 + (Data->Random >> 12) % 4)
+        };
+        float Amplitudes[2] = {
+            AnimBenchRandom(Data, 0.1f, 0.8f),
+            AnimBenchRandom(Data, 0.0f, 0.2f)
+        };
+        float Phases[2] = {
+            AnimBenchRandom(Data, 0.0f, 2.0f * MATH_PI),
+            AnimBenchRandom(Data, 0.0f, 2.0f * MATH_PI)
+        };
+
+        for (unsigned int Frame = 0; Frame < ANIM_BENCH_FRAMES; Frame++)
+        {
+            unsigned int i = Frame * ANIM_BENCH_JOINTS + Joint;
+            float Cycle = 2.0f * MATH_PI * (float)Frame / Length;
+
+            float Angle = Amplitudes[0];
+
+            if (!IsHeld)
+            {
+                Angle = Amplitudes[0] * sinf(Cycle * Cycles[0] + Phases[0]) +
+                        Amplitudes[1] * sinf(Cycle * Cycles[1] + Phases[1]);
+            }
+
+            Clip->Rotations[i] = QuatFromAxisAngle(Axis, Angle);
+            Clip->Translations[i] = Offsets[Joint];
+
+            if (Joint == 0)
+            {
+                Clip->Translations[i].y = 0.05f * sinf(2.0f * Cycle);
+            }
+
+            if (Joint == 5)
+            {
+                float Scale = 1.0f + 0.1f * sinf(Cycle);
+                Clip->Scales[i] = { Scale, Scale, Scale };
+            }
+        }
+    }
+}
+
+/** Samples every clip with backend, at every frame and between them, and
+ * checks it against sampling the raw clip. Prints the worst error of each
+ * type of track, and returns false if any track went further than its
+ * recorded error allows, or if sampling with cursors came out any
+ * different to searching for every key. */
+template <typename backend>
+static
+bool CheckAnimBackend(anim_bench_data *Data)
+{
+    double Worst[ANIM_TRACK_TYPES] = {};
+    bool IsBounded = true;
+
+    for (unsigned int i = 0; i < ANIM_BENCH_CLIPS; i++)
+    {
+        const anim_clip *Clip = &Data->Clips[i];
+        unsigned int Steps = (Clip->FrameCount - 1) * ANIM_BENCH_SUBFRAMES;
+
+        memset(Data->Cursors[i],
+               0,
+               Clip->JointCount * ANIM_TRACK_TYPES * sizeof(unsigned short));
+
+        for (unsigned int Step = 0; Step < Steps; Step++)
+        {
+            float Time = (float)Step /
+                         (float)(ANIM_BENCH_SUBFRAMES * ANIM_SAMPLE_RATE);
+
+            SampleRawClip(&Data->Raw[i], Time, &Data->Reference);
+            SampleClipWith<backend>(Clip, Time, Data->Cursors[i], &Data->Pose);
+            SampleClipWith<backend>(Clip, Time, 0, &Data->Other);
+
+            IsBounded &= memcmp(Data->Pose.Batches,
+                                Data->Other.Batches,
+                                Data->Pose.BatchCount *
+                                sizeof(anim_pose_batch)) == 0;
+
+            for (unsigned int Joint = 0; Joint < Clip->JointCount; Joint++)
+            {
+                vec3 Translations[2];
+                quat Rotations[2];
+                vec3 Scales[2];
+
+                GetPoseJoint(&Data->Reference,
+                             Joint,
+                             &Translations[0],
+                             &Rotations[0],
+                             &Scales[0]);
+                GetPoseJoint(&Data->Pose,
+                             Joint,
+                             &Translations[1],
+                             &Rotations[1],
+                             &Scales[1]);
+
+                vec4 References[ANIM_TRACK_TYPES] = {
+                    { Rotations[0].x,
+                      Rotations[0].y,
+                      Rotations[0].z,
+                      Rotations[0].w },
+                    Vec4(Translations[0], 0.0f),
+                    Vec4(Scales[0], 0.0f)
+                };
+                vec4 Values[ANIM_TRACK_TYPES] = {
+                    { Rotations[1].x,
+                      Rotations[1].y,
+                      Rotations[1].z,
+                      Rotations[1].w },
+                    Vec4(Translations[1], 0.0f),
+                    Vec4(Scales[1], 0.0f)
+                };
+
+                for (unsigned int Type = 0; Type < ANIM_TRACK_TYPES; Type++)
+                {
+                    const anim_track *Track =
+                        &Clip->Tracks[Joint * ANIM_TRACK_TYPES + Type];
+
+                    double Error =
+                        GetAnimError(Type, Values[Type], References[Type]);
+
+                    Worst[Type] = Error > Worst[Type] ? Error : Worst[Type];
+                    IsBounded &= Error <= Track->MaxError + ANIM_BENCH_SLACK;
+                }
+            }
+        }
+    }
+
+    printf("anim_%s_rotation_error %.3g\n",
+           backend::Name,
+           Worst[ANIM_TRACK_ROTATION]);
+    printf("anim_%s_translation_error %.3g\n",
+           backend::Name,
+           Worst[ANIM_TRACK_TRANSLATION]);
+    printf("anim_%s_scale_error %.3g\n",
+           backend::Name,
+           Worst[ANIM_TRACK_SCALE]);
+
+    return IsBounded;
+}
+
+/** Times backend sampling clips, both playing forward and jumping around,
+ * and blending poses. Prints joints per microsecond of each. */
+template <typename backend>
+static
+void BenchmarkAnimBackend(anim_bench_data *Data)
+{
+    double Best = 1e9;
+
+    for (unsigned int Run = 0; Run < ANIM_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        // NOTE[joe] Every clip a frame at 60Hz at a time, in turn.
+        for (unsigned int i = 0; i < ANIM_BENCH_SAMPLES; i++)
+        {
+            unsigned int Clip = i % ANIM_BENCH_CLIPS;
+            float Time = (float)(i / ANIM_BENCH_CLIPS) / 60.0f;
+
+            SampleClipWith<backend>(&Data->Clips[Clip],
+                                    Time,
+                                    Data->Cursors[Clip],
+                                    &Data->Pose);
+        }
+
+        double Time = PlatformGetTime() - Begin;
+        Best = Time < Best ? Time : Best;
+    }
+
+    printf("anim_%s_joints_per_us %.1f\n",
+           backend::Name,
+           ANIM_BENCH_SAMPLES * ANIM_BENCH_JOINTS / (Best * 1e6));
+
+    double Duration = Data->Clips[0].Duration;
+    Best = 1e9;
+
+    for (unsigned int Run = 0; Run < ANIM_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        for (unsigned int i = 0; i < ANIM_BENCH_SAMPLES; i++)
+        {
+            unsigned int Jump = (i * 97) % ANIM_BENCH_SAMPLES;
+            float Time = (float)(Duration * Jump / ANIM_BENCH_SAMPLES);
+
+            SampleClipWith<backend>(&Data->Clips[i % ANIM_BENCH_CLIPS],
+                                    Time,
+                                    0,
+                                    &Data->Pose);
+        }
+
+        double Time = PlatformGetTime() - Begin;
+        Best = Time < Best ? Time : Best;
+    }
+
+    printf("anim_%s_seek_joints_per_us %.1f\n",
+           backend::Name,
+           ANIM_BENCH_SAMPLES * ANIM_BENCH_JOINTS / (Best * 1e6));
+
+    SampleClipWith<backend>(&Data->Clips[1], 0.5f, 0, &Data->Other);
+
+    Best = 1e9;
+
+    for (unsigned int Run = 0; Run < ANIM_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        for (unsigned int i = 0; i < ANIM_BENCH_SAMPLES; i++)
+        {
+            BlendPosesWith<backend>(&Data->Pose,
+                                    &Data->Other,
+                                    (float)i / ANIM_BENCH_SAMPLES,
+                                    &Data->Reference);
+        }
+
+        double Time = PlatformGetTime() - Begin;
+        Best = Time < Best ? Time : Best;
+    }
+
+    printf("anim_%s_blend_joints_per_us %.1f\n",
+           backend::Name,
+           ANIM_BENCH_SAMPLES * ANIM_BENCH_JOINTS / (Best * 1e6));
+}
+
+/** Runs every animation check and benchmark and prints the results.
+ * Returns false if any track was out of bounds. */
+static
+bool BenchmarkAnimation()
+{
+    anim_bench_data *Data = new anim_bench_data;
+    Data->Random = 0x9E3779B9;
+
+    InitializeArena(&Data->Arena, MEGABYTES(256), "Animation benchmark");
+
+    /** Make up some clips, and compress them. */
+
+    vec3 Offsets[ANIM_BENCH_JOINTS];
+    BuildAnimBenchSkeleton(Data, Offsets);
+
+    float Tolerances[ANIM_BENCH_JOINTS * ANIM_TRACK_TYPES];
+
+    for (unsigned int i = 0; i < ANIM_BENCH_JOINTS; i++)
+    {
+        float *Joint = &Tolerances[i * ANIM_TRACK_TYPES];
+        Joint[ANIM_TRACK_ROTATION] = ANIM_BENCH_ROTATION_TOLERANCE;
+        Joint[ANIM_TRACK_TRANSLATION] = ANIM_BENCH_TRANSLATION_TOLERANCE;
+        Joint[ANIM_TRACK_SCALE] = ANIM_BENCH_SCALE_TOLERANCE;
+    }
+
+    size_t Size = 0;
+    unsigned int KeyCount = 0;
+    bool IsBounded = true;
+
+    for (unsigned int i = 0; i < ANIM_BENCH_CLIPS; i++)
+    {
+        BuildAnimBenchClip(Data, Offsets, &Data->Raw[i]);
+        CompressClip(&Data->Raw[i], Tolerances, &Data->Arena, &Data->Clips[i]);
+
+        Size += Data->Clips[i].Size;
+        KeyCount += Data->Clips[i].KeyCount;
+
+        // NOTE[joe] Quantization should never need more than these
+        // tolerances on their own.
+        for (unsigned int k = 0; k < ANIM_BENCH_JOINTS * ANIM_TRACK_TYPES; k++)
+        {
+            IsBounded &= Data->Clips[i].Tracks[k].MaxError <= Tolerances[k];
+        }
+    }
+
+    InitializePose(&Data->Reference, &Data->Arena, ANIM_BENCH_JOINTS);
+    InitializePose(&Data->Pose, &Data->Arena, ANIM_BENCH_JOINTS);
+    InitializePose(&Data->Other, &Data->Arena, ANIM_BENCH_JOINTS);
+
+    for (unsigned int i = 0; i < ANIM_BENCH_CLIPS; i++)
+    {
+        Data->Cursors[i] = PushArray(&Data->Arena,
+                                     unsigned short,
+                                     ANIM_BENCH_JOINTS * ANIM_TRACK_TYPES);
+    }
+
+    size_t RawSize = ANIM_BENCH_JOINTS * ANIM_BENCH_FRAMES *
+                     (2 * sizeof(vec3) + sizeof(quat));
+    unsigned int TrackCount =
+        ANIM_BENCH_CLIPS * ANIM_BENCH_JOINTS * ANIM_TRACK_TYPES;
+
+    printf("anim_joints %u\n", ANIM_BENCH_JOINTS);
+    printf("anim_frames %u\n", ANIM_BENCH_FRAMES);
+    printf("anim_backend %s\n", anim_backend::Name);
+    printf("anim_raw_bytes_per_clip %zu\n", RawSize);
+    printf("anim_bytes_per_clip %zu\n", Size / ANIM_BENCH_CLIPS);
+    printf("anim_compression_ratio %.1f\n",
+           (double)RawSize * ANIM_BENCH_CLIPS / Size);
+    printf("anim_keys_per_track %.1f\n", (double)KeyCount / TrackCount);
+
+    /** Check every kernel against the raw clips, then time them. */
+
+    IsBounded &= CheckAnimBackend<math_scalar>(Data);
+
+#if MATH_HAS_SSE
+    IsBounded &= CheckAnimBackend<math_sse>(Data);
+#endif
+
+#if MATH_HAS_AVX2
+    IsBounded &= CheckAnimBackend<math_avx2>(Data);
+#endif
+
+    BenchmarkAnimBackend<math_scalar>(Data);
+
+#if MATH_HAS_SSE
+    BenchmarkAnimBackend<math_sse>(Data);
+#endif
+
+#if MATH_HAS_AVX2
+    BenchmarkAnimBackend<math_avx2>(Data);
+#endif
+
+    /** What the compression saves us from, for comparison. */
+
+    double Best = 1e9;
+
+    for (unsigned int Run = 0; Run < ANIM_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        for (unsigned int i = 0; i < ANIM_BENCH_SAMPLES; i++)
+        {
+            float Time = (float)(Data->Clips[0].Duration * i /
+                                 ANIM_BENCH_SAMPLES);
+
+            SampleRawClip(&Data->Raw[i % ANIM_BENCH_CLIPS],
+                          Time,
+                          &Data->Pose);
+        }
+
+        double Time = PlatformGetTime() - Begin;
+        Best = Time < Best ? Time : Best;
+    }
+
+    printf("anim_raw_joints_per_us %.1f\n",
+           ANIM_BENCH_SAMPLES * ANIM_BENCH_JOINTS / (Best * 1e6));
+
+    /** Whole characters: three clips and two blends each, through to the
+     * palette. */
+
+    anim_character *Characters =
+        PushArray(&Data->Arena, anim_character, ANIM_BENCH_CHARACTERS);
+
+    for (unsigned int i = 0; i < ANIM_BENCH_CHARACTERS; i++)
+    {
+        anim_blend_tree Tree = {};
+
+        unsigned int Walk =
+            AddClipNode(&Tree, &Data->Clips[i % ANIM_BENCH_CLIPS], 1.0f);
+        unsigned int Run =
+            AddClipNode(&Tree, &Data->Clips[(i + 1) % ANIM_BENCH_CLIPS], 1.0f);
+        unsigned int Moving =
+            AddBlendNode(&Tree, Walk, Run, AnimBenchRandom(Data, 0.1f, 0.9f));
+        unsigned int Wave =
+            AddClipNode(&Tree, &Data->Clips[(i + 3) % ANIM_BENCH_CLIPS], 0.5f);
+        AddBlendNode(&Tree, Moving, Wave, AnimBenchRandom(Data, 0.1f, 0.9f));
+
+        InitializeCharacter(&Characters[i],
+                            &Data->Skeleton,
+                            &Tree,
+                            &Data->Arena);
+
+        Characters[i].Time = AnimBenchRandom(Data, 0.0f, 4.0f);
+    }
+
+    Best = 1e9;
+
+    for (unsigned int Run = 0; Run < ANIM_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        for (unsigned int i = 0; i < ANIM_BENCH_CHARACTERS; i++)
+        {
+            EvaluateCharacter(&Characters[i]);
+        }
+
+        double Time = PlatformGetTime() - Begin;
+        Best = Time < Best ? Time : Best;
+    }
+
+    printf("anim_characters %u\n", ANIM_BENCH_CHARACTERS);
+    printf("anim_serial_characters_per_ms %.0f\n",
+           ANIM_BENCH_CHARACTERS / (Best * 1000.0));
+
+    unsigned int CoreCount = PlatformGetCoreCount();
+
+    job_system *Jobs = new job_system;
+
+    InitializeJobSystem(Jobs, CoreCount);
+
+    Best = 1e9;
+
+    for (unsigned int Run = 0; Run < ANIM_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        EvaluateCharacters(Jobs, Characters, ANIM_BENCH_CHARACTERS);
+
+        double Time = PlatformGetTime() - Begin;
+        Best = Time < Best ? Time : Best;
+    }
+
+    ShutdownJobSystem(Jobs);
+
+    delete Jobs;
+
+    printf("anim_parallel_%u_characters_per_ms %.0f\n",
+           CoreCount,
+           ANIM_BENCH_CHARACTERS / (Best * 1000.0));
+    printf("anim_bounded %d\n", IsBounded ? 1 : 0);
+
+    ReleaseArena(&Data->Arena);
+
+    delete Data;
+
+    return IsBounded;
+}
@@ -0,0 +1,1500 @@
+/**
+ * @file animation.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains our animation runtime: the clip compressor, the SIMD
+ * kernels that decode and blend poses, blend trees, and evaluating
+ * characters across the job system. See animation.h.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "job.h"
+#include "animation.h"
+
+// NOTE[joe] The smallest three components of a unit quaternion are never
+// bigger than this, so that's the range their 15 bits cover.
+#define ANIM_ROTATION_RANGE 0.707106781f
+#define ANIM_ROTATION_STEP (2.0f * ANIM_ROTATION_RANGE / 32767.0f)
+
+/** Everything the kernels need to sample one type of track for a batch of
+ * joints, gathered a lane per joint: both keys either side of the time,
+ * how far between them it is, and how to dequantize them. */
+typedef struct alignas(32) {
+    unsigned short Keys[2][3][ANIM_BATCH_WIDTH];
+    float          Alpha[ANIM_BATCH_WIDTH];
+    float          Min[3][ANIM_BATCH_WIDTH];
+    float          Step[3][ANIM_BATCH_WIDTH];
+} anim_gather;
+
+/** Packs Rotation into three 16 bit values: the three smallest components,
+ * 15 bits each, and which one was left out in the top bits of the first
+ * two. The left out one is the biggest, which we make positive (q and -q
+ * are the same rotation) so it can be worked out from the others. */
+static
+void QuantizeRotation(quat Rotation, unsigned short *Result)
+{
+    Rotation = Normalize(Rotation);
+
+    float Components[4] = { Rotation.x, Rotation.y, Rotation.z, Rotation.w };
+    unsigned int Largest = 0;
+
+    for (unsigned int i = 1; i < 4; i++)
+    {
+        if (fabsf(Components[i]) > fabsf(Components[Largest]))
+        {
+            Largest = i;
+        }
+    }
+
+    float Sign = Components[Largest] < 0.0f ? -1.0f : 1.0f;
+
+    for (unsigned int i = 0, k = 0; i < 4; i++)
+    {
+        if (i == Largest)
+        {
+            continue;
+        }
+
+        float Key = roundf((Components[i] * Sign + ANIM_ROTATION_RANGE) /
+                           ANIM_ROTATION_STEP);
+        Key = Key < 0.0f ? 0.0f : (Key > 32767.0f ? 32767.0f : Key);
+
+        Result[k++] = (unsigned short)Key;
+    }
+
+    Result[0] |= (Largest & 1) << 15;
+    Result[1] |= (Largest >> 1) << 15;
+}
+
+/** Undoes QuantizeRotation(). Every kernel does the same math, lane by
+ * lane. */
+static inline
+quat DequantizeRotation(unsigned int V0, unsigned int V1, unsigned int V2)
+{
+    unsigned int Largest = (V0 >> 15) | (V1 >> 15) << 1;
+
+    float Smallest[3] = {
+        (float)(V0 & 0x7FFF) * ANIM_ROTATION_STEP - ANIM_ROTATION_RANGE,
+        (float)(V1 & 0x7FFF) * ANIM_ROTATION_STEP - ANIM_ROTATION_RANGE,
+        (float)(V2 & 0x7FFF) * ANIM_ROTATION_STEP - ANIM_ROTATION_RANGE
+    };
+
+    float Sum = Smallest[0] * Smallest[0] +
+                Smallest[1] * Smallest[1] +
+                Smallest[2] * Smallest[2];
+
+    float Missing = sqrtf(fmaxf(1.0f - Sum, 0.0f));
+
+    float Components[4];
+
+    for (unsigned int i = 0, k = 0; i < 4; i++)
+    {
+        Components[i] = i == Largest ? Missing : Smallest[k++];
+    }
+
+    return { Components[0], Components[1], Components[2], Components[3] };
+}
+
+/** One component of a translation or scale, Alpha of the way from key A to
+ * key B. Interpolates the keys before dequantizing them, which saves a
+ * multiply. */
+static inline
+float DequantizeComponent(float Min, float Step, float A, float B, float Alpha)
+{
+    return Min + Step * (A + (B - A) * Alpha);
+}
+
+/** Decodes a lane at a time. Every other backend is checked against this
+ * one. */
+template <>
+struct anim_kernels<math_scalar> {
+    static inline
+    void DecodeRotations(const anim_gather *Gather,
+                         float (*Result)[ANIM_BATCH_WIDTH])
+    {
+        const unsigned short (*A)[ANIM_BATCH_WIDTH] = Gather->Keys[0];
+        const unsigned short (*B)[ANIM_BATCH_WIDTH] = Gather->Keys[1];
+
+        for (unsigned int i = 0; i < ANIM_BATCH_WIDTH; i++)
+        {
+            quat Rotation =
+                Nlerp(DequantizeRotation(A[0][i], A[1][i], A[2][i]),
+                      DequantizeRotation(B[0][i], B[1][i], B[2][i]),
+                      Gather->Alpha[i]);
+
+            Result[0][i] = Rotation.x;
+            Result[1][i] = Rotation.y;
+            Result[2][i] = Rotation.z;
+            Result[3][i] = Rotation.w;
+        }
+    }
+
+    static inline
+    void DecodeVectors(const anim_gather *Gather,
+                       float (*Result)[ANIM_BATCH_WIDTH])
+    {
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            for (unsigned int i = 0; i < ANIM_BATCH_WIDTH; i++)
+            {
+                Result[k][i] = DequantizeComponent(Gather->Min[k][i],
+                                                   Gather->Step[k][i],
+                                                   Gather->Keys[0][k][i],
+                                                   Gather->Keys[1][k][i],
+                                                   Gather->Alpha[i]);
+            }
+        }
+    }
+
+    /** Result can be A or B. */
+    static inline
+    void Blend(const anim_pose_batch *A,
+               const anim_pose_batch *B,
+               float Weight,
+               anim_pose_batch *Result)
+    {
+        for (unsigned int i = 0; i < ANIM_BATCH_WIDTH; i++)
+        {
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                Result->Translations[k][i] = Lerp(A->Translations[k][i],
+                                                  B->Translations[k][i],
+                                                  Weight);
+                Result->Scales[k][i] = Lerp(A->Scales[k][i],
+                                            B->Scales[k][i],
+                                            Weight);
+            }
+
+            quat Rotation = Nlerp({ A->Rotations[0][i],
+                                    A->Rotations[1][i],
+                                    A->Rotations[2][i],
+                                    A->Rotations[3][i] },
+                                  { B->Rotations[0][i],
+                                    B->Rotations[1][i],
+                                    B->Rotations[2][i],
+                                    B->Rotations[3][i] },
+                                  Weight);
+
+            Result->Rotations[0][i] = Rotation.x;
+            Result->Rotations[1][i] = Rotation.y;
+            Result->Rotations[2][i] = Rotation.z;
+            Result->Rotations[3][i] = Rotation.w;
+        }
+    }
+};
+
+#if MATH_HAS_SSE
+
+/** Four lanes a register, so a batch is two of everything. Only needs
+ * SSE2, so picking a component has to be done with masks. */
+template <>
+struct anim_kernels<math_sse> {
+    /** Mask ? A : B, a lane at a time. */
+    static inline
+    __m128 Select(__m128 Mask, __m128 A, __m128 B)
+    {
+        return _mm_or_ps(_mm_and_ps(Mask, A), _mm_andnot_ps(Mask, B));
+    }
+
+    /** Widens four 16 bit keys to 32 bit lanes. */
+    static inline
+    __m128i LoadKeys(const unsigned short *Keys)
+    {
+        return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)Keys),
+                                  _mm_setzero_si128());
+    }
+
+    /** DequantizeRotation() on four lanes of Keys, starting at Offset. */
+    static inline
+    void DequantizeRotations(const unsigned short (*Keys)[ANIM_BATCH_WIDTH],
+                             unsigned int Offset,
+                             __m128 *Result)
+    {
+        __m128i V0 = LoadKeys(&Keys[0][Offset]);
+        __m128i V1 = LoadKeys(&Keys[1][Offset]);
+        __m128i V2 = LoadKeys(&Keys[2][Offset]);
+
+        __m128i Largest =
+            _mm_or_si128(_mm_srli_epi32(V0, 15),
+                         _mm_slli_epi32(_mm_srli_epi32(V1, 15), 1));
+
+        __m128i Bits = _mm_set1_epi32(0x7FFF);
+        __m128 Step = _mm_set1_ps(ANIM_ROTATION_STEP);
+        __m128 Range = _mm_set1_ps(ANIM_ROTATION_RANGE);
+
+        __m128 S0 = _mm_sub_ps(
+            _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(V0, Bits)), Step),
+            Range);
+        __m128 S1 = _mm_sub_ps(
+            _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(V1, Bits)), Step),
+            Range);
+        __m128 S2 = _mm_sub_ps(
+            _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(V2, Bits)), Step),
+            Range);
+
+        __m128 Sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(S0, S0),
+                                           _mm_mul_ps(S1, S1)),
+                                _mm_mul_ps(S2, S2));
+
+        __m128 Missing = _mm_sqrt_ps(
+            _mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), Sum), _mm_setzero_ps()));
+
+        __m128 Is0 = _mm_castsi128_ps(
+            _mm_cmpeq_epi32(Largest, _mm_set1_epi32(0)));
+        __m128 Is1 = _mm_castsi128_ps(
+            _mm_cmpeq_epi32(Largest, _mm_set1_epi32(1)));
+        __m128 Is2 = _mm_castsi128_ps(
+            _mm_cmpeq_epi32(Largest, _mm_set1_epi32(2)));
+        __m128 Is3 = _mm_castsi128_ps(
+            _mm_cmpeq_epi32(Largest, _mm_set1_epi32(3)));
+
+        // NOTE[joe] The smallest three fill in the other components in
+        // order, so each component is one of at most two of them.
+        Result[0] = Select(Is0, Missing, S0);
+        Result[1] = Select(Is1, Missing, Select(Is0, S0, S1));
+        Result[2] = Select(Is2, Missing, Select(Is3, S2, S1));
+        Result[3] = Select(Is3, Missing, S2);
+    }
+
+    /** Nlerp() on four lanes of quaternions, a component per register. */
+    static inline
+    void NlerpLanes(const __m128 *A, const __m128 *B, __m128 T, __m128 *Result)
+    {
+        __m128 Dot = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(A[0], B[0]), _mm_mul_ps(A[1], B[1])),
+            _mm_add_ps(_mm_mul_ps(A[2], B[2]), _mm_mul_ps(A[3], B[3])));
+
+        __m128 Sign = _mm_and_ps(_mm_cmplt_ps(Dot, _mm_setzero_ps()),
+                                 _mm_set1_ps(-0.0f));
+
+        __m128 Lanes[4];
+        __m128 Length = _mm_setzero_ps();
+
+        for (unsigned int k = 0; k < 4; k++)
+        {
+            __m128 To = _mm_xor_ps(B[k], Sign);
+            Lanes[k] = _mm_add_ps(A[k], _mm_mul_ps(_mm_sub_ps(To, A[k]), T));
+            Length = _mm_add_ps(Length, _mm_mul_ps(Lanes[k], Lanes[k]));
+        }
+
+        __m128 Scale = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(Length));
+
+        for (unsigned int k = 0; k < 4; k++)
+        {
+            Result[k] = _mm_mul_ps(Lanes[k], Scale);
+        }
+    }
+
+    static inline
+    void DecodeRotations(const anim_gather *Gather,
+                         float (*Result)[ANIM_BATCH_WIDTH])
+    {
+        for (unsigned int Offset = 0; Offset < ANIM_BATCH_WIDTH; Offset += 4)
+        {
+            __m128 A[4];
+            __m128 B[4];
+            __m128 Rotation[4];
+
+            DequantizeRotations(Gather->Keys[0], Offset, A);
+            DequantizeRotations(Gather->Keys[1], Offset, B);
+
+            NlerpLanes(A, B, _mm_load_ps(&Gather->Alpha[Offset]), Rotation);
+
+            for (unsigned int k = 0; k < 4; k++)
+            {
+                _mm_store_ps(&Result[k][Offset], Rotation[k]);
+            }
+        }
+    }
+
+    static inline
+    void DecodeVectors(const anim_gather *Gather,
+                       float (*Result)[ANIM_BATCH_WIDTH])
+    {
+        for (unsigned int Offset = 0; Offset < ANIM_BATCH_WIDTH; Offset += 4)
+        {
+            __m128 Alpha = _mm_load_ps(&Gather->Alpha[Offset]);
+
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                __m128 A =
+                    _mm_cvtepi32_ps(LoadKeys(&Gather->Keys[0][k][Offset]));
+                __m128 B =
+                    _mm_cvtepi32_ps(LoadKeys(&Gather->Keys[1][k][Offset]));
+
+                __m128 Key =
+                    _mm_add_ps(A, _mm_mul_ps(_mm_sub_ps(B, A), Alpha));
+
+                __m128 Value =
+                    _mm_add_ps(_mm_load_ps(&Gather->Min[k][Offset]),
+                               _mm_mul_ps(_mm_load_ps(&Gather->Step[k][Offset]),
+                                          Key));
+
+                _mm_store_ps(&Result[k][Offset], Value);
+            }
+        }
+    }
+
+    /** Result can be A or B. */
+    static inline
+    void Blend(const anim_pose_batch *A,
+               const anim_pose_batch *B,
+               float Weight,
+               anim_pose_batch *Result)
+    {
+        __m128 T = _mm_set1_ps(Weight);
+
+        for (unsigned int Offset = 0; Offset < ANIM_BATCH_WIDTH; Offset += 4)
+        {
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                __m128 From = _mm_load_ps(&A->Translations[k][Offset]);
+                __m128 To = _mm_load_ps(&B->Translations[k][Offset]);
+
+                _mm_store_ps(&Result->Translations[k][Offset],
+                             _mm_add_ps(From,
+                                        _mm_mul_ps(_mm_sub_ps(To, From), T)));
+
+                From = _mm_load_ps(&A->Scales[k][Offset]);
+                To = _mm_load_ps(&B->Scales[k][Offset]);
+
+                _mm_store_ps(&Result->Scales[k][Offset],
+                             _mm_add_ps(From,
+                                        _mm_mul_ps(_mm_sub_ps(To, From), T)));
+            }
+
+            __m128 From[4];
+            __m128 To[4];
+            __m128 Rotation[4];
+
+            for (unsigned int k = 0; k < 4; k++)
+            {
+                From[k] = _mm_load_ps(&A->Rotations[k][Offset]);
+                To[k] = _mm_load_ps(&B->Rotations[k][Offset]);
+            }
+
+            NlerpLanes(From, To, T, Rotation);
+
+            for (unsigned int k = 0; k < 4; k++)
+            {
+                _mm_store_ps(&Result->Rotations[k][Offset], Rotation[k]);
+            }
+        }
+    }
+};
+
+#endif
+
+#if MATH_HAS_AVX2
+
+/** A whole batch a register, with FMAs for the interpolation. */
+template <>
+struct anim_kernels<math_avx2> {
+    /** Widens eight 16 bit keys to 32 bit lanes. */
+    static inline
+    __m256i LoadKeys(const unsigned short *Keys)
+    {
+        return _mm256_cvtepu16_epi32(_mm_load_si128((const __m128i *)Keys));
+    }
+
+    /** DequantizeRotation() on a batch of Keys. */
+    static inline
+    void DequantizeRotations(const unsigned short (*Keys)[ANIM_BATCH_WIDTH],
+                             __m256 *Result)
+    {
+        __m256i V0 = LoadKeys(Keys[0]);
+        __m256i V1 = LoadKeys(Keys[1]);
+        __m256i V2 = LoadKeys(Keys[2]);
+
+        __m256i Largest =
+            _mm256_or_si256(_mm256_srli_epi32(V0, 15),
+                            _mm256_slli_epi32(_mm256_srli_epi32(V1, 15), 1));
+
+        __m256i Bits = _mm256_set1_epi32(0x7FFF);
+        __m256 Step = _mm256_set1_ps(ANIM_ROTATION_STEP);
+        __m256 Range = _mm256_set1_ps(ANIM_ROTATION_RANGE);
+
+        __m256 S0 = _mm256_sub_ps(
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(V0, Bits)),
+                          Step),
+            Range);
+        __m256 S1 = _mm256_sub_ps(
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(V1, Bits)),
+                          Step),
+            Range);
+        __m256 S2 = _mm256_sub_ps(
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(V2, Bits)),
+                          Step),
+            Range);
+
+        __m256 Sum = _mm256_fmadd_ps(S2,
+                                     S2,
+                                     _mm256_fmadd_ps(S1,
+                                                     S1,
+                                                     _mm256_mul_ps(S0, S0)));
+
+        __m256 Missing = _mm256_sqrt_ps(
+            _mm256_max_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), Sum),
+                          _mm256_setzero_ps()));
+
+        __m256 Is0 = _mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(Largest, _mm256_set1_epi32(0)));
+        __m256 Is1 = _mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(Largest, _mm256_set1_epi32(1)));
+        __m256 Is2 = _mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(Largest, _mm256_set1_epi32(2)));
+        __m256 Is3 = _mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(Largest, _mm256_set1_epi32(3)));
+
+        // NOTE[joe] blendv takes its second argument where the mask is set.
+        Result[0] = _mm256_blendv_ps(S0, Missing, Is0);
+        Result[1] = _mm256_blendv_ps(_mm256_blendv_ps(S1, S0, Is0),
+                                     Missing,
+                                     Is1);
+        Result[2] = _mm256_blendv_ps(_mm256_blendv_ps(S1, S2, Is3),
+                                     Missing,
+                                     Is2);
+        Result[3] = _mm256_blendv_ps(S2, Missing, Is3);
+    }
+
+    static inline
+    void NlerpLanes(const __m256 *A, const __m256 *B, __m256 T, __m256 *Result)
+    {
+        // NOTE[joe] Summed in pairs, rather than one long chain of FMAs.
+        __m256 Dot = _mm256_add_ps(
+            _mm256_fmadd_ps(A[1], B[1], _mm256_mul_ps(A[0], B[0])),
+            _mm256_fmadd_ps(A[3], B[3], _mm256_mul_ps(A[2], B[2])));
+
+        __m256 Sign = _mm256_and_ps(
+            _mm256_cmp_ps(Dot, _mm256_setzero_ps(), _CMP_LT_OQ),
+            _mm256_set1_ps(-0.0f));
+
+        __m256 Lanes[4];
+
+        for (unsigned int k = 0; k < 4; k++)
+        {
+            __m256 To = _mm256_xor_ps(B[k], Sign);
+            Lanes[k] = _mm256_fmadd_ps(_mm256_sub_ps(To, A[k]), T, A[k]);
+        }
+
+        __m256 Length = _mm256_add_ps(
+            _mm256_fmadd_ps(Lanes[1], Lanes[1],
+                            _mm256_mul_ps(Lanes[0], Lanes[0])),
+            _mm256_fmadd_ps(Lanes[3], Lanes[3],
+                            _mm256_mul_ps(Lanes[2], Lanes[2])));
+
+        __m256 Scale = _mm256_div_ps(_mm256_set1_ps(1.0f),
+                                     _mm256_sqrt_ps(Length));
+
+        for (unsigned int k = 0; k < 4; k++)
+        {
+            Result[k] = _mm256_mul_ps(Lanes[k], Scale);
+        }
+    }
+
+    static inline
+    void DecodeRotations(const anim_gather *Gather,
+                         float (*Result)[ANIM_BATCH_WIDTH])
+    {
+        __m256 A[4];
+        __m256 B[4];
+        __m256 Rotation[4];
+
+        DequantizeRotations(Gather->Keys[0], A);
+        DequantizeRotations(Gather->Keys[1], B);
+
+        NlerpLanes(A, B, _mm256_load_ps(Gather->Alpha), Rotation);
+
+        // NOTE[joe] Written out, because as loops GCC turns these copies
+        // into memcpy()s, which stall on store forwarding.
+        _mm256_store_ps(Result[0], Rotation[0]);
+        _mm256_store_ps(Result[1], Rotation[1]);
+        _mm256_store_ps(Result[2], Rotation[2]);
+        _mm256_store_ps(Result[3], Rotation[3]);
+    }
+
+    static inline
+    void DecodeVectors(const anim_gather *Gather,
+                       float (*Result)[ANIM_BATCH_WIDTH])
+    {
+        __m256 Alpha = _mm256_load_ps(Gather->Alpha);
+
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            __m256 A = _mm256_cvtepi32_ps(LoadKeys(Gather->Keys[0][k]));
+            __m256 B = _mm256_cvtepi32_ps(LoadKeys(Gather->Keys[1][k]));
+
+            __m256 Key = _mm256_fmadd_ps(_mm256_sub_ps(B, A), Alpha, A);
+
+            _mm256_store_ps(Result[k],
+                            _mm256_fmadd_ps(_mm256_load_ps(Gather->Step[k]),
+                                            Key,
+                                            _mm256_load_ps(Gather->Min[k])));
+        }
+    }
+
+    /** Result can be A or B. */
+    static inline
+    void Blend(const anim_pose_batch *A,
+               const anim_pose_batch *B,
+               float Weight,
+               anim_pose_batch *Result)
+    {
+        __m256 T = _mm256_set1_ps(Weight);
+
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            __m256 From = _mm256_load_ps(A->Translations[k]);
+            __m256 To = _mm256_load_ps(B->Translations[k]);
+
+            _mm256_store_ps(Result->Translations[k],
+                            _mm256_fmadd_ps(_mm256_sub_ps(To, From), T, From));
+
+            From = _mm256_load_ps(A->Scales[k]);
+            To = _mm256_load_ps(B->Scales[k]);
+
+            _mm256_store_ps(Result->Scales[k],
+                            _mm256_fmadd_ps(_mm256_sub_ps(To, From), T, From));
+        }
+
+        // NOTE[joe] Written out, for the same reason as in
+        // DecodeRotations().
+        __m256 From[4] = {
+            _mm256_load_ps(A->Rotations[0]),
+            _mm256_load_ps(A->Rotations[1]),
+            _mm256_load_ps(A->Rotations[2]),
+            _mm256_load_ps(A->Rotations[3])
+        };
+        __m256 To[4] = {
+            _mm256_load_ps(B->Rotations[0]),
+            _mm256_load_ps(B->Rotations[1]),
+            _mm256_load_ps(B->Rotations[2]),
+            _mm256_load_ps(B->Rotations[3])
+        };
+        __m256 Rotation[4];
+
+        NlerpLanes(From, To, T, Rotation);
+
+        _mm256_store_ps(Result->Rotations[0], Rotation[0]);
+        _mm256_store_ps(Result->Rotations[1], Rotation[1]);
+        _mm256_store_ps(Result->Rotations[2], Rotation[2]);
+        _mm256_store_ps(Result->Rotations[3], Rotation[3]);
+    }
+};
+
+#endif
+
+// NOTE[joe] NEON goes through the scalar kernels for now.
+#if MATH_HAS_AVX2
+typedef math_avx2 anim_backend;
+#elif MATH_HAS_SSE
+typedef math_sse anim_backend;
+#else
+typedef math_scalar anim_backend;
+#endif
+
+/** Skeletons, poses and raw clips. */
+
+/** Allocates a skeleton of JointCount joints from Arena, each one a root
+ * with an identity inverse bind, for the caller to fill in. */
+static
+void InitializeSkeleton(anim_skeleton *Skeleton,
+                        memory_arena *Arena,
+                        unsigned int JointCount)
+{
+    Skeleton->JointCount = JointCount;
+    Skeleton->Parents = PushArray(Arena, unsigned int, JointCount);
+    Skeleton->InverseBinds = PushArray(Arena, mat4, JointCount);
+
+    for (unsigned int i = 0; i < JointCount; i++)
+    {
+        Skeleton->Parents[i] = ANIM_NO_PARENT;
+        Skeleton->InverseBinds[i] = Mat4Identity();
+    }
+}
+
+static
+void InitializePose(anim_pose *Pose,
+                    memory_arena *Arena,
+                    unsigned int JointCount)
+{
+    Pose->JointCount = JointCount;
+    Pose->BatchCount = (JointCount + ANIM_BATCH_WIDTH - 1) / ANIM_BATCH_WIDTH;
+    Pose->Batches = PushArray(Arena, anim_pose_batch, Pose->BatchCount);
+}
+
+/** Allocates a raw clip from Arena, with every joint at the origin, not
+ * rotated and not scaled, for the caller to fill in. */
+static
+void InitializeRawClip(anim_raw_clip *Clip,
+                       memory_arena *Arena,
+                       unsigned int JointCount,
+                       unsigned int FrameCount)
+{
+    unsigned int Count = JointCount * FrameCount;
+
+    Clip->JointCount = JointCount;
+    Clip->FrameCount = FrameCount;
+    Clip->Translations = PushArray(Arena, vec3, Count);
+    Clip->Rotations = PushArray(Arena, quat, Count);
+    Clip->Scales = PushArray(Arena, vec3, Count);
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        Clip->Translations[i] = { 0.0f, 0.0f, 0.0f };
+        Clip->Rotations[i] = QuatIdentity();
+        Clip->Scales[i] = { 1.0f, 1.0f, 1.0f };
+    }
+}
+
+/** Sets Joint's transform in Pose. */
+static inline
+void SetPoseJoint(anim_pose *Pose,
+                  unsigned int Joint,
+                  vec3 Translation,
+                  quat Rotation,
+                  vec3 Scale)
+{
+    anim_pose_batch *Batch = &Pose->Batches[Joint / ANIM_BATCH_WIDTH];
+    unsigned int i = Joint % ANIM_BATCH_WIDTH;
+
+    Batch->Translations[0][i] = Translation.x;
+    Batch->Translations[1][i] = Translation.y;
+    Batch->Translations[2][i] = Translation.z;
+    Batch->Rotations[0][i] = Rotation.x;
+    Batch->Rotations[1][i] = Rotation.y;
+    Batch->Rotations[2][i] = Rotation.z;
+    Batch->Rotations[3][i] = Rotation.w;
+    Batch->Scales[0][i] = Scale.x;
+    Batch->Scales[1][i] = Scale.y;
+    Batch->Scales[2][i] = Scale.z;
+}
+
+/** Gets Joint's transform out of Pose. */
+static inline
+void GetPoseJoint(const anim_pose *Pose,
+                  unsigned int Joint,
+                  vec3 *Translation,
+                  quat *Rotation,
+                  vec3 *Scale)
+{
+    const anim_pose_batch *Batch = &Pose->Batches[Joint / ANIM_BATCH_WIDTH];
+    unsigned int i = Joint % ANIM_BATCH_WIDTH;
+
+    *Translation = {
+        Batch->Translations[0][i],
+        Batch->Translations[1][i],
+        Batch->Translations[2][i]
+    };
+    *Rotation = {
+        Batch->Rotations[0][i],
+        Batch->Rotations[1][i],
+        Batch->Rotations[2][i],
+        Batch->Rotations[3][i]
+    };
+    *Scale = {
+        Batch->Scales[0][i],
+        Batch->Scales[1][i],
+        Batch->Scales[2][i]
+    };
+}
+
+/** Sampling. */
+
+/** Where Time falls in a clip of FrameCount frames, in frames. Clips loop,
+ * so that's wrapped around to somewhere in the clip. */
+static inline
+float GetAnimPosition(unsigned int FrameCount, float Time)
+{
+    float Length = (float)(FrameCount - 1);
+
+    if (Length <= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    float Position = fmodf(Time * ANIM_SAMPLE_RATE, Length);
+
+    return Position < 0.0f ? Position + Length : Position;
+}
+
+/** Finds the keys of Track either side of Position, as indices into Clip's
+ * keys, and returns how far between them Position is. Cursor, unless it's
+ * null, is where to look first, and gets where the keys were found. */
+static inline
+float FindAnimKeys(const anim_clip *Clip,
+                   const anim_track *Track,
+                   float Position,
+                   unsigned short *Cursor,
+                   unsigned int *A,
+                   unsigned int *B)
+{
+    const unsigned short *Frames = Clip->Frames + Track->FirstKey;
+
+    // NOTE[joe] Keys are on whole frames, so comparing against the frame
+    // Position is in is the same as comparing against Position.
+    unsigned int Frame = (unsigned int)Position;
+
+    // NOTE[joe] What we're after is the last key at or before Frame, short
+    // of the last key, so that there's always one after it.
+    unsigned int Last = Track->KeyCount - 1;
+    unsigned int Low = 0;
+    bool IsFound = false;
+
+    // NOTE[joe] Playing forward moves a frame or less at a time, so it's
+    // nearly always the same key as last time or the one after.
+    if (Cursor && *Cursor < Last && Frames[*Cursor] <= Frame)
+    {
+        Low = *Cursor;
+
+        if (Low + 1 < Last && Frames[Low + 1] <= Frame)
+        {
+            Low++;
+        }
+
+        IsFound = Low + 1 == Last || Frames[Low + 1] > Frame;
+    }
+
+    if (!IsFound)
+    {
+        // NOTE[joe] Branchless, since which way each step goes is a coin
+        // toss. The first key is always frame zero, so Low never starts
+        // past Frame.
+        Low = 0;
+
+        for (unsigned int Count = Last; Count > 1;)
+        {
+            unsigned int Half = Count / 2;
+            Low = Frames[Low + Half] <= Frame ? Low + Half : Low;
+            Count -= Half;
+        }
+    }
+
+    if (Cursor)
+    {
+        *Cursor = (unsigned short)Low;
+    }
+
+    unsigned int High = Last > 0 ? Low + 1 : Low;
+
+    *A = Track->FirstKey + Low;
+    *B = Track->FirstKey + High;
+
+    if (Low == High)
+    {
+        return 0.0f;
+    }
+
+    float Alpha = (Position - (float)Frames[Low]) /
+                  (float)(Frames[High] - Frames[Low]);
+
+    return Alpha > 1.0f ? 1.0f : Alpha;
+}
+
+/** Gathers the Type tracks of Batch's joints, at Position, for the kernels
+ * to decode. Cursors is one per track, or null. */
+static
+void GatherAnimTracks(const anim_clip *Clip,
+                      unsigned int Batch,
+                      anim_track_type Type,
+                      float Position,
+                      unsigned short *Cursors,
+                      anim_gather *Gather)
+{
+    for (unsigned int i = 0; i < ANIM_BATCH_WIDTH; i++)
+    {
+        // NOTE[joe] Padding lanes repeat the last joint, rather than decode
+        // garbage.
+        unsigned int Joint = Batch * ANIM_BATCH_WIDTH + i;
+        Joint = Joint < Clip->JointCount ? Joint : Clip->JointCount - 1;
+
+        unsigned int Index = Joint * ANIM_TRACK_TYPES + Type;
+        const anim_track *Track = &Clip->Tracks[Index];
+
+        unsigned int A;
+        unsigned int B;
+        Gather->Alpha[i] = FindAnimKeys(Clip,
+                                        Track,
+                                        Position,
+                                        Cursors ? &Cursors[Index] : 0,
+                                        &A,
+                                        &B);
+
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            Gather->Keys[0][k][i] = Clip->Values[A * 3 + k];
+            Gather->Keys[1][k][i] = Clip->Values[B * 3 + k];
+        }
+
+        if (Type != ANIM_TRACK_ROTATION)
+        {
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                Gather->Min[k][i] = Track->Min[k];
+                Gather->Step[k][i] = Track->Step[k];
+            }
+        }
+    }
+}
+
+/** Samples Clip at Time (in seconds) into Result with backend's kernels.
+ * Cursors, if it isn't null, has one entry per track, kept from one call
+ * to the next to save searching for keys. They start out as zero. */
+template <typename backend>
+static
+void SampleClipWith(const anim_clip *Clip,
+                    float Time,
+                    unsigned short *Cursors,
+                    anim_pose *Result)
+{
+    Assert(Result->JointCount == Clip->JointCount,
+           "Sampling a clip into the wrong size pose.\n");
+
+    float Position = GetAnimPosition(Clip->FrameCount, Time);
+
+    anim_gather Gather;
+
+    for (unsigned int i = 0; i < Result->BatchCount; i++)
+    {
+        anim_pose_batch *Batch = &Result->Batches[i];
+
+        GatherAnimTracks(Clip,
+                         i,
+                         ANIM_TRACK_ROTATION,
+                         Position,
+                         Cursors,
+                         &Gather);
+        anim_kernels<backend>::DecodeRotations(&Gather, Batch->Rotations);
+
+        GatherAnimTracks(Clip,
+                         i,
+                         ANIM_TRACK_TRANSLATION,
+                         Position,
+                         Cursors,
+                         &Gather);
+        anim_kernels<backend>::DecodeVectors(&Gather, Batch->Translations);
+
+        GatherAnimTracks(Clip,
+                         i,
+                         ANIM_TRACK_SCALE,
+                         Position,
+                         Cursors,
+                         &Gather);
+        anim_kernels<backend>::DecodeVectors(&Gather, Batch->Scales);
+    }
+}
+
+static
+void SampleClip(const anim_clip *Clip,
+                float Time,
+                unsigned short *Cursors,
+                anim_pose *Result)
+{
+    SampleClipWith<anim_backend>(Clip, Time, Cursors, Result);
+}
+
+/** Samples Clip at Time into Result, interpolating between every frame the
+ * way the compressed clip interpolates between keys. What compressed clips
+ * get checked against. */
+static
+void SampleRawClip(const anim_raw_clip *Clip, float Time, anim_pose *Result)
+{
+    Assert(Result->JointCount == Clip->JointCount,
+           "Sampling a clip into the wrong size pose.\n");
+
+    float Position = GetAnimPosition(Clip->FrameCount, Time);
+
+    unsigned int Frame = (unsigned int)Position;
+    unsigned int Next = Frame + 1 < Clip->FrameCount ? Frame + 1 : Frame;
+    float Alpha = Position - (float)Frame;
+
+    const vec3 *Translations = Clip->Translations + Frame * Clip->JointCount;
+    const quat *Rotations = Clip->Rotations + Frame * Clip->JointCount;
+    const vec3 *Scales = Clip->Scales + Frame * Clip->JointCount;
+
+    unsigned int Step = (Next - Frame) * Clip->JointCount;
+    unsigned int Padded = Result->BatchCount * ANIM_BATCH_WIDTH;
+
+    for (unsigned int i = 0; i < Padded; i++)
+    {
+        unsigned int j = i < Clip->JointCount ? i : Clip->JointCount - 1;
+
+        SetPoseJoint(Result,
+                     i,
+                     Lerp(Translations[j], Translations[j + Step], Alpha),
+                     Nlerp(Rotations[j], Rotations[j + Step], Alpha),
+                     Lerp(Scales[j], Scales[j + Step], Alpha));
+    }
+}
+
+/** Compression. */
+
+/** The raw value of Joint's Type track at Frame. Translations and scales
+ * are in x, y and z. */
+static
+vec4 GetRawAnimValue(const anim_raw_clip *Clip,
+                     unsigned int Joint,
+                     unsigned int Type,
+                     unsigned int Frame)
+{
+    unsigned int i = Frame * Clip->JointCount + Joint;
+
+    if (Type == ANIM_TRACK_ROTATION)
+    {
+        quat Rotation = Clip->Rotations[i];
+        return { Rotation.x, Rotation.y, Rotation.z, Rotation.w };
+    }
+
+    vec3 Value = Type == ANIM_TRACK_TRANSLATION ? Clip->Translations[i]
+                                                : Clip->Scales[i];
+
+    return Vec4(Value, 0.0f);
+}
+
+static
+void QuantizeAnimValue(const anim_track *Track,
+                       unsigned int Type,
+                       vec4 Value,
+                       unsigned short *Result)
+{
+    if (Type == ANIM_TRACK_ROTATION)
+    {
+        QuantizeRotation({ Value.x, Value.y, Value.z, Value.w }, Result);
+        return;
+    }
+
+    const float *Components = &Value.x;
+
+    for (unsigned int k = 0; k < 3; k++)
+    {
+        float Key = 0.0f;
+
+        if (Track->Step[k] > 0.0f)
+        {
+            Key = roundf((Components[k] - Track->Min[k]) / Track->Step[k]);
+            Key = Key < 0.0f ? 0.0f : (Key > 65535.0f ? 65535.0f : Key);
+        }
+
+        Result[k] = (unsigned short)Key;
+    }
+}
+
+/** Decodes Alpha of the way from key A to key B, exactly as the scalar
+ * kernels do. */
+static
+vec4 DecodeAnimValue(const anim_track *Track,
+                     unsigned int Type,
+                     const unsigned short *A,
+                     const unsigned short *B,
+                     float Alpha)
+{
+    if (Type == ANIM_TRACK_ROTATION)
+    {
+        quat Rotation = Nlerp(DequantizeRotation(A[0], A[1], A[2]),
+                              DequantizeRotation(B[0], B[1], B[2]),
+                              Alpha);
+
+        return { Rotation.x, Rotation.y, Rotation.z, Rotation.w };
+    }
+
+    vec4 Result = {};
+    float *Components = &Result.x;
+
+    for (unsigned int k = 0; k < 3; k++)
+    {
+        Components[k] = DequantizeComponent(Track->Min[k],
+                                            Track->Step[k],
+                                            A[k],
+                                            B[k],
+                                            Alpha);
+    }
+
+    return Result;
+}
+
+/** How far Value is from Reference: the angle between them for rotations,
+ * and the distance between them for everything else. */
+static
+double GetAnimError(unsigned int Type, vec4 Value, vec4 Reference)
+{
+    if (Type == ANIM_TRACK_ROTATION)
+    {
+        // NOTE[joe] The angle of the rotation from one to the other. atan2()
+        // stays accurate for tiny angles, where acos() of the dot doesn't.
+        quat Delta = Conjugate({ Reference.x,
+                                 Reference.y,
+                                 Reference.z,
+                                 Reference.w }) *
+                     quat{ Value.x, Value.y, Value.z, Value.w };
+
+        double Sin = sqrt((double)Delta.x * Delta.x +
+                          (double)Delta.y * Delta.y +
+                          (double)Delta.z * Delta.z);
+
+        return 2.0 * atan2(Sin, fabs((double)Delta.w));
+    }
+
+    double X = (double)Value.x - Reference.x;
+    double Y = (double)Value.y - Reference.y;
+    double Z = (double)Value.z - Reference.z;
+
+    return sqrt(X * X + Y * Y + Z * Z);
+}
+
+/** Picks which frames of Joint's Type track to keep as keys. Greedy: each
+ * key is as many frames past the last as it can be with every frame in
+ * between decoding to within Tolerance. Writes the keys' frames to Frames,
+ * unless it's null, and returns how many there are. */
+static
+unsigned int SelectAnimKeys(const anim_raw_clip *Clip,
+                            const anim_track *Track,
+                            unsigned int Joint,
+                            unsigned int Type,
+                            float Tolerance,
+                            unsigned short *Frames)
+{
+    unsigned int Last = Clip->FrameCount - 1;
+
+    unsigned short A[3];
+    unsigned short B[3];
+
+    /** A track that never moves more than Tolerance only needs one key. */
+
+    QuantizeAnimValue(Track, Type, GetRawAnimValue(Clip, Joint, Type, 0), A);
+    vec4 First = DecodeAnimValue(Track, Type, A, A, 0.0f);
+
+    bool IsConstant = true;
+
+    for (unsigned int Frame = 1; Frame <= Last && IsConstant; Frame++)
+    {
+        vec4 Reference = GetRawAnimValue(Clip, Joint, Type, Frame);
+        IsConstant = GetAnimError(Type, First, Reference) <= Tolerance;
+    }
+
+    unsigned int Count = 0;
+
+    if (Frames)
+    {
+        Frames[Count] = 0;
+    }
+
+    Count++;
+
+    if (IsConstant)
+    {
+        return Count;
+    }
+
+    /** Otherwise stretch each key as far as it'll go. */
+
+    unsigned int Key = 0;
+
+    while (Key < Last)
+    {
+        QuantizeAnimValue(Track,
+                          Type,
+                          GetRawAnimValue(Clip, Joint, Type, Key),
+                          A);
+
+        unsigned int Next = Key + 1;
+
+        for (unsigned int Candidate = Key + 2; Candidate <= Last; Candidate++)
+        {
+            QuantizeAnimValue(Track,
+                              Type,
+                              GetRawAnimValue(Clip, Joint, Type, Candidate),
+                              B);
+
+            bool Fits = true;
+
+            for (unsigned int Frame = Key + 1;
+                 Frame < Candidate && Fits;
+                 Frame++)
+            {
+                // NOTE[joe] The same Alpha FindAnimKeys() works out.
+                float Alpha = ((float)Frame - (float)Key) /
+                              (float)(Candidate - Key);
+
+                vec4 Value = DecodeAnimValue(Track, Type, A, B, Alpha);
+                vec4 Reference = GetRawAnimValue(Clip, Joint, Type, Frame);
+
+                Fits = GetAnimError(Type, Value, Reference) <= Tolerance;
+            }
+
+            if (!Fits)
+            {
+                break;
+            }
+
+            Next = Candidate;
+        }
+
+        if (Frames)
+        {
+            Frames[Count] = (unsigned short)Next;
+        }
+
+        Count++;
+        Key = Next;
+    }
+
+    return Count;
+}
+
+/** Compresses Raw into Result, allocated from Arena. Tolerances has one
+ * entry per track, indexed like Result's tracks: the furthest each one may
+ * be from Raw at any frame, in radians for rotations and units for
+ * translations and scales. Quantization alone can be further off than a
+ * tolerance that's too tight; the track's MaxError says by how much. */
+static
+void CompressClip(const anim_raw_clip *Raw,
+                  const float *Tolerances,
+                  memory_arena *Arena,
+                  anim_clip *Result)
+{
+    Assert(Raw->FrameCount > 0 && Raw->FrameCount <= ANIM_MAX_FRAMES,
+           "Too many frames to compress.\n");
+
+    unsigned int TrackCount = Raw->JointCount * ANIM_TRACK_TYPES;
+
+    Result->JointCount = Raw->JointCount;
+    Result->FrameCount = Raw->FrameCount;
+    Result->Duration = (float)(Raw->FrameCount - 1) / ANIM_SAMPLE_RATE;
+    Result->Tracks = PushArray(Arena, anim_track, TrackCount);
+    Result->KeyCount = 0;
+
+    /** Find each track's range, and how many keys it needs. */
+
+    for (unsigned int i = 0; i < TrackCount; i++)
+    {
+        anim_track *Track = &Result->Tracks[i];
+        unsigned int Joint = i / ANIM_TRACK_TYPES;
+        unsigned int Type = i % ANIM_TRACK_TYPES;
+
+        *Track = {};
+
+        if (Type != ANIM_TRACK_ROTATION)
+        {
+            vec4 Min = GetRawAnimValue(Raw, Joint, Type, 0);
+            vec4 Max = Min;
+
+            for (unsigned int Frame = 1; Frame < Raw->FrameCount; Frame++)
+            {
+                vec4 Value = GetRawAnimValue(Raw, Joint, Type, Frame);
+
+                Min = { fminf(Min.x, Value.x),
+                        fminf(Min.y, Value.y),
+                        fminf(Min.z, Value.z),
+                        0.0f };
+                Max = { fmaxf(Max.x, Value.x),
+                        fmaxf(Max.y, Value.y),
+                        fmaxf(Max.z, Value.z),
+                        0.0f };
+            }
+
+            Track->Min[0] = Min.x;
+            Track->Min[1] = Min.y;
+            Track->Min[2] = Min.z;
+            Track->Step[0] = (Max.x - Min.x) / 65535.0f;
+            Track->Step[1] = (Max.y - Min.y) / 65535.0f;
+            Track->Step[2] = (Max.z - Min.z) / 65535.0f;
+        }
+
+        Track->FirstKey = Result->KeyCount;
+        Track->KeyCount =
+            SelectAnimKeys(Raw, Track, Joint, Type, Tolerances[i], 0);
+
+        Result->KeyCount += Track->KeyCount;
+    }
+
+    Result->Frames = PushArray(Arena, unsigned short, Result->KeyCount);
+    Result->Values = PushArray(Arena, unsigned short, Result->KeyCount * 3);
+
+    /** Store the keys, then measure how far off each track ended up. */
+
+    for (unsigned int i = 0; i < TrackCount; i++)
+    {
+        anim_track *Track = &Result->Tracks[i];
+        unsigned int Joint = i / ANIM_TRACK_TYPES;
+        unsigned int Type = i % ANIM_TRACK_TYPES;
+
+        unsigned short *Frames = Result->Frames + Track->FirstKey;
+        unsigned short *Values = Result->Values + Track->FirstKey * 3;
+
+        SelectAnimKeys(Raw, Track, Joint, Type, Tolerances[i], Frames);
+
+        for (unsigned int k = 0; k < Track->KeyCount; k++)
+        {
+            QuantizeAnimValue(Track,
+                              Type,
+                              GetRawAnimValue(Raw, Joint, Type, Frames[k]),
+                              Values + k * 3);
+        }
+
+        double Worst = 0.0;
+
+        for (unsigned int Frame = 0; Frame < Raw->FrameCount; Frame++)
+        {
+            unsigned int A;
+            unsigned int B;
+            float Alpha =
+                FindAnimKeys(Result, Track, (float)Frame, 0, &A, &B);
+
+            vec4 Value = DecodeAnimValue(Track,
+                                         Type,
+                                         Result->Values + A * 3,
+                                         Result->Values + B * 3,
+                                         Alpha);
+            vec4 Reference = GetRawAnimValue(Raw, Joint, Type, Frame);
+
+            double Error = GetAnimError(Type, Value, Reference);
+            Worst = Error > Worst ? Error : Worst;
+        }
+
+        Track->MaxError = (float)Worst;
+    }
+
+    Result->Size = sizeof(anim_clip) +
+                   TrackCount * sizeof(anim_track) +
+                   Result->KeyCount * 4 * sizeof(unsigned short);
+}
+
+/** Blending. */
+
+/** Blends Weight of the way from pose A to pose B into Result, with
+ * backend's kernels. Result can be A or B. */
+template <typename backend>
+static
+void BlendPosesWith(const anim_pose *A,
+                    const anim_pose *B,
+                    float Weight,
+                    anim_pose *Result)
+{
+    for (unsigned int i = 0; i < Result->BatchCount; i++)
+    {
+        anim_kernels<backend>::Blend(&A->Batches[i],
+                                     &B->Batches[i],
+                                     Weight,
+                                     &Result->Batches[i]);
+    }
+}
+
+static
+void BlendPoses(const anim_pose *A,
+                const anim_pose *B,
+                float Weight,
+                anim_pose *Result)
+{
+    BlendPosesWith<anim_backend>(A, B, Weight, Result);
+}
+
+/** Adds a node that samples Clip at Speed times the character's time, and
+ * returns its index. */
+static
+unsigned int AddClipNode(anim_blend_tree *Tree,
+                         const anim_clip *Clip,
+                         float Speed)
+{
+    Assert(Tree->NodeCount < ANIM_MAX_NODES, "Too many blend tree nodes.\n");
+
+    anim_node *Node = &Tree->Nodes[Tree->NodeCount];
+    *Node = {};
+    Node->Type = ANIM_NODE_CLIP;
+    Node->Clip = Clip;
+    Node->Speed = Speed;
+
+    return Tree->NodeCount++;
+}
+
+/** Adds a node that blends Weight of the way from node A to node B, and
+ * returns its index. */
+static
+unsigned int AddBlendNode(anim_blend_tree *Tree,
+                          unsigned int A,
+                          unsigned int B,
+                          float Weight)
+{
+    Assert(Tree->NodeCount < ANIM_MAX_NODES, "Too many blend tree nodes.\n");
+    Assert(A < Tree->NodeCount && B < Tree->NodeCount,
+           "Blend nodes have to come after their children.\n");
+
+    anim_node *Node = &Tree->Nodes[Tree->NodeCount];
+    *Node = {};
+    Node->Type = ANIM_NODE_BLEND;
+    Node->Children[0] = A;
+    Node->Children[1] = B;
+    Node->Weight = Weight;
+
+    return Tree->NodeCount++;
+}
+
+/** How many scratch poses evaluating Node takes. */
+static
+unsigned int GetBlendTreeDepth(const anim_blend_tree *Tree, unsigned int Node)
+{
+    const anim_node *Blend = &Tree->Nodes[Node];
+
+    if (Blend->Type == ANIM_NODE_CLIP)
+    {
+        return 0;
+    }
+
+    // NOTE[joe] The first child goes straight into the result, the second
+    // into a scratch pose, with the rest of the scratch under it.
+    unsigned int First = GetBlendTreeDepth(Tree, Blend->Children[0]);
+    unsigned int Second = 1 + GetBlendTreeDepth(Tree, Blend->Children[1]);
+
+    return First > Second ? First : Second;
+}
+
+/** Evaluates Node of Character's tree at its Time into Result. Scratch
+ * has to have at least GetBlendTreeDepth() poses. */
+static
+void EvaluateBlendNode(anim_character *Character,
+                       unsigned int Node,
+                       anim_pose *Result,
+                       anim_pose *Scratch)
+{
+    const anim_node *Blend = &Character->Tree.Nodes[Node];
+
+    if (Blend->Type == ANIM_NODE_CLIP)
+    {
+        SampleClip(Blend->Clip,
+                   Character->Time * Blend->Speed,
+                   Character->Cursors[Node],
+                   Result);
+        return;
+    }
+
+    // NOTE[joe] A side with no weight isn't worth sampling.
+    if (Blend->Weight <= 0.0f || Blend->Weight >= 1.0f)
+    {
+        unsigned int Child = Blend->Children[Blend->Weight >= 1.0f ? 1 : 0];
+        EvaluateBlendNode(Character, Child, Result, Scratch);
+        return;
+    }
+
+    EvaluateBlendNode(Character, Blend->Children[0], Result, Scratch);
+    EvaluateBlendNode(Character, Blend->Children[1], Scratch, Scratch + 1);
+
+    BlendPoses(Result, Scratch, Blend->Weight, Result);
+}
+
+/** Characters. */
+
+/** Sets Character up to animate Skeleton through a copy of Tree, with
+ * everything it needs allocated from Arena. Only the tree's weights and
+ * speeds can change afterwards, not its shape or its clips. */
+static
+void InitializeCharacter(anim_character *Character,
+                         const anim_skeleton *Skeleton,
+                         const anim_blend_tree *Tree,
+                         memory_arena *Arena)
+{
+    Assert(Tree->NodeCount > 0, "Characters need a blend tree.\n");
+
+    Character->Skeleton = Skeleton;
+    Character->Tree = *Tree;
+    Character->Time = 0.0f;
+
+    for (unsigned int i = 0; i < Tree->NodeCount; i++)
+    {
+        const anim_node *Node = &Tree->Nodes[i];
+        Character->Cursors[i] = 0;
+
+        if (Node->Type == ANIM_NODE_CLIP)
+        {
+            unsigned int Count = Node->Clip->JointCount * ANIM_TRACK_TYPES;
+
+            Character->Cursors[i] = PushArray(Arena, unsigned short, Count);
+            memset(Character->Cursors[i], 0, Count * sizeof(unsigned short));
+        }
+    }
+
+    InitializePose(&Character->Pose, Arena, Skeleton->JointCount);
+
+    Character->ScratchCount = GetBlendTreeDepth(Tree, Tree->NodeCount - 1);
+    Character->Scratch =
+        PushArray(Arena, anim_pose, Character->ScratchCount);
+
+    for (unsigned int i = 0; i < Character->ScratchCount; i++)
+    {
+        InitializePose(&Character->Scratch[i], Arena, Skeleton->JointCount);
+    }
+
+    Character->Models = PushArray(Arena, mat4, Skeleton->JointCount);
+    Character->Palette = PushArray(Arena, mat4, Skeleton->JointCount);
+}
+
+/** Turns Pose into model space transforms, parents first, and those into
+ * the skinning palette. */
+static
+void BuildPalette(const anim_skeleton *Skeleton,
+                  const anim_pose *Pose,
+                  mat4 *Models,
+                  mat4 *Palette)
+{
+    for (unsigned int i = 0; i < Skeleton->JointCount; i++)
+    {
+        vec3 Translation;
+        quat Rotation;
+        vec3 Scale;
+        GetPoseJoint(Pose, i, &Translation, &Rotation, &Scale);
+
+        mat4 Local = Mat4FromTransform(Translation, Rotation, Scale);
+        unsigned int Parent = Skeleton->Parents[i];
+
+        if (Parent == ANIM_NO_PARENT)
+        {
+            Models[i] = Local;
+        }
+        else
+        {
+            Multiply(&Models[Parent], &Local, &Models[i]);
+        }
+
+        Multiply(&Models[i], &Skeleton->InverseBinds[i], &Palette[i]);
+    }
+}
+
+/** Evaluates Character's blend tree at its Time, through to its palette. */
+static
+void EvaluateCharacter(anim_character *Character)
+{
+    EvaluateBlendNode(Character,
+                      Character->Tree.NodeCount - 1,
+                      &Character->Pose,
+                      Character->Scratch);
+
+    BuildPalette(Character->Skeleton,
+                 &Character->Pose,
+                 Character->Models,
+                 Character->Palette);
+}
+
+static
+void EvaluateCharactersJob(void *Data, unsigned int Start, unsigned int End)
+{
+    anim_character *Characters = (anim_character *)Data;
+
+    for (unsigned int i = Start; i < End; i++)
+    {
+        EvaluateCharacter(&Characters[i]);
+    }
+}
+
+/** Evaluates Count Characters across Jobs, and waits. Characters share
+ * nothing they write, so any number of them can be evaluated at once. */
+static
+void EvaluateCharacters(job_system *Jobs,
+                        anim_character *Characters,
+                        unsigned int Count)
+{
+    ParallelForAndWait(Jobs,
+                       EvaluateCharactersJob,
+                       Characters,
+                       Count,
+                       ANIM_MIN_CHUNK);
+}
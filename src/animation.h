@@ -0,0 +1,172 @@
+/**
+ * @file animation.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the definitions for our animation runtime: compressed
+ * clips, sampling them into poses, blending poses through a blend tree, and
+ * turning the result into a skinning palette.
+ *
+ * Clips are authored as raw clips, every joint's transform at every frame,
+ * and compressed once up front. Each joint has a rotation, a translation
+ * and a scale track. A track keeps only the frames it needs for linear
+ * interpolation between them to stay within that track's tolerance, and
+ * each key is 48 bits: rotations as the smallest three components of the
+ * quaternion, translations and scales as 16 bits a component across the
+ * track's range. Every track records the worst error it ended up with.
+ * Since tracks keep different frames, finding a track's keys is a search;
+ * characters remember where each track's were last time, which when
+ * playing forward is nearly always where they still are.
+ *
+ * Poses are stored a batch of joints at a time, component by component, so
+ * decoding and blending them are straight SIMD over a batch. Characters are
+ * independent of each other, so many of them are evaluated in parallel on
+ * the job system.
+ */
+
+#ifndef _ANIMATION_H_
+#define _ANIMATION_H_
+
+#include "linear_math.h"
+
+#define ANIM_SAMPLE_RATE 30
+#define ANIM_BATCH_WIDTH MATH_BATCH_WIDTH
+
+// NOTE[joe] Key times are frame numbers, and have to fit in 16 bits.
+#define ANIM_MAX_FRAMES 65536
+
+#define ANIM_NO_PARENT 0xFFFFFFFF
+
+#define ANIM_MAX_NODES 16
+
+// NOTE[joe] Characters are much bigger units of work than a vertex, so
+// they're handed out a few at a time.
+#define ANIM_MIN_CHUNK 4
+
+typedef enum {
+    ANIM_TRACK_ROTATION = 0,
+    ANIM_TRACK_TRANSLATION,
+    ANIM_TRACK_SCALE,
+    ANIM_TRACK_TYPES,
+} anim_track_type;
+
+/** Joints are ordered so that every joint comes after its parent. */
+typedef struct {
+    unsigned int  JointCount;
+    unsigned int *Parents;
+    // NOTE[joe] Takes a point from model space in the bind pose to the
+    // joint's own space.
+    mat4         *InverseBinds;
+} anim_skeleton;
+
+/** An uncompressed clip, for authoring clips and checking compressed ones
+ * against. Indexed by Frame * JointCount + Joint. */
+typedef struct {
+    unsigned int  JointCount;
+    unsigned int  FrameCount;
+    vec3         *Translations;
+    quat         *Rotations;
+    vec3         *Scales;
+} anim_raw_clip;
+
+typedef struct {
+    unsigned int   FirstKey;
+    unsigned int   KeyCount;
+    // NOTE[joe] Translation and scale keys are Min + Step * key. Rotation
+    // keys don't need either.
+    float          Min[3];
+    float          Step[3];
+    // NOTE[joe] The furthest sampling this track at any frame gets from the
+    // raw clip, in radians for rotations and units for everything else.
+    float          MaxError;
+} anim_track;
+
+/** A compressed clip. Loops, so its last frame should match its first. */
+typedef struct {
+    unsigned int    JointCount;
+    unsigned int    FrameCount;
+    float           Duration;
+
+    // NOTE[joe] ANIM_TRACK_TYPES per joint, indexed by
+    // Joint * ANIM_TRACK_TYPES + type.
+    anim_track     *Tracks;
+
+    // NOTE[joe] Every track's keys, one track after another. Each key has
+    // a frame number and three 16 bit values.
+    unsigned int    KeyCount;
+    unsigned short *Frames;
+    unsigned short *Values;
+
+    // NOTE[joe] Everything above, in bytes.
+    size_t          Size;
+} anim_clip;
+
+/** ANIM_BATCH_WIDTH joints' local transforms, a component at a time. */
+typedef struct alignas(32) {
+    float Translations[3][ANIM_BATCH_WIDTH];
+    float Rotations[4][ANIM_BATCH_WIDTH];
+    float Scales[3][ANIM_BATCH_WIDTH];
+} anim_pose_batch;
+
+/** Every joint of a skeleton. Joints past the last one in the last batch
+ * are padding, which gets sampled and blended like the rest and ignored. */
+typedef struct {
+    unsigned int     JointCount;
+    unsigned int     BatchCount;
+    anim_pose_batch *Batches;
+} anim_pose;
+
+typedef enum {
+    ANIM_NODE_CLIP = 0,
+    ANIM_NODE_BLEND,
+} anim_node_type;
+
+typedef struct {
+    anim_node_type   Type;
+
+    /** ANIM_NODE_CLIP. */
+
+    const anim_clip *Clip;
+    // NOTE[joe] Multiplies the character's time, so clips of different
+    // lengths can be kept in step.
+    float            Speed;
+
+    /** ANIM_NODE_BLEND. */
+
+    // NOTE[joe] All of Children[0] at a Weight of zero, all of Children[1]
+    // at one.
+    unsigned int     Children[2];
+    float            Weight;
+} anim_node;
+
+/** Children always come before their parents, so the last node added is
+ * the root. */
+typedef struct {
+    unsigned int NodeCount;
+    anim_node    Nodes[ANIM_MAX_NODES];
+} anim_blend_tree;
+
+typedef struct {
+    const anim_skeleton *Skeleton;
+    anim_blend_tree      Tree;
+    float                Time;
+
+    // NOTE[joe] For each clip node in Tree, where each of its tracks found
+    // its keys last time. See SampleClip().
+    unsigned short      *Cursors[ANIM_MAX_NODES];
+
+    anim_pose            Pose;
+    // NOTE[joe] One pose for each level of blend nodes in Tree.
+    unsigned int         ScratchCount;
+    anim_pose           *Scratch;
+
+    mat4                *Models;
+    // NOTE[joe] What skinning wants: each joint's model space transform
+    // times its inverse bind.
+    mat4                *Palette;
+} anim_character;
+
+template <typename backend>
+struct anim_kernels;
+
+#endif
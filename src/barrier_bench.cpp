@@ -0,0 +1,516 @@
+/**
+ * @file barrier_bench.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the checks that keep our resource state tracker honest.
+ * None of them need a device: vkCmdPipelineBarrier() is swapped out for a
+ * function that writes down what it was asked for, and every resource is a
+ * made up handle. Each of the tracker's rules is checked on its own, barrier
+ * by barrier, and then a reference frame, which makes the same uses
+ * GameRender() does, has to come out at the barriers we worked out for it in
+ * each of the paths a frame can take. Platform layers run them with
+ * --bench-barriers, instead of the game, and exit with an error if any check
+ * fails.
+ */
+
+#include "platform.h"
+#include "render.h"
+
+#define BARRIER_BENCH_MAX_CALLS 64
+#define BARRIER_BENCH_MAX_IMAGE_BARRIERS 8
+
+// NOTE[joe] The first frame pays for every resource's first transition, so
+// it's the frames after it that are checked.
+#define BARRIER_BENCH_FRAMES 6
+
+#define BARRIER_BENCH_PRESENT_IMAGES 3
+
+typedef struct {
+    VkPipelineStageFlags SrcStages;
+    VkPipelineStageFlags DstStages;
+    VkDependencyFlags    DependencyFlags;
+    unsigned int         MemoryBarrierCount;
+    VkMemoryBarrier      MemoryBarrier;
+    unsigned int         BufferBarrierCount;
+    unsigned int         ImageBarrierCount;
+    VkImageMemoryBarrier ImageBarriers[BARRIER_BENCH_MAX_IMAGE_BARRIERS];
+} barrier_bench_call;
+
+/** Which way through GameRender() a reference frame goes, and the barriers
+ * it costs every frame once it's warmed up. */
+typedef struct {
+    const char   *Name;
+    bool          HasJoints;
+    bool          IsGpuSkinned;
+    bool          HasParticles;
+    bool          IsEmitting;
+    unsigned int  MipCount;
+    unsigned int  FlushCount;
+    unsigned int  ImageBarrierCount;
+    unsigned int  MemoryBarrierCount;
+} barrier_bench_frame;
+
+// NOTE[joe] Worked out by hand from GameRender(). Every frame flushes for
+// each of its passes: skinning, particles (two, or three when emitting),
+// both cull phases, both scene passes, a mip of the pyramid each, and the
+// present. Every one of those waits on a write, so each is a memory barrier
+// too. The images are the present image and depth going in and out of
+// attachment, and depth being sampled by the particles on its way.
+static const barrier_bench_frame BarrierBenchFrames[] = {
+    { "plain",       false, false, false, false,  3,  8, 4,  8 },
+    { "skinned",     true,  true,  false, false, 10, 16, 4, 16 },
+    { "cpu_skinned", true,  false, true,  false, 10, 18, 6, 18 },
+    { "particles",   false, false, true,  true,   5, 13, 6, 13 },
+    { "everything",  true,  true,  true,  true,  11, 20, 6, 20 },
+};
+
+// NOTE[joe] vkCmdPipelineBarrier() has nowhere for us to hang a pointer, so
+// what it was asked for goes here.
+static unsigned int BarrierBenchCallCount;
+static barrier_bench_call BarrierBenchCalls[BARRIER_BENCH_MAX_CALLS];
+
+/** Stands in for vkCmdPipelineBarrier(), and writes down the call. There's
+ * no command buffer, and the tracker never asks for a buffer barrier, so
+ * those are left unnamed. */
+static VKAPI_ATTR
+void VKAPI_CALL RecordBenchBarrier(VkCommandBuffer,
+                                   VkPipelineStageFlags SrcStages,
+                                   VkPipelineStageFlags DstStages,
+                                   VkDependencyFlags DependencyFlags,
+                                   uint32_t MemoryBarrierCount,
+                                   const VkMemoryBarrier *MemoryBarriers,
+                                   uint32_t BufferBarrierCount,
+                                   const VkBufferMemoryBarrier *,
+                                   uint32_t ImageBarrierCount,
+                                   const VkImageMemoryBarrier *ImageBarriers)
+{
+    unsigned int Index = BarrierBenchCallCount++;
+
+    if (Index >= BARRIER_BENCH_MAX_CALLS)
+    {
+        return;
+    }
+
+    barrier_bench_call *Call = &BarrierBenchCalls[Index];
+    *Call = {};
+    Call->SrcStages = SrcStages;
+    Call->DstStages = DstStages;
+    Call->DependencyFlags = DependencyFlags;
+    Call->MemoryBarrierCount = MemoryBarrierCount;
+    Call->BufferBarrierCount = BufferBarrierCount;
+    Call->ImageBarrierCount = ImageBarrierCount;
+
+    if (MemoryBarrierCount)
+    {
+        Call->MemoryBarrier = MemoryBarriers[0];
+    }
+
+    for (unsigned int i = 0;
+         i < ImageBarrierCount && i < BARRIER_BENCH_MAX_IMAGE_BARRIERS;
+         i++)
+    {
+        Call->ImageBarriers[i] = ImageBarriers[i];
+    }
+}
+
+static
+void ResetBarrierBench(resource_tracker *Tracker)
+{
+    *Tracker = {};
+    BarrierBenchCallCount = 0;
+}
+
+/** Checks each of the tracker's rules on its own: whether a use needs a
+ * barrier at all, and if it does, exactly what that barrier is. */
+static
+bool CheckBarrierBenchRules(resource_tracker *Tracker)
+{
+    VkBuffer Buffer = (VkBuffer)(uintptr_t)1;
+    VkBuffer ReadOnly = (VkBuffer)(uintptr_t)4;
+    VkImage Image = (VkImage)(uintptr_t)2;
+    VkImage Mips = (VkImage)(uintptr_t)3;
+
+    ResetBarrierBench(Tracker);
+
+    TrackBuffer(Tracker, Buffer);
+    TrackBuffer(Tracker, ReadOnly);
+    TrackImage(Tracker,
+               Image,
+               VK_IMAGE_ASPECT_COLOR_BIT,
+               1, 1,
+               VK_IMAGE_LAYOUT_UNDEFINED);
+    TrackImage(Tracker,
+               Mips,
+               VK_IMAGE_ASPECT_COLOR_BIT,
+               4, 1,
+               VK_IMAGE_LAYOUT_UNDEFINED);
+
+    barrier_bench_call *Call;
+
+    /** A buffer nothing has touched can be written without waiting. */
+
+    UseBuffer(Tracker, Buffer, RESOURCE_USAGE_COMPUTE_WRITE);
+    FlushBarriers(Tracker, 0);
+
+    bool IsFirstWriteFree = BarrierBenchCallCount == 0;
+
+    /** Reading what was written has to wait for it, and see it. */
+
+    UseBuffer(Tracker, Buffer, RESOURCE_USAGE_INDIRECT_BUFFER);
+    FlushBarriers(Tracker, 0);
+
+    Call = &BarrierBenchCalls[0];
+
+    bool IsReadAfterWrite =
+        BarrierBenchCallCount == 1 &&
+        Call->SrcStages == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT &&
+        Call->DstStages == VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT &&
+        Call->MemoryBarrierCount == 1 &&
+        (Call->MemoryBarrier.srcAccessMask & VK_ACCESS_SHADER_WRITE_BIT) &&
+        Call->MemoryBarrier.dstAccessMask ==
+            VK_ACCESS_INDIRECT_COMMAND_READ_BIT &&
+        Call->ImageBarrierCount == 0;
+
+    /** Reading it again the same way needs nothing more. */
+
+    UseBuffer(Tracker, Buffer, RESOURCE_USAGE_INDIRECT_BUFFER);
+    FlushBarriers(Tracker, 0);
+
+    bool IsReadAfterReadFree = BarrierBenchCallCount == 1;
+
+    /** Writing over a buffer that's only been read just has to wait for the
+     * reads to finish, since there's no write of its own to make visible. */
+
+    UseBuffer(Tracker, ReadOnly, RESOURCE_USAGE_INDIRECT_BUFFER);
+    FlushBarriers(Tracker, 0);
+    UseBuffer(Tracker, ReadOnly, RESOURCE_USAGE_COMPUTE_WRITE);
+    FlushBarriers(Tracker, 0);
+
+    Call = &BarrierBenchCalls[1];
+
+    bool IsWriteAfterRead =
+        BarrierBenchCallCount == 2 &&
+        Call->SrcStages == VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT &&
+        Call->DstStages == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT &&
+        Call->MemoryBarrierCount == 0 &&
+        Call->ImageBarrierCount == 0;
+
+    /** A new layout is an image barrier, from the top of the pipe for an
+     * image nothing has used yet. */
+
+    UseImage(Tracker, Image, RESOURCE_USAGE_COLOR_ATTACHMENT);
+    FlushBarriers(Tracker, 0);
+
+    Call = &BarrierBenchCalls[2];
+
+    bool IsLayoutChange =
+        BarrierBenchCallCount == 3 &&
+        Call->SrcStages == VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT &&
+        Call->DstStages == VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT &&
+        Call->MemoryBarrierCount == 0 &&
+        Call->ImageBarrierCount == 1 &&
+        Call->ImageBarriers[0].image == Image &&
+        Call->ImageBarriers[0].oldLayout == VK_IMAGE_LAYOUT_UNDEFINED &&
+        Call->ImageBarriers[0].newLayout ==
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    /** Mips going the same way share a barrier, and a subresource used
+     * twice before a flush is only transitioned once, to its last use. */
+
+    UseImage(Tracker, Mips, RESOURCE_USAGE_COMPUTE_SAMPLED);
+    UseImage(Tracker, Mips, RESOURCE_USAGE_COMPUTE_READ);
+    FlushBarriers(Tracker, 0);
+
+    Call = &BarrierBenchCalls[3];
+
+    bool IsMerged =
+        BarrierBenchCallCount == 4 &&
+        Call->ImageBarrierCount == 1 &&
+        Call->ImageBarriers[0].subresourceRange.baseMipLevel == 0 &&
+        Call->ImageBarriers[0].subresourceRange.levelCount == 4 &&
+        Call->ImageBarriers[0].oldLayout == VK_IMAGE_LAYOUT_UNDEFINED &&
+        Call->ImageBarriers[0].newLayout == VK_IMAGE_LAYOUT_GENERAL;
+
+    /** A mip written and then read in GENERAL, the way the pyramid is
+     * built, needs a memory barrier, but no image barrier. */
+
+    UseImageMips(Tracker, Mips, RESOURCE_USAGE_COMPUTE_WRITE, 1, 1);
+    FlushBarriers(Tracker, 0);
+    UseImageMips(Tracker, Mips, RESOURCE_USAGE_COMPUTE_READ, 1, 1);
+    FlushBarriers(Tracker, 0);
+
+    Call = &BarrierBenchCalls[5];
+
+    bool IsSameLayoutMemory =
+        BarrierBenchCallCount == 6 &&
+        Call->SrcStages == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT &&
+        Call->DstStages == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT &&
+        Call->MemoryBarrierCount == 1 &&
+        (Call->MemoryBarrier.srcAccessMask & VK_ACCESS_SHADER_WRITE_BIT) &&
+        (Call->MemoryBarrier.dstAccessMask & VK_ACCESS_SHADER_READ_BIT) &&
+        Call->ImageBarrierCount == 0;
+
+    printf("barrier_first_write_free %d\n", IsFirstWriteFree ? 1 : 0);
+    printf("barrier_read_after_write %d\n", IsReadAfterWrite ? 1 : 0);
+    printf("barrier_read_after_read_free %d\n", IsReadAfterReadFree ? 1 : 0);
+    printf("barrier_write_after_read %d\n", IsWriteAfterRead ? 1 : 0);
+    printf("barrier_layout_change %d\n", IsLayoutChange ? 1 : 0);
+    printf("barrier_mips_merged %d\n", IsMerged ? 1 : 0);
+    printf("barrier_same_layout_memory %d\n", IsSameLayoutMemory ? 1 : 0);
+
+    return IsFirstWriteFree &&
+           IsReadAfterWrite &&
+           IsReadAfterReadFree &&
+           IsWriteAfterRead &&
+           IsLayoutChange &&
+           IsMerged &&
+           IsSameLayoutMemory;
+}
+
+/** Makes the uses GameRender() makes on a frame that goes Frame's way,
+ * presenting PresentImage, and flushes wherever it flushes. */
+static
+void RecordBarrierBenchFrame(resource_tracker *Tracker,
+                             const barrier_bench_frame *Frame,
+                             VkImage PresentImage)
+{
+    VkImage Depth = (VkImage)(uintptr_t)10;
+    VkImage Pyramid = (VkImage)(uintptr_t)11;
+    VkBuffer VertexInput = (VkBuffer)(uintptr_t)20;
+    VkBuffer Source = (VkBuffer)(uintptr_t)21;
+    VkBuffer Skinned = (VkBuffer)(uintptr_t)22;
+    VkBuffer ParticleArgs = (VkBuffer)(uintptr_t)23;
+    VkBuffer Pool = (VkBuffer)(uintptr_t)24;
+    VkBuffer Dead = (VkBuffer)(uintptr_t)25;
+    VkBuffer Alive = (VkBuffer)(uintptr_t)26;
+    VkBuffer Counter = (VkBuffer)(uintptr_t)27;
+    VkBuffer Visibility = (VkBuffer)(uintptr_t)28;
+    VkBuffer CullArgs = (VkBuffer)(uintptr_t)29;
+    VkBuffer CullStats = (VkBuffer)(uintptr_t)30;
+
+    AcquireImage(Tracker,
+                 PresentImage,
+                 VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+    /** RecordSkinning() */
+
+    if (Frame->HasJoints && Frame->IsGpuSkinned)
+    {
+        UseBuffer(Tracker, Source, RESOURCE_USAGE_COMPUTE_READ);
+        UseBuffer(Tracker, Skinned, RESOURCE_USAGE_COMPUTE_WRITE);
+        FlushBarriers(Tracker, 0);
+    }
+    else if (Frame->HasJoints)
+    {
+        UseBuffer(Tracker, Skinned, RESOURCE_USAGE_TRANSFER_DST);
+        FlushBarriers(Tracker, 0);
+    }
+
+    /** RecordParticles() */
+
+    if (Frame->HasParticles)
+    {
+        UseBuffer(Tracker, ParticleArgs, RESOURCE_USAGE_INDIRECT_BUFFER);
+        UseBuffer(Tracker, Pool, RESOURCE_USAGE_COMPUTE_WRITE);
+        UseBuffer(Tracker, Dead, RESOURCE_USAGE_COMPUTE_WRITE);
+        UseBuffer(Tracker, Alive, RESOURCE_USAGE_COMPUTE_WRITE);
+        UseBuffer(Tracker, Counter, RESOURCE_USAGE_COMPUTE_WRITE);
+        UseImage(Tracker, Depth, RESOURCE_USAGE_COMPUTE_SAMPLED);
+        FlushBarriers(Tracker, 0);
+
+        if (Frame->IsEmitting)
+        {
+            UseBuffer(Tracker, Pool, RESOURCE_USAGE_COMPUTE_WRITE);
+            UseBuffer(Tracker, Dead, RESOURCE_USAGE_COMPUTE_WRITE);
+            UseBuffer(Tracker, Alive, RESOURCE_USAGE_COMPUTE_WRITE);
+            UseBuffer(Tracker, Counter, RESOURCE_USAGE_COMPUTE_WRITE);
+            FlushBarriers(Tracker, 0);
+        }
+
+        UseBuffer(Tracker, Counter, RESOURCE_USAGE_COMPUTE_WRITE);
+        UseBuffer(Tracker, ParticleArgs, RESOURCE_USAGE_COMPUTE_WRITE);
+        FlushBarriers(Tracker, 0);
+    }
+
+    /** RecordCullPass() and the first scene pass. */
+
+    UseBuffer(Tracker, Visibility, RESOURCE_USAGE_COMPUTE_READ);
+    UseBuffer(Tracker, CullArgs, RESOURCE_USAGE_COMPUTE_WRITE);
+    UseBuffer(Tracker, CullStats, RESOURCE_USAGE_COMPUTE_WRITE);
+    UseImage(Tracker, Pyramid, RESOURCE_USAGE_COMPUTE_READ);
+    FlushBarriers(Tracker, 0);
+
+    UseBuffer(Tracker, CullArgs, RESOURCE_USAGE_INDIRECT_BUFFER);
+    UseBuffer(Tracker, VertexInput, RESOURCE_USAGE_VERTEX_BUFFER);
+    UseBuffer(Tracker, Skinned, RESOURCE_USAGE_VERTEX_BUFFER);
+    UseImage(Tracker, PresentImage, RESOURCE_USAGE_COLOR_ATTACHMENT);
+    UseImage(Tracker, Depth, RESOURCE_USAGE_DEPTH_ATTACHMENT);
+    FlushBarriers(Tracker, 0);
+
+    /** RecordDepthPyramid() */
+
+    for (unsigned int Mip = 0; Mip < Frame->MipCount; Mip++)
+    {
+        if (Mip == 0)
+        {
+            UseImage(Tracker, Depth, RESOURCE_USAGE_COMPUTE_SAMPLED);
+        }
+        else
+        {
+            UseImageMips(Tracker,
+                         Pyramid,
+                         RESOURCE_USAGE_COMPUTE_READ,
+                         Mip - 1,
+                         1);
+        }
+
+        UseImageMips(Tracker, Pyramid, RESOURCE_USAGE_COMPUTE_WRITE, Mip, 1);
+        FlushBarriers(Tracker, 0);
+    }
+
+    /** RecordCullPass() again, and the second scene pass. */
+
+    UseBuffer(Tracker, Visibility, RESOURCE_USAGE_COMPUTE_WRITE);
+    UseBuffer(Tracker, CullArgs, RESOURCE_USAGE_COMPUTE_WRITE);
+    UseBuffer(Tracker, CullStats, RESOURCE_USAGE_COMPUTE_WRITE);
+    UseImage(Tracker, Pyramid, RESOURCE_USAGE_COMPUTE_READ);
+    FlushBarriers(Tracker, 0);
+
+    UseBuffer(Tracker, CullArgs, RESOURCE_USAGE_INDIRECT_BUFFER);
+
+    if (Frame->HasParticles)
+    {
+        UseBuffer(Tracker, ParticleArgs, RESOURCE_USAGE_INDIRECT_BUFFER);
+        UseBuffer(Tracker, Pool, RESOURCE_USAGE_VERTEX_READ);
+        UseBuffer(Tracker, Alive, RESOURCE_USAGE_VERTEX_READ);
+    }
+
+    UseImage(Tracker, PresentImage, RESOURCE_USAGE_COLOR_ATTACHMENT);
+    UseImage(Tracker, Depth, RESOURCE_USAGE_DEPTH_ATTACHMENT);
+    FlushBarriers(Tracker, 0);
+
+    /** The present. */
+
+    UseImage(Tracker, PresentImage, RESOURCE_USAGE_PRESENT);
+    UseBuffer(Tracker, CullStats, RESOURCE_USAGE_HOST_READ);
+    UseBuffer(Tracker, Visibility, RESOURCE_USAGE_HOST_READ);
+    FlushBarriers(Tracker, 0);
+}
+
+/** Renders a few reference frames the way Frame says, and checks every one
+ * after the first comes out at Frame's barriers. */
+static
+bool CheckBarrierBenchFrame(resource_tracker *Tracker,
+                            const barrier_bench_frame *Frame)
+{
+    ResetBarrierBench(Tracker);
+
+    VkImage PresentImages[BARRIER_BENCH_PRESENT_IMAGES];
+
+    for (unsigned int i = 0; i < BARRIER_BENCH_PRESENT_IMAGES; i++)
+    {
+        PresentImages[i] = (VkImage)(uintptr_t)(i + 1);
+
+        TrackImage(Tracker,
+                   PresentImages[i],
+                   VK_IMAGE_ASPECT_COLOR_BIT,
+                   1, 1,
+                   VK_IMAGE_LAYOUT_UNDEFINED);
+    }
+
+    TrackImage(Tracker,
+               (VkImage)(uintptr_t)10,
+               VK_IMAGE_ASPECT_DEPTH_BIT,
+               1, 1,
+               VK_IMAGE_LAYOUT_UNDEFINED);
+    TrackImage(Tracker,
+               (VkImage)(uintptr_t)11,
+               VK_IMAGE_ASPECT_COLOR_BIT,
+               Frame->MipCount, 1,
+               VK_IMAGE_LAYOUT_UNDEFINED);
+
+    for (unsigned int i = 20; i <= 30; i++)
+    {
+        TrackBuffer(Tracker, (VkBuffer)(uintptr_t)i);
+    }
+
+    bool IsCorrect = true;
+    resource_barrier_stats Stats = {};
+
+    for (unsigned int i = 0; i < BARRIER_BENCH_FRAMES; i++)
+    {
+        Tracker->Stats = {};
+        BarrierBenchCallCount = 0;
+
+        VkImage PresentImage = PresentImages[i % BARRIER_BENCH_PRESENT_IMAGES];
+
+        RecordBarrierBenchFrame(Tracker, Frame, PresentImage);
+
+        Stats = Tracker->Stats;
+
+        if (i > 0)
+        {
+            IsCorrect &= Stats.FlushCount == Frame->FlushCount &&
+                         Stats.ImageBarrierCount == Frame->ImageBarrierCount &&
+                         Stats.MemoryBarrierCount == Frame->MemoryBarrierCount;
+        }
+
+        /** Every call has to be one Vulkan would take: stages on both
+         * sides, and buffers folded into the memory barrier. */
+
+        IsCorrect &= BarrierBenchCallCount <= BARRIER_BENCH_MAX_CALLS;
+
+        for (unsigned int j = 0;
+             j < BarrierBenchCallCount && j < BARRIER_BENCH_MAX_CALLS;
+             j++)
+        {
+            barrier_bench_call *Call = &BarrierBenchCalls[j];
+
+            IsCorrect &= Call->SrcStages != 0 &&
+                         Call->DstStages != 0 &&
+                         Call->DependencyFlags == 0 &&
+                         Call->BufferBarrierCount == 0 &&
+                         Call->ImageBarrierCount <=
+                             BARRIER_BENCH_MAX_IMAGE_BARRIERS;
+        }
+    }
+
+    printf("barrier_frame_%s %u/%u/%u %d\n",
+           Frame->Name,
+           Stats.FlushCount,
+           Stats.ImageBarrierCount,
+           Stats.MemoryBarrierCount,
+           IsCorrect ? 1 : 0);
+
+    return IsCorrect;
+}
+
+static
+bool BenchmarkBarriers()
+{
+    resource_tracker *Tracker = new resource_tracker;
+
+    // NOTE[joe] Whatever the platform loaded goes back once we're done, in
+    // case anything after us wants the real one.
+    PFN_vkCmdPipelineBarrier CmdPipelineBarrier = vkCmdPipelineBarrier;
+    vkCmdPipelineBarrier = RecordBenchBarrier;
+
+    bool IsCorrect = CheckBarrierBenchRules(Tracker);
+
+    unsigned int FrameCount =
+        sizeof(BarrierBenchFrames) / sizeof(BarrierBenchFrames[0]);
+
+    for (unsigned int i = 0; i < FrameCount; i++)
+    {
+        IsCorrect &= CheckBarrierBenchFrame(Tracker, &BarrierBenchFrames[i]);
+    }
+
+    vkCmdPipelineBarrier = CmdPipelineBarrier;
+
+    printf("barrier_correct %d\n", IsCorrect ? 1 : 0);
+
+    delete Tracker;
+
+    return IsCorrect;
+}
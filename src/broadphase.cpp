@@ -0,0 +1,1062 @@
+/**
+ * @file broadphase.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains our collision broadphase: keeping bodies sorted, fitting
+ * a grid to them and putting them into its cells, the SIMD kernels that sweep
+ * a cell, and doing all of that across the job system. See broadphase.h.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "job.h"
+#include "broadphase.h"
+
+// NOTE[joe] If the incremental sort has moved bodies this many places each
+// on average, they've jumped around too much for it; it gives up and the
+// bodies are sorted from scratch instead. It checks as it goes, with some
+// slack for the first few, so it finds out early rather than after doing
+// most of the work for nothing.
+#define BROADPHASE_MAX_MOVES_PER_BODY 8
+#define BROADPHASE_MOVE_SLACK 1024
+
+// NOTE[joe] How many bodies ahead the sort fetches boxes.
+#define BROADPHASE_PREFETCH 128
+
+/** Where a cell is writing its pairs. */
+typedef struct {
+    broadphase       *Broadphase;
+    broadphase_cell  *Cell;
+    unsigned int      CellY;
+    unsigned int      CellZ;
+    broadphase_block *Block;
+    broadphase_pair  *Cursor;
+    broadphase_pair  *End;
+} broadphase_writer;
+
+template <typename backend>
+struct broadphase_kernels;
+
+/** Value as an integer that sorts the same way floats do: negatives are
+ * flipped all the way round, and positives are moved over the top of them.
+ * Zero and negative zero come out different, which is fine, as long as
+ * everything sorts by the same keys. */
+static inline
+unsigned int GetBroadphaseKey(float Value)
+{
+    unsigned int Bits;
+    memcpy(&Bits, &Value, sizeof(Bits));
+
+    return (Bits & 0x80000000) ? ~Bits : Bits | 0x80000000;
+}
+
+/** Which of CellCount cells Value is in, along one side of the grid.
+ * Anything off the grid is in the cell at that edge. */
+static inline
+unsigned int GetBroadphaseCell(float Value,
+                               float Origin,
+                               float Scale,
+                               unsigned int CellCount)
+{
+    float Cell = (Value - Origin) * Scale;
+
+    // NOTE[joe] Written so NaNs end up in the first cell.
+    if (!(Cell > 0.0f))
+    {
+        return 0;
+    }
+
+    if (Cell >= (float)CellCount)
+    {
+        return CellCount - 1;
+    }
+
+    return (unsigned int)Cell;
+}
+
+/** Sets Writer's block's count, and adds it to the cell's. */
+static inline
+void FinishBroadphaseBlock(broadphase_writer *Writer)
+{
+    broadphase_block *Block = Writer->Block;
+
+    if (Block)
+    {
+        Block->Count = (unsigned int)(Writer->Cursor - Block->Pairs);
+        Writer->Cell->PairCount += Block->Count;
+    }
+
+    Writer->Block = 0;
+    Writer->Cursor = 0;
+    Writer->End = 0;
+}
+
+/** Moves Writer on to a new block. Returns false if there aren't any left. */
+static
+bool GrowBroadphaseWriter(broadphase_writer *Writer)
+{
+    broadphase *Broadphase = Writer->Broadphase;
+    broadphase_cell *Cell = Writer->Cell;
+
+    FinishBroadphaseBlock(Writer);
+
+    // NOTE[joe] Checked first, so that once blocks have run out, cells
+    // dropping pairs don't all fight over the count.
+    if (Broadphase->UsedBlockCount.load(std::memory_order_relaxed) >=
+        Broadphase->BlockCount)
+    {
+        return false;
+    }
+
+    unsigned int Index =
+        Broadphase->UsedBlockCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (Index >= Broadphase->BlockCount)
+    {
+        return false;
+    }
+
+    broadphase_block *Block = &Broadphase->Blocks[Index];
+    Block->Count = 0;
+    Block->Next = BROADPHASE_NO_BLOCK;
+
+    if (Cell->LastBlock == BROADPHASE_NO_BLOCK)
+    {
+        Cell->FirstBlock = Index;
+    }
+    else
+    {
+        Broadphase->Blocks[Cell->LastBlock].Next = Index;
+    }
+
+    Cell->LastBlock = Index;
+
+    Writer->Block = Block;
+    Writer->Cursor = Block->Pairs;
+    Writer->End = Block->Pairs + BROADPHASE_BLOCK_SIZE;
+
+    return true;
+}
+
+/** Writes a pair for entries i and j, whose boxes overlap, if this is the
+ * cell that keeps it: the one with the low corner of the overlap in y and
+ * z, which is in every cell the pair shares. */
+static inline
+void WriteBroadphasePair(broadphase_writer *Writer,
+                         unsigned int i,
+                         unsigned int j)
+{
+    broadphase *Broadphase = Writer->Broadphase;
+
+    float MinYi = Broadphase->EntryMinY[i];
+    float MinYj = Broadphase->EntryMinY[j];
+    float MinZi = Broadphase->EntryMinZ[i];
+    float MinZj = Broadphase->EntryMinZ[j];
+
+    unsigned int CellY = GetBroadphaseCell(MinYi > MinYj ? MinYi : MinYj,
+                                           Broadphase->CellOriginY,
+                                           Broadphase->CellScaleY,
+                                           Broadphase->CellCountY);
+    unsigned int CellZ = GetBroadphaseCell(MinZi > MinZj ? MinZi : MinZj,
+                                           Broadphase->CellOriginZ,
+                                           Broadphase->CellScaleZ,
+                                           Broadphase->CellCountZ);
+
+    if (CellY != Writer->CellY || CellZ != Writer->CellZ)
+    {
+        return;
+    }
+
+    if (Writer->Cursor == Writer->End && !GrowBroadphaseWriter(Writer))
+    {
+        Writer->Cell->DroppedCount++;
+        return;
+    }
+
+    unsigned int A = Broadphase->EntryBodies[i];
+    unsigned int B = Broadphase->EntryBodies[j];
+
+    broadphase_pair *Pair = Writer->Cursor++;
+    Pair->A = A < B ? A : B;
+    Pair->B = A < B ? B : A;
+}
+
+/** Writes a pair between entry i and each of the entries from j on that
+ * has its bit set in Hits. */
+static inline
+void WriteBroadphaseHits(broadphase_writer *Writer,
+                         unsigned int i,
+                         unsigned int j,
+                         unsigned int Hits)
+{
+    for (unsigned int k = 0; Hits; k++, Hits >>= 1)
+    {
+        if (Hits & 1)
+        {
+            WriteBroadphasePair(Writer, i, j + k);
+        }
+    }
+}
+
+/** Sweeps entries [Start, End) against the rest of their cell's, one at a
+ * time. Every other backend is checked against this one. */
+template <>
+struct broadphase_kernels<math_scalar> {
+    static inline
+    void Sweep(broadphase *Broadphase,
+               unsigned int Start,
+               unsigned int End,
+               broadphase_writer *Writer)
+    {
+        const float *MinX = Broadphase->EntryMinX;
+        const float *MinY = Broadphase->EntryMinY;
+        const float *MinZ = Broadphase->EntryMinZ;
+        const float *MaxY = Broadphase->EntryMaxY;
+        const float *MaxZ = Broadphase->EntryMaxZ;
+
+        for (unsigned int i = Start; i < End; i++)
+        {
+            float MaxX = Broadphase->EntryMaxX[i];
+
+            // NOTE[joe] Ends at the cell's sentinels, at the latest.
+            for (unsigned int j = i + 1; MinX[j] <= MaxX; j++)
+            {
+                if (MinY[j] <= MaxY[i] && MaxY[j] >= MinY[i] &&
+                    MinZ[j] <= MaxZ[i] && MaxZ[j] >= MinZ[i])
+                {
+                    WriteBroadphasePair(Writer, i, j);
+                }
+            }
+        }
+    }
+};
+
+#if MATH_HAS_SSE
+
+/** Four of the entries that follow at a time. */
+template <>
+struct broadphase_kernels<math_sse> {
+    static inline
+    void Sweep(broadphase *Broadphase,
+               unsigned int Start,
+               unsigned int End,
+               broadphase_writer *Writer)
+    {
+        const float *MinX = Broadphase->EntryMinX;
+        const float *MinY = Broadphase->EntryMinY;
+        const float *MinZ = Broadphase->EntryMinZ;
+        const float *MaxY = Broadphase->EntryMaxY;
+        const float *MaxZ = Broadphase->EntryMaxZ;
+
+        for (unsigned int i = Start; i < End; i++)
+        {
+            __m128 MaxXi = _mm_set1_ps(Broadphase->EntryMaxX[i]);
+            __m128 MinYi = _mm_set1_ps(MinY[i]);
+            __m128 MaxYi = _mm_set1_ps(MaxY[i]);
+            __m128 MinZi = _mm_set1_ps(MinZ[i]);
+            __m128 MaxZi = _mm_set1_ps(MaxZ[i]);
+
+            for (unsigned int j = i + 1;; j += 4)
+            {
+                __m128 InRange = _mm_cmple_ps(_mm_loadu_ps(&MinX[j]), MaxXi);
+                __m128 Y = _mm_and_ps(
+                    _mm_cmple_ps(_mm_loadu_ps(&MinY[j]), MaxYi),
+                    _mm_cmpge_ps(_mm_loadu_ps(&MaxY[j]), MinYi));
+                __m128 Z = _mm_and_ps(
+                    _mm_cmple_ps(_mm_loadu_ps(&MinZ[j]), MaxZi),
+                    _mm_cmpge_ps(_mm_loadu_ps(&MaxZ[j]), MinZi));
+
+                unsigned int Hits = (unsigned int)_mm_movemask_ps(
+                    _mm_and_ps(InRange, _mm_and_ps(Y, Z)));
+
+                if (Hits)
+                {
+                    WriteBroadphaseHits(Writer, i, j, Hits);
+                }
+
+                // NOTE[joe] Sorted, so once one is out of range, so is
+                // everything after it.
+                if (_mm_movemask_ps(InRange) != 0xF)
+                {
+                    break;
+                }
+            }
+        }
+    }
+};
+
+#endif
+
+#if MATH_HAS_AVX2
+
+/** Eight of the entries that follow at a time. */
+template <>
+struct broadphase_kernels<math_avx2> {
+    static inline
+    void Sweep(broadphase *Broadphase,
+               unsigned int Start,
+               unsigned int End,
+               broadphase_writer *Writer)
+    {
+        const float *MinX = Broadphase->EntryMinX;
+        const float *MinY = Broadphase->EntryMinY;
+        const float *MinZ = Broadphase->EntryMinZ;
+        const float *MaxY = Broadphase->EntryMaxY;
+        const float *MaxZ = Broadphase->EntryMaxZ;
+
+        for (unsigned int i = Start; i < End; i++)
+        {
+            __m256 MaxXi = _mm256_set1_ps(Broadphase->EntryMaxX[i]);
+            __m256 MinYi = _mm256_set1_ps(MinY[i]);
+            __m256 MaxYi = _mm256_set1_ps(MaxY[i]);
+            __m256 MinZi = _mm256_set1_ps(MinZ[i]);
+            __m256 MaxZi = _mm256_set1_ps(MaxZ[i]);
+
+            for (unsigned int j = i + 1;; j += 8)
+            {
+                __m256 InRange = _mm256_cmp_ps(_mm256_loadu_ps(&MinX[j]),
+                                               MaxXi,
+                                               _CMP_LE_OQ);
+                __m256 Y = _mm256_and_ps(
+                    _mm256_cmp_ps(_mm256_loadu_ps(&MinY[j]),
+                                  MaxYi,
+                                  _CMP_LE_OQ),
+                    _mm256_cmp_ps(_mm256_loadu_ps(&MaxY[j]),
+                                  MinYi,
+                                  _CMP_GE_OQ));
+                __m256 Z = _mm256_and_ps(
+                    _mm256_cmp_ps(_mm256_loadu_ps(&MinZ[j]),
+                                  MaxZi,
+                                  _CMP_LE_OQ),
+                    _mm256_cmp_ps(_mm256_loadu_ps(&MaxZ[j]),
+                                  MinZi,
+                                  _CMP_GE_OQ));
+
+                unsigned int Hits = (unsigned int)_mm256_movemask_ps(
+                    _mm256_and_ps(InRange, _mm256_and_ps(Y, Z)));
+
+                if (Hits)
+                {
+                    WriteBroadphaseHits(Writer, i, j, Hits);
+                }
+
+                if (_mm256_movemask_ps(InRange) != 0xFF)
+                {
+                    break;
+                }
+            }
+        }
+    }
+};
+
+#endif
+
+// NOTE[joe] NEON goes through the scalar kernel for now.
+#if MATH_HAS_AVX2
+typedef math_avx2 broadphase_backend;
+#elif MATH_HAS_SSE
+typedef math_sse broadphase_backend;
+#else
+typedef math_scalar broadphase_backend;
+#endif
+
+/** Room for MaxCount bodies and at least MaxPairCount pairs, allocated from
+ * Arena. */
+static
+void InitializeBroadphase(broadphase *Broadphase,
+                          memory_arena *Arena,
+                          unsigned int MaxCount,
+                          unsigned int MaxPairCount)
+{
+    Broadphase->MaxCount = MaxCount;
+    Broadphase->Count = 0;
+
+    Broadphase->Boxes = PushArray(Arena, broadphase_box, MaxCount);
+
+    Broadphase->Order = PushArray(Arena, unsigned int, MaxCount);
+    Broadphase->Keys = PushArray(Arena, unsigned int, MaxCount);
+    Broadphase->SortItems = PushArray(Arena, unsigned long long, MaxCount);
+    Broadphase->TempItems = PushArray(Arena, unsigned long long, MaxCount);
+    Broadphase->IsUnsorted = false;
+
+    Broadphase->CellCountY = 1;
+    Broadphase->CellCountZ = 1;
+    Broadphase->Cells =
+        PushArray(Arena, broadphase_cell, BROADPHASE_MAX_CELLS);
+
+    Broadphase->Sorted = PushArray(Arena, broadphase_entry, MaxCount);
+    Broadphase->CellRanges = PushArray(Arena, unsigned int, MaxCount);
+
+    Broadphase->ChunkCount = 0;
+    Broadphase->ChunkSize = 0;
+    Broadphase->ChunkCursors =
+        PushArray(Arena,
+                  unsigned int,
+                  BROADPHASE_MAX_CHUNKS * BROADPHASE_MAX_CELLS);
+
+    Broadphase->MaxEntryCount =
+        MaxCount * BROADPHASE_CELLS_PER_BODY +
+        BROADPHASE_MAX_CELLS * BROADPHASE_PADDING;
+    Broadphase->EntryCount = 0;
+
+    Broadphase->Entries =
+        PushArray(Arena, broadphase_entry, Broadphase->MaxEntryCount);
+
+    // NOTE[joe] Cache line aligned, like ECS columns, so no two arrays
+    // share a line.
+    size_t EntrySize = sizeof(float) * Broadphase->MaxEntryCount;
+
+    Broadphase->EntryMinX = (float *)PushSize(Arena, EntrySize, 64);
+    Broadphase->EntryMinY = (float *)PushSize(Arena, EntrySize, 64);
+    Broadphase->EntryMinZ = (float *)PushSize(Arena, EntrySize, 64);
+    Broadphase->EntryMaxX = (float *)PushSize(Arena, EntrySize, 64);
+    Broadphase->EntryMaxY = (float *)PushSize(Arena, EntrySize, 64);
+    Broadphase->EntryMaxZ = (float *)PushSize(Arena, EntrySize, 64);
+    Broadphase->EntryBodies =
+        PushArray(Arena, unsigned int, Broadphase->MaxEntryCount);
+
+    // NOTE[joe] Every cell's last block can be partly empty, so there's one
+    // extra for each of them.
+    Broadphase->BlockCount =
+        (MaxPairCount + BROADPHASE_BLOCK_SIZE - 1) / BROADPHASE_BLOCK_SIZE +
+        BROADPHASE_MAX_CELLS;
+    Broadphase->Blocks =
+        PushArray(Arena, broadphase_block, Broadphase->BlockCount);
+    Broadphase->UsedBlockCount.store(0);
+
+    Broadphase->MaxPairCount = Broadphase->BlockCount * BROADPHASE_BLOCK_SIZE;
+    Broadphase->Pairs =
+        PushArray(Arena, broadphase_pair, Broadphase->MaxPairCount);
+    Broadphase->PairCount = 0;
+    Broadphase->DroppedCount = 0;
+    Broadphase->SortMoveCount = 0;
+    Broadphase->WasSortedFromScratch = false;
+}
+
+/** Gives Body a box from Min to Max. It takes effect on the next update. */
+static
+void SetBroadphaseBox(broadphase *Broadphase,
+                      unsigned int Body,
+                      vec3 Min,
+                      vec3 Max)
+{
+    broadphase_box *Box = &Broadphase->Boxes[Body];
+    Box->Min = Min;
+    Box->Max = Max;
+}
+
+/** Adds a body with a box from Min to Max, and returns it. Bodies are
+ * numbered from zero, in the order they're added. */
+static
+unsigned int AddBroadphaseBody(broadphase *Broadphase, vec3 Min, vec3 Max)
+{
+    Assert(Broadphase->Count < Broadphase->MaxCount,
+           "Too many broadphase bodies.\n");
+
+    unsigned int Body = Broadphase->Count++;
+
+    SetBroadphaseBox(Broadphase, Body, Min, Max);
+
+    Broadphase->IsUnsorted = true;
+
+    return Body;
+}
+
+/** Copies Body's box into the i'th place in sorted order. */
+static inline
+void SetBroadphaseSorted(broadphase *Broadphase,
+                         unsigned int i,
+                         unsigned int Body,
+                         const broadphase_box *Box)
+{
+    broadphase_entry *Entry = &Broadphase->Sorted[i];
+    Entry->Min = Box->Min;
+    Entry->Body = Body;
+    Entry->Max = Box->Max;
+    Entry->Padding = 0;
+}
+
+/** Radix sorts every body by key, eight bits at a time, then copies boxes
+ * into sorted order. Starts from bodies in order, and each pass keeps the
+ * order of equal keys, so bodies with the same key stay in order too. */
+static
+void SortBroadphaseFromScratch(broadphase *Broadphase)
+{
+    unsigned int Count = Broadphase->Count;
+    unsigned long long *Items = Broadphase->SortItems;
+    unsigned long long *TempItems = Broadphase->TempItems;
+
+    // NOTE[joe] Every pass's digits are counted up front, in one go.
+    unsigned int Offsets[4][256] = {};
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        unsigned int Key = GetBroadphaseKey(Broadphase->Boxes[i].Min.x);
+
+        Items[i] = (unsigned long long)Key << 32 | i;
+
+        Offsets[0][Key & 0xFF]++;
+        Offsets[1][(Key >> 8) & 0xFF]++;
+        Offsets[2][(Key >> 16) & 0xFF]++;
+        Offsets[3][Key >> 24]++;
+    }
+
+    for (unsigned int Pass = 0; Pass < 4; Pass++)
+    {
+        unsigned int Shift = 32 + Pass * 8;
+
+        // NOTE[joe] Every key has the same digit here, as the top one often
+        // does when everything's in the same part of the world. The pass
+        // wouldn't move anything.
+        if (Offsets[Pass][(Items[0] >> Shift) & 0xFF] == Count)
+        {
+            continue;
+        }
+
+        unsigned int Total = 0;
+
+        for (unsigned int Digit = 0; Digit < 256; Digit++)
+        {
+            unsigned int DigitCount = Offsets[Pass][Digit];
+            Offsets[Pass][Digit] = Total;
+            Total += DigitCount;
+        }
+
+        for (unsigned int i = 0; i < Count; i++)
+        {
+            unsigned long long Item = Items[i];
+            TempItems[Offsets[Pass][(Item >> Shift) & 0xFF]++] = Item;
+        }
+
+        unsigned long long *Swap = Items;
+        Items = TempItems;
+        TempItems = Swap;
+    }
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+#if MATH_HAS_SSE
+        if (i + BROADPHASE_PREFETCH < Count)
+        {
+            unsigned int Next = (unsigned int)Items[i + BROADPHASE_PREFETCH];
+
+            _mm_prefetch((const char *)&Broadphase->Boxes[Next], _MM_HINT_T0);
+        }
+#endif
+
+        unsigned int Body = (unsigned int)Items[i];
+
+        Broadphase->Keys[i] = (unsigned int)(Items[i] >> 32);
+        Broadphase->Order[i] = Body;
+
+        SetBroadphaseSorted(Broadphase, i, Body, &Broadphase->Boxes[Body]);
+    }
+
+    Broadphase->WasSortedFromScratch = true;
+}
+
+/** Insertion sorts last frame's order by this frame's keys, copying boxes
+ * into sorted order as it goes, so each one is only fetched once. Returns
+ * false, with bodies in some other order, if it had to move them too far. */
+static
+bool SortBroadphaseIncrementally(broadphase *Broadphase)
+{
+    unsigned int Count = Broadphase->Count;
+    unsigned int *Order = Broadphase->Order;
+    unsigned int *Keys = Broadphase->Keys;
+    broadphase_entry *Sorted = Broadphase->Sorted;
+
+    unsigned long long MoveCount = 0;
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+#if MATH_HAS_SSE
+        // NOTE[joe] Boxes are all over the place, and fetching them is
+        // nearly all this costs. Nothing past i has moved yet, so it's
+        // known which ones are coming.
+        if (i + BROADPHASE_PREFETCH < Count)
+        {
+            unsigned int Next = Order[i + BROADPHASE_PREFETCH];
+
+            _mm_prefetch((const char *)&Broadphase->Boxes[Next], _MM_HINT_T0);
+        }
+#endif
+
+        unsigned int Body = Order[i];
+        broadphase_box Box = Broadphase->Boxes[Body];
+        unsigned int Key = GetBroadphaseKey(Box.Min.x);
+        unsigned int Slot = i;
+
+        // NOTE[joe] Everything before i already has this frame's key.
+        while (Slot > 0 &&
+               (Keys[Slot - 1] > Key ||
+                (Keys[Slot - 1] == Key && Order[Slot - 1] > Body)))
+        {
+            Keys[Slot] = Keys[Slot - 1];
+            Order[Slot] = Order[Slot - 1];
+            Sorted[Slot] = Sorted[Slot - 1];
+            Slot--;
+        }
+
+        Keys[Slot] = Key;
+        Order[Slot] = Body;
+        SetBroadphaseSorted(Broadphase, Slot, Body, &Box);
+
+        MoveCount += i - Slot;
+
+        if (MoveCount > (unsigned long long)(i + BROADPHASE_MOVE_SLACK) *
+                        BROADPHASE_MAX_MOVES_PER_BODY)
+        {
+            Broadphase->SortMoveCount = MoveCount;
+
+            return false;
+        }
+    }
+
+    Broadphase->SortMoveCount = MoveCount;
+    Broadphase->WasSortedFromScratch = false;
+
+    return true;
+}
+
+/** Puts bodies in order along x. Either way round, the order only depends
+ * on the boxes, not on what order they were in before. */
+static
+void SortBroadphase(broadphase *Broadphase)
+{
+    Broadphase->SortMoveCount = 0;
+
+    if (Broadphase->IsUnsorted || !SortBroadphaseIncrementally(Broadphase))
+    {
+        SortBroadphaseFromScratch(Broadphase);
+    }
+
+    Broadphase->IsUnsorted = false;
+}
+
+
+/** Sets the grid to CountY by CountZ cells, across Low to High. */
+static
+void SetBroadphaseGrid(broadphase *Broadphase,
+                       unsigned int CountY,
+                       unsigned int CountZ,
+                       vec3 Low,
+                       vec3 High)
+{
+    Broadphase->CellCountY = CountY;
+    Broadphase->CellCountZ = CountZ;
+    Broadphase->CellOriginY = Low.y;
+    Broadphase->CellOriginZ = Low.z;
+
+    // NOTE[joe] Flat along a side means one cell along it, and everything in
+    // it.
+    float ExtentY = High.y - Low.y;
+    float ExtentZ = High.z - Low.z;
+
+    Broadphase->CellScaleY = ExtentY > 0.0f ? (float)CountY / ExtentY : 0.0f;
+    Broadphase->CellScaleZ = ExtentZ > 0.0f ? (float)CountZ / ExtentZ : 0.0f;
+}
+
+/** How many cells to cut Extent into, for cells Side across. */
+static
+unsigned int GetBroadphaseCellCount(float Extent, float Side)
+{
+    if (!(Side > 0.0f) || !(Extent > Side))
+    {
+        return 1;
+    }
+
+    float Count = ceilf(Extent / Side);
+
+    if (Count >= (float)BROADPHASE_MAX_CELLS_PER_SIDE)
+    {
+        return BROADPHASE_MAX_CELLS_PER_SIDE;
+    }
+
+    return (unsigned int)Count;
+}
+
+/** Fits a grid of square cells around every box, with about
+ * BROADPHASE_CELL_TARGET bodies in each if they're spread out evenly. */
+static
+void FitBroadphaseGrid(broadphase *Broadphase)
+{
+    unsigned int Count = Broadphase->Count;
+
+    vec3 Low = { 0.0f, INFINITY, INFINITY };
+    vec3 High = { 0.0f, -INFINITY, -INFINITY };
+    double SizeY = 0.0;
+    double SizeZ = 0.0;
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        broadphase_box *Box = &Broadphase->Boxes[i];
+
+        float MinY = Box->Min.y;
+        float MinZ = Box->Min.z;
+        float MaxY = Box->Max.y;
+        float MaxZ = Box->Max.z;
+
+        Low.y = MinY < Low.y ? MinY : Low.y;
+        Low.z = MinZ < Low.z ? MinZ : Low.z;
+        High.y = MaxY > High.y ? MaxY : High.y;
+        High.z = MaxZ > High.z ? MaxZ : High.z;
+
+        SizeY += MaxY - MinY;
+        SizeZ += MaxZ - MinZ;
+    }
+
+    if (Count == 0)
+    {
+        SetBroadphaseGrid(Broadphase, 1, 1, Low, Low);
+        return;
+    }
+
+    float ExtentY = High.y - Low.y;
+    float ExtentZ = High.z - Low.z;
+
+    unsigned int TargetCount = Count / BROADPHASE_CELL_TARGET;
+    TargetCount = TargetCount ? TargetCount : 1;
+
+    // NOTE[joe] Square cells, unless the world is flatter along one side
+    // than a cell is across. Then all the cells go along the other side.
+    float Side = sqrtf(ExtentY * ExtentZ / (float)TargetCount);
+
+    if (ExtentY < Side)
+    {
+        Side = ExtentZ / (float)TargetCount;
+    }
+    else if (ExtentZ < Side)
+    {
+        Side = ExtentY / (float)TargetCount;
+    }
+
+    float AverageSize = (float)((SizeY > SizeZ ? SizeY : SizeZ) / Count);
+    float MinSide = BROADPHASE_CELL_MIN_BOXES * AverageSize;
+
+    Side = Side > MinSide ? Side : MinSide;
+
+    SetBroadphaseGrid(Broadphase,
+                      GetBroadphaseCellCount(ExtentY, Side),
+                      GetBroadphaseCellCount(ExtentZ, Side),
+                      Low,
+                      High);
+}
+
+/** Works out which cells each body in chunks [Start, End) of the sorted
+ * bodies touches, and counts how many go in each cell. */
+static
+void CountBroadphaseJob(void *Data, unsigned int Start, unsigned int End)
+{
+    broadphase *Broadphase = (broadphase *)Data;
+
+    unsigned int CountY = Broadphase->CellCountY;
+    unsigned int CellCount = CountY * Broadphase->CellCountZ;
+
+    for (unsigned int Chunk = Start; Chunk < End; Chunk++)
+    {
+        unsigned int *Counts =
+            &Broadphase->ChunkCursors[Chunk * BROADPHASE_MAX_CELLS];
+
+        for (unsigned int Cell = 0; Cell < CellCount; Cell++)
+        {
+            Counts[Cell] = 0;
+        }
+
+        unsigned int First = Chunk * Broadphase->ChunkSize;
+        unsigned int Last = First + Broadphase->ChunkSize;
+        Last = Last < Broadphase->Count ? Last : Broadphase->Count;
+
+        for (unsigned int i = First; i < Last; i++)
+        {
+            broadphase_entry *Sorted = &Broadphase->Sorted[i];
+
+            unsigned int Y0 = GetBroadphaseCell(Sorted->Min.y,
+                                                Broadphase->CellOriginY,
+                                                Broadphase->CellScaleY,
+                                                CountY);
+            unsigned int Y1 = GetBroadphaseCell(Sorted->Max.y,
+                                                Broadphase->CellOriginY,
+                                                Broadphase->CellScaleY,
+                                                CountY);
+            unsigned int Z0 = GetBroadphaseCell(Sorted->Min.z,
+                                                Broadphase->CellOriginZ,
+                                                Broadphase->CellScaleZ,
+                                                Broadphase->CellCountZ);
+            unsigned int Z1 = GetBroadphaseCell(Sorted->Max.z,
+                                                Broadphase->CellOriginZ,
+                                                Broadphase->CellScaleZ,
+                                                Broadphase->CellCountZ);
+
+            Broadphase->CellRanges[i] = Y0 | Y1 << 8 | Z0 << 16 | Z1 << 24;
+
+            for (unsigned int Z = Z0; Z <= Z1; Z++)
+            {
+                for (unsigned int Y = Y0; Y <= Y1; Y++)
+                {
+                    Counts[Z * CountY + Y]++;
+                }
+            }
+        }
+    }
+}
+
+/** Copies the boxes of chunks [Start, End) of the sorted bodies into every
+ * cell they touch. Cells fill up in sorted order, since each chunk starts
+ * after the ones before it in every cell. */
+static
+void FillBroadphaseJob(void *Data, unsigned int Start, unsigned int End)
+{
+    broadphase *Broadphase = (broadphase *)Data;
+
+    unsigned int CountY = Broadphase->CellCountY;
+
+    for (unsigned int Chunk = Start; Chunk < End; Chunk++)
+    {
+        unsigned int *Cursors =
+            &Broadphase->ChunkCursors[Chunk * BROADPHASE_MAX_CELLS];
+
+        unsigned int First = Chunk * Broadphase->ChunkSize;
+        unsigned int Last = First + Broadphase->ChunkSize;
+        Last = Last < Broadphase->Count ? Last : Broadphase->Count;
+
+        for (unsigned int i = First; i < Last; i++)
+        {
+            unsigned int Range = Broadphase->CellRanges[i];
+
+            unsigned int Y0 = Range & 0xFF;
+            unsigned int Y1 = (Range >> 8) & 0xFF;
+            unsigned int Z0 = (Range >> 16) & 0xFF;
+            unsigned int Z1 = Range >> 24;
+
+            for (unsigned int Z = Z0; Z <= Z1; Z++)
+            {
+                for (unsigned int Y = Y0; Y <= Y1; Y++)
+                {
+                    unsigned int Entry = Cursors[Z * CountY + Y]++;
+
+                    Broadphase->Entries[Entry] = Broadphase->Sorted[i];
+                }
+            }
+        }
+    }
+}
+
+/** Lays the cells out one after another, each chunk's bodies after the last
+ * chunk's in every cell, and turns the chunks' counts into where their
+ * bodies go. Returns false, having touched nothing, if there isn't room. */
+static
+bool PlaceBroadphaseCells(broadphase *Broadphase)
+{
+    unsigned int CellCount = Broadphase->CellCountY * Broadphase->CellCountZ;
+
+    unsigned long long Total = (unsigned long long)CellCount *
+                               BROADPHASE_PADDING;
+
+    for (unsigned int Chunk = 0; Chunk < Broadphase->ChunkCount; Chunk++)
+    {
+        unsigned int *Counts =
+            &Broadphase->ChunkCursors[Chunk * BROADPHASE_MAX_CELLS];
+
+        for (unsigned int Cell = 0; Cell < CellCount; Cell++)
+        {
+            Total += Counts[Cell];
+        }
+    }
+
+    if (Total > Broadphase->MaxEntryCount)
+    {
+        return false;
+    }
+
+    unsigned int Entry = 0;
+
+    for (unsigned int Cell = 0; Cell < CellCount; Cell++)
+    {
+        broadphase_cell *Info = &Broadphase->Cells[Cell];
+        Info->First = Entry;
+
+        for (unsigned int Chunk = 0; Chunk < Broadphase->ChunkCount; Chunk++)
+        {
+            unsigned int *Cursor =
+                &Broadphase->ChunkCursors[Chunk * BROADPHASE_MAX_CELLS + Cell];
+            unsigned int ChunkCount = *Cursor;
+
+            *Cursor = Entry;
+            Entry += ChunkCount;
+        }
+
+        Info->Count = Entry - Info->First;
+        Entry += BROADPHASE_PADDING;
+    }
+
+    Broadphase->EntryCount = Entry;
+
+    return true;
+}
+
+/** Puts every body into the cells it touches, in sorted order. */
+static
+void FillBroadphaseCells(broadphase *Broadphase, job_system *Jobs)
+{
+    unsigned int Count = Broadphase->Count;
+
+    unsigned int ChunkCount =
+        (Count + BROADPHASE_MIN_CHUNK - 1) / BROADPHASE_MIN_CHUNK;
+    ChunkCount = ChunkCount < BROADPHASE_MAX_CHUNKS ? ChunkCount
+                                                   : BROADPHASE_MAX_CHUNKS;
+    ChunkCount = ChunkCount ? ChunkCount : 1;
+
+    Broadphase->ChunkCount = ChunkCount;
+    Broadphase->ChunkSize = (Count + ChunkCount - 1) / ChunkCount;
+
+    FitBroadphaseGrid(Broadphase);
+
+    ParallelForAndWait(Jobs, CountBroadphaseJob, Broadphase, ChunkCount, 1);
+
+    // NOTE[joe] If bodies are in too many cells each to fit, they're bigger
+    // than the grid expected; halve it until they fit. One cell always
+    // does.
+    while (!PlaceBroadphaseCells(Broadphase))
+    {
+        Broadphase->CellCountY = (Broadphase->CellCountY + 1) / 2;
+        Broadphase->CellCountZ = (Broadphase->CellCountZ + 1) / 2;
+        Broadphase->CellScaleY *= 0.5f;
+        Broadphase->CellScaleZ *= 0.5f;
+
+        ParallelForAndWait(Jobs,
+                           CountBroadphaseJob,
+                           Broadphase,
+                           ChunkCount,
+                           1);
+    }
+
+    ParallelForAndWait(Jobs, FillBroadphaseJob, Broadphase, ChunkCount, 1);
+}
+
+/** Gets the cells ready to be swept. */
+static
+void BeginBroadphaseSweep(broadphase *Broadphase)
+{
+    Broadphase->UsedBlockCount.store(0, std::memory_order_relaxed);
+}
+
+/** Sweeps cells [Start, End) with backend's kernel. */
+template <typename backend>
+static
+void SweepBroadphaseWith(broadphase *Broadphase,
+                         unsigned int Start,
+                         unsigned int End)
+{
+    for (unsigned int i = Start; i < End; i++)
+    {
+        broadphase_cell *Cell = &Broadphase->Cells[i];
+        Cell->FirstBlock = BROADPHASE_NO_BLOCK;
+        Cell->LastBlock = BROADPHASE_NO_BLOCK;
+        Cell->PairCount = 0;
+        Cell->DroppedCount = 0;
+
+        unsigned int First = Cell->First;
+        unsigned int Last = First + Cell->Count;
+
+        for (unsigned int Entry = First; Entry < Last; Entry++)
+        {
+            broadphase_entry *Box = &Broadphase->Entries[Entry];
+
+            Broadphase->EntryMinX[Entry] = Box->Min.x;
+            Broadphase->EntryMinY[Entry] = Box->Min.y;
+            Broadphase->EntryMinZ[Entry] = Box->Min.z;
+            Broadphase->EntryMaxX[Entry] = Box->Max.x;
+            Broadphase->EntryMaxY[Entry] = Box->Max.y;
+            Broadphase->EntryMaxZ[Entry] = Box->Max.z;
+            Broadphase->EntryBodies[Entry] = Box->Body;
+        }
+
+        // NOTE[joe] Starts after everything, and is empty in y and z, so it
+        // ends every sweep and never overlaps anything.
+        for (unsigned int Entry = Last;
+             Entry < Last + BROADPHASE_PADDING;
+             Entry++)
+        {
+            Broadphase->EntryMinX[Entry] = INFINITY;
+            Broadphase->EntryMinY[Entry] = INFINITY;
+            Broadphase->EntryMinZ[Entry] = INFINITY;
+            Broadphase->EntryMaxX[Entry] = -INFINITY;
+            Broadphase->EntryMaxY[Entry] = -INFINITY;
+            Broadphase->EntryMaxZ[Entry] = -INFINITY;
+        }
+
+        broadphase_writer Writer = {};
+        Writer.Broadphase = Broadphase;
+        Writer.Cell = Cell;
+        Writer.CellY = i % Broadphase->CellCountY;
+        Writer.CellZ = i / Broadphase->CellCountY;
+
+        broadphase_kernels<backend>::Sweep(Broadphase, First, Last, &Writer);
+
+        FinishBroadphaseBlock(&Writer);
+    }
+}
+
+static
+void SweepBroadphaseJob(void *Data, unsigned int Start, unsigned int End)
+{
+    SweepBroadphaseWith<broadphase_backend>((broadphase *)Data, Start, End);
+}
+
+/** Copies every cell's pairs into Pairs, one cell after another. */
+static
+void CollectBroadphasePairs(broadphase *Broadphase)
+{
+    unsigned int CellCount = Broadphase->CellCountY * Broadphase->CellCountZ;
+    unsigned int PairCount = 0;
+    unsigned int DroppedCount = 0;
+
+    for (unsigned int i = 0; i < CellCount; i++)
+    {
+        broadphase_cell *Cell = &Broadphase->Cells[i];
+        Cell->Offset = PairCount;
+
+        PairCount += Cell->PairCount;
+        DroppedCount += Cell->DroppedCount;
+
+        broadphase_pair *Pairs = Broadphase->Pairs + Cell->Offset;
+        unsigned int Index = Cell->FirstBlock;
+
+        while (Index != BROADPHASE_NO_BLOCK)
+        {
+            broadphase_block *Block = &Broadphase->Blocks[Index];
+
+            memcpy(Pairs, Block->Pairs, sizeof(broadphase_pair) * Block->Count);
+
+            Pairs += Block->Count;
+            Index = Block->Next;
+        }
+    }
+
+    Broadphase->PairCount = PairCount;
+    Broadphase->DroppedCount = DroppedCount;
+}
+
+/** Finds every pair of bodies whose boxes overlap (touching counts), across
+ * Jobs, and waits. The pairs end up in Broadphase->Pairs. */
+static
+void UpdateBroadphase(broadphase *Broadphase, job_system *Jobs)
+{
+    // NOTE[joe] The sort is the one part that doesn't split up. It's close
+    // to a single pass when bodies haven't moved far.
+    SortBroadphase(Broadphase);
+
+    FillBroadphaseCells(Broadphase, Jobs);
+
+    BeginBroadphaseSweep(Broadphase);
+
+    ParallelForAndWait(Jobs,
+                       SweepBroadphaseJob,
+                       Broadphase,
+                       Broadphase->CellCountY * Broadphase->CellCountZ,
+                       1);
+
+    CollectBroadphasePairs(Broadphase);
+}
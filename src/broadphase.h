@@ -0,0 +1,194 @@
+/**
+ * @file broadphase.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the definitions for our collision broadphase, which
+ * finds every pair of bodies whose bounding boxes overlap, for the narrow
+ * phase to look at more closely.
+ *
+ * It's sweep and prune along x. Bodies are kept sorted by the low end of
+ * their boxes, and a body can only overlap the bodies after it up to where
+ * those start past its own high end; y and z are only tested for those.
+ * Bodies barely move between frames, so the sort from last frame is nearly
+ * sorted already, and an insertion sort puts it right again in close to one
+ * pass.
+ *
+ * Sweeping everything along one axis falls apart as the world gets bigger,
+ * since everything in the same slice of x is a candidate, however far apart
+ * in y and z. So space is cut into a grid of cells across y and z, and each
+ * cell sweeps just the bodies that touch it. Bodies go into cells in sorted
+ * order, so every cell's list comes out sorted without sorting it again. A
+ * pair that shares more than one cell is only kept by the cell that has the
+ * low corner of where they overlap.
+ *
+ * Boxes are copied a body at a time wherever they go, so copying one into
+ * sorted order, or into a cell, is one cache miss rather than six: bodies
+ * are numbered in no particular order along x, and cells are filled from
+ * all over. Each cell then splits its own boxes out a component per array
+ * right before it's swept, while they're still in cache, so the tests along
+ * y and z are straight SIMD over the bodies that follow.
+ *
+ * Cells are swept in parallel on the job system, each writing its pairs on
+ * its own, and the cells' pairs are put together in order, so the pairs
+ * always come out in the same order for the same boxes, no matter how many
+ * threads found them.
+ */
+
+#ifndef _BROADPHASE_H_
+#define _BROADPHASE_H_
+
+#include <atomic>
+
+#include "linear_math.h"
+
+// NOTE[joe] Sentinels after each cell's bodies, so a SIMD sweep never has
+// to check for the end. Has to be at least the widest kernel.
+#define BROADPHASE_PADDING 8
+
+// NOTE[joe] Cells are the unit of work that gets handed out. Aiming for
+// this many bodies in each keeps sweeps short, and still leaves plenty more
+// cells than threads. A cell is at least a few boxes across, though, or
+// every body would be in lots of them.
+#define BROADPHASE_CELL_TARGET 1024
+#define BROADPHASE_CELL_MIN_BOXES 4.0f
+
+// NOTE[joe] Cell coordinates are packed a byte each, so a side can't have
+// more than 256 cells; this is plenty.
+#define BROADPHASE_MAX_CELLS_PER_SIDE 64
+#define BROADPHASE_MAX_CELLS \
+    (BROADPHASE_MAX_CELLS_PER_SIDE * BROADPHASE_MAX_CELLS_PER_SIDE)
+
+// NOTE[joe] How many cells bodies can be in, on average, before the grid
+// is made coarser to fit.
+#define BROADPHASE_CELLS_PER_BODY 4
+
+// NOTE[joe] Bodies are put into cells this many at a time, at least.
+#define BROADPHASE_MIN_CHUNK 16384
+#define BROADPHASE_MAX_CHUNKS 64
+
+#define BROADPHASE_BLOCK_SIZE 256
+#define BROADPHASE_NO_BLOCK 0xFFFFFFFF
+
+typedef struct alignas(32) {
+    vec3         Min;
+    unsigned int Padding0;
+    vec3         Max;
+    unsigned int Padding1;
+} broadphase_box;
+
+/** A body's box, copied into sorted order or into a cell. */
+typedef struct alignas(32) {
+    vec3         Min;
+    unsigned int Body;
+    vec3         Max;
+    unsigned int Padding;
+} broadphase_entry;
+
+/** Two bodies whose boxes overlap, lowest first. */
+typedef struct {
+    unsigned int A;
+    unsigned int B;
+} broadphase_pair;
+
+/** Where a cell writes its pairs, before they're put together. */
+typedef struct {
+    unsigned int    Count;
+    unsigned int    Next;
+    broadphase_pair Pairs[BROADPHASE_BLOCK_SIZE];
+} broadphase_block;
+
+typedef struct {
+    // NOTE[joe] The cell's bodies, as entries.
+    unsigned int First;
+    unsigned int Count;
+
+    // NOTE[joe] The blocks this cell's pairs are in, and where they start
+    // in the broadphase's pairs.
+    unsigned int FirstBlock;
+    unsigned int LastBlock;
+    unsigned int PairCount;
+    unsigned int Offset;
+    unsigned int DroppedCount;
+} broadphase_cell;
+
+typedef struct {
+    unsigned int                MaxCount;
+    unsigned int                Count;
+
+    // NOTE[joe] Indexed by body.
+    broadphase_box             *Boxes;
+
+    // NOTE[joe] Bodies in order along x, by the low end of their boxes and
+    // then by body, so the order only depends on where the boxes are. Keys
+    // are the low ends as integers that sort the same way the floats do.
+    unsigned int               *Order;
+    unsigned int               *Keys;
+    // NOTE[joe] Bodies have been added since the last sort, which could be
+    // anywhere in it. The next sort starts from scratch.
+    bool                        IsUnsorted;
+
+    // NOTE[joe] Scratch for sorting from scratch: each body's key and the
+    // body packed together, so a radix pass only scatters one thing.
+    unsigned long long         *SortItems;
+    unsigned long long         *TempItems;
+
+    // NOTE[joe] Fitted to where the boxes are, every update. Cell (y, z) is
+    // Cells[z * CellCountY + y].
+    unsigned int                CellCountY;
+    unsigned int                CellCountZ;
+    float                       CellOriginY;
+    float                       CellOriginZ;
+    float                       CellScaleY;
+    float                       CellScaleZ;
+    broadphase_cell            *Cells;
+
+    // NOTE[joe] Everyone's boxes in sorted order, and which cells each one
+    // touches, a byte each for the first and last in y, then in z.
+    broadphase_entry           *Sorted;
+    unsigned int               *CellRanges;
+
+    // NOTE[joe] Sorted bodies are split into chunks to be put into cells.
+    // How many of each chunk's bodies go in each cell, and then where they
+    // go, indexed by Chunk * BROADPHASE_MAX_CELLS + Cell.
+    unsigned int                ChunkCount;
+    unsigned int                ChunkSize;
+    unsigned int               *ChunkCursors;
+
+    // NOTE[joe] Every cell's bodies' boxes, one cell after another, each
+    // followed by room for BROADPHASE_PADDING sentinels that never overlap
+    // anything. A cell's boxes are split out into the arrays after them at
+    // the same places, sentinels and all, when it's swept.
+    unsigned int                MaxEntryCount;
+    unsigned int                EntryCount;
+    broadphase_entry           *Entries;
+    float                      *EntryMinX;
+    float                      *EntryMinY;
+    float                      *EntryMinZ;
+    float                      *EntryMaxX;
+    float                      *EntryMaxY;
+    float                      *EntryMaxZ;
+    unsigned int               *EntryBodies;
+
+    broadphase_block           *Blocks;
+    unsigned int                BlockCount;
+    std::atomic<unsigned int>   UsedBlockCount;
+
+    // NOTE[joe] This frame's pairs, cell by cell.
+    broadphase_pair            *Pairs;
+    unsigned int                PairCount;
+    unsigned int                MaxPairCount;
+
+    // NOTE[joe] Pairs that didn't fit. Which ones is up to which cells ran
+    // out of room first, so once any are dropped the rest of the pairs
+    // aren't deterministic anymore either.
+    unsigned int                DroppedCount;
+
+    // NOTE[joe] How far the last sort moved bodies incrementally, in
+    // places, and whether it then had to give up and start from scratch.
+    // Moves about the same as the number of bodies means it was nearly free.
+    unsigned long long          SortMoveCount;
+    bool                        WasSortedFromScratch;
+} broadphase;
+
+#endif
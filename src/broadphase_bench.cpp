@@ -0,0 +1,425 @@
+/**
+ * @file broadphase_bench.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the broadphase benchmarks, and the checks that keep it
+ * honest. Boxes drift around a space sized so that each one overlaps a
+ * couple of others, at 10k, 100k and 1M bodies, and the broadphase is timed
+ * finding their pairs across the job system, a frame at a time so that it
+ * sorts incrementally like it would in the game, and from scratch for
+ * comparison. Every kernel the build can run has to find the same pairs, in
+ * the same order, on one thread; and for the smallest scene, every pair is
+ * checked against testing every box against every other. Platform layers
+ * run them with --bench-broadphase, instead of the game, and exit with an
+ * error if any check fails.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "job.h"
+#include "broadphase.h"
+
+#define BROADPHASE_BENCH_SCENES 3
+#define BROADPHASE_BENCH_RUNS 16
+#define BROADPHASE_BENCH_KERNEL_RUNS 4
+
+// NOTE[joe] Testing every pair is quadratic, so only scenes up to this big
+// get checked that way.
+#define BROADPHASE_BENCH_BRUTE_MAX 16384
+
+// NOTE[joe] Bodies per unit of volume. Boxes are between half a unit and a
+// unit across, so this works out at a little over one pair per body.
+#define BROADPHASE_BENCH_DENSITY 0.6f
+
+// NOTE[joe] Fastest a body moves in a frame, in multiples of the average gap
+// between bodies along x. What the incremental sort costs depends on how many
+// bodies each one passes, so at the same speed in units, the bigger scenes
+// would pass so many more that it gave up on every frame. This keeps it doing
+// the same work per body at every size: about 0.05 units a frame at 10k.
+#define BROADPHASE_BENCH_SPEED 16.0f
+
+typedef struct {
+    memory_arena     Arena;
+    broadphase       Broadphase;
+    unsigned int     Count;
+    float            Size;
+    vec3            *Centers;
+    vec3            *HalfSizes;
+    vec3            *Velocities;
+    broadphase_pair *Reference;
+    unsigned int     ReferenceCount;
+    unsigned int     Random;
+} broadphase_bench_data;
+
+static
+float BroadphaseBenchRandom(broadphase_bench_data *Data, float Low, float High)
+{
+    Data->Random ^= Data->Random << 13;
+    Data->Random ^= Data->Random >> 17;
+    Data->Random ^= Data->Random << 5;
+
+    return Low + (High - Low) * (float)(Data->Random & 0xFFFFFF) / 16777216.0f;
+}
+
+static
+void SetBroadphaseBenchBox(broadphase_bench_data *Data, unsigned int Body)
+{
+    SetBroadphaseBox(&Data->Broadphase,
+                     Body,
+                     Data->Centers[Body] - Data->HalfSizes[Body],
+                     Data->Centers[Body] + Data->HalfSizes[Body]);
+}
+
+/** One frame's worth of drifting, bouncing off the sides of the space. */
+static
+void MoveBroadphaseBenchBodies(broadphase_bench_data *Data)
+{
+    for (unsigned int i = 0; i < Data->Count; i++)
+    {
+        float *Center = &Data->Centers[i].x;
+        float *Velocity = &Data->Velocities[i].x;
+
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            Center[k] += Velocity[k];
+
+            if (Center[k] < 0.0f || Center[k] > Data->Size)
+            {
+                Velocity[k] = -Velocity[k];
+            }
+        }
+
+        SetBroadphaseBenchBox(Data, i);
+    }
+}
+
+static
+bool IsBroadphaseBenchOverlap(broadphase *Broadphase,
+                              unsigned int A,
+                              unsigned int B)
+{
+    broadphase_box *BoxA = &Broadphase->Boxes[A];
+    broadphase_box *BoxB = &Broadphase->Boxes[B];
+
+    return BoxA->Min.x <= BoxB->Max.x && BoxA->Max.x >= BoxB->Min.x &&
+           BoxA->Min.y <= BoxB->Max.y && BoxA->Max.y >= BoxB->Min.y &&
+           BoxA->Min.z <= BoxB->Max.z && BoxA->Max.z >= BoxB->Min.z;
+}
+
+/** Checks the broadphase found exactly the pairs testing every box against
+ * every other does: each one once, and nothing else. */
+static
+bool CheckBroadphaseBruteForce(broadphase_bench_data *Data)
+{
+    broadphase *Broadphase = &Data->Broadphase;
+    unsigned int Count = Data->Count;
+
+    arena_temp Temp = BeginArenaTemp(&Data->Arena);
+
+    /** Bucket the broadphase's pairs by their first body, each bucket in
+     * order of second body. Bucket A is [Starts[A], Starts[A + 1]). */
+
+    unsigned int *Starts = PushArray(&Data->Arena, unsigned int, Count + 1);
+    unsigned int *Ends = PushArray(&Data->Arena, unsigned int, Count);
+    unsigned int *Others =
+        PushArray(&Data->Arena, unsigned int, Broadphase->PairCount);
+
+    for (unsigned int i = 0; i <= Count; i++)
+    {
+        Starts[i] = 0;
+    }
+
+    for (unsigned int i = 0; i < Broadphase->PairCount; i++)
+    {
+        Starts[Broadphase->Pairs[i].A + 1]++;
+    }
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        Starts[i + 1] += Starts[i];
+        Ends[i] = Starts[i];
+    }
+
+    for (unsigned int i = 0; i < Broadphase->PairCount; i++)
+    {
+        broadphase_pair *Pair = &Broadphase->Pairs[i];
+        unsigned int Slot = Ends[Pair->A]++;
+
+        // NOTE[joe] Buckets are tiny, so an insertion sort is plenty.
+        while (Slot > Starts[Pair->A] && Others[Slot - 1] > Pair->B)
+        {
+            Others[Slot] = Others[Slot - 1];
+            Slot--;
+        }
+
+        Others[Slot] = Pair->B;
+    }
+
+    /** Walk every pair in the same order and compare. */
+
+    bool IsExact = true;
+    unsigned int BruteCount = 0;
+
+    for (unsigned int A = 0; A < Count; A++)
+    {
+        unsigned int Slot = Starts[A];
+
+        for (unsigned int B = A + 1; B < Count; B++)
+        {
+            if (IsBroadphaseBenchOverlap(Broadphase, A, B))
+            {
+                BruteCount++;
+
+                if (Slot >= Starts[A + 1] || Others[Slot] != B)
+                {
+                    IsExact = false;
+                }
+
+                Slot++;
+            }
+        }
+
+        if (Slot != Starts[A + 1])
+        {
+            IsExact = false;
+        }
+    }
+
+    EndArenaTemp(Temp);
+
+    printf("broadphase_%u_brute_pairs %u\n", Count, BruteCount);
+
+    return IsExact && Broadphase->PairCount == BruteCount;
+}
+
+/** Checks backend finds the same pairs, in the same order, as the game's
+ * kernel did across the job system, then times it sweeping on its own. */
+template <typename backend>
+static
+bool BenchmarkBroadphaseBackend(broadphase_bench_data *Data)
+{
+    broadphase *Broadphase = &Data->Broadphase;
+
+    double Best = 1e9;
+
+    for (unsigned int Run = 0; Run < BROADPHASE_BENCH_KERNEL_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        BeginBroadphaseSweep(Broadphase);
+        SweepBroadphaseWith<backend>(
+            Broadphase,
+            0,
+            Broadphase->CellCountY * Broadphase->CellCountZ);
+        CollectBroadphasePairs(Broadphase);
+
+        double Time = PlatformGetTime() - Begin;
+        Best = Time < Best ? Time : Best;
+    }
+
+    bool IsSame =
+        Broadphase->PairCount == Data->ReferenceCount &&
+        Broadphase->DroppedCount == 0 &&
+        memcmp(Broadphase->Pairs,
+               Data->Reference,
+               sizeof(broadphase_pair) * Data->ReferenceCount) == 0;
+
+    printf("broadphase_%u_%s_same %d\n",
+           Data->Count,
+           backend::Name,
+           IsSame ? 1 : 0);
+    printf("broadphase_%u_%s_serial_pairs_per_ms %.0f\n",
+           Data->Count,
+           backend::Name,
+           Data->ReferenceCount / (Best * 1000.0));
+
+    return IsSame;
+}
+
+/** Benchmarks and checks one scene of Count bodies. Returns false if any
+ * check failed. */
+static
+bool BenchmarkBroadphaseScene(broadphase_bench_data *Data,
+                              job_system *Jobs,
+                              unsigned int Count)
+{
+    broadphase *Broadphase = &Data->Broadphase;
+
+    InitializeArena(&Data->Arena, GIGABYTES(1), "Broadphase benchmark");
+
+    Data->Count = Count;
+    Data->Size = cbrtf((float)Count / BROADPHASE_BENCH_DENSITY);
+    Data->Centers = PushArray(&Data->Arena, vec3, Count);
+    Data->HalfSizes = PushArray(&Data->Arena, vec3, Count);
+    Data->Velocities = PushArray(&Data->Arena, vec3, Count);
+
+    // NOTE[joe] Plenty of room, so nothing's ever dropped.
+    InitializeBroadphase(Broadphase, &Data->Arena, Count, 4 * Count);
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        Data->Centers[i] = {
+            BroadphaseBenchRandom(Data, 0.0f, Data->Size),
+            BroadphaseBenchRandom(Data, 0.0f, Data->Size),
+            BroadphaseBenchRandom(Data, 0.0f, Data->Size)
+        };
+
+        Data->HalfSizes[i] = {
+            BroadphaseBenchRandom(Data, 0.25f, 0.5f),
+            BroadphaseBenchRandom(Data, 0.25f, 0.5f),
+            BroadphaseBenchRandom(Data, 0.25f, 0.5f)
+        };
+
+        Data->Velocities[i] = {
+            BroadphaseBenchRandom(Data, -1.0f, 1.0f),
+            BroadphaseBenchRandom(Data, -1.0f, 1.0f),
+            BroadphaseBenchRandom(Data, -1.0f, 1.0f)
+        };
+
+        Data->Velocities[i] =
+            Data->Velocities[i] * (BROADPHASE_BENCH_SPEED * Data->Size / Count);
+
+        AddBroadphaseBody(Broadphase,
+                          Data->Centers[i] - Data->HalfSizes[i],
+                          Data->Centers[i] + Data->HalfSizes[i]);
+    }
+
+    /** The first update sorts from scratch. */
+
+    double Begin = PlatformGetTime();
+
+    UpdateBroadphase(Broadphase, Jobs);
+
+    double FirstTime = PlatformGetTime() - Begin;
+
+    /** Every one after that picks up where the last one left off. */
+
+    double Best = 1e9;
+    unsigned long long MoveCount = 0;
+    unsigned int ScratchCount = 0;
+
+    for (unsigned int Run = 0; Run < BROADPHASE_BENCH_RUNS; Run++)
+    {
+        MoveBroadphaseBenchBodies(Data);
+
+        Begin = PlatformGetTime();
+
+        UpdateBroadphase(Broadphase, Jobs);
+
+        double Time = PlatformGetTime() - Begin;
+        Best = Time < Best ? Time : Best;
+
+        MoveCount += Broadphase->SortMoveCount;
+        ScratchCount += Broadphase->WasSortedFromScratch;
+    }
+
+    unsigned int PairCount = Broadphase->PairCount;
+
+    printf("broadphase_%u_pairs %u\n", Count, PairCount);
+    printf("broadphase_%u_first_update_ms %.3f\n", Count, FirstTime * 1000.0);
+    printf("broadphase_%u_update_ms %.3f\n", Count, Best * 1000.0);
+    printf("broadphase_%u_pairs_per_ms %.0f\n",
+           Count,
+           PairCount / (Best * 1000.0));
+    // NOTE[joe] If this isn't 0, the update time above is partly (or all)
+    // sorting from scratch, and isn't measuring the incremental sort.
+    printf("broadphase_%u_sorts_from_scratch %u/%u\n",
+           Count,
+           ScratchCount,
+           BROADPHASE_BENCH_RUNS);
+    printf("broadphase_%u_cells %ux%u\n",
+           Count,
+           Broadphase->CellCountY,
+           Broadphase->CellCountZ);
+    printf("broadphase_%u_entries_per_body %.2f\n",
+           Count,
+           (double)Broadphase->EntryCount / Count);
+    printf("broadphase_%u_sort_moves_per_body %.2f\n",
+           Count,
+           (double)MoveCount / ((double)Count * BROADPHASE_BENCH_RUNS));
+
+    /** Keep what the game's kernel found across the job system, for every
+     * other kernel to match. */
+
+    bool IsCorrect = Broadphase->DroppedCount == 0;
+
+    Data->ReferenceCount = PairCount;
+    Data->Reference = PushArray(&Data->Arena, broadphase_pair, PairCount);
+    memcpy(Data->Reference,
+           Broadphase->Pairs,
+           sizeof(broadphase_pair) * PairCount);
+
+    // NOTE[joe] An incremental sort has to come out the same as sorting
+    // from scratch.
+    Begin = PlatformGetTime();
+
+    Broadphase->IsUnsorted = true;
+    UpdateBroadphase(Broadphase, Jobs);
+
+    double ScratchTime = PlatformGetTime() - Begin;
+
+    printf("broadphase_%u_update_from_scratch_ms %.3f\n",
+           Count,
+           ScratchTime * 1000.0);
+
+    IsCorrect &= Broadphase->PairCount == PairCount &&
+                 memcmp(Broadphase->Pairs,
+                        Data->Reference,
+                        sizeof(broadphase_pair) * PairCount) == 0;
+
+    IsCorrect &= BenchmarkBroadphaseBackend<math_scalar>(Data);
+
+#if MATH_HAS_SSE
+    IsCorrect &= BenchmarkBroadphaseBackend<math_sse>(Data);
+#endif
+
+#if MATH_HAS_AVX2
+    IsCorrect &= BenchmarkBroadphaseBackend<math_avx2>(Data);
+#endif
+
+    if (Count <= BROADPHASE_BENCH_BRUTE_MAX)
+    {
+        IsCorrect &= CheckBroadphaseBruteForce(Data);
+    }
+
+    ReleaseArena(&Data->Arena);
+
+    return IsCorrect;
+}
+
+/** Runs every broadphase check and benchmark and prints the results.
+ * Returns false if anything found the wrong pairs. */
+static
+bool BenchmarkBroadphase()
+{
+    broadphase_bench_data *Data = new broadphase_bench_data;
+    Data->Random = 0x6C8E9CF5;
+
+    unsigned int CoreCount = PlatformGetCoreCount();
+
+    job_system *Jobs = new job_system;
+
+    InitializeJobSystem(Jobs, CoreCount);
+
+    printf("broadphase_backend %s\n", broadphase_backend::Name);
+    printf("broadphase_threads %u\n", CoreCount);
+
+    unsigned int Counts[BROADPHASE_BENCH_SCENES] = { 10000, 100000, 1000000 };
+    bool IsCorrect = true;
+
+    for (unsigned int i = 0; i < BROADPHASE_BENCH_SCENES; i++)
+    {
+        IsCorrect &= BenchmarkBroadphaseScene(Data, Jobs, Counts[i]);
+    }
+
+    ShutdownJobSystem(Jobs);
+
+    delete Jobs;
+
+    printf("broadphase_correct %d\n", IsCorrect ? 1 : 0);
+
+    delete Data;
+
+    return IsCorrect;
+}
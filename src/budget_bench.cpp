@@ -0,0 +1,321 @@
+/**
+ * @file budget_bench.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the checks for what happens when a heap goes over its
+ * memory budget. None of them need a device: the context has two made up
+ * heaps, the budget is the fallback estimate from what we've allocated, and
+ * vkDestroyBuffer() and vkFreeMemory() are swapped out for functions that
+ * count their calls. Platform layers run them with --bench-budget, instead of
+ * the game, and exit with an error if any check fails.
+ */
+
+#include "platform.h"
+#include "render.h"
+
+#define BUDGET_BENCH_HEAP_SIZE MEGABYTES(1000)
+#define BUDGET_BENCH_MAX_CALLS 8
+
+// NOTE[joe] Neither stand in has anywhere for us to hang a pointer, so what
+// they were asked for goes here.
+static unsigned int BudgetBenchDestroyCount;
+static unsigned int BudgetBenchFreeCount;
+
+static VKAPI_ATTR
+void VKAPI_CALL CountBenchDestroyBuffer(VkDevice,
+                                        VkBuffer,
+                                        const VkAllocationCallbacks *)
+{
+    BudgetBenchDestroyCount++;
+}
+
+static VKAPI_ATTR
+void VKAPI_CALL CountBenchFreeMemory(VkDevice,
+                                     VkDeviceMemory,
+                                     const VkAllocationCallbacks *)
+{
+    BudgetBenchFreeCount++;
+}
+
+/** What one of the test handlers was asked for, in the order it was asked. */
+typedef struct {
+    unsigned int Handler;
+    unsigned int Heap;
+    VkDeviceSize Bytes;
+} budget_bench_call;
+
+typedef struct {
+    unsigned int       Index;
+    VkDeviceSize       Frees;
+    unsigned int      *CallCount;
+    budget_bench_call *Calls;
+} budget_bench_handler;
+
+/** Test eviction handler that says it freed however much it was set up to. */
+static
+VkDeviceSize EvictBenchBytes(unsigned int Heap, VkDeviceSize Bytes, void *Data)
+{
+    budget_bench_handler *Handler = (budget_bench_handler *)Data;
+
+    if (*Handler->CallCount < BUDGET_BENCH_MAX_CALLS)
+    {
+        budget_bench_call *Call = &Handler->Calls[(*Handler->CallCount)++];
+        Call->Handler = Handler->Index;
+        Call->Heap = Heap;
+        Call->Bytes = Bytes;
+    }
+
+    return Handler->Frees;
+}
+
+/** Makes it look like Size bytes of memory type TypeIndex were allocated, the
+ * way AllocateDeviceMemory() would have written it down. */
+static
+VkDeviceMemory AddBenchAllocation(vulkan_context *Context,
+                                  uintptr_t Handle,
+                                  VkDeviceSize Size,
+                                  unsigned int TypeIndex)
+{
+    memory_tracker *Tracker = &Context->Memory;
+
+    memory_allocation *Allocation =
+        &Tracker->Allocations[Tracker->AllocationCount++];
+    Allocation->Memory = (VkDeviceMemory)Handle;
+    Allocation->Size = Size;
+    Allocation->TypeIndex = TypeIndex;
+
+    unsigned int Heap = GetDeviceMemoryHeap(Context, Allocation);
+
+    Tracker->Stats.HeapBytes[Heap] += Size;
+    Tracker->Stats.HeapAllocationCount[Heap]++;
+
+    return Allocation->Memory;
+}
+
+/** Sets Context up with two heaps, one memory type each, and nothing
+ * allocated or registered. */
+static
+void ResetBudgetBench(vulkan_context *Context)
+{
+    Context->Memory = {};
+    Context->Resources = {};
+    Context->Particles = {};
+
+    VkPhysicalDeviceMemoryProperties *Properties = &Context->MemoryProperties;
+    *Properties = {};
+    Properties->memoryHeapCount = 2;
+    Properties->memoryHeaps[0].size = BUDGET_BENCH_HEAP_SIZE;
+    Properties->memoryHeaps[1].size = BUDGET_BENCH_HEAP_SIZE;
+    Properties->memoryTypeCount = 2;
+    Properties->memoryTypes[0].heapIndex = 0;
+    Properties->memoryTypes[1].heapIndex = 1;
+
+    BudgetBenchDestroyCount = 0;
+    BudgetBenchFreeCount = 0;
+}
+
+/** Checks when handlers get called, in what order, and with how much. */
+static
+bool CheckBudgetBenchHandlers(vulkan_context *Context)
+{
+    unsigned int CallCount = 0;
+    budget_bench_call Calls[BUDGET_BENCH_MAX_CALLS] = {};
+
+    budget_bench_handler Handlers[3] = {
+        { 0, 0, &CallCount, Calls },
+        { 1, 0, &CallCount, Calls },
+        { 2, 0, &CallCount, Calls },
+    };
+
+    VkDeviceSize Budget = (VkDeviceSize)
+        (BUDGET_BENCH_HEAP_SIZE * MEMORY_BUDGET_FALLBACK);
+    VkDeviceSize HighWater = (VkDeviceSize)
+        (Budget * MEMORY_BUDGET_HIGH_WATER);
+    VkDeviceSize Target = (VkDeviceSize)(Budget * MEMORY_BUDGET_TARGET);
+
+    /** Right at the high water mark nothing is evicted. */
+    ResetBudgetBench(Context);
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        RegisterEvictionHandler(Context, EvictBenchBytes, &Handlers[i]);
+    }
+
+    AddBenchAllocation(Context, 1, HighWater, 0);
+    UpdateMemoryBudget(Context);
+
+    memory_budget *State = &Context->Memory.Budget;
+
+    bool IsUnderQuiet = CallCount == 0 &&
+                        State->EvictionCount == 0 &&
+                        State->HeapBudget[0] == Budget &&
+                        State->HeapUsage[0] == HighWater &&
+                        !State->IsOverBudget[0];
+
+    /** Past it, handlers are asked in order for what's left to get back
+     * down to the target, and the ones after whoever got there aren't. */
+    VkDeviceSize Over = MEGABYTES(1);
+    VkDeviceSize Wanted = HighWater + Over - Target;
+
+    AddBenchAllocation(Context, 2, Over, 0);
+
+    Handlers[0].Frees = Wanted / 4;
+    Handlers[1].Frees = Wanted;
+
+    UpdateMemoryBudget(Context);
+
+    bool IsInOrder = CallCount == 2 &&
+                     Calls[0].Handler == 0 &&
+                     Calls[0].Heap == 0 &&
+                     Calls[0].Bytes == Wanted &&
+                     Calls[1].Handler == 1 &&
+                     Calls[1].Heap == 0 &&
+                     Calls[1].Bytes == Wanted - Wanted / 4 &&
+                     State->EvictionCount == 1 &&
+                     !State->IsOverBudget[0] &&
+                     !State->IsOverBudget[1];
+
+    /** When nobody can free enough, every handler is asked and the heap is
+     * left marked as over budget, until it comes back under. */
+    CallCount = 0;
+    Handlers[0].Frees = 0;
+    Handlers[1].Frees = 0;
+
+    UpdateMemoryBudget(Context);
+
+    bool IsStuck = CallCount == 3 &&
+                   Calls[2].Handler == 2 &&
+                   Calls[2].Bytes == Wanted &&
+                   State->IsOverBudget[0];
+
+    FreeDeviceMemory(Context, (VkDeviceMemory)(uintptr_t)2);
+    UpdateMemoryBudget(Context);
+
+    IsStuck &= CallCount == 3 && !State->IsOverBudget[0];
+
+    printf("budget_under_quiet %d\n", IsUnderQuiet ? 1 : 0);
+    printf("budget_handlers_in_order %d\n", IsInOrder ? 1 : 0);
+    printf("budget_over_marked %d\n", IsStuck ? 1 : 0);
+
+    return IsUnderQuiet && IsInOrder && IsStuck;
+}
+
+/** Checks that the particles give their buffers up when their heap is over
+ * budget, and only then. */
+static
+bool CheckBudgetBenchParticles(vulkan_context *Context)
+{
+    ResetBudgetBench(Context);
+
+    particle_system *Particles = &Context->Particles;
+    Particles->MaxCount = 1024;
+
+    VkBuffer *Buffers[] = {
+        &Particles->PoolBuffer,
+        &Particles->DeadBuffer,
+        &Particles->AliveBuffer,
+        &Particles->CounterBuffer,
+        &Particles->ArgsBuffer,
+    };
+
+    VkDeviceMemory *Memories[] = {
+        &Particles->PoolMemory,
+        &Particles->DeadMemory,
+        &Particles->AliveMemory,
+        &Particles->CounterMemory,
+        &Particles->ArgsMemory,
+    };
+
+    VkDeviceSize ParticleBytes = 0;
+
+    for (unsigned int i = 0; i < 5; i++)
+    {
+        *Buffers[i] = (VkBuffer)(uintptr_t)(10 + i);
+        TrackBuffer(&Context->Resources, *Buffers[i]);
+
+        *Memories[i] = AddBenchAllocation(Context, 10 + i, MEGABYTES(20), 0);
+        ParticleBytes += MEGABYTES(20);
+    }
+
+    // NOTE[joe] Something that isn't ours to evict, so there's something
+    // left once the particles are gone.
+    VkBuffer Other = (VkBuffer)(uintptr_t)20;
+    TrackBuffer(&Context->Resources, Other);
+    AddBenchAllocation(Context, 20, MEGABYTES(10), 0);
+
+    RegisterEvictionHandler(Context, EvictParticles, Context);
+
+    /** Another heap going over doesn't touch them. */
+    AddBenchAllocation(Context, 30, BUDGET_BENCH_HEAP_SIZE, 1);
+    UpdateMemoryBudget(Context);
+
+    bool IsOtherHeapIgnored = Particles->MaxCount == 1024 &&
+                              BudgetBenchDestroyCount == 0 &&
+                              BudgetBenchFreeCount == 0 &&
+                              Context->Memory.Budget.IsOverBudget[1];
+
+    FreeDeviceMemory(Context, (VkDeviceMemory)(uintptr_t)30);
+
+    /** Their own heap going over takes all of them, which is enough to get
+     * it back under. */
+    VkDeviceSize HeapBytes = Context->Memory.Stats.HeapBytes[0];
+    AddBenchAllocation(Context, 40, MEGABYTES(620), 0);
+
+    BudgetBenchFreeCount = 0;
+    UpdateMemoryBudget(Context);
+
+    resource_tracker *Resources = &Context->Resources;
+    memory_stats *Stats = &Context->Memory.Stats;
+
+    bool IsEvicted = Particles->MaxCount == 0 &&
+                     BudgetBenchDestroyCount == 5 &&
+                     BudgetBenchFreeCount == 5 &&
+                     Resources->BufferCount == 1 &&
+                     Resources->Buffers[0].Buffer == Other &&
+                     Context->Memory.AllocationCount == 2 &&
+                     Stats->HeapAllocationCount[0] == 2 &&
+                     Stats->HeapBytes[0] ==
+                         HeapBytes - ParticleBytes + MEGABYTES(620) &&
+                     !Context->Memory.Budget.IsOverBudget[0];
+
+    /** And once they're gone, there's nothing more to take. */
+    AddBenchAllocation(Context, 50, MEGABYTES(100), 0);
+    UpdateMemoryBudget(Context);
+
+    bool IsEvictedOnce = BudgetBenchDestroyCount == 5 &&
+                         BudgetBenchFreeCount == 5 &&
+                         Context->Memory.Budget.IsOverBudget[0];
+
+    printf("budget_particles_other_heap %d\n", IsOtherHeapIgnored ? 1 : 0);
+    printf("budget_particles_evicted %d\n", IsEvicted ? 1 : 0);
+    printf("budget_particles_evicted_once %d\n", IsEvictedOnce ? 1 : 0);
+
+    return IsOtherHeapIgnored && IsEvicted && IsEvictedOnce;
+}
+
+/** Runs the budget checks, printing one line per check, and returns whether
+ * they all passed. */
+bool BenchmarkBudget()
+{
+    vulkan_context *Context = new vulkan_context();
+
+    // NOTE[joe] Whatever the platform loaded goes back once we're done, in
+    // case anything after us wants the real ones.
+    PFN_vkDestroyBuffer DestroyBuffer = vkDestroyBuffer;
+    PFN_vkFreeMemory FreeMemory = vkFreeMemory;
+    vkDestroyBuffer = CountBenchDestroyBuffer;
+    vkFreeMemory = CountBenchFreeMemory;
+
+    bool IsCorrect = CheckBudgetBenchHandlers(Context);
+    IsCorrect &= CheckBudgetBenchParticles(Context);
+
+    vkDestroyBuffer = DestroyBuffer;
+    vkFreeMemory = FreeMemory;
+
+    printf("budget_correct %d\n", IsCorrect ? 1 : 0);
+
+    delete Context;
+
+    return IsCorrect;
+}
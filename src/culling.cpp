@@ -0,0 +1,677 @@
+/**
+ * @file culling.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains our GPU occlusion culling: the buffers and depth pyramid
+ * it works from, and the compute passes that build the pyramid and decide
+ * each pass' draws. See culling.h.
+ */
+
+#include "platform.h"
+#include "render.h"
+#include "culling.h"
+
+static_assert(sizeof(cull_draw) == 96, "cull_draw doesn't match std430");
+
+// NOTE[joe] Nothing checks these against the shaders when they're built, so
+// what hzb_cull.comp and hzb_reduce.comp were written against is checked here
+// instead.
+static_assert(sizeof(cull_constants) == 20,
+              "cull_constants doesn't match hzb_cull.comp");
+static_assert(sizeof(cull_reduce_constants) == 16,
+              "cull_reduce_constants doesn't match hzb_reduce.comp");
+static_assert(RENDER_MAX_DRAWS == 1024,
+              "RENDER_MAX_DRAWS doesn't match MaxDraws in hzb_cull.comp");
+
+/** Creates a buffer of Size bytes and binds it to memory with Flags. */
+static
+VkBuffer CreateCullBuffer(vulkan_context *Context,
+                          VkDeviceSize Size,
+                          VkBufferUsageFlags Usage,
+                          VkMemoryPropertyFlags Flags,
+                          VkDeviceMemory *Memory)
+{
+    VkBufferCreateInfo BufferInfo = {};
+    BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    BufferInfo.size = Size;
+    BufferInfo.usage = Usage;
+    BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkBuffer Buffer;
+    VkResult Result = vkCreateBuffer(Context->Device,
+                                     &BufferInfo,
+                                     GetHostAllocator(Context, HOST_TAG_BUFFER),
+                                     &Buffer);
+
+    Assert(Result == VK_SUCCESS, "Failed to create culling buffer.\n");
+
+    *Memory = AllocateBufferMemory(Context, Buffer, Flags, Flags);
+
+    return Buffer;
+}
+
+/** The biggest power of two no bigger than Size, which is at least one. */
+static
+unsigned int FloorPowerOfTwo(unsigned int Size)
+{
+    unsigned int Result = 1;
+
+    while (Result <= Size / 2)
+    {
+        Result *= 2;
+    }
+
+    return Result;
+}
+
+/** Creates a view of Count of the pyramid's mips, from Mip. */
+static
+VkImageView CreatePyramidView(vulkan_context *Context,
+                              unsigned int Mip,
+                              unsigned int Count)
+{
+    VkImageViewCreateInfo ViewInfo = {};
+    ViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    ViewInfo.image = Context->Culling.Pyramid;
+    ViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    ViewInfo.format = VK_FORMAT_R32_SFLOAT;
+    ViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    ViewInfo.subresourceRange.baseMipLevel = Mip;
+    ViewInfo.subresourceRange.levelCount = Count;
+    ViewInfo.subresourceRange.layerCount = 1;
+
+    VkImageView View;
+    VkResult Result = vkCreateImageView(Context->Device,
+                                        &ViewInfo,
+                                        GetHostAllocator(Context,
+                                                         HOST_TAG_IMAGE),
+                                        &View);
+
+    Assert(Result == VK_SUCCESS, "Failed to create pyramid view.\n");
+
+    return View;
+}
+
+/** Sets up culling for the screen, and queues clearing what's visible on the
+ * setup context, so the first frame's first pass draws nothing and its
+ * second draws whatever's visible. */
+static
+void InitializeCulling(vulkan_context *Context)
+{
+    cull_system *Culling = &Context->Culling;
+    resource_tracker *Resources = &Context->Resources;
+
+    /** Create the buffers. */
+
+    VkMemoryPropertyFlags Mappable = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    VkDeviceMemory Memory;
+
+    // NOTE[joe] Host writes are made visible by the submit, so this one
+    // isn't tracked.
+    Culling->DrawBuffer = CreateCullBuffer(Context,
+                                           RENDER_MAX_DRAWS * sizeof(cull_draw),
+                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                           Mappable,
+                                           &Culling->DrawMemory);
+
+    VkResult Result = vkMapMemory(Context->Device,
+                                  Culling->DrawMemory,
+                                  0,
+                                  VK_WHOLE_SIZE,
+                                  0,
+                                  (void **)&Culling->DrawMapped);
+
+    Assert(Result == VK_SUCCESS, "Failed to map culling draws.\n");
+
+    // NOTE[joe] Tracked for the same reason as the stats.
+    Culling->VisibilityBuffer =
+        CreateCullBuffer(Context,
+                         RENDER_MAX_DRAWS * sizeof(unsigned int),
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         Mappable,
+                         &Culling->VisibilityMemory);
+
+    Result = vkMapMemory(Context->Device,
+                         Culling->VisibilityMemory,
+                         0,
+                         VK_WHOLE_SIZE,
+                         0,
+                         (void **)&Culling->VisibilityMapped);
+
+    Assert(Result == VK_SUCCESS, "Failed to map culling visibility.\n");
+
+    memset(Culling->VisibilityMapped,
+           0,
+           RENDER_MAX_DRAWS * sizeof(unsigned int));
+
+    TrackBuffer(Resources, Culling->VisibilityBuffer);
+
+    Culling->ArgsBuffer =
+        CreateCullBuffer(Context,
+                         CULL_PHASE_COUNT * RENDER_MAX_DRAWS *
+                         sizeof(VkDrawIndirectCommand),
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                         VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                         &Memory);
+
+    TrackBuffer(Resources, Culling->ArgsBuffer);
+
+    // NOTE[joe] Tracked, unlike the draws, because the GPU writes it and we
+    // read it, and that needs a barrier to the host.
+    Culling->StatsBuffer = CreateCullBuffer(Context,
+                                            sizeof(cull_stats),
+                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                            Mappable,
+                                            &Culling->StatsMemory);
+
+    Result = vkMapMemory(Context->Device,
+                         Culling->StatsMemory,
+                         0,
+                         VK_WHOLE_SIZE,
+                         0,
+                         (void **)&Culling->StatsMapped);
+
+    Assert(Result == VK_SUCCESS, "Failed to map culling stats.\n");
+
+    *Culling->StatsMapped = {};
+
+    TrackBuffer(Resources, Culling->StatsBuffer);
+
+    /** Create the pyramid, and a view of each of its mips. */
+
+    Culling->PyramidWidth = FloorPowerOfTwo(Context->Width);
+    Culling->PyramidHeight = FloorPowerOfTwo(Context->Height);
+    Culling->MipCount = 1;
+
+    while ((Culling->PyramidWidth >> Culling->MipCount) ||
+           (Culling->PyramidHeight >> Culling->MipCount))
+    {
+        Culling->MipCount++;
+    }
+
+    Assert(Culling->MipCount <= CULL_MAX_MIPS, "Screen too big to cull.\n");
+
+    VkImageCreateInfo ImageInfo = {};
+    ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    ImageInfo.imageType = VK_IMAGE_TYPE_2D;
+    ImageInfo.format = VK_FORMAT_R32_SFLOAT;
+    ImageInfo.extent = { Culling->PyramidWidth, Culling->PyramidHeight, 1 };
+    ImageInfo.mipLevels = Culling->MipCount;
+    ImageInfo.arrayLayers = 1;
+    ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    ImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ImageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    const VkAllocationCallbacks *ImageAllocator =
+        GetHostAllocator(Context, HOST_TAG_IMAGE);
+
+    Result = vkCreateImage(Context->Device,
+                           &ImageInfo,
+                           ImageAllocator,
+                           &Culling->Pyramid);
+
+    Assert(Result == VK_SUCCESS, "Failed to create depth pyramid.\n");
+
+    AllocateImageMemory(Context,
+                        Culling->Pyramid,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    TrackImage(Resources,
+               Culling->Pyramid,
+               VK_IMAGE_ASPECT_COLOR_BIT,
+               Culling->MipCount,
+               1,
+               VK_IMAGE_LAYOUT_UNDEFINED);
+
+    Culling->PyramidView = CreatePyramidView(Context, 0, Culling->MipCount);
+
+    for (unsigned int Mip = 0; Mip < Culling->MipCount; Mip++)
+    {
+        Culling->MipViews[Mip] = CreatePyramidView(Context, Mip, 1);
+    }
+
+    /** Get at the depth buffer, to build mip 0 from. */
+
+    VkImageViewCreateInfo ViewInfo = {};
+    ViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    ViewInfo.image = Context->DepthImage;
+    ViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    ViewInfo.format = Context->DepthFormat;
+    ViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    ViewInfo.subresourceRange.levelCount = 1;
+    ViewInfo.subresourceRange.layerCount = 1;
+
+    Result = vkCreateImageView(Context->Device,
+                               &ViewInfo,
+                               ImageAllocator,
+                               &Culling->DepthView);
+
+    Assert(Result == VK_SUCCESS, "Failed to create culling depth view.\n");
+
+    // NOTE[joe] Everything's read with texelFetch(), same as the particles'
+    // depth.
+    VkSamplerCreateInfo SamplerInfo = {};
+    SamplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    SamplerInfo.magFilter = VK_FILTER_NEAREST;
+    SamplerInfo.minFilter = VK_FILTER_NEAREST;
+    SamplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    SamplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    SamplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    SamplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    SamplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+    Result = vkCreateSampler(Context->Device,
+                             &SamplerInfo,
+                             ImageAllocator,
+                             &Culling->Sampler);
+
+    Assert(Result == VK_SUCCESS, "Failed to create culling sampler.\n");
+
+    /** Describe it all to the shaders. */
+
+    const VkAllocationCallbacks *Allocator =
+        GetHostAllocator(Context, HOST_TAG_PIPELINE);
+
+    VkDescriptorSetLayoutBinding CullBindings[5] = {};
+
+    for (unsigned int i = 0; i < 5; i++)
+    {
+        CullBindings[i].binding = i;
+        CullBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        CullBindings[i].descriptorCount = 1;
+        CullBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    CullBindings[4].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+    VkDescriptorSetLayoutCreateInfo SetLayoutInfo = {};
+    SetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    SetLayoutInfo.bindingCount = 5;
+    SetLayoutInfo.pBindings = CullBindings;
+
+    Result = vkCreateDescriptorSetLayout(Context->Device,
+                                         &SetLayoutInfo,
+                                         Allocator,
+                                         &Culling->CullSetLayout);
+
+    Assert(Result == VK_SUCCESS, "Failed to create cull set layout.\n");
+
+    VkDescriptorSetLayoutBinding ReduceBindings[2] = {};
+    ReduceBindings[0].binding = 0;
+    ReduceBindings[0].descriptorType =
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    ReduceBindings[0].descriptorCount = 1;
+    ReduceBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    ReduceBindings[1].binding = 1;
+    ReduceBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    ReduceBindings[1].descriptorCount = 1;
+    ReduceBindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    SetLayoutInfo.bindingCount = 2;
+    SetLayoutInfo.pBindings = ReduceBindings;
+
+    Result = vkCreateDescriptorSetLayout(Context->Device,
+                                         &SetLayoutInfo,
+                                         Allocator,
+                                         &Culling->ReduceSetLayout);
+
+    Assert(Result == VK_SUCCESS, "Failed to create reduce set layout.\n");
+
+    VkDescriptorPoolSize PoolSizes[3] = {};
+    PoolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    PoolSizes[0].descriptorCount = 4;
+    PoolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    PoolSizes[1].descriptorCount = 1 + Culling->MipCount;
+    PoolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    PoolSizes[2].descriptorCount = Culling->MipCount;
+
+    VkDescriptorPoolCreateInfo PoolInfo = {};
+    PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    PoolInfo.maxSets = 1 + Culling->MipCount;
+    PoolInfo.poolSizeCount = 3;
+    PoolInfo.pPoolSizes = PoolSizes;
+
+    Result = vkCreateDescriptorPool(Context->Device,
+                                    &PoolInfo,
+                                    Allocator,
+                                    &Culling->DescriptorPool);
+
+    Assert(Result == VK_SUCCESS, "Failed to create culling descriptors.\n");
+
+    VkDescriptorSetAllocateInfo SetInfo = {};
+    SetInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    SetInfo.descriptorPool = Culling->DescriptorPool;
+    SetInfo.descriptorSetCount = 1;
+    SetInfo.pSetLayouts = &Culling->CullSetLayout;
+
+    Result = vkAllocateDescriptorSets(Context->Device,
+                                      &SetInfo,
+                                      &Culling->CullSet);
+
+    Assert(Result == VK_SUCCESS, "Failed to allocate cull descriptors.\n");
+
+    VkDescriptorSetLayout ReduceSetLayouts[CULL_MAX_MIPS];
+
+    for (unsigned int Mip = 0; Mip < Culling->MipCount; Mip++)
+    {
+        ReduceSetLayouts[Mip] = Culling->ReduceSetLayout;
+    }
+
+    SetInfo.descriptorSetCount = Culling->MipCount;
+    SetInfo.pSetLayouts = ReduceSetLayouts;
+
+    Result = vkAllocateDescriptorSets(Context->Device,
+                                      &SetInfo,
+                                      Culling->ReduceSets);
+
+    Assert(Result == VK_SUCCESS, "Failed to allocate reduce descriptors.\n");
+
+    // NOTE[joe] Nothing here ever changes either, so every set is written
+    // once. The pyramid's mips are only ever read in the general layout,
+    // since they're written in it just before.
+    VkDescriptorBufferInfo BufferInfos[4] = {
+        { Culling->DrawBuffer, 0, VK_WHOLE_SIZE },
+        { Culling->VisibilityBuffer, 0, VK_WHOLE_SIZE },
+        { Culling->ArgsBuffer, 0, VK_WHOLE_SIZE },
+        { Culling->StatsBuffer, 0, VK_WHOLE_SIZE },
+    };
+
+    VkDescriptorImageInfo PyramidInfo = {};
+    PyramidInfo.sampler = Culling->Sampler;
+    PyramidInfo.imageView = Culling->PyramidView;
+    PyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    VkWriteDescriptorSet Writes[5] = {};
+
+    for (unsigned int i = 0; i < 5; i++)
+    {
+        Writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        Writes[i].dstSet = Culling->CullSet;
+        Writes[i].dstBinding = i;
+        Writes[i].descriptorCount = 1;
+        Writes[i].descriptorType = CullBindings[i].descriptorType;
+
+        if (i < 4)
+        {
+            Writes[i].pBufferInfo = &BufferInfos[i];
+        }
+        else
+        {
+            Writes[i].pImageInfo = &PyramidInfo;
+        }
+    }
+
+    vkUpdateDescriptorSets(Context->Device, 5, Writes, 0, 0);
+
+    for (unsigned int Mip = 0; Mip < Culling->MipCount; Mip++)
+    {
+        VkDescriptorImageInfo SourceInfo = {};
+        SourceInfo.sampler = Culling->Sampler;
+
+        if (Mip == 0)
+        {
+            SourceInfo.imageView = Culling->DepthView;
+            SourceInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+        else
+        {
+            SourceInfo.imageView = Culling->MipViews[Mip - 1];
+            SourceInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        }
+
+        VkDescriptorImageInfo DestinationInfo = {};
+        DestinationInfo.imageView = Culling->MipViews[Mip];
+        DestinationInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet ReduceWrites[2] = {};
+
+        for (unsigned int i = 0; i < 2; i++)
+        {
+            ReduceWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            ReduceWrites[i].dstSet = Culling->ReduceSets[Mip];
+            ReduceWrites[i].dstBinding = i;
+            ReduceWrites[i].descriptorCount = 1;
+            ReduceWrites[i].descriptorType = ReduceBindings[i].descriptorType;
+        }
+
+        ReduceWrites[0].pImageInfo = &SourceInfo;
+        ReduceWrites[1].pImageInfo = &DestinationInfo;
+
+        vkUpdateDescriptorSets(Context->Device, 2, ReduceWrites, 0, 0);
+    }
+
+    /** Both passes take their sizes through push constants. */
+
+    VkPushConstantRange CullRange = {};
+    CullRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    CullRange.size = sizeof(cull_constants);
+
+    VkPipelineLayoutCreateInfo LayoutInfo = {};
+    LayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    LayoutInfo.setLayoutCount = 1;
+    LayoutInfo.pSetLayouts = &Culling->CullSetLayout;
+    LayoutInfo.pushConstantRangeCount = 1;
+    LayoutInfo.pPushConstantRanges = &CullRange;
+
+    Result = vkCreatePipelineLayout(Context->Device,
+                                    &LayoutInfo,
+                                    Allocator,
+                                    &Culling->CullLayout);
+
+    Assert(Result == VK_SUCCESS, "Failed to create cull layout.\n");
+
+    VkPushConstantRange ReduceRange = {};
+    ReduceRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    ReduceRange.size = sizeof(cull_reduce_constants);
+
+    LayoutInfo.pSetLayouts = &Culling->ReduceSetLayout;
+    LayoutInfo.pPushConstantRanges = &ReduceRange;
+
+    Result = vkCreatePipelineLayout(Context->Device,
+                                    &LayoutInfo,
+                                    Allocator,
+                                    &Culling->ReduceLayout);
+
+    Assert(Result == VK_SUCCESS, "Failed to create reduce layout.\n");
+}
+
+/** Creates one of the culling compute pipelines from Shader, with Layout. */
+static
+VkPipeline CreateCullPipeline(vulkan_context *Context,
+                              VkShaderModule Shader,
+                              VkPipelineLayout Layout)
+{
+    VkComputePipelineCreateInfo PipelineInfo = {};
+    PipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    PipelineInfo.stage.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    PipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    PipelineInfo.stage.module = Shader;
+    PipelineInfo.stage.pName = "main";
+    PipelineInfo.layout = Layout;
+
+    VkPipeline Pipeline;
+    VkResult Result =
+        vkCreateComputePipelines(Context->Device,
+                                 Context->Pipelines.Cache,
+                                 1,
+                                 &PipelineInfo,
+                                 GetHostAllocator(Context, HOST_TAG_PIPELINE),
+                                 &Pipeline);
+
+    Assert(Result == VK_SUCCESS, "Failed to create culling pipeline.\n");
+
+    return Pipeline;
+}
+
+/** Hands Packet's draws to the GPU for this frame's cull passes. Safe to call
+ * once the last frame's fence has signalled. */
+static
+void WriteCullDraws(vulkan_context *Context, const render_packet *Packet)
+{
+    cull_draw *Draws = Context->Culling.DrawMapped;
+
+    for (unsigned int i = 0; i < Packet->DrawCount; i++)
+    {
+        const render_draw *Draw = &Packet->Draws[i];
+
+        Draws[i].Transform = Draw->Instance.Transform;
+        Draws[i].BoundsMin = Draw->BoundsMin;
+        Draws[i].VertexCount = Draw->VertexCount;
+        Draws[i].BoundsMax = Draw->BoundsMax;
+        Draws[i].Padding = 0;
+    }
+}
+
+/** Records Phase's cull pass into CommandBuffer, which writes Phase's draws.
+ * Phase one has to come after RecordDepthPyramid(). */
+static
+void RecordCullPass(vulkan_context *Context,
+                    VkCommandBuffer CommandBuffer,
+                    unsigned int Phase,
+                    unsigned int DrawCount)
+{
+    cull_system *Culling = &Context->Culling;
+    resource_tracker *Resources = &Context->Resources;
+
+    cull_constants Constants;
+    Constants.DrawCount = DrawCount;
+    Constants.Phase = Phase;
+    Constants.PyramidWidth = Culling->PyramidWidth;
+    Constants.PyramidHeight = Culling->PyramidHeight;
+    Constants.PyramidMipCount = Culling->MipCount;
+
+    // NOTE[joe] Phase zero only reads last frame's visibility; phase one
+    // writes this frame's.
+    UseBuffer(Resources,
+              Culling->VisibilityBuffer,
+              Phase == 0 ? RESOURCE_USAGE_COMPUTE_READ :
+                           RESOURCE_USAGE_COMPUTE_WRITE);
+    UseBuffer(Resources, Culling->ArgsBuffer, RESOURCE_USAGE_COMPUTE_WRITE);
+    UseBuffer(Resources, Culling->StatsBuffer, RESOURCE_USAGE_COMPUTE_WRITE);
+
+    // NOTE[joe] Phase zero doesn't look at the pyramid, but the shader's the
+    // same, so it still has to be in the layout its descriptor says. After
+    // the first frame it's still there from the last one's phase one.
+    UseImage(Resources, Culling->Pyramid, RESOURCE_USAGE_COMPUTE_READ);
+
+    FlushBarriers(Resources, CommandBuffer);
+
+    vkCmdBindPipeline(CommandBuffer,
+                      VK_PIPELINE_BIND_POINT_COMPUTE,
+                      Culling->CullPipeline);
+    vkCmdBindDescriptorSets(CommandBuffer,
+                            VK_PIPELINE_BIND_POINT_COMPUTE,
+                            Culling->CullLayout,
+                            0,
+                            1, &Culling->CullSet,
+                            0, 0);
+    vkCmdPushConstants(CommandBuffer,
+                       Culling->CullLayout,
+                       VK_SHADER_STAGE_COMPUTE_BIT,
+                       0,
+                       sizeof(Constants),
+                       &Constants);
+
+    vkCmdDispatch(CommandBuffer,
+                  (DrawCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE,
+                  1,
+                  1);
+}
+
+/** Reduces the depth buffer into the pyramid, a mip at a time, recording
+ * into CommandBuffer. Has to come after the first pass has ended. */
+static
+void RecordDepthPyramid(vulkan_context *Context,
+                        VkCommandBuffer CommandBuffer)
+{
+    cull_system *Culling = &Context->Culling;
+    resource_tracker *Resources = &Context->Resources;
+
+    vkCmdBindPipeline(CommandBuffer,
+                      VK_PIPELINE_BIND_POINT_COMPUTE,
+                      Culling->ReducePipeline);
+
+    cull_reduce_constants Constants;
+    Constants.SourceWidth = Context->Width;
+    Constants.SourceHeight = Context->Height;
+
+    for (unsigned int Mip = 0; Mip < Culling->MipCount; Mip++)
+    {
+        Constants.Width = Culling->PyramidWidth >> Mip;
+        Constants.Height = Culling->PyramidHeight >> Mip;
+        Constants.Width = Constants.Width ? Constants.Width : 1;
+        Constants.Height = Constants.Height ? Constants.Height : 1;
+
+        // NOTE[joe] Each mip only waits on the one before it, and the
+        // tracker only transitions the mips we name.
+        if (Mip == 0)
+        {
+            UseImage(Resources,
+                     Context->DepthImage,
+                     RESOURCE_USAGE_COMPUTE_SAMPLED);
+        }
+        else
+        {
+            UseImageMips(Resources,
+                         Culling->Pyramid,
+                         RESOURCE_USAGE_COMPUTE_READ,
+                         Mip - 1,
+                         1);
+        }
+
+        UseImageMips(Resources,
+                     Culling->Pyramid,
+                     RESOURCE_USAGE_COMPUTE_WRITE,
+                     Mip,
+                     1);
+
+        FlushBarriers(Resources, CommandBuffer);
+
+        vkCmdBindDescriptorSets(CommandBuffer,
+                                VK_PIPELINE_BIND_POINT_COMPUTE,
+                                Culling->ReduceLayout,
+                                0,
+                                1, &Culling->ReduceSets[Mip],
+                                0, 0);
+        vkCmdPushConstants(CommandBuffer,
+                           Culling->ReduceLayout,
+                           VK_SHADER_STAGE_COMPUTE_BIT,
+                           0,
+                           sizeof(Constants),
+                           &Constants);
+
+        vkCmdDispatch(CommandBuffer,
+                      (Constants.Width + CULL_REDUCE_GROUP_SIZE - 1) /
+                      CULL_REDUCE_GROUP_SIZE,
+                      (Constants.Height + CULL_REDUCE_GROUP_SIZE - 1) /
+                      CULL_REDUCE_GROUP_SIZE,
+                      1);
+
+        Constants.SourceWidth = Constants.Width;
+        Constants.SourceHeight = Constants.Height;
+    }
+}
+
+/** Adds the frame that just finished to the totals, and zeroes the stats for
+ * the next one. Only safe once the frame's fence has signalled. */
+static
+void ReadCullStats(vulkan_context *Context)
+{
+    cull_system *Culling = &Context->Culling;
+    cull_stats *Stats = Culling->StatsMapped;
+
+    Culling->FrameCount++;
+    Culling->TestedCount += Stats->TestedCount;
+    Culling->FirstPassCount += Stats->FirstPassCount;
+    Culling->SecondPassCount += Stats->SecondPassCount;
+    Culling->CulledCount += Stats->CulledCount;
+
+    *Stats = {};
+}
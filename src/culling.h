@@ -0,0 +1,138 @@
+/**
+ * @file culling.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the definitions for our GPU occlusion culling, which
+ * decides which of a frame's draws actually get drawn, on the GPU, using a
+ * hierarchical depth buffer.
+ *
+ * Each frame is drawn in two passes. The first draws whatever was visible
+ * last frame, which is nearly always nearly everything that's visible now.
+ * Its depth is then reduced into a pyramid of mips, each texel of which is
+ * the farthest depth of the four under it, so that a box of any size can be
+ * tested against it with four reads from the right mip. Every draw's bounds
+ * are tested against the pyramid, which decides what's visible next frame,
+ * and anything that turns out visible now but wasn't drawn in the first pass
+ * is drawn in a second one, on top of the first. Each draw is an indirect
+ * draw, whose instance count the GPU sets to one or zero. All that comes
+ * back to the CPU is the statistics, and each draw's visibility, so that a
+ * draw is only recorded into the pass that can draw it.
+ *
+ * Visibility is remembered by draw index, so a draw that stays at the same
+ * index in the render_packet from frame to frame gets the most out of it. A
+ * draw that moves only costs a frame of being drawn in the second pass.
+ */
+
+#ifndef _CULLING_H_
+#define _CULLING_H_
+
+#include "linear_math.h"
+
+// NOTE[joe] Has to match local_size_x in hzb_cull.comp, and local_size_x and
+// local_size_y in hzb_reduce.comp.
+#define CULL_GROUP_SIZE 64
+#define CULL_REDUCE_GROUP_SIZE 8
+
+// NOTE[joe] Every mip of the pyramid is tracked, so it can't have more than
+// the tracker can hold. That's still a 32768 pixel wide screen.
+#define CULL_MAX_MIPS RESOURCE_MAX_SUBRESOURCES
+
+#define CULL_PHASE_COUNT 2
+
+/** A draw's bounds, handed to the shaders. The same layout as the shaders',
+ * under std430. */
+typedef struct {
+    // NOTE[joe] From the bounds' space to clip space.
+    mat4         Transform;
+    vec3         BoundsMin;
+    unsigned int VertexCount;
+    vec3         BoundsMax;
+    unsigned int Padding;
+} cull_draw;
+
+/** Counted up by the GPU over a frame, and read back once it's done. */
+typedef struct {
+    unsigned int TestedCount;
+    // NOTE[joe] Drawn in the first pass, because they were visible last
+    // frame, and in the second, because they weren't but are now.
+    unsigned int FirstPassCount;
+    unsigned int SecondPassCount;
+    // NOTE[joe] Drawn in neither. The three of them add up to TestedCount.
+    unsigned int CulledCount;
+} cull_stats;
+
+/** The cull pass' push constants. Has to match the Cull block in
+ * hzb_cull.comp. */
+typedef struct {
+    unsigned int DrawCount;
+    unsigned int Phase;
+    unsigned int PyramidWidth;
+    unsigned int PyramidHeight;
+    unsigned int PyramidMipCount;
+} cull_constants;
+
+/** The reduce pass' push constants. Has to match the Reduce block in
+ * hzb_reduce.comp. */
+typedef struct {
+    unsigned int SourceWidth;
+    unsigned int SourceHeight;
+    unsigned int Width;
+    unsigned int Height;
+} cull_reduce_constants;
+
+typedef struct {
+    // NOTE[joe] Persistently mapped and rewritten every frame, the same as
+    // the joint palette.
+    VkBuffer              DrawBuffer;
+    VkDeviceMemory        DrawMemory;
+    cull_draw            *DrawMapped;
+
+    // NOTE[joe] One per draw, from the last test each one had. Mapped too,
+    // and read once the frame that wrote it is done, at which point it's what
+    // the next frame's first pass goes by.
+    VkBuffer              VisibilityBuffer;
+    VkDeviceMemory        VisibilityMemory;
+    unsigned int         *VisibilityMapped;
+    // NOTE[joe] Each phase's draws, RENDER_MAX_DRAWS of them each.
+    VkBuffer              ArgsBuffer;
+
+    // NOTE[joe] Mapped as well, and zeroed by us after every frame's read.
+    VkBuffer              StatsBuffer;
+    VkDeviceMemory        StatsMemory;
+    cull_stats           *StatsMapped;
+
+    // NOTE[joe] Mip 0 is the biggest power of two that fits in the screen,
+    // each way, so every mip after it is exactly half the last.
+    VkImage               Pyramid;
+    unsigned int          PyramidWidth;
+    unsigned int          PyramidHeight;
+    unsigned int          MipCount;
+    VkImageView           PyramidView;
+    VkImageView           MipViews[CULL_MAX_MIPS];
+
+    // NOTE[joe] Just the depth aspect, which is all a shader can sample.
+    VkImageView           DepthView;
+    VkSampler             Sampler;
+
+    VkDescriptorSetLayout CullSetLayout;
+    VkDescriptorSetLayout ReduceSetLayout;
+    VkDescriptorPool      DescriptorPool;
+    VkDescriptorSet       CullSet;
+    // NOTE[joe] One per mip, each reading the one before it, or the depth
+    // buffer for mip 0.
+    VkDescriptorSet       ReduceSets[CULL_MAX_MIPS];
+    VkPipelineLayout      CullLayout;
+    VkPipelineLayout      ReduceLayout;
+    VkPipeline            CullPipeline;
+    VkPipeline            ReducePipeline;
+
+    // NOTE[joe] Summed over every frame read back so far, for the curious.
+    unsigned long long    FrameCount;
+    unsigned long long    TestedCount;
+    unsigned long long    FirstPassCount;
+    unsigned long long    SecondPassCount;
+    unsigned long long    CulledCount;
+} cull_system;
+
+#endif
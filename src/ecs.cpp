@@ -0,0 +1,698 @@
+/**
+ * @file ecs.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our entity component system. See ecs.h.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "job.h"
+#include "ecs.h"
+
+#define ECS_INITIAL_ENTITY_CAPACITY 1024
+#define ECS_INITIAL_CHUNK_CAPACITY 16
+
+/** Returns the component's id, for masks and lookups. Components have to be
+ * registered before the first archetype that uses them is created. */
+static
+unsigned int RegisterComponent(ecs_world *World,
+                               unsigned int Size,
+                               unsigned int Alignment,
+                               const char *Name)
+{
+    Assert(World->ComponentCount < ECS_MAX_COMPONENTS,
+           "Too many component types.\n");
+    Assert(Alignment <= ECS_COLUMN_ALIGNMENT,
+           "Component is aligned past a column.\n");
+
+    unsigned int Component = World->ComponentCount++;
+
+    World->Components[Component].Size = Size;
+    World->Components[Component].Alignment = Alignment;
+    World->Components[Component].Name = Name;
+
+    return Component;
+}
+
+static
+unsigned int CreateArchetype(ecs_world *World, component_mask Mask)
+{
+    Assert(World->ArchetypeCount < ECS_MAX_ARCHETYPES,
+           "Too many archetypes.\n");
+
+    unsigned int Index = World->ArchetypeCount++;
+
+    ecs_archetype *Archetype = &World->Archetypes[Index];
+    *Archetype = {};
+    Archetype->Mask = Mask;
+
+    unsigned int RowSize = sizeof(entity);
+
+    for (unsigned int Component = 0;
+         Component < World->ComponentCount;
+         Component++)
+    {
+        if (Mask & COMPONENT_BIT(Component))
+        {
+            Archetype->Components[Archetype->ComponentCount++] =
+                (unsigned char)Component;
+            RowSize += World->Components[Component].Size;
+        }
+    }
+
+    Assert(World->ComponentCount == ECS_MAX_COMPONENTS ||
+           Mask >> World->ComponentCount == 0,
+           "Archetype uses an unregistered component.\n");
+
+    // NOTE[joe] Leave room to pad every column out to a cache line.
+    unsigned int Padding = (Archetype->ComponentCount + 1) *
+                           ECS_COLUMN_ALIGNMENT;
+
+    Assert(RowSize + Padding <= ECS_CHUNK_SIZE,
+           "Archetype too big to fit in a chunk.\n");
+
+    Archetype->RowsPerChunk = (ECS_CHUNK_SIZE - Padding) / RowSize;
+
+    unsigned int Offset = Archetype->RowsPerChunk * sizeof(entity);
+
+    for (unsigned int i = 0; i < Archetype->ComponentCount; i++)
+    {
+        unsigned int Component = Archetype->Components[i];
+
+        Offset = (Offset + ECS_COLUMN_ALIGNMENT - 1) &
+                 ~(ECS_COLUMN_ALIGNMENT - 1);
+
+        Archetype->Offsets[Component] = Offset;
+
+        Offset += Archetype->RowsPerChunk * World->Components[Component].Size;
+    }
+
+    Assert(Offset <= ECS_CHUNK_SIZE, "Chunk layout overflowed.\n");
+
+    for (unsigned int i = 0; i < ECS_MAX_COMPONENTS; i++)
+    {
+        Archetype->AddEdges[i] = ECS_NO_ARCHETYPE;
+        Archetype->RemoveEdges[i] = ECS_NO_ARCHETYPE;
+    }
+
+    return Index;
+}
+
+/** Returns the archetype for exactly the components in Mask, creating it if
+ * this is the first entity to have them. */
+static
+unsigned int GetArchetype(ecs_world *World, component_mask Mask)
+{
+    for (unsigned int i = 0; i < World->ArchetypeCount; i++)
+    {
+        if (World->Archetypes[i].Mask == Mask)
+        {
+            return i;
+        }
+    }
+
+    return CreateArchetype(World, Mask);
+}
+
+/** Sets World up to allocate from Arena, which it doesn't own. */
+static
+void InitializeWorld(ecs_world *World, memory_arena *Arena)
+{
+    World->Arena = Arena;
+    World->ComponentCount = 0;
+    World->ArchetypeCount = 0;
+    World->EntityCapacity = 0;
+    World->EntityCount = 0;
+    World->FreeEntity = ECS_NO_ENTITY;
+    World->Entities = 0;
+    World->FreeChunks = 0;
+}
+
+static
+unsigned char *AllocateChunk(ecs_world *World)
+{
+    unsigned char *Chunk = World->FreeChunks;
+
+    if (Chunk)
+    {
+        World->FreeChunks = *(unsigned char **)Chunk;
+        return Chunk;
+    }
+
+    return (unsigned char *)PushSize(World->Arena,
+                                     ECS_CHUNK_SIZE,
+                                     ECS_COLUMN_ALIGNMENT);
+}
+
+static
+void FreeChunk(ecs_world *World, unsigned char *Chunk)
+{
+    *(unsigned char **)Chunk = World->FreeChunks;
+    World->FreeChunks = Chunk;
+}
+
+static inline
+unsigned char *GetRowComponent(ecs_world *World,
+                               ecs_archetype *Archetype,
+                               unsigned int Row,
+                               unsigned int Component)
+{
+    unsigned char *Chunk = Archetype->Chunks[Row / Archetype->RowsPerChunk];
+    unsigned int Size = World->Components[Component].Size;
+
+    return Chunk +
+           Archetype->Offsets[Component] +
+           (Row % Archetype->RowsPerChunk) * Size;
+}
+
+static inline
+entity *GetRowEntity(ecs_archetype *Archetype, unsigned int Row)
+{
+    unsigned char *Chunk = Archetype->Chunks[Row / Archetype->RowsPerChunk];
+
+    return (entity *)Chunk + Row % Archetype->RowsPerChunk;
+}
+
+/** Returns a new row on the end of Archetype, with its components zeroed. */
+static
+unsigned int AllocateRow(ecs_world *World,
+                         ecs_archetype *Archetype,
+                         entity Entity)
+{
+    if (Archetype->EntityCount ==
+        Archetype->ChunkCount * Archetype->RowsPerChunk)
+    {
+        if (Archetype->ChunkCount == Archetype->ChunkCapacity)
+        {
+            // NOTE[joe] The old table is left behind in the arena. It's a
+            // pointer per chunk, so doubling keeps the waste small.
+            unsigned int Capacity = Archetype->ChunkCapacity ?
+                                    Archetype->ChunkCapacity * 2 :
+                                    ECS_INITIAL_CHUNK_CAPACITY;
+
+            unsigned char **Chunks = PushArray(World->Arena,
+                                               unsigned char *,
+                                               Capacity);
+
+            if (Archetype->ChunkCount)
+            {
+                memcpy(Chunks,
+                       Archetype->Chunks,
+                       Archetype->ChunkCount * sizeof(unsigned char *));
+            }
+
+            Archetype->Chunks = Chunks;
+            Archetype->ChunkCapacity = Capacity;
+        }
+
+        Archetype->Chunks[Archetype->ChunkCount++] = AllocateChunk(World);
+    }
+
+    unsigned int Row = Archetype->EntityCount++;
+
+    *GetRowEntity(Archetype, Row) = Entity;
+
+    for (unsigned int i = 0; i < Archetype->ComponentCount; i++)
+    {
+        unsigned int Component = Archetype->Components[i];
+
+        memset(GetRowComponent(World, Archetype, Row, Component),
+               0,
+               World->Components[Component].Size);
+    }
+
+    return Row;
+}
+
+/** Takes Row out of Archetype by moving the last row into its place, so
+ * that the archetype stays packed. */
+static
+void RemoveRow(ecs_world *World, ecs_archetype *Archetype, unsigned int Row)
+{
+    unsigned int Last = Archetype->EntityCount - 1;
+
+    if (Row != Last)
+    {
+        entity Moved = *GetRowEntity(Archetype, Last);
+        *GetRowEntity(Archetype, Row) = Moved;
+
+        for (unsigned int i = 0; i < Archetype->ComponentCount; i++)
+        {
+            unsigned int Component = Archetype->Components[i];
+
+            memcpy(GetRowComponent(World, Archetype, Row, Component),
+                   GetRowComponent(World, Archetype, Last, Component),
+                   World->Components[Component].Size);
+        }
+
+        World->Entities[Moved.Index].Row = Row;
+    }
+
+    Archetype->EntityCount--;
+
+    if (Archetype->EntityCount ==
+        (Archetype->ChunkCount - 1) * Archetype->RowsPerChunk)
+    {
+        FreeChunk(World, Archetype->Chunks[--Archetype->ChunkCount]);
+    }
+}
+
+static
+ecs_entity_record *GetEntityRecord(ecs_world *World, entity Entity)
+{
+    Assert(Entity.Index < World->EntityCount, "Entity out of range.\n");
+
+    ecs_entity_record *Record = &World->Entities[Entity.Index];
+
+    Assert(Record->Generation == Entity.Generation &&
+           Record->Archetype != ECS_NO_ARCHETYPE,
+           "Entity has been destroyed.\n");
+
+    return Record;
+}
+
+static
+bool IsEntityAlive(ecs_world *World, entity Entity)
+{
+    if (Entity.Index >= World->EntityCount)
+    {
+        return false;
+    }
+
+    ecs_entity_record *Record = &World->Entities[Entity.Index];
+
+    return Record->Generation == Entity.Generation &&
+           Record->Archetype != ECS_NO_ARCHETYPE;
+}
+
+/** Returns a new entity with the components in Mask, all zeroed. */
+static
+entity CreateEntity(ecs_world *World, component_mask Mask)
+{
+    entity Entity;
+
+    if (World->FreeEntity != ECS_NO_ENTITY)
+    {
+        Entity.Index = World->FreeEntity;
+        World->FreeEntity = World->Entities[Entity.Index].Row;
+    }
+    else
+    {
+        if (World->EntityCount == World->EntityCapacity)
+        {
+            unsigned int Capacity = World->EntityCapacity ?
+                                    World->EntityCapacity * 2 :
+                                    ECS_INITIAL_ENTITY_CAPACITY;
+
+            ecs_entity_record *Entities = PushArray(World->Arena,
+                                                    ecs_entity_record,
+                                                    Capacity);
+
+            if (World->EntityCount)
+            {
+                memcpy(Entities,
+                       World->Entities,
+                       World->EntityCount * sizeof(ecs_entity_record));
+            }
+
+            World->Entities = Entities;
+            World->EntityCapacity = Capacity;
+        }
+
+        Entity.Index = World->EntityCount++;
+        World->Entities[Entity.Index].Generation = 0;
+    }
+
+    ecs_entity_record *Record = &World->Entities[Entity.Index];
+    Entity.Generation = Record->Generation;
+
+    unsigned int Archetype = GetArchetype(World, Mask);
+
+    Record->Archetype = (unsigned short)Archetype;
+    Record->Row = AllocateRow(World, &World->Archetypes[Archetype], Entity);
+
+    return Entity;
+}
+
+static
+void DestroyEntity(ecs_world *World, entity Entity)
+{
+    ecs_entity_record *Record = GetEntityRecord(World, Entity);
+
+    RemoveRow(World, &World->Archetypes[Record->Archetype], Record->Row);
+
+    Record->Archetype = ECS_NO_ARCHETYPE;
+    Record->Generation++;
+    Record->Row = World->FreeEntity;
+    World->FreeEntity = Entity.Index;
+}
+
+/** Moves Entity's components over to Archetype, dropping any it doesn't
+ * have and zeroing any that are new. */
+static
+void MoveEntity(ecs_world *World, entity Entity, unsigned int To)
+{
+    ecs_entity_record *Record = &World->Entities[Entity.Index];
+
+    ecs_archetype *Source = &World->Archetypes[Record->Archetype];
+    ecs_archetype *Destination = &World->Archetypes[To];
+
+    unsigned int Row = AllocateRow(World, Destination, Entity);
+
+    for (unsigned int i = 0; i < Destination->ComponentCount; i++)
+    {
+        unsigned int Component = Destination->Components[i];
+
+        if (Source->Mask & COMPONENT_BIT(Component))
+        {
+            memcpy(GetRowComponent(World, Destination, Row, Component),
+                   GetRowComponent(World, Source, Record->Row, Component),
+                   World->Components[Component].Size);
+        }
+    }
+
+    RemoveRow(World, Source, Record->Row);
+
+    Record->Archetype = (unsigned short)To;
+    Record->Row = Row;
+}
+
+static
+bool HasComponent(ecs_world *World, entity Entity, unsigned int Component)
+{
+    ecs_entity_record *Record = GetEntityRecord(World, Entity);
+
+    return (World->Archetypes[Record->Archetype].Mask &
+            COMPONENT_BIT(Component)) != 0;
+}
+
+/** Returns Entity's Component, or zero if it doesn't have one. Only good
+ * until the next structural change (anything that creates, destroys or moves
+ * an entity). */
+static
+void *GetComponent(ecs_world *World, entity Entity, unsigned int Component)
+{
+    ecs_entity_record *Record = GetEntityRecord(World, Entity);
+    ecs_archetype *Archetype = &World->Archetypes[Record->Archetype];
+
+    if (!(Archetype->Mask & COMPONENT_BIT(Component)))
+    {
+        return 0;
+    }
+
+    return GetRowComponent(World, Archetype, Record->Row, Component);
+}
+
+/** Adds Component to Entity and returns it, zeroed. If Entity already has
+ * one, returns that instead. */
+static
+void *AddComponent(ecs_world *World, entity Entity, unsigned int Component)
+{
+    ecs_entity_record *Record = GetEntityRecord(World, Entity);
+    ecs_archetype *Archetype = &World->Archetypes[Record->Archetype];
+
+    if (!(Archetype->Mask & COMPONENT_BIT(Component)))
+    {
+        unsigned int To = Archetype->AddEdges[Component];
+
+        if (To == ECS_NO_ARCHETYPE)
+        {
+            To = GetArchetype(World,
+                              Archetype->Mask | COMPONENT_BIT(Component));
+
+            // NOTE[joe] Creating an archetype never moves the others, so
+            // Archetype is still good here.
+            Archetype->AddEdges[Component] = (unsigned short)To;
+            World->Archetypes[To].RemoveEdges[Component] =
+                (unsigned short)Record->Archetype;
+        }
+
+        MoveEntity(World, Entity, To);
+    }
+
+    return GetComponent(World, Entity, Component);
+}
+
+static
+void RemoveComponent(ecs_world *World, entity Entity, unsigned int Component)
+{
+    ecs_entity_record *Record = GetEntityRecord(World, Entity);
+    ecs_archetype *Archetype = &World->Archetypes[Record->Archetype];
+
+    if (Archetype->Mask & COMPONENT_BIT(Component))
+    {
+        unsigned int To = Archetype->RemoveEdges[Component];
+
+        if (To == ECS_NO_ARCHETYPE)
+        {
+            To = GetArchetype(World,
+                              Archetype->Mask & ~COMPONENT_BIT(Component));
+
+            Archetype->RemoveEdges[Component] = (unsigned short)To;
+            World->Archetypes[To].AddEdges[Component] =
+                (unsigned short)Record->Archetype;
+        }
+
+        MoveEntity(World, Entity, To);
+    }
+}
+
+static
+ecs_query CreateQuery(component_mask All, component_mask None)
+{
+    ecs_query Query = {};
+    Query.All = All;
+    Query.None = None;
+
+    return Query;
+}
+
+/** Adds any archetypes created since the last update that Query matches. */
+static
+void UpdateQuery(ecs_world *World, ecs_query *Query)
+{
+    for (unsigned int i = Query->CheckedArchetypeCount;
+         i < World->ArchetypeCount;
+         i++)
+    {
+        component_mask Mask = World->Archetypes[i].Mask;
+
+        if ((Mask & Query->All) == Query->All && !(Mask & Query->None))
+        {
+            Query->Archetypes[Query->ArchetypeCount++] = (unsigned short)i;
+        }
+    }
+
+    Query->CheckedArchetypeCount = World->ArchetypeCount;
+}
+
+static
+ecs_iterator BeginQuery(ecs_world *World, ecs_query *Query)
+{
+    UpdateQuery(World, Query);
+
+    ecs_iterator Iterator = {};
+    Iterator.Query = Query;
+
+    return Iterator;
+}
+
+/** Moves Iterator on to the next chunk with any entities in it. Returns false
+ * once there are none left. */
+static
+bool NextChunk(ecs_world *World, ecs_iterator *Iterator)
+{
+    ecs_query *Query = Iterator->Query;
+
+    while (Iterator->QueryIndex < Query->ArchetypeCount)
+    {
+        ecs_archetype *Archetype =
+            &World->Archetypes[Query->Archetypes[Iterator->QueryIndex]];
+
+        if (Iterator->ChunkIndex < Archetype->ChunkCount)
+        {
+            unsigned int First = Iterator->ChunkIndex *
+                                 Archetype->RowsPerChunk;
+            unsigned int Count = Archetype->EntityCount - First;
+
+            if (Count > Archetype->RowsPerChunk)
+            {
+                Count = Archetype->RowsPerChunk;
+            }
+
+            Iterator->View.Archetype = Archetype;
+            Iterator->View.Chunk = Archetype->Chunks[Iterator->ChunkIndex];
+            Iterator->View.Count = Count;
+
+            Iterator->ChunkIndex++;
+
+            return true;
+        }
+
+        Iterator->QueryIndex++;
+        Iterator->ChunkIndex = 0;
+    }
+
+    return false;
+}
+
+/** Returns the start of Component's array in View's chunk. The component has
+ * to be one the archetype has. */
+static inline
+void *GetChunkColumn(ecs_chunk_view *View, unsigned int Component)
+{
+    Assert(View->Archetype->Mask & COMPONENT_BIT(Component),
+           "Chunk doesn't have that component.\n");
+
+    return View->Chunk + View->Archetype->Offsets[Component];
+}
+
+static inline
+entity *GetChunkEntities(ecs_chunk_view *View)
+{
+    return (entity *)View->Chunk;
+}
+
+/** Runs System over every chunk it matches, on the calling thread. */
+static
+void RunSystem(ecs_world *World, ecs_system *System)
+{
+    ecs_iterator Iterator = BeginQuery(World, &System->Query);
+
+    while (NextChunk(World, &Iterator))
+    {
+        System->Function(&Iterator.View, System->Data);
+    }
+}
+
+static
+void RunSystemChunks(void *Data, unsigned int Start, unsigned int End)
+{
+    ecs_system_run *Run = (ecs_system_run *)Data;
+    ecs_world *World = Run->World;
+    ecs_query *Query = &Run->System->Query;
+
+    unsigned int QueryIndex = 0;
+
+    while (Run->FirstChunk[QueryIndex + 1] <= Start)
+    {
+        QueryIndex++;
+    }
+
+    for (unsigned int i = Start; i < End; i++)
+    {
+        while (Run->FirstChunk[QueryIndex + 1] <= i)
+        {
+            QueryIndex++;
+        }
+
+        ecs_archetype *Archetype =
+            &World->Archetypes[Query->Archetypes[QueryIndex]];
+
+        unsigned int ChunkIndex = i - Run->FirstChunk[QueryIndex];
+        unsigned int First = ChunkIndex * Archetype->RowsPerChunk;
+        unsigned int Count = Archetype->EntityCount - First;
+
+        if (Count > Archetype->RowsPerChunk)
+        {
+            Count = Archetype->RowsPerChunk;
+        }
+
+        ecs_chunk_view View;
+        View.Archetype = Archetype;
+        View.Chunk = Archetype->Chunks[ChunkIndex];
+        View.Count = Count;
+
+        Run->System->Function(&View, Run->System->Data);
+    }
+}
+
+static
+void EcsPhaseJob(job_system *Jobs, job *Job, void *Data)
+{
+}
+
+/** Returns true if A and B can't run at the same time, i.e. one of them
+ * writes something the other reads or writes. */
+static
+bool DoSystemsConflict(ecs_system *A, ecs_system *B)
+{
+    return (A->Writes & (B->Reads | B->Writes)) ||
+           (B->Writes & A->Reads);
+}
+
+/** Runs Systems across the job system and waits for them. Systems are split
+ * into phases, each system going in the phase after the last earlier system
+ * it conflicts with. Within a phase, everything runs at once, a chunk at a
+ * time. Nothing may create, destroy or move entities until this returns. */
+static
+void RunSystems(ecs_world *World,
+                job_system *Jobs,
+                ecs_system *Systems,
+                unsigned int SystemCount)
+{
+    Assert(SystemCount <= ECS_MAX_SYSTEMS, "Too many systems.\n");
+
+    unsigned int Phases[ECS_MAX_SYSTEMS];
+    unsigned int PhaseCount = 0;
+
+    for (unsigned int i = 0; i < SystemCount; i++)
+    {
+        Phases[i] = 0;
+
+        for (unsigned int j = 0; j < i; j++)
+        {
+            if (Phases[j] >= Phases[i] &&
+                DoSystemsConflict(&Systems[i], &Systems[j]))
+            {
+                Phases[i] = Phases[j] + 1;
+            }
+        }
+
+        if (Phases[i] + 1 > PhaseCount)
+        {
+            PhaseCount = Phases[i] + 1;
+        }
+
+        ecs_system_run *Run = &World->Runs[i];
+        Run->World = World;
+        Run->System = &Systems[i];
+
+        UpdateQuery(World, &Systems[i].Query);
+
+        ecs_query *Query = &Systems[i].Query;
+        unsigned int ChunkCount = 0;
+
+        for (unsigned int q = 0; q < Query->ArchetypeCount; q++)
+        {
+            Run->FirstChunk[q] = ChunkCount;
+            ChunkCount += World->Archetypes[Query->Archetypes[q]].ChunkCount;
+        }
+
+        Run->FirstChunk[Query->ArchetypeCount] = ChunkCount;
+    }
+
+    for (unsigned int Phase = 0; Phase < PhaseCount; Phase++)
+    {
+        job *Root = CreateJob(Jobs, EcsPhaseJob, 0, 0, 0);
+
+        for (unsigned int i = 0; i < SystemCount; i++)
+        {
+            ecs_system_run *Run = &World->Runs[i];
+            unsigned int ChunkCount =
+                Run->FirstChunk[Systems[i].Query.ArchetypeCount];
+
+            if (Phases[i] == Phase && ChunkCount)
+            {
+                // NOTE[joe] A chunk is already a good few thousand bytes of
+                // work, so let ParallelFor() hand them out one at a time.
+                ParallelFor(Jobs, RunSystemChunks, Run, ChunkCount, 1, Root);
+            }
+        }
+
+        RunJob(Jobs, Root);
+        WaitForJob(Jobs, Root);
+    }
+}
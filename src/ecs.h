@@ -0,0 +1,157 @@
+/**
+ * @file ecs.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for our entity component system.
+ * Entities with the same set of components share an archetype, which keeps
+ * them in fixed size chunks, one array per component. Archetypes stay packed:
+ * every chunk but the last is full, so going through all of an archetype's
+ * entities is a straight walk through memory.
+ *
+ * Creating and destroying entities, or adding and removing components, is
+ * only done from one thread at a time (the game thread). Systems read and
+ * write component data in parallel, but never change which entities exist.
+ */
+
+#ifndef _ECS_H_
+#define _ECS_H_
+
+#define ECS_CHUNK_SIZE KILOBYTES(16)
+
+// NOTE[joe] Component masks are one bit per component.
+#define ECS_MAX_COMPONENTS 64
+#define ECS_MAX_ARCHETYPES 256
+#define ECS_MAX_SYSTEMS 64
+
+// NOTE[joe] Columns start on a cache line, so that no two columns share one
+// and SIMD loads of a column are always aligned.
+#define ECS_COLUMN_ALIGNMENT 64
+
+#define ECS_NO_ARCHETYPE 0xFFFF
+#define ECS_NO_ENTITY 0xFFFFFFFF
+
+typedef unsigned long long component_mask;
+
+#define COMPONENT_BIT(Component) ((component_mask)1 << (Component))
+
+/** Entities are an index plus a generation, which goes up every time the
+ * index is reused, so that a stale entity can't touch its replacement. */
+typedef struct {
+    unsigned int Index;
+    unsigned int Generation;
+} entity;
+
+typedef struct {
+    unsigned int  Size;
+    unsigned int  Alignment;
+    const char   *Name;
+} ecs_component_info;
+
+typedef struct {
+    component_mask   Mask;
+    unsigned int     ComponentCount;
+    unsigned char    Components[ECS_MAX_COMPONENTS];
+
+    // NOTE[joe] Where each component's column starts within a chunk,
+    // indexed by component. The entity column always comes first.
+    unsigned int     Offsets[ECS_MAX_COMPONENTS];
+    unsigned int     RowsPerChunk;
+
+    unsigned int     EntityCount;
+    unsigned int     ChunkCount;
+    unsigned int     ChunkCapacity;
+    unsigned char  **Chunks;
+
+    // NOTE[joe] The archetype with one more (or one fewer) component, found
+    // the first time we need it. ECS_NO_ARCHETYPE until then.
+    unsigned short   AddEdges[ECS_MAX_COMPONENTS];
+    unsigned short   RemoveEdges[ECS_MAX_COMPONENTS];
+} ecs_archetype;
+
+typedef struct {
+    unsigned short Archetype;
+    // NOTE[joe] While an entity is dead, Row is the next free index instead.
+    unsigned int   Row;
+    unsigned int   Generation;
+} ecs_entity_record;
+
+/** Every archetype with all of All and none of None. Matches are cached, and
+ * only archetypes created since the last update get checked. */
+typedef struct {
+    component_mask All;
+    component_mask None;
+
+    unsigned int   CheckedArchetypeCount;
+    unsigned int   ArchetypeCount;
+    unsigned short Archetypes[ECS_MAX_ARCHETYPES];
+} ecs_query;
+
+/** One chunk's worth of entities that all have the same components. */
+typedef struct {
+    ecs_archetype *Archetype;
+    unsigned char *Chunk;
+    unsigned int   Count;
+} ecs_chunk_view;
+
+typedef struct {
+    ecs_query      *Query;
+    unsigned int    QueryIndex;
+    unsigned int    ChunkIndex;
+    ecs_chunk_view  View;
+} ecs_iterator;
+
+typedef void ecs_system_function(ecs_chunk_view *View, void *Data);
+
+/** Runs Function over every chunk Query matches. Reads and Writes list every
+ * component the system touches; systems whose writes don't overlap anything
+ * another reads or writes can run at the same time. */
+typedef struct {
+    const char          *Name;
+    ecs_query            Query;
+    component_mask       Reads;
+    component_mask       Writes;
+    ecs_system_function *Function;
+    void                *Data;
+} ecs_system;
+
+typedef struct ecs_world ecs_world;
+
+typedef struct {
+    ecs_world    *World;
+    ecs_system   *System;
+    // NOTE[joe] Where each of the query's archetypes starts, counting chunks
+    // through all of them in order, with the total on the end.
+    unsigned int  FirstChunk[ECS_MAX_ARCHETYPES + 1];
+} ecs_system_run;
+
+struct ecs_world {
+    // NOTE[joe] Chunks and tables all come from here, and are only given
+    // back by throwing the whole world away.
+    memory_arena       *Arena;
+
+    unsigned int        ComponentCount;
+    ecs_component_info  Components[ECS_MAX_COMPONENTS];
+
+    unsigned int        ArchetypeCount;
+    ecs_archetype       Archetypes[ECS_MAX_ARCHETYPES];
+
+    ecs_entity_record  *Entities;
+    unsigned int        EntityCapacity;
+    unsigned int        EntityCount;
+    unsigned int        FreeEntity;
+
+    // NOTE[joe] Chunks emptied out of one archetype, for the next one that
+    // needs a chunk. Linked through their first bytes.
+    unsigned char      *FreeChunks;
+
+    ecs_system_run      Runs[ECS_MAX_SYSTEMS];
+};
+
+#define ECS_COMPONENT(World, type) \
+    RegisterComponent(World, sizeof(type), alignof(type), #type)
+
+#define GetColumn(View, type, Component) \
+    ((type *)GetChunkColumn(View, Component))
+
+#endif
@@ -0,0 +1,474 @@
+/**
+ * @file ecs_bench.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains benchmarks for the entity component system: moving a
+ * million entities' positions along by their velocities, on one thread and
+ * across the job system, against the same update on plain arrays (about as
+ * fast as memory will go) and on objects scattered around the heap (what
+ * chasing pointers costs). Also what moving an entity between archetypes
+ * and destroying one costs, and a check that destroying entities leaves the
+ * rest of them intact. Platform layers run them with --bench-ecs, instead of
+ * the game, and exit with an error if the check fails. Results go to stdout
+ * as "name value" lines, like the frame stats.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "job.h"
+#include "ecs.h"
+
+#define ECS_BENCH_ENTITIES (1 << 20)
+#define ECS_BENCH_MOVES (1 << 16)
+#define ECS_BENCH_RUNS 8
+
+// NOTE[joe] Every ECS_BENCH_DESTROY_STRIDE'th entity is destroyed, so the
+// holes are spread over every chunk of both archetypes.
+#define ECS_BENCH_DESTROYS (1 << 14)
+#define ECS_BENCH_DESTROY_STRIDE (ECS_BENCH_ENTITIES / ECS_BENCH_DESTROYS)
+
+// NOTE[joe] Read a position and velocity, write the position back.
+#define ECS_BENCH_BYTES_PER_ENTITY (3 * 3 * sizeof(float))
+
+typedef struct {
+    float X;
+    float Y;
+    float Z;
+} ecs_bench_position;
+
+typedef struct {
+    float X;
+    float Y;
+    float Z;
+} ecs_bench_velocity;
+
+typedef struct {
+    float Angle;
+    float Rate;
+} ecs_bench_spin;
+
+/** What an entity might look like without an ECS: everything it has in one
+ * object, a cache line all told, with the objects wherever they were
+ * allocated. */
+typedef struct {
+    ecs_bench_position Position;
+    ecs_bench_velocity Velocity;
+    unsigned char      Other[40];
+} ecs_bench_object;
+
+/** Values[i] += Rates[i] * DeltaTime, for Count floats. */
+static
+void MoveFloats(float *Values,
+                float *Rates,
+                unsigned int Count,
+                float DeltaTime)
+{
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        Values[i] += Rates[i] * DeltaTime;
+    }
+}
+
+typedef struct {
+    unsigned int Position;
+    unsigned int Velocity;
+    unsigned int Spin;
+    float        DeltaTime;
+} ecs_bench_components;
+
+static
+void MoveSystem(ecs_chunk_view *View, void *Data)
+{
+    ecs_bench_components *Components = (ecs_bench_components *)Data;
+
+    // NOTE[joe] Positions and velocities are both three floats, so the
+    // update is the same for every float in the two columns, which is
+    // something the compiler will vectorize.
+    float *Positions = GetColumn(View, float, Components->Position);
+    float *Velocities = GetColumn(View, float, Components->Velocity);
+
+    MoveFloats(Positions, Velocities, View->Count * 3, Components->DeltaTime);
+}
+
+static
+void SpinSystem(ecs_chunk_view *View, void *Data)
+{
+    ecs_bench_components *Components = (ecs_bench_components *)Data;
+
+    ecs_bench_spin *Spins = GetColumn(View, ecs_bench_spin, Components->Spin);
+
+    for (unsigned int i = 0; i < View->Count; i++)
+    {
+        Spins[i].Angle += Spins[i].Rate * Components->DeltaTime;
+    }
+}
+
+/** Returns the best of a few timed single threaded runs of System, in
+ * seconds. */
+static
+double BenchmarkSystem(ecs_world *World, ecs_system *System)
+{
+    double Best = 1e9;
+
+    for (unsigned int Run = 0; Run < ECS_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        RunSystem(World, System);
+
+        double Elapsed = PlatformGetTime() - Begin;
+
+        if (Elapsed < Best)
+        {
+            Best = Elapsed;
+        }
+    }
+
+    return Best;
+}
+
+/** The same update as MoveSystem(), straight down two arrays. */
+static
+double BenchmarkArrays(ecs_bench_position *Positions,
+                       ecs_bench_velocity *Velocities,
+                       float DeltaTime)
+{
+    double Best = 1e9;
+
+    for (unsigned int Run = 0; Run < ECS_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        MoveFloats((float *)Positions,
+                   (float *)Velocities,
+                   ECS_BENCH_ENTITIES * 3,
+                   DeltaTime);
+
+        double Elapsed = PlatformGetTime() - Begin;
+
+        if (Elapsed < Best)
+        {
+            Best = Elapsed;
+        }
+    }
+
+    return Best;
+}
+
+/** The same update as MoveSystem(), through a pointer per object. */
+static
+double BenchmarkObjects(ecs_bench_object **Objects, float DeltaTime)
+{
+    double Best = 1e9;
+
+    for (unsigned int Run = 0; Run < ECS_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        for (unsigned int i = 0; i < ECS_BENCH_ENTITIES; i++)
+        {
+            ecs_bench_object *Object = Objects[i];
+
+            Object->Position.X += Object->Velocity.X * DeltaTime;
+            Object->Position.Y += Object->Velocity.Y * DeltaTime;
+            Object->Position.Z += Object->Velocity.Z * DeltaTime;
+        }
+
+        double Elapsed = PlatformGetTime() - Begin;
+
+        if (Elapsed < Best)
+        {
+            Best = Elapsed;
+        }
+    }
+
+    return Best;
+}
+
+/** Returns the best of a few timed runs of Systems across the job system,
+ * in seconds. */
+static
+double BenchmarkSystems(ecs_world *World,
+                        job_system *Jobs,
+                        ecs_system *Systems,
+                        unsigned int SystemCount)
+{
+    double Best = 1e9;
+
+    for (unsigned int Run = 0; Run < ECS_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        RunSystems(World, Jobs, Systems, SystemCount);
+
+        double Elapsed = PlatformGetTime() - Begin;
+
+        if (Elapsed < Best)
+        {
+            Best = Elapsed;
+        }
+    }
+
+    return Best;
+}
+
+/** Checks the world after every ECS_BENCH_DESTROY_STRIDE'th of Entities has
+ * been destroyed. Each hole is filled with its archetype's last row, so every
+ * survivor has to still be alive with the components it was made with,
+ * wherever it ended up. Then one more is created, which has to reuse the last
+ * slot freed, one generation on, and come out zeroed. */
+static
+bool CheckDestroyedEntities(ecs_world *World,
+                            ecs_bench_components *Components,
+                            entity *Entities,
+                            component_mask Mask)
+{
+    bool IsIntact = true;
+
+    for (unsigned int i = 0; i < ECS_BENCH_ENTITIES; i++)
+    {
+        bool IsDestroyed = i % ECS_BENCH_DESTROY_STRIDE == 0;
+
+        if (IsEntityAlive(World, Entities[i]) == IsDestroyed)
+        {
+            IsIntact = false;
+            continue;
+        }
+
+        if (IsDestroyed)
+            continue;
+
+        ecs_bench_velocity *Velocity = (ecs_bench_velocity *)GetComponent(
+            World,
+            Entities[i],
+            Components->Velocity);
+
+        IsIntact &= Velocity->X == (float)(i % 7) &&
+                    Velocity->Y == (float)(i % 11) &&
+                    Velocity->Z == (float)(i % 13) &&
+                    HasComponent(World, Entities[i], Components->Spin) ==
+                    ((i & 1) != 0);
+    }
+
+    unsigned int EntityCount = 0;
+
+    for (unsigned int i = 0; i < World->ArchetypeCount; i++)
+    {
+        EntityCount += World->Archetypes[i].EntityCount;
+    }
+
+    IsIntact &= EntityCount == ECS_BENCH_ENTITIES - ECS_BENCH_DESTROYS;
+
+    entity Last = Entities[(ECS_BENCH_DESTROYS - 1) * ECS_BENCH_DESTROY_STRIDE];
+    entity Reused = CreateEntity(World, Mask);
+
+    ecs_bench_velocity *Velocity = (ecs_bench_velocity *)GetComponent(
+        World,
+        Reused,
+        Components->Velocity);
+
+    bool IsReused = Reused.Index == Last.Index &&
+                    Reused.Generation == Last.Generation + 1 &&
+                    IsEntityAlive(World, Reused) &&
+                    !IsEntityAlive(World, Last) &&
+                    Velocity->X == 0.0f &&
+                    Velocity->Y == 0.0f &&
+                    Velocity->Z == 0.0f;
+
+    printf("ecs_destroy_intact %d\n", IsIntact ? 1 : 0);
+    printf("ecs_destroy_reused %d\n", IsReused ? 1 : 0);
+
+    return IsIntact && IsReused;
+}
+
+/** Runs every ECS benchmark and prints the results. Returns whether the
+ * destroy check passed. */
+static
+bool BenchmarkEcs()
+{
+    unsigned int CoreCount = PlatformGetCoreCount();
+
+    memory_arena Arena;
+    InitializeArena(&Arena, GIGABYTES(1), "ECS benchmark");
+
+    ecs_world *World = PushStruct(&Arena, ecs_world);
+    InitializeWorld(World, &Arena);
+
+    ecs_bench_components Components;
+    Components.Position = ECS_COMPONENT(World, ecs_bench_position);
+    Components.Velocity = ECS_COMPONENT(World, ecs_bench_velocity);
+    Components.Spin = ECS_COMPONENT(World, ecs_bench_spin);
+    Components.DeltaTime = 1.0f / 60.0f;
+
+    component_mask Moving = COMPONENT_BIT(Components.Position) |
+                            COMPONENT_BIT(Components.Velocity);
+
+    entity *Entities = new entity[ECS_BENCH_ENTITIES];
+
+    // NOTE[joe] Half of them spin as well, so that moving them all takes
+    // going through more than one archetype.
+    for (unsigned int i = 0; i < ECS_BENCH_ENTITIES; i++)
+    {
+        component_mask Mask = Moving;
+
+        if (i & 1)
+        {
+            Mask |= COMPONENT_BIT(Components.Spin);
+        }
+
+        Entities[i] = CreateEntity(World, Mask);
+
+        ecs_bench_velocity *Velocity = (ecs_bench_velocity *)GetComponent(
+            World,
+            Entities[i],
+            Components.Velocity);
+        Velocity->X = (float)(i % 7);
+        Velocity->Y = (float)(i % 11);
+        Velocity->Z = (float)(i % 13);
+    }
+
+    ecs_system Systems[2] = {};
+
+    Systems[0].Name = "Move";
+    Systems[0].Query = CreateQuery(Moving, 0);
+    Systems[0].Reads = COMPONENT_BIT(Components.Velocity);
+    Systems[0].Writes = COMPONENT_BIT(Components.Position);
+    Systems[0].Function = MoveSystem;
+    Systems[0].Data = &Components;
+
+    Systems[1].Name = "Spin";
+    Systems[1].Query = CreateQuery(COMPONENT_BIT(Components.Spin), 0);
+    Systems[1].Writes = COMPONENT_BIT(Components.Spin);
+    Systems[1].Function = SpinSystem;
+    Systems[1].Data = &Components;
+
+    printf("ecs_entities %u\n", ECS_BENCH_ENTITIES);
+    printf("ecs_archetypes %u\n", World->ArchetypeCount);
+    printf("ecs_arena_mb %.1f\n", Arena.Used / (1024.0 * 1024.0));
+
+    /** One thread, against the plain arrays and the scattered objects. */
+
+    double Bytes = (double)ECS_BENCH_ENTITIES * ECS_BENCH_BYTES_PER_ENTITY;
+
+    double EcsTime = BenchmarkSystem(World, &Systems[0]);
+
+    printf("ecs_iterate_ms %.3f\n", EcsTime * 1000.0);
+    printf("ecs_iterate_gbs %.2f\n", Bytes / EcsTime / 1e9);
+
+    ecs_bench_position *__restrict Positions =
+        new ecs_bench_position[ECS_BENCH_ENTITIES]();
+    ecs_bench_velocity *__restrict Velocities =
+        new ecs_bench_velocity[ECS_BENCH_ENTITIES]();
+
+    double ArrayTime = BenchmarkArrays(Positions,
+                                       Velocities,
+                                       Components.DeltaTime);
+
+    printf("ecs_array_ms %.3f\n", ArrayTime * 1000.0);
+    printf("ecs_array_gbs %.2f\n", Bytes / ArrayTime / 1e9);
+
+    delete[] Positions;
+    delete[] Velocities;
+
+    ecs_bench_object **Objects = new ecs_bench_object *[ECS_BENCH_ENTITIES];
+
+    for (unsigned int i = 0; i < ECS_BENCH_ENTITIES; i++)
+    {
+        Objects[i] = new ecs_bench_object();
+    }
+
+    // NOTE[joe] Objects allocated one after the other tend to end up one
+    // after the other, which a real game's wouldn't after a while of being
+    // created and destroyed. Shuffling the order we visit them in stands in
+    // for that.
+    unsigned int Random = 0x9E3779B9;
+
+    for (unsigned int i = ECS_BENCH_ENTITIES - 1; i > 0; i--)
+    {
+        Random ^= Random << 13;
+        Random ^= Random >> 17;
+        Random ^= Random << 5;
+
+        unsigned int j = Random % (i + 1);
+
+        ecs_bench_object *Swap = Objects[i];
+        Objects[i] = Objects[j];
+        Objects[j] = Swap;
+    }
+
+    double ObjectTime = BenchmarkObjects(Objects, Components.DeltaTime);
+
+    printf("ecs_object_ms %.3f\n", ObjectTime * 1000.0);
+
+    for (unsigned int i = 0; i < ECS_BENCH_ENTITIES; i++)
+    {
+        delete Objects[i];
+    }
+
+    delete[] Objects;
+
+    /** Both systems at once across the job system. */
+
+    job_system *Jobs = new job_system;
+
+    InitializeJobSystem(Jobs, CoreCount);
+
+    printf("ecs_parallel_%u_ms %.3f\n",
+           CoreCount,
+           BenchmarkSystems(World, Jobs, Systems, 2) * 1000.0);
+
+    ShutdownJobSystem(Jobs);
+
+    delete Jobs;
+
+    /** Adding and removing a component, i.e. two moves between archetypes,
+     * spread out over the world. */
+
+    double Begin = PlatformGetTime();
+
+    for (unsigned int i = 0; i < ECS_BENCH_MOVES; i++)
+    {
+        entity Entity = Entities[(i * 17) % ECS_BENCH_ENTITIES];
+
+        if (HasComponent(World, Entity, Components.Spin))
+        {
+            RemoveComponent(World, Entity, Components.Spin);
+            AddComponent(World, Entity, Components.Spin);
+        }
+        else
+        {
+            AddComponent(World, Entity, Components.Spin);
+            RemoveComponent(World, Entity, Components.Spin);
+        }
+    }
+
+    double MoveTime = PlatformGetTime() - Begin;
+
+    printf("ecs_move_ns %.1f\n", MoveTime * 1e9 / (2.0 * ECS_BENCH_MOVES));
+
+    /** Destroying entities spread out over the world, each of which moves
+     * its archetype's last row into the hole. */
+
+    Begin = PlatformGetTime();
+
+    for (unsigned int i = 0; i < ECS_BENCH_DESTROYS; i++)
+    {
+        DestroyEntity(World, Entities[i * ECS_BENCH_DESTROY_STRIDE]);
+    }
+
+    double DestroyTime = PlatformGetTime() - Begin;
+
+    printf("ecs_destroy_ns %.1f\n", DestroyTime * 1e9 / ECS_BENCH_DESTROYS);
+
+    bool IsCorrect =
+        CheckDestroyedEntities(World, &Components, Entities, Moving);
+
+    printf("ecs_correct %d\n", IsCorrect ? 1 : 0);
+
+    delete[] Entities;
+
+    ReleaseArena(&Arena);
+
+    return IsCorrect;
+}
@@ -0,0 +1,422 @@
+/**
+ * @file game.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our simulation and the platform independent half of the
+ * frame loop. Platform layers call StartRenderThread() once Vulkan is up, then
+ * every frame take a packet with BeginGamePacket(), fill it with GameAdvance(),
+ * publish it with EndGamePacket() and GameWaitForNextFrame(). StopRenderThread()
+ * drains whatever's left and shuts down.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "render.h"
+#include "transform.h"
+#include "animation.h"
+#include "job.h"
+#include "occlusion.h"
+#include "game.h"
+
+#define GAME_PI 3.14159265358979f
+
+/** Steps the simulation forward by exactly one tick. */
+static
+void GameUpdate(game_state *State, float Dt)
+{
+    State->Tick++;
+
+    // NOTE[joe] Half a turn a second.
+    State->TriangleAngle += GAME_PI * Dt;
+
+    if (State->TriangleAngle > 2.0f * GAME_PI)
+    {
+        State->TriangleAngle -= 2.0f * GAME_PI;
+    }
+}
+
+/** Builds what we render from the last two ticks, Alpha of the way from
+ * Loop's Previous to Current. Occlusion culling runs across Jobs. */
+static
+void GameBuildPacket(game_loop *Loop,
+                     job_system *Jobs,
+                     float Alpha,
+                     render_packet *Packet)
+{
+    const game_state *Previous = &Loop->Previous;
+    const game_state *Current = &Loop->Current;
+
+    Packet->Tick = Current->Tick;
+    Packet->DrawCount = 0;
+
+    // NOTE[joe] Go the short way around if the angle wrapped this tick.
+    float Delta = Current->TriangleAngle - Previous->TriangleAngle;
+
+    if (Delta < -GAME_PI)
+    {
+        Delta += 2.0f * GAME_PI;
+    }
+
+    float Angle = Previous->TriangleAngle + Delta * Alpha;
+
+    mat4 Spin = Mat4RotationZ(Angle);
+    SetLocalTransform(&Loop->Transforms, Loop->Triangle, &Spin);
+
+    UpdateTransforms(&Loop->Transforms);
+
+    const mat4 *TriangleTransform =
+        GetWorldTransform(&Loop->Transforms, Loop->Triangle);
+
+    // NOTE[joe] The triangle hides whatever's behind it.
+    occlusion_buffer *Occlusion = &Loop->Occlusion;
+
+    BeginOcclusion(Occlusion);
+    AddOccluder(Occlusion,
+                RenderTriangle,
+                RENDER_TRIANGLE_VERTEX_COUNT,
+                TriangleTransform);
+    RenderOcclusion(Occlusion, Jobs);
+
+    render_draw *Triangle = &Packet->Draws[Packet->DrawCount++];
+    Triangle->VertexCount = RENDER_TRIANGLE_VERTEX_COUNT;
+    Triangle->IsSkinned = false;
+    Triangle->Instance.Transform = *TriangleTransform;
+    Triangle->BoundsMin = { -1.0f, -1.0f, 0.0f };
+    Triangle->BoundsMax = { 1.0f, 1.0f, 0.0f };
+
+    // NOTE[joe] Animation time is interpolated the same as everything else,
+    // and wrapped in doubles, before ticks get too big for floats.
+    anim_character *Sway = &Loop->StripCharacter;
+    double Seconds = ((double)Previous->Tick + Alpha) * GAME_TICK_SECONDS;
+    Sway->Time = (float)fmod(Seconds, (double)Loop->StripSway.Duration);
+
+    EvaluateCharacter(Sway);
+
+    Packet->JointCount = SKIN_STRIP_JOINT_COUNT;
+
+    for (unsigned int i = 0; i < SKIN_STRIP_JOINT_COUNT; i++)
+    {
+        Packet->Joints[i] = Sway->Palette[i];
+    }
+
+    // NOTE[joe] The top of the strip swings about halfway up, so it stays
+    // within half a unit and a bit of the middle, whichever way it leans.
+    occlusion_box StripBounds = {
+        { -0.55f, 0.0f, 0.0f },
+        { 0.55f, 1.05f, 0.0f },
+        *GetWorldTransform(&Loop->Transforms, Loop->Strip)
+    };
+
+    if (IsOcclusionBoxVisible(Occlusion, &StripBounds))
+    {
+        render_draw *Strip = &Packet->Draws[Packet->DrawCount++];
+        Strip->VertexCount = SKIN_STRIP_VERTEX_COUNT;
+        Strip->IsSkinned = true;
+        Strip->Instance.Transform = StripBounds.Transform;
+        Strip->BoundsMin = StripBounds.Min;
+        Strip->BoundsMax = StripBounds.Max;
+    }
+    else
+    {
+        Loop->CulledDrawCount++;
+    }
+
+    // NOTE[joe] A fountain just behind the triangle's top corner, so that
+    // particles falling past it bounce off its edges. Interpolated time
+    // never runs backwards, but clamp it anyway.
+    double Dt = Seconds - Loop->ParticleSeconds;
+    Loop->ParticleSeconds = Seconds;
+
+    if (Dt < 0.0)
+    {
+        Dt = 0.0;
+    }
+
+    Loop->ParticleDebt += Loop->ParticleRate * (float)Dt;
+    unsigned int EmitCount = (unsigned int)Loop->ParticleDebt;
+    Loop->ParticleDebt -= (float)EmitCount;
+
+    particle_emitter *Emitter = &Packet->Particles;
+    Emitter->Transform = *GetWorldTransform(&Loop->Transforms, Loop->SceneRoot);
+    Emitter->Position = { -0.05f, -0.9f, 0.005f };
+    Emitter->Spread = 0.004f;
+    Emitter->Velocity = { 0.15f, -0.6f, 0.0f };
+    Emitter->Jitter = 0.5f;
+    Emitter->Gravity = { 0.0f, 1.5f, 0.0f };
+    Emitter->Drag = 0.1f;
+    Emitter->Lifetime = GAME_PARTICLE_LIFETIME;
+    Emitter->Size = 0.004f;
+    Emitter->Dt = (float)Dt;
+    Emitter->EmitCount = EmitCount;
+}
+
+/** Sets up the strip's skeleton and sway clip, allocated from Arena. The
+ * raw clip only lives in Scratch until it's compressed. */
+static
+void InitializeStripAnimation(game_loop *Loop,
+                              memory_arena *Arena,
+                              memory_arena *Scratch)
+{
+    // NOTE[joe] Joint 0 at the bottom of the strip, and joint 1 halfway up,
+    // which sways back and forth about its own pivot every two seconds.
+    anim_skeleton *Skeleton = &Loop->StripSkeleton;
+    InitializeSkeleton(Skeleton, Arena, SKIN_STRIP_JOINT_COUNT);
+
+    Skeleton->Parents[1] = 0;
+    Skeleton->InverseBinds[1] = Mat4Translation({ 0.0f, -0.5f, 0.0f });
+
+    arena_temp Temp = BeginArenaTemp(Scratch);
+
+    unsigned int FrameCount = 2 * ANIM_SAMPLE_RATE + 1;
+    anim_raw_clip Raw;
+    InitializeRawClip(&Raw, Scratch, SKIN_STRIP_JOINT_COUNT, FrameCount);
+
+    for (unsigned int Frame = 0; Frame < FrameCount; Frame++)
+    {
+        float Cycle = 2.0f * GAME_PI * (float)Frame / (float)(FrameCount - 1);
+        unsigned int i = Frame * SKIN_STRIP_JOINT_COUNT + 1;
+
+        Raw.Translations[i] = { 0.0f, 0.5f, 0.0f };
+        Raw.Rotations[i] = QuatFromAxisAngle({ 0.0f, 0.0f, 1.0f },
+                                             0.75f * sinf(Cycle));
+    }
+
+    float Tolerances[SKIN_STRIP_JOINT_COUNT * ANIM_TRACK_TYPES];
+
+    for (unsigned int i = 0; i < SKIN_STRIP_JOINT_COUNT; i++)
+    {
+        Tolerances[i * ANIM_TRACK_TYPES + ANIM_TRACK_ROTATION] = 1e-3f;
+        Tolerances[i * ANIM_TRACK_TYPES + ANIM_TRACK_TRANSLATION] = 1e-4f;
+        Tolerances[i * ANIM_TRACK_TYPES + ANIM_TRACK_SCALE] = 1e-4f;
+    }
+
+    CompressClip(&Raw, Tolerances, Arena, &Loop->StripSway);
+
+    EndArenaTemp(Temp);
+
+    anim_blend_tree Tree = {};
+    AddClipNode(&Tree, &Loop->StripSway, 1.0f);
+
+    InitializeCharacter(&Loop->StripCharacter, Skeleton, &Tree, Arena);
+}
+
+/** Starts the loop at the current time, with the scene allocated from
+ * Arena and Scratch used for anything that's only needed while starting.
+ * FrameRate of zero renders as fast as we can. ParticleCount is how many
+ * particles the renderer has room for. */
+static
+void InitializeGameLoop(game_loop *Loop,
+                        memory_arena *Arena,
+                        memory_arena *Scratch,
+                        unsigned int FrameRate,
+                        unsigned int ParticleCount)
+{
+    *Loop = {};
+
+    InitializeTransformHierarchy(&Loop->Transforms, Arena, GAME_MAX_TRANSFORMS);
+
+    Loop->SceneRoot = CreateTransform(&Loop->Transforms, TRANSFORM_NONE);
+    Loop->Triangle = CreateTransform(&Loop->Transforms, Loop->SceneRoot);
+    Loop->Strip = CreateTransform(&Loop->Transforms, Loop->SceneRoot);
+
+    mat4 StripOffset = Mat4Translation({ 0.6f, -0.5f, 0.0f });
+    SetLocalTransform(&Loop->Transforms, Loop->Strip, &StripOffset);
+
+    InitializeStripAnimation(Loop, Arena, Scratch);
+
+    InitializeOcclusion(&Loop->Occlusion,
+                        Arena,
+                        GAME_OCCLUSION_WIDTH,
+                        GAME_OCCLUSION_HEIGHT,
+                        GAME_MAX_OCCLUDERS,
+                        GAME_MAX_OCCLUDER_TRIANGLES);
+
+    Loop->ParticleRate = (float)ParticleCount / GAME_PARTICLE_LIFETIME;
+
+    Loop->LastTime = PlatformGetTime();
+    Loop->NextFrameTime = Loop->LastTime;
+
+    if (FrameRate)
+    {
+        Loop->FrameSeconds = 1.0 / FrameRate;
+    }
+}
+
+/** Runs however many ticks have come due since the last call, and builds
+ * this frame's Packet, with Jobs to help. */
+static
+void GameAdvance(game_loop *Loop, job_system *Jobs, render_packet *Packet)
+{
+    double Now = PlatformGetTime();
+    double FrameTime = Now - Loop->LastTime;
+    Loop->LastTime = Now;
+
+    if (FrameTime > GAME_MAX_FRAME_SECONDS)
+    {
+        FrameTime = GAME_MAX_FRAME_SECONDS;
+    }
+
+    Loop->Accumulator += FrameTime;
+
+    while (Loop->Accumulator >= GAME_TICK_SECONDS)
+    {
+        Loop->Previous = Loop->Current;
+        GameUpdate(&Loop->Current, (float)GAME_TICK_SECONDS);
+
+        Loop->Accumulator -= GAME_TICK_SECONDS;
+    }
+
+    float Alpha = (float)(Loop->Accumulator / GAME_TICK_SECONDS);
+
+    GameBuildPacket(Loop, Jobs, Alpha, Packet);
+}
+
+/** Sleeps until it's time to start the next frame. Does nothing when the
+ * loop is uncapped. */
+static
+void GameWaitForNextFrame(game_loop *Loop)
+{
+    if (Loop->FrameSeconds == 0)
+        return;
+
+    // NOTE[joe] Deadlines are spaced exactly FrameSeconds apart, rather than
+    // FrameSeconds after we woke up, so that oversleeping one frame doesn't
+    // push every frame after it back too.
+    Loop->NextFrameTime += Loop->FrameSeconds;
+
+    double Now = PlatformGetTime();
+
+    // If we've fallen more than a frame behind, don't try to catch up with a
+    // burst of unpaced frames; just start pacing again from now.
+    if (Now - Loop->NextFrameTime > Loop->FrameSeconds)
+    {
+        Loop->NextFrameTime = Now;
+        return;
+    }
+
+    PlatformSleepUntil(Loop->NextFrameTime);
+}
+
+static
+void InitializeLightSemaphore(light_semaphore *Semaphore,
+                              memory_arena *Arena,
+                              int Count)
+{
+    Semaphore->Count.store(Count, std::memory_order_relaxed);
+    Semaphore->Semaphore = PlatformCreateSemaphore(Arena, 0);
+}
+
+static
+void WaitLightSemaphore(light_semaphore *Semaphore)
+{
+    // NOTE[joe] Going negative means we owe a wait; whoever brings it back up
+    // signals the platform semaphore for us.
+    if (Semaphore->Count.fetch_sub(1, std::memory_order_acquire) < 1)
+    {
+        PlatformWaitSemaphore(Semaphore->Semaphore);
+    }
+}
+
+static
+void SignalLightSemaphore(light_semaphore *Semaphore)
+{
+    if (Semaphore->Count.fetch_add(1, std::memory_order_release) < 0)
+    {
+        PlatformSignalSemaphore(Semaphore->Semaphore);
+    }
+}
+
+typedef struct {
+    vulkan_context *Context;
+    render_handoff *Handoff;
+    job_system     *Jobs;
+} render_thread_data;
+
+/** The render thread. Draws packets as the game publishes them, in order,
+ * until the game says it's quitting. */
+static
+void RenderThreadProc(void *Data)
+{
+    render_thread_data *ThreadData = (render_thread_data *)Data;
+    render_handoff *Handoff = ThreadData->Handoff;
+
+    // NOTE[joe] So that rendering can hand work off to the job system too.
+    RegisterJobThread(ThreadData->Jobs);
+
+    for (;;)
+    {
+        WaitLightSemaphore(&Handoff->Full);
+
+        if (Handoff->IsLast[Handoff->RenderIndex])
+        {
+            break;
+        }
+
+        render_packet *Packet = &Handoff->Packets[Handoff->RenderIndex];
+        GameRender(ThreadData->Context, ThreadData->Jobs, Packet);
+
+        Handoff->RenderIndex ^= 1;
+        SignalLightSemaphore(&Handoff->Free);
+    }
+}
+
+static render_thread_data RenderThreadData;
+static platform_thread *RenderThread;
+
+/** Starts the render thread, keeping track of it on Arena. From here on the
+ * game thread must not touch Context. */
+static
+void StartRenderThread(vulkan_context *Context,
+                       render_handoff *Handoff,
+                       job_system *Jobs,
+                       memory_arena *Arena)
+{
+    Handoff->GameIndex = 0;
+    Handoff->RenderIndex = 0;
+    Handoff->IsLast[0] = false;
+    Handoff->IsLast[1] = false;
+
+    InitializeLightSemaphore(&Handoff->Free, Arena, 2);
+    InitializeLightSemaphore(&Handoff->Full, Arena, 0);
+
+    RenderThreadData.Context = Context;
+    RenderThreadData.Handoff = Handoff;
+    RenderThreadData.Jobs = Jobs;
+
+    RenderThread = PlatformCreateThread(Arena,
+                                        RenderThreadProc,
+                                        &RenderThreadData);
+}
+
+/** Returns the packet for the game thread to build this frame into. Blocks
+ * while the renderer still has both. */
+static
+render_packet *BeginGamePacket(render_handoff *Handoff)
+{
+    WaitLightSemaphore(&Handoff->Free);
+
+    return &Handoff->Packets[Handoff->GameIndex];
+}
+
+/** Hands the packet from BeginGamePacket() over to the render thread. */
+static
+void EndGamePacket(render_handoff *Handoff)
+{
+    Handoff->GameIndex ^= 1;
+    SignalLightSemaphore(&Handoff->Full);
+}
+
+/** Waits for the render thread to draw everything it's been given, then
+ * stops it. */
+static
+void StopRenderThread(render_handoff *Handoff)
+{
+    BeginGamePacket(Handoff);
+
+    Handoff->IsLast[Handoff->GameIndex] = true;
+    EndGamePacket(Handoff);
+
+    PlatformJoinThread(RenderThread);
+    RenderThread = 0;
+}
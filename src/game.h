@@ -0,0 +1,113 @@
+/**
+ * @file game.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for our game state and the frame loop
+ * that drives it. Simulation runs in fixed ticks, no matter how fast or slow
+ * we render; rendering draws somewhere in between the last two ticks.
+ *
+ * The game and the renderer run on separate threads. The game thread builds
+ * frame N+1's render_packet into one half of a render_handoff while the render
+ * thread records and submits frame N from the other half.
+ */
+
+#ifndef _GAME_H_
+#define _GAME_H_
+
+#include <atomic>
+
+// NOTE[joe] Simulation always steps by exactly this much.
+#define GAME_TICK_RATE 60
+#define GAME_TICK_SECONDS (1.0 / GAME_TICK_RATE)
+
+// NOTE[joe] The longest frame we'll try to catch up on. Anything past this
+// (a breakpoint, a hitch while loading) is dropped rather than turned into
+// hundreds of ticks in one go.
+#define GAME_MAX_FRAME_SECONDS 0.25
+
+#define GAME_DEFAULT_FRAME_RATE 60
+
+#define GAME_MAX_TRANSFORMS 4096
+
+// NOTE[joe] How long each particle lives. The emitter keeps the pool about
+// full by emitting the whole pool once every lifetime.
+#define GAME_PARTICLE_LIFETIME 2.0f
+
+// NOTE[joe] Occluders are drawn into a buffer this big, whatever size the
+// window is, with room for this many of them.
+#define GAME_OCCLUSION_WIDTH 256
+#define GAME_OCCLUSION_HEIGHT 144
+#define GAME_MAX_OCCLUDERS 64
+#define GAME_MAX_OCCLUDER_TRIANGLES 4096
+
+typedef struct {
+    unsigned long long Tick;
+    float              TriangleAngle;
+} game_state;
+
+typedef struct {
+    // NOTE[joe] Previous and Current are the last two ticks. Rendering
+    // interpolates between them by how far into the next tick we are.
+    game_state Previous;
+    game_state Current;
+    double     Accumulator;
+    double     LastTime;
+
+    // NOTE[joe] Zero means uncapped, which is what benchmarks want.
+    double     FrameSeconds;
+    double     NextFrameTime;
+
+    // NOTE[joe] Belongs to the game thread. Rebuilt from the interpolated
+    // state every frame, so it never lags behind what we draw.
+    transform_hierarchy Transforms;
+    transform_id        SceneRoot;
+    transform_id        Triangle;
+    transform_id        Strip;
+
+    // NOTE[joe] Also the game thread's. The strip sways on a clip, rather
+    // than anything the simulation does.
+    anim_skeleton       StripSkeleton;
+    anim_clip           StripSway;
+    anim_character      StripCharacter;
+
+    // NOTE[joe] Particles are emitted per rendered frame, not per tick, so
+    // the rate is kept up by carrying the fraction of a particle we didn't
+    // emit over to the next frame.
+    float               ParticleRate;
+    float               ParticleDebt;
+    double              ParticleSeconds;
+
+    // NOTE[joe] Redrawn every frame, before anything that might be hidden
+    // gets a draw.
+    occlusion_buffer    Occlusion;
+    unsigned long long  CulledDrawCount;
+} game_loop;
+
+/** A counting semaphore that only goes to the platform when a thread actually
+ * has to sleep. Handing off a packet the other side isn't waiting on is a
+ * single atomic add. */
+typedef struct {
+    std::atomic<int>    Count;
+    platform_semaphore *Semaphore;
+} light_semaphore;
+
+/** Two render_packets passed back and forth between exactly one game thread
+ * and one render thread. */
+typedef struct {
+    render_packet   Packets[2];
+
+    // NOTE[joe] Free counts packets the game can write into, Full counts
+    // packets the renderer has yet to draw. Each side only ever touches the
+    // packet at its own index, and flips it once it's done.
+    light_semaphore Free;
+    light_semaphore Full;
+    unsigned int    GameIndex;
+    unsigned int    RenderIndex;
+
+    // NOTE[joe] Set on the last packet the game publishes, which the render
+    // thread doesn't draw; it just stops.
+    bool            IsLast[2];
+} render_handoff;
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file io.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our I/O queue. See io.h.
+ */
+
+#include "platform.h"
+#include "job.h"
+#include "io.h"
+
+typedef struct {
+    io_complete_function *Complete;
+    void                 *CompleteData;
+} io_complete_job_data;
+
+static
+void IoCompleteJob(job_system *System, job *Job, void *Data)
+{
+    io_complete_job_data *Completion = (io_complete_job_data *)Data;
+
+    Completion->Complete(System, Completion->CompleteData);
+}
+
+static
+void IoThreadProc(void *Data)
+{
+    io_queue *Queue = (io_queue *)Data;
+
+    // NOTE[joe] We never run jobs on this thread, but we need a deque to
+    // hand completions to the workers through.
+    RegisterJobThread(Queue->Jobs);
+
+    for (;;)
+    {
+        PlatformWaitSemaphore(Queue->Pending);
+
+        if (!Queue->IsRunning.load(std::memory_order_acquire))
+            break;
+
+        LockJobSpinLock(&Queue->Lock);
+        io_request Request = Queue->Requests[Queue->Head++ &
+                                             (IO_MAX_REQUESTS - 1)];
+        UnlockJobSpinLock(&Queue->Lock);
+
+        file_contents *Result = Request.Result;
+        Result->Size = 0;
+        Result->Data = PlatformReadEntireFile(Request.FilePath,
+                                              &Result->Size);
+
+        io_complete_job_data Completion;
+        Completion.Complete = Request.Complete;
+        Completion.CompleteData = Request.CompleteData;
+
+        RunJob(Queue->Jobs,
+               CreateJob(Queue->Jobs,
+                         IoCompleteJob,
+                         &Completion,
+                         sizeof(Completion),
+                         0));
+    }
+}
+
+/** Starts the I/O threads, keeping track of them on Arena. Jobs must outlive
+ * the queue. */
+static
+void InitializeIoQueue(io_queue *Queue, job_system *Jobs, memory_arena *Arena)
+{
+    Queue->Jobs = Jobs;
+    Queue->Lock.IsLocked.store(false);
+    Queue->Head = 0;
+    Queue->Tail = 0;
+    Queue->Pending = PlatformCreateSemaphore(Arena, 0);
+    Queue->IsRunning.store(true);
+
+    for (unsigned int i = 0; i < IO_THREAD_COUNT; i++)
+    {
+        Queue->Threads[i] = PlatformCreateThread(Arena, IoThreadProc, Queue);
+    }
+}
+
+/** Stops the I/O threads. Reads that haven't started yet never will. */
+static
+void ShutdownIoQueue(io_queue *Queue)
+{
+    Queue->IsRunning.store(false, std::memory_order_release);
+
+    for (unsigned int i = 0; i < IO_THREAD_COUNT; i++)
+    {
+        PlatformSignalSemaphore(Queue->Pending);
+    }
+
+    for (unsigned int i = 0; i < IO_THREAD_COUNT; i++)
+    {
+        PlatformJoinThread(Queue->Threads[i]);
+    }
+
+    PlatformDestroySemaphore(Queue->Pending);
+}
+
+/** Reads all of FilePath into Result on one of the I/O threads, then runs
+ * Complete(CompleteData) as a job. FilePath and Result have to stay put until
+ * then. */
+static
+void QueueFileRead(io_queue *Queue,
+                   const char *FilePath,
+                   file_contents *Result,
+                   io_complete_function *Complete,
+                   void *CompleteData)
+{
+    LockJobSpinLock(&Queue->Lock);
+
+    Assert(Queue->Tail - Queue->Head < IO_MAX_REQUESTS,
+           "Too many file reads queued.\n");
+
+    io_request *Request = &Queue->Requests[Queue->Tail++ &
+                                           (IO_MAX_REQUESTS - 1)];
+    Request->FilePath = FilePath;
+    Request->Result = Result;
+    Request->Complete = Complete;
+    Request->CompleteData = CompleteData;
+
+    UnlockJobSpinLock(&Queue->Lock);
+
+    PlatformSignalSemaphore(Queue->Pending);
+}
+
+static
+void FreeFileContents(file_contents *File)
+{
+    delete[] (unsigned char *)File->Data;
+
+    File->Data = 0;
+    File->Size = 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file io.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for our I/O queue. A handful of threads
+ * do nothing but blocking file reads, so that however many reads are queued
+ * up, that many are in flight at once and nobody else has to block on them.
+ * Finished reads are handed back to the job system.
+ */
+
+#ifndef _IO_H_
+#define _IO_H_
+
+#include <atomic>
+
+// NOTE[joe] Reads in flight at once. Past a point more doesn't help even on
+// an SSD, and it's threads sitting around the rest of the time.
+#define IO_THREAD_COUNT 8
+
+// NOTE[joe] Must be a power of two.
+#define IO_MAX_REQUESTS 4096
+
+/** A file read with ReadFileAsync(). Data is zero if the read failed;
+ * otherwise it's ours to FreeFileContents(). */
+typedef struct {
+    void         *Data;
+    unsigned int  Size;
+} file_contents;
+
+typedef void io_complete_function(job_system *Jobs, void *Data);
+
+typedef struct {
+    const char           *FilePath;
+    file_contents        *Result;
+    // NOTE[joe] Run as a job once the read is done.
+    io_complete_function *Complete;
+    void                 *CompleteData;
+} io_request;
+
+typedef struct {
+    job_system          *Jobs;
+
+    job_spin_lock        Lock;
+    io_request           Requests[IO_MAX_REQUESTS];
+    unsigned int         Head;
+    unsigned int         Tail;
+    platform_semaphore  *Pending;
+
+    platform_thread     *Threads[IO_THREAD_COUNT];
+    std::atomic<bool>    IsRunning;
+} io_queue;
+
+#endif
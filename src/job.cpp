@@ -0,0 +1,951 @@
+/**
+ * @file job.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our job system. Any thread that wants to create or wait
+ * on jobs has to be one of the workers, or have called RegisterJobThread().
+ * InitializeJobSystem() registers the thread that calls it.
+ *
+ * Worker threads never run jobs on their own stacks. Each one converts itself
+ * into a fiber and immediately switches to one from the pool, which runs the
+ * scheduler loop in JobFiberProc(). When a job waits, the fiber it's on gets
+ * parked and the worker switches to a free fiber, which picks up the loop
+ * where the last one left off.
+ */
+
+#include "platform.h"
+#include "job.h"
+
+#if defined(_MSC_VER)
+#define JOB_NOINLINE __declspec(noinline)
+#else
+#define JOB_NOINLINE __attribute__((noinline))
+#endif
+
+typedef enum {
+    JOB_FIBER_NONE,
+    JOB_FIBER_FREE,
+    JOB_FIBER_PARK,
+} job_fiber_action;
+
+typedef struct {
+    // NOTE[joe] Which thread of which job system we are. Set by
+    // RegisterJobThread(), and by the workers when they start.
+    job_system       *System;
+    unsigned int      Index;
+
+    // NOTE[joe] Only set on workers. CurrentFiber is the pool fiber we're
+    // running on, ThreadFiber is the thread's own.
+    job_fiber        *CurrentFiber;
+    platform_fiber   *ThreadFiber;
+
+    // NOTE[joe] What to do with the fiber we just switched away from. It
+    // can't be freed or parked until we're off its stack, otherwise another
+    // worker could switch into it while we're still running on it.
+    job_fiber        *PendingFiber;
+    job_fiber_action  PendingAction;
+} job_thread_state;
+
+static thread_local job_thread_state JobThreadState;
+
+/** Returns the calling thread's job state. A fiber can go to sleep on one
+ * thread and wake up on another, so this must be looked up again after every
+ * switch. The compiler is allowed to cache the address of a thread_local
+ * across a call, which is why this is kept out of line. */
+static JOB_NOINLINE
+job_thread_state *GetJobThreadState()
+{
+    return &JobThreadState;
+}
+
+/** Pushes Job onto the bottom of Deque, or returns false if it's full. Only
+ * the owner may call this. */
+static
+bool PushJob(job_deque *Deque, job *Job)
+{
+    long long Bottom = Deque->Bottom.load(std::memory_order_relaxed);
+    long long Top = Deque->Top.load(std::memory_order_acquire);
+
+    // NOTE[joe] Thieves only ever move Top up, so a stale Top can only make
+    // the deque look fuller than it is.
+    if (Bottom - Top >= JOB_DEQUE_SIZE)
+        return false;
+
+    // NOTE[joe] Release so that a thief that reads the entry also sees the
+    // job's contents.
+    Deque->Entries[Bottom & (JOB_DEQUE_SIZE - 1)].store(
+        Job, std::memory_order_release);
+
+    std::atomic_thread_fence(std::memory_order_release);
+    Deque->Bottom.store(Bottom + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+/** Pops the most recently pushed job off the bottom of Deque, or returns 0 if
+ * it's empty. Only the owner may call this. */
+static
+job *PopJob(job_deque *Deque)
+{
+    long long Bottom = Deque->Bottom.load(std::memory_order_relaxed) - 1;
+    Deque->Bottom.store(Bottom, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    long long Top = Deque->Top.load(std::memory_order_relaxed);
+
+    if (Top > Bottom)
+    {
+        // It was empty already.
+        Deque->Bottom.store(Bottom + 1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    job *Job = Deque->Entries[Bottom & (JOB_DEQUE_SIZE - 1)].load(
+        std::memory_order_relaxed);
+
+    if (Top == Bottom)
+    {
+        // NOTE[joe] This was the last job, so we're racing any thief for it.
+        // Whoever moves Top first wins.
+        if (!Deque->Top.compare_exchange_strong(Top,
+                                                Top + 1,
+                                                std::memory_order_seq_cst,
+                                                std::memory_order_relaxed))
+        {
+            Job = 0;
+        }
+
+        Deque->Bottom.store(Bottom + 1, std::memory_order_relaxed);
+    }
+
+    return Job;
+}
+
+/** Steals the oldest job off the top of Deque, or returns 0 if it's empty or
+ * somebody else got there first. Any thread may call this. */
+static
+job *StealJob(job_deque *Deque)
+{
+    long long Top = Deque->Top.load(std::memory_order_acquire);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    long long Bottom = Deque->Bottom.load(std::memory_order_acquire);
+
+    if (Top >= Bottom)
+        return 0;
+
+    job *Job = Deque->Entries[Top & (JOB_DEQUE_SIZE - 1)].load(
+        std::memory_order_acquire);
+
+    if (!Deque->Top.compare_exchange_strong(Top,
+                                            Top + 1,
+                                            std::memory_order_seq_cst,
+                                            std::memory_order_relaxed))
+    {
+        return 0;
+    }
+
+    return Job;
+}
+
+static
+bool IsDequeEmpty(job_deque *Deque)
+{
+    long long Top = Deque->Top.load(std::memory_order_relaxed);
+    long long Bottom = Deque->Bottom.load(std::memory_order_relaxed);
+
+    return Bottom <= Top;
+}
+
+static
+void LockJobSpinLock(job_spin_lock *Lock)
+{
+    while (Lock->IsLocked.exchange(true, std::memory_order_acquire))
+    {
+        while (Lock->IsLocked.load(std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+static
+bool TryLockJobSpinLock(job_spin_lock *Lock)
+{
+    return !Lock->IsLocked.load(std::memory_order_relaxed) &&
+           !Lock->IsLocked.exchange(true, std::memory_order_acquire);
+}
+
+static
+void UnlockJobSpinLock(job_spin_lock *Lock)
+{
+    Lock->IsLocked.store(false, std::memory_order_release);
+}
+
+static
+job_thread *GetJobThread(job_system *System)
+{
+    job_thread_state *State = GetJobThreadState();
+
+    Assert(State->System == System,
+           "This thread hasn't registered with the job system.\n");
+
+    return System->Threads[State->Index].load(std::memory_order_relaxed);
+}
+
+/** Gives the calling thread a deque and job pool of its own. Returns its index
+ * among the job system's threads. */
+static
+unsigned int RegisterJobThread(job_system *System)
+{
+    unsigned int Index = System->ThreadCount.fetch_add(1);
+
+    Assert(Index < JOB_MAX_THREADS, "Too many job threads.\n");
+
+    LockJobSpinLock(&System->ArenaLock);
+    job_thread *Thread = PushStruct(&System->Arena, job_thread);
+    UnlockJobSpinLock(&System->ArenaLock);
+
+    Thread->Deque.Top.store(0, std::memory_order_relaxed);
+    Thread->Deque.Bottom.store(0, std::memory_order_relaxed);
+    Thread->PoolNext = 0;
+    Thread->Random = 0x9E3779B9u * (Index + 1);
+
+    for (unsigned int i = 0; i < JOB_POOL_SIZE; i++)
+    {
+        Thread->Pool[i].UnfinishedJobs.store(0, std::memory_order_relaxed);
+    }
+
+    // NOTE[joe] Thieves skip slots that are still null, so this has to be
+    // published only once the thread is fully set up.
+    System->Threads[Index].store(Thread, std::memory_order_release);
+
+    job_thread_state *State = GetJobThreadState();
+    *State = {};
+    State->System = System;
+    State->Index = Index;
+
+    return Index;
+}
+
+/** Creates a job that runs Function with a copy of DataSize bytes of Data. If
+ * Parent is given, it won't finish until this job has. The job doesn't run
+ * until it's passed to RunJob(). */
+static
+job *CreateJob(job_system *System,
+               job_function *Function,
+               const void *Data,
+               unsigned int DataSize,
+               job *Parent)
+{
+    Assert(DataSize <= JOB_DATA_SIZE, "Job data too big.\n");
+
+    job_thread *Thread = GetJobThread(System);
+    job *Job = &Thread->Pool[Thread->PoolNext++ & (JOB_POOL_SIZE - 1)];
+
+    // NOTE[joe] Jobs that wait (or have children that do) can stay
+    // unfinished for a long time, so step over any we come round to again.
+    for (unsigned int Tries = 1;
+         Job->UnfinishedJobs.load(std::memory_order_acquire) != 0;
+         Tries++)
+    {
+        Assert(Tries < JOB_POOL_SIZE, "Job pool is full.\n");
+
+        Job = &Thread->Pool[Thread->PoolNext++ & (JOB_POOL_SIZE - 1)];
+    }
+
+    Job->Function = Function;
+    Job->Parent = Parent;
+    Job->UnfinishedJobs.store(1, std::memory_order_relaxed);
+
+    if (DataSize)
+    {
+        memcpy(Job->Data, Data, DataSize);
+    }
+
+    if (Parent)
+    {
+        Parent->UnfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return Job;
+}
+
+/** Takes one of the wake ups owed to sleeping threads. Returns false if
+ * nobody was owed one. */
+static
+bool ClaimJobWakeUp(job_system *System)
+{
+    int Sleeping = System->Sleeping.load(std::memory_order_relaxed);
+
+    while (Sleeping > 0 &&
+           !System->Sleeping.compare_exchange_weak(Sleeping, Sleeping - 1))
+    {
+    }
+
+    return Sleeping > 0;
+}
+
+/** Wakes one sleeping thread, if there are any. */
+static
+void WakeJobWorker(job_system *System)
+{
+    // NOTE[joe] Pairs with the fetch_add in SleepJobThread(). Either we see
+    // the thread going to sleep, or it sees the job we just pushed.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (ClaimJobWakeUp(System))
+    {
+        PlatformSignalSemaphore(System->WakeUp);
+    }
+}
+
+static
+bool IsJobFinished(job *Job)
+{
+    return Job->UnfinishedJobs.load(std::memory_order_acquire) == 0;
+}
+
+static
+void FinishJob(job_system *System, job *Job)
+{
+    // NOTE[joe] Read Parent first; once the count hits zero the job's slot
+    // can be handed out again.
+    job *Parent = Job->Parent;
+
+    if (Job->UnfinishedJobs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    if (Parent)
+    {
+        FinishJob(System, Parent);
+    }
+    else if (System->WaitingFiberCount.load(std::memory_order_relaxed) ||
+             System->WaitingThreadCount.load(std::memory_order_relaxed))
+    {
+        // NOTE[joe] Somebody might be waiting on this, and might be asleep.
+        // Whoever wakes up polls, so it doesn't matter who that is.
+        WakeJobWorker(System);
+    }
+}
+
+static
+void ExecuteJob(job_system *System, job *Job)
+{
+    Job->Function(System, Job, Job->Data);
+
+    FinishJob(System, Job);
+}
+
+/** Queues Job up on the calling thread's deque. */
+static
+void RunJob(job_system *System, job *Job)
+{
+    // NOTE[joe] A full deque means there's more queued up than the other
+    // threads can steal anyway, so the job is run here and now instead. It
+    // can still wait like any other, and whatever it runs goes the same way
+    // until there's room again.
+    if (!PushJob(&GetJobThread(System)->Deque, Job))
+    {
+        ExecuteJob(System, Job);
+        return;
+    }
+
+    WakeJobWorker(System);
+}
+
+/** Finds something for the calling thread to do: the newest job on its own
+ * deque, or failing that, the oldest on somebody else's. */
+static
+job *GetJob(job_system *System)
+{
+    job_thread *Thread = GetJobThread(System);
+    unsigned int ThreadIndex = GetJobThreadState()->Index;
+
+    job *Job = PopJob(&Thread->Deque);
+
+    if (Job)
+        return Job;
+
+    unsigned int ThreadCount =
+        System->ThreadCount.load(std::memory_order_acquire);
+
+    if (ThreadCount > JOB_MAX_THREADS)
+    {
+        ThreadCount = JOB_MAX_THREADS;
+    }
+
+    // NOTE[joe] Start from a random victim so that thieves spread out.
+    Thread->Random ^= Thread->Random << 13;
+    Thread->Random ^= Thread->Random >> 17;
+    Thread->Random ^= Thread->Random << 5;
+
+    unsigned int First = Thread->Random % ThreadCount;
+
+    for (unsigned int i = 0; i < ThreadCount; i++)
+    {
+        unsigned int Victim = (First + i) % ThreadCount;
+
+        if (Victim == ThreadIndex)
+            continue;
+
+        job_thread *VictimThread =
+            System->Threads[Victim].load(std::memory_order_acquire);
+
+        if (!VictimThread)
+            continue;
+
+        Job = StealJob(&VictimThread->Deque);
+
+        if (Job)
+            return Job;
+    }
+
+    return 0;
+}
+
+static
+bool IsAnyJobQueued(job_system *System)
+{
+    unsigned int ThreadCount =
+        System->ThreadCount.load(std::memory_order_acquire);
+
+    for (unsigned int i = 0; i < ThreadCount && i < JOB_MAX_THREADS; i++)
+    {
+        job_thread *Thread = System->Threads[i].load(std::memory_order_acquire);
+
+        if (Thread && !IsDequeEmpty(&Thread->Deque))
+            return true;
+    }
+
+    return false;
+}
+
+/** Takes a fiber off the free list, or returns 0 if they're all in use. */
+static
+job_fiber *AllocateJobFiber(job_system *System)
+{
+    job_fiber *Fiber = 0;
+
+    LockJobSpinLock(&System->FiberLock);
+
+    if (System->FreeFiberCount)
+    {
+        Fiber = System->FreeFibers[--System->FreeFiberCount];
+    }
+
+    UnlockJobSpinLock(&System->FiberLock);
+
+    return Fiber;
+}
+
+/** Finds a parked fiber that's done waiting and takes it off the waiting
+ * list, or returns 0 if there isn't one. */
+static
+job_fiber *TakeReadyJobFiber(job_system *System)
+{
+    if (System->WaitingFiberCount.load(std::memory_order_relaxed) == 0)
+        return 0;
+
+    // NOTE[joe] Whoever holds the lock is already polling, so don't queue
+    // up behind them to do the same.
+    if (!TryLockJobSpinLock(&System->FiberLock))
+        return 0;
+
+    job_fiber *Ready = 0;
+    unsigned int Count = System->WaitingFiberCount.load(
+        std::memory_order_relaxed);
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        job_fiber *Fiber = System->WaitingFibers[i];
+
+        if (Fiber->IsReady(Fiber->WaitData))
+        {
+            Ready = Fiber;
+
+            System->WaitingFibers[i] = System->WaitingFibers[Count - 1];
+            System->WaitingFiberCount.store(Count - 1,
+                                            std::memory_order_relaxed);
+            break;
+        }
+    }
+
+    UnlockJobSpinLock(&System->FiberLock);
+
+    return Ready;
+}
+
+/** Does whatever the fiber we just switched away from asked for. Called
+ * first thing after every switch. */
+static
+void FinishJobFiberSwitch(job_system *System)
+{
+    job_thread_state *State = GetJobThreadState();
+
+    job_fiber *Fiber = State->PendingFiber;
+    job_fiber_action Action = State->PendingAction;
+
+    State->PendingFiber = 0;
+    State->PendingAction = JOB_FIBER_NONE;
+
+    if (Action == JOB_FIBER_NONE)
+        return;
+
+    LockJobSpinLock(&System->FiberLock);
+
+    if (Action == JOB_FIBER_FREE)
+    {
+        System->FreeFibers[System->FreeFiberCount++] = Fiber;
+    }
+    else
+    {
+        unsigned int Count = System->WaitingFiberCount.load(
+            std::memory_order_relaxed);
+
+        System->WaitingFibers[Count] = Fiber;
+        System->WaitingFiberCount.store(Count + 1, std::memory_order_relaxed);
+    }
+
+    UnlockJobSpinLock(&System->FiberLock);
+}
+
+/** Switches from the current pool fiber to To, and has Action done to the
+ * current one once we're off of it. Returns when somebody switches back. */
+static
+void SwitchJobFiber(job_system *System,
+                    job_fiber *To,
+                    job_fiber_action Action)
+{
+    job_thread_state *State = GetJobThreadState();
+    job_fiber *From = State->CurrentFiber;
+
+    State->PendingFiber = From;
+    State->PendingAction = Action;
+    State->CurrentFiber = To;
+
+    PlatformSwitchToFiber(From->Fiber, To->Fiber);
+
+    // NOTE[joe] We may well be on another thread now.
+    FinishJobFiberSwitch(System);
+}
+
+/** Sleeps until somebody wakes us, or until Microseconds have gone by if
+ * that isn't zero. */
+static
+void SleepJobThread(job_system *System, unsigned int Microseconds)
+{
+    // NOTE[joe] Say we're going to sleep before the last look for work, so
+    // that anyone pushing a job after it sees us.
+    System->Sleeping.fetch_add(1, std::memory_order_seq_cst);
+
+    bool WasWoken = false;
+
+    if (!IsAnyJobQueued(System) &&
+        System->IsRunning.load(std::memory_order_seq_cst))
+    {
+        if (Microseconds)
+        {
+            WasWoken = PlatformWaitSemaphoreTimeout(System->WakeUp,
+                                                    Microseconds);
+        }
+        else
+        {
+            PlatformWaitSemaphore(System->WakeUp);
+            WasWoken = true;
+        }
+    }
+
+    // NOTE[joe] Take back our own wake up if nobody has claimed it yet. If
+    // somebody has, they've signalled (or are about to), and we have to eat
+    // it, or the next thread to sleep would wake straight back up.
+    if (!WasWoken && !ClaimJobWakeUp(System))
+    {
+        PlatformWaitSemaphore(System->WakeUp);
+    }
+}
+
+// NOTE[joe] How many times an idle thread looks for work before going to
+// sleep. Short enough not to burn a core between frames, long enough not to
+// sleep through the gaps inside one.
+#define JOB_IDLE_SPINS 256
+
+// NOTE[joe] How long a sleeping thread goes before polling the waits nothing
+// signals us about, like IO and the GPU, and how long a thread with its own
+// way of blocking blocks for before looking for jobs again.
+#define JOB_POLL_MICROSECONDS 500
+#define JOB_BLOCK_MICROSECONDS 1000
+
+/** Returns once IsReady(Data) does. On a worker, this parks the job's fiber
+ * and goes off to run other jobs in the meantime. Anywhere else (or if every
+ * fiber is already in use), it runs other jobs in place until then, and
+ * blocks when there aren't any: in Block(Data), if that isn't null, or else
+ * asleep alongside the idle workers. */
+static
+void WaitForJobCondition(job_system *System,
+                         job_wait_function *IsReady,
+                         job_block_function *Block,
+                         void *Data)
+{
+    if (IsReady(Data))
+        return;
+
+    job_fiber *Self = GetJobThreadState()->CurrentFiber;
+    job_fiber *Next = Self ? AllocateJobFiber(System) : 0;
+
+    if (Next)
+    {
+        Self->IsReady = IsReady;
+        Self->WaitData = Data;
+
+        SwitchJobFiber(System, Next, JOB_FIBER_PARK);
+
+        return;
+    }
+
+    System->WaitingThreadCount.fetch_add(1, std::memory_order_seq_cst);
+
+    unsigned int IdleSpins = 0;
+
+    while (!IsReady(Data))
+    {
+        job *Job = GetJob(System);
+
+        if (Job)
+        {
+            ExecuteJob(System, Job);
+            IdleSpins = 0;
+        }
+        else if (Block)
+        {
+            Block(Data, JOB_BLOCK_MICROSECONDS);
+        }
+        else if (++IdleSpins < JOB_IDLE_SPINS)
+        {
+            PlatformYield();
+        }
+        else
+        {
+            // NOTE[joe] Finishing a job wakes us, but nothing else does, so
+            // this can't sleep for good.
+            IdleSpins = 0;
+            SleepJobThread(System, JOB_POLL_MICROSECONDS);
+        }
+    }
+
+    System->WaitingThreadCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+static
+bool IsJobReady(void *Data)
+{
+    return IsJobFinished((job *)Data);
+}
+
+/** Returns once Job has finished. See WaitForJobCondition(). */
+// NOTE[joe] Job's slot in its pool gets reused JOB_POOL_SIZE jobs later, so
+// don't hang on to finished jobs and wait on them much later.
+static
+void WaitForJob(job_system *System, job *Job)
+{
+    WaitForJobCondition(System, IsJobReady, 0, Job);
+}
+
+/** The scheduler loop every pool fiber runs. Resumes parked fibers that are
+ * ready, otherwise runs jobs, until the job system shuts down. */
+static
+void JobFiberProc(void *Data)
+{
+    job_system *System = (job_system *)Data;
+
+    FinishJobFiberSwitch(System);
+
+    unsigned int IdleSpins = 0;
+
+    for (;;)
+    {
+        if (!System->IsRunning.load(std::memory_order_relaxed))
+        {
+            // NOTE[joe] Hand the thread back to its own fiber, so the worker
+            // can return. If another worker picks this fiber up later on,
+            // it'll come straight back here and do the same on its thread.
+            job_thread_state *State = GetJobThreadState();
+
+            State->PendingFiber = State->CurrentFiber;
+            State->PendingAction = JOB_FIBER_FREE;
+
+            job_fiber *Self = State->CurrentFiber;
+            State->CurrentFiber = 0;
+
+            PlatformSwitchToFiber(Self->Fiber, State->ThreadFiber);
+
+            FinishJobFiberSwitch(System);
+            continue;
+        }
+
+        // NOTE[joe] Finishing off jobs that were already started comes
+        // before starting new ones.
+        job_fiber *Ready = TakeReadyJobFiber(System);
+
+        if (Ready)
+        {
+            SwitchJobFiber(System, Ready, JOB_FIBER_FREE);
+            IdleSpins = 0;
+            continue;
+        }
+
+        job *Job = GetJob(System);
+
+        if (Job)
+        {
+            ExecuteJob(System, Job);
+            IdleSpins = 0;
+        }
+        else if (++IdleSpins < JOB_IDLE_SPINS)
+        {
+            PlatformYield();
+        }
+        else
+        {
+            IdleSpins = 0;
+
+            // NOTE[joe] Finishing a job wakes us, but a parked fiber could be
+            // waiting on something else, so only sleep for good when there
+            // are none. Whoever parks a fiber is awake to see it here.
+            unsigned int Microseconds =
+                System->WaitingFiberCount.load(std::memory_order_relaxed) ?
+                JOB_POLL_MICROSECONDS : 0;
+
+            SleepJobThread(System, Microseconds);
+        }
+    }
+}
+
+static
+void JobWorkerProc(void *Data)
+{
+    job_system *System = (job_system *)Data;
+
+    RegisterJobThread(System);
+
+    job_thread_state *State = GetJobThreadState();
+
+    LockJobSpinLock(&System->ArenaLock);
+    State->ThreadFiber = PlatformConvertThreadToFiber(&System->Arena);
+    UnlockJobSpinLock(&System->ArenaLock);
+
+    job_fiber *Fiber = AllocateJobFiber(System);
+
+    Assert(Fiber != 0, "No free fiber to start a worker on.\n");
+
+    State->CurrentFiber = Fiber;
+    PlatformSwitchToFiber(State->ThreadFiber, Fiber->Fiber);
+
+    // NOTE[joe] Back from JobFiberProc(), so we're shutting down.
+    FinishJobFiberSwitch(System);
+
+    PlatformConvertFiberToThread(GetJobThreadState()->ThreadFiber);
+}
+
+/** Starts WorkerCount - 1 worker threads; the calling thread is the last
+ * worker. A WorkerCount of zero means one per physical core. */
+static
+void InitializeJobSystem(job_system *System, unsigned int WorkerCount)
+{
+    if (WorkerCount == 0)
+    {
+        WorkerCount = PlatformGetCoreCount();
+    }
+
+    if (WorkerCount > JOB_MAX_THREADS / 2)
+    {
+        WorkerCount = JOB_MAX_THREADS / 2;
+    }
+
+    for (unsigned int i = 0; i < JOB_MAX_THREADS; i++)
+    {
+        System->Threads[i].store(0, std::memory_order_relaxed);
+    }
+
+    InitializeArena(&System->Arena, JOB_ARENA_SIZE, "jobs");
+    System->ArenaLock.IsLocked.store(false);
+
+    System->ThreadCount.store(0);
+    System->WorkerCount = WorkerCount;
+    System->Sleeping.store(0);
+    System->WakeUp = PlatformCreateSemaphore(&System->Arena, 0);
+    System->IsRunning.store(true);
+
+    System->FiberLock.IsLocked.store(false);
+    System->FreeFiberCount = 0;
+    System->WaitingFiberCount.store(0);
+    System->WaitingThreadCount.store(0);
+
+    for (unsigned int i = 0; i < JOB_FIBER_COUNT; i++)
+    {
+        job_fiber *Fiber = &System->Fibers[i];
+        Fiber->Fiber = PlatformCreateFiber(&System->Arena,
+                                           JOB_FIBER_STACK_SIZE,
+                                           JobFiberProc,
+                                           System);
+        Fiber->IsReady = 0;
+        Fiber->WaitData = 0;
+
+        System->FreeFibers[System->FreeFiberCount++] = Fiber;
+    }
+
+    RegisterJobThread(System);
+
+    // NOTE[joe] Workers register as they start, so from here on the arena
+    // is shared.
+    for (unsigned int i = 1; i < WorkerCount; i++)
+    {
+        LockJobSpinLock(&System->ArenaLock);
+        System->Workers[i] = PlatformCreateThread(&System->Arena,
+                                                  JobWorkerProc,
+                                                  System);
+        UnlockJobSpinLock(&System->ArenaLock);
+    }
+}
+
+/** Stops the workers. Any jobs still queued, or parked waiting, are
+ * dropped. */
+static
+void ShutdownJobSystem(job_system *System)
+{
+    System->IsRunning.store(false, std::memory_order_seq_cst);
+
+    for (unsigned int i = 1; i < System->WorkerCount; i++)
+    {
+        PlatformSignalSemaphore(System->WakeUp);
+    }
+
+    for (unsigned int i = 1; i < System->WorkerCount; i++)
+    {
+        PlatformJoinThread(System->Workers[i]);
+    }
+
+    for (unsigned int i = 0; i < JOB_MAX_THREADS; i++)
+    {
+        System->Threads[i].store(0);
+    }
+
+    for (unsigned int i = 0; i < JOB_FIBER_COUNT; i++)
+    {
+        PlatformDestroyFiber(System->Fibers[i].Fiber);
+    }
+
+    PlatformDestroySemaphore(System->WakeUp);
+
+    // NOTE[joe] Takes the threads, their deques and the fibers with it. Any
+    // thread that registered itself has to be done with the job system by
+    // now.
+    ReleaseArena(&System->Arena);
+
+    *GetJobThreadState() = {};
+}
+
+typedef struct {
+    parallel_for_function *Function;
+    void                  *Data;
+    unsigned int           Start;
+    unsigned int           End;
+    unsigned int           Chunk;
+} parallel_for_data;
+
+static
+void ParallelForJob(job_system *System, job *Job, void *Data)
+{
+    parallel_for_data Range = *(parallel_for_data *)Data;
+
+    while (Range.Start < Range.End)
+    {
+        // NOTE[joe] Looked up every time round, since Function could wait and
+        // come back on another thread.
+        job_thread *Thread = GetJobThread(System);
+
+        // NOTE[joe] Only split off work while our deque is empty, i.e. while
+        // the thieves have taken everything we've offered them so far. When
+        // nobody is stealing, this runs the whole range in Chunk sized bites
+        // without creating a single extra job.
+        if (Range.End - Range.Start >= 2 * Range.Chunk &&
+            IsDequeEmpty(&Thread->Deque))
+        {
+            unsigned int Middle = Range.Start + (Range.End - Range.Start) / 2;
+
+            parallel_for_data Half = Range;
+            Half.Start = Middle;
+
+            job *Child = CreateJob(System,
+                                   ParallelForJob,
+                                   &Half,
+                                   sizeof(Half),
+                                   Job);
+            RunJob(System, Child);
+
+            Range.End = Middle;
+        }
+        else
+        {
+            unsigned int ChunkEnd = Range.Start + Range.Chunk;
+
+            if (ChunkEnd > Range.End || ChunkEnd < Range.Start)
+            {
+                ChunkEnd = Range.End;
+            }
+
+            Range.Function(Range.Data, Range.Start, ChunkEnd);
+            Range.Start = ChunkEnd;
+        }
+    }
+}
+
+/** Calls Function over [0, Count) in chunks of at least MinimumChunk, spread
+ * across the workers. Returns a job to wait on. A MinimumChunk of zero picks
+ * one from Count and the number of workers. */
+static
+job *ParallelFor(job_system *System,
+                 parallel_for_function *Function,
+                 void *Data,
+                 unsigned int Count,
+                 unsigned int MinimumChunk,
+                 job *Parent)
+{
+    parallel_for_data Range = {};
+    Range.Function = Function;
+    Range.Data = Data;
+    Range.Start = 0;
+    Range.End = Count;
+    Range.Chunk = MinimumChunk;
+
+    if (Range.Chunk == 0)
+    {
+        // NOTE[joe] Enough chunks per worker to even out uneven work.
+        Range.Chunk = Count / (System->WorkerCount * 32);
+    }
+
+    if (Range.Chunk == 0)
+    {
+        Range.Chunk = 1;
+    }
+
+    job *Job = CreateJob(System, ParallelForJob, &Range, sizeof(Range), Parent);
+    RunJob(System, Job);
+
+    return Job;
+}
+
+/** Runs Function over [0, Count) and waits for it. */
+static
+void ParallelForAndWait(job_system *System,
+                        parallel_for_function *Function,
+                        void *Data,
+                        unsigned int Count,
+                        unsigned int MinimumChunk)
+{
+    job *Job = ParallelFor(System, Function, Data, Count, MinimumChunk, 0);
+
+    WaitForJob(System, Job);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file job.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for our job system. There's one worker
+ * per physical core, each with its own work-stealing deque. Jobs can have
+ * children, and a job only counts as finished once all of its children are.
+ *
+ * Workers run jobs on fibers. A job that waits, on another job, a fence, or
+ * anything else it can poll, parks its fiber and the worker carries on with
+ * other jobs on a fresh one. Once whatever it was waiting on is done, any
+ * worker can pick the parked fiber back up. Threads that aren't workers can't
+ * park, so when they wait they run other jobs in the meantime instead, and
+ * block once there aren't any.
+ */
+
+#ifndef _JOB_H_
+#define _JOB_H_
+
+#include <atomic>
+
+#include "memory.h"
+
+// NOTE[joe] Threads that can use the job system at once: the workers, plus
+// any other thread that registers itself (e.g. the render thread).
+#define JOB_MAX_THREADS 64
+
+// NOTE[joe] Jobs live in a per-thread ring, so at most this many jobs a
+// thread created can be unfinished at once. Both must be powers of two.
+#define JOB_POOL_SIZE 4096
+#define JOB_DEQUE_SIZE 4096
+
+#define JOB_CACHE_LINE 64
+
+// NOTE[joe] Every fiber is either running on a worker, parked waiting, or
+// free, so this bounds how many jobs can be waiting at once. Past that, waits
+// fall back to running other jobs in place.
+#define JOB_FIBER_COUNT 256
+#define JOB_FIBER_STACK_SIZE (64 * 1024)
+
+// NOTE[joe] Enough for every thread's deque and job pool, plus the fibers and
+// threads themselves. Only what's used gets committed.
+#define JOB_ARENA_SIZE MEGABYTES(32)
+
+typedef struct job job;
+typedef struct job_system job_system;
+
+typedef void job_function(job_system *System, job *Job, void *Data);
+
+/** Returns true once whatever a job is waiting on is done. Called from any
+ * worker, so it has to be thread safe and quick. */
+typedef bool job_wait_function(void *Data);
+
+/** Blocks until whatever a job is waiting on might be done, or Microseconds
+ * have gone by, whichever comes first. Only called on threads that can't
+ * park, once they've run out of other jobs. */
+typedef void job_block_function(void *Data, unsigned int Microseconds);
+
+// NOTE[joe] Whatever's left of a cache line after the bookkeeping is for the
+// job's own data, so that creating one never allocates. It starts pointer
+// aligned, since job data is mostly pointers, which costs the int's padding.
+#define JOB_DATA_SIZE (JOB_CACHE_LINE - 3 * sizeof(void *))
+
+struct alignas(JOB_CACHE_LINE) job {
+    job_function     *Function;
+    job              *Parent;
+    // NOTE[joe] One for the job itself, plus one per child not yet finished.
+    std::atomic<int>  UnfinishedJobs;
+    alignas(void *) unsigned char Data[JOB_DATA_SIZE];
+};
+
+/** A Chase-Lev deque. Only the owning thread pushes and pops, at the bottom;
+ * everyone else steals from the top. */
+typedef struct {
+    alignas(JOB_CACHE_LINE) std::atomic<long long> Top;
+    alignas(JOB_CACHE_LINE) std::atomic<long long> Bottom;
+    std::atomic<job *>                             Entries[JOB_DEQUE_SIZE];
+} job_deque;
+
+typedef struct {
+    job_deque    Deque;
+    job          Pool[JOB_POOL_SIZE];
+    unsigned int PoolNext;
+    // NOTE[joe] For picking steal victims.
+    unsigned int Random;
+} job_thread;
+
+typedef struct {
+    platform_fiber    *Fiber;
+    // NOTE[joe] What the fiber is waiting on, while it's parked.
+    job_wait_function *IsReady;
+    void              *WaitData;
+} job_fiber;
+
+/** Guards the fiber lists. They're only held for a handful of instructions,
+ * or a poll of each parked fiber. */
+typedef struct {
+    std::atomic<bool> IsLocked;
+} job_spin_lock;
+
+struct job_system {
+    std::atomic<job_thread *>  Threads[JOB_MAX_THREADS];
+    std::atomic<unsigned int>  ThreadCount;
+    unsigned int               WorkerCount;
+    platform_thread           *Workers[JOB_MAX_THREADS];
+
+    // NOTE[joe] Idle workers sleep on WakeUp, and so do threads that can't
+    // park while they wait. Sleeping counts the wake ups owed, so that
+    // pushing a job only goes to the platform when somebody is actually
+    // asleep.
+    std::atomic<int>           Sleeping;
+    platform_semaphore        *WakeUp;
+    std::atomic<bool>          IsRunning;
+
+    job_fiber                  Fibers[JOB_FIBER_COUNT];
+    job_spin_lock              FiberLock;
+    job_fiber                 *FreeFibers[JOB_FIBER_COUNT];
+    unsigned int               FreeFiberCount;
+    job_fiber                 *WaitingFibers[JOB_FIBER_COUNT];
+    // NOTE[joe] Read without the lock to skip polling when nothing waits.
+    std::atomic<unsigned int>  WaitingFiberCount;
+    // NOTE[joe] Threads that can't park, waiting in WaitForJobCondition().
+    std::atomic<unsigned int>  WaitingThreadCount;
+
+    // NOTE[joe] Everything the job system allocates comes out of this, and
+    // goes back all at once on shutdown. Threads register themselves from
+    // wherever they are, so unlike the game's arenas it's shared, under
+    // ArenaLock.
+    memory_arena               Arena;
+    job_spin_lock              ArenaLock;
+};
+
+typedef void parallel_for_function(void *Data,
+                                   unsigned int Start,
+                                   unsigned int End);
+
+#endif
@@ -0,0 +1,265 @@
+/**
+ * @file job_bench.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains microbenchmarks for the job system: what it costs to
+ * schedule a job, how well ParallelFor() scales from one worker up to one per
+ * core, what a fiber switch costs, and how many jobs we get through when they
+ * spend their time waiting. Platform layers run them with --bench-jobs,
+ * instead of the game.
+ * Results go to stdout as "name value" lines, like the frame stats.
+ */
+
+#include "platform.h"
+#include "job.h"
+
+#define JOB_BENCH_BATCH_SIZE 2048
+#define JOB_BENCH_BATCHES 256
+#define JOB_BENCH_ELEMENTS (1 << 20)
+#define JOB_BENCH_RUNS 8
+#define JOB_BENCH_SWITCHES 100000
+#define JOB_BENCH_WAITERS 128
+#define JOB_BENCH_WAITS 64
+
+static
+void EmptyJob(job_system *System, job *Job, void *Data)
+{
+}
+
+/** Returns the average nanoseconds to create, run and finish one empty job,
+ * spawned as the children of a root job. */
+static
+double BenchmarkJobOverhead(job_system *System)
+{
+    double Begin = PlatformGetTime();
+
+    for (unsigned int Batch = 0; Batch < JOB_BENCH_BATCHES; Batch++)
+    {
+        job *Root = CreateJob(System, EmptyJob, 0, 0, 0);
+
+        for (unsigned int i = 0; i < JOB_BENCH_BATCH_SIZE; i++)
+        {
+            RunJob(System, CreateJob(System, EmptyJob, 0, 0, Root));
+        }
+
+        RunJob(System, Root);
+        WaitForJob(System, Root);
+    }
+
+    double Elapsed = PlatformGetTime() - Begin;
+
+    return Elapsed * 1e9 / (JOB_BENCH_BATCHES * (JOB_BENCH_BATCH_SIZE + 1));
+}
+
+static
+void BenchmarkWork(void *Data, unsigned int Start, unsigned int End)
+{
+    float *Values = (float *)Data;
+
+    // NOTE[joe] Something like a small particle update's worth of math per
+    // element, so that scaling isn't just measuring memory bandwidth.
+    for (unsigned int i = Start; i < End; i++)
+    {
+        float Value = Values[i];
+
+        for (unsigned int Step = 0; Step < 16; Step++)
+        {
+            Value = Value * 0.999f + 0.5f / (1.0f + Value * Value);
+        }
+
+        Values[i] = Value;
+    }
+}
+
+/** Returns the best of a few timed ParallelFor() runs, in seconds. */
+static
+double BenchmarkParallelFor(job_system *System, float *Values)
+{
+    double Best = 1e9;
+
+    for (unsigned int Run = 0; Run < JOB_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        ParallelForAndWait(System,
+                           BenchmarkWork,
+                           Values,
+                           JOB_BENCH_ELEMENTS,
+                           0);
+
+        double Elapsed = PlatformGetTime() - Begin;
+
+        if (Elapsed < Best)
+        {
+            Best = Elapsed;
+        }
+    }
+
+    return Best;
+}
+
+typedef struct {
+    platform_fiber *Main;
+    platform_fiber *Other;
+} fiber_bench_data;
+
+static
+void PingPongFiberProc(void *Data)
+{
+    fiber_bench_data *Fibers = (fiber_bench_data *)Data;
+
+    for (;;)
+    {
+        PlatformSwitchToFiber(Fibers->Other, Fibers->Main);
+    }
+}
+
+/** Returns the nanoseconds one fiber switch takes, bouncing between two
+ * fibers on the calling thread. */
+static
+double BenchmarkFiberSwitch()
+{
+    memory_arena Arena;
+    InitializeArena(&Arena, KILOBYTES(64), "fiber bench");
+
+    fiber_bench_data Fibers;
+    Fibers.Main = PlatformConvertThreadToFiber(&Arena);
+    Fibers.Other = PlatformCreateFiber(&Arena,
+                                       JOB_FIBER_STACK_SIZE,
+                                       PingPongFiberProc,
+                                       &Fibers);
+
+    double Begin = PlatformGetTime();
+
+    for (unsigned int i = 0; i < JOB_BENCH_SWITCHES; i++)
+    {
+        PlatformSwitchToFiber(Fibers.Main, Fibers.Other);
+    }
+
+    double Elapsed = PlatformGetTime() - Begin;
+
+    PlatformDestroyFiber(Fibers.Other);
+    PlatformConvertFiberToThread(Fibers.Main);
+
+    ReleaseArena(&Arena);
+
+    // NOTE[joe] Two switches per round trip.
+    return Elapsed * 1e9 / (2.0 * JOB_BENCH_SWITCHES);
+}
+
+static
+void WaitedOnJob(job_system *System, job *Job, void *Data)
+{
+    float Values[64];
+
+    for (unsigned int i = 0; i < 64; i++)
+    {
+        Values[i] = (float)i;
+    }
+
+    BenchmarkWork(Values, 0, 64);
+}
+
+static
+void WaitingJob(job_system *System, job *Job, void *Data)
+{
+    // NOTE[joe] Straight-line code that spends most of its time waiting on
+    // jobs of its own.
+    for (unsigned int i = 0; i < JOB_BENCH_WAITS; i++)
+    {
+        job *Child = CreateJob(System, WaitedOnJob, 0, 0, 0);
+        RunJob(System, Child);
+
+        WaitForJob(System, Child);
+    }
+}
+
+/** Returns the average microseconds per wait, with JOB_BENCH_WAITERS jobs
+ * each waiting JOB_BENCH_WAITS times in a row. */
+static
+double BenchmarkWaiting(job_system *System)
+{
+    double Begin = PlatformGetTime();
+
+    job *Root = CreateJob(System, EmptyJob, 0, 0, 0);
+
+    for (unsigned int i = 0; i < JOB_BENCH_WAITERS; i++)
+    {
+        RunJob(System, CreateJob(System, WaitingJob, 0, 0, Root));
+    }
+
+    RunJob(System, Root);
+    WaitForJob(System, Root);
+
+    double Elapsed = PlatformGetTime() - Begin;
+
+    return Elapsed * 1e6 / (JOB_BENCH_WAITERS * JOB_BENCH_WAITS);
+}
+
+/** Runs every job system benchmark and prints the results. */
+static
+void BenchmarkJobSystem()
+{
+    unsigned int CoreCount = PlatformGetCoreCount();
+
+    printf("job_cores %u\n", CoreCount);
+
+    job_system *System = new job_system;
+
+    /** Scheduling overhead, alone and with everyone stealing. */
+
+    InitializeJobSystem(System, 1);
+    printf("job_overhead_ns_1 %.1f\n", BenchmarkJobOverhead(System));
+    ShutdownJobSystem(System);
+
+    InitializeJobSystem(System, CoreCount);
+    printf("job_overhead_ns_%u %.1f\n",
+           CoreCount,
+           BenchmarkJobOverhead(System));
+    ShutdownJobSystem(System);
+
+    /** Fibers. */
+
+    printf("fiber_switch_ns %.1f\n", BenchmarkFiberSwitch());
+
+    for (unsigned int Workers = 1; Workers <= CoreCount; Workers *= 2)
+    {
+        InitializeJobSystem(System, Workers);
+        printf("fiber_wait_us_%u %.3f\n", Workers, BenchmarkWaiting(System));
+        ShutdownJobSystem(System);
+    }
+
+    /** ParallelFor() scaling. */
+
+    float *Values = new float[JOB_BENCH_ELEMENTS];
+
+    for (unsigned int i = 0; i < JOB_BENCH_ELEMENTS; i++)
+    {
+        Values[i] = (float)(i % 1024) / 1024.0f;
+    }
+
+    double SingleTime = 0;
+
+    for (unsigned int Workers = 1; Workers <= CoreCount; Workers++)
+    {
+        InitializeJobSystem(System, Workers);
+
+        double Time = BenchmarkParallelFor(System, Values);
+
+        ShutdownJobSystem(System);
+
+        if (Workers == 1)
+        {
+            SingleTime = Time;
+        }
+
+        printf("job_scaling_%u_ms %.3f\n", Workers, Time * 1000.0);
+        printf("job_scaling_%u_efficiency %.2f\n",
+               Workers,
+               SingleTime / (Time * Workers));
+    }
+
+    delete[] Values;
+    delete System;
+}
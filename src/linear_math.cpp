@@ -0,0 +1,1005 @@
+/**
+ * @file linear_math.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our math library. See linear_math.h.
+ */
+
+#include "linear_math.h"
+
+/** Vectors. */
+
+constexpr vec2 operator+(vec2 A, vec2 B) { return { A.x + B.x, A.y + B.y }; }
+constexpr vec2 operator-(vec2 A, vec2 B) { return { A.x - B.x, A.y - B.y }; }
+constexpr vec2 operator*(vec2 A, vec2 B) { return { A.x * B.x, A.y * B.y }; }
+constexpr vec2 operator*(vec2 A, float B) { return { A.x * B, A.y * B }; }
+constexpr vec2 operator*(float A, vec2 B) { return B * A; }
+constexpr vec2 operator/(vec2 A, float B) { return A * (1.0f / B); }
+constexpr vec2 operator-(vec2 A) { return { -A.x, -A.y }; }
+
+constexpr vec3 operator+(vec3 A, vec3 B)
+{
+    return { A.x + B.x, A.y + B.y, A.z + B.z };
+}
+
+constexpr vec3 operator-(vec3 A, vec3 B)
+{
+    return { A.x - B.x, A.y - B.y, A.z - B.z };
+}
+
+constexpr vec3 operator*(vec3 A, vec3 B)
+{
+    return { A.x * B.x, A.y * B.y, A.z * B.z };
+}
+
+constexpr vec3 operator*(vec3 A, float B)
+{
+    return { A.x * B, A.y * B, A.z * B };
+}
+
+constexpr vec3 operator*(float A, vec3 B) { return B * A; }
+constexpr vec3 operator/(vec3 A, float B) { return A * (1.0f / B); }
+constexpr vec3 operator-(vec3 A) { return { -A.x, -A.y, -A.z }; }
+
+constexpr vec4 operator+(vec4 A, vec4 B)
+{
+    return { A.x + B.x, A.y + B.y, A.z + B.z, A.w + B.w };
+}
+
+constexpr vec4 operator-(vec4 A, vec4 B)
+{
+    return { A.x - B.x, A.y - B.y, A.z - B.z, A.w - B.w };
+}
+
+constexpr vec4 operator*(vec4 A, vec4 B)
+{
+    return { A.x * B.x, A.y * B.y, A.z * B.z, A.w * B.w };
+}
+
+constexpr vec4 operator*(vec4 A, float B)
+{
+    return { A.x * B, A.y * B, A.z * B, A.w * B };
+}
+
+constexpr vec4 operator*(float A, vec4 B) { return B * A; }
+constexpr vec4 operator/(vec4 A, float B) { return A * (1.0f / B); }
+constexpr vec4 operator-(vec4 A) { return { -A.x, -A.y, -A.z, -A.w }; }
+
+constexpr vec3 Vec3(vec4 A) { return { A.x, A.y, A.z }; }
+constexpr vec4 Vec4(vec3 A, float W) { return { A.x, A.y, A.z, W }; }
+
+constexpr float Dot(vec2 A, vec2 B) { return A.x * B.x + A.y * B.y; }
+
+constexpr float Dot(vec3 A, vec3 B)
+{
+    return A.x * B.x + A.y * B.y + A.z * B.z;
+}
+
+constexpr float Dot(vec4 A, vec4 B)
+{
+    return A.x * B.x + A.y * B.y + A.z * B.z + A.w * B.w;
+}
+
+constexpr vec3 Cross(vec3 A, vec3 B)
+{
+    return {
+        A.y * B.z - A.z * B.y,
+        A.z * B.x - A.x * B.z,
+        A.x * B.y - A.y * B.x
+    };
+}
+
+static inline float Length(vec2 A) { return sqrtf(Dot(A, A)); }
+static inline float Length(vec3 A) { return sqrtf(Dot(A, A)); }
+static inline float Length(vec4 A) { return sqrtf(Dot(A, A)); }
+
+/** Returns A scaled to length one. A can't be zero. */
+static inline vec2 Normalize(vec2 A) { return A / Length(A); }
+static inline vec3 Normalize(vec3 A) { return A / Length(A); }
+static inline vec4 Normalize(vec4 A) { return A / Length(A); }
+
+constexpr float Lerp(float A, float B, float T) { return A + (B - A) * T; }
+constexpr vec2 Lerp(vec2 A, vec2 B, float T) { return A + (B - A) * T; }
+constexpr vec3 Lerp(vec3 A, vec3 B, float T) { return A + (B - A) * T; }
+constexpr vec4 Lerp(vec4 A, vec4 B, float T) { return A + (B - A) * T; }
+
+/** Quaternions. */
+
+constexpr quat QuatIdentity() { return { 0.0f, 0.0f, 0.0f, 1.0f }; }
+
+/** A rotation of Angle radians about Axis, which has to be unit length. */
+static inline
+quat QuatFromAxisAngle(vec3 Axis, float Angle)
+{
+    float Sin = sinf(Angle * 0.5f);
+
+    return { Axis.x * Sin, Axis.y * Sin, Axis.z * Sin, cosf(Angle * 0.5f) };
+}
+
+/** A then B, i.e. rotating by the result is rotating by B, then by A. */
+constexpr quat operator*(quat A, quat B)
+{
+    return {
+        A.w * B.x + A.x * B.w + A.y * B.z - A.z * B.y,
+        A.w * B.y - A.x * B.z + A.y * B.w + A.z * B.x,
+        A.w * B.z + A.x * B.y - A.y * B.x + A.z * B.w,
+        A.w * B.w - A.x * B.x - A.y * B.y - A.z * B.z
+    };
+}
+
+constexpr quat Conjugate(quat A) { return { -A.x, -A.y, -A.z, A.w }; }
+
+constexpr float Dot(quat A, quat B)
+{
+    return A.x * B.x + A.y * B.y + A.z * B.z + A.w * B.w;
+}
+
+static inline
+quat Normalize(quat A)
+{
+    float Scale = 1.0f / sqrtf(Dot(A, A));
+
+    return { A.x * Scale, A.y * Scale, A.z * Scale, A.w * Scale };
+}
+
+/** Rotates V by Q, which has to be unit length. */
+constexpr vec3 Rotate(quat Q, vec3 V)
+{
+    // NOTE[joe] V + 2w(q x V) + 2(q x (q x V)), with q the vector part.
+    vec3 Axis = { Q.x, Q.y, Q.z };
+    vec3 T = 2.0f * Cross(Axis, V);
+
+    return V + Q.w * T + Cross(Axis, T);
+}
+
+/** Normalized linear interpolation, the short way around. Cheaper than
+ * Slerp(), and close enough for blending animation. */
+static inline
+quat Nlerp(quat A, quat B, float T)
+{
+    float Sign = Dot(A, B) < 0.0f ? -1.0f : 1.0f;
+
+    quat Result = {
+        A.x + (B.x * Sign - A.x) * T,
+        A.y + (B.y * Sign - A.y) * T,
+        A.z + (B.z * Sign - A.z) * T,
+        A.w + (B.w * Sign - A.w) * T
+    };
+
+    return Normalize(Result);
+}
+
+static inline
+quat Slerp(quat A, quat B, float T)
+{
+    float Cos = Dot(A, B);
+    float Sign = 1.0f;
+
+    if (Cos < 0.0f)
+    {
+        Cos = -Cos;
+        Sign = -1.0f;
+    }
+
+    // NOTE[joe] Nearly the same rotation; the angle is too small to divide
+    // by, and a straight line is just as good.
+    if (Cos > 0.9995f)
+    {
+        return Nlerp(A, B, T);
+    }
+
+    float Angle = acosf(Cos);
+    float Scale = 1.0f / sinf(Angle);
+    float WeightA = sinf((1.0f - T) * Angle) * Scale;
+    float WeightB = sinf(T * Angle) * Scale * Sign;
+
+    return {
+        A.x * WeightA + B.x * WeightB,
+        A.y * WeightA + B.y * WeightB,
+        A.z * WeightA + B.z * WeightB,
+        A.w * WeightA + B.w * WeightB
+    };
+}
+
+/** 3x3 matrices. */
+
+constexpr mat3 Mat3Identity()
+{
+    return { { { 1.0f, 0.0f, 0.0f },
+               { 0.0f, 1.0f, 0.0f },
+               { 0.0f, 0.0f, 1.0f } } };
+}
+
+constexpr vec3 operator*(const mat3 &A, vec3 B)
+{
+    return A.Columns[0] * B.x + A.Columns[1] * B.y + A.Columns[2] * B.z;
+}
+
+constexpr mat3 operator*(const mat3 &A, const mat3 &B)
+{
+    return { { A * B.Columns[0], A * B.Columns[1], A * B.Columns[2] } };
+}
+
+constexpr mat3 Transpose(const mat3 &A)
+{
+    return { { { A.Columns[0].x, A.Columns[1].x, A.Columns[2].x },
+               { A.Columns[0].y, A.Columns[1].y, A.Columns[2].y },
+               { A.Columns[0].z, A.Columns[1].z, A.Columns[2].z } } };
+}
+
+constexpr float Determinant(const mat3 &A)
+{
+    return Dot(A.Columns[0], Cross(A.Columns[1], A.Columns[2]));
+}
+
+/** The inverse of A, which has to be invertible. */
+constexpr mat3 Inverse(const mat3 &A)
+{
+    // NOTE[joe] The rows of the inverse are the cross products of pairs of
+    // columns, over the determinant.
+    vec3 Row0 = Cross(A.Columns[1], A.Columns[2]);
+    vec3 Row1 = Cross(A.Columns[2], A.Columns[0]);
+    vec3 Row2 = Cross(A.Columns[0], A.Columns[1]);
+
+    float Scale = 1.0f / Dot(A.Columns[0], Row0);
+
+    mat3 Rows = { { Row0 * Scale, Row1 * Scale, Row2 * Scale } };
+
+    return Transpose(Rows);
+}
+
+/** The upper left 3x3 of A, e.g. for transforming normals. */
+constexpr mat3 Mat3FromMat4(const mat4 &A)
+{
+    return { { Vec3(A.Columns[0]), Vec3(A.Columns[1]), Vec3(A.Columns[2]) } };
+}
+
+/** 4x4 matrices. */
+
+constexpr mat4 Mat4Identity()
+{
+    return { { { 1.0f, 0.0f, 0.0f, 0.0f },
+               { 0.0f, 1.0f, 0.0f, 0.0f },
+               { 0.0f, 0.0f, 1.0f, 0.0f },
+               { 0.0f, 0.0f, 0.0f, 1.0f } } };
+}
+
+constexpr mat4 Mat4Translation(vec3 Translation)
+{
+    mat4 Result = Mat4Identity();
+    Result.Columns[3] = Vec4(Translation, 1.0f);
+
+    return Result;
+}
+
+constexpr mat4 Mat4Scale(vec3 Scale)
+{
+    mat4 Result = Mat4Identity();
+    Result.Columns[0].x = Scale.x;
+    Result.Columns[1].y = Scale.y;
+    Result.Columns[2].z = Scale.z;
+
+    return Result;
+}
+
+/** Rotation matrices turn counter clockwise, looking down the axis towards
+ * the origin. */
+static inline
+mat4 Mat4RotationX(float Angle)
+{
+    float Cos = cosf(Angle);
+    float Sin = sinf(Angle);
+
+    mat4 Result = Mat4Identity();
+    Result.Columns[1] = { 0.0f, Cos, Sin, 0.0f };
+    Result.Columns[2] = { 0.0f, -Sin, Cos, 0.0f };
+
+    return Result;
+}
+
+static inline
+mat4 Mat4RotationY(float Angle)
+{
+    float Cos = cosf(Angle);
+    float Sin = sinf(Angle);
+
+    mat4 Result = Mat4Identity();
+    Result.Columns[0] = { Cos, 0.0f, -Sin, 0.0f };
+    Result.Columns[2] = { Sin, 0.0f, Cos, 0.0f };
+
+    return Result;
+}
+
+static inline
+mat4 Mat4RotationZ(float Angle)
+{
+    float Cos = cosf(Angle);
+    float Sin = sinf(Angle);
+
+    mat4 Result = Mat4Identity();
+    Result.Columns[0] = { Cos, Sin, 0.0f, 0.0f };
+    Result.Columns[1] = { -Sin, Cos, 0.0f, 0.0f };
+
+    return Result;
+}
+
+/** The rotation Q (unit length) as a matrix. */
+constexpr mat4 Mat4FromQuat(quat Q)
+{
+    float XX = Q.x * Q.x, YY = Q.y * Q.y, ZZ = Q.z * Q.z;
+    float XY = Q.x * Q.y, XZ = Q.x * Q.z, YZ = Q.y * Q.z;
+    float WX = Q.w * Q.x, WY = Q.w * Q.y, WZ = Q.w * Q.z;
+
+    return { { { 1.0f - 2.0f * (YY + ZZ), 2.0f * (XY + WZ), 2.0f * (XZ - WY),
+                 0.0f },
+               { 2.0f * (XY - WZ), 1.0f - 2.0f * (XX + ZZ), 2.0f * (YZ + WX),
+                 0.0f },
+               { 2.0f * (XZ + WY), 2.0f * (YZ - WX), 1.0f - 2.0f * (XX + YY),
+                 0.0f },
+               { 0.0f, 0.0f, 0.0f, 1.0f } } };
+}
+
+/** Scales, then rotates, then translates. */
+constexpr mat4 Mat4FromTransform(vec3 Translation, quat Rotation, vec3 Scale)
+{
+    mat4 Result = Mat4FromQuat(Rotation);
+    Result.Columns[0] = Result.Columns[0] * Scale.x;
+    Result.Columns[1] = Result.Columns[1] * Scale.y;
+    Result.Columns[2] = Result.Columns[2] * Scale.z;
+    Result.Columns[3] = Vec4(Translation, 1.0f);
+
+    return Result;
+}
+
+constexpr mat4 Transpose(const mat4 &A)
+{
+    const vec4 *C = A.Columns;
+
+    return { { { C[0].x, C[1].x, C[2].x, C[3].x },
+               { C[0].y, C[1].y, C[2].y, C[3].y },
+               { C[0].z, C[1].z, C[2].z, C[3].z },
+               { C[0].w, C[1].w, C[2].w, C[3].w } } };
+}
+
+/** Projections map into Vulkan's clip space: x right, y down, and depth
+ * from zero at the near plane to one at the far plane. View space is right
+ * handed, looking down -Z with +Y up. */
+static inline
+mat4 Perspective(float FieldOfViewY, float Aspect, float Near, float Far)
+{
+    float Focal = 1.0f / tanf(FieldOfViewY * 0.5f);
+
+    mat4 Result = {};
+    Result.Columns[0].x = Focal / Aspect;
+    Result.Columns[1].y = -Focal;
+    Result.Columns[2].z = Far / (Near - Far);
+    Result.Columns[2].w = -1.0f;
+    Result.Columns[3].z = Near * Far / (Near - Far);
+
+    return Result;
+}
+
+constexpr mat4 Orthographic(float Left,
+                            float Right,
+                            float Bottom,
+                            float Top,
+                            float Near,
+                            float Far)
+{
+    mat4 Result = Mat4Identity();
+    Result.Columns[0].x = 2.0f / (Right - Left);
+    Result.Columns[1].y = -2.0f / (Top - Bottom);
+    Result.Columns[2].z = -1.0f / (Far - Near);
+    Result.Columns[3] = {
+        -(Right + Left) / (Right - Left),
+        (Top + Bottom) / (Top - Bottom),
+        -Near / (Far - Near),
+        1.0f
+    };
+
+    return Result;
+}
+
+/** A view matrix from Eye looking at Target. Up can't point the same way. */
+static inline
+mat4 LookAt(vec3 Eye, vec3 Target, vec3 Up)
+{
+    vec3 Forward = Normalize(Target - Eye);
+    vec3 Right = Normalize(Cross(Forward, Up));
+    vec3 TrueUp = Cross(Right, Forward);
+
+    mat4 Result = {};
+    Result.Columns[0] = { Right.x, TrueUp.x, -Forward.x, 0.0f };
+    Result.Columns[1] = { Right.y, TrueUp.y, -Forward.y, 0.0f };
+    Result.Columns[2] = { Right.z, TrueUp.z, -Forward.z, 0.0f };
+    Result.Columns[3] = {
+        -Dot(Right, Eye),
+        -Dot(TrueUp, Eye),
+        Dot(Forward, Eye),
+        1.0f
+    };
+
+    return Result;
+}
+
+/** Backends. Every backend does the same four things: multiply two
+ * matrices, invert one, and transform points, either as an array of vec4s
+ * or in batches of vec4x8. Results and inputs mustn't overlap. */
+
+template <>
+struct math_kernels<math_scalar> {
+    static constexpr
+    void Multiply(const mat4 *A, const mat4 *B, mat4 *Result)
+    {
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            Result->Columns[i] = A->Columns[0] * B->Columns[i].x +
+                                 A->Columns[1] * B->Columns[i].y +
+                                 A->Columns[2] * B->Columns[i].z +
+                                 A->Columns[3] * B->Columns[i].w;
+        }
+    }
+
+    static constexpr
+    void Inverse(const mat4 *A, mat4 *Result)
+    {
+        // NOTE[joe] Laplace expansion by 2x2 minors: the S terms are the
+        // minors of the first two rows, the C terms of the last two. Here
+        // aRC is row R, column C.
+        float a00 = A->Columns[0].x, a01 = A->Columns[1].x;
+        float a02 = A->Columns[2].x, a03 = A->Columns[3].x;
+        float a10 = A->Columns[0].y, a11 = A->Columns[1].y;
+        float a12 = A->Columns[2].y, a13 = A->Columns[3].y;
+        float a20 = A->Columns[0].z, a21 = A->Columns[1].z;
+        float a22 = A->Columns[2].z, a23 = A->Columns[3].z;
+        float a30 = A->Columns[0].w, a31 = A->Columns[1].w;
+        float a32 = A->Columns[2].w, a33 = A->Columns[3].w;
+
+        float S0 = a00 * a11 - a10 * a01;
+        float S1 = a00 * a12 - a10 * a02;
+        float S2 = a00 * a13 - a10 * a03;
+        float S3 = a01 * a12 - a11 * a02;
+        float S4 = a01 * a13 - a11 * a03;
+        float S5 = a02 * a13 - a12 * a03;
+
+        float C5 = a22 * a33 - a32 * a23;
+        float C4 = a21 * a33 - a31 * a23;
+        float C3 = a21 * a32 - a31 * a22;
+        float C2 = a20 * a33 - a30 * a23;
+        float C1 = a20 * a32 - a30 * a22;
+        float C0 = a20 * a31 - a30 * a21;
+
+        float Scale = 1.0f / (S0 * C5 - S1 * C4 + S2 * C3 +
+                              S3 * C2 - S4 * C1 + S5 * C0);
+
+        Result->Columns[0] = {
+            (a11 * C5 - a12 * C4 + a13 * C3) * Scale,
+            (-a10 * C5 + a12 * C2 - a13 * C1) * Scale,
+            (a10 * C4 - a11 * C2 + a13 * C0) * Scale,
+            (-a10 * C3 + a11 * C1 - a12 * C0) * Scale
+        };
+        Result->Columns[1] = {
+            (-a01 * C5 + a02 * C4 - a03 * C3) * Scale,
+            (a00 * C5 - a02 * C2 + a03 * C1) * Scale,
+            (-a00 * C4 + a01 * C2 - a03 * C0) * Scale,
+            (a00 * C3 - a01 * C1 + a02 * C0) * Scale
+        };
+        Result->Columns[2] = {
+            (a31 * S5 - a32 * S4 + a33 * S3) * Scale,
+            (-a30 * S5 + a32 * S2 - a33 * S1) * Scale,
+            (a30 * S4 - a31 * S2 + a33 * S0) * Scale,
+            (-a30 * S3 + a31 * S1 - a32 * S0) * Scale
+        };
+        Result->Columns[3] = {
+            (-a21 * S5 + a22 * S4 - a23 * S3) * Scale,
+            (a20 * S5 - a22 * S2 + a23 * S1) * Scale,
+            (-a20 * S4 + a21 * S2 - a23 * S0) * Scale,
+            (a20 * S3 - a21 * S1 + a22 * S0) * Scale
+        };
+    }
+
+    static constexpr
+    void TransformPoints(const mat4 *A,
+                         const vec4 *Points,
+                         vec4 *Result,
+                         unsigned int Count)
+    {
+        for (unsigned int i = 0; i < Count; i++)
+        {
+            Result[i] = A->Columns[0] * Points[i].x +
+                        A->Columns[1] * Points[i].y +
+                        A->Columns[2] * Points[i].z +
+                        A->Columns[3] * Points[i].w;
+        }
+    }
+
+    static
+    void TransformBatches(const mat4 *A,
+                          const vec4x8 *Batches,
+                          vec4x8 *Result,
+                          unsigned int Count)
+    {
+        const float *M = &A->Columns[0].x;
+
+        for (unsigned int Batch = 0; Batch < Count; Batch++)
+        {
+            const vec4x8 *In = &Batches[Batch];
+            vec4x8 *Out = &Result[Batch];
+
+            for (unsigned int i = 0; i < MATH_BATCH_WIDTH; i++)
+            {
+                float X = In->x[i], Y = In->y[i], Z = In->z[i], W = In->w[i];
+
+                Out->x[i] = M[0] * X + M[4] * Y + M[8] * Z + M[12] * W;
+                Out->y[i] = M[1] * X + M[5] * Y + M[9] * Z + M[13] * W;
+                Out->z[i] = M[2] * X + M[6] * Y + M[10] * Z + M[14] * W;
+                Out->w[i] = M[3] * X + M[7] * Y + M[11] * Z + M[15] * W;
+            }
+        }
+    }
+};
+
+#if MATH_HAS_SSE
+
+#define MATH_SHUFFLE(A, B, X, Y, Z, W) \
+    _mm_shuffle_ps(A, B, _MM_SHUFFLE(W, Z, Y, X))
+
+template <>
+struct math_kernels<math_sse> {
+    static inline
+    __m128 Combine(__m128 A0, __m128 A1, __m128 A2, __m128 A3, __m128 B)
+    {
+        __m128 Result = _mm_mul_ps(A0, MATH_SHUFFLE(B, B, 0, 0, 0, 0));
+        Result = _mm_add_ps(Result,
+                            _mm_mul_ps(A1, MATH_SHUFFLE(B, B, 1, 1, 1, 1)));
+        Result = _mm_add_ps(Result,
+                            _mm_mul_ps(A2, MATH_SHUFFLE(B, B, 2, 2, 2, 2)));
+        Result = _mm_add_ps(Result,
+                            _mm_mul_ps(A3, MATH_SHUFFLE(B, B, 3, 3, 3, 3)));
+
+        return Result;
+    }
+
+    static inline
+    void Multiply(const mat4 *A, const mat4 *B, mat4 *Result)
+    {
+        __m128 A0 = _mm_load_ps(&A->Columns[0].x);
+        __m128 A1 = _mm_load_ps(&A->Columns[1].x);
+        __m128 A2 = _mm_load_ps(&A->Columns[2].x);
+        __m128 A3 = _mm_load_ps(&A->Columns[3].x);
+
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            __m128 Column = _mm_load_ps(&B->Columns[i].x);
+
+            _mm_store_ps(&Result->Columns[i].x,
+                         Combine(A0, A1, A2, A3, Column));
+        }
+    }
+
+    /** A 2x2 matrix, packed as (m00, m01, m10, m11), times another. */
+    static inline
+    __m128 Multiply2x2(__m128 A, __m128 B)
+    {
+        return _mm_add_ps(
+            _mm_mul_ps(A, MATH_SHUFFLE(B, B, 0, 3, 0, 3)),
+            _mm_mul_ps(MATH_SHUFFLE(A, A, 1, 0, 3, 2),
+                       MATH_SHUFFLE(B, B, 2, 1, 2, 1)));
+    }
+
+    /** The adjugate of A times B. */
+    static inline
+    __m128 AdjugateMultiply2x2(__m128 A, __m128 B)
+    {
+        return _mm_sub_ps(
+            _mm_mul_ps(MATH_SHUFFLE(A, A, 3, 3, 0, 0), B),
+            _mm_mul_ps(MATH_SHUFFLE(A, A, 1, 1, 2, 2),
+                       MATH_SHUFFLE(B, B, 2, 3, 0, 1)));
+    }
+
+    /** A times the adjugate of B. */
+    static inline
+    __m128 MultiplyAdjugate2x2(__m128 A, __m128 B)
+    {
+        return _mm_sub_ps(
+            _mm_mul_ps(A, MATH_SHUFFLE(B, B, 3, 0, 3, 0)),
+            _mm_mul_ps(MATH_SHUFFLE(A, A, 1, 0, 3, 2),
+                       MATH_SHUFFLE(B, B, 2, 1, 2, 1)));
+    }
+
+    static inline
+    void Inverse(const mat4 *A, mat4 *Result)
+    {
+        // NOTE[joe] Blockwise inversion, treating A as four 2x2 matrices:
+        //
+        //     A = | P Q |    inverse(A) = 1/|A| | X Y |
+        //         | R S |                       | Z W |
+        //
+        // Working on columns as if they were rows gives us the inverse of
+        // the transpose, laid out as rows, which is the inverse laid out as
+        // columns; so this doesn't care which way round A is stored.
+        __m128 C0 = _mm_load_ps(&A->Columns[0].x);
+        __m128 C1 = _mm_load_ps(&A->Columns[1].x);
+        __m128 C2 = _mm_load_ps(&A->Columns[2].x);
+        __m128 C3 = _mm_load_ps(&A->Columns[3].x);
+
+        __m128 P = _mm_movelh_ps(C0, C1);
+        __m128 Q = _mm_movehl_ps(C1, C0);
+        __m128 R = _mm_movelh_ps(C2, C3);
+        __m128 S = _mm_movehl_ps(C3, C2);
+
+        // The four blocks' determinants, as (|P|, |Q|, |R|, |S|).
+        __m128 Determinants = _mm_sub_ps(
+            _mm_mul_ps(MATH_SHUFFLE(C0, C2, 0, 2, 0, 2),
+                       MATH_SHUFFLE(C1, C3, 1, 3, 1, 3)),
+            _mm_mul_ps(MATH_SHUFFLE(C0, C2, 1, 3, 1, 3),
+                       MATH_SHUFFLE(C1, C3, 0, 2, 0, 2)));
+
+        __m128 DetP = MATH_SHUFFLE(Determinants, Determinants, 0, 0, 0, 0);
+        __m128 DetQ = MATH_SHUFFLE(Determinants, Determinants, 1, 1, 1, 1);
+        __m128 DetR = MATH_SHUFFLE(Determinants, Determinants, 2, 2, 2, 2);
+        __m128 DetS = MATH_SHUFFLE(Determinants, Determinants, 3, 3, 3, 3);
+
+        __m128 AdjSR = AdjugateMultiply2x2(S, R);
+        __m128 AdjPQ = AdjugateMultiply2x2(P, Q);
+
+        __m128 X = _mm_sub_ps(_mm_mul_ps(DetS, P), Multiply2x2(Q, AdjSR));
+        __m128 W = _mm_sub_ps(_mm_mul_ps(DetP, S), Multiply2x2(R, AdjPQ));
+        __m128 Y = _mm_sub_ps(_mm_mul_ps(DetQ, R),
+                              MultiplyAdjugate2x2(S, AdjPQ));
+        __m128 Z = _mm_sub_ps(_mm_mul_ps(DetR, Q),
+                              MultiplyAdjugate2x2(P, AdjSR));
+
+        // |A| = |P||S| + |Q||R| - trace((adj(P)Q)(adj(S)R))
+        __m128 Trace = _mm_mul_ps(AdjPQ,
+                                  MATH_SHUFFLE(AdjSR, AdjSR, 0, 2, 1, 3));
+        Trace = _mm_add_ps(Trace, MATH_SHUFFLE(Trace, Trace, 2, 3, 0, 1));
+        Trace = _mm_add_ps(Trace, MATH_SHUFFLE(Trace, Trace, 1, 0, 3, 2));
+
+        __m128 Determinant = _mm_sub_ps(
+            _mm_add_ps(_mm_mul_ps(DetP, DetS), _mm_mul_ps(DetQ, DetR)),
+            Trace);
+
+        // NOTE[joe] The signs finish off taking the adjugates of X, Y, Z and
+        // W; the shuffles below do the rest of it along with the transpose.
+        __m128 Scale = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f),
+                                  Determinant);
+
+        X = _mm_mul_ps(X, Scale);
+        Y = _mm_mul_ps(Y, Scale);
+        Z = _mm_mul_ps(Z, Scale);
+        W = _mm_mul_ps(W, Scale);
+
+        _mm_store_ps(&Result->Columns[0].x, MATH_SHUFFLE(X, Y, 3, 1, 3, 1));
+        _mm_store_ps(&Result->Columns[1].x, MATH_SHUFFLE(X, Y, 2, 0, 2, 0));
+        _mm_store_ps(&Result->Columns[2].x, MATH_SHUFFLE(Z, W, 3, 1, 3, 1));
+        _mm_store_ps(&Result->Columns[3].x, MATH_SHUFFLE(Z, W, 2, 0, 2, 0));
+    }
+
+    static inline
+    void TransformPoints(const mat4 *A,
+                         const vec4 *Points,
+                         vec4 *Result,
+                         unsigned int Count)
+    {
+        __m128 A0 = _mm_load_ps(&A->Columns[0].x);
+        __m128 A1 = _mm_load_ps(&A->Columns[1].x);
+        __m128 A2 = _mm_load_ps(&A->Columns[2].x);
+        __m128 A3 = _mm_load_ps(&A->Columns[3].x);
+
+        for (unsigned int i = 0; i < Count; i++)
+        {
+            __m128 Point = _mm_load_ps(&Points[i].x);
+
+            _mm_store_ps(&Result[i].x, Combine(A0, A1, A2, A3, Point));
+        }
+    }
+
+    static inline
+    void TransformBatches(const mat4 *A,
+                          const vec4x8 *Batches,
+                          vec4x8 *Result,
+                          unsigned int Count)
+    {
+        const float *M = &A->Columns[0].x;
+
+        // NOTE[joe] Each output component is a row of A dotted with the
+        // point, so broadcast A's elements and go four points at a time.
+        __m128 Elements[16];
+
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            Elements[i] = _mm_set1_ps(M[i]);
+        }
+
+        for (unsigned int Batch = 0; Batch < Count; Batch++)
+        {
+            const vec4x8 *In = &Batches[Batch];
+            vec4x8 *Out = &Result[Batch];
+
+            for (unsigned int i = 0; i < MATH_BATCH_WIDTH; i += 4)
+            {
+                __m128 X = _mm_load_ps(&In->x[i]);
+                __m128 Y = _mm_load_ps(&In->y[i]);
+                __m128 Z = _mm_load_ps(&In->z[i]);
+                __m128 W = _mm_load_ps(&In->w[i]);
+
+                float *Outputs[4] = { Out->x, Out->y, Out->z, Out->w };
+
+                for (unsigned int Row = 0; Row < 4; Row++)
+                {
+                    __m128 Value = _mm_mul_ps(Elements[Row], X);
+                    Value = _mm_add_ps(Value,
+                                       _mm_mul_ps(Elements[4 + Row], Y));
+                    Value = _mm_add_ps(Value,
+                                       _mm_mul_ps(Elements[8 + Row], Z));
+                    Value = _mm_add_ps(Value,
+                                       _mm_mul_ps(Elements[12 + Row], W));
+
+                    _mm_store_ps(&Outputs[Row][i], Value);
+                }
+            }
+        }
+    }
+};
+
+#endif
+
+#if MATH_HAS_AVX2
+
+/** The same as SSE for single matrices, which don't have eight of anything
+ * to fill a register with, and eight points at a time with FMA. */
+template <>
+struct math_kernels<math_avx2> : math_kernels<math_sse> {
+    static inline
+    void Multiply(const mat4 *A, const mat4 *B, mat4 *Result)
+    {
+        // NOTE[joe] Two columns at a time, with A in both halves.
+        __m256 A0 = _mm256_broadcast_ps((const __m128 *)&A->Columns[0]);
+        __m256 A1 = _mm256_broadcast_ps((const __m128 *)&A->Columns[1]);
+        __m256 A2 = _mm256_broadcast_ps((const __m128 *)&A->Columns[2]);
+        __m256 A3 = _mm256_broadcast_ps((const __m128 *)&A->Columns[3]);
+
+        for (unsigned int i = 0; i < 4; i += 2)
+        {
+            // NOTE[joe] mat4 is only 16 byte aligned, so a pair of columns
+            // may straddle 32.
+            __m256 Pair = _mm256_loadu_ps(&B->Columns[i].x);
+
+            // NOTE[joe] Shuffles stay within each half, so these broadcast
+            // one element of each column across its own half.
+            __m256 Column =
+                _mm256_mul_ps(A0, _mm256_shuffle_ps(Pair, Pair, 0x00));
+            Column = _mm256_fmadd_ps(A1,
+                                     _mm256_shuffle_ps(Pair, Pair, 0x55),
+                                     Column);
+            Column = _mm256_fmadd_ps(A2,
+                                     _mm256_shuffle_ps(Pair, Pair, 0xAA),
+                                     Column);
+            Column = _mm256_fmadd_ps(A3,
+                                     _mm256_shuffle_ps(Pair, Pair, 0xFF),
+                                     Column);
+
+            _mm256_storeu_ps(&Result->Columns[i].x, Column);
+        }
+    }
+
+    static inline
+    void TransformBatches(const mat4 *A,
+                          const vec4x8 *Batches,
+                          vec4x8 *Result,
+                          unsigned int Count)
+    {
+        const float *M = &A->Columns[0].x;
+
+        __m256 Elements[16];
+
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            Elements[i] = _mm256_set1_ps(M[i]);
+        }
+
+        for (unsigned int Batch = 0; Batch < Count; Batch++)
+        {
+            const vec4x8 *In = &Batches[Batch];
+            vec4x8 *Out = &Result[Batch];
+
+            __m256 X = _mm256_load_ps(In->x);
+            __m256 Y = _mm256_load_ps(In->y);
+            __m256 Z = _mm256_load_ps(In->z);
+            __m256 W = _mm256_load_ps(In->w);
+
+            float *Outputs[4] = { Out->x, Out->y, Out->z, Out->w };
+
+            for (unsigned int Row = 0; Row < 4; Row++)
+            {
+                __m256 Value = _mm256_mul_ps(Elements[Row], X);
+                Value = _mm256_fmadd_ps(Elements[4 + Row], Y, Value);
+                Value = _mm256_fmadd_ps(Elements[8 + Row], Z, Value);
+                Value = _mm256_fmadd_ps(Elements[12 + Row], W, Value);
+
+                _mm256_store_ps(Outputs[Row], Value);
+            }
+        }
+    }
+};
+
+#endif
+
+#if MATH_HAS_NEON
+
+/** NEON has no cheap way to do the SSE inverse's shuffles, so inverses stay
+ * scalar. */
+template <>
+struct math_kernels<math_neon> : math_kernels<math_scalar> {
+    static inline
+    float32x4_t Combine(float32x4_t A0,
+                        float32x4_t A1,
+                        float32x4_t A2,
+                        float32x4_t A3,
+                        float32x4_t B)
+    {
+        float32x4_t Result = vmulq_n_f32(A0, vgetq_lane_f32(B, 0));
+        Result = vmlaq_n_f32(Result, A1, vgetq_lane_f32(B, 1));
+        Result = vmlaq_n_f32(Result, A2, vgetq_lane_f32(B, 2));
+        Result = vmlaq_n_f32(Result, A3, vgetq_lane_f32(B, 3));
+
+        return Result;
+    }
+
+    static inline
+    void Multiply(const mat4 *A, const mat4 *B, mat4 *Result)
+    {
+        float32x4_t A0 = vld1q_f32(&A->Columns[0].x);
+        float32x4_t A1 = vld1q_f32(&A->Columns[1].x);
+        float32x4_t A2 = vld1q_f32(&A->Columns[2].x);
+        float32x4_t A3 = vld1q_f32(&A->Columns[3].x);
+
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            float32x4_t Column = vld1q_f32(&B->Columns[i].x);
+
+            vst1q_f32(&Result->Columns[i].x,
+                      Combine(A0, A1, A2, A3, Column));
+        }
+    }
+
+    static inline
+    void TransformPoints(const mat4 *A,
+                         const vec4 *Points,
+                         vec4 *Result,
+                         unsigned int Count)
+    {
+        float32x4_t A0 = vld1q_f32(&A->Columns[0].x);
+        float32x4_t A1 = vld1q_f32(&A->Columns[1].x);
+        float32x4_t A2 = vld1q_f32(&A->Columns[2].x);
+        float32x4_t A3 = vld1q_f32(&A->Columns[3].x);
+
+        for (unsigned int i = 0; i < Count; i++)
+        {
+            float32x4_t Point = vld1q_f32(&Points[i].x);
+
+            vst1q_f32(&Result[i].x, Combine(A0, A1, A2, A3, Point));
+        }
+    }
+
+    static inline
+    void TransformBatches(const mat4 *A,
+                          const vec4x8 *Batches,
+                          vec4x8 *Result,
+                          unsigned int Count)
+    {
+        const float *M = &A->Columns[0].x;
+
+        for (unsigned int Batch = 0; Batch < Count; Batch++)
+        {
+            const vec4x8 *In = &Batches[Batch];
+            vec4x8 *Out = &Result[Batch];
+
+            for (unsigned int i = 0; i < MATH_BATCH_WIDTH; i += 4)
+            {
+                float32x4_t X = vld1q_f32(&In->x[i]);
+                float32x4_t Y = vld1q_f32(&In->y[i]);
+                float32x4_t Z = vld1q_f32(&In->z[i]);
+                float32x4_t W = vld1q_f32(&In->w[i]);
+
+                float *Outputs[4] = { Out->x, Out->y, Out->z, Out->w };
+
+                for (unsigned int Row = 0; Row < 4; Row++)
+                {
+                    float32x4_t Value = vmulq_n_f32(X, M[Row]);
+                    Value = vmlaq_n_f32(Value, Y, M[4 + Row]);
+                    Value = vmlaq_n_f32(Value, Z, M[8 + Row]);
+                    Value = vmlaq_n_f32(Value, W, M[12 + Row]);
+
+                    vst1q_f32(&Outputs[Row][i], Value);
+                }
+            }
+        }
+    }
+};
+
+#endif
+
+/** What the rest of the engine calls. These go to math_backend, except in
+ * constant expressions, which can only use the scalar code. */
+
+constexpr mat4 operator*(const mat4 &A, const mat4 &B)
+{
+    mat4 Result = {};
+
+    if (std::is_constant_evaluated())
+    {
+        math_kernels<math_scalar>::Multiply(&A, &B, &Result);
+    }
+    else
+    {
+        math_kernels<math_backend>::Multiply(&A, &B, &Result);
+    }
+
+    return Result;
+}
+
+constexpr vec4 operator*(const mat4 &A, vec4 B)
+{
+    return A.Columns[0] * B.x +
+           A.Columns[1] * B.y +
+           A.Columns[2] * B.z +
+           A.Columns[3] * B.w;
+}
+
+/** Result = A * B, without copying the matrices about. Result can't be A
+ * or B. */
+static inline
+void Multiply(const mat4 *A, const mat4 *B, mat4 *Result)
+{
+    math_kernels<math_backend>::Multiply(A, B, Result);
+}
+
+/** The inverse of A, which has to be invertible. */
+constexpr mat4 Inverse(const mat4 &A)
+{
+    mat4 Result = {};
+
+    if (std::is_constant_evaluated())
+    {
+        math_kernels<math_scalar>::Inverse(&A, &Result);
+    }
+    else
+    {
+        math_kernels<math_backend>::Inverse(&A, &Result);
+    }
+
+    return Result;
+}
+
+constexpr vec3 TransformPoint(const mat4 &A, vec3 Point)
+{
+    return Vec3(A * Vec4(Point, 1.0f));
+}
+
+constexpr vec3 TransformDirection(const mat4 &A, vec3 Direction)
+{
+    return Vec3(A * Vec4(Direction, 0.0f));
+}
+
+/** Result[i] = A * Points[i], for Count points. */
+static inline
+void TransformPoints(const mat4 *A,
+                     const vec4 *Points,
+                     vec4 *Result,
+                     unsigned int Count)
+{
+    math_kernels<math_backend>::TransformPoints(A, Points, Result, Count);
+}
+
+/** The same, for Count batches of MATH_BATCH_WIDTH points. */
+static inline
+void TransformPoints(const mat4 *A,
+                     const vec4x8 *Batches,
+                     vec4x8 *Result,
+                     unsigned int Count)
+{
+    math_kernels<math_backend>::TransformBatches(A, Batches, Result, Count);
+}
@@ -0,0 +1,131 @@
+/**
+ * @file linear_math.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for our math library: vectors,
+ * matrices and quaternions, plus vec4x8, which is eight vec4s stored
+ * component by component for working on in bulk.
+ *
+ * Matrices are column major and multiply column vectors, the same as GLSL,
+ * so they can go to a shader as they are.
+ *
+ * The heavy lifting (matrix multiplies, inverses, transforming lots of
+ * points) is done by a backend picked at compile time from what the target
+ * has: AVX2, SSE, NEON, or plain scalar code that every other backend gets
+ * checked against. Everything that can be is constexpr; in constant
+ * expressions it always takes the scalar path.
+ */
+
+#ifndef _LINEAR_MATH_H_
+#define _LINEAR_MATH_H_
+
+#include <type_traits>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#define MATH_HAS_AVX2 1
+#else
+#define MATH_HAS_AVX2 0
+#endif
+
+// NOTE[joe] x64 always has SSE2, which is all the SSE backend needs. It
+// uses SSE4.1 where it's been turned on (MSVC only says so through __AVX__).
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define MATH_HAS_SSE 1
+#else
+#define MATH_HAS_SSE 0
+#endif
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define MATH_HAS_SSE41 1
+#else
+#define MATH_HAS_SSE41 0
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define MATH_HAS_NEON 1
+#else
+#define MATH_HAS_NEON 0
+#endif
+
+#if MATH_HAS_AVX2
+#include <immintrin.h>
+#elif MATH_HAS_SSE41
+#include <smmintrin.h>
+#elif MATH_HAS_SSE
+#include <emmintrin.h>
+#endif
+
+#if MATH_HAS_NEON
+#include <arm_neon.h>
+#endif
+
+#define MATH_PI 3.14159265358979f
+
+typedef struct {
+    float x, y;
+} vec2;
+
+typedef struct {
+    float x, y, z;
+} vec3;
+
+typedef struct alignas(16) {
+    float x, y, z, w;
+} vec4;
+
+/** x, y, z is the axis times sin(angle / 2), w is cos(angle / 2). */
+typedef struct alignas(16) {
+    float x, y, z, w;
+} quat;
+
+typedef struct {
+    vec3 Columns[3];
+} mat3;
+
+typedef struct alignas(16) {
+    vec4 Columns[4];
+} mat4;
+
+#define MATH_BATCH_WIDTH 8
+
+/** Eight vec4s, a component at a time. */
+typedef struct alignas(32) {
+    float x[MATH_BATCH_WIDTH];
+    float y[MATH_BATCH_WIDTH];
+    float z[MATH_BATCH_WIDTH];
+    float w[MATH_BATCH_WIDTH];
+} vec4x8;
+
+/** Backends. Each one's math_kernels specialization in linear_math.cpp is
+ * only there when the target can run it. */
+typedef struct math_scalar {
+    static constexpr const char *Name = "scalar";
+} math_scalar;
+
+typedef struct math_sse {
+    static constexpr const char *Name = "sse";
+} math_sse;
+
+typedef struct math_avx2 {
+    static constexpr const char *Name = "avx2";
+} math_avx2;
+
+typedef struct math_neon {
+    static constexpr const char *Name = "neon";
+} math_neon;
+
+#if MATH_HAS_AVX2
+typedef math_avx2 math_backend;
+#elif MATH_HAS_SSE
+typedef math_sse math_backend;
+#elif MATH_HAS_NEON
+typedef math_neon math_backend;
+#else
+typedef math_scalar math_backend;
+#endif
+
+template <typename backend>
+struct math_kernels;
+
+#endif
@@ -0,0 +1,988 @@
+/**
+ * @file linux_main.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This is our Linux platform layer and entry point. When compiling this game
+ * project on Linux, you want to target this file as your main file.
+ *
+ * Pass --headless to render without a window (through VK_EXT_headless_surface)
+ * and --frames N to quit after N frames. Together they're what the benchmark
+ * boxes run, e.g. with lavapipe. Windowed runs are paced to --fps N (60 by
+ * default); headless runs and --uncapped render as fast as they can.
+ * --particles N sizes the particle pool (0 turns particles off).
+ * --bench-jobs, --bench-ecs, --bench-math, --bench-skin, --bench-anim,
+ * --bench-broadphase, --bench-physics, --bench-occlusion, --bench-barriers,
+ * --bench-budget and --bench-transforms run the job system, ECS, math,
+ * skinning, animation, broadphase, physics, occlusion culling, barrier, memory
+ * budget and transform hierarchy benchmarks instead of the game.
+ */
+
+#include <xcb/xcb.h>
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Include Vulkan headers.
+#define VK_USE_PLATFORM_XCB_KHR
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include "vulkan_ext.h"
+
+// Include engine headers.
+#include "render.h"
+#include "platform.h"
+#include "memory.h"
+
+// NOTE[joe] Our Vulkan setup allocates from arenas, so this comes first.
+#include "memory.cpp"
+
+typedef struct {
+    bool              IsHeadless;
+    xcb_connection_t *Connection;
+    xcb_window_t      Window;
+    xcb_atom_t        DeleteAtom;
+} linux_window;
+
+// Include Linux specific vulkan setup.
+#include "linux_vulkan_helper.cpp"
+
+// Include platform independent game code.
+#include "linear_math.cpp"
+#include "job.cpp"
+#include "job_bench.cpp"
+#include "ecs.cpp"
+#include "ecs_bench.cpp"
+#include "math_bench.cpp"
+#include "io.cpp"
+#include "task.cpp"
+#include "transform.cpp"
+#include "transform_bench.cpp"
+#include "skinning.cpp"
+#include "skin_bench.cpp"
+#include "animation.cpp"
+#include "anim_bench.cpp"
+#include "broadphase.cpp"
+#include "broadphase_bench.cpp"
+#include "physics.cpp"
+#include "physics_bench.cpp"
+#include "occlusion.cpp"
+#include "occlusion_bench.cpp"
+#include "particles.cpp"
+#include "culling.cpp"
+#include "render.cpp"
+#include "barrier_bench.cpp"
+#include "budget_bench.cpp"
+#include "game.cpp"
+
+// NOTE[joe] Temporary globals
+static int ApplicationQuit;
+static vulkan_context Context;
+static game_loop Loop;
+static render_handoff Handoff;
+static job_system Jobs;
+static io_queue IO;
+static game_memory Memory;
+
+#ifdef DEBUG
+static
+void Assert(bool Flag, const char* Message)
+{
+    if (!Flag)
+    {
+        fprintf(stderr, "ASSERT FAILED: %s", Message);
+
+        __builtin_trap();
+    }
+}
+#endif
+
+static
+void Abort(const char* Message)
+{
+    fprintf(stderr, "ABORT: %s", Message);
+
+    abort();
+}
+
+static
+void PlatformLog(const char* Format, ...)
+{
+    va_list Arguments;
+    va_start(Arguments, Format);
+    vfprintf(stderr, Format, Arguments);
+    va_end(Arguments);
+}
+
+static
+unsigned char *PlatformReadEntireFile(const char *FilePath,
+                                      unsigned int *Size)
+{
+    int File = open(FilePath, O_RDONLY);
+
+    if (File < 0)
+    {
+        PlatformLog("Failed to open %s.\n", FilePath);
+        return 0;
+    }
+
+    struct stat Stat;
+    fstat(File, &Stat);
+
+    unsigned char *Data = new unsigned char[Stat.st_size];
+    ssize_t BytesRead = 0;
+
+    while (BytesRead < Stat.st_size)
+    {
+        ssize_t Result = read(File,
+                              Data + BytesRead,
+                              Stat.st_size - BytesRead);
+
+        if (Result < 0 && errno == EINTR)
+            continue;
+
+        if (Result <= 0)
+            break;
+
+        BytesRead += Result;
+    }
+
+    close(File);
+
+    if (BytesRead != Stat.st_size)
+    {
+        PlatformLog("Failed to read %s.\n", FilePath);
+
+        delete[] Data;
+        return 0;
+    }
+
+    *Size = (unsigned int)Stat.st_size;
+
+    return Data;
+}
+
+static
+void *PlatformReserveMemory(size_t Size)
+{
+    // NOTE[joe] MAP_NORESERVE keeps big reservations from counting against
+    // overcommit until we actually commit them.
+    void *Address = mmap(0,
+                         Size,
+                         PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                         -1,
+                         0);
+
+    return Address == MAP_FAILED ? 0 : Address;
+}
+
+static
+bool PlatformCommitMemory(void *Address, size_t Size)
+{
+    return mprotect(Address, Size, PROT_READ | PROT_WRITE) == 0;
+}
+
+static
+void PlatformReleaseMemory(void *Address, size_t Size)
+{
+    munmap(Address, Size);
+}
+
+/** Returns CLOCK_MONOTONIC in seconds. */
+static
+double PlatformGetTime()
+{
+    struct timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+
+    return (double)Time.tv_sec + (double)Time.tv_nsec / 1e9;
+}
+
+/** Sleeps on CLOCK_MONOTONIC until Time. */
+static
+void PlatformSleepUntil(double Time)
+{
+    struct timespec Deadline;
+    Deadline.tv_sec = (time_t)Time;
+    Deadline.tv_nsec = (long)((Time - (double)Deadline.tv_sec) * 1e9);
+
+    if (Deadline.tv_nsec >= 1000000000L)
+    {
+        Deadline.tv_sec++;
+        Deadline.tv_nsec -= 1000000000L;
+    }
+
+    // NOTE[joe] An absolute deadline means a signal waking us early just
+    // sends us back to sleep for whatever's left, rather than the whole lot.
+    while (clock_nanosleep(CLOCK_MONOTONIC,
+                           TIMER_ABSTIME,
+                           &Deadline,
+                           0) == EINTR);
+}
+
+struct platform_thread {
+    pthread_t             Handle;
+    platform_thread_proc *Proc;
+    void                 *Data;
+};
+
+struct platform_semaphore {
+    sem_t Handle;
+};
+
+static
+void *linux_ThreadProc(void *Parameter)
+{
+    platform_thread *Thread = (platform_thread *)Parameter;
+    Thread->Proc(Thread->Data);
+
+    return 0;
+}
+
+static
+platform_thread *PlatformCreateThread(memory_arena *Arena,
+                                      platform_thread_proc *Proc,
+                                      void *Data)
+{
+    platform_thread *Thread = PushStruct(Arena, platform_thread);
+    Thread->Proc = Proc;
+    Thread->Data = Data;
+
+    int Result = pthread_create(&Thread->Handle, 0, linux_ThreadProc, Thread);
+
+    Assert(Result == 0, "Failed to create thread.\n");
+
+    return Thread;
+}
+
+static
+void PlatformJoinThread(platform_thread *Thread)
+{
+    pthread_join(Thread->Handle, 0);
+}
+
+static
+platform_semaphore *PlatformCreateSemaphore(memory_arena *Arena,
+                                            unsigned int Count)
+{
+    platform_semaphore *Semaphore = PushStruct(Arena, platform_semaphore);
+
+    int Result = sem_init(&Semaphore->Handle, 0, Count);
+
+    Assert(Result == 0, "Failed to create semaphore.\n");
+
+    return Semaphore;
+}
+
+static
+void PlatformWaitSemaphore(platform_semaphore *Semaphore)
+{
+    while (sem_wait(&Semaphore->Handle) != 0 && errno == EINTR);
+}
+
+static
+bool PlatformWaitSemaphoreTimeout(platform_semaphore *Semaphore,
+                                  unsigned int Microseconds)
+{
+    // NOTE[joe] sem_timedwait() only takes a realtime deadline.
+    struct timespec Deadline;
+    clock_gettime(CLOCK_REALTIME, &Deadline);
+
+    Deadline.tv_sec += Microseconds / 1000000;
+    Deadline.tv_nsec += (long)(Microseconds % 1000000) * 1000;
+
+    if (Deadline.tv_nsec >= 1000000000L)
+    {
+        Deadline.tv_sec++;
+        Deadline.tv_nsec -= 1000000000L;
+    }
+
+    for (;;)
+    {
+        if (sem_timedwait(&Semaphore->Handle, &Deadline) == 0)
+            return true;
+
+        if (errno != EINTR)
+            return false;
+    }
+}
+
+static
+void PlatformSignalSemaphore(platform_semaphore *Semaphore)
+{
+    sem_post(&Semaphore->Handle);
+}
+
+static
+void PlatformDestroySemaphore(platform_semaphore *Semaphore)
+{
+    sem_destroy(&Semaphore->Handle);
+}
+
+static
+void PlatformYield()
+{
+    sched_yield();
+}
+
+// NOTE[joe] swapcontext() saves and restores the signal mask, which is a
+// system call each way and most of what a switch cost. On x86-64 we switch
+// stacks ourselves instead, saving only what the ABI says a call has to
+// keep: the callee saved registers, the stack pointer, and the MXCSR and x87
+// control words. Everywhere else still goes through ucontext.
+#if defined(__x86_64__)
+
+/** Pushes the calling fiber's registers onto its stack, stores its stack
+ * pointer in *From, and pops To's off of To, returning into whatever To last
+ * switched away from (or linux_FiberStart, the first time). */
+extern "C" void linux_SwitchStack(void **From, void *To);
+
+/** Where a new fiber's first switch returns to. Calls the function in r13
+ * with the pointer in r12, which was put there by PlatformCreateFiber(). */
+extern "C" void linux_FiberStart();
+
+__asm__(
+    ".pushsection .text\n"
+    ".p2align 4\n"
+    ".type linux_SwitchStack, @function\n"
+    "linux_SwitchStack:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size linux_SwitchStack, .-linux_SwitchStack\n"
+    ".p2align 4\n"
+    ".type linux_FiberStart, @function\n"
+    "linux_FiberStart:\n"
+    "    movq %r12, %rdi\n"
+    "    callq *%r13\n"
+    "    ud2\n"
+    ".size linux_FiberStart, .-linux_FiberStart\n"
+    ".popsection\n");
+
+// NOTE[joe] What linux_SwitchStack() leaves on a stack, from the stack
+// pointer up.
+typedef struct {
+    unsigned int       Mxcsr;
+    unsigned int       FpuControl;
+    unsigned long long R15;
+    unsigned long long R14;
+    unsigned long long R13;
+    unsigned long long R12;
+    unsigned long long Rbx;
+    unsigned long long Rbp;
+    void              *Return;
+} linux_fiber_frame;
+
+static_assert(sizeof(linux_fiber_frame) == 64,
+              "linux_fiber_frame doesn't match linux_SwitchStack");
+
+// NOTE[joe] The values every thread starts with: all exceptions masked,
+// round to nearest, and double extended precision for the x87.
+#define LINUX_DEFAULT_MXCSR 0x1F80
+#define LINUX_DEFAULT_FPU_CONTROL 0x037F
+
+#endif
+
+struct platform_fiber {
+#if defined(__x86_64__)
+    // NOTE[joe] Everything else is saved on the stack itself.
+    void                 *Stack;
+#else
+    ucontext_t            Context;
+#endif
+    void                 *Memory;
+    size_t                MemorySize;
+    platform_thread_proc *Proc;
+    void                 *Data;
+};
+
+#if defined(__x86_64__)
+
+static
+void linux_FiberProc(platform_fiber *Fiber)
+{
+    Fiber->Proc(Fiber->Data);
+}
+
+#else
+
+static
+void linux_FiberProc(unsigned int High, unsigned int Low)
+{
+    // NOTE[joe] makecontext() only passes ints, so the pointer comes in
+    // halves.
+    platform_fiber *Fiber = (platform_fiber *)
+        (((unsigned long long)High << 32) | (unsigned long long)Low);
+
+    Fiber->Proc(Fiber->Data);
+}
+
+#endif
+
+static
+platform_fiber *PlatformConvertThreadToFiber(memory_arena *Arena)
+{
+    // NOTE[joe] Context gets filled in the first time we switch away.
+    platform_fiber *Fiber = PushStruct(Arena, platform_fiber);
+    Fiber->Memory = 0;
+    Fiber->MemorySize = 0;
+    Fiber->Proc = 0;
+    Fiber->Data = 0;
+
+    return Fiber;
+}
+
+static
+void PlatformConvertFiberToThread(platform_fiber *Fiber)
+{
+    // NOTE[joe] There's nothing to undo; the thread's fiber goes with its
+    // arena.
+}
+
+static
+platform_fiber *PlatformCreateFiber(memory_arena *Arena,
+                                    unsigned int StackSize,
+                                    platform_thread_proc *Proc,
+                                    void *Data)
+{
+    size_t PageSize = sysconf(_SC_PAGESIZE);
+    StackSize = (StackSize + PageSize - 1) & ~(PageSize - 1);
+
+    platform_fiber *Fiber = PushStruct(Arena, platform_fiber);
+    Fiber->Proc = Proc;
+    Fiber->Data = Data;
+
+    // NOTE[joe] Stacks grow down, so the guard page goes at the bottom. Only
+    // the pages actually touched ever get backed by memory.
+    Fiber->MemorySize = StackSize + PageSize;
+    Fiber->Memory = mmap(0,
+                         Fiber->MemorySize,
+                         PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS,
+                         -1,
+                         0);
+
+    Assert(Fiber->Memory != MAP_FAILED, "Failed to map fiber stack.\n");
+
+    mprotect(Fiber->Memory, PageSize, PROT_NONE);
+
+#if defined(__x86_64__)
+    // NOTE[joe] Made to look like the fiber switched away just before
+    // linux_FiberStart(). Its return address sits 8 below the (16 byte
+    // aligned) top, so the stack is aligned again when it calls the proc.
+    char *Top = (char *)Fiber->Memory + Fiber->MemorySize;
+    linux_fiber_frame *Frame =
+        (linux_fiber_frame *)(Top - sizeof(linux_fiber_frame));
+    *Frame = {};
+    Frame->Mxcsr = LINUX_DEFAULT_MXCSR;
+    Frame->FpuControl = LINUX_DEFAULT_FPU_CONTROL;
+    Frame->R13 = (unsigned long long)linux_FiberProc;
+    Frame->R12 = (unsigned long long)Fiber;
+    Frame->Return = (void *)linux_FiberStart;
+
+    Fiber->Stack = Frame;
+#else
+    getcontext(&Fiber->Context);
+    Fiber->Context.uc_stack.ss_sp = (char *)Fiber->Memory + PageSize;
+    Fiber->Context.uc_stack.ss_size = StackSize;
+    Fiber->Context.uc_link = 0;
+
+    unsigned long long Pointer = (unsigned long long)Fiber;
+    makecontext(&Fiber->Context,
+                (void (*)())linux_FiberProc,
+                2,
+                (unsigned int)(Pointer >> 32),
+                (unsigned int)Pointer);
+#endif
+
+    return Fiber;
+}
+
+static
+void PlatformDestroyFiber(platform_fiber *Fiber)
+{
+    munmap(Fiber->Memory, Fiber->MemorySize);
+}
+
+static
+void PlatformSwitchToFiber(platform_fiber *From, platform_fiber *To)
+{
+#if defined(__x86_64__)
+    linux_SwitchStack(&From->Stack, To->Stack);
+#else
+    swapcontext(&From->Context, &To->Context);
+#endif
+}
+
+static
+unsigned int PlatformGetCoreCount()
+{
+    // NOTE[joe] Hyper-threads share a "physical id" and "core id" pair in
+    // /proc/cpuinfo, so count the distinct pairs.
+    unsigned int Cores[256];
+    unsigned int CoreCount = 0;
+
+    FILE *CpuInfo = fopen("/proc/cpuinfo", "r");
+
+    if (CpuInfo)
+    {
+        char Line[256];
+        unsigned int PhysicalId = 0;
+
+        while (fgets(Line, sizeof(Line), CpuInfo))
+        {
+            unsigned int CoreId;
+
+            if (sscanf(Line, "physical id : %u", &PhysicalId) == 1)
+                continue;
+
+            if (sscanf(Line, "core id : %u", &CoreId) == 1)
+            {
+                unsigned int Core = (PhysicalId << 16) | CoreId;
+                bool IsNew = true;
+
+                for (unsigned int i = 0; i < CoreCount; i++)
+                {
+                    if (Cores[i] == Core)
+                    {
+                        IsNew = false;
+                        break;
+                    }
+                }
+
+                if (IsNew && CoreCount < 256)
+                {
+                    Cores[CoreCount++] = Core;
+                }
+            }
+        }
+
+        fclose(CpuInfo);
+    }
+
+    if (CoreCount == 0)
+    {
+        long Processors = sysconf(_SC_NPROCESSORS_ONLN);
+        CoreCount = Processors > 0 ? (unsigned int)Processors : 1;
+    }
+
+    return CoreCount;
+}
+
+/** Connects to the X server and opens a Width by Height window. Returns
+ * false if there's no X server to connect to. */
+static
+bool linux_CreateWindow(linux_window *Window,
+                        unsigned int Width,
+                        unsigned int Height)
+{
+    Window->Connection = xcb_connect(0, 0);
+
+    if (xcb_connection_has_error(Window->Connection))
+        return false;
+
+    xcb_screen_t *Screen =
+        xcb_setup_roots_iterator(xcb_get_setup(Window->Connection)).data;
+
+    Window->Window = xcb_generate_id(Window->Connection);
+
+    unsigned int EventMask = XCB_EVENT_MASK_EXPOSURE |
+                             XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+
+    xcb_create_window(Window->Connection,
+                      XCB_COPY_FROM_PARENT,
+                      Window->Window,
+                      Screen->root,
+                      0, 0,
+                      Width, Height,
+                      0,
+                      XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      Screen->root_visual,
+                      XCB_CW_EVENT_MASK,
+                      &EventMask);
+
+    const char *Title = "Full Metal Jacket";
+    xcb_change_property(Window->Connection,
+                        XCB_PROP_MODE_REPLACE,
+                        Window->Window,
+                        XCB_ATOM_WM_NAME,
+                        XCB_ATOM_STRING,
+                        8,
+                        strlen(Title),
+                        Title);
+
+    /** Ask the window manager to tell us when the window is closed, rather
+     * than just killing our connection. */
+
+    xcb_intern_atom_cookie_t ProtocolsCookie =
+        xcb_intern_atom(Window->Connection, 1, 12, "WM_PROTOCOLS");
+    xcb_intern_atom_cookie_t DeleteCookie =
+        xcb_intern_atom(Window->Connection, 0, 16, "WM_DELETE_WINDOW");
+
+    xcb_intern_atom_reply_t *ProtocolsReply =
+        xcb_intern_atom_reply(Window->Connection, ProtocolsCookie, 0);
+    xcb_intern_atom_reply_t *DeleteReply =
+        xcb_intern_atom_reply(Window->Connection, DeleteCookie, 0);
+
+    Window->DeleteAtom = DeleteReply->atom;
+
+    xcb_change_property(Window->Connection,
+                        XCB_PROP_MODE_REPLACE,
+                        Window->Window,
+                        ProtocolsReply->atom,
+                        XCB_ATOM_ATOM,
+                        32,
+                        1,
+                        &Window->DeleteAtom);
+
+    free(ProtocolsReply);
+    free(DeleteReply);
+
+    xcb_map_window(Window->Connection, Window->Window);
+    xcb_flush(Window->Connection);
+
+    return true;
+}
+
+/** Handles every pending X event. */
+static
+void linux_ProcessEvents(linux_window *Window)
+{
+    xcb_generic_event_t *Event;
+
+    while ((Event = xcb_poll_for_event(Window->Connection)))
+    {
+        switch (Event->response_type & ~0x80)
+        {
+            case XCB_CLIENT_MESSAGE:
+            {
+                xcb_client_message_event_t *Message =
+                    (xcb_client_message_event_t *)Event;
+
+                if (Message->data.data32[0] == Window->DeleteAtom)
+                {
+                    ApplicationQuit = 1;
+                }
+            } break;
+
+            default: break;
+        }
+
+        free(Event);
+    }
+
+    if (xcb_connection_has_error(Window->Connection))
+    {
+        ApplicationQuit = 1;
+    }
+}
+
+/** Linux's entry point into our game. */
+int main(int ArgumentCount, char **Arguments)
+{
+    linux_window Window = {};
+    unsigned int FrameLimit = 0;
+    unsigned int FrameRate = 0;
+    unsigned int ParticleCount = PARTICLE_DEFAULT_COUNT;
+    bool IsUncapped = false;
+
+    for (int i = 1; i < ArgumentCount; i++)
+    {
+        if (strcmp(Arguments[i], "--headless") == 0)
+        {
+            Window.IsHeadless = true;
+        }
+        else if (strcmp(Arguments[i], "--frames") == 0 &&
+                 i + 1 < ArgumentCount)
+        {
+            FrameLimit = atoi(Arguments[++i]);
+        }
+        else if (strcmp(Arguments[i], "--fps") == 0 &&
+                 i + 1 < ArgumentCount)
+        {
+            FrameRate = atoi(Arguments[++i]);
+        }
+        else if (strcmp(Arguments[i], "--particles") == 0 &&
+                 i + 1 < ArgumentCount)
+        {
+            ParticleCount = (unsigned int)strtoul(Arguments[++i], 0, 10);
+        }
+        else if (strcmp(Arguments[i], "--uncapped") == 0)
+        {
+            IsUncapped = true;
+        }
+        else if (strcmp(Arguments[i], "--bench-jobs") == 0)
+        {
+            BenchmarkJobSystem();
+            return 0;
+        }
+        else if (strcmp(Arguments[i], "--bench-ecs") == 0)
+        {
+            return BenchmarkEcs() ? 0 : 1;
+        }
+        else if (strcmp(Arguments[i], "--bench-math") == 0)
+        {
+            return BenchmarkMath() ? 0 : 1;
+        }
+        else if (strcmp(Arguments[i], "--bench-skin") == 0)
+        {
+            return BenchmarkSkinning() ? 0 : 1;
+        }
+        else if (strcmp(Arguments[i], "--bench-anim") == 0)
+        {
+            return BenchmarkAnimation() ? 0 : 1;
+        }
+        else if (strcmp(Arguments[i], "--bench-broadphase") == 0)
+        {
+            return BenchmarkBroadphase() ? 0 : 1;
+        }
+        else if (strcmp(Arguments[i], "--bench-physics") == 0)
+        {
+            return BenchmarkPhysics() ? 0 : 1;
+        }
+        else if (strcmp(Arguments[i], "--bench-occlusion") == 0)
+        {
+            return BenchmarkOcclusion() ? 0 : 1;
+        }
+        else if (strcmp(Arguments[i], "--bench-barriers") == 0)
+        {
+            return BenchmarkBarriers() ? 0 : 1;
+        }
+        else if (strcmp(Arguments[i], "--bench-budget") == 0)
+        {
+            return BenchmarkBudget() ? 0 : 1;
+        }
+        else if (strcmp(Arguments[i], "--bench-transforms") == 0)
+        {
+            return BenchmarkTransforms() ? 0 : 1;
+        }
+        else
+        {
+            fprintf(stderr,
+                    "Usage: %s [--headless] [--frames N] [--fps N] "
+                    "[--uncapped] [--particles N] [--bench-jobs] "
+                    "[--bench-ecs] [--bench-math] [--bench-skin] "
+                    "[--bench-anim] [--bench-broadphase] "
+                    "[--bench-physics] [--bench-occlusion] "
+                    "[--bench-barriers] [--bench-budget] "
+                    "[--bench-transforms]\n",
+                    Arguments[0]);
+            return 1;
+        }
+    }
+
+    // NOTE[joe] A headless run with no frame limit would never end.
+    if (Window.IsHeadless && FrameLimit == 0)
+    {
+        FrameLimit = 1000;
+    }
+
+    // NOTE[joe] Benchmarks measure how fast we can go, so headless runs
+    // aren't paced unless asked to be with --fps.
+    if (IsUncapped)
+    {
+        FrameRate = 0;
+    }
+    else if (FrameRate == 0 && !Window.IsHeadless)
+    {
+        FrameRate = GAME_DEFAULT_FRAME_RATE;
+    }
+
+    if (ParticleCount > PARTICLE_MAX_COUNT)
+    {
+        ParticleCount = PARTICLE_MAX_COUNT;
+    }
+
+    // TODO[joe] Pick this up from the command line too?
+    Context.Width = 1280;
+    Context.Height = 720;
+
+    if (!Window.IsHeadless &&
+        !linux_CreateWindow(&Window, Context.Width, Context.Height))
+    {
+        Abort("Could not connect to the X server. Try --headless.\n");
+    }
+
+    double StartupBegin = PlatformGetTime();
+
+    InitializeGameMemory(&Memory);
+
+    linux_LoadVulkan();
+    linux_InitializeVulkanContext(&Context, &Memory, &Window);
+
+    // NOTE[joe] This thread is one of the workers.
+    InitializeJobSystem(&Jobs, 0);
+    InitializeIoQueue(&IO, &Jobs, &Memory.Permanent);
+
+    GameInitialize(&Context, &Jobs, &IO, &Memory.Permanent, ParticleCount);
+
+    double StartupEnd = PlatformGetTime();
+
+    /** Render until we're closed or hit the frame limit. */
+
+    unsigned int FrameCount = 0;
+    double FrameTimeMin = 1e9;
+    double FrameTimeMax = 0;
+
+    InitializeGameLoop(&Loop,
+                       &Memory.Level,
+                       &Memory.Frame,
+                       FrameRate,
+                       ParticleCount);
+
+    // NOTE[joe] This thread keeps the window and the simulation; all Vulkan
+    // work from here on happens on the render thread. Frame times below are
+    // measured here, so once both threads are busy they're the time between
+    // packets handed over, i.e. the pipeline's throughput.
+    StartRenderThread(&Context, &Handoff, &Jobs, &Memory.Permanent);
+
+    double FrameBegin = PlatformGetTime();
+    double RunBegin = FrameBegin;
+
+    while (!ApplicationQuit)
+    {
+        if (!Window.IsHeadless)
+        {
+            linux_ProcessEvents(&Window);
+        }
+
+        // NOTE[joe] Frame scratch only lives until the end of the frame
+        // that pushed it.
+        ResetArena(&Memory.Frame);
+
+        render_packet *Packet = BeginGamePacket(&Handoff);
+        GameAdvance(&Loop, &Jobs, Packet);
+        EndGamePacket(&Handoff);
+
+        GameWaitForNextFrame(&Loop);
+
+        double FrameEnd = PlatformGetTime();
+        double FrameTime = FrameEnd - FrameBegin;
+        FrameBegin = FrameEnd;
+
+        if (FrameTime < FrameTimeMin) FrameTimeMin = FrameTime;
+        if (FrameTime > FrameTimeMax) FrameTimeMax = FrameTime;
+
+        if (++FrameCount == FrameLimit)
+        {
+            ApplicationQuit = 1;
+        }
+    }
+
+    // NOTE[joe] The last packet or two are still with the renderer, and
+    // count towards the run.
+    StopRenderThread(&Handoff);
+    ShutdownIoQueue(&IO);
+    ShutdownJobSystem(&Jobs);
+    ReleaseGameMemory(&Memory);
+
+    /** Report how long things took, for the benchmark scripts. */
+
+    double RunTime = PlatformGetTime() - RunBegin;
+
+    printf("startup_ms %.3f\n", (StartupEnd - StartupBegin) * 1000.0);
+    printf("frames %u\n", FrameCount);
+    printf("particles_max %u\n", ParticleCount);
+    printf("occlusion_culled_draws %llu\n", Loop.CulledDrawCount);
+
+    if (FrameCount)
+    {
+        printf("frame_ms_avg %.3f\n", RunTime * 1000.0 / FrameCount);
+        printf("frame_ms_min %.3f\n", FrameTimeMin * 1000.0);
+        printf("frame_ms_max %.3f\n", FrameTimeMax * 1000.0);
+    }
+
+    // NOTE[joe] Driver allocations per frame should be zero once we're
+    // running. Anything else is churn to go and get rid of.
+    host_allocator *HostAllocator = &Context.HostAllocator;
+
+    if (HostAllocator->FrameCount > 1)
+    {
+        printf("host_allocs_per_frame %.2f\n",
+               (double)HostAllocator->FrameAllocationTotal /
+               (double)(HostAllocator->FrameCount - 1));
+        printf("host_allocs_frame_max %lld\n",
+               HostAllocator->MaxFrameAllocations);
+    }
+
+    printf("host_kb %lld\n", HostAllocator->Total.LiveBytes.load() / 1024);
+    printf("host_kb_peak %lld\n",
+           HostAllocator->Total.PeakBytes.load() / 1024);
+
+    memory_budget *Budget = &Context.Memory.Budget;
+
+    for (unsigned int i = 0; i < Context.MemoryProperties.memoryHeapCount; i++)
+    {
+        printf("heap_%u_kb %llu\n",
+               i,
+               (unsigned long long)(Budget->HeapUsage[i] / 1024));
+        printf("heap_%u_budget_kb %llu\n",
+               i,
+               (unsigned long long)(Budget->HeapBudget[i] / 1024));
+    }
+
+    printf("heap_evictions %u\n", Budget->EvictionCount);
+
+    // NOTE[joe] The last frame's barriers, for comparing runs. What they
+    // should be is checked by --bench-barriers, not here.
+    resource_barrier_stats *Barriers = &Context.Resources.Stats;
+
+    printf("barrier_flushes %u\n", Barriers->FlushCount);
+    printf("barrier_images %u\n", Barriers->ImageBarrierCount);
+    printf("barrier_memory %u\n", Barriers->MemoryBarrierCount);
+
+    // NOTE[joe] Per frame, counted by the GPU.
+    cull_system *Culling = &Context.Culling;
+
+    if (Culling->FrameCount)
+    {
+        double CullFrames = (double)Culling->FrameCount;
+
+        printf("hzb_tested_avg %.2f\n", Culling->TestedCount / CullFrames);
+        printf("hzb_first_pass_avg %.2f\n",
+               Culling->FirstPassCount / CullFrames);
+        printf("hzb_second_pass_avg %.2f\n",
+               Culling->SecondPassCount / CullFrames);
+        printf("hzb_culled_avg %.2f\n", Culling->CulledCount / CullFrames);
+    }
+
+    if (!Window.IsHeadless)
+    {
+        xcb_disconnect(Window.Connection);
+    }
+
+    return 0;
+}
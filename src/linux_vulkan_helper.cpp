@@ -0,0 +1,132 @@
+/**
+ * @file linux_vulkan_helper.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains and performs the Linux side of our Vulkan setup: loading
+ * libvulkan.so.1 and creating either an XCB or a headless surface. Everything
+ * that doesn't care about the platform lives in vulkan_setup.cpp.
+ */
+
+#include "platform.h"
+#include "render.h"
+#include "memory.h"
+
+// Declare handles to Vulkan functions that we will load later.
+#include "vulkan_dispatch.h"
+
+// Vulkan Linux surface extension functions.
+static PFN_vkCreateXcbSurfaceKHR vkCreateXcbSurfaceKHR;
+static PFN_vkCreateHeadlessSurfaceEXT vkCreateHeadlessSurfaceEXT;
+
+// NOTE[joe] Engine Vulkan modules call through the handles above, so they have
+// to be pulled in after them.
+#include "vulkan_dispatch.cpp"
+#include "vulkan_allocator.cpp"
+#include "vulkan_barrier.cpp"
+#include "vulkan_memory.cpp"
+#include "vulkan_upload.cpp"
+#include "vulkan_attachment.cpp"
+#include "vulkan_pipeline.cpp"
+#include "vulkan_setup.cpp"
+
+/** Loads libvulkan and retrieves the functions we need from it. */
+static
+void linux_LoadVulkan()
+{
+    void *Vulkan = dlopen("libvulkan.so.1", RTLD_NOW | RTLD_LOCAL);
+
+    if (Vulkan)
+    {
+        // NOTE[joe] This is the only function we take from the library
+        // directly. Everything else is loaded through it, see
+        // vulkan_dispatch.cpp.
+        vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)
+            dlsym(Vulkan, "vkGetInstanceProcAddr");
+
+        Assert(vkGetInstanceProcAddr != 0,
+               "libvulkan.so.1 has no vkGetInstanceProcAddr.\n");
+
+        unsigned int Missing = LoadVulkanGlobalFunctions();
+
+        Assert(Missing == 0, "Missing global Vulkan functions.\n");
+    }
+    else
+    {
+#ifdef DEBUG
+        PlatformLog("%s\n", dlerror());
+        Assert(false, "Could not find libvulkan.so.1.\n");
+#else
+        Abort("Could not load Vulkan!\n");
+#endif
+    }
+}
+
+/** Initializes Vulkan against Window's XCB connection, or against a headless
+ * surface if Window->IsHeadless is set. */
+static
+void linux_InitializeVulkanContext(vulkan_context *Context,
+                                   game_memory *Memory,
+                                   linux_window *Window)
+{
+    if (Window->IsHeadless)
+    {
+        CreateVulkanInstance(Context,
+                             Memory,
+                             VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+
+        vkCreateHeadlessSurfaceEXT = (PFN_vkCreateHeadlessSurfaceEXT)
+            vkGetInstanceProcAddr(Context->Instance,
+                                  "vkCreateHeadlessSurfaceEXT");
+
+        Assert(vkCreateHeadlessSurfaceEXT != 0,
+               "Missing Vulkan function vkCreateHeadlessSurfaceEXT.\n");
+
+        /** Create rendering surface. */
+
+        // NOTE[joe] Headless surfaces have no size of their own, so the
+        // swapchain falls back on Context->Width and Context->Height.
+        VkHeadlessSurfaceCreateInfoEXT SurfaceCreateInfo = {};
+        SurfaceCreateInfo.sType =
+            VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+
+        const VkAllocationCallbacks *Allocator =
+            GetHostAllocator(Context, HOST_TAG_INSTANCE);
+
+        VkResult Result = vkCreateHeadlessSurfaceEXT(Context->Instance,
+                                                     &SurfaceCreateInfo,
+                                                     Allocator,
+                                                     &Context->Surface);
+
+        Assert(Result == VK_SUCCESS, "Failed to create headless surface.\n");
+    }
+    else
+    {
+        CreateVulkanInstance(Context, Memory, "VK_KHR_xcb_surface");
+
+        vkCreateXcbSurfaceKHR = (PFN_vkCreateXcbSurfaceKHR)
+            vkGetInstanceProcAddr(Context->Instance, "vkCreateXcbSurfaceKHR");
+
+        Assert(vkCreateXcbSurfaceKHR != 0,
+               "Missing Vulkan function vkCreateXcbSurfaceKHR.\n");
+
+        /** Create rendering surface. */
+
+        VkXcbSurfaceCreateInfoKHR SurfaceCreateInfo = {};
+        SurfaceCreateInfo.sType = VK_STRUCTURE_TYPE_XCB_SURFACE_CREATE_INFO_KHR;
+        SurfaceCreateInfo.connection = Window->Connection;
+        SurfaceCreateInfo.window = Window->Window;
+
+        const VkAllocationCallbacks *Allocator =
+            GetHostAllocator(Context, HOST_TAG_INSTANCE);
+
+        VkResult Result = vkCreateXcbSurfaceKHR(Context->Instance,
+                                                &SurfaceCreateInfo,
+                                                Allocator,
+                                                &Context->Surface);
+
+        Assert(Result == VK_SUCCESS, "Failed to create surface.\n");
+    }
+
+    InitializeVulkanDevice(Context, Memory);
+}
@@ -0,0 +1,484 @@
+/**
+ * @file math_bench.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains accuracy checks and benchmarks for the math library.
+ * Every backend the target can run is checked against the same math done
+ * in doubles, then timed multiplying matrices, inverting them, and
+ * transforming points. Platform layers run them with --bench-math, instead
+ * of the game, and exit with an error if any backend is out of tolerance.
+ * Results go to stdout as "name value" lines, like the frame stats.
+ */
+
+#include "platform.h"
+#include "linear_math.h"
+
+#define MATH_BENCH_MATRICES 4096
+#define MATH_BENCH_POINTS (1 << 16)
+#define MATH_BENCH_RUNS 16
+
+// NOTE[joe] Largest error allowed, relative to the size of the value (or
+// absolute, below one). Inverting the projections loses more to rounding.
+#define MATH_BENCH_TOLERANCE 1e-5
+#define MATH_BENCH_INVERSE_TOLERANCE 1e-3
+
+// NOTE[joe] The constexpr paths, checked at compile time.
+constexpr mat4 MathBenchConstant =
+    Mat4Translation({ 1.0f, 2.0f, 3.0f }) * Mat4Scale({ 2.0f, 2.0f, 2.0f });
+constexpr mat4 MathBenchConstantInverse = Inverse(MathBenchConstant);
+
+static_assert(MathBenchConstant.Columns[0].x == 2.0f &&
+              MathBenchConstant.Columns[3].z == 3.0f,
+              "constexpr matrix multiply is wrong");
+static_assert(MathBenchConstantInverse.Columns[0].x == 0.5f &&
+              MathBenchConstantInverse.Columns[3].x == -0.5f,
+              "constexpr matrix inverse is wrong");
+
+/** The same layout as mat4, in doubles. */
+typedef struct {
+    double Columns[4][4];
+} math_reference;
+
+typedef struct {
+    mat4         *A;
+    mat4         *B;
+    mat4         *Products;
+    mat4         *Inverses;
+    vec4         *Points;
+    vec4         *Transformed;
+    vec4x8       *Batches;
+    vec4x8       *TransformedBatches;
+    unsigned int  Random;
+} math_bench_data;
+
+static
+float MathBenchRandom(math_bench_data *Data, float Low, float High)
+{
+    Data->Random ^= Data->Random << 13;
+    Data->Random ^= Data->Random >> 17;
+    Data->Random ^= Data->Random << 5;
+
+    return Low + (High - Low) * (float)(Data->Random & 0xFFFFFF) / 16777216.0f;
+}
+
+/** Something like what we'd really have: a scale, rotation and translation,
+ * every other one through a camera's view and projection. */
+static
+mat4 MathBenchMatrix(math_bench_data *Data, unsigned int Index)
+{
+    vec3 Axis = {
+        MathBenchRandom(Data, -1.0f, 1.0f),
+        MathBenchRandom(Data, -1.0f, 1.0f),
+        MathBenchRandom(Data, 0.1f, 1.0f)
+    };
+
+    quat Rotation = QuatFromAxisAngle(Normalize(Axis),
+                                      MathBenchRandom(Data, -MATH_PI, MATH_PI));
+
+    vec3 Translation = {
+        MathBenchRandom(Data, -10.0f, 10.0f),
+        MathBenchRandom(Data, -10.0f, 10.0f),
+        MathBenchRandom(Data, -10.0f, 10.0f)
+    };
+
+    vec3 Scale = {
+        MathBenchRandom(Data, 0.5f, 2.0f),
+        MathBenchRandom(Data, 0.5f, 2.0f),
+        MathBenchRandom(Data, 0.5f, 2.0f)
+    };
+
+    mat4 Model = Mat4FromTransform(Translation, Rotation, Scale);
+
+    if (Index & 1)
+    {
+        mat4 View = LookAt({ 0.0f, 5.0f, 20.0f },
+                           { 0.0f, 0.0f, 0.0f },
+                           { 0.0f, 1.0f, 0.0f });
+        mat4 Projection = Perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+        return Projection * View * Model;
+    }
+
+    return Model;
+}
+
+static
+math_reference ToReference(const mat4 *A)
+{
+    math_reference Result;
+
+    for (unsigned int Column = 0; Column < 4; Column++)
+    {
+        Result.Columns[Column][0] = A->Columns[Column].x;
+        Result.Columns[Column][1] = A->Columns[Column].y;
+        Result.Columns[Column][2] = A->Columns[Column].z;
+        Result.Columns[Column][3] = A->Columns[Column].w;
+    }
+
+    return Result;
+}
+
+static
+math_reference MultiplyReference(const math_reference *A,
+                                 const math_reference *B)
+{
+    math_reference Result;
+
+    for (unsigned int Column = 0; Column < 4; Column++)
+    {
+        for (unsigned int Row = 0; Row < 4; Row++)
+        {
+            double Sum = 0.0;
+
+            for (unsigned int k = 0; k < 4; k++)
+            {
+                Sum += A->Columns[k][Row] * B->Columns[Column][k];
+            }
+
+            Result.Columns[Column][Row] = Sum;
+        }
+    }
+
+    return Result;
+}
+
+/** Gauss-Jordan elimination with partial pivoting. */
+static
+math_reference InverseReference(const math_reference *A)
+{
+    double Rows[4][8];
+
+    for (unsigned int Row = 0; Row < 4; Row++)
+    {
+        for (unsigned int Column = 0; Column < 4; Column++)
+        {
+            Rows[Row][Column] = A->Columns[Column][Row];
+            Rows[Row][4 + Column] = Row == Column ? 1.0 : 0.0;
+        }
+    }
+
+    for (unsigned int Pivot = 0; Pivot < 4; Pivot++)
+    {
+        unsigned int Best = Pivot;
+
+        for (unsigned int Row = Pivot + 1; Row < 4; Row++)
+        {
+            if (fabs(Rows[Row][Pivot]) > fabs(Rows[Best][Pivot]))
+            {
+                Best = Row;
+            }
+        }
+
+        for (unsigned int Column = 0; Column < 8; Column++)
+        {
+            double Swap = Rows[Pivot][Column];
+            Rows[Pivot][Column] = Rows[Best][Column];
+            Rows[Best][Column] = Swap;
+        }
+
+        double Scale = 1.0 / Rows[Pivot][Pivot];
+
+        for (unsigned int Column = 0; Column < 8; Column++)
+        {
+            Rows[Pivot][Column] *= Scale;
+        }
+
+        for (unsigned int Row = 0; Row < 4; Row++)
+        {
+            if (Row != Pivot)
+            {
+                double Factor = Rows[Row][Pivot];
+
+                for (unsigned int Column = 0; Column < 8; Column++)
+                {
+                    Rows[Row][Column] -= Factor * Rows[Pivot][Column];
+                }
+            }
+        }
+    }
+
+    math_reference Result;
+
+    for (unsigned int Row = 0; Row < 4; Row++)
+    {
+        for (unsigned int Column = 0; Column < 4; Column++)
+        {
+            Result.Columns[Column][Row] = Rows[Row][4 + Column];
+        }
+    }
+
+    return Result;
+}
+
+static
+double MathError(float Value, double Reference)
+{
+    double Scale = fabs(Reference) > 1.0 ? fabs(Reference) : 1.0;
+
+    return fabs((double)Value - Reference) / Scale;
+}
+
+static
+double MatrixError(const mat4 *A, const math_reference *Reference)
+{
+    double Worst = 0.0;
+
+    for (unsigned int Column = 0; Column < 4; Column++)
+    {
+        const float *Values = &A->Columns[Column].x;
+
+        for (unsigned int Row = 0; Row < 4; Row++)
+        {
+            double Error = MathError(Values[Row],
+                                     Reference->Columns[Column][Row]);
+
+            if (Error > Worst)
+            {
+                Worst = Error;
+            }
+        }
+    }
+
+    return Worst;
+}
+
+static
+double PointError(float X, float Y, float Z, float W,
+                  const math_reference *A,
+                  const vec4 *Point)
+{
+    double In[4] = { Point->x, Point->y, Point->z, Point->w };
+    float Out[4] = { X, Y, Z, W };
+    double Worst = 0.0;
+
+    for (unsigned int Row = 0; Row < 4; Row++)
+    {
+        double Sum = 0.0;
+
+        for (unsigned int k = 0; k < 4; k++)
+        {
+            Sum += A->Columns[k][Row] * In[k];
+        }
+
+        double Error = MathError(Out[Row], Sum);
+
+        if (Error > Worst)
+        {
+            Worst = Error;
+        }
+    }
+
+    return Worst;
+}
+
+/** Checks backend's results against doubles, prints how far off they were
+ * and how fast they came. Returns false if anything's out of tolerance. */
+template <typename backend>
+static
+bool BenchmarkMathBackend(math_bench_data *Data)
+{
+    typedef math_kernels<backend> kernels;
+
+    const char *Name = backend::Name;
+
+    /** Accuracy. */
+
+    for (unsigned int i = 0; i < MATH_BENCH_MATRICES; i++)
+    {
+        kernels::Multiply(&Data->A[i], &Data->B[i], &Data->Products[i]);
+        kernels::Inverse(&Data->A[i], &Data->Inverses[i]);
+    }
+
+    kernels::TransformPoints(&Data->A[0],
+                             Data->Points,
+                             Data->Transformed,
+                             MATH_BENCH_POINTS);
+    kernels::TransformBatches(&Data->A[0],
+                              Data->Batches,
+                              Data->TransformedBatches,
+                              MATH_BENCH_POINTS / MATH_BATCH_WIDTH);
+
+    double MultiplyError = 0.0;
+    double InverseError = 0.0;
+
+    for (unsigned int i = 0; i < MATH_BENCH_MATRICES; i++)
+    {
+        math_reference A = ToReference(&Data->A[i]);
+        math_reference B = ToReference(&Data->B[i]);
+
+        math_reference Product = MultiplyReference(&A, &B);
+        math_reference Inverse = InverseReference(&A);
+
+        double Error = MatrixError(&Data->Products[i], &Product);
+        MultiplyError = Error > MultiplyError ? Error : MultiplyError;
+
+        Error = MatrixError(&Data->Inverses[i], &Inverse);
+        InverseError = Error > InverseError ? Error : InverseError;
+    }
+
+    math_reference Transform = ToReference(&Data->A[0]);
+    double PointsError = 0.0;
+
+    for (unsigned int i = 0; i < MATH_BENCH_POINTS; i++)
+    {
+        const vec4 *Out = &Data->Transformed[i];
+        const vec4x8 *Batch = &Data->TransformedBatches[i / MATH_BATCH_WIDTH];
+        unsigned int Lane = i % MATH_BATCH_WIDTH;
+
+        double Error = PointError(Out->x, Out->y, Out->z, Out->w,
+                                  &Transform,
+                                  &Data->Points[i]);
+        PointsError = Error > PointsError ? Error : PointsError;
+
+        Error = PointError(Batch->x[Lane],
+                           Batch->y[Lane],
+                           Batch->z[Lane],
+                           Batch->w[Lane],
+                           &Transform,
+                           &Data->Points[i]);
+        PointsError = Error > PointsError ? Error : PointsError;
+    }
+
+    printf("math_%s_multiply_error %.3g\n", Name, MultiplyError);
+    printf("math_%s_inverse_error %.3g\n", Name, InverseError);
+    printf("math_%s_transform_error %.3g\n", Name, PointsError);
+
+    bool IsAccurate = MultiplyError <= MATH_BENCH_TOLERANCE &&
+                      InverseError <= MATH_BENCH_INVERSE_TOLERANCE &&
+                      PointsError <= MATH_BENCH_TOLERANCE;
+
+    /** Throughput, best of a few runs each. */
+
+    double Multiply = 1e9;
+    double Inverse = 1e9;
+    double Points = 1e9;
+    double Batches = 1e9;
+
+    for (unsigned int Run = 0; Run < MATH_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        for (unsigned int i = 0; i < MATH_BENCH_MATRICES; i++)
+        {
+            kernels::Multiply(&Data->A[i], &Data->B[i], &Data->Products[i]);
+        }
+
+        double Middle = PlatformGetTime();
+
+        for (unsigned int i = 0; i < MATH_BENCH_MATRICES; i++)
+        {
+            kernels::Inverse(&Data->A[i], &Data->Inverses[i]);
+        }
+
+        double End = PlatformGetTime();
+
+        Multiply = Middle - Begin < Multiply ? Middle - Begin : Multiply;
+        Inverse = End - Middle < Inverse ? End - Middle : Inverse;
+
+        Begin = PlatformGetTime();
+
+        kernels::TransformPoints(&Data->A[Run],
+                                 Data->Points,
+                                 Data->Transformed,
+                                 MATH_BENCH_POINTS);
+
+        Middle = PlatformGetTime();
+
+        kernels::TransformBatches(&Data->A[Run],
+                                  Data->Batches,
+                                  Data->TransformedBatches,
+                                  MATH_BENCH_POINTS / MATH_BATCH_WIDTH);
+
+        End = PlatformGetTime();
+
+        Points = Middle - Begin < Points ? Middle - Begin : Points;
+        Batches = End - Middle < Batches ? End - Middle : Batches;
+    }
+
+    printf("math_%s_multiply_ns %.2f\n",
+           Name,
+           Multiply * 1e9 / MATH_BENCH_MATRICES);
+    printf("math_%s_inverse_ns %.2f\n",
+           Name,
+           Inverse * 1e9 / MATH_BENCH_MATRICES);
+    printf("math_%s_points_per_us %.1f\n",
+           Name,
+           MATH_BENCH_POINTS / (Points * 1e6));
+    printf("math_%s_batch_points_per_us %.1f\n",
+           Name,
+           MATH_BENCH_POINTS / (Batches * 1e6));
+
+    return IsAccurate;
+}
+
+/** Runs every math check and benchmark and prints the results. Returns
+ * false if any backend got something wrong. */
+static
+bool BenchmarkMath()
+{
+    math_bench_data Data;
+    Data.A = new mat4[MATH_BENCH_MATRICES];
+    Data.B = new mat4[MATH_BENCH_MATRICES];
+    Data.Products = new mat4[MATH_BENCH_MATRICES];
+    Data.Inverses = new mat4[MATH_BENCH_MATRICES];
+    Data.Points = new vec4[MATH_BENCH_POINTS];
+    Data.Transformed = new vec4[MATH_BENCH_POINTS];
+    Data.Batches = new vec4x8[MATH_BENCH_POINTS / MATH_BATCH_WIDTH];
+    Data.TransformedBatches = new vec4x8[MATH_BENCH_POINTS / MATH_BATCH_WIDTH];
+    Data.Random = 0x2545F491;
+
+    for (unsigned int i = 0; i < MATH_BENCH_MATRICES; i++)
+    {
+        Data.A[i] = MathBenchMatrix(&Data, i);
+        Data.B[i] = MathBenchMatrix(&Data, i + 1);
+    }
+
+    for (unsigned int i = 0; i < MATH_BENCH_POINTS; i++)
+    {
+        vec4 Point = {
+            MathBenchRandom(&Data, -100.0f, 100.0f),
+            MathBenchRandom(&Data, -100.0f, 100.0f),
+            MathBenchRandom(&Data, -100.0f, 100.0f),
+            1.0f
+        };
+
+        vec4x8 *Batch = &Data.Batches[i / MATH_BATCH_WIDTH];
+        unsigned int Lane = i % MATH_BATCH_WIDTH;
+
+        Data.Points[i] = Point;
+        Batch->x[Lane] = Point.x;
+        Batch->y[Lane] = Point.y;
+        Batch->z[Lane] = Point.z;
+        Batch->w[Lane] = Point.w;
+    }
+
+    printf("math_backend %s\n", math_backend::Name);
+
+    bool IsAccurate = BenchmarkMathBackend<math_scalar>(&Data);
+
+#if MATH_HAS_SSE
+    IsAccurate &= BenchmarkMathBackend<math_sse>(&Data);
+#endif
+
+#if MATH_HAS_AVX2
+    IsAccurate &= BenchmarkMathBackend<math_avx2>(&Data);
+#endif
+
+#if MATH_HAS_NEON
+    IsAccurate &= BenchmarkMathBackend<math_neon>(&Data);
+#endif
+
+    printf("math_accurate %d\n", IsAccurate ? 1 : 0);
+
+    delete[] Data.A;
+    delete[] Data.B;
+    delete[] Data.Products;
+    delete[] Data.Inverses;
+    delete[] Data.Points;
+    delete[] Data.Transformed;
+    delete[] Data.Batches;
+    delete[] Data.TransformedBatches;
+
+    return IsAccurate;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file memory.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our memory arenas. See memory.h.
+ */
+
+#include "platform.h"
+#include "memory.h"
+
+/** Reserves Size bytes of address space for Arena. Nothing is committed until
+ * something's pushed. */
+static
+void InitializeArena(memory_arena *Arena, size_t Size, const char *Name)
+{
+    Size = (Size + ARENA_COMMIT_SIZE - 1) & ~(ARENA_COMMIT_SIZE - 1);
+
+    Arena->Base = (unsigned char *)PlatformReserveMemory(Size);
+    Arena->Reserved = Size;
+    Arena->Committed = 0;
+    Arena->Used = 0;
+    Arena->HighWater = 0;
+    Arena->Name = Name;
+
+    if (!Arena->Base)
+    {
+        PlatformLog("Failed to reserve %zu bytes for the %s arena.\n",
+                    Size,
+                    Name);
+        Abort("Failed to reserve memory.\n");
+    }
+}
+
+static
+void ReleaseArena(memory_arena *Arena)
+{
+    PlatformReleaseMemory(Arena->Base, Arena->Reserved);
+
+    *Arena = {};
+}
+
+/** Returns Size bytes from Arena, aligned to Alignment (a power of two).
+ * What's returned isn't cleared, unless it's the first time the memory has
+ * been used. Running out of space is fatal. */
+static
+void *PushSize(memory_arena *Arena, size_t Size, size_t Alignment)
+{
+    size_t Start = (Arena->Used + Alignment - 1) & ~(Alignment - 1);
+    size_t End = Start + Size;
+
+    if (End > Arena->Reserved || End < Start)
+    {
+        PlatformLog("The %s arena is out of space (%zu of %zu bytes used, "
+                    "%zu more wanted).\n",
+                    Arena->Name,
+                    Arena->Used,
+                    Arena->Reserved,
+                    Size);
+        Abort("Out of memory.\n");
+    }
+
+    if (End > Arena->Committed)
+    {
+        size_t Commit = (End - Arena->Committed + ARENA_COMMIT_SIZE - 1) &
+                        ~(ARENA_COMMIT_SIZE - 1);
+
+        if (!PlatformCommitMemory(Arena->Base + Arena->Committed, Commit))
+        {
+            PlatformLog("Failed to commit %zu bytes for the %s arena.\n",
+                        Commit,
+                        Arena->Name);
+            Abort("Out of memory.\n");
+        }
+
+        Arena->Committed += Commit;
+    }
+
+    Arena->Used = End;
+
+    if (End > Arena->HighWater)
+    {
+        Arena->HighWater = End;
+    }
+
+    return Arena->Base + Start;
+}
+
+/** Frees everything in Arena at once. What's committed stays committed, so
+ * the next frame (or level) doesn't have to go to the system again. */
+static
+void ResetArena(memory_arena *Arena)
+{
+    Arena->Used = 0;
+}
+
+static
+arena_temp BeginArenaTemp(memory_arena *Arena)
+{
+    arena_temp Temp;
+    Temp.Arena = Arena;
+    Temp.Used = Arena->Used;
+
+    return Temp;
+}
+
+/** Frees everything pushed onto the arena since BeginArenaTemp(). */
+static
+void EndArenaTemp(arena_temp Temp)
+{
+    Assert(Temp.Arena->Used >= Temp.Used, "Arena temps ended out of order.\n");
+
+    Temp.Arena->Used = Temp.Used;
+}
+
+static
+void InitializeGameMemory(game_memory *Memory)
+{
+    InitializeArena(&Memory->Permanent, PERMANENT_ARENA_SIZE, "permanent");
+    InitializeArena(&Memory->Level, LEVEL_ARENA_SIZE, "level");
+    InitializeArena(&Memory->Frame, FRAME_ARENA_SIZE, "frame");
+}
+
+static
+void ReleaseGameMemory(game_memory *Memory)
+{
+    ReleaseArena(&Memory->Permanent);
+    ReleaseArena(&Memory->Level);
+    ReleaseArena(&Memory->Frame);
+}
@@ -0,0 +1,64 @@
+/**
+ * @file memory.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for our memory arenas. An arena reserves
+ * a big range of address space up front and commits it as it's used, so
+ * pushing onto one is a pointer bump and memory never moves. Arenas are freed
+ * all at once, by resetting them, never piece by piece.
+ *
+ * The game has three: Permanent for things that live as long as the process,
+ * Level for things that live until the next level load, and Frame for scratch
+ * that's thrown away every frame.
+ */
+
+#ifndef _MEMORY_H_
+#define _MEMORY_H_
+
+#define KILOBYTES(N) ((size_t)(N) << 10)
+#define MEGABYTES(N) ((size_t)(N) << 20)
+#define GIGABYTES(N) ((size_t)(N) << 30)
+
+// NOTE[joe] Arenas commit in steps of this, so that pushing lots of little
+// things doesn't go to the system every time. Must be a multiple of the page
+// size (64KB is Windows' allocation granularity).
+#define ARENA_COMMIT_SIZE KILOBYTES(64)
+
+#define PERMANENT_ARENA_SIZE MEGABYTES(256)
+#define LEVEL_ARENA_SIZE GIGABYTES(1)
+#define FRAME_ARENA_SIZE MEGABYTES(64)
+
+/** Not thread safe; each arena belongs to one thread at a time. */
+typedef struct {
+    unsigned char *Base;
+    size_t         Reserved;
+    size_t         Committed;
+    size_t         Used;
+    // NOTE[joe] The most this arena has ever had in use, for sizing them.
+    size_t         HighWater;
+    const char    *Name;
+} memory_arena;
+
+/** Where an arena was up to, to roll it back there with EndArenaTemp(). */
+typedef struct {
+    memory_arena *Arena;
+    size_t        Used;
+} arena_temp;
+
+typedef struct {
+    memory_arena Permanent;
+    memory_arena Level;
+    // NOTE[joe] Belongs to the game thread, which resets it at the start of
+    // every frame. During start up, before there are frames, it's scratch
+    // for whoever's initializing.
+    memory_arena Frame;
+} game_memory;
+
+#define PushStruct(Arena, type) \
+    ((type *)PushSize(Arena, sizeof(type), alignof(type)))
+
+#define PushArray(Arena, type, Count) \
+    ((type *)PushSize(Arena, sizeof(type) * (size_t)(Count), alignof(type)))
+
+#endif
@@ -0,0 +1,1107 @@
+/**
+ * @file occlusion.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains our occlusion culling: clipping and setting up occluder
+ * triangles, binning them into tiles, the SIMD kernels that rasterize a tile
+ * and test a box against one, and doing all of that across the job system.
+ * See occlusion.h.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "job.h"
+#include "occlusion.h"
+
+/** A clipped vertex on the screen, snapped to fixed point. */
+typedef struct {
+    int   X;
+    int   Y;
+    float Depth;
+} occlusion_vertex;
+
+/** What TestOcclusionBoxes() hands its jobs. */
+typedef struct {
+    const occlusion_buffer *Buffer;
+    const occlusion_box    *Boxes;
+    unsigned char          *IsVisible;
+} occlusion_test;
+
+template <typename backend>
+struct occlusion_kernels;
+
+/** The part of [Min, Max) in the tile that starts at Start, relative to it. */
+static inline
+void GetOcclusionOverlap(int Min, int Max, int Start, int Size, int *First,
+                         int *Last)
+{
+    *First = Min > Start ? Min - Start : 0;
+    *Last = Max < Start + Size ? Max - Start : Size;
+}
+
+/** Triangle's pixels in the tile at (TileX, TileY), relative to the tile. */
+static inline
+occlusion_rect GetOcclusionTileRect(const occlusion_triangle *Triangle,
+                                    int TileX,
+                                    int TileY)
+{
+    occlusion_rect Rect = {};
+
+    GetOcclusionOverlap(Triangle->MinX,
+                        Triangle->MaxX,
+                        TileX,
+                        OCCLUSION_TILE_WIDTH,
+                        &Rect.MinX,
+                        &Rect.MaxX);
+    GetOcclusionOverlap(Triangle->MinY,
+                        Triangle->MaxY,
+                        TileY,
+                        OCCLUSION_TILE_HEIGHT,
+                        &Rect.MinY,
+                        &Rect.MaxY);
+
+    return Rect;
+}
+
+/** Draws a pixel at a time. Every other backend is checked against this
+ * one, which is in turn checked against drawing every pixel of the screen
+ * from scratch. */
+template <>
+struct occlusion_kernels<math_scalar> {
+    /** Draws Triangle into Depths, the tile at (TileX, TileY). */
+    static inline
+    void Rasterize(float *Depths,
+                   const occlusion_triangle *Triangle,
+                   int TileX,
+                   int TileY)
+    {
+        occlusion_rect Rect = GetOcclusionTileRect(Triangle, TileX, TileY);
+
+        for (int y = Rect.MinY; y < Rect.MaxY; y++)
+        {
+            int PixelY = TileY + y;
+            float RowDepth =
+                Triangle->Depth + Triangle->DepthStepY * (float)PixelY;
+            float *Line = Depths + y * OCCLUSION_TILE_WIDTH;
+
+            int Rows[3];
+
+            for (unsigned int i = 0; i < 3; i++)
+            {
+                Rows[i] = Triangle->Edges[i] + Triangle->EdgeStepY[i] * PixelY;
+            }
+
+            for (int x = Rect.MinX; x < Rect.MaxX; x++)
+            {
+                int PixelX = TileX + x;
+
+                int Inside = (Rows[0] + Triangle->EdgeStepX[0] * PixelX) |
+                             (Rows[1] + Triangle->EdgeStepX[1] * PixelX) |
+                             (Rows[2] + Triangle->EdgeStepX[2] * PixelX);
+
+                if (Inside >= 0)
+                {
+                    float Depth =
+                        RowDepth + Triangle->DepthStepX * (float)PixelX;
+
+                    Line[x] = Depth < Line[x] ? Depth : Line[x];
+                }
+            }
+        }
+    }
+
+    /** Whether anything in Depths, a tile, inside Rect (relative to the
+     * tile) is as far away as Depth, or farther. */
+    static inline
+    bool IsVisible(const float *Depths, const occlusion_rect *Rect, float Depth)
+    {
+        for (int y = Rect->MinY; y < Rect->MaxY; y++)
+        {
+            const float *Line = Depths + y * OCCLUSION_TILE_WIDTH;
+
+            for (int x = Rect->MinX; x < Rect->MaxX; x++)
+            {
+                if (Line[x] >= Depth)
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+};
+
+#if MATH_HAS_SSE
+
+/** Four pixels of a row at a time. Pixels outside the triangle's bounds
+ * still fail its edges, so spans only need lining up with the tile. */
+template <>
+struct occlusion_kernels<math_sse> {
+    static inline
+    void Rasterize(float *Depths,
+                   const occlusion_triangle *Triangle,
+                   int TileX,
+                   int TileY)
+    {
+        occlusion_rect Rect = GetOcclusionTileRect(Triangle, TileX, TileY);
+
+        __m128i Lanes = _mm_setr_epi32(0, 1, 2, 3);
+        __m128 DepthStepX = _mm_set1_ps(Triangle->DepthStepX);
+
+        // NOTE[joe] SSE2 has no 32 bit multiply, so each lane's step is
+        // worked out up front.
+        __m128i LaneSteps[3];
+
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            int Step = Triangle->EdgeStepX[i];
+            LaneSteps[i] = _mm_setr_epi32(0, Step, 2 * Step, 3 * Step);
+        }
+
+        int First = Rect.MinX & ~3;
+
+        for (int y = Rect.MinY; y < Rect.MaxY; y++)
+        {
+            int PixelY = TileY + y;
+            __m128 RowDepth = _mm_set1_ps(
+                Triangle->Depth + Triangle->DepthStepY * (float)PixelY);
+            float *Line = Depths + y * OCCLUSION_TILE_WIDTH;
+
+            int Rows[3];
+
+            for (unsigned int i = 0; i < 3; i++)
+            {
+                Rows[i] = Triangle->Edges[i] + Triangle->EdgeStepY[i] * PixelY;
+            }
+
+            for (int x = First; x < Rect.MaxX; x += 4)
+            {
+                int PixelX = TileX + x;
+
+                __m128i Inside = _mm_or_si128(
+                    _mm_add_epi32(
+                        _mm_set1_epi32(Rows[0] +
+                                       Triangle->EdgeStepX[0] * PixelX),
+                        LaneSteps[0]),
+                    _mm_or_si128(
+                        _mm_add_epi32(
+                            _mm_set1_epi32(Rows[1] +
+                                           Triangle->EdgeStepX[1] * PixelX),
+                            LaneSteps[1]),
+                        _mm_add_epi32(
+                            _mm_set1_epi32(Rows[2] +
+                                           Triangle->EdgeStepX[2] * PixelX),
+                            LaneSteps[2])));
+
+                // NOTE[joe] A lane's outside if any of its edges came out
+                // negative.
+                __m128 Outside = _mm_castsi128_ps(_mm_srai_epi32(Inside, 31));
+
+                if (_mm_movemask_ps(Outside) == 0xF)
+                {
+                    continue;
+                }
+
+                __m128 Xs = _mm_cvtepi32_ps(
+                    _mm_add_epi32(_mm_set1_epi32(PixelX), Lanes));
+                __m128 Depth = _mm_add_ps(RowDepth, _mm_mul_ps(DepthStepX, Xs));
+                __m128 Old = _mm_load_ps(Line + x);
+                __m128 New = _mm_min_ps(Depth, Old);
+
+                _mm_store_ps(Line + x,
+                             _mm_or_ps(_mm_and_ps(Outside, Old),
+                                       _mm_andnot_ps(Outside, New)));
+            }
+        }
+    }
+
+    static inline
+    bool IsVisible(const float *Depths, const occlusion_rect *Rect, float Depth)
+    {
+        __m128i Lanes = _mm_setr_epi32(0, 1, 2, 3);
+        __m128i MinX = _mm_set1_epi32(Rect->MinX - 1);
+        __m128i MaxX = _mm_set1_epi32(Rect->MaxX);
+        __m128 Depths4 = _mm_set1_ps(Depth);
+
+        int First = Rect->MinX & ~3;
+
+        for (int y = Rect->MinY; y < Rect->MaxY; y++)
+        {
+            const float *Line = Depths + y * OCCLUSION_TILE_WIDTH;
+
+            for (int x = First; x < Rect->MaxX; x += 4)
+            {
+                __m128i Xs = _mm_add_epi32(_mm_set1_epi32(x), Lanes);
+                __m128i Columns = _mm_and_si128(_mm_cmpgt_epi32(Xs, MinX),
+                                                _mm_cmplt_epi32(Xs, MaxX));
+                __m128 Behind = _mm_cmpge_ps(_mm_load_ps(Line + x), Depths4);
+
+                if (_mm_movemask_ps(
+                        _mm_and_ps(Behind, _mm_castsi128_ps(Columns))))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+};
+
+#endif
+
+#if MATH_HAS_AVX2
+
+/** Eight pixels of a row at a time. */
+template <>
+struct occlusion_kernels<math_avx2> {
+    static inline
+    void Rasterize(float *Depths,
+                   const occlusion_triangle *Triangle,
+                   int TileX,
+                   int TileY)
+    {
+        occlusion_rect Rect = GetOcclusionTileRect(Triangle, TileX, TileY);
+
+        __m256i Lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256 DepthStepX = _mm256_set1_ps(Triangle->DepthStepX);
+
+        __m256i LaneSteps[3];
+
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            LaneSteps[i] =
+                _mm256_mullo_epi32(_mm256_set1_epi32(Triangle->EdgeStepX[i]),
+                                   Lanes);
+        }
+
+        int First = Rect.MinX & ~7;
+
+        for (int y = Rect.MinY; y < Rect.MaxY; y++)
+        {
+            int PixelY = TileY + y;
+            __m256 RowDepth = _mm256_set1_ps(
+                Triangle->Depth + Triangle->DepthStepY * (float)PixelY);
+            float *Line = Depths + y * OCCLUSION_TILE_WIDTH;
+
+            int Rows[3];
+
+            for (unsigned int i = 0; i < 3; i++)
+            {
+                Rows[i] = Triangle->Edges[i] + Triangle->EdgeStepY[i] * PixelY;
+            }
+
+            for (int x = First; x < Rect.MaxX; x += 8)
+            {
+                int PixelX = TileX + x;
+
+                __m256i Inside = _mm256_or_si256(
+                    _mm256_add_epi32(
+                        _mm256_set1_epi32(Rows[0] +
+                                          Triangle->EdgeStepX[0] * PixelX),
+                        LaneSteps[0]),
+                    _mm256_or_si256(
+                        _mm256_add_epi32(
+                            _mm256_set1_epi32(Rows[1] +
+                                              Triangle->EdgeStepX[1] * PixelX),
+                            LaneSteps[1]),
+                        _mm256_add_epi32(
+                            _mm256_set1_epi32(Rows[2] +
+                                              Triangle->EdgeStepX[2] * PixelX),
+                            LaneSteps[2])));
+
+                // NOTE[joe] Blends go by the sign bit, which is set where
+                // any edge came out negative.
+                __m256 Outside = _mm256_castsi256_ps(Inside);
+
+                if (_mm256_movemask_ps(Outside) == 0xFF)
+                {
+                    continue;
+                }
+
+                __m256 Xs = _mm256_cvtepi32_ps(
+                    _mm256_add_epi32(_mm256_set1_epi32(PixelX), Lanes));
+                __m256 Depth =
+                    _mm256_add_ps(RowDepth, _mm256_mul_ps(DepthStepX, Xs));
+                __m256 Old = _mm256_load_ps(Line + x);
+
+                _mm256_store_ps(Line + x,
+                                _mm256_blendv_ps(_mm256_min_ps(Depth, Old),
+                                                 Old,
+                                                 Outside));
+            }
+        }
+    }
+
+    static inline
+    bool IsVisible(const float *Depths, const occlusion_rect *Rect, float Depth)
+    {
+        __m256i Lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i MinX = _mm256_set1_epi32(Rect->MinX - 1);
+        __m256i MaxX = _mm256_set1_epi32(Rect->MaxX);
+        __m256 Depths8 = _mm256_set1_ps(Depth);
+
+        int First = Rect->MinX & ~7;
+
+        for (int y = Rect->MinY; y < Rect->MaxY; y++)
+        {
+            const float *Line = Depths + y * OCCLUSION_TILE_WIDTH;
+
+            for (int x = First; x < Rect->MaxX; x += 8)
+            {
+                __m256i Xs = _mm256_add_epi32(_mm256_set1_epi32(x), Lanes);
+                __m256i Columns =
+                    _mm256_and_si256(_mm256_cmpgt_epi32(Xs, MinX),
+                                     _mm256_cmpgt_epi32(MaxX, Xs));
+                __m256 Behind = _mm256_cmp_ps(_mm256_load_ps(Line + x),
+                                              Depths8,
+                                              _CMP_GE_OQ);
+
+                if (_mm256_movemask_ps(
+                        _mm256_and_ps(Behind, _mm256_castsi256_ps(Columns))))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+};
+
+#endif
+
+// NOTE[joe] NEON goes through the scalar kernel for now.
+#if MATH_HAS_AVX2
+typedef math_avx2 occlusion_backend;
+#elif MATH_HAS_SSE
+typedef math_sse occlusion_backend;
+#else
+typedef math_scalar occlusion_backend;
+#endif
+
+/** A Width by Height buffer, with room for MaxOccluderCount occluders of
+ * MaxTriangleCount triangles between them, allocated from Arena. Width and
+ * Height have to be multiples of the tile size. */
+static
+void InitializeOcclusion(occlusion_buffer *Buffer,
+                         memory_arena *Arena,
+                         unsigned int Width,
+                         unsigned int Height,
+                         unsigned int MaxOccluderCount,
+                         unsigned int MaxTriangleCount)
+{
+    Assert(Width % OCCLUSION_TILE_WIDTH == 0 &&
+           Height % OCCLUSION_TILE_HEIGHT == 0,
+           "Occlusion buffer isn't a whole number of tiles.\n");
+    Assert(Width <= OCCLUSION_MAX_SIZE && Height <= OCCLUSION_MAX_SIZE,
+           "Occlusion buffer is too big.\n");
+
+    Buffer->Width = Width;
+    Buffer->Height = Height;
+    Buffer->TileCountX = Width / OCCLUSION_TILE_WIDTH;
+    Buffer->TileCountY = Height / OCCLUSION_TILE_HEIGHT;
+
+    unsigned int TileCount = Buffer->TileCountX * Buffer->TileCountY;
+
+    // NOTE[joe] A tile to a cache line boundary, so no two jobs share one.
+    Buffer->Depths =
+        (float *)PushSize(Arena, sizeof(float) * Width * Height, 64);
+    Buffer->TileMaxDepths = PushArray(Arena, float, TileCount);
+
+    for (unsigned int i = 0; i < Width * Height; i++)
+    {
+        Buffer->Depths[i] = 1.0f;
+    }
+
+    for (unsigned int i = 0; i < TileCount; i++)
+    {
+        Buffer->TileMaxDepths[i] = 1.0f;
+    }
+
+    Buffer->MaxOccluderCount = MaxOccluderCount;
+    Buffer->OccluderCount = 0;
+    Buffer->Occluders =
+        PushArray(Arena, occlusion_occluder, MaxOccluderCount);
+    Buffer->TriangleCount = 0;
+
+    unsigned int ChunkCount =
+        (MaxTriangleCount + OCCLUSION_SETUP_CHUNK - 1) / OCCLUSION_SETUP_CHUNK;
+
+    Buffer->MaxTriangleCount = MaxTriangleCount;
+    Buffer->Triangles =
+        PushArray(Arena,
+                  occlusion_triangle,
+                  ChunkCount * OCCLUSION_SETUP_CHUNK *
+                      OCCLUSION_MAX_CLIPPED_TRIANGLES);
+    Buffer->ChunkCounts = PushArray(Arena, unsigned int, ChunkCount);
+
+    Buffer->MaxBinnedCount = MaxTriangleCount * OCCLUSION_BINS_PER_TRIANGLE;
+    Buffer->Bins = PushArray(Arena, unsigned int, Buffer->MaxBinnedCount);
+    Buffer->BinStarts = PushArray(Arena, unsigned int, TileCount);
+    Buffer->BinEnds = PushArray(Arena, unsigned int, TileCount);
+    Buffer->DroppedCount = 0;
+}
+
+/** Forgets last frame's occluders. */
+static
+void BeginOcclusion(occlusion_buffer *Buffer)
+{
+    Buffer->OccluderCount = 0;
+    Buffer->TriangleCount = 0;
+}
+
+/** Adds VertexCount vertices of a triangle list as an occluder, with
+ * Transform taking them to clip space. Vertices has to stay put until
+ * RenderOcclusion(). */
+static
+void AddOccluder(occlusion_buffer *Buffer,
+                 const vertex *Vertices,
+                 unsigned int VertexCount,
+                 const mat4 *Transform)
+{
+    Assert(Buffer->OccluderCount < Buffer->MaxOccluderCount,
+           "Too many occluders.\n");
+    Assert(VertexCount % 3 == 0, "Occluders have to be triangle lists.\n");
+
+    unsigned int TriangleCount = VertexCount / 3;
+
+    Assert(Buffer->TriangleCount + TriangleCount <= Buffer->MaxTriangleCount,
+           "Too many occluder triangles.\n");
+
+    occlusion_occluder *Occluder = &Buffer->Occluders[Buffer->OccluderCount++];
+    Occluder->Vertices = Vertices;
+    Occluder->TriangleCount = TriangleCount;
+    Occluder->FirstTriangle = Buffer->TriangleCount;
+    Occluder->Transform = *Transform;
+
+    Buffer->TriangleCount += TriangleCount;
+}
+
+/** How far inside clip plane Plane is: w, the near plane, then the left,
+ * right, top and bottom of the screen. Negative is outside. */
+static inline
+float GetOcclusionPlaneDistance(vec4 Point, unsigned int Plane)
+{
+    switch (Plane)
+    {
+        case 0: return Point.w - OCCLUSION_MIN_W;
+        case 1: return Point.z;
+        case 2: return Point.w + Point.x;
+        case 3: return Point.w - Point.x;
+        case 4: return Point.w + Point.y;
+        default: return Point.w - Point.y;
+    }
+}
+
+#define OCCLUSION_PLANE_COUNT 6
+
+/** One bit per plane Point is outside of. */
+static inline
+unsigned int GetOcclusionOutcode(vec4 Point)
+{
+    unsigned int Outcode = 0;
+
+    for (unsigned int Plane = 0; Plane < OCCLUSION_PLANE_COUNT; Plane++)
+    {
+        if (GetOcclusionPlaneDistance(Point, Plane) < 0.0f)
+        {
+            Outcode |= 1 << Plane;
+        }
+    }
+
+    return Outcode;
+}
+
+/** Cuts the Count corners of Polygon down to what's inside Plane, into
+ * Result. Returns how many corners are left. */
+static
+unsigned int ClipOcclusionPolygon(const vec4 *Polygon,
+                                  unsigned int Count,
+                                  unsigned int Plane,
+                                  vec4 *Result)
+{
+    unsigned int ResultCount = 0;
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        vec4 From = Polygon[i];
+        vec4 To = Polygon[(i + 1) % Count];
+        float FromDistance = GetOcclusionPlaneDistance(From, Plane);
+        float ToDistance = GetOcclusionPlaneDistance(To, Plane);
+
+        if (FromDistance >= 0.0f)
+        {
+            Result[ResultCount++] = From;
+        }
+
+        if ((FromDistance >= 0.0f) != (ToDistance >= 0.0f))
+        {
+            float T = FromDistance / (FromDistance - ToDistance);
+            Result[ResultCount++] = Lerp(From, To, T);
+        }
+    }
+
+    return ResultCount;
+}
+
+/** Transforms Occluder's triangle Triangle, clips it to the screen and
+ * snaps it to it, into Polygon. Returns how many corners that left, which
+ * is fewer than three if none of it's on the screen. */
+static
+unsigned int ProjectOcclusionTriangle(const occlusion_buffer *Buffer,
+                                      const occlusion_occluder *Occluder,
+                                      unsigned int Triangle,
+                                      occlusion_vertex *Polygon)
+{
+    vec4 Corners[2][OCCLUSION_MAX_CLIPPED_VERTICES];
+    unsigned int Outcodes[3];
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        const vertex *Vertex = &Occluder->Vertices[Triangle * 3 + i];
+
+        Corners[0][i] = Occluder->Transform *
+                        vec4 { Vertex->x, Vertex->y, Vertex->z, Vertex->w };
+        Outcodes[i] = GetOcclusionOutcode(Corners[0][i]);
+    }
+
+    // NOTE[joe] Entirely outside one plane, or entirely inside them all.
+    if (Outcodes[0] & Outcodes[1] & Outcodes[2])
+    {
+        return 0;
+    }
+
+    unsigned int Count = 3;
+    unsigned int Current = 0;
+    unsigned int Crossed = Outcodes[0] | Outcodes[1] | Outcodes[2];
+
+    for (unsigned int Plane = 0; Plane < OCCLUSION_PLANE_COUNT; Plane++)
+    {
+        if (Crossed & (1 << Plane))
+        {
+            Count = ClipOcclusionPolygon(Corners[Current],
+                                         Count,
+                                         Plane,
+                                         Corners[Current ^ 1]);
+            Current ^= 1;
+
+            if (Count < 3)
+            {
+                return 0;
+            }
+        }
+    }
+
+    float ScaleX = 0.5f * (float)(Buffer->Width * OCCLUSION_SUBPIXELS);
+    float ScaleY = 0.5f * (float)(Buffer->Height * OCCLUSION_SUBPIXELS);
+    int MaxX = (int)(Buffer->Width * OCCLUSION_SUBPIXELS);
+    int MaxY = (int)(Buffer->Height * OCCLUSION_SUBPIXELS);
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        vec4 Corner = Corners[Current][i];
+        float InverseW = 1.0f / Corner.w;
+
+        // NOTE[joe] Clipping leaves corners on the edges of the screen, give
+        // or take rounding, so they're clamped to it.
+        int X = (int)floorf((Corner.x * InverseW + 1.0f) * ScaleX + 0.5f);
+        int Y = (int)floorf((Corner.y * InverseW + 1.0f) * ScaleY + 0.5f);
+
+        Polygon[i].X = X < 0 ? 0 : (X > MaxX ? MaxX : X);
+        Polygon[i].Y = Y < 0 ? 0 : (Y > MaxY ? MaxY : Y);
+        Polygon[i].Depth = Corner.z * InverseW;
+    }
+
+    return Count;
+}
+
+/** Sets up the triangle from A, B and C, either way round, into Triangle.
+ * Returns false if it doesn't cover the centre of any pixel. */
+static
+bool SetupOcclusionTriangle(const occlusion_buffer *Buffer,
+                            occlusion_vertex A,
+                            occlusion_vertex B,
+                            occlusion_vertex C,
+                            occlusion_triangle *Triangle)
+{
+    int Area = (B.X - A.X) * (C.Y - A.Y) - (B.Y - A.Y) * (C.X - A.X);
+
+    if (Area == 0)
+    {
+        return false;
+    }
+
+    // NOTE[joe] Occluders are drawn from both sides, so turn the ones
+    // facing away around, rather than dropping them.
+    if (Area < 0)
+    {
+        occlusion_vertex Swap = B;
+        B = C;
+        C = Swap;
+    }
+
+    /** Only pixels whose centres are inside the corners can be in it. */
+
+    int Half = OCCLUSION_SUBPIXELS / 2;
+    int Low = OCCLUSION_SUBPIXELS - 1 - Half;
+
+    int MinX = A.X < B.X ? (A.X < C.X ? A.X : C.X) : (B.X < C.X ? B.X : C.X);
+    int MinY = A.Y < B.Y ? (A.Y < C.Y ? A.Y : C.Y) : (B.Y < C.Y ? B.Y : C.Y);
+    int MaxX = A.X > B.X ? (A.X > C.X ? A.X : C.X) : (B.X > C.X ? B.X : C.X);
+    int MaxY = A.Y > B.Y ? (A.Y > C.Y ? A.Y : C.Y) : (B.Y > C.Y ? B.Y : C.Y);
+
+    // NOTE[joe] Shifts round down, for negative numbers too.
+    Triangle->MinX = (MinX + Low) >> OCCLUSION_SUBPIXEL_BITS;
+    Triangle->MinY = (MinY + Low) >> OCCLUSION_SUBPIXEL_BITS;
+    Triangle->MaxX = ((MaxX - Half) >> OCCLUSION_SUBPIXEL_BITS) + 1;
+    Triangle->MaxY = ((MaxY - Half) >> OCCLUSION_SUBPIXEL_BITS) + 1;
+
+    if (Triangle->MaxX > (int)Buffer->Width)
+    {
+        Triangle->MaxX = Buffer->Width;
+    }
+
+    if (Triangle->MaxY > (int)Buffer->Height)
+    {
+        Triangle->MaxY = Buffer->Height;
+    }
+
+    if (Triangle->MinX >= Triangle->MaxX || Triangle->MinY >= Triangle->MaxY)
+    {
+        return false;
+    }
+
+    /** Edge functions, positive inside. */
+
+    occlusion_vertex Corners[3] = { A, B, C };
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        occlusion_vertex From = Corners[i];
+        occlusion_vertex To = Corners[(i + 1) % 3];
+
+        int StepX = From.Y - To.Y;
+        int StepY = To.X - From.X;
+        int Offset = (To.Y - From.Y) * From.X - (To.X - From.X) * From.Y;
+
+        // NOTE[joe] A pixel centre exactly on an edge two triangles share
+        // belongs to one of them, never both and never neither. Which one
+        // only depends on which way the edge goes.
+        bool IsInclusive = StepX > 0 || (StepX == 0 && StepY > 0);
+
+        Triangle->Edges[i] =
+            (StepX + StepY) * Half + Offset - (IsInclusive ? 0 : 1);
+        Triangle->EdgeStepX[i] = StepX * OCCLUSION_SUBPIXELS;
+        Triangle->EdgeStepY[i] = StepY * OCCLUSION_SUBPIXELS;
+    }
+
+    /** Depth's a plane across the screen, in pixels. */
+
+    double Scale = 1.0 / OCCLUSION_SUBPIXELS;
+    double AX = A.X * Scale;
+    double AY = A.Y * Scale;
+    double BX = B.X * Scale - AX;
+    double BY = B.Y * Scale - AY;
+    double CX = C.X * Scale - AX;
+    double CY = C.Y * Scale - AY;
+    double BDepth = (double)B.Depth - A.Depth;
+    double CDepth = (double)C.Depth - A.Depth;
+    double InverseArea = 1.0 / (BX * CY - BY * CX);
+
+    double StepX = (BDepth * CY - CDepth * BY) * InverseArea;
+    double StepY = (CDepth * BX - BDepth * CX) * InverseArea;
+
+    Triangle->Depth =
+        (float)(A.Depth + StepX * (0.5 - AX) + StepY * (0.5 - AY));
+    Triangle->DepthStepX = (float)StepX;
+    Triangle->DepthStepY = (float)StepY;
+
+    return true;
+}
+
+/** Sets up chunks [Start, End) of occluder triangles. */
+static
+void SetupOcclusionJob(void *Data, unsigned int Start, unsigned int End)
+{
+    occlusion_buffer *Buffer = (occlusion_buffer *)Data;
+
+    for (unsigned int Chunk = Start; Chunk < End; Chunk++)
+    {
+        unsigned int First = Chunk * OCCLUSION_SETUP_CHUNK;
+        unsigned int Last = First + OCCLUSION_SETUP_CHUNK;
+        Last = Last < Buffer->TriangleCount ? Last : Buffer->TriangleCount;
+
+        occlusion_triangle *Triangles =
+            Buffer->Triangles +
+            First * OCCLUSION_MAX_CLIPPED_TRIANGLES;
+        unsigned int Count = 0;
+
+        // NOTE[joe] The last occluder that starts at or before First.
+        unsigned int Low = 0;
+        unsigned int High = Buffer->OccluderCount;
+
+        while (High - Low > 1)
+        {
+            unsigned int Middle = (Low + High) / 2;
+
+            if (Buffer->Occluders[Middle].FirstTriangle <= First)
+            {
+                Low = Middle;
+            }
+            else
+            {
+                High = Middle;
+            }
+        }
+
+        const occlusion_occluder *Occluder = &Buffer->Occluders[Low];
+
+        for (unsigned int Triangle = First; Triangle < Last; Triangle++)
+        {
+            while (Triangle >=
+                   Occluder->FirstTriangle + Occluder->TriangleCount)
+            {
+                Occluder++;
+            }
+
+            occlusion_vertex Polygon[OCCLUSION_MAX_CLIPPED_VERTICES];
+            unsigned int Corners =
+                ProjectOcclusionTriangle(Buffer,
+                                         Occluder,
+                                         Triangle - Occluder->FirstTriangle,
+                                         Polygon);
+
+            for (unsigned int i = 1; i + 1 < Corners; i++)
+            {
+                if (SetupOcclusionTriangle(Buffer,
+                                           Polygon[0],
+                                           Polygon[i],
+                                           Polygon[i + 1],
+                                           &Triangles[Count]))
+                {
+                    Count++;
+                }
+            }
+        }
+
+        Buffer->ChunkCounts[Chunk] = Count;
+    }
+}
+
+/** Calls Visit(Buffer, Tile, Index, Context) for every tile each set up
+ * triangle covers, in the order the triangles were added. */
+template <typename visitor>
+static
+void VisitOcclusionTiles(occlusion_buffer *Buffer, visitor Visit)
+{
+    unsigned int ChunkCount =
+        (Buffer->TriangleCount + OCCLUSION_SETUP_CHUNK - 1) /
+        OCCLUSION_SETUP_CHUNK;
+
+    for (unsigned int Chunk = 0; Chunk < ChunkCount; Chunk++)
+    {
+        unsigned int First =
+            Chunk * OCCLUSION_SETUP_CHUNK * OCCLUSION_MAX_CLIPPED_TRIANGLES;
+
+        for (unsigned int i = 0; i < Buffer->ChunkCounts[Chunk]; i++)
+        {
+            occlusion_triangle *Triangle = &Buffer->Triangles[First + i];
+
+            unsigned int FirstX = Triangle->MinX / OCCLUSION_TILE_WIDTH;
+            unsigned int FirstY = Triangle->MinY / OCCLUSION_TILE_HEIGHT;
+            unsigned int LastX = (Triangle->MaxX - 1) / OCCLUSION_TILE_WIDTH;
+            unsigned int LastY = (Triangle->MaxY - 1) / OCCLUSION_TILE_HEIGHT;
+
+            for (unsigned int y = FirstY; y <= LastY; y++)
+            {
+                for (unsigned int x = FirstX; x <= LastX; x++)
+                {
+                    Visit(y * Buffer->TileCountX + x, First + i);
+                }
+            }
+        }
+    }
+}
+
+/** Lists which triangles each tile has to draw. Tiles get their room in
+ * the bins in order, so if they run out, it's the last tiles that go
+ * without, the same way every time. */
+static
+void BinOcclusionTriangles(occlusion_buffer *Buffer)
+{
+    unsigned int TileCount = Buffer->TileCountX * Buffer->TileCountY;
+
+    for (unsigned int Tile = 0; Tile < TileCount; Tile++)
+    {
+        Buffer->BinEnds[Tile] = 0;
+    }
+
+    VisitOcclusionTiles(Buffer, [Buffer](unsigned int Tile, unsigned int) {
+        Buffer->BinEnds[Tile]++;
+    });
+
+    unsigned int Start = 0;
+    unsigned int DroppedCount = 0;
+
+    for (unsigned int Tile = 0; Tile < TileCount; Tile++)
+    {
+        unsigned int Count = Buffer->BinEnds[Tile];
+        unsigned int Room = Buffer->MaxBinnedCount - Start;
+
+        if (Count > Room)
+        {
+            DroppedCount += Count - Room;
+            Count = Room;
+        }
+
+        Buffer->BinStarts[Tile] = Start;
+        Buffer->BinEnds[Tile] = Start;
+        Start += Count;
+    }
+
+    VisitOcclusionTiles(Buffer, [Buffer, TileCount, Start](unsigned int Tile,
+                                                           unsigned int Index) {
+        unsigned int Limit =
+            Tile + 1 < TileCount ? Buffer->BinStarts[Tile + 1] : Start;
+
+        if (Buffer->BinEnds[Tile] < Limit)
+        {
+            Buffer->Bins[Buffer->BinEnds[Tile]++] = Index;
+        }
+    });
+
+    Buffer->DroppedCount = DroppedCount;
+}
+
+/** Clears tiles [Start, End) and draws their triangles into them, with
+ * backend's kernel. */
+template <typename backend>
+static
+void RasterizeOcclusionWith(occlusion_buffer *Buffer,
+                            unsigned int Start,
+                            unsigned int End)
+{
+    for (unsigned int Tile = Start; Tile < End; Tile++)
+    {
+        float *Depths = Buffer->Depths + Tile * OCCLUSION_TILE_SIZE;
+
+        for (unsigned int i = 0; i < OCCLUSION_TILE_SIZE; i++)
+        {
+            Depths[i] = 1.0f;
+        }
+
+        int TileX = (Tile % Buffer->TileCountX) * OCCLUSION_TILE_WIDTH;
+        int TileY = (Tile / Buffer->TileCountX) * OCCLUSION_TILE_HEIGHT;
+
+        for (unsigned int i = Buffer->BinStarts[Tile];
+             i < Buffer->BinEnds[Tile];
+             i++)
+        {
+            occlusion_kernels<backend>::Rasterize(
+                Depths,
+                &Buffer->Triangles[Buffer->Bins[i]],
+                TileX,
+                TileY);
+        }
+
+        float MaxDepth = 0.0f;
+
+        for (unsigned int i = 0; i < OCCLUSION_TILE_SIZE; i++)
+        {
+            MaxDepth = Depths[i] > MaxDepth ? Depths[i] : MaxDepth;
+        }
+
+        Buffer->TileMaxDepths[Tile] = MaxDepth;
+    }
+}
+
+static
+void RasterizeOcclusionJob(void *Data, unsigned int Start, unsigned int End)
+{
+    RasterizeOcclusionWith<occlusion_backend>((occlusion_buffer *)Data,
+                                              Start,
+                                              End);
+}
+
+/** Clips and sets up this frame's occluders, and draws them, across Jobs.
+ * Waits until the buffer's ready to test boxes against. */
+static
+void RenderOcclusion(occlusion_buffer *Buffer, job_system *Jobs)
+{
+    unsigned int ChunkCount =
+        (Buffer->TriangleCount + OCCLUSION_SETUP_CHUNK - 1) /
+        OCCLUSION_SETUP_CHUNK;
+
+    ParallelForAndWait(Jobs, SetupOcclusionJob, Buffer, ChunkCount, 1);
+
+    // NOTE[joe] The one part that doesn't split up. It's a couple of passes
+    // of adding one, for each tile a triangle covers.
+    BinOcclusionTriangles(Buffer);
+
+    ParallelForAndWait(Jobs,
+                       RasterizeOcclusionJob,
+                       Buffer,
+                       Buffer->TileCountX * Buffer->TileCountY,
+                       OCCLUSION_MIN_TILES);
+}
+
+/** Where Box lands on the screen. A box that reaches behind the near plane
+ * could cover anything, so it gets the whole screen, as near as it gets. */
+static
+occlusion_rect GetOcclusionRect(const occlusion_buffer *Buffer,
+                                const occlusion_box *Box)
+{
+    occlusion_rect Rect = {
+        0, 0, (int)Buffer->Width, (int)Buffer->Height, 0.0f
+    };
+
+    float MinX = INFINITY;
+    float MinY = INFINITY;
+    float MaxX = -INFINITY;
+    float MaxY = -INFINITY;
+    float Depth = INFINITY;
+
+    for (unsigned int i = 0; i < 8; i++)
+    {
+        vec4 Corner = {
+            (i & 1) ? Box->Max.x : Box->Min.x,
+            (i & 2) ? Box->Max.y : Box->Min.y,
+            (i & 4) ? Box->Max.z : Box->Min.z,
+            1.0f
+        };
+
+        Corner = Box->Transform * Corner;
+
+        if (Corner.w < OCCLUSION_MIN_W || Corner.z < 0.0f)
+        {
+            return Rect;
+        }
+
+        float InverseW = 1.0f / Corner.w;
+        float X = (Corner.x * InverseW + 1.0f) * 0.5f * Buffer->Width;
+        float Y = (Corner.y * InverseW + 1.0f) * 0.5f * Buffer->Height;
+        float Z = Corner.z * InverseW;
+
+        MinX = X < MinX ? X : MinX;
+        MinY = Y < MinY ? Y : MinY;
+        MaxX = X > MaxX ? X : MaxX;
+        MaxY = Y > MaxY ? Y : MaxY;
+        Depth = Z < Depth ? Z : Depth;
+    }
+
+    // NOTE[joe] Every pixel it touches any of. Clamped as floats, since it
+    // can be a long way off the screen.
+    float Width = (float)Buffer->Width;
+    float Height = (float)Buffer->Height;
+
+    Rect.MinX = (int)floorf(MinX < 0.0f ? 0.0f : (MinX > Width ? Width : MinX));
+    Rect.MinY =
+        (int)floorf(MinY < 0.0f ? 0.0f : (MinY > Height ? Height : MinY));
+    Rect.MaxX = (int)ceilf(MaxX < 0.0f ? 0.0f : (MaxX > Width ? Width : MaxX));
+    Rect.MaxY =
+        (int)ceilf(MaxY < 0.0f ? 0.0f : (MaxY > Height ? Height : MaxY));
+    Rect.Depth = Depth;
+
+    return Rect;
+}
+
+/** Whether anything in Rect is as far away as its depth, or farther, with
+ * backend's kernel. A rect that's off the screen isn't visible. */
+template <typename backend>
+static
+bool IsOcclusionRectVisibleWith(const occlusion_buffer *Buffer,
+                                const occlusion_rect *Rect)
+{
+    if (Rect->MinX >= Rect->MaxX || Rect->MinY >= Rect->MaxY)
+    {
+        return false;
+    }
+
+    unsigned int FirstX = Rect->MinX / OCCLUSION_TILE_WIDTH;
+    unsigned int FirstY = Rect->MinY / OCCLUSION_TILE_HEIGHT;
+    unsigned int LastX = (Rect->MaxX - 1) / OCCLUSION_TILE_WIDTH;
+    unsigned int LastY = (Rect->MaxY - 1) / OCCLUSION_TILE_HEIGHT;
+
+    for (unsigned int y = FirstY; y <= LastY; y++)
+    {
+        for (unsigned int x = FirstX; x <= LastX; x++)
+        {
+            unsigned int Tile = y * Buffer->TileCountX + x;
+
+            // NOTE[joe] Behind the farthest thing in the tile.
+            if (Rect->Depth > Buffer->TileMaxDepths[Tile])
+            {
+                continue;
+            }
+
+            int TileX = x * OCCLUSION_TILE_WIDTH;
+            int TileY = y * OCCLUSION_TILE_HEIGHT;
+
+            occlusion_rect Local = {};
+            GetOcclusionOverlap(Rect->MinX,
+                                Rect->MaxX,
+                                TileX,
+                                OCCLUSION_TILE_WIDTH,
+                                &Local.MinX,
+                                &Local.MaxX);
+            GetOcclusionOverlap(Rect->MinY,
+                                Rect->MaxY,
+                                TileY,
+                                OCCLUSION_TILE_HEIGHT,
+                                &Local.MinY,
+                                &Local.MaxY);
+
+            if (occlusion_kernels<backend>::IsVisible(
+                    Buffer->Depths + Tile * OCCLUSION_TILE_SIZE,
+                    &Local,
+                    Rect->Depth))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/** Whether any of Box might be seen past this frame's occluders. */
+static
+bool IsOcclusionBoxVisible(const occlusion_buffer *Buffer,
+                           const occlusion_box *Box)
+{
+    occlusion_rect Rect = GetOcclusionRect(Buffer, Box);
+
+    return IsOcclusionRectVisibleWith<occlusion_backend>(Buffer, &Rect);
+}
+
+static
+void TestOcclusionJob(void *Data, unsigned int Start, unsigned int End)
+{
+    occlusion_test *Test = (occlusion_test *)Data;
+
+    for (unsigned int i = Start; i < End; i++)
+    {
+        Test->IsVisible[i] = IsOcclusionBoxVisible(Test->Buffer,
+                                                   &Test->Boxes[i]);
+    }
+}
+
+/** Tests Count Boxes across Jobs, setting IsVisible for each, and waits. */
+static
+void TestOcclusionBoxes(const occlusion_buffer *Buffer,
+                        job_system *Jobs,
+                        const occlusion_box *Boxes,
+                        unsigned int Count,
+                        unsigned char *IsVisible)
+{
+    occlusion_test Test = { Buffer, Boxes, IsVisible };
+
+    ParallelForAndWait(Jobs,
+                       TestOcclusionJob,
+                       &Test,
+                       Count,
+                       OCCLUSION_MIN_BOXES);
+}
@@ -0,0 +1,147 @@
+/**
+ * @file occlusion.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the definitions for our occlusion culling, which draws
+ * a handful of big, simple meshes (walls, buildings, the ground) into a
+ * small depth buffer on the CPU, and then checks the bounding box of
+ * everything else we'd draw against it. Anything whose box is behind what's
+ * already there at every pixel it covers never becomes a draw.
+ *
+ * Occluders are transformed and clipped, a chunk of triangles per job, and
+ * snapped to a sixteenth of a pixel, so their edges can be walked in
+ * integers and come out the same every time. Each triangle is then binned
+ * into the tiles of the screen it covers, and each tile is rasterized by a
+ * job of its own, so no two jobs ever write the same pixel. Tiles are kept
+ * a tile at a time in memory, and a row of a tile is a few SIMD registers
+ * wide, so a span of pixels is tested against all three edges, has its
+ * depth worked out and gets written with a handful of instructions.
+ *
+ * Each tile also remembers the farthest depth in it once it's done. Most
+ * boxes that are hidden are hidden a long way behind something, and get
+ * found out by that alone, without looking at a single pixel.
+ *
+ * All of this runs on the game thread and its workers while it builds a
+ * packet, which is while the render thread has the last one in flight.
+ */
+
+#ifndef _OCCLUSION_H_
+#define _OCCLUSION_H_
+
+#include "linear_math.h"
+#include "render.h"
+
+// NOTE[joe] A row of a tile is four AVX2 registers, or eight SSE ones.
+#define OCCLUSION_TILE_WIDTH 32
+#define OCCLUSION_TILE_HEIGHT 8
+#define OCCLUSION_TILE_SIZE (OCCLUSION_TILE_WIDTH * OCCLUSION_TILE_HEIGHT)
+
+// NOTE[joe] Edge functions are kept in 32 bits. Snapped positions are up to
+// OCCLUSION_MAX_SIZE << OCCLUSION_SUBPIXEL_BITS, and an edge function is a
+// sum of products of two of those, so this is as big as it can get.
+#define OCCLUSION_SUBPIXEL_BITS 4
+#define OCCLUSION_SUBPIXELS (1 << OCCLUSION_SUBPIXEL_BITS)
+#define OCCLUSION_MAX_SIZE 1024
+
+// NOTE[joe] A triangle clipped by the near plane, w, and the four sides of
+// the screen can pick up a corner at each one.
+#define OCCLUSION_MAX_CLIPPED_VERTICES 9
+#define OCCLUSION_MAX_CLIPPED_TRIANGLES (OCCLUSION_MAX_CLIPPED_VERTICES - 2)
+
+// NOTE[joe] Clip space w below this is treated as behind the eye.
+#define OCCLUSION_MIN_W 1e-5f
+
+// NOTE[joe] Occluder triangles are set up this many to a job, and tiles
+// rasterized and boxes tested this many to a job, at least.
+#define OCCLUSION_SETUP_CHUNK 256
+#define OCCLUSION_MIN_TILES 4
+#define OCCLUSION_MIN_BOXES 64
+
+// NOTE[joe] Room in the bins for each occluder triangle to cover this many
+// tiles, on average.
+#define OCCLUSION_BINS_PER_TRIANGLE 8
+
+/** A mesh to draw into the depth buffer this frame, and where it is.
+ * Vertices are a triangle list, the same as the renderer draws from. */
+typedef struct {
+    const vertex *Vertices;
+    unsigned int  TriangleCount;
+    // NOTE[joe] Where its triangles start, counting every occluder's.
+    unsigned int  FirstTriangle;
+    // NOTE[joe] From the mesh's space to clip space.
+    mat4          Transform;
+} occlusion_occluder;
+
+/** Something that might be drawn, if it isn't hidden. */
+typedef struct {
+    vec3 Min;
+    vec3 Max;
+    mat4 Transform;
+} occlusion_box;
+
+/** A triangle ready to rasterize. A pixel's in it if all three of its
+ * edge functions are at least zero at the pixel's centre. They're linear in
+ * the pixel, so are stored at pixel (0, 0), and by how much they change
+ * going one pixel across and one pixel down. Depth is the same. */
+typedef struct {
+    // NOTE[joe] Pixels, from Min up to but not including Max.
+    int   MinX;
+    int   MinY;
+    int   MaxX;
+    int   MaxY;
+    int   Edges[3];
+    int   EdgeStepX[3];
+    int   EdgeStepY[3];
+    float Depth;
+    float DepthStepX;
+    float DepthStepY;
+} occlusion_triangle;
+
+/** A box's pixels, from Min up to but not including Max, and the nearest
+ * its depth gets. */
+typedef struct {
+    int   MinX;
+    int   MinY;
+    int   MaxX;
+    int   MaxY;
+    float Depth;
+} occlusion_rect;
+
+typedef struct {
+    unsigned int        Width;
+    unsigned int        Height;
+    unsigned int        TileCountX;
+    unsigned int        TileCountY;
+
+    // NOTE[joe] Tile by tile, and row by row within a tile. Depth goes from
+    // zero at the near plane to one at the far plane, which is what it's
+    // cleared to, and the nearest thing at a pixel wins.
+    float              *Depths;
+    float              *TileMaxDepths;
+
+    unsigned int        MaxOccluderCount;
+    unsigned int        OccluderCount;
+    occlusion_occluder *Occluders;
+    unsigned int        TriangleCount;
+
+    // NOTE[joe] Room for every chunk's clipped triangles, each chunk's
+    // after the last. A chunk's triangles start at
+    // Chunk * OCCLUSION_SETUP_CHUNK * OCCLUSION_MAX_CLIPPED_TRIANGLES.
+    unsigned int        MaxTriangleCount;
+    occlusion_triangle *Triangles;
+    unsigned int       *ChunkCounts;
+
+    // NOTE[joe] Which triangles each tile has to draw, tile after tile, in
+    // the order they were added. Tile i's are [BinStarts[i], BinEnds[i]).
+    unsigned int        MaxBinnedCount;
+    unsigned int       *Bins;
+    unsigned int       *BinStarts;
+    unsigned int       *BinEnds;
+
+    // NOTE[joe] Triangles left out of a tile because the bins were full.
+    // Leaving an occluder out only ever hides less, never more.
+    unsigned int        DroppedCount;
+} occlusion_buffer;
+
+#endif
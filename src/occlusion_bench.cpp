@@ -0,0 +1,579 @@
+/**
+ * @file occlusion_bench.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the occlusion culling benchmarks, and the checks that
+ * keep it honest. A camera looks down a street of a city of box buildings,
+ * which are the occluders, at thousands of little props scattered between
+ * them, which are the boxes tested against them. The buffer is drawn and
+ * the props tested across the job system, and with every kernel the build
+ * can run on one thread. Every pixel of the buffer is checked against
+ * drawing each triangle over the whole screen from scratch, and every
+ * kernel has to agree on the buffer and on which props are hidden. Platform
+ * layers run them with --bench-occlusion, instead of the game, and exit with
+ * an error if any check fails.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "job.h"
+#include "occlusion.h"
+
+#define OCCLUSION_BENCH_WIDTH 256
+#define OCCLUSION_BENCH_HEIGHT 144
+#define OCCLUSION_BENCH_RUNS 16
+
+// NOTE[joe] A grid of blocks, a building on each, and the props scattered
+// across the lot.
+#define OCCLUSION_BENCH_BLOCKS 16
+#define OCCLUSION_BENCH_BLOCK_SIZE 12.0f
+#define OCCLUSION_BENCH_PROPS 16384
+
+#define OCCLUSION_BENCH_CUBE_VERTICES 36
+
+// NOTE[joe] How far apart depths can be and still be the same, since the
+// reference works them out a different way.
+#define OCCLUSION_BENCH_DEPTH_TOLERANCE 1e-4f
+
+typedef struct {
+    memory_arena      Arena;
+    occlusion_buffer  Buffer;
+    mat4              ViewProjection;
+    vertex            Cube[OCCLUSION_BENCH_CUBE_VERTICES];
+    vertex            Ground[6];
+    unsigned int      BuildingCount;
+    mat4             *Buildings;
+    occlusion_box    *Props;
+    unsigned char    *IsVisible;
+    float            *Reference;
+    unsigned int      Random;
+} occlusion_bench_data;
+
+static
+float OcclusionBenchRandom(occlusion_bench_data *Data, float Low, float High)
+{
+    Data->Random ^= Data->Random << 13;
+    Data->Random ^= Data->Random >> 17;
+    Data->Random ^= Data->Random << 5;
+
+    return Low + (High - Low) * (float)(Data->Random & 0xFFFFFF) / 16777216.0f;
+}
+
+/** A cube from -1 to 1, as a triangle list. */
+static
+void BuildOcclusionBenchCube(vertex *Vertices)
+{
+    unsigned int Count = 0;
+
+    for (unsigned int Axis = 0; Axis < 3; Axis++)
+    {
+        for (unsigned int Side = 0; Side < 2; Side++)
+        {
+            float Corners[4][3];
+
+            for (unsigned int i = 0; i < 4; i++)
+            {
+                Corners[i][Axis] = Side ? 1.0f : -1.0f;
+                Corners[i][(Axis + 1) % 3] = (i == 1 || i == 2) ? 1.0f : -1.0f;
+                Corners[i][(Axis + 2) % 3] = i >= 2 ? 1.0f : -1.0f;
+            }
+
+            unsigned int Order[6] = { 0, 1, 2, 0, 2, 3 };
+
+            for (unsigned int i = 0; i < 6; i++)
+            {
+                float *Corner = Corners[Order[i]];
+                Vertices[Count++] = { Corner[0], Corner[1], Corner[2], 1.0f };
+            }
+        }
+    }
+}
+
+/** The depth at pixel (X, Y), wherever its tile keeps it. */
+static
+float GetOcclusionBenchDepth(const occlusion_buffer *Buffer,
+                             unsigned int X,
+                             unsigned int Y)
+{
+    unsigned int Tile = (Y / OCCLUSION_TILE_HEIGHT) * Buffer->TileCountX +
+                        X / OCCLUSION_TILE_WIDTH;
+
+    return Buffer->Depths[Tile * OCCLUSION_TILE_SIZE +
+                          (Y % OCCLUSION_TILE_HEIGHT) * OCCLUSION_TILE_WIDTH +
+                          X % OCCLUSION_TILE_WIDTH];
+}
+
+/** Whether pixel centre (X, Y), in subpixels, is inside the edge from From
+ * to To, with corners going the positive way round. Centres on the edge are
+ * in if it's a top or left edge. */
+static
+bool IsOcclusionBenchInside(occlusion_vertex From,
+                            occlusion_vertex To,
+                            long long X,
+                            long long Y)
+{
+    long long Edge = (long long)(To.X - From.X) * (Y - From.Y) -
+                     (long long)(To.Y - From.Y) * (X - From.X);
+
+    if (Edge != 0)
+    {
+        return Edge > 0;
+    }
+
+    return To.Y < From.Y || (To.Y == From.Y && To.X > From.X);
+}
+
+/** Draws every occluder into Reference, a plain row by row buffer, testing
+ * every pixel of the screen against every triangle. It shares clipping and
+ * snapping with the real thing, and nothing after that. */
+static
+void RasterizeOcclusionBenchReference(occlusion_bench_data *Data)
+{
+    occlusion_buffer *Buffer = &Data->Buffer;
+    unsigned int Width = Buffer->Width;
+    unsigned int Height = Buffer->Height;
+
+    for (unsigned int i = 0; i < Width * Height; i++)
+    {
+        Data->Reference[i] = 1.0f;
+    }
+
+    for (unsigned int o = 0; o < Buffer->OccluderCount; o++)
+    {
+        const occlusion_occluder *Occluder = &Buffer->Occluders[o];
+
+        for (unsigned int t = 0; t < Occluder->TriangleCount; t++)
+        {
+            occlusion_vertex Polygon[OCCLUSION_MAX_CLIPPED_VERTICES];
+            unsigned int Count =
+                ProjectOcclusionTriangle(Buffer, Occluder, t, Polygon);
+
+            for (unsigned int i = 1; i + 1 < Count; i++)
+            {
+                occlusion_vertex A = Polygon[0];
+                occlusion_vertex B = Polygon[i];
+                occlusion_vertex C = Polygon[i + 1];
+
+                long long Area = (long long)(B.X - A.X) * (C.Y - A.Y) -
+                                 (long long)(B.Y - A.Y) * (C.X - A.X);
+
+                if (Area == 0)
+                {
+                    continue;
+                }
+
+                if (Area < 0)
+                {
+                    occlusion_vertex Swap = B;
+                    B = C;
+                    C = Swap;
+                    Area = -Area;
+                }
+
+                for (unsigned int y = 0; y < Height; y++)
+                {
+                    for (unsigned int x = 0; x < Width; x++)
+                    {
+                        long long X = x * OCCLUSION_SUBPIXELS +
+                                      OCCLUSION_SUBPIXELS / 2;
+                        long long Y = y * OCCLUSION_SUBPIXELS +
+                                      OCCLUSION_SUBPIXELS / 2;
+
+                        if (!IsOcclusionBenchInside(A, B, X, Y) ||
+                            !IsOcclusionBenchInside(B, C, X, Y) ||
+                            !IsOcclusionBenchInside(C, A, X, Y))
+                        {
+                            continue;
+                        }
+
+                        // NOTE[joe] Each corner's weight is the area of the
+                        // triangle across from it.
+                        double WeightA =
+                            (double)((long long)(C.X - B.X) * (Y - B.Y) -
+                                     (long long)(C.Y - B.Y) * (X - B.X));
+                        double WeightB =
+                            (double)((long long)(A.X - C.X) * (Y - C.Y) -
+                                     (long long)(A.Y - C.Y) * (X - C.X));
+                        double WeightC = (double)Area - WeightA - WeightB;
+
+                        float Depth = (float)((WeightA * A.Depth +
+                                               WeightB * B.Depth +
+                                               WeightC * C.Depth) /
+                                              (double)Area);
+
+                        float *Pixel = &Data->Reference[y * Width + x];
+                        *Pixel = Depth < *Pixel ? Depth : *Pixel;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/** Checks every pixel of the buffer against the reference. */
+static
+bool CheckOcclusionBenchReference(occlusion_bench_data *Data)
+{
+    occlusion_buffer *Buffer = &Data->Buffer;
+
+    unsigned int WrongCount = 0;
+    unsigned int CoveredCount = 0;
+
+    for (unsigned int y = 0; y < Buffer->Height; y++)
+    {
+        for (unsigned int x = 0; x < Buffer->Width; x++)
+        {
+            float Reference = Data->Reference[y * Buffer->Width + x];
+            float Depth = GetOcclusionBenchDepth(Buffer, x, y);
+
+            CoveredCount += Reference < 1.0f;
+
+            if (fabsf(Depth - Reference) > OCCLUSION_BENCH_DEPTH_TOLERANCE)
+            {
+                WrongCount++;
+            }
+        }
+    }
+
+    printf("occlusion_covered_pixels %u/%u\n",
+           CoveredCount,
+           Buffer->Width * Buffer->Height);
+    printf("occlusion_wrong_pixels %u\n", WrongCount);
+
+    return WrongCount == 0;
+}
+
+/** Whether any pixel of Rect is as far as its depth or farther, looking at
+ * every one. */
+static
+bool IsOcclusionBenchRectVisible(const occlusion_buffer *Buffer,
+                                 const occlusion_rect *Rect)
+{
+    for (int y = Rect->MinY; y < Rect->MaxY; y++)
+    {
+        for (int x = Rect->MinX; x < Rect->MaxX; x++)
+        {
+            if (GetOcclusionBenchDepth(Buffer, x, y) >= Rect->Depth)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/** The city's occluders, for this frame. */
+static
+void AddOcclusionBenchOccluders(occlusion_bench_data *Data)
+{
+    occlusion_buffer *Buffer = &Data->Buffer;
+
+    BeginOcclusion(Buffer);
+
+    AddOccluder(Buffer, Data->Ground, 6, &Data->ViewProjection);
+
+    for (unsigned int i = 0; i < Data->BuildingCount; i++)
+    {
+        AddOccluder(Buffer,
+                    Data->Cube,
+                    OCCLUSION_BENCH_CUBE_VERTICES,
+                    &Data->Buildings[i]);
+    }
+}
+
+/** Times drawing the buffer and testing every prop with backend's kernels
+ * on one thread, and checks they draw what the game's kernels did across
+ * the job system, and test props the same as looking at every pixel. */
+template <typename backend>
+static
+bool BenchmarkOcclusionBackend(occlusion_bench_data *Data,
+                               const float *Depths)
+{
+    occlusion_buffer *Buffer = &Data->Buffer;
+    unsigned int TileCount = Buffer->TileCountX * Buffer->TileCountY;
+    unsigned int ChunkCount =
+        (Buffer->TriangleCount + OCCLUSION_SETUP_CHUNK - 1) /
+        OCCLUSION_SETUP_CHUNK;
+
+    double BestRaster = 1e9;
+    double BestTest = 1e9;
+    bool IsSame = true;
+
+    for (unsigned int Run = 0; Run < OCCLUSION_BENCH_RUNS; Run++)
+    {
+        AddOcclusionBenchOccluders(Data);
+
+        double Begin = PlatformGetTime();
+
+        SetupOcclusionJob(Buffer, 0, ChunkCount);
+        BinOcclusionTriangles(Buffer);
+        RasterizeOcclusionWith<backend>(Buffer, 0, TileCount);
+
+        double Time = PlatformGetTime() - Begin;
+        BestRaster = Time < BestRaster ? Time : BestRaster;
+
+        Begin = PlatformGetTime();
+
+        for (unsigned int i = 0; i < OCCLUSION_BENCH_PROPS; i++)
+        {
+            occlusion_rect Rect = GetOcclusionRect(Buffer, &Data->Props[i]);
+            Data->IsVisible[i] =
+                IsOcclusionRectVisibleWith<backend>(Buffer, &Rect);
+        }
+
+        Time = PlatformGetTime() - Begin;
+        BestTest = Time < BestTest ? Time : BestTest;
+    }
+
+    // NOTE[joe] Kernels work depth out the same way, but a compiler's free
+    // to fuse the scalar one's multiply and add, so they only have to agree
+    // as closely as they have to agree with the reference.
+    for (unsigned int i = 0; i < Buffer->Width * Buffer->Height; i++)
+    {
+        if (fabsf(Buffer->Depths[i] - Depths[i]) >
+            OCCLUSION_BENCH_DEPTH_TOLERANCE)
+        {
+            IsSame = false;
+        }
+    }
+
+    /** On its own buffer, it has to agree with looking at every pixel. */
+
+    unsigned int CulledCount = 0;
+
+    for (unsigned int i = 0; i < OCCLUSION_BENCH_PROPS; i++)
+    {
+        occlusion_rect Rect = GetOcclusionRect(Buffer, &Data->Props[i]);
+
+        if ((bool)Data->IsVisible[i] !=
+            IsOcclusionBenchRectVisible(Buffer, &Rect))
+        {
+            IsSame = false;
+        }
+
+        CulledCount += !Data->IsVisible[i];
+    }
+
+    printf("occlusion_%s_same %d\n", backend::Name, IsSame ? 1 : 0);
+    printf("occlusion_%s_culled %u\n", backend::Name, CulledCount);
+    printf("occlusion_%s_serial_raster_ms %.3f\n",
+           backend::Name,
+           BestRaster * 1000.0);
+    printf("occlusion_%s_serial_test_ms %.3f\n",
+           backend::Name,
+           BestTest * 1000.0);
+    printf("occlusion_%s_serial_boxes_per_ms %.0f\n",
+           backend::Name,
+           OCCLUSION_BENCH_PROPS / (BestTest * 1000.0));
+
+    return IsSame;
+}
+
+/** Runs every occlusion check and benchmark and prints the results.
+ * Returns false if anything was drawn or tested wrong. */
+static
+bool BenchmarkOcclusion()
+{
+    occlusion_bench_data *Data = new occlusion_bench_data;
+    Data->Random = 0x2F6B3A91;
+
+    unsigned int CoreCount = PlatformGetCoreCount();
+
+    job_system *Jobs = new job_system;
+
+    InitializeJobSystem(Jobs, CoreCount);
+
+    printf("occlusion_backend %s\n", occlusion_backend::Name);
+    printf("occlusion_threads %u\n", CoreCount);
+
+    InitializeArena(&Data->Arena, GIGABYTES(1), "Occlusion benchmark");
+
+    /** A camera at head height, looking down a street and a little up. */
+
+    float Aspect = (float)OCCLUSION_BENCH_WIDTH / OCCLUSION_BENCH_HEIGHT;
+
+    Data->ViewProjection =
+        Perspective(1.1f, Aspect, 0.5f, 1000.0f) *
+        LookAt(vec3 { 1.5f, 1.7f, -100.0f },
+               vec3 { 12.0f, 6.0f, 0.0f },
+               vec3 { 0.0f, 1.0f, 0.0f });
+
+    BuildOcclusionBenchCube(Data->Cube);
+
+    float Extent = OCCLUSION_BENCH_BLOCKS * OCCLUSION_BENCH_BLOCK_SIZE;
+    vec3 GroundCorners[4] = {
+        { -Extent, 0.0f, -Extent },
+        {  Extent, 0.0f, -Extent },
+        {  Extent, 0.0f,  Extent },
+        { -Extent, 0.0f,  Extent }
+    };
+    unsigned int GroundOrder[6] = { 0, 1, 2, 0, 2, 3 };
+
+    for (unsigned int i = 0; i < 6; i++)
+    {
+        vec3 Corner = GroundCorners[GroundOrder[i]];
+        Data->Ground[i] = { Corner.x, Corner.y, Corner.z, 1.0f };
+    }
+
+    /** A building on each block, either side of streets along x = 0. */
+
+    float Half = 0.5f * OCCLUSION_BENCH_BLOCK_SIZE;
+    float Start = -0.5f * OCCLUSION_BENCH_BLOCKS * OCCLUSION_BENCH_BLOCK_SIZE;
+
+    Data->BuildingCount = OCCLUSION_BENCH_BLOCKS * OCCLUSION_BENCH_BLOCKS;
+    Data->Buildings = PushArray(&Data->Arena, mat4, Data->BuildingCount);
+
+    for (unsigned int z = 0; z < OCCLUSION_BENCH_BLOCKS; z++)
+    {
+        for (unsigned int x = 0; x < OCCLUSION_BENCH_BLOCKS; x++)
+        {
+            vec3 Size = {
+                OcclusionBenchRandom(Data, 2.0f, Half - 1.0f),
+                OcclusionBenchRandom(Data, 3.0f, 30.0f),
+                OcclusionBenchRandom(Data, 2.0f, Half - 1.0f)
+            };
+            vec3 Center = {
+                Start + (x + 0.5f) * OCCLUSION_BENCH_BLOCK_SIZE,
+                Size.y,
+                Start + (z + 0.5f) * OCCLUSION_BENCH_BLOCK_SIZE
+            };
+
+            Data->Buildings[z * OCCLUSION_BENCH_BLOCKS + x] =
+                Data->ViewProjection * Mat4Translation(Center) *
+                Mat4Scale(Size);
+        }
+    }
+
+    /** Props anywhere, some of them in the buildings. */
+
+    Data->Props = PushArray(&Data->Arena, occlusion_box, OCCLUSION_BENCH_PROPS);
+    Data->IsVisible =
+        PushArray(&Data->Arena, unsigned char, OCCLUSION_BENCH_PROPS);
+
+    for (unsigned int i = 0; i < OCCLUSION_BENCH_PROPS; i++)
+    {
+        float Size = OcclusionBenchRandom(Data, 0.2f, 0.6f);
+        vec3 Position = {
+            OcclusionBenchRandom(Data, Start, -Start),
+            0.0f,
+            OcclusionBenchRandom(Data, Start, -Start)
+        };
+
+        occlusion_box *Prop = &Data->Props[i];
+        Prop->Min = { -Size, 0.0f, -Size };
+        Prop->Max = { Size, 2.0f * Size, Size };
+        Prop->Transform = Data->ViewProjection * Mat4Translation(Position);
+    }
+
+    unsigned int TriangleCount =
+        2 + Data->BuildingCount * OCCLUSION_BENCH_CUBE_VERTICES / 3;
+
+    InitializeOcclusion(&Data->Buffer,
+                        &Data->Arena,
+                        OCCLUSION_BENCH_WIDTH,
+                        OCCLUSION_BENCH_HEIGHT,
+                        Data->BuildingCount + 1,
+                        TriangleCount);
+
+    occlusion_buffer *Buffer = &Data->Buffer;
+    unsigned int PixelCount = Buffer->Width * Buffer->Height;
+
+    /** The game's kernels, across the job system. */
+
+    double BestRaster = 1e9;
+    double BestTest = 1e9;
+
+    for (unsigned int Run = 0; Run < OCCLUSION_BENCH_RUNS; Run++)
+    {
+        AddOcclusionBenchOccluders(Data);
+
+        double Begin = PlatformGetTime();
+
+        RenderOcclusion(Buffer, Jobs);
+
+        double Time = PlatformGetTime() - Begin;
+        BestRaster = Time < BestRaster ? Time : BestRaster;
+
+        Begin = PlatformGetTime();
+
+        TestOcclusionBoxes(Buffer,
+                           Jobs,
+                           Data->Props,
+                           OCCLUSION_BENCH_PROPS,
+                           Data->IsVisible);
+
+        Time = PlatformGetTime() - Begin;
+        BestTest = Time < BestTest ? Time : BestTest;
+    }
+
+    unsigned int CulledCount = 0;
+    unsigned int OffscreenCount = 0;
+
+    for (unsigned int i = 0; i < OCCLUSION_BENCH_PROPS; i++)
+    {
+        occlusion_rect Rect = GetOcclusionRect(Buffer, &Data->Props[i]);
+
+        CulledCount += !Data->IsVisible[i];
+        OffscreenCount += Rect.MinX >= Rect.MaxX || Rect.MinY >= Rect.MaxY;
+    }
+
+    unsigned int ChunkCount =
+        (TriangleCount + OCCLUSION_SETUP_CHUNK - 1) / OCCLUSION_SETUP_CHUNK;
+    unsigned int SetupCount = 0;
+
+    for (unsigned int i = 0; i < ChunkCount; i++)
+    {
+        SetupCount += Buffer->ChunkCounts[i];
+    }
+
+    printf("occlusion_size %ux%u\n", Buffer->Width, Buffer->Height);
+    printf("occlusion_occluder_triangles %u\n", Buffer->TriangleCount);
+    printf("occlusion_setup_triangles %u\n", SetupCount);
+    printf("occlusion_binned_triangles %u\n",
+           Buffer->BinEnds[Buffer->TileCountX * Buffer->TileCountY - 1]);
+    printf("occlusion_dropped_triangles %u\n", Buffer->DroppedCount);
+    printf("occlusion_raster_ms %.3f\n", BestRaster * 1000.0);
+    printf("occlusion_test_ms %.3f\n", BestTest * 1000.0);
+    printf("occlusion_culled %u/%u\n", CulledCount, OCCLUSION_BENCH_PROPS);
+    printf("occlusion_offscreen %u\n", OffscreenCount);
+    printf("occlusion_culled_per_ms %.0f\n", CulledCount / (BestTest * 1000.0));
+    printf("occlusion_boxes_per_ms %.0f\n",
+           OCCLUSION_BENCH_PROPS / (BestTest * 1000.0));
+
+    bool IsCorrect = Buffer->DroppedCount == 0;
+
+    /** Keep what they drew, for the rest to match. */
+
+    float *Depths = PushArray(&Data->Arena, float, PixelCount);
+    memcpy(Depths, Buffer->Depths, sizeof(float) * PixelCount);
+
+    Data->Reference = PushArray(&Data->Arena, float, PixelCount);
+
+    RasterizeOcclusionBenchReference(Data);
+
+    IsCorrect &= CheckOcclusionBenchReference(Data);
+
+    IsCorrect &= BenchmarkOcclusionBackend<math_scalar>(Data, Depths);
+
+#if MATH_HAS_SSE
+    IsCorrect &= BenchmarkOcclusionBackend<math_sse>(Data, Depths);
+#endif
+
+#if MATH_HAS_AVX2
+    IsCorrect &= BenchmarkOcclusionBackend<math_avx2>(Data, Depths);
+#endif
+
+    ReleaseArena(&Data->Arena);
+
+    ShutdownJobSystem(Jobs);
+
+    delete Jobs;
+
+    printf("occlusion_correct %d\n", IsCorrect ? 1 : 0);
+
+    delete Data;
+
+    return IsCorrect;
+}
@@ -0,0 +1,584 @@
+/**
+ * @file particles.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains our GPU particles: the buffers they live in, the compute
+ * passes that emit and move them, and their draw. See particles.h.
+ */
+
+#include "platform.h"
+#include "render.h"
+#include "particles.h"
+
+// NOTE[joe] 128 bytes of push constants is all every device guarantees.
+static_assert(sizeof(particle_simulate_constants) == 128,
+              "particle push constants are the wrong size");
+
+// NOTE[joe] Nothing checks these against the shaders when they're built, so
+// the offsets they depend on are checked here instead.
+static_assert(sizeof(particle) == 32, "particle doesn't match std430");
+static_assert(offsetof(particle_args, Draw) == 16,
+              "particle_args doesn't match particle_finalize.comp");
+static_assert(offsetof(particle_draw_constants, Frame) == 72,
+              "particle_draw_constants doesn't match particle.vert");
+
+/** Creates a device local buffer of Size bytes and starts tracking it. Its
+ * memory goes in Memory. */
+static
+VkBuffer CreateParticleBuffer(vulkan_context *Context,
+                              VkDeviceSize Size,
+                              VkBufferUsageFlags Usage,
+                              VkDeviceMemory *Memory)
+{
+    VkBufferCreateInfo BufferInfo = {};
+    BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    BufferInfo.size = Size;
+    BufferInfo.usage = Usage |
+                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                       VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkBuffer Buffer;
+    VkResult Result = vkCreateBuffer(Context->Device,
+                                     &BufferInfo,
+                                     GetHostAllocator(Context, HOST_TAG_BUFFER),
+                                     &Buffer);
+
+    Assert(Result == VK_SUCCESS, "Failed to create particle buffer.\n");
+
+    *Memory = AllocateBufferMemory(Context,
+                                   Buffer,
+                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    TrackBuffer(&Context->Resources, Buffer);
+
+    return Buffer;
+}
+
+/** Eviction handler for the particles. They can't do with less, so if
+ * they're on Heap, every buffer goes and particles are turned off for good.
+ * Returns how much of Heap that freed. Budgets are only updated at the start
+ * of a frame, after the last one's fence, so the GPU is done with them. */
+static
+VkDeviceSize EvictParticles(unsigned int Heap, VkDeviceSize Bytes, void *Data)
+{
+    vulkan_context *Context = (vulkan_context *)Data;
+    particle_system *Particles = &Context->Particles;
+
+    if (!Particles->MaxCount)
+        return 0;
+
+    memory_allocation *Pool = FindDeviceMemory(Context, Particles->PoolMemory);
+
+    if (!Pool || GetDeviceMemoryHeap(Context, Pool) != Heap)
+        return 0;
+
+    VkBuffer Buffers[] = {
+        Particles->PoolBuffer,
+        Particles->DeadBuffer,
+        Particles->AliveBuffer,
+        Particles->CounterBuffer,
+        Particles->ArgsBuffer,
+    };
+
+    VkDeviceMemory Memories[] = {
+        Particles->PoolMemory,
+        Particles->DeadMemory,
+        Particles->AliveMemory,
+        Particles->CounterMemory,
+        Particles->ArgsMemory,
+    };
+
+    VkDeviceSize Freed = 0;
+
+    for (unsigned int i = 0; i < 5; i++)
+    {
+        memory_allocation *Allocation = FindDeviceMemory(Context, Memories[i]);
+
+        if (Allocation && GetDeviceMemoryHeap(Context, Allocation) == Heap)
+        {
+            Freed += Allocation->Size;
+        }
+
+        UntrackBuffer(&Context->Resources, Buffers[i]);
+
+        vkDestroyBuffer(Context->Device,
+                        Buffers[i],
+                        GetHostAllocator(Context, HOST_TAG_BUFFER));
+        FreeDeviceMemory(Context, Memories[i]);
+    }
+
+    // NOTE[joe] Everything that records particle work checks this first,
+    // so nothing touches the set or the buffers again.
+    Particles->MaxCount = 0;
+
+    PlatformLog("Evicted the particles, freeing %llu KB of heap %u.\n",
+                (unsigned long long)(Freed / 1024),
+                Heap);
+
+    return Freed;
+}
+
+/** Sets up MaxCount particles, all of them dead, and queues their first
+ * state's upload on the setup context. Arena is only used while this runs.
+ * Zero leaves particles off. */
+static
+void InitializeParticleSystem(vulkan_context *Context,
+                              memory_arena *Arena,
+                              unsigned int MaxCount)
+{
+    particle_system *Particles = &Context->Particles;
+
+    Assert(MaxCount <= PARTICLE_MAX_COUNT, "Too many particles.\n");
+
+    Particles->MaxCount = MaxCount;
+    Particles->Frame = 0;
+
+    if (!MaxCount)
+    {
+        return;
+    }
+
+    /** Create the buffers, and fill in where particles start. */
+
+    Particles->PoolBuffer =
+        CreateParticleBuffer(Context,
+                             MaxCount * sizeof(particle),
+                             0,
+                             &Particles->PoolMemory);
+    Particles->DeadBuffer =
+        CreateParticleBuffer(Context,
+                             MaxCount * sizeof(unsigned int),
+                             0,
+                             &Particles->DeadMemory);
+    Particles->AliveBuffer =
+        CreateParticleBuffer(Context,
+                             2 * MaxCount * sizeof(unsigned int),
+                             0,
+                             &Particles->AliveMemory);
+    Particles->CounterBuffer =
+        CreateParticleBuffer(Context,
+                             sizeof(particle_counters),
+                             0,
+                             &Particles->CounterMemory);
+    Particles->ArgsBuffer =
+        CreateParticleBuffer(Context,
+                             sizeof(particle_args),
+                             VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                             &Particles->ArgsMemory);
+
+    // NOTE[joe] Particles are only eye candy, so they're the first thing to
+    // go when a heap runs short.
+    RegisterEvictionHandler(Context, EvictParticles, Context);
+
+    // NOTE[joe] Emitting pops from the end, so lower particles get used
+    // first.
+    arena_temp Temp = BeginArenaTemp(Arena);
+
+    unsigned int *Dead = PushArray(Arena, unsigned int, MaxCount);
+
+    for (unsigned int i = 0; i < MaxCount; i++)
+    {
+        Dead[i] = MaxCount - 1 - i;
+    }
+
+    UploadToBuffer(Context,
+                   Particles->DeadBuffer,
+                   0,
+                   Dead,
+                   MaxCount * sizeof(unsigned int));
+
+    EndArenaTemp(Temp);
+
+    particle_counters Counters = {};
+    Counters.DeadCount = (int)MaxCount;
+
+    UploadToBuffer(Context,
+                   Particles->CounterBuffer,
+                   0,
+                   &Counters,
+                   sizeof(Counters));
+
+    particle_args Args = {};
+    Args.Simulate = { 0, 1, 1 };
+    Args.Draw.vertexCount = 6;
+
+    UploadToBuffer(Context,
+                   Particles->ArgsBuffer,
+                   0,
+                   &Args,
+                   sizeof(Args));
+
+    /** Get at the depth buffer, for collisions. */
+
+    const VkAllocationCallbacks *ImageAllocator =
+        GetHostAllocator(Context, HOST_TAG_IMAGE);
+
+    VkImageViewCreateInfo ViewInfo = {};
+    ViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    ViewInfo.image = Context->DepthImage;
+    ViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    ViewInfo.format = Context->DepthFormat;
+    ViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    ViewInfo.subresourceRange.levelCount = 1;
+    ViewInfo.subresourceRange.layerCount = 1;
+
+    VkResult Result = vkCreateImageView(Context->Device,
+                                        &ViewInfo,
+                                        ImageAllocator,
+                                        &Particles->DepthView);
+
+    Assert(Result == VK_SUCCESS, "Failed to create particle depth view.\n");
+
+    // NOTE[joe] Only ever read with texelFetch(), so filtering doesn't
+    // matter, but a sampled image has to come with a sampler.
+    VkSamplerCreateInfo SamplerInfo = {};
+    SamplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    SamplerInfo.magFilter = VK_FILTER_NEAREST;
+    SamplerInfo.minFilter = VK_FILTER_NEAREST;
+    SamplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    SamplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    SamplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    SamplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+
+    Result = vkCreateSampler(Context->Device,
+                             &SamplerInfo,
+                             ImageAllocator,
+                             &Particles->DepthSampler);
+
+    Assert(Result == VK_SUCCESS, "Failed to create particle depth sampler.\n");
+
+    /** Describe it all to the shaders. The pool and the alive lists are
+     * read by the draw too. */
+
+    VkDescriptorSetLayoutBinding Bindings[6] = {};
+
+    for (unsigned int i = 0; i < 6; i++)
+    {
+        Bindings[i].binding = i;
+        Bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        Bindings[i].descriptorCount = 1;
+        Bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    Bindings[0].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT;
+    Bindings[2].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT;
+    Bindings[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+    VkDescriptorSetLayoutCreateInfo SetLayoutInfo = {};
+    SetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    SetLayoutInfo.bindingCount = 6;
+    SetLayoutInfo.pBindings = Bindings;
+
+    const VkAllocationCallbacks *Allocator =
+        GetHostAllocator(Context, HOST_TAG_PIPELINE);
+
+    Result = vkCreateDescriptorSetLayout(Context->Device,
+                                         &SetLayoutInfo,
+                                         Allocator,
+                                         &Particles->SetLayout);
+
+    Assert(Result == VK_SUCCESS, "Failed to create particle set layout.\n");
+
+    VkDescriptorPoolSize PoolSizes[2] = {};
+    PoolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    PoolSizes[0].descriptorCount = 5;
+    PoolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    PoolSizes[1].descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo PoolInfo = {};
+    PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    PoolInfo.maxSets = 1;
+    PoolInfo.poolSizeCount = 2;
+    PoolInfo.pPoolSizes = PoolSizes;
+
+    Result = vkCreateDescriptorPool(Context->Device,
+                                    &PoolInfo,
+                                    Allocator,
+                                    &Particles->DescriptorPool);
+
+    Assert(Result == VK_SUCCESS, "Failed to create particle descriptors.\n");
+
+    VkDescriptorSetAllocateInfo SetInfo = {};
+    SetInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    SetInfo.descriptorPool = Particles->DescriptorPool;
+    SetInfo.descriptorSetCount = 1;
+    SetInfo.pSetLayouts = &Particles->SetLayout;
+
+    Result = vkAllocateDescriptorSets(Context->Device,
+                                      &SetInfo,
+                                      &Particles->DescriptorSet);
+
+    Assert(Result == VK_SUCCESS, "Failed to allocate particle descriptors.\n");
+
+    // NOTE[joe] Nothing here ever changes, so the set is written once.
+    VkDescriptorBufferInfo BufferInfos[5] = {
+        { Particles->PoolBuffer, 0, VK_WHOLE_SIZE },
+        { Particles->DeadBuffer, 0, VK_WHOLE_SIZE },
+        { Particles->AliveBuffer, 0, VK_WHOLE_SIZE },
+        { Particles->CounterBuffer, 0, VK_WHOLE_SIZE },
+        { Particles->ArgsBuffer, 0, VK_WHOLE_SIZE },
+    };
+
+    VkDescriptorImageInfo DepthInfo = {};
+    DepthInfo.sampler = Particles->DepthSampler;
+    DepthInfo.imageView = Particles->DepthView;
+    DepthInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet Writes[6] = {};
+
+    for (unsigned int i = 0; i < 6; i++)
+    {
+        Writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        Writes[i].dstSet = Particles->DescriptorSet;
+        Writes[i].dstBinding = i;
+        Writes[i].descriptorCount = 1;
+        Writes[i].descriptorType = Bindings[i].descriptorType;
+
+        if (i < 5)
+        {
+            Writes[i].pBufferInfo = &BufferInfos[i];
+        }
+        else
+        {
+            Writes[i].pImageInfo = &DepthInfo;
+        }
+    }
+
+    vkUpdateDescriptorSets(Context->Device, 6, Writes, 0, 0);
+
+    /** The emitter goes in through push constants, which differ between
+     * the compute passes and the draw. */
+
+    VkPushConstantRange ComputeRange = {};
+    ComputeRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    ComputeRange.size = sizeof(particle_simulate_constants);
+
+    VkPipelineLayoutCreateInfo LayoutInfo = {};
+    LayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    LayoutInfo.setLayoutCount = 1;
+    LayoutInfo.pSetLayouts = &Particles->SetLayout;
+    LayoutInfo.pushConstantRangeCount = 1;
+    LayoutInfo.pPushConstantRanges = &ComputeRange;
+
+    Result = vkCreatePipelineLayout(Context->Device,
+                                    &LayoutInfo,
+                                    Allocator,
+                                    &Particles->ComputeLayout);
+
+    Assert(Result == VK_SUCCESS, "Failed to create particle compute layout.\n");
+
+    VkPushConstantRange DrawRange = {};
+    DrawRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    DrawRange.size = sizeof(particle_draw_constants);
+
+    LayoutInfo.pPushConstantRanges = &DrawRange;
+
+    Result = vkCreatePipelineLayout(Context->Device,
+                                    &LayoutInfo,
+                                    Allocator,
+                                    &Particles->DrawLayout);
+
+    Assert(Result == VK_SUCCESS, "Failed to create particle draw layout.\n");
+
+    /** Describe the draw. Its shaders are filled in once they've loaded. */
+
+    // NOTE[joe] Particles are tested against the depth buffer but don't
+    // write to it, or they'd collide with each other next frame.
+    pipeline_desc *Draw = &Particles->DrawPipeline;
+    Draw->Layout = Particles->DrawLayout;
+    Draw->IsVertexPulled = true;
+    Draw->Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    Draw->PolygonMode = VK_POLYGON_MODE_FILL;
+    Draw->CullMode = VK_CULL_MODE_NONE;
+    Draw->FrontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    Draw->DepthTestEnable = true;
+    Draw->DepthWriteEnable = false;
+    Draw->DepthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+}
+
+/** Creates one of the particle compute pipelines from Shader. */
+static
+VkPipeline CreateParticlePipeline(vulkan_context *Context,
+                                  VkShaderModule Shader)
+{
+    VkComputePipelineCreateInfo PipelineInfo = {};
+    PipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    PipelineInfo.stage.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    PipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    PipelineInfo.stage.module = Shader;
+    PipelineInfo.stage.pName = "main";
+    PipelineInfo.layout = Context->Particles.ComputeLayout;
+
+    VkPipeline Pipeline;
+    VkResult Result =
+        vkCreateComputePipelines(Context->Device,
+                                 Context->Pipelines.Cache,
+                                 1,
+                                 &PipelineInfo,
+                                 GetHostAllocator(Context, HOST_TAG_PIPELINE),
+                                 &Pipeline);
+
+    Assert(Result == VK_SUCCESS, "Failed to create particle pipeline.\n");
+
+    return Pipeline;
+}
+
+/** Flushes whatever the next particle pass is waiting on, and binds its
+ * Pipeline. */
+static
+void BeginParticlePass(vulkan_context *Context,
+                       VkCommandBuffer CommandBuffer,
+                       VkPipeline Pipeline)
+{
+    FlushBarriers(&Context->Resources, CommandBuffer);
+
+    vkCmdBindPipeline(CommandBuffer,
+                      VK_PIPELINE_BIND_POINT_COMPUTE,
+                      Pipeline);
+}
+
+/** Moves every particle, then emits Emitter's new ones, recording both into
+ * CommandBuffer. Has to come before the render pass, which clears the depth
+ * buffer particles collide with. Leaves the pool, the alive lists and the
+ * draw's arguments for the caller to transition for DrawParticles(). */
+static
+void RecordParticles(vulkan_context *Context,
+                     VkCommandBuffer CommandBuffer,
+                     const particle_emitter *Emitter)
+{
+    particle_system *Particles = &Context->Particles;
+    resource_tracker *Resources = &Context->Resources;
+
+    unsigned int EmitCount = Emitter->EmitCount < Particles->MaxCount ?
+                             Emitter->EmitCount : Particles->MaxCount;
+
+    particle_simulate_constants Constants;
+    Constants.Transform = Emitter->Transform;
+    Constants.Position = Emitter->Position;
+    Constants.Spread = Emitter->Spread;
+    Constants.Velocity = Emitter->Velocity;
+    Constants.Jitter = Emitter->Jitter;
+    Constants.Gravity = Emitter->Gravity;
+    Constants.Drag = Emitter->Drag;
+    Constants.Dt = Emitter->Dt;
+    Constants.Lifetime = Emitter->Lifetime;
+    Constants.EmitCount = EmitCount;
+    Constants.Frame = Particles->Frame;
+
+    // NOTE[joe] Every pass shares one layout, so the set and the constants
+    // only have to be bound once.
+    vkCmdBindDescriptorSets(CommandBuffer,
+                            VK_PIPELINE_BIND_POINT_COMPUTE,
+                            Particles->ComputeLayout,
+                            0,
+                            1, &Particles->DescriptorSet,
+                            0, 0);
+    vkCmdPushConstants(CommandBuffer,
+                       Particles->ComputeLayout,
+                       VK_SHADER_STAGE_COMPUTE_BIT,
+                       0,
+                       sizeof(Constants),
+                       &Constants);
+
+    /** Simulate, as many groups as there were particles alive. */
+
+    UseBuffer(Resources, Particles->ArgsBuffer, RESOURCE_USAGE_INDIRECT_BUFFER);
+    UseBuffer(Resources, Particles->PoolBuffer, RESOURCE_USAGE_COMPUTE_WRITE);
+    UseBuffer(Resources, Particles->DeadBuffer, RESOURCE_USAGE_COMPUTE_WRITE);
+    UseBuffer(Resources, Particles->AliveBuffer, RESOURCE_USAGE_COMPUTE_WRITE);
+    UseBuffer(Resources,
+              Particles->CounterBuffer,
+              RESOURCE_USAGE_COMPUTE_WRITE);
+    UseImage(Resources, Context->DepthImage, RESOURCE_USAGE_COMPUTE_SAMPLED);
+
+    BeginParticlePass(Context, CommandBuffer, Particles->SimulatePipeline);
+
+    vkCmdDispatchIndirect(CommandBuffer,
+                          Particles->ArgsBuffer,
+                          offsetof(particle_args, Simulate));
+
+    /** Emit, which can reuse anything simulating just killed. */
+
+    if (EmitCount)
+    {
+        UseBuffer(Resources,
+                  Particles->PoolBuffer,
+                  RESOURCE_USAGE_COMPUTE_WRITE);
+        UseBuffer(Resources,
+                  Particles->DeadBuffer,
+                  RESOURCE_USAGE_COMPUTE_WRITE);
+        UseBuffer(Resources,
+                  Particles->AliveBuffer,
+                  RESOURCE_USAGE_COMPUTE_WRITE);
+        UseBuffer(Resources,
+                  Particles->CounterBuffer,
+                  RESOURCE_USAGE_COMPUTE_WRITE);
+
+        BeginParticlePass(Context, CommandBuffer, Particles->EmitPipeline);
+
+        vkCmdDispatch(CommandBuffer,
+                      (EmitCount + PARTICLE_GROUP_SIZE - 1) /
+                      PARTICLE_GROUP_SIZE,
+                      1,
+                      1);
+    }
+
+    /** Write this frame's draw and next frame's simulate. */
+
+    UseBuffer(Resources,
+              Particles->CounterBuffer,
+              RESOURCE_USAGE_COMPUTE_WRITE);
+    UseBuffer(Resources, Particles->ArgsBuffer, RESOURCE_USAGE_COMPUTE_WRITE);
+
+    BeginParticlePass(Context, CommandBuffer, Particles->FinalizePipeline);
+
+    vkCmdDispatch(CommandBuffer, 1, 1, 1);
+}
+
+/** Draws every live particle, inside the render pass, after RecordParticles()
+ * has recorded this frame's passes. */
+static
+void DrawParticles(vulkan_context *Context,
+                   VkCommandBuffer CommandBuffer,
+                   const particle_emitter *Emitter)
+{
+    particle_system *Particles = &Context->Particles;
+
+    // NOTE[joe] Size is half a particle's width; its height is scaled so
+    // that it comes out square on screen.
+    particle_draw_constants Constants = {};
+    Constants.Transform = Emitter->Transform;
+    Constants.Size = {
+        Emitter->Size,
+        Emitter->Size * (float)Context->Width / (float)Context->Height
+    };
+    Constants.Frame = Particles->Frame;
+
+    BindPipeline(Context, CommandBuffer, &Particles->DrawPipeline);
+
+    vkCmdBindDescriptorSets(CommandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            Particles->DrawLayout,
+                            0,
+                            1, &Particles->DescriptorSet,
+                            0, 0);
+    vkCmdPushConstants(CommandBuffer,
+                       Particles->DrawLayout,
+                       VK_SHADER_STAGE_VERTEX_BIT,
+                       0,
+                       sizeof(Constants),
+                       &Constants);
+
+    vkCmdDrawIndirect(CommandBuffer,
+                      Particles->ArgsBuffer,
+                      offsetof(particle_args, Draw),
+                      1,
+                      sizeof(VkDrawIndirectCommand));
+
+    // NOTE[joe] This frame is done with the alive lists, so they swap.
+    Particles->Frame++;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file particles.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the definitions for our GPU particles. Particles never
+ * leave the GPU: emitting them, moving them, bouncing them off the depth
+ * buffer and handing dead ones back all happen in compute passes, and they're
+ * drawn by an indirect draw whose instance count the GPU wrote. All the CPU
+ * does each frame is record the same few commands, with the emitter in push
+ * constants, so it does the same work for a million particles as for none.
+ *
+ * Particles stay where they are in the pool. Live ones are listed by index
+ * in one of two alive lists, which swap every frame: simulating reads this
+ * frame's list, appends the survivors to the other one and pushes the rest
+ * onto the dead list, then emitting pops new particles off the dead list and
+ * appends them to the other list too.
+ */
+
+#ifndef _PARTICLES_H_
+#define _PARTICLES_H_
+
+#include "linear_math.h"
+
+// NOTE[joe] Has to match local_size_x in the particle compute shaders.
+#define PARTICLE_GROUP_SIZE 256
+
+// NOTE[joe] Keeps the pool inside the 128MB of storage buffer every device
+// can bind, and a full pool's dispatch under 65535 groups.
+#define PARTICLE_MAX_COUNT (1 << 22)
+#define PARTICLE_DEFAULT_COUNT 65536
+
+/** The same layout as the shaders', under std430. */
+typedef struct {
+    vec3  Position;
+    float Age;
+    vec3  Velocity;
+    float Lifetime;
+} particle;
+
+typedef struct {
+    // NOTE[joe] Signed, since emitting can take it below zero for a moment.
+    // See particle_emit.comp.
+    int          DeadCount;
+    unsigned int AliveCount[2];
+} particle_counters;
+
+/** Written by the GPU at the end of every frame's passes. */
+typedef struct {
+    VkDispatchIndirectCommand Simulate;
+    unsigned int              Padding;
+    VkDrawIndirectCommand     Draw;
+} particle_args;
+
+/** What the game wants emitted this frame, and how particles move. Goes in
+ * the render_packet. */
+typedef struct {
+    // NOTE[joe] Takes particles from the space they're simulated in to clip
+    // space, for drawing them and for finding them in the depth buffer.
+    mat4         Transform;
+    vec3         Position;
+    // NOTE[joe] How far from Position particles start, on each axis.
+    float        Spread;
+    vec3         Velocity;
+    // NOTE[joe] How much each particle's velocity varies, as a fraction of
+    // Velocity's length.
+    float        Jitter;
+    vec3         Gravity;
+    float        Drag;
+    float        Lifetime;
+    // NOTE[joe] Half the width of a particle, in clip space.
+    float        Size;
+    float        Dt;
+    unsigned int EmitCount;
+} particle_emitter;
+
+/** The compute passes' push constants. Has to match the Emitter block in the
+ * particle compute shaders. */
+typedef struct {
+    mat4         Transform;
+    vec3         Position;
+    float        Spread;
+    vec3         Velocity;
+    float        Jitter;
+    vec3         Gravity;
+    float        Drag;
+    float        Dt;
+    float        Lifetime;
+    unsigned int EmitCount;
+    unsigned int Frame;
+} particle_simulate_constants;
+
+/** The draw's push constants. Has to match the Draw block in particle.vert. */
+typedef struct {
+    mat4         Transform;
+    vec2         Size;
+    unsigned int Frame;
+} particle_draw_constants;
+
+typedef struct {
+    // NOTE[joe] Zero turns particles off altogether.
+    unsigned int          MaxCount;
+
+    // NOTE[joe] Frames simulated so far. Picks which alive list is which,
+    // and seeds emission.
+    unsigned int          Frame;
+
+    VkBuffer              PoolBuffer;
+    VkBuffer              DeadBuffer;
+    // NOTE[joe] Both alive lists, MaxCount indices each.
+    VkBuffer              AliveBuffer;
+    VkBuffer              CounterBuffer;
+    VkBuffer              ArgsBuffer;
+
+    // NOTE[joe] Kept so the buffers can be given up if memory runs short.
+    // See EvictParticles().
+    VkDeviceMemory        PoolMemory;
+    VkDeviceMemory        DeadMemory;
+    VkDeviceMemory        AliveMemory;
+    VkDeviceMemory        CounterMemory;
+    VkDeviceMemory        ArgsMemory;
+
+    // NOTE[joe] Just the depth aspect of the depth buffer, which is all a
+    // shader can sample.
+    VkImageView           DepthView;
+    VkSampler             DepthSampler;
+
+    VkDescriptorSetLayout SetLayout;
+    VkDescriptorPool      DescriptorPool;
+    VkDescriptorSet       DescriptorSet;
+    VkPipelineLayout      ComputeLayout;
+    VkPipelineLayout      DrawLayout;
+    VkPipeline            SimulatePipeline;
+    VkPipeline            EmitPipeline;
+    VkPipeline            FinalizePipeline;
+    pipeline_desc         DrawPipeline;
+} particle_system;
+
+#endif
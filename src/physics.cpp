@@ -0,0 +1,2238 @@
+/**
+ * @file physics.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains our rigid body dynamics: contacts between boxes,
+ * islands and sleeping, coloring, the SIMD contact solver, and stepping the
+ * world across the job system. See physics.h.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "job.h"
+#include "broadphase.h"
+#include "physics.h"
+
+// NOTE[joe] Faces are picked over edges, and A's faces over B's, unless the
+// other is clearly better, so a resting contact doesn't flip between them
+// from one step to the next.
+#define PHYSICS_RELATIVE_TOLERANCE 0.95f
+#define PHYSICS_ABSOLUTE_TOLERANCE 0.005f
+
+// NOTE[joe] How close a point has to be to one from last step, on A, to
+// carry its impulses over.
+#define PHYSICS_MATCH_DISTANCE 0.05f
+
+// NOTE[joe] A face clipped against the four sides of another.
+#define PHYSICS_MAX_CLIP_POINTS 8
+
+#define PHYSICS_MIN_BODIES 1024
+#define PHYSICS_MIN_PAIRS 64
+#define PHYSICS_MIN_BATCHES 4
+
+#define PHYSICS_NO_BODY 0xFFFFFFFF
+
+/** A box in the world, its axes the columns of its rotation. */
+typedef struct {
+    vec3  Center;
+    vec3  Axes[3];
+    float Half[3];
+} physics_box;
+
+typedef enum {
+    PHYSICS_AXIS_FACE_A = 0,
+    PHYSICS_AXIS_FACE_B,
+    PHYSICS_AXIS_EDGE,
+} physics_axis_type;
+
+/** The axis two boxes are furthest apart along, of one kind. */
+typedef struct {
+    float        Separation;
+    unsigned int IndexA;
+    unsigned int IndexB;
+    vec3         Normal;
+} physics_axis;
+
+static inline
+vec3 GetPhysicsPosition(physics_world *World, unsigned int Body)
+{
+    return { World->PositionX[Body],
+             World->PositionY[Body],
+             World->PositionZ[Body] };
+}
+
+static inline
+quat GetPhysicsRotation(physics_world *World, unsigned int Body)
+{
+    return { World->RotationX[Body],
+             World->RotationY[Body],
+             World->RotationZ[Body],
+             World->RotationW[Body] };
+}
+
+static inline
+vec3 GetPhysicsVelocity(physics_world *World, unsigned int Body)
+{
+    return { World->VelocityX[Body],
+             World->VelocityY[Body],
+             World->VelocityZ[Body] };
+}
+
+static inline
+vec3 GetPhysicsAngular(physics_world *World, unsigned int Body)
+{
+    return { World->AngularX[Body],
+             World->AngularY[Body],
+             World->AngularZ[Body] };
+}
+
+static inline
+void SetPhysicsVelocities(physics_world *World,
+                          unsigned int Body,
+                          vec3 Velocity,
+                          vec3 Angular)
+{
+    World->VelocityX[Body] = Velocity.x;
+    World->VelocityY[Body] = Velocity.y;
+    World->VelocityZ[Body] = Velocity.z;
+    World->AngularX[Body] = Angular.x;
+    World->AngularY[Body] = Angular.y;
+    World->AngularZ[Body] = Angular.z;
+}
+
+static inline
+void ClearPhysicsPush(physics_world *World, unsigned int Body)
+{
+    World->PushVelocityX[Body] = 0.0f;
+    World->PushVelocityY[Body] = 0.0f;
+    World->PushVelocityZ[Body] = 0.0f;
+    World->PushAngularX[Body] = 0.0f;
+    World->PushAngularY[Body] = 0.0f;
+    World->PushAngularZ[Body] = 0.0f;
+}
+
+/** Body's world inverse inertia, as a matrix. */
+static inline
+mat3 GetPhysicsInertia(physics_world *World, unsigned int Body)
+{
+    float XX = World->WorldInertia[0][Body];
+    float XY = World->WorldInertia[1][Body];
+    float XZ = World->WorldInertia[2][Body];
+    float YY = World->WorldInertia[3][Body];
+    float YZ = World->WorldInertia[4][Body];
+    float ZZ = World->WorldInertia[5][Body];
+
+    return { { { XX, XY, XZ }, { XY, YY, YZ }, { XZ, YZ, ZZ } } };
+}
+
+/** Only bodies that can move are ever awake. */
+static inline
+bool IsPhysicsBodyAwake(physics_world *World, unsigned int Body)
+{
+    return World->IsAwake[Body] != 0;
+}
+
+static inline
+bool IsPhysicsBodyAsleep(physics_world *World, unsigned int Body)
+{
+    return !World->IsAwake[Body] && World->InverseMass[Body] > 0.0f;
+}
+
+/** Works out Body's world inverse inertia and bounding box from where it
+ * is now. */
+static
+void UpdatePhysicsBody(physics_world *World, unsigned int Body)
+{
+    mat3 Rotation =
+        Mat3FromMat4(Mat4FromQuat(GetPhysicsRotation(World, Body)));
+    vec3 Inverse = World->InverseInertia[Body];
+    float Diagonal[3] = { Inverse.x, Inverse.y, Inverse.z };
+
+    // NOTE[joe] R * diag(Inverse) * R^T, which is symmetric.
+    unsigned int Rows[6] = { 0, 0, 0, 1, 1, 2 };
+    unsigned int Columns[6] = { 0, 1, 2, 1, 2, 2 };
+
+    for (unsigned int i = 0; i < 6; i++)
+    {
+        float Sum = 0.0f;
+
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            const float *Axis = &Rotation.Columns[k].x;
+            Sum += Axis[Rows[i]] * Diagonal[k] * Axis[Columns[i]];
+        }
+
+        World->WorldInertia[i][Body] = Sum;
+    }
+
+    vec3 Half = World->HalfSizes[Body];
+    vec3 Extent = {};
+
+    for (unsigned int k = 0; k < 3; k++)
+    {
+        vec3 Axis = Rotation.Columns[k];
+        float Size = (&Half.x)[k];
+
+        Extent.x += fabsf(Axis.x) * Size;
+        Extent.y += fabsf(Axis.y) * Size;
+        Extent.z += fabsf(Axis.z) * Size;
+    }
+
+    // NOTE[joe] Out as far as contacts are made.
+    Extent = Extent + vec3 { PHYSICS_MARGIN, PHYSICS_MARGIN, PHYSICS_MARGIN };
+
+    vec3 Position = GetPhysicsPosition(World, Body);
+
+    SetBroadphaseBox(&World->Broadphase,
+                     Body,
+                     Position - Extent,
+                     Position + Extent);
+}
+
+/** Room for MaxCount bodies, MaxPairCount pairs of them touching and
+ * MaxJointCount joints, allocated from Arena. */
+static
+void InitializePhysics(physics_world *World,
+                       memory_arena *Arena,
+                       unsigned int MaxCount,
+                       unsigned int MaxPairCount,
+                       unsigned int MaxJointCount)
+{
+    World->MaxCount = MaxCount;
+    World->Count = 0;
+
+    // NOTE[joe] Cache line aligned, like ECS columns, so no two arrays
+    // share a line.
+    size_t Size = sizeof(float) * MaxCount;
+
+    World->PositionX = (float *)PushSize(Arena, Size, 64);
+    World->PositionY = (float *)PushSize(Arena, Size, 64);
+    World->PositionZ = (float *)PushSize(Arena, Size, 64);
+    World->RotationX = (float *)PushSize(Arena, Size, 64);
+    World->RotationY = (float *)PushSize(Arena, Size, 64);
+    World->RotationZ = (float *)PushSize(Arena, Size, 64);
+    World->RotationW = (float *)PushSize(Arena, Size, 64);
+    World->VelocityX = (float *)PushSize(Arena, Size, 64);
+    World->VelocityY = (float *)PushSize(Arena, Size, 64);
+    World->VelocityZ = (float *)PushSize(Arena, Size, 64);
+    World->AngularX = (float *)PushSize(Arena, Size, 64);
+    World->AngularY = (float *)PushSize(Arena, Size, 64);
+    World->AngularZ = (float *)PushSize(Arena, Size, 64);
+    World->PushVelocityX = (float *)PushSize(Arena, Size, 64);
+    World->PushVelocityY = (float *)PushSize(Arena, Size, 64);
+    World->PushVelocityZ = (float *)PushSize(Arena, Size, 64);
+    World->PushAngularX = (float *)PushSize(Arena, Size, 64);
+    World->PushAngularY = (float *)PushSize(Arena, Size, 64);
+    World->PushAngularZ = (float *)PushSize(Arena, Size, 64);
+    World->InverseMass = (float *)PushSize(Arena, Size, 64);
+    World->InverseInertia = PushArray(Arena, vec3, MaxCount);
+    World->HalfSizes = PushArray(Arena, vec3, MaxCount);
+
+    for (unsigned int i = 0; i < 6; i++)
+    {
+        World->WorldInertia[i] = (float *)PushSize(Arena, Size, 64);
+    }
+
+    World->IsAwake = PushArray(Arena, unsigned char, MaxCount);
+    World->SleepTimes = PushArray(Arena, float, MaxCount);
+    World->SleepNext = PushArray(Arena, unsigned int, MaxCount);
+
+    InitializeBroadphase(&World->Broadphase, Arena, MaxCount, MaxPairCount);
+
+    World->MaxManifoldCount = World->Broadphase.MaxPairCount;
+    World->ManifoldCount = 0;
+    World->Manifolds =
+        PushArray(Arena, physics_manifold, World->MaxManifoldCount);
+    World->PreviousCount = 0;
+    World->PreviousManifolds =
+        PushArray(Arena, physics_manifold, World->MaxManifoldCount);
+
+    World->TableSize = 1;
+
+    while (World->TableSize < 2 * World->MaxManifoldCount)
+    {
+        World->TableSize *= 2;
+    }
+
+    World->Table = PushArray(Arena, unsigned int, World->TableSize);
+
+    World->CandidateCount = 0;
+    World->Candidates =
+        PushArray(Arena, broadphase_pair, World->MaxManifoldCount);
+
+    World->MaxJointCount = MaxJointCount;
+    World->JointCount = 0;
+    World->Joints = PushArray(Arena, physics_joint, MaxJointCount);
+
+    World->Parents = PushArray(Arena, unsigned int, MaxCount);
+    World->IslandSleepTimes = PushArray(Arena, float, MaxCount);
+    World->IslandHeads = PushArray(Arena, unsigned int, MaxCount);
+    World->IslandTails = PushArray(Arena, unsigned int, MaxCount);
+    World->ColorMasks = PushArray(Arena, unsigned int, MaxCount);
+
+    World->ManifoldColors =
+        PushArray(Arena, unsigned int, World->MaxManifoldCount);
+    World->JointColors = PushArray(Arena, unsigned int, MaxJointCount);
+    World->JointOrder = PushArray(Arena, unsigned int, MaxJointCount);
+
+    // NOTE[joe] Every color's last batch can be partly empty.
+    World->MaxBatchCount =
+        (World->MaxManifoldCount + PHYSICS_LANES - 1) / PHYSICS_LANES +
+        PHYSICS_COLOR_COUNT;
+    World->BatchCount = 0;
+    World->Batches = PushArray(Arena, physics_batch, World->MaxBatchCount);
+
+    World->Gravity = { 0.0f, -9.81f, 0.0f };
+    World->Iterations = PHYSICS_ITERATIONS;
+    World->PushIterations = PHYSICS_PUSH_ITERATIONS;
+    World->SleepTime = PHYSICS_SLEEP_TIME;
+    World->TimeStep = 0.0f;
+    World->Color = 0;
+    World->Pass = PHYSICS_PASS_SOLVE;
+    World->Iteration = 0;
+
+    World->IslandCount = 0;
+    World->AwakeCount = 0;
+    World->UsedColorCount = 0;
+}
+
+/** Adds a box HalfSize across each way from Position, turned by Rotation,
+ * and returns it. A Mass of zero never moves. Bodies are numbered from
+ * zero, in the order they're added. */
+static
+unsigned int AddPhysicsBody(physics_world *World,
+                            vec3 Position,
+                            quat Rotation,
+                            vec3 HalfSize,
+                            float Mass)
+{
+    Assert(World->Count < World->MaxCount, "Too many physics bodies.\n");
+
+    unsigned int Body = World->Count++;
+
+    World->PositionX[Body] = Position.x;
+    World->PositionY[Body] = Position.y;
+    World->PositionZ[Body] = Position.z;
+    World->RotationX[Body] = Rotation.x;
+    World->RotationY[Body] = Rotation.y;
+    World->RotationZ[Body] = Rotation.z;
+    World->RotationW[Body] = Rotation.w;
+    SetPhysicsVelocities(World, Body, vec3 {}, vec3 {});
+    ClearPhysicsPush(World, Body);
+    World->HalfSizes[Body] = HalfSize;
+
+    if (Mass > 0.0f)
+    {
+        // NOTE[joe] A solid box's, from its full sizes squared over twelve.
+        vec3 Square = HalfSize * HalfSize;
+        float Scale = Mass / 3.0f;
+
+        World->InverseMass[Body] = 1.0f / Mass;
+        World->InverseInertia[Body] = {
+            1.0f / (Scale * (Square.y + Square.z)),
+            1.0f / (Scale * (Square.x + Square.z)),
+            1.0f / (Scale * (Square.x + Square.y)),
+        };
+        World->IsAwake[Body] = 1;
+    }
+    else
+    {
+        World->InverseMass[Body] = 0.0f;
+        World->InverseInertia[Body] = {};
+        World->IsAwake[Body] = 0;
+    }
+
+    World->SleepTimes[Body] = 0.0f;
+    World->SleepNext[Body] = Body;
+
+    unsigned int BroadphaseBody =
+        AddBroadphaseBody(&World->Broadphase, Position, Position);
+
+    // NOTE[joe] Bodies are looked up in the broadphase by their physics
+    // index, so if these ever differ every pair after it is wrong. It's once
+    // per body, so release builds check too.
+    if (BroadphaseBody != Body)
+    {
+        Abort("Broadphase out of step with physics.\n");
+    }
+
+    UpdatePhysicsBody(World, Body);
+
+    return Body;
+}
+
+/** Joins A and B at Anchor, in the world, where they are now, and returns
+ * the joint. */
+static
+unsigned int AddPhysicsJoint(physics_world *World,
+                             unsigned int A,
+                             unsigned int B,
+                             vec3 Anchor)
+{
+    Assert(World->JointCount < World->MaxJointCount,
+           "Too many physics joints.\n");
+
+    unsigned int Index = World->JointCount++;
+
+    physics_joint *Joint = &World->Joints[Index];
+    *Joint = {};
+    Joint->A = A;
+    Joint->B = B;
+    Joint->LocalA = Rotate(Conjugate(GetPhysicsRotation(World, A)),
+                           Anchor - GetPhysicsPosition(World, A));
+    Joint->LocalB = Rotate(Conjugate(GetPhysicsRotation(World, B)),
+                           Anchor - GetPhysicsPosition(World, B));
+
+    return Index;
+}
+
+static
+physics_box GetPhysicsBox(physics_world *World, unsigned int Body)
+{
+    mat3 Rotation =
+        Mat3FromMat4(Mat4FromQuat(GetPhysicsRotation(World, Body)));
+    vec3 Half = World->HalfSizes[Body];
+
+    physics_box Box;
+    Box.Center = GetPhysicsPosition(World, Body);
+    Box.Axes[0] = Rotation.Columns[0];
+    Box.Axes[1] = Rotation.Columns[1];
+    Box.Axes[2] = Rotation.Columns[2];
+    Box.Half[0] = Half.x;
+    Box.Half[1] = Half.y;
+    Box.Half[2] = Half.z;
+
+    return Box;
+}
+
+/** How far Box reaches along Axis, either way from its center. */
+static inline
+float GetPhysicsBoxRadius(const physics_box *Box, vec3 Axis)
+{
+    return Box->Half[0] * fabsf(Dot(Box->Axes[0], Axis)) +
+           Box->Half[1] * fabsf(Dot(Box->Axes[1], Axis)) +
+           Box->Half[2] * fabsf(Dot(Box->Axes[2], Axis));
+}
+
+/** Keeps the part of polygon In on the inside of a plane, where
+ * Dot(Point, Normal) <= Offset. Returns how many points are left. */
+static
+unsigned int ClipPhysicsPolygon(const vec3 *In,
+                                unsigned int Count,
+                                vec3 *Out,
+                                vec3 Normal,
+                                float Offset)
+{
+    unsigned int OutCount = 0;
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        vec3 P = In[i];
+        vec3 Q = In[(i + 1) % Count];
+        float DistanceP = Dot(P, Normal) - Offset;
+        float DistanceQ = Dot(Q, Normal) - Offset;
+
+        if (DistanceP <= 0.0f)
+        {
+            Out[OutCount++] = P;
+        }
+
+        if ((DistanceP <= 0.0f) != (DistanceQ <= 0.0f))
+        {
+            float T = DistanceP / (DistanceP - DistanceQ);
+            Out[OutCount++] = P + (Q - P) * T;
+        }
+    }
+
+    return OutCount;
+}
+
+/** Adds a point to Manifold. */
+static inline
+void AddPhysicsPoint(physics_manifold *Manifold, vec3 Point, float Separation)
+{
+    unsigned int Index = Manifold->PointCount++;
+
+    Manifold->Points[Index] = Point;
+    Manifold->Separations[Index] = Separation;
+    Manifold->NormalImpulses[Index] = 0.0f;
+    Manifold->TangentImpulses[Index][0] = 0.0f;
+    Manifold->TangentImpulses[Index][1] = 0.0f;
+}
+
+/** Picks the four of Count points that cover the most: the deepest, the
+ * one furthest from it, and the two furthest either side of the line
+ * between them. */
+static
+void AddPhysicsPoints(physics_manifold *Manifold,
+                      const vec3 *Points,
+                      const float *Separations,
+                      unsigned int Count)
+{
+    if (Count <= PHYSICS_MAX_POINTS)
+    {
+        for (unsigned int i = 0; i < Count; i++)
+        {
+            AddPhysicsPoint(Manifold, Points[i], Separations[i]);
+        }
+
+        return;
+    }
+
+    unsigned int Picks[PHYSICS_MAX_POINTS] = {};
+
+    for (unsigned int i = 1; i < Count; i++)
+    {
+        Picks[0] = Separations[i] < Separations[Picks[0]] ? i : Picks[0];
+    }
+
+    vec3 First = Points[Picks[0]];
+    float Furthest = -1.0f;
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        vec3 Offset = Points[i] - First;
+        float Distance = Dot(Offset, Offset);
+
+        if (Distance > Furthest)
+        {
+            Furthest = Distance;
+            Picks[1] = i;
+        }
+    }
+
+    vec3 Line = Points[Picks[1]] - First;
+    float Most = -INFINITY;
+    float Least = INFINITY;
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        float Area = Dot(Cross(Line, Points[i] - First), Manifold->Normal);
+
+        if (Area > Most)
+        {
+            Most = Area;
+            Picks[2] = i;
+        }
+
+        if (Area < Least)
+        {
+            Least = Area;
+            Picks[3] = i;
+        }
+    }
+
+    for (unsigned int i = 0; i < PHYSICS_MAX_POINTS; i++)
+    {
+        bool IsRepeat = false;
+
+        for (unsigned int j = 0; j < i; j++)
+        {
+            IsRepeat |= Picks[j] == Picks[i];
+        }
+
+        if (!IsRepeat)
+        {
+            AddPhysicsPoint(Manifold,
+                            Points[Picks[i]],
+                            Separations[Picks[i]]);
+        }
+    }
+}
+
+/** Clips the face of Incident that faces Reference against Reference's face
+ * along Axis, which faces the other way, along Normal. */
+static
+void CollidePhysicsFaces(physics_manifold *Manifold,
+                         const physics_box *Reference,
+                         const physics_box *Incident,
+                         unsigned int Axis,
+                         vec3 Normal)
+{
+    // NOTE[joe] The incident face is the one most against Normal.
+    unsigned int IncidentAxis = 0;
+    float Most = -1.0f;
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        float Alignment = fabsf(Dot(Incident->Axes[i], Normal));
+
+        if (Alignment > Most)
+        {
+            Most = Alignment;
+            IncidentAxis = i;
+        }
+    }
+
+    vec3 FaceNormal = Incident->Axes[IncidentAxis];
+    FaceNormal = Dot(FaceNormal, Normal) > 0.0f ? -FaceNormal : FaceNormal;
+
+    unsigned int U = (IncidentAxis + 1) % 3;
+    unsigned int V = (IncidentAxis + 2) % 3;
+    vec3 Center = Incident->Center +
+                  FaceNormal * Incident->Half[IncidentAxis];
+    vec3 SideU = Incident->Axes[U] * Incident->Half[U];
+    vec3 SideV = Incident->Axes[V] * Incident->Half[V];
+
+    vec3 Polygon[PHYSICS_MAX_CLIP_POINTS];
+    vec3 Clipped[PHYSICS_MAX_CLIP_POINTS];
+    unsigned int Count = 4;
+
+    Polygon[0] = Center + SideU + SideV;
+    Polygon[1] = Center - SideU + SideV;
+    Polygon[2] = Center - SideU - SideV;
+    Polygon[3] = Center + SideU - SideV;
+
+    // NOTE[joe] The reference face's four sides.
+    vec3 ReferenceCenter = Reference->Center + Normal * Reference->Half[Axis];
+
+    for (unsigned int Side = 1; Side < 3 && Count; Side++)
+    {
+        unsigned int SideAxis = (Axis + Side) % 3;
+        vec3 Direction = Reference->Axes[SideAxis];
+        float Offset = Dot(Reference->Center, Direction);
+        float Half = Reference->Half[SideAxis];
+
+        Count = ClipPhysicsPolygon(Polygon,
+                                   Count,
+                                   Clipped,
+                                   Direction,
+                                   Offset + Half);
+        Count = ClipPhysicsPolygon(Clipped,
+                                   Count,
+                                   Polygon,
+                                   -Direction,
+                                   Half - Offset);
+    }
+
+    vec3 Points[PHYSICS_MAX_CLIP_POINTS];
+    float Separations[PHYSICS_MAX_CLIP_POINTS];
+    unsigned int PointCount = 0;
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        float Separation = Dot(Polygon[i] - ReferenceCenter, Normal);
+
+        if (Separation <= PHYSICS_MARGIN)
+        {
+            // NOTE[joe] Halfway between the incident point and the
+            // reference face.
+            Points[PointCount] = Polygon[i] - Normal * (0.5f * Separation);
+            Separations[PointCount] = Separation;
+            PointCount++;
+        }
+    }
+
+    AddPhysicsPoints(Manifold, Points, Separations, PointCount);
+}
+
+/** Where the edge of A along IndexA gets closest to the edge of B along
+ * IndexB, with the edges the ones furthest along Normal, from A to B. */
+static
+void CollidePhysicsEdges(physics_manifold *Manifold,
+                         const physics_box *A,
+                         const physics_box *B,
+                         const physics_axis *Edge)
+{
+    vec3 Normal = Edge->Normal;
+    vec3 PointA = A->Center;
+    vec3 PointB = B->Center;
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        if (i != Edge->IndexA)
+        {
+            float Sign = Dot(A->Axes[i], Normal) > 0.0f ? 1.0f : -1.0f;
+            PointA = PointA + A->Axes[i] * (Sign * A->Half[i]);
+        }
+
+        if (i != Edge->IndexB)
+        {
+            float Sign = Dot(B->Axes[i], Normal) > 0.0f ? -1.0f : 1.0f;
+            PointB = PointB + B->Axes[i] * (Sign * B->Half[i]);
+        }
+    }
+
+    vec3 DirectionA = A->Axes[Edge->IndexA];
+    vec3 DirectionB = B->Axes[Edge->IndexB];
+    vec3 Offset = PointA - PointB;
+
+    float Along = Dot(DirectionA, DirectionB);
+    float OffsetA = Dot(DirectionA, Offset);
+    float OffsetB = Dot(DirectionB, Offset);
+    float Denominator = 1.0f - Along * Along;
+
+    // NOTE[joe] Parallel edges are never picked, since their cross product
+    // is too short to be an axis.
+    float S = (Along * OffsetB - OffsetA) / Denominator;
+    float HalfA = A->Half[Edge->IndexA];
+    S = S < -HalfA ? -HalfA : S > HalfA ? HalfA : S;
+
+    float T = Along * S + OffsetB;
+    float HalfB = B->Half[Edge->IndexB];
+    T = T < -HalfB ? -HalfB : T > HalfB ? HalfB : T;
+
+    vec3 ClosestA = PointA + DirectionA * S;
+    vec3 ClosestB = PointB + DirectionB * T;
+
+    AddPhysicsPoint(Manifold,
+                    (ClosestA + ClosestB) * 0.5f,
+                    Dot(ClosestB - ClosestA, Normal));
+}
+
+/** Finds where Manifold's boxes touch, if they do, with separating axes:
+ * the three faces of each, and every edge of one against every edge of the
+ * other. */
+static
+void CollidePhysicsBoxes(physics_world *World, physics_manifold *Manifold)
+{
+    Manifold->PointCount = 0;
+
+    physics_box A = GetPhysicsBox(World, Manifold->A);
+    physics_box B = GetPhysicsBox(World, Manifold->B);
+    vec3 Offset = B.Center - A.Center;
+
+    physics_axis Faces[2] = {};
+    Faces[0].Separation = -INFINITY;
+    Faces[1].Separation = -INFINITY;
+
+    const physics_box *Boxes[2] = { &A, &B };
+
+    for (unsigned int Side = 0; Side < 2; Side++)
+    {
+        const physics_box *Box = Boxes[Side];
+        const physics_box *Other = Boxes[1 - Side];
+
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            vec3 Axis = Box->Axes[i];
+            float Distance = Dot(Offset, Axis);
+            float Separation = fabsf(Distance) - Box->Half[i] -
+                               GetPhysicsBoxRadius(Other, Axis);
+
+            if (Separation > PHYSICS_MARGIN)
+            {
+                return;
+            }
+
+            if (Separation > Faces[Side].Separation)
+            {
+                Faces[Side].Separation = Separation;
+                Faces[Side].IndexA = i;
+                Faces[Side].IndexB = i;
+                Faces[Side].Normal = Distance < 0.0f ? -Axis : Axis;
+            }
+        }
+    }
+
+    physics_axis Edge = {};
+    Edge.Separation = -INFINITY;
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        for (unsigned int j = 0; j < 3; j++)
+        {
+            vec3 Axis = Cross(A.Axes[i], B.Axes[j]);
+            float Length = sqrtf(Dot(Axis, Axis));
+
+            if (Length < 1e-4f)
+            {
+                continue;
+            }
+
+            Axis = Axis / Length;
+
+            float Distance = Dot(Offset, Axis);
+            float Separation = fabsf(Distance) -
+                               GetPhysicsBoxRadius(&A, Axis) -
+                               GetPhysicsBoxRadius(&B, Axis);
+
+            if (Separation > PHYSICS_MARGIN)
+            {
+                return;
+            }
+
+            if (Separation > Edge.Separation)
+            {
+                Edge.Separation = Separation;
+                Edge.IndexA = i;
+                Edge.IndexB = j;
+                Edge.Normal = Distance < 0.0f ? -Axis : Axis;
+            }
+        }
+    }
+
+    physics_axis_type Type = PHYSICS_AXIS_FACE_A;
+    float Best = Faces[0].Separation;
+
+    if (Faces[1].Separation >
+        PHYSICS_RELATIVE_TOLERANCE * Best + PHYSICS_ABSOLUTE_TOLERANCE)
+    {
+        Type = PHYSICS_AXIS_FACE_B;
+        Best = Faces[1].Separation;
+    }
+
+    if (Edge.Separation >
+        PHYSICS_RELATIVE_TOLERANCE * Best + PHYSICS_ABSOLUTE_TOLERANCE)
+    {
+        Type = PHYSICS_AXIS_EDGE;
+    }
+
+    switch (Type)
+    {
+        case PHYSICS_AXIS_FACE_A:
+        {
+            Manifold->Normal = Faces[0].Normal;
+            CollidePhysicsFaces(Manifold,
+                                &A,
+                                &B,
+                                Faces[0].IndexA,
+                                Faces[0].Normal);
+        } break;
+
+        case PHYSICS_AXIS_FACE_B:
+        {
+            // NOTE[joe] Clipped from B's side, so its normal points at A.
+            Manifold->Normal = Faces[1].Normal;
+            CollidePhysicsFaces(Manifold,
+                                &B,
+                                &A,
+                                Faces[1].IndexB,
+                                -Faces[1].Normal);
+        } break;
+
+        case PHYSICS_AXIS_EDGE:
+        {
+            Manifold->Normal = Edge.Normal;
+            CollidePhysicsEdges(Manifold, &A, &B, &Edge);
+        } break;
+    }
+
+    quat InverseA = Conjugate(GetPhysicsRotation(World, Manifold->A));
+
+    for (unsigned int i = 0; i < Manifold->PointCount; i++)
+    {
+        Manifold->LocalPoints[i] =
+            Rotate(InverseA, Manifold->Points[i] - A.Center);
+    }
+}
+
+static inline
+unsigned int HashPhysicsPair(unsigned int A, unsigned int B)
+{
+    return (A * 0x9E3779B1u) ^ (B * 0x85EBCA77u);
+}
+
+/** Fills the table with last step's manifolds, by pair. Only as much of it
+ * as twice their number is used, so it's only as slow to clear. */
+static
+void BuildPhysicsTable(physics_world *World)
+{
+    unsigned int Size = 1;
+
+    while (Size < 2 * World->PreviousCount)
+    {
+        Size *= 2;
+    }
+
+    World->TableSize = Size;
+
+    for (unsigned int i = 0; i < Size; i++)
+    {
+        World->Table[i] = PHYSICS_NO_MANIFOLD;
+    }
+
+    for (unsigned int i = 0; i < World->PreviousCount; i++)
+    {
+        physics_manifold *Manifold = &World->PreviousManifolds[i];
+        unsigned int Slot =
+            HashPhysicsPair(Manifold->A, Manifold->B) & (Size - 1);
+
+        while (World->Table[Slot] != PHYSICS_NO_MANIFOLD)
+        {
+            Slot = (Slot + 1) & (Size - 1);
+        }
+
+        World->Table[Slot] = i;
+    }
+}
+
+/** Carries impulses over from last step's manifold for the same pair, for
+ * the points that are near where they were on A. */
+static
+void MatchPhysicsManifold(physics_world *World, physics_manifold *Manifold)
+{
+    if (World->PreviousCount == 0)
+    {
+        return;
+    }
+
+    unsigned int Mask = World->TableSize - 1;
+    unsigned int Slot = HashPhysicsPair(Manifold->A, Manifold->B) & Mask;
+    physics_manifold *Previous = 0;
+
+    for (;;)
+    {
+        unsigned int Index = World->Table[Slot];
+
+        if (Index == PHYSICS_NO_MANIFOLD)
+        {
+            return;
+        }
+
+        Previous = &World->PreviousManifolds[Index];
+
+        if (Previous->A == Manifold->A && Previous->B == Manifold->B)
+        {
+            break;
+        }
+
+        Slot = (Slot + 1) & Mask;
+    }
+
+    float Limit = PHYSICS_MATCH_DISTANCE * PHYSICS_MATCH_DISTANCE;
+
+    for (unsigned int i = 0; i < Manifold->PointCount; i++)
+    {
+        float Closest = Limit;
+
+        for (unsigned int j = 0; j < Previous->PointCount; j++)
+        {
+            vec3 Offset = Manifold->LocalPoints[i] - Previous->LocalPoints[j];
+            float Distance = Dot(Offset, Offset);
+
+            if (Distance < Closest)
+            {
+                Closest = Distance;
+                Manifold->NormalImpulses[i] = Previous->NormalImpulses[j];
+                Manifold->TangentImpulses[i][0] =
+                    Previous->TangentImpulses[j][0];
+                Manifold->TangentImpulses[i][1] =
+                    Previous->TangentImpulses[j][1];
+            }
+        }
+    }
+}
+
+/** Wakes Body, and everything that fell asleep with it. */
+static
+void WakePhysicsBody(physics_world *World, unsigned int Body)
+{
+    unsigned int Next = Body;
+
+    do
+    {
+        unsigned int After = World->SleepNext[Next];
+
+        World->IsAwake[Next] = 1;
+        World->SleepTimes[Next] = 0.0f;
+        World->SleepNext[Next] = Next;
+
+        Next = After;
+    } while (Next != Body);
+}
+
+/** Wakes anything asleep that's near or joined to something awake, then
+ * picks out the broadphase's pairs that have something awake in them. */
+static
+void FindPhysicsCandidates(physics_world *World)
+{
+    broadphase *Broadphase = &World->Broadphase;
+
+    for (unsigned int i = 0; i < Broadphase->PairCount; i++)
+    {
+        broadphase_pair Pair = Broadphase->Pairs[i];
+
+        if (IsPhysicsBodyAwake(World, Pair.A) &&
+            IsPhysicsBodyAsleep(World, Pair.B))
+        {
+            WakePhysicsBody(World, Pair.B);
+        }
+        else if (IsPhysicsBodyAwake(World, Pair.B) &&
+                 IsPhysicsBodyAsleep(World, Pair.A))
+        {
+            WakePhysicsBody(World, Pair.A);
+        }
+    }
+
+    for (unsigned int i = 0; i < World->JointCount; i++)
+    {
+        physics_joint *Joint = &World->Joints[i];
+
+        if (IsPhysicsBodyAwake(World, Joint->A) &&
+            IsPhysicsBodyAsleep(World, Joint->B))
+        {
+            WakePhysicsBody(World, Joint->B);
+        }
+        else if (IsPhysicsBodyAwake(World, Joint->B) &&
+                 IsPhysicsBodyAsleep(World, Joint->A))
+        {
+            WakePhysicsBody(World, Joint->A);
+        }
+    }
+
+    // NOTE[joe] Pairs that are asleep, or that don't move at all, are
+    // skipped.
+    unsigned int Count = 0;
+
+    for (unsigned int i = 0; i < Broadphase->PairCount; i++)
+    {
+        broadphase_pair Pair = Broadphase->Pairs[i];
+
+        if (IsPhysicsBodyAwake(World, Pair.A) ||
+            IsPhysicsBodyAwake(World, Pair.B))
+        {
+            World->Candidates[Count++] = Pair;
+        }
+    }
+
+    World->CandidateCount = Count;
+}
+
+/** Finds the manifolds of candidates [Start, End), each in its own slot. */
+static
+void CollidePhysicsJob(void *Data, unsigned int Start, unsigned int End)
+{
+    physics_world *World = (physics_world *)Data;
+
+    for (unsigned int i = Start; i < End; i++)
+    {
+        physics_manifold *Manifold = &World->Manifolds[i];
+        Manifold->A = World->Candidates[i].A;
+        Manifold->B = World->Candidates[i].B;
+
+        CollidePhysicsBoxes(World, Manifold);
+        MatchPhysicsManifold(World, Manifold);
+    }
+}
+
+/** Drops the candidates that didn't touch, keeping the rest in order. */
+static
+void CompactPhysicsManifolds(physics_world *World)
+{
+    unsigned int Count = 0;
+
+    for (unsigned int i = 0; i < World->CandidateCount; i++)
+    {
+        if (World->Manifolds[i].PointCount)
+        {
+            if (Count != i)
+            {
+                World->Manifolds[Count] = World->Manifolds[i];
+            }
+
+            Count++;
+        }
+    }
+
+    World->ManifoldCount = Count;
+}
+
+/** Gravity, for bodies [Start, End) that are awake. */
+static
+void AccelerateBodiesJob(void *Data, unsigned int Start, unsigned int End)
+{
+    physics_world *World = (physics_world *)Data;
+    vec3 Change = World->Gravity * World->TimeStep;
+
+    for (unsigned int Body = Start; Body < End; Body++)
+    {
+        float Awake = World->IsAwake[Body] ? 1.0f : 0.0f;
+
+        World->VelocityX[Body] += Change.x * Awake;
+        World->VelocityY[Body] += Change.y * Awake;
+        World->VelocityZ[Body] += Change.z * Awake;
+    }
+}
+
+static
+unsigned int FindPhysicsIsland(unsigned int *Parents, unsigned int Body)
+{
+    while (Parents[Body] != Body)
+    {
+        Parents[Body] = Parents[Parents[Body]];
+        Body = Parents[Body];
+    }
+
+    return Body;
+}
+
+static inline
+void JoinPhysicsIslands(physics_world *World, unsigned int A, unsigned int B)
+{
+    // NOTE[joe] Things that don't move don't join islands together; the
+    // ground would make the whole world one.
+    if (World->InverseMass[A] == 0.0f || World->InverseMass[B] == 0.0f)
+    {
+        return;
+    }
+
+    unsigned int RootA = FindPhysicsIsland(World->Parents, A);
+    unsigned int RootB = FindPhysicsIsland(World->Parents, B);
+
+    // NOTE[joe] The lowest body is always the root, so islands come out
+    // the same whatever order they're joined in.
+    if (RootA < RootB)
+    {
+        World->Parents[RootB] = RootA;
+    }
+    else if (RootB < RootA)
+    {
+        World->Parents[RootA] = RootB;
+    }
+}
+
+/** Joins awake bodies into islands through their contacts and joints. */
+static
+void BuildPhysicsIslands(physics_world *World)
+{
+    for (unsigned int Body = 0; Body < World->Count; Body++)
+    {
+        World->Parents[Body] = Body;
+    }
+
+    for (unsigned int i = 0; i < World->ManifoldCount; i++)
+    {
+        physics_manifold *Manifold = &World->Manifolds[i];
+        JoinPhysicsIslands(World, Manifold->A, Manifold->B);
+    }
+
+    for (unsigned int i = 0; i < World->JointCount; i++)
+    {
+        physics_joint *Joint = &World->Joints[i];
+
+        if (IsPhysicsBodyAwake(World, Joint->A) ||
+            IsPhysicsBodyAwake(World, Joint->B))
+        {
+            JoinPhysicsIslands(World, Joint->A, Joint->B);
+        }
+    }
+}
+
+/** The colors Body is already in, if it moves. Bodies that don't move can
+ * be in any number of constraints of a color, since nothing changes them. */
+static inline
+unsigned int GetPhysicsColorMask(physics_world *World, unsigned int Body)
+{
+    return World->InverseMass[Body] > 0.0f ? World->ColorMasks[Body] : 0;
+}
+
+/** The lowest color neither A nor B is in yet, which they then are. */
+static
+unsigned int PickPhysicsColor(physics_world *World,
+                              unsigned int A,
+                              unsigned int B)
+{
+    unsigned int Used = GetPhysicsColorMask(World, A) |
+                        GetPhysicsColorMask(World, B);
+
+    for (unsigned int Color = 0; Color < PHYSICS_MAX_COLORS; Color++)
+    {
+        unsigned int Bit = 1u << Color;
+
+        if (!(Used & Bit))
+        {
+            World->ColorMasks[A] |= Bit;
+            World->ColorMasks[B] |= Bit;
+
+            return Color;
+        }
+    }
+
+    return PHYSICS_OVERFLOW_COLOR;
+}
+
+/** Colors every manifold and joint that has something awake in it, in
+ * order, and packs each color's manifolds into batches. */
+static
+void ColorPhysicsConstraints(physics_world *World)
+{
+    for (unsigned int i = 0; i < World->ManifoldCount; i++)
+    {
+        World->ColorMasks[World->Manifolds[i].A] = 0;
+        World->ColorMasks[World->Manifolds[i].B] = 0;
+    }
+
+    for (unsigned int i = 0; i < World->JointCount; i++)
+    {
+        World->ColorMasks[World->Joints[i].A] = 0;
+        World->ColorMasks[World->Joints[i].B] = 0;
+    }
+
+    unsigned int ManifoldCounts[PHYSICS_COLOR_COUNT] = {};
+    unsigned int JointCounts[PHYSICS_COLOR_COUNT] = {};
+
+    for (unsigned int i = 0; i < World->ManifoldCount; i++)
+    {
+        physics_manifold *Manifold = &World->Manifolds[i];
+        unsigned int Color = PickPhysicsColor(World, Manifold->A, Manifold->B);
+
+        World->ManifoldColors[i] = Color;
+        ManifoldCounts[Color]++;
+    }
+
+    for (unsigned int i = 0; i < World->JointCount; i++)
+    {
+        physics_joint *Joint = &World->Joints[i];
+        unsigned int Color = PHYSICS_COLOR_COUNT;
+
+        if (IsPhysicsBodyAwake(World, Joint->A) ||
+            IsPhysicsBodyAwake(World, Joint->B))
+        {
+            Color = PickPhysicsColor(World, Joint->A, Joint->B);
+            JointCounts[Color]++;
+        }
+
+        World->JointColors[i] = Color;
+    }
+
+    unsigned int BatchCount = 0;
+    unsigned int JointCount = 0;
+    unsigned int UsedCount = 0;
+
+    for (unsigned int Color = 0; Color < PHYSICS_COLOR_COUNT; Color++)
+    {
+        physics_color *Info = &World->Colors[Color];
+        Info->FirstBatch = BatchCount;
+        Info->BatchCount =
+            (ManifoldCounts[Color] + PHYSICS_LANES - 1) / PHYSICS_LANES;
+        Info->FirstJoint = JointCount;
+        Info->JointCount = JointCounts[Color];
+
+        BatchCount += Info->BatchCount;
+        JointCount += Info->JointCount;
+        UsedCount += Info->BatchCount || Info->JointCount;
+    }
+
+    Assert(BatchCount <= World->MaxBatchCount, "Too many physics batches.\n");
+
+    World->BatchCount = BatchCount;
+    World->UsedColorCount = UsedCount;
+
+    unsigned int Filled[PHYSICS_COLOR_COUNT] = {};
+
+    for (unsigned int i = 0; i < World->ManifoldCount; i++)
+    {
+        unsigned int Color = World->ManifoldColors[i];
+        unsigned int Slot = Filled[Color]++;
+
+        physics_batch *Batch = &World->Batches[World->Colors[Color].FirstBatch +
+                                               Slot / PHYSICS_LANES];
+        unsigned int Lane = Slot % PHYSICS_LANES;
+
+        Batch->Manifolds[Lane] = i;
+        Batch->Count = Lane + 1;
+    }
+
+    for (unsigned int Color = 0; Color < PHYSICS_COLOR_COUNT; Color++)
+    {
+        Filled[Color] = 0;
+    }
+
+    for (unsigned int i = 0; i < World->JointCount; i++)
+    {
+        unsigned int Color = World->JointColors[i];
+
+        if (Color < PHYSICS_COLOR_COUNT)
+        {
+            unsigned int Slot = World->Colors[Color].FirstJoint +
+                                Filled[Color]++;
+            World->JointOrder[Slot] = i;
+        }
+    }
+}
+
+/** Two directions across Normal, and at right angles to each other. */
+static
+void GetPhysicsTangents(vec3 Normal, vec3 *Tangent1, vec3 *Tangent2)
+{
+    // NOTE[joe] 0.57735 is one over root three; one of the components is
+    // always at least that big.
+    vec3 Tangent = fabsf(Normal.x) >= 0.57735f
+                       ? vec3 { Normal.y, -Normal.x, 0.0f }
+                       : vec3 { 0.0f, Normal.z, -Normal.y };
+
+    *Tangent1 = Normalize(Tangent);
+    *Tangent2 = Cross(Normal, *Tangent1);
+}
+
+/** One over how hard it is to push A and B apart along Direction, at RA and
+ * RB from their centers. */
+static inline
+float GetPhysicsMass(float InverseMassA,
+                     const mat3 &InertiaA,
+                     vec3 RA,
+                     float InverseMassB,
+                     const mat3 &InertiaB,
+                     vec3 RB,
+                     vec3 Direction)
+{
+    vec3 AngularA = Cross(RA, Direction);
+    vec3 AngularB = Cross(RB, Direction);
+
+    float Mass = InverseMassA + InverseMassB +
+                 Dot(AngularA, InertiaA * AngularA) +
+                 Dot(AngularB, InertiaB * AngularB);
+
+    return Mass > 0.0f ? 1.0f / Mass : 0.0f;
+}
+
+/** Fills in Batch's lanes from its manifolds, for this step. Empty lanes
+ * are all zero, and push nothing. */
+static
+void PreparePhysicsBatch(physics_world *World, physics_batch *Batch)
+{
+    float TimeStep = World->TimeStep;
+    unsigned int PointCount = 0;
+
+    for (unsigned int Lane = 0; Lane < PHYSICS_LANES; Lane++)
+    {
+        physics_manifold Empty = {};
+        physics_manifold *Manifold = &Empty;
+        unsigned int A = 0;
+        unsigned int B = 0;
+
+        if (Lane < Batch->Count)
+        {
+            Manifold = &World->Manifolds[Batch->Manifolds[Lane]];
+            A = Manifold->A;
+            B = Manifold->B;
+        }
+
+        Batch->BodyA[Lane] = A;
+        Batch->BodyB[Lane] = B;
+
+        float InverseMassA = 0.0f;
+        float InverseMassB = 0.0f;
+        mat3 InertiaA = {};
+        mat3 InertiaB = {};
+
+        if (Lane < Batch->Count)
+        {
+            InverseMassA = World->InverseMass[A];
+            InverseMassB = World->InverseMass[B];
+            InertiaA = GetPhysicsInertia(World, A);
+            InertiaB = GetPhysicsInertia(World, B);
+        }
+
+        vec3 Normal = Manifold->Normal;
+        vec3 Tangent1 = {};
+        vec3 Tangent2 = {};
+
+        if (Lane < Batch->Count)
+        {
+            GetPhysicsTangents(Normal, &Tangent1, &Tangent2);
+        }
+
+        Batch->NormalX[Lane] = Normal.x;
+        Batch->NormalY[Lane] = Normal.y;
+        Batch->NormalZ[Lane] = Normal.z;
+        Batch->Tangent1X[Lane] = Tangent1.x;
+        Batch->Tangent1Y[Lane] = Tangent1.y;
+        Batch->Tangent1Z[Lane] = Tangent1.z;
+        Batch->Tangent2X[Lane] = Tangent2.x;
+        Batch->Tangent2Y[Lane] = Tangent2.y;
+        Batch->Tangent2Z[Lane] = Tangent2.z;
+        Batch->Friction[Lane] = PHYSICS_FRICTION;
+
+        Batch->InverseMassA[Lane] = InverseMassA;
+        Batch->InverseMassB[Lane] = InverseMassB;
+
+        const float *PackedA[6] = {
+            &InertiaA.Columns[0].x, &InertiaA.Columns[0].y,
+            &InertiaA.Columns[0].z, &InertiaA.Columns[1].y,
+            &InertiaA.Columns[1].z, &InertiaA.Columns[2].z,
+        };
+        const float *PackedB[6] = {
+            &InertiaB.Columns[0].x, &InertiaB.Columns[0].y,
+            &InertiaB.Columns[0].z, &InertiaB.Columns[1].y,
+            &InertiaB.Columns[1].z, &InertiaB.Columns[2].z,
+        };
+
+        for (unsigned int i = 0; i < 6; i++)
+        {
+            Batch->InertiaA[i][Lane] = *PackedA[i];
+            Batch->InertiaB[i][Lane] = *PackedB[i];
+        }
+
+        vec3 CenterA = Lane < Batch->Count ? GetPhysicsPosition(World, A)
+                                           : vec3 {};
+        vec3 CenterB = Lane < Batch->Count ? GetPhysicsPosition(World, B)
+                                           : vec3 {};
+
+        for (unsigned int k = 0; k < PHYSICS_MAX_POINTS; k++)
+        {
+            vec3 RA = {};
+            vec3 RB = {};
+            float NormalMass = 0.0f;
+            float Tangent1Mass = 0.0f;
+            float Tangent2Mass = 0.0f;
+            float Bias = 0.0f;
+            float PushBias = 0.0f;
+            float NormalImpulse = 0.0f;
+            float Tangent1Impulse = 0.0f;
+            float Tangent2Impulse = 0.0f;
+
+            if (k < Manifold->PointCount)
+            {
+                RA = Manifold->Points[k] - CenterA;
+                RB = Manifold->Points[k] - CenterB;
+
+                NormalMass = GetPhysicsMass(InverseMassA, InertiaA, RA,
+                                            InverseMassB, InertiaB, RB,
+                                            Normal);
+                Tangent1Mass = GetPhysicsMass(InverseMassA, InertiaA, RA,
+                                              InverseMassB, InertiaB, RB,
+                                              Tangent1);
+                Tangent2Mass = GetPhysicsMass(InverseMassA, InertiaA, RA,
+                                              InverseMassB, InertiaB, RB,
+                                              Tangent2);
+
+                // NOTE[joe] Apart, they're allowed to close the gap this
+                // step, and no more. Overlapping, they're pushed apart by
+                // some of however far they're in past the slop.
+                float Separation = Manifold->Separations[k];
+
+                if (Separation > 0.0f)
+                {
+                    Bias = Separation / TimeStep;
+                }
+                else
+                {
+                    float Depth = Separation + PHYSICS_SLOP;
+                    Depth = Depth < 0.0f ? Depth : 0.0f;
+                    PushBias = PHYSICS_BAUMGARTE / TimeStep * Depth;
+                }
+
+                NormalImpulse = Manifold->NormalImpulses[k];
+                Tangent1Impulse = Manifold->TangentImpulses[k][0];
+                Tangent2Impulse = Manifold->TangentImpulses[k][1];
+
+                PointCount = k + 1 > PointCount ? k + 1 : PointCount;
+            }
+
+            Batch->RAX[k][Lane] = RA.x;
+            Batch->RAY[k][Lane] = RA.y;
+            Batch->RAZ[k][Lane] = RA.z;
+            Batch->RBX[k][Lane] = RB.x;
+            Batch->RBY[k][Lane] = RB.y;
+            Batch->RBZ[k][Lane] = RB.z;
+            Batch->NormalMass[k][Lane] = NormalMass;
+            Batch->Tangent1Mass[k][Lane] = Tangent1Mass;
+            Batch->Tangent2Mass[k][Lane] = Tangent2Mass;
+            Batch->Bias[k][Lane] = Bias;
+            Batch->PushBias[k][Lane] = PushBias;
+            Batch->PushImpulse[k][Lane] = 0.0f;
+            Batch->NormalImpulse[k][Lane] = NormalImpulse;
+            Batch->Tangent1Impulse[k][Lane] = Tangent1Impulse;
+            Batch->Tangent2Impulse[k][Lane] = Tangent2Impulse;
+        }
+    }
+
+    Batch->PointCount = PointCount;
+}
+
+/** Where A's and B's anchors are, and how to pull them together. */
+static
+void PreparePhysicsJoint(physics_world *World, physics_joint *Joint)
+{
+    unsigned int A = Joint->A;
+    unsigned int B = Joint->B;
+
+    Joint->RA = Rotate(GetPhysicsRotation(World, A), Joint->LocalA);
+    Joint->RB = Rotate(GetPhysicsRotation(World, B), Joint->LocalB);
+
+    // NOTE[joe] K = (mA + mB) I - [RA] IA [RA] - [RB] IB [RB], where [R] is
+    // the matrix that crosses R with whatever it multiplies.
+    mat3 Inertias[2] = {
+        GetPhysicsInertia(World, A),
+        GetPhysicsInertia(World, B),
+    };
+    vec3 Arms[2] = { Joint->RA, Joint->RB };
+
+    float Mass = World->InverseMass[A] + World->InverseMass[B];
+    mat3 K = { { { Mass, 0.0f, 0.0f },
+                 { 0.0f, Mass, 0.0f },
+                 { 0.0f, 0.0f, Mass } } };
+
+    for (unsigned int Side = 0; Side < 2; Side++)
+    {
+        vec3 R = Arms[Side];
+        mat3 Skew = { { { 0.0f, R.z, -R.y },
+                        { -R.z, 0.0f, R.x },
+                        { R.y, -R.x, 0.0f } } };
+        mat3 Term = Skew * Inertias[Side] * Skew;
+
+        for (unsigned int Column = 0; Column < 3; Column++)
+        {
+            K.Columns[Column] = K.Columns[Column] - Term.Columns[Column];
+        }
+    }
+
+    Joint->Mass = Inverse(K);
+
+    vec3 Error = (GetPhysicsPosition(World, B) + Joint->RB) -
+                 (GetPhysicsPosition(World, A) + Joint->RA);
+
+    Joint->Bias = Error * (PHYSICS_BAUMGARTE / World->TimeStep);
+}
+
+/** Pushes A and B by Impulse, at their anchors. */
+static
+void ApplyPhysicsJoint(physics_world *World,
+                       physics_joint *Joint,
+                       vec3 Impulse)
+{
+    unsigned int A = Joint->A;
+    unsigned int B = Joint->B;
+
+    if (World->InverseMass[A] > 0.0f)
+    {
+        vec3 Velocity = GetPhysicsVelocity(World, A) -
+                        Impulse * World->InverseMass[A];
+        vec3 Angular = GetPhysicsAngular(World, A) -
+                       GetPhysicsInertia(World, A) * Cross(Joint->RA, Impulse);
+
+        SetPhysicsVelocities(World, A, Velocity, Angular);
+    }
+
+    if (World->InverseMass[B] > 0.0f)
+    {
+        vec3 Velocity = GetPhysicsVelocity(World, B) +
+                        Impulse * World->InverseMass[B];
+        vec3 Angular = GetPhysicsAngular(World, B) +
+                       GetPhysicsInertia(World, B) * Cross(Joint->RB, Impulse);
+
+        SetPhysicsVelocities(World, B, Velocity, Angular);
+    }
+}
+
+static
+void SolvePhysicsJoint(physics_world *World,
+                       physics_joint *Joint,
+                       physics_pass Pass)
+{
+    if (Pass == PHYSICS_PASS_WARM_START)
+    {
+        ApplyPhysicsJoint(World, Joint, Joint->Impulse);
+        return;
+    }
+
+    // NOTE[joe] Joints fix their own drift, with their bias.
+    if (Pass == PHYSICS_PASS_PUSH)
+    {
+        return;
+    }
+
+    unsigned int A = Joint->A;
+    unsigned int B = Joint->B;
+
+    vec3 Relative = GetPhysicsVelocity(World, B) +
+                    Cross(GetPhysicsAngular(World, B), Joint->RB) -
+                    GetPhysicsVelocity(World, A) -
+                    Cross(GetPhysicsAngular(World, A), Joint->RA);
+
+    vec3 Impulse = -(Joint->Mass * (Relative + Joint->Bias));
+
+    Joint->Impulse = Joint->Impulse + Impulse;
+
+    ApplyPhysicsJoint(World, Joint, Impulse);
+}
+
+/** A backend's SIMD registers, as many lanes of a batch at a time as fit.
+ * The scalar one does a lane at a time. */
+template <typename backend>
+struct physics_lanes;
+
+template <>
+struct physics_lanes<math_scalar> {
+    typedef float wide;
+    static constexpr unsigned int Width = 1;
+
+    static inline wide Load(const float *P) { return *P; }
+    static inline void Store(float *P, wide A) { *P = A; }
+    static inline wide Set(float A) { return A; }
+    static inline wide Add(wide A, wide B) { return A + B; }
+    static inline wide Sub(wide A, wide B) { return A - B; }
+    static inline wide Mul(wide A, wide B) { return A * B; }
+    static inline wide Min(wide A, wide B) { return A < B ? A : B; }
+    static inline wide Max(wide A, wide B) { return A > B ? A : B; }
+};
+
+#if MATH_HAS_SSE
+
+template <>
+struct physics_lanes<math_sse> {
+    typedef __m128 wide;
+    static constexpr unsigned int Width = 4;
+
+    static inline wide Load(const float *P) { return _mm_load_ps(P); }
+    static inline void Store(float *P, wide A) { _mm_store_ps(P, A); }
+    static inline wide Set(float A) { return _mm_set1_ps(A); }
+    static inline wide Add(wide A, wide B) { return _mm_add_ps(A, B); }
+    static inline wide Sub(wide A, wide B) { return _mm_sub_ps(A, B); }
+    static inline wide Mul(wide A, wide B) { return _mm_mul_ps(A, B); }
+    static inline wide Min(wide A, wide B) { return _mm_min_ps(A, B); }
+    static inline wide Max(wide A, wide B) { return _mm_max_ps(A, B); }
+};
+
+#endif
+
+#if MATH_HAS_AVX2
+
+template <>
+struct physics_lanes<math_avx2> {
+    typedef __m256 wide;
+    static constexpr unsigned int Width = 8;
+
+    static inline wide Load(const float *P) { return _mm256_load_ps(P); }
+    static inline void Store(float *P, wide A) { _mm256_store_ps(P, A); }
+    static inline wide Set(float A) { return _mm256_set1_ps(A); }
+    static inline wide Add(wide A, wide B) { return _mm256_add_ps(A, B); }
+    static inline wide Sub(wide A, wide B) { return _mm256_sub_ps(A, B); }
+    static inline wide Mul(wide A, wide B) { return _mm256_mul_ps(A, B); }
+    static inline wide Min(wide A, wide B) { return _mm256_min_ps(A, B); }
+    static inline wide Max(wide A, wide B) { return _mm256_max_ps(A, B); }
+};
+
+#endif
+
+// NOTE[joe] NEON goes through the scalar lanes for now.
+#if MATH_HAS_AVX2
+typedef math_avx2 physics_backend;
+#elif MATH_HAS_SSE
+typedef math_sse physics_backend;
+#else
+typedef math_scalar physics_backend;
+#endif
+
+/** The contact solver, written once over backend's lanes. */
+template <typename backend>
+struct physics_kernels {
+    typedef physics_lanes<backend> lanes;
+    typedef typename lanes::wide wide;
+
+    typedef struct {
+        wide x, y, z;
+    } wide3;
+
+    static inline
+    wide3 Load3(const float *X, const float *Y, const float *Z)
+    {
+        return { lanes::Load(X), lanes::Load(Y), lanes::Load(Z) };
+    }
+
+    static inline
+    void Store3(float *X, float *Y, float *Z, wide3 A)
+    {
+        lanes::Store(X, A.x);
+        lanes::Store(Y, A.y);
+        lanes::Store(Z, A.z);
+    }
+
+    static inline
+    wide3 Add3(wide3 A, wide3 B)
+    {
+        return { lanes::Add(A.x, B.x),
+                 lanes::Add(A.y, B.y),
+                 lanes::Add(A.z, B.z) };
+    }
+
+    static inline
+    wide3 Sub3(wide3 A, wide3 B)
+    {
+        return { lanes::Sub(A.x, B.x),
+                 lanes::Sub(A.y, B.y),
+                 lanes::Sub(A.z, B.z) };
+    }
+
+    static inline
+    wide3 Scale3(wide3 A, wide S)
+    {
+        return { lanes::Mul(A.x, S), lanes::Mul(A.y, S), lanes::Mul(A.z, S) };
+    }
+
+    static inline
+    wide Dot3(wide3 A, wide3 B)
+    {
+        return lanes::Add(lanes::Add(lanes::Mul(A.x, B.x),
+                                     lanes::Mul(A.y, B.y)),
+                          lanes::Mul(A.z, B.z));
+    }
+
+    static inline
+    wide3 Cross3(wide3 A, wide3 B)
+    {
+        return { lanes::Sub(lanes::Mul(A.y, B.z), lanes::Mul(A.z, B.y)),
+                 lanes::Sub(lanes::Mul(A.z, B.x), lanes::Mul(A.x, B.z)),
+                 lanes::Sub(lanes::Mul(A.x, B.y), lanes::Mul(A.y, B.x)) };
+    }
+
+    /** Symmetric inertia I, as xx, xy, xz, yy, yz, zz, times V. */
+    static inline
+    wide3 MulInertia(const wide *I, wide3 V)
+    {
+        return {
+            lanes::Add(lanes::Add(lanes::Mul(I[0], V.x), lanes::Mul(I[1], V.y)),
+                       lanes::Mul(I[2], V.z)),
+            lanes::Add(lanes::Add(lanes::Mul(I[1], V.x), lanes::Mul(I[3], V.y)),
+                       lanes::Mul(I[4], V.z)),
+            lanes::Add(lanes::Add(lanes::Mul(I[2], V.x), lanes::Mul(I[4], V.y)),
+                       lanes::Mul(I[5], V.z)),
+        };
+    }
+
+    /** The speed B's point moves away from A's at. */
+    static inline
+    wide3 GetRelative(wide3 VA, wide3 WA, wide3 RA,
+                      wide3 VB, wide3 WB, wide3 RB)
+    {
+        return Sub3(Add3(VB, Cross3(WB, RB)), Add3(VA, Cross3(WA, RA)));
+    }
+
+    /** Runs one pass of sequential impulses over Batch, or, warm starting,
+     * pushes with what it ended on last time. Pushing apart, only the
+     * normals of contacts that overlap are solved, with the push velocities.
+     * Lanes are gathered from the bodies and scattered back Width at a time,
+     * so the scalar lanes can solve batches whose manifolds share bodies,
+     * one after another. Points are solved in turn, first to last and then
+     * last to first, so none of them always goes first and takes most of
+     * the impulse, which would twist stacks the same way every step. */
+    static
+    void Solve(physics_world *World, physics_batch *Batch, physics_pass Pass)
+    {
+        constexpr unsigned int Width = lanes::Width;
+
+        bool IsPushing = Pass == PHYSICS_PASS_PUSH;
+        bool IsBackwards = World->Iteration & 1;
+        float *Velocities[6] = {
+            IsPushing ? World->PushVelocityX : World->VelocityX,
+            IsPushing ? World->PushVelocityY : World->VelocityY,
+            IsPushing ? World->PushVelocityZ : World->VelocityZ,
+            IsPushing ? World->PushAngularX : World->AngularX,
+            IsPushing ? World->PushAngularY : World->AngularY,
+            IsPushing ? World->PushAngularZ : World->AngularZ,
+        };
+
+        for (unsigned int Lane = 0; Lane < Batch->Count; Lane += Width)
+        {
+            // NOTE[joe] Linear and angular velocities of A, then of B, a
+            // component at a time.
+            alignas(32) float Gathered[12][Width];
+
+            for (unsigned int k = 0; k < Width; k++)
+            {
+                unsigned int A = Batch->BodyA[Lane + k];
+                unsigned int B = Batch->BodyB[Lane + k];
+
+                for (unsigned int i = 0; i < 6; i++)
+                {
+                    Gathered[i][k] = Velocities[i][A];
+                    Gathered[i + 6][k] = Velocities[i][B];
+                }
+            }
+
+            wide3 VA = Load3(Gathered[0], Gathered[1], Gathered[2]);
+            wide3 WA = Load3(Gathered[3], Gathered[4], Gathered[5]);
+            wide3 VB = Load3(Gathered[6], Gathered[7], Gathered[8]);
+            wide3 WB = Load3(Gathered[9], Gathered[10], Gathered[11]);
+
+            wide3 Normal = Load3(&Batch->NormalX[Lane],
+                                 &Batch->NormalY[Lane],
+                                 &Batch->NormalZ[Lane]);
+            wide3 Tangent1 = Load3(&Batch->Tangent1X[Lane],
+                                   &Batch->Tangent1Y[Lane],
+                                   &Batch->Tangent1Z[Lane]);
+            wide3 Tangent2 = Load3(&Batch->Tangent2X[Lane],
+                                   &Batch->Tangent2Y[Lane],
+                                   &Batch->Tangent2Z[Lane]);
+            wide Friction = lanes::Load(&Batch->Friction[Lane]);
+            wide MassA = lanes::Load(&Batch->InverseMassA[Lane]);
+            wide MassB = lanes::Load(&Batch->InverseMassB[Lane]);
+
+            wide InertiaA[6];
+            wide InertiaB[6];
+
+            for (unsigned int i = 0; i < 6; i++)
+            {
+                InertiaA[i] = lanes::Load(&Batch->InertiaA[i][Lane]);
+                InertiaB[i] = lanes::Load(&Batch->InertiaB[i][Lane]);
+            }
+
+            wide Zero = lanes::Set(0.0f);
+
+            for (unsigned int Point = 0; Point < Batch->PointCount; Point++)
+            {
+                unsigned int k = IsBackwards ?
+                    Batch->PointCount - 1 - Point : Point;
+
+                wide3 RA = Load3(&Batch->RAX[k][Lane],
+                                 &Batch->RAY[k][Lane],
+                                 &Batch->RAZ[k][Lane]);
+                wide3 RB = Load3(&Batch->RBX[k][Lane],
+                                 &Batch->RBY[k][Lane],
+                                 &Batch->RBZ[k][Lane]);
+                wide NormalMass = lanes::Load(&Batch->NormalMass[k][Lane]);
+
+                wide3 Impulse;
+
+                if (Pass == PHYSICS_PASS_WARM_START)
+                {
+                    wide Normal0 =
+                        lanes::Load(&Batch->NormalImpulse[k][Lane]);
+                    wide Tangent10 =
+                        lanes::Load(&Batch->Tangent1Impulse[k][Lane]);
+                    wide Tangent20 =
+                        lanes::Load(&Batch->Tangent2Impulse[k][Lane]);
+
+                    Impulse = Add3(Scale3(Normal, Normal0),
+                                   Add3(Scale3(Tangent1, Tangent10),
+                                        Scale3(Tangent2, Tangent20)));
+                }
+                else if (IsPushing)
+                {
+                    wide3 Relative = GetRelative(VA, WA, RA, VB, WB, RB);
+                    wide Speed = Dot3(Relative, Normal);
+                    wide Bias = lanes::Load(&Batch->PushBias[k][Lane]);
+                    wide Pushed = lanes::Load(&Batch->PushImpulse[k][Lane]);
+
+                    wide Change =
+                        lanes::Mul(NormalMass,
+                                   lanes::Sub(Zero, lanes::Add(Speed, Bias)));
+                    wide Total = lanes::Max(lanes::Add(Pushed, Change), Zero);
+
+                    Impulse = Scale3(Normal, lanes::Sub(Total, Pushed));
+
+                    lanes::Store(&Batch->PushImpulse[k][Lane], Total);
+                }
+                else
+                {
+                    wide NormalImpulse =
+                        lanes::Load(&Batch->NormalImpulse[k][Lane]);
+                    wide Tangent1Impulse =
+                        lanes::Load(&Batch->Tangent1Impulse[k][Lane]);
+                    wide Tangent2Impulse =
+                        lanes::Load(&Batch->Tangent2Impulse[k][Lane]);
+
+                    wide3 Relative = GetRelative(VA, WA, RA, VB, WB, RB);
+
+                    // NOTE[joe] Never pulls; the total only ever pushes.
+                    wide Speed = Dot3(Relative, Normal);
+                    wide Bias = lanes::Load(&Batch->Bias[k][Lane]);
+                    wide Change =
+                        lanes::Mul(NormalMass,
+                                   lanes::Sub(Zero, lanes::Add(Speed, Bias)));
+                    wide Total = lanes::Max(lanes::Add(NormalImpulse, Change),
+                                            Zero);
+                    Change = lanes::Sub(Total, NormalImpulse);
+                    NormalImpulse = Total;
+
+                    Impulse = Scale3(Normal, Change);
+
+                    VA = Sub3(VA, Scale3(Impulse, MassA));
+                    WA = Sub3(WA, MulInertia(InertiaA, Cross3(RA, Impulse)));
+                    VB = Add3(VB, Scale3(Impulse, MassB));
+                    WB = Add3(WB, MulInertia(InertiaB, Cross3(RB, Impulse)));
+
+                    // NOTE[joe] Friction, up to how hard the contact is
+                    // pushing, either way.
+                    Relative = GetRelative(VA, WA, RA, VB, WB, RB);
+
+                    wide Limit = lanes::Mul(Friction, NormalImpulse);
+                    wide Negative = lanes::Sub(Zero, Limit);
+
+                    wide Speed1 = Dot3(Relative, Tangent1);
+                    wide Mass1 = lanes::Load(&Batch->Tangent1Mass[k][Lane]);
+                    wide Total1 = lanes::Sub(Tangent1Impulse,
+                                             lanes::Mul(Mass1, Speed1));
+                    Total1 = lanes::Min(lanes::Max(Total1, Negative), Limit);
+                    wide Change1 = lanes::Sub(Total1, Tangent1Impulse);
+                    Tangent1Impulse = Total1;
+
+                    wide Speed2 = Dot3(Relative, Tangent2);
+                    wide Mass2 = lanes::Load(&Batch->Tangent2Mass[k][Lane]);
+                    wide Total2 = lanes::Sub(Tangent2Impulse,
+                                             lanes::Mul(Mass2, Speed2));
+                    Total2 = lanes::Min(lanes::Max(Total2, Negative), Limit);
+                    wide Change2 = lanes::Sub(Total2, Tangent2Impulse);
+                    Tangent2Impulse = Total2;
+
+                    Impulse = Add3(Scale3(Tangent1, Change1),
+                                   Scale3(Tangent2, Change2));
+
+                    lanes::Store(&Batch->NormalImpulse[k][Lane], NormalImpulse);
+                    lanes::Store(&Batch->Tangent1Impulse[k][Lane],
+                                 Tangent1Impulse);
+                    lanes::Store(&Batch->Tangent2Impulse[k][Lane],
+                                 Tangent2Impulse);
+                }
+
+                VA = Sub3(VA, Scale3(Impulse, MassA));
+                WA = Sub3(WA, MulInertia(InertiaA, Cross3(RA, Impulse)));
+                VB = Add3(VB, Scale3(Impulse, MassB));
+                WB = Add3(WB, MulInertia(InertiaB, Cross3(RB, Impulse)));
+            }
+
+            Store3(Gathered[0], Gathered[1], Gathered[2], VA);
+            Store3(Gathered[3], Gathered[4], Gathered[5], WA);
+            Store3(Gathered[6], Gathered[7], Gathered[8], VB);
+            Store3(Gathered[9], Gathered[10], Gathered[11], WB);
+
+            // NOTE[joe] Bodies that don't move are shared between lanes, and
+            // between batches on other threads, so they're never written.
+            for (unsigned int k = 0; k < Width && Lane + k < Batch->Count; k++)
+            {
+                unsigned int A = Batch->BodyA[Lane + k];
+                unsigned int B = Batch->BodyB[Lane + k];
+
+                if (World->InverseMass[A] > 0.0f)
+                {
+                    for (unsigned int i = 0; i < 6; i++)
+                    {
+                        Velocities[i][A] = Gathered[i][k];
+                    }
+                }
+
+                if (World->InverseMass[B] > 0.0f)
+                {
+                    for (unsigned int i = 0; i < 6; i++)
+                    {
+                        Velocities[i][B] = Gathered[i + 6][k];
+                    }
+                }
+            }
+        }
+    }
+};
+
+/** Gets batches [Start, End) and every joint ready for this step. */
+static
+void PreparePhysicsJob(void *Data, unsigned int Start, unsigned int End)
+{
+    physics_world *World = (physics_world *)Data;
+
+    for (unsigned int i = Start; i < End; i++)
+    {
+        if (i < World->BatchCount)
+        {
+            PreparePhysicsBatch(World, &World->Batches[i]);
+        }
+        else
+        {
+            PreparePhysicsJoint(World, &World->Joints[i - World->BatchCount]);
+        }
+    }
+}
+
+/** Solves batches and joints [Start, End) of the current color. */
+static
+void SolvePhysicsJob(void *Data, unsigned int Start, unsigned int End)
+{
+    physics_world *World = (physics_world *)Data;
+    physics_color *Color = &World->Colors[World->Color];
+
+    for (unsigned int i = Start; i < End; i++)
+    {
+        if (i < Color->BatchCount)
+        {
+            physics_kernels<physics_backend>::Solve(
+                World,
+                &World->Batches[Color->FirstBatch + i],
+                World->Pass);
+        }
+        else
+        {
+            unsigned int Joint =
+                World->JointOrder[Color->FirstJoint + i - Color->BatchCount];
+
+            SolvePhysicsJoint(World,
+                              &World->Joints[Joint],
+                              World->Pass);
+        }
+    }
+}
+
+/** One pass over every color, a color at a time. The last color's
+ * constraints can share bodies, so it runs on this thread, and its batches
+ * a lane at a time. */
+static
+void SolvePhysicsColors(physics_world *World,
+                        job_system *Jobs,
+                        physics_pass Pass,
+                        unsigned int Iteration)
+{
+    World->Pass = Pass;
+    World->Iteration = Iteration;
+
+    for (unsigned int Color = 0; Color < PHYSICS_MAX_COLORS; Color++)
+    {
+        physics_color *Info = &World->Colors[Color];
+        unsigned int Count = Info->BatchCount + Info->JointCount;
+
+        if (Count)
+        {
+            World->Color = Color;
+            ParallelForAndWait(Jobs,
+                               SolvePhysicsJob,
+                               World,
+                               Count,
+                               PHYSICS_MIN_BATCHES);
+        }
+    }
+
+    physics_color *Overflow = &World->Colors[PHYSICS_OVERFLOW_COLOR];
+
+    for (unsigned int i = 0; i < Overflow->BatchCount; i++)
+    {
+        physics_kernels<math_scalar>::Solve(
+            World,
+            &World->Batches[Overflow->FirstBatch + i],
+            Pass);
+    }
+
+    for (unsigned int i = 0; i < Overflow->JointCount; i++)
+    {
+        unsigned int Joint = World->JointOrder[Overflow->FirstJoint + i];
+        SolvePhysicsJoint(World, &World->Joints[Joint], Pass);
+    }
+}
+
+/** Copies batches [Start, End)'s impulses back to their manifolds, to
+ * start from next step. */
+static
+void StorePhysicsImpulsesJob(void *Data, unsigned int Start, unsigned int End)
+{
+    physics_world *World = (physics_world *)Data;
+
+    for (unsigned int i = Start; i < End; i++)
+    {
+        physics_batch *Batch = &World->Batches[i];
+
+        for (unsigned int Lane = 0; Lane < Batch->Count; Lane++)
+        {
+            physics_manifold *Manifold =
+                &World->Manifolds[Batch->Manifolds[Lane]];
+
+            for (unsigned int k = 0; k < Manifold->PointCount; k++)
+            {
+                Manifold->NormalImpulses[k] = Batch->NormalImpulse[k][Lane];
+                Manifold->TangentImpulses[k][0] =
+                    Batch->Tangent1Impulse[k][Lane];
+                Manifold->TangentImpulses[k][1] =
+                    Batch->Tangent2Impulse[k][Lane];
+            }
+        }
+    }
+}
+
+/** Moves bodies [Start, End) that are awake along their velocities, and
+ * counts how long they've been still. */
+static
+void IntegrateBodiesJob(void *Data, unsigned int Start, unsigned int End)
+{
+    physics_world *World = (physics_world *)Data;
+    float TimeStep = World->TimeStep;
+    float HalfStep = 0.5f * TimeStep;
+
+    for (unsigned int Body = Start; Body < End; Body++)
+    {
+        if (!World->IsAwake[Body])
+        {
+            continue;
+        }
+
+        vec3 Velocity = GetPhysicsVelocity(World, Body);
+        vec3 Angular = GetPhysicsAngular(World, Body);
+
+        // NOTE[joe] Pushing apart moves bodies, but it's never kept.
+        vec3 Moving = {
+            Velocity.x + World->PushVelocityX[Body],
+            Velocity.y + World->PushVelocityY[Body],
+            Velocity.z + World->PushVelocityZ[Body],
+        };
+        vec3 Turning = {
+            Angular.x + World->PushAngularX[Body],
+            Angular.y + World->PushAngularY[Body],
+            Angular.z + World->PushAngularZ[Body],
+        };
+        ClearPhysicsPush(World, Body);
+
+        World->PositionX[Body] += Moving.x * TimeStep;
+        World->PositionY[Body] += Moving.y * TimeStep;
+        World->PositionZ[Body] += Moving.z * TimeStep;
+
+        // NOTE[joe] dq/dt = (w, 0) q / 2.
+        quat Q = GetPhysicsRotation(World, Body);
+        quat Spin = { Turning.x, Turning.y, Turning.z, 0.0f };
+        quat Change = Spin * Q;
+
+        Q.x += Change.x * HalfStep;
+        Q.y += Change.y * HalfStep;
+        Q.z += Change.z * HalfStep;
+        Q.w += Change.w * HalfStep;
+        Q = Normalize(Q);
+
+        World->RotationX[Body] = Q.x;
+        World->RotationY[Body] = Q.y;
+        World->RotationZ[Body] = Q.z;
+        World->RotationW[Body] = Q.w;
+
+        UpdatePhysicsBody(World, Body);
+
+        bool IsStill =
+            Dot(Velocity, Velocity) <
+                PHYSICS_SLEEP_LINEAR * PHYSICS_SLEEP_LINEAR &&
+            Dot(Angular, Angular) <
+                PHYSICS_SLEEP_ANGULAR * PHYSICS_SLEEP_ANGULAR;
+
+        World->SleepTimes[Body] =
+            IsStill ? World->SleepTimes[Body] + TimeStep : 0.0f;
+    }
+}
+
+/** Puts every island whose bodies have all been still long enough to sleep,
+ * linking its bodies round in a loop to wake them together. */
+static
+void SleepPhysicsIslands(physics_world *World)
+{
+    unsigned int *Parents = World->Parents;
+    unsigned int IslandCount = 0;
+
+    for (unsigned int Body = 0; Body < World->Count; Body++)
+    {
+        World->IslandTails[Body] = PHYSICS_NO_BODY;
+
+        if (IsPhysicsBodyAwake(World, Body) && Parents[Body] == Body)
+        {
+            World->IslandSleepTimes[Body] = INFINITY;
+            World->IslandHeads[Body] = PHYSICS_NO_BODY;
+            IslandCount++;
+        }
+    }
+
+    for (unsigned int Body = 0; Body < World->Count; Body++)
+    {
+        if (IsPhysicsBodyAwake(World, Body))
+        {
+            unsigned int Root = FindPhysicsIsland(Parents, Body);
+            float Time = World->SleepTimes[Body];
+
+            if (Time < World->IslandSleepTimes[Root])
+            {
+                World->IslandSleepTimes[Root] = Time;
+            }
+        }
+    }
+
+    unsigned int AwakeCount = 0;
+
+    for (unsigned int Body = 0; Body < World->Count; Body++)
+    {
+        if (!IsPhysicsBodyAwake(World, Body))
+        {
+            continue;
+        }
+
+        unsigned int Root = FindPhysicsIsland(Parents, Body);
+
+        if (World->IslandSleepTimes[Root] < World->SleepTime)
+        {
+            AwakeCount++;
+            continue;
+        }
+
+        World->IsAwake[Body] = 0;
+        SetPhysicsVelocities(World, Body, vec3 {}, vec3 {});
+
+        if (World->IslandTails[Root] == PHYSICS_NO_BODY)
+        {
+            World->IslandTails[Root] = Body;
+        }
+
+        World->SleepNext[Body] = World->IslandHeads[Root];
+        World->IslandHeads[Root] = Body;
+    }
+
+    // NOTE[joe] Closes each loop, now that its first body is known.
+    for (unsigned int Body = 0; Body < World->Count; Body++)
+    {
+        if (World->IslandTails[Body] != PHYSICS_NO_BODY)
+        {
+            World->SleepNext[World->IslandTails[Body]] =
+                World->IslandHeads[Body];
+        }
+    }
+
+    World->IslandCount = IslandCount;
+    World->AwakeCount = AwakeCount;
+}
+
+/** Moves everything on by TimeStep. */
+static
+void StepPhysics(physics_world *World, job_system *Jobs, float TimeStep)
+{
+    World->TimeStep = TimeStep;
+
+    UpdateBroadphase(&World->Broadphase, Jobs);
+
+    FindPhysicsCandidates(World);
+
+    BuildPhysicsTable(World);
+
+    ParallelForAndWait(Jobs,
+                       CollidePhysicsJob,
+                       World,
+                       World->CandidateCount,
+                       PHYSICS_MIN_PAIRS);
+
+    CompactPhysicsManifolds(World);
+
+    ParallelForAndWait(Jobs,
+                       AccelerateBodiesJob,
+                       World,
+                       World->Count,
+                       PHYSICS_MIN_BODIES);
+
+    BuildPhysicsIslands(World);
+
+    ColorPhysicsConstraints(World);
+
+    ParallelForAndWait(Jobs,
+                       PreparePhysicsJob,
+                       World,
+                       World->BatchCount + World->JointCount,
+                       PHYSICS_MIN_BATCHES);
+
+    SolvePhysicsColors(World, Jobs, PHYSICS_PASS_WARM_START, 0);
+
+    for (unsigned int i = 0; i < World->Iterations; i++)
+    {
+        SolvePhysicsColors(World, Jobs, PHYSICS_PASS_SOLVE, i);
+    }
+
+    for (unsigned int i = 0; i < World->PushIterations; i++)
+    {
+        SolvePhysicsColors(World, Jobs, PHYSICS_PASS_PUSH, i);
+    }
+
+    ParallelForAndWait(Jobs,
+                       StorePhysicsImpulsesJob,
+                       World,
+                       World->BatchCount,
+                       PHYSICS_MIN_BATCHES);
+
+    ParallelForAndWait(Jobs,
+                       IntegrateBodiesJob,
+                       World,
+                       World->Count,
+                       PHYSICS_MIN_BODIES);
+
+    SleepPhysicsIslands(World);
+
+    // NOTE[joe] This step's manifolds are next step's to match against.
+    physics_manifold *Swap = World->PreviousManifolds;
+    World->PreviousManifolds = World->Manifolds;
+    World->Manifolds = Swap;
+    World->PreviousCount = World->ManifoldCount;
+}
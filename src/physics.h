@@ -0,0 +1,259 @@
+/**
+ * @file physics.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the definitions for our rigid body dynamics: boxes,
+ * the contacts between them, and ball joints, stepped with sequential
+ * impulses.
+ *
+ * Each step the broadphase finds which boxes might touch, and each pair of
+ * those gets a manifold of up to four contact points. Manifolds remember
+ * last step's impulses for the points that are still there, so the solver
+ * starts each step close to where it finished the last one, which is what
+ * lets stacks stand still.
+ *
+ * Bodies that touch, through contacts or joints, make up an island. Islands
+ * are what sleep: once every body in one has been still for long enough,
+ * they all stop, and nothing is done for them again until something awake
+ * comes near one of them. Then the whole island wakes up together.
+ *
+ * Sequential impulses solves one constraint at a time, and each one changes
+ * the velocities the next one sees, so two constraints on the same body
+ * can't run at once. Constraints are colored so that no two of a color
+ * share a body that moves, and then everything of a color can run at once:
+ * a color at a time, across the job system, and within a color eight
+ * manifolds at a time, a manifold per SIMD lane. Which color something gets
+ * only depends on the order the constraints come in, not on threads, so the
+ * same scene steps exactly the same on any number of them.
+ *
+ * Bodies are kept a component per array, and so are the batches of eight
+ * manifolds the solver works through.
+ */
+
+#ifndef _PHYSICS_H_
+#define _PHYSICS_H_
+
+#include "linear_math.h"
+#include "broadphase.h"
+
+// NOTE[joe] Manifolds solved together, a lane each. The same for every
+// backend, so batches are laid out the same whichever one runs them.
+#define PHYSICS_LANES 8
+#define PHYSICS_MAX_POINTS 4
+
+// NOTE[joe] A color is a bit in each body's mask. Constraints that don't
+// fit in any color are solved one at a time, on one thread, after the rest.
+#define PHYSICS_MAX_COLORS 32
+#define PHYSICS_OVERFLOW_COLOR PHYSICS_MAX_COLORS
+#define PHYSICS_COLOR_COUNT (PHYSICS_MAX_COLORS + 1)
+
+#define PHYSICS_ITERATIONS 8
+
+// NOTE[joe] Overlapping bodies are pushed apart in passes of their own, with
+// velocities that only last the step. Pushing them apart with their real
+// velocities would carry on after they'd separated, and pump energy into
+// stacks.
+#define PHYSICS_PUSH_ITERATIONS 2
+
+// NOTE[joe] Contacts are made this far out, so the solver can stop bodies
+// that are about to touch before they overlap.
+#define PHYSICS_MARGIN 0.02f
+
+// NOTE[joe] Overlap that's left alone, so resting contacts don't jitter, and
+// how much of the rest is pushed out each step.
+#define PHYSICS_SLOP 0.005f
+#define PHYSICS_BAUMGARTE 0.2f
+
+#define PHYSICS_FRICTION 0.6f
+
+// NOTE[joe] A body's still when it's slower than these, and an island
+// sleeps when all of its bodies have been still this long.
+#define PHYSICS_SLEEP_LINEAR 0.05f
+#define PHYSICS_SLEEP_ANGULAR 0.05f
+#define PHYSICS_SLEEP_TIME 0.5f
+
+#define PHYSICS_NO_MANIFOLD 0xFFFFFFFF
+
+/** Where two boxes touch. Points are halfway between their surfaces. */
+typedef struct {
+    unsigned int A;
+    unsigned int B;
+    unsigned int PointCount;
+
+    // NOTE[joe] From A towards B.
+    vec3         Normal;
+    vec3         Points[PHYSICS_MAX_POINTS];
+    // NOTE[joe] Negative where the boxes overlap.
+    float        Separations[PHYSICS_MAX_POINTS];
+
+    // NOTE[joe] Where the points are on A, to find them again next step.
+    vec3         LocalPoints[PHYSICS_MAX_POINTS];
+    float        NormalImpulses[PHYSICS_MAX_POINTS];
+    float        TangentImpulses[PHYSICS_MAX_POINTS][2];
+} physics_manifold;
+
+/** Holds a point on A and a point on B together. */
+typedef struct {
+    unsigned int A;
+    unsigned int B;
+    vec3         LocalA;
+    vec3         LocalB;
+    vec3         Impulse;
+
+    // NOTE[joe] Worked out for the step.
+    vec3         RA;
+    vec3         RB;
+    mat3         Mass;
+    vec3         Bias;
+} physics_joint;
+
+/** Up to PHYSICS_LANES manifolds of one color, a component per array. */
+typedef struct alignas(32) {
+    unsigned int Manifolds[PHYSICS_LANES];
+    unsigned int BodyA[PHYSICS_LANES];
+    unsigned int BodyB[PHYSICS_LANES];
+
+    float NormalX[PHYSICS_LANES];
+    float NormalY[PHYSICS_LANES];
+    float NormalZ[PHYSICS_LANES];
+    float Tangent1X[PHYSICS_LANES];
+    float Tangent1Y[PHYSICS_LANES];
+    float Tangent1Z[PHYSICS_LANES];
+    float Tangent2X[PHYSICS_LANES];
+    float Tangent2Y[PHYSICS_LANES];
+    float Tangent2Z[PHYSICS_LANES];
+    float Friction[PHYSICS_LANES];
+
+    // NOTE[joe] World inverse inertias are xx, xy, xz, yy, yz, zz.
+    float InverseMassA[PHYSICS_LANES];
+    float InverseMassB[PHYSICS_LANES];
+    float InertiaA[6][PHYSICS_LANES];
+    float InertiaB[6][PHYSICS_LANES];
+
+    float RAX[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float RAY[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float RAZ[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float RBX[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float RBY[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float RBZ[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float NormalMass[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float Tangent1Mass[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float Tangent2Mass[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float Bias[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float PushBias[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float PushImpulse[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float NormalImpulse[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float Tangent1Impulse[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+    float Tangent2Impulse[PHYSICS_MAX_POINTS][PHYSICS_LANES];
+
+    // NOTE[joe] After the lanes, so they all start on a SIMD boundary.
+    unsigned int Count;
+    unsigned int PointCount;
+} physics_batch;
+
+typedef enum {
+    PHYSICS_PASS_WARM_START = 0,
+    PHYSICS_PASS_SOLVE,
+    PHYSICS_PASS_PUSH,
+} physics_pass;
+
+/** A color's batches and joints. */
+typedef struct {
+    unsigned int FirstBatch;
+    unsigned int BatchCount;
+    unsigned int FirstJoint;
+    unsigned int JointCount;
+} physics_color;
+
+typedef struct {
+    unsigned int         MaxCount;
+    unsigned int         Count;
+
+    // NOTE[joe] Indexed by body. Bodies with no mass don't move.
+    float               *PositionX;
+    float               *PositionY;
+    float               *PositionZ;
+    float               *RotationX;
+    float               *RotationY;
+    float               *RotationZ;
+    float               *RotationW;
+    float               *VelocityX;
+    float               *VelocityY;
+    float               *VelocityZ;
+    float               *AngularX;
+    float               *AngularY;
+    float               *AngularZ;
+    // NOTE[joe] How fast bodies are being pushed apart, this step only.
+    float               *PushVelocityX;
+    float               *PushVelocityY;
+    float               *PushVelocityZ;
+    float               *PushAngularX;
+    float               *PushAngularY;
+    float               *PushAngularZ;
+    float               *InverseMass;
+    vec3                *InverseInertia;
+    vec3                *HalfSizes;
+    // NOTE[joe] xx, xy, xz, yy, yz, zz, kept up to date for bodies that
+    // are awake.
+    float               *WorldInertia[6];
+
+    // NOTE[joe] Only bodies that move are ever awake. Sleeping bodies are
+    // linked round their island, so waking one wakes the rest.
+    unsigned char       *IsAwake;
+    float               *SleepTimes;
+    unsigned int        *SleepNext;
+
+    broadphase           Broadphase;
+
+    // NOTE[joe] This step's manifolds, and last step's to carry impulses
+    // over from, found by pair in a table of last step's.
+    unsigned int         MaxManifoldCount;
+    unsigned int         ManifoldCount;
+    physics_manifold    *Manifolds;
+    unsigned int         PreviousCount;
+    physics_manifold    *PreviousManifolds;
+    unsigned int         TableSize;
+    unsigned int        *Table;
+
+    // NOTE[joe] Pairs from the broadphase with something awake in them.
+    unsigned int         CandidateCount;
+    broadphase_pair     *Candidates;
+
+    unsigned int         MaxJointCount;
+    unsigned int         JointCount;
+    physics_joint       *Joints;
+
+    // NOTE[joe] Scratch for islands and colors, indexed by body.
+    unsigned int        *Parents;
+    float               *IslandSleepTimes;
+    unsigned int        *IslandHeads;
+    unsigned int        *IslandTails;
+    unsigned int        *ColorMasks;
+
+    unsigned int        *ManifoldColors;
+    unsigned int        *JointColors;
+    physics_color        Colors[PHYSICS_COLOR_COUNT];
+    unsigned int         MaxBatchCount;
+    unsigned int         BatchCount;
+    physics_batch       *Batches;
+    unsigned int        *JointOrder;
+
+    vec3                 Gravity;
+    unsigned int         Iterations;
+    unsigned int         PushIterations;
+    float                SleepTime;
+
+    // NOTE[joe] For the step's jobs.
+    float                TimeStep;
+    unsigned int         Color;
+    physics_pass         Pass;
+    unsigned int         Iteration;
+
+    // NOTE[joe] From the last step, for the curious.
+    unsigned int         IslandCount;
+    unsigned int         AwakeCount;
+    unsigned int         UsedColorCount;
+} physics_world;
+
+#endif
@@ -0,0 +1,498 @@
+/**
+ * @file physics_bench.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the physics benchmarks, and the checks that keep it
+ * honest. Two scenes are stepped across the job system, on every number of
+ * threads from one up to every core: a field of stacks, ten boxes high, and
+ * a row of pyramids. Each reports how long a step takes, how well that
+ * scales, whether the stacks stood up, and what a step costs once they've
+ * all gone to sleep. Then a scene with a bit of everything, falling boxes
+ * and a chain of joints included, is stepped on different numbers of
+ * threads, and every body has to end up exactly where it did on one thread.
+ * Platform layers run them with --bench-physics, instead of the game, and
+ * exit with an error if any check fails.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "job.h"
+#include "physics.h"
+
+#define PHYSICS_BENCH_TIME_STEP (1.0f / 60.0f)
+
+// NOTE[joe] Long enough for everything to land and settle, and for stacks
+// that are going to fall over to have done it.
+#define PHYSICS_BENCH_STEPS 180
+
+// NOTE[joe] How long stacks get to fall asleep in, and how many steps are
+// then timed with nothing awake.
+#define PHYSICS_BENCH_SLEEP_STEPS 600
+#define PHYSICS_BENCH_ASLEEP_STEPS 60
+
+#define PHYSICS_BENCH_STACK_SIDE 10
+#define PHYSICS_BENCH_STACK_HEIGHT 10
+#define PHYSICS_BENCH_PYRAMID_BASE 20
+#define PHYSICS_BENCH_PYRAMID_COUNT 4
+
+#define PHYSICS_BENCH_CHAIN_LENGTH 10
+
+// NOTE[joe] As far as a stack's top box can drop, or drift, and still count
+// as standing: a tenth of a box.
+#define PHYSICS_BENCH_TOLERANCE 0.1f
+
+#define PHYSICS_BENCH_DETERMINISM_RUNS 3
+
+// NOTE[joe] Position, rotation, and velocity and angular velocity, a
+// component each.
+#define PHYSICS_BENCH_ARRAYS 13
+
+typedef enum {
+    PHYSICS_BENCH_STACKS = 0,
+    PHYSICS_BENCH_PYRAMIDS,
+    PHYSICS_BENCH_MIXED,
+} physics_bench_scene;
+
+typedef struct {
+    memory_arena  Arena;
+    physics_world World;
+
+    // NOTE[joe] The boxes to watch, and where they started.
+    unsigned int  WatchCount;
+    unsigned int *Watched;
+    vec3         *Starts;
+} physics_bench_data;
+
+/** A box's half size on every side, and the gap left between them. */
+static const float PhysicsBenchHalf = 0.5f;
+static const float PhysicsBenchGap = 0.001f;
+
+static
+void AddPhysicsBenchGround(physics_world *World, float Size)
+{
+    AddPhysicsBody(World,
+                   vec3 { 0.0f, -1.0f, 0.0f },
+                   QuatIdentity(),
+                   vec3 { Size, 1.0f, Size },
+                   0.0f);
+}
+
+/** Columns of boxes, a little apart, each on top of the last. */
+static
+void AddPhysicsBenchStacks(physics_bench_data *Data, unsigned int Side)
+{
+    float Spacing = 2.0f;
+    float Offset = 0.5f * Spacing * (float)(Side - 1);
+    float Step = 2.0f * PhysicsBenchHalf + PhysicsBenchGap;
+
+    for (unsigned int z = 0; z < Side; z++)
+    {
+        for (unsigned int x = 0; x < Side; x++)
+        {
+            unsigned int Body = 0;
+            vec3 Position = {};
+
+            for (unsigned int y = 0; y < PHYSICS_BENCH_STACK_HEIGHT; y++)
+            {
+                Position = {
+                    Spacing * (float)x - Offset,
+                    PhysicsBenchHalf + PhysicsBenchGap + Step * (float)y,
+                    Spacing * (float)z - Offset,
+                };
+
+                Body = AddPhysicsBody(&Data->World,
+                                      Position,
+                                      QuatIdentity(),
+                                      vec3 { PhysicsBenchHalf,
+                                             PhysicsBenchHalf,
+                                             PhysicsBenchHalf },
+                                      1.0f);
+            }
+
+            Data->Watched[Data->WatchCount] = Body;
+            Data->Starts[Data->WatchCount] = Position;
+            Data->WatchCount++;
+        }
+    }
+}
+
+/** A pyramid of boxes in a wall, Base across at the bottom, at Z. */
+static
+void AddPhysicsBenchPyramid(physics_bench_data *Data,
+                            unsigned int Base,
+                            float Z)
+{
+    float Step = 2.0f * PhysicsBenchHalf + PhysicsBenchGap;
+    unsigned int Body = 0;
+    vec3 Position = {};
+
+    for (unsigned int y = 0; y < Base; y++)
+    {
+        unsigned int Count = Base - y;
+        float Left = -0.5f * Step * (float)(Count - 1);
+
+        for (unsigned int x = 0; x < Count; x++)
+        {
+            Position = {
+                Left + Step * (float)x,
+                PhysicsBenchHalf + PhysicsBenchGap + Step * (float)y,
+                Z,
+            };
+
+            Body = AddPhysicsBody(&Data->World,
+                                  Position,
+                                  QuatIdentity(),
+                                  vec3 { PhysicsBenchHalf,
+                                         PhysicsBenchHalf,
+                                         PhysicsBenchHalf },
+                                  1.0f);
+        }
+    }
+
+    Data->Watched[Data->WatchCount] = Body;
+    Data->Starts[Data->WatchCount] = Position;
+    Data->WatchCount++;
+}
+
+/** Stacks and a pyramid, with tumbling boxes dropped on them and a chain
+ * of boxes hanging from a fixed one by joints. */
+static
+void AddPhysicsBenchMixed(physics_bench_data *Data)
+{
+    physics_world *World = &Data->World;
+
+    AddPhysicsBenchStacks(Data, 3);
+    AddPhysicsBenchPyramid(Data, 8, 8.0f);
+
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        vec3 Axis = Normalize(vec3 { 1.0f, (float)i, 2.0f });
+        quat Rotation = QuatFromAxisAngle(Axis, 0.3f * (float)i);
+
+        unsigned int Body = AddPhysicsBody(World,
+                                           vec3 { -2.0f + 0.3f * (float)i,
+                                                  14.0f + 1.5f * (float)i,
+                                                  -1.0f + 0.2f * (float)i },
+                                           Rotation,
+                                           vec3 { 0.4f, 0.3f, 0.5f },
+                                           2.0f);
+
+        World->VelocityX[Body] = 0.5f * (float)(i % 3) - 0.5f;
+        World->AngularY[Body] = 0.2f * (float)i;
+    }
+
+    float Top = 12.0f;
+    unsigned int Anchor = AddPhysicsBody(World,
+                                         vec3 { -8.0f, Top, 0.0f },
+                                         QuatIdentity(),
+                                         vec3 { 0.25f, 0.25f, 0.25f },
+                                         0.0f);
+    unsigned int Previous = Anchor;
+
+    for (unsigned int i = 0; i < PHYSICS_BENCH_CHAIN_LENGTH; i++)
+    {
+        float X = -8.0f + 0.6f * (float)(i + 1);
+        unsigned int Link = AddPhysicsBody(World,
+                                           vec3 { X, Top, 0.0f },
+                                           QuatIdentity(),
+                                           vec3 { 0.25f, 0.1f, 0.1f },
+                                           0.5f);
+
+        AddPhysicsJoint(World, Previous, Link, vec3 { X - 0.3f, Top, 0.0f });
+
+        Previous = Link;
+    }
+}
+
+/** Sets up Scene from scratch, stepping on Jobs. */
+static
+void BuildPhysicsBenchScene(physics_bench_data *Data,
+                            physics_bench_scene Scene)
+{
+    InitializeArena(&Data->Arena, GIGABYTES(1), "Physics benchmark");
+
+    unsigned int Side = PHYSICS_BENCH_STACK_SIDE;
+    unsigned int Base = PHYSICS_BENCH_PYRAMID_BASE;
+    unsigned int Count = 1;
+
+    switch (Scene)
+    {
+        case PHYSICS_BENCH_STACKS:
+        {
+            Count += Side * Side * PHYSICS_BENCH_STACK_HEIGHT;
+        } break;
+
+        case PHYSICS_BENCH_PYRAMIDS:
+        {
+            Count += PHYSICS_BENCH_PYRAMID_COUNT * Base * (Base + 1) / 2;
+        } break;
+
+        case PHYSICS_BENCH_MIXED:
+        {
+            Count += 9 * PHYSICS_BENCH_STACK_HEIGHT + 36 + 16 + 1 +
+                     PHYSICS_BENCH_CHAIN_LENGTH;
+        } break;
+    }
+
+    Data->WatchCount = 0;
+    Data->Watched = PushArray(&Data->Arena, unsigned int, Count);
+    Data->Starts = PushArray(&Data->Arena, vec3, Count);
+
+    // NOTE[joe] Boxes in stacks and pyramids touch a handful of others.
+    InitializePhysics(&Data->World,
+                      &Data->Arena,
+                      Count,
+                      8 * Count,
+                      PHYSICS_BENCH_CHAIN_LENGTH);
+
+    AddPhysicsBenchGround(&Data->World, 100.0f);
+
+    switch (Scene)
+    {
+        case PHYSICS_BENCH_STACKS:
+        {
+            AddPhysicsBenchStacks(Data, Side);
+        } break;
+
+        case PHYSICS_BENCH_PYRAMIDS:
+        {
+            for (unsigned int i = 0; i < PHYSICS_BENCH_PYRAMID_COUNT; i++)
+            {
+                AddPhysicsBenchPyramid(Data, Base, 3.0f * (float)i);
+            }
+        } break;
+
+        case PHYSICS_BENCH_MIXED:
+        {
+            AddPhysicsBenchMixed(Data);
+        } break;
+    }
+
+    Assert(Data->World.Count == Count, "Physics benchmark miscounted.\n");
+}
+
+/** How far the watched boxes dropped and drifted from where they started,
+ * at most. */
+static
+void MeasurePhysicsBenchScene(physics_bench_data *Data,
+                              float *Drop,
+                              float *Drift)
+{
+    *Drop = 0.0f;
+    *Drift = 0.0f;
+
+    for (unsigned int i = 0; i < Data->WatchCount; i++)
+    {
+        unsigned int Body = Data->Watched[i];
+        vec3 Start = Data->Starts[i];
+        vec3 Offset = vec3 { Data->World.PositionX[Body],
+                             Data->World.PositionY[Body],
+                             Data->World.PositionZ[Body] } - Start;
+
+        float Sideways = sqrtf(Offset.x * Offset.x + Offset.z * Offset.z);
+
+        *Drop = -Offset.y > *Drop ? -Offset.y : *Drop;
+        *Drift = Sideways > *Drift ? Sideways : *Drift;
+    }
+}
+
+/** Times Scene on every number of threads, then checks it stood up and
+ * went to sleep. Returns false if it didn't. */
+static
+bool BenchmarkPhysicsScene(physics_bench_data *Data,
+                           physics_bench_scene Scene,
+                           const char *Name)
+{
+    unsigned int CoreCount = PlatformGetCoreCount();
+    job_system *Jobs = new job_system;
+    double SingleTime = 0.0;
+    bool IsCorrect = true;
+
+    for (unsigned int Workers = 1; Workers <= CoreCount; Workers++)
+    {
+        InitializeJobSystem(Jobs, Workers);
+        BuildPhysicsBenchScene(Data, Scene);
+
+        physics_world *World = &Data->World;
+
+        // NOTE[joe] Kept awake, so every step has the whole scene to solve,
+        // and it has to keep standing up on its own the whole time.
+        // Everything's moving while it lands, so every step is timed, not
+        // just the best one.
+        World->SleepTime = INFINITY;
+
+        double Begin = PlatformGetTime();
+
+        for (unsigned int Step = 0; Step < PHYSICS_BENCH_STEPS; Step++)
+        {
+            StepPhysics(World, Jobs, PHYSICS_BENCH_TIME_STEP);
+        }
+
+        double Time = (PlatformGetTime() - Begin) / PHYSICS_BENCH_STEPS;
+
+        if (Workers == 1)
+        {
+            SingleTime = Time;
+
+            float Drop;
+            float Drift;
+            MeasurePhysicsBenchScene(Data, &Drop, &Drift);
+
+            printf("physics_%s_bodies %u\n", Name, World->Count - 1);
+            printf("physics_%s_manifolds %u\n", Name, World->PreviousCount);
+            printf("physics_%s_colors %u\n", Name, World->UsedColorCount);
+            printf("physics_%s_overflow %u\n",
+                   Name,
+                   World->Colors[PHYSICS_OVERFLOW_COLOR].BatchCount);
+            printf("physics_%s_drop %.4f\n", Name, Drop);
+            printf("physics_%s_drift %.4f\n", Name, Drift);
+
+            IsCorrect &= Drop < PHYSICS_BENCH_TOLERANCE &&
+                         Drift < PHYSICS_BENCH_TOLERANCE;
+
+            /** Let it all fall asleep, and see what that costs. */
+
+            World->SleepTime = PHYSICS_SLEEP_TIME;
+
+            for (unsigned int Step = 0;
+                 Step < PHYSICS_BENCH_SLEEP_STEPS && World->AwakeCount;
+                 Step++)
+            {
+                StepPhysics(World, Jobs, PHYSICS_BENCH_TIME_STEP);
+            }
+
+            printf("physics_%s_awake %u\n", Name, World->AwakeCount);
+
+            Begin = PlatformGetTime();
+
+            for (unsigned int Step = 0;
+                 Step < PHYSICS_BENCH_ASLEEP_STEPS;
+                 Step++)
+            {
+                StepPhysics(World, Jobs, PHYSICS_BENCH_TIME_STEP);
+            }
+
+            double Asleep =
+                (PlatformGetTime() - Begin) / PHYSICS_BENCH_ASLEEP_STEPS;
+
+            printf("physics_%s_asleep_ms %.3f\n", Name, Asleep * 1000.0);
+
+            IsCorrect &= World->AwakeCount == 0;
+        }
+
+        printf("physics_%s_%u_ms %.3f\n", Name, Workers, Time * 1000.0);
+        printf("physics_%s_%u_efficiency %.2f\n",
+               Name,
+               Workers,
+               SingleTime / (Time * Workers));
+
+        ReleaseArena(&Data->Arena);
+        ShutdownJobSystem(Jobs);
+    }
+
+    delete Jobs;
+
+    return IsCorrect;
+}
+
+/** Steps the mixed scene on different numbers of threads, and checks every
+ * body ends up in exactly the same state. */
+static
+bool CheckPhysicsDeterminism(physics_bench_data *Data)
+{
+    unsigned int WorkerCounts[PHYSICS_BENCH_DETERMINISM_RUNS] = { 1, 2, 4 };
+    physics_bench_data *Reference = new physics_bench_data;
+    job_system *Jobs = new job_system;
+    bool IsSame = true;
+
+    for (unsigned int Run = 0; Run < PHYSICS_BENCH_DETERMINISM_RUNS; Run++)
+    {
+        physics_bench_data *Current = Run == 0 ? Reference : Data;
+
+        InitializeJobSystem(Jobs, WorkerCounts[Run]);
+        BuildPhysicsBenchScene(Current, PHYSICS_BENCH_MIXED);
+
+        for (unsigned int Step = 0; Step < PHYSICS_BENCH_STEPS; Step++)
+        {
+            StepPhysics(&Current->World, Jobs, PHYSICS_BENCH_TIME_STEP);
+        }
+
+        ShutdownJobSystem(Jobs);
+
+        if (Run == 0)
+        {
+            continue;
+        }
+
+        physics_world *A = &Reference->World;
+        physics_world *B = &Current->World;
+        size_t Size = sizeof(float) * A->Count;
+
+        float *ArraysA[PHYSICS_BENCH_ARRAYS] = {
+            A->PositionX, A->PositionY, A->PositionZ,
+            A->RotationX, A->RotationY, A->RotationZ, A->RotationW,
+            A->VelocityX, A->VelocityY, A->VelocityZ,
+            A->AngularX, A->AngularY, A->AngularZ,
+        };
+        float *ArraysB[PHYSICS_BENCH_ARRAYS] = {
+            B->PositionX, B->PositionY, B->PositionZ,
+            B->RotationX, B->RotationY, B->RotationZ, B->RotationW,
+            B->VelocityX, B->VelocityY, B->VelocityZ,
+            B->AngularX, B->AngularY, B->AngularZ,
+        };
+
+        bool IsRunSame = A->Count == B->Count &&
+                         memcmp(A->IsAwake, B->IsAwake, A->Count) == 0;
+
+        for (unsigned int i = 0; i < PHYSICS_BENCH_ARRAYS; i++)
+        {
+            IsRunSame &= memcmp(ArraysA[i], ArraysB[i], Size) == 0;
+        }
+
+        printf("physics_deterministic_%u_threads %d\n",
+               WorkerCounts[Run],
+               IsRunSame ? 1 : 0);
+
+        IsSame &= IsRunSame;
+
+        ReleaseArena(&Current->Arena);
+    }
+
+    physics_world *World = &Reference->World;
+    printf("physics_mixed_awake %u\n", World->AwakeCount);
+    printf("physics_mixed_islands %u\n", World->IslandCount);
+
+    ReleaseArena(&Reference->Arena);
+
+    delete Jobs;
+    delete Reference;
+
+    return IsSame;
+}
+
+/** Runs every physics check and benchmark and prints the results. Returns
+ * false if anything fell over or came out different. */
+static
+bool BenchmarkPhysics()
+{
+    physics_bench_data *Data = new physics_bench_data;
+
+    printf("physics_backend %s\n", physics_backend::Name);
+    printf("physics_threads %u\n", PlatformGetCoreCount());
+
+    bool IsCorrect = true;
+
+    IsCorrect &= BenchmarkPhysicsScene(Data, PHYSICS_BENCH_STACKS, "stacks");
+    IsCorrect &=
+        BenchmarkPhysicsScene(Data, PHYSICS_BENCH_PYRAMIDS, "pyramids");
+
+    bool IsDeterministic = CheckPhysicsDeterminism(Data);
+
+    printf("physics_deterministic %d\n", IsDeterministic ? 1 : 0);
+    printf("physics_correct %d\n", IsCorrect && IsDeterministic ? 1 : 0);
+
+    delete Data;
+
+    return IsCorrect && IsDeterministic;
+}
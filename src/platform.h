@@ -11,8 +11,7 @@
 #ifndef _PLATFORM_H_
 #define _PLATFORM_H_
 
-// TODO[joe] Create size macros for better handling memory things?
-#define PLATFORM_MAX_SHADER_SIZE 16384
+#include "memory.h"
 
 #ifdef DEBUG
 static void Assert(bool, const char*);
@@ -26,7 +25,81 @@ static void Assert(bool, const char*);
 
 static void Abort(const char*);
 
-static inline
-VkShaderModule PlatformLoadShader(vulkan_context, const char*);
+/** Writes a printf style message to wherever the platform keeps its logs. */
+static void PlatformLog(const char*, ...);
+
+/** Returns a monotonic, high resolution time in seconds. */
+static double PlatformGetTime();
+
+/** Sleeps the calling thread until PlatformGetTime() reaches Time. */
+static void PlatformSleepUntil(double);
+
+// NOTE[joe] Threads and semaphores are opaque here; each platform layer
+// defines the structs. They're pushed onto whatever arena they're created
+// with, so they have to be joined or destroyed before it's reset.
+typedef struct platform_thread platform_thread;
+typedef struct platform_semaphore platform_semaphore;
+
+typedef void platform_thread_proc(void *Data);
+
+/** Starts a thread running Proc(Data). */
+static platform_thread *PlatformCreateThread(memory_arena *Arena,
+                                             platform_thread_proc *Proc,
+                                             void *Data);
+
+/** Waits for Thread to return, then closes it. */
+static void PlatformJoinThread(platform_thread *Thread);
+
+static platform_semaphore *PlatformCreateSemaphore(memory_arena *Arena,
+                                                   unsigned int Count);
+static void PlatformWaitSemaphore(platform_semaphore *Semaphore);
+/** Waits on Semaphore for at most Microseconds. Returns true if it was
+ * signalled, false if the time ran out first. */
+static bool PlatformWaitSemaphoreTimeout(platform_semaphore *Semaphore,
+                                         unsigned int Microseconds);
+static void PlatformSignalSemaphore(platform_semaphore *Semaphore);
+static void PlatformDestroySemaphore(platform_semaphore *Semaphore);
+
+// NOTE[joe] Fibers are threads we switch between ourselves. A thread has to
+// be converted into one before it can switch to any other. Like threads,
+// they live on the arena they're created (or converted) with.
+typedef struct platform_fiber platform_fiber;
+
+static platform_fiber *PlatformConvertThreadToFiber(memory_arena *Arena);
+static void PlatformConvertFiberToThread(platform_fiber *Fiber);
+
+/** Creates a fiber that will run Proc(Data) on a stack of StackSize bytes,
+ * with a guard page below it. Proc must never return. */
+static platform_fiber *PlatformCreateFiber(memory_arena *Arena,
+                                           unsigned int StackSize,
+                                           platform_thread_proc *Proc,
+                                           void *Data);
+static void PlatformDestroyFiber(platform_fiber *Fiber);
+
+/** Saves the calling fiber's state into From, then switches to To. */
+static void PlatformSwitchToFiber(platform_fiber *From, platform_fiber *To);
+
+/** Gives up the rest of the calling thread's time slice. */
+static void PlatformYield();
+
+/** Returns how many physical cores the machine has. */
+static unsigned int PlatformGetCoreCount();
+
+/** Reserves Size bytes of address space, without any memory behind it yet.
+ * Returns 0 if the reservation failed. */
+static void *PlatformReserveMemory(size_t Size);
+
+/** Backs Size bytes of a reservation, starting at Address, with zeroed memory
+ * we can read and write. Returns false if the system is out of memory. */
+static bool PlatformCommitMemory(void *Address, size_t Size);
+
+/** Gives back a whole reservation, committed or not. */
+static void PlatformReleaseMemory(void *Address, size_t Size);
+
+/** Reads all of FilePath into memory, which the caller frees with delete[].
+ * Returns 0 if the file couldn't be read. Blocks; see io.h for doing it
+ * without. */
+static unsigned char *PlatformReadEntireFile(const char *FilePath,
+                                             unsigned int *Size);
 
 #endif
@@ -0,0 +1,613 @@
+/**
+ * @file render.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our platform independent rendering code. Platform layers
+ * call GameInitialize() once Vulkan is up, and GameRender() every frame.
+ */
+
+#include "platform.h"
+#include "render.h"
+#include "job.h"
+#include "io.h"
+#include "task.h"
+
+// NOTE[joe] Temporary globals
+static pipeline_desc TrianglePipeline;
+
+/** Reads a SPIR-V file and creates a shader module from it. */
+static
+task<VkShaderModule> LoadShaderAsync(vulkan_context *Context,
+                                     io_queue *IO,
+                                     const char *FilePath)
+{
+    file_contents File = co_await ReadFileAsync(IO, FilePath);
+
+    Assert(File.Data != 0, "Failed to load shader.\n");
+
+    VkShaderModuleCreateInfo ShaderModuleCreateInfo = {};
+    ShaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    ShaderModuleCreateInfo.codeSize = File.Size;
+    ShaderModuleCreateInfo.pCode = (uint32_t *)File.Data;
+
+    VkShaderModule ShaderModule;
+    VkResult Result =
+        vkCreateShaderModule(Context->Device,
+                             &ShaderModuleCreateInfo,
+                             GetHostAllocator(Context, HOST_TAG_PIPELINE),
+                             &ShaderModule);
+
+    Assert(Result == VK_SUCCESS, "Failed to create shader module.\n");
+
+    FreeFileContents(&File);
+
+    co_return ShaderModule;
+}
+
+/** Loads our shaders and compiles the pipelines that use them. */
+static
+task<void> LoadPipelinesAsync(vulkan_context *Context,
+                              job_system *Jobs,
+                              io_queue *IO)
+{
+    // NOTE[joe] Both reads are queued before we wait on either, so they're
+    // in flight together.
+    // TODO[joe] Figure out how to better get the shader path.
+    task<VkShaderModule> VertexShader =
+        LoadShaderAsync(Context, IO, "../data/spirv/simple.vert.spv");
+    task<VkShaderModule> FragShader =
+        LoadShaderAsync(Context, IO, "../data/spirv/simple.frag.spv");
+
+    // NOTE[joe] The CPU skinning path doesn't need a shader at all.
+    bool IsGpuSkinning = Context->Skinning.Path == SKIN_PATH_GPU;
+    task<VkShaderModule> SkinShader;
+
+    if (IsGpuSkinning)
+    {
+        SkinShader =
+            LoadShaderAsync(Context, IO, "../data/spirv/skin.comp.spv");
+    }
+
+    // NOTE[joe] Nor do particles, when they're turned off.
+    bool HasParticles = Context->Particles.MaxCount != 0;
+    task<VkShaderModule> SimulateShader;
+    task<VkShaderModule> EmitShader;
+    task<VkShaderModule> FinalizeShader;
+    task<VkShaderModule> ParticleVertexShader;
+    task<VkShaderModule> ParticleFragShader;
+
+    if (HasParticles)
+    {
+        SimulateShader = LoadShaderAsync(
+            Context, IO, "../data/spirv/particle_simulate.comp.spv");
+        EmitShader = LoadShaderAsync(
+            Context, IO, "../data/spirv/particle_emit.comp.spv");
+        FinalizeShader = LoadShaderAsync(
+            Context, IO, "../data/spirv/particle_finalize.comp.spv");
+        ParticleVertexShader = LoadShaderAsync(
+            Context, IO, "../data/spirv/particle.vert.spv");
+        ParticleFragShader = LoadShaderAsync(
+            Context, IO, "../data/spirv/particle.frag.spv");
+    }
+
+    task<VkShaderModule> CullShader =
+        LoadShaderAsync(Context, IO, "../data/spirv/hzb_cull.comp.spv");
+    task<VkShaderModule> ReduceShader =
+        LoadShaderAsync(Context, IO, "../data/spirv/hzb_reduce.comp.spv");
+
+    TrianglePipeline.VertexShader = co_await VertexShader;
+    TrianglePipeline.FragmentShader = co_await FragShader;
+
+    VkShaderModule SkinModule = VK_NULL_HANDLE;
+
+    if (IsGpuSkinning)
+    {
+        SkinModule = co_await SkinShader;
+    }
+
+    particle_system *Particles = &Context->Particles;
+    VkShaderModule SimulateModule = VK_NULL_HANDLE;
+    VkShaderModule EmitModule = VK_NULL_HANDLE;
+    VkShaderModule FinalizeModule = VK_NULL_HANDLE;
+
+    if (HasParticles)
+    {
+        SimulateModule = co_await SimulateShader;
+        EmitModule = co_await EmitShader;
+        FinalizeModule = co_await FinalizeShader;
+        Particles->DrawPipeline.VertexShader = co_await ParticleVertexShader;
+        Particles->DrawPipeline.FragmentShader = co_await ParticleFragShader;
+    }
+
+    VkShaderModule CullModule = co_await CullShader;
+    VkShaderModule ReduceModule = co_await ReduceShader;
+
+    // NOTE[joe] If every read beat us here we'd still be on the thread that
+    // called us, so make sure the compile happens on a worker.
+    co_await ScheduleOn(Jobs);
+
+    // NOTE[joe] The pipeline manager isn't thread safe. That's fine while
+    // nothing else can be using it, like here during initialization, but
+    // compiling pipelines from tasks while we're rendering would need a lock
+    // around it first.
+    GetPipeline(Context, &TrianglePipeline);
+
+    if (IsGpuSkinning)
+    {
+        CreateSkinPipeline(Context, SkinModule);
+    }
+
+    if (HasParticles)
+    {
+        Particles->SimulatePipeline =
+            CreateParticlePipeline(Context, SimulateModule);
+        Particles->EmitPipeline = CreateParticlePipeline(Context, EmitModule);
+        Particles->FinalizePipeline =
+            CreateParticlePipeline(Context, FinalizeModule);
+
+        GetPipeline(Context, &Particles->DrawPipeline);
+    }
+
+    cull_system *Culling = &Context->Culling;
+    Culling->CullPipeline =
+        CreateCullPipeline(Context, CullModule, Culling->CullLayout);
+    Culling->ReducePipeline =
+        CreateCullPipeline(Context, ReduceModule, Culling->ReduceLayout);
+}
+
+/** Loads our shaders and creates the pipelines we draw with. Meshes that
+ * have to stay around on the CPU are allocated from Arena. ParticleCount is
+ * the most particles there can be at once, or zero for none. */
+static
+void GameInitialize(vulkan_context *Context,
+                    job_system *Jobs,
+                    io_queue *IO,
+                    memory_arena *Arena,
+                    unsigned int ParticleCount)
+{
+    /** Set up skinning, particles and culling, which the pipelines below
+     * depend on. */
+
+    skin_vertex *Strip = PushArray(Arena, skin_vertex, SKIN_STRIP_VERTEX_COUNT);
+    BuildSkinStrip(Strip);
+
+    InitializeSkinRenderer(Context, Strip, SKIN_STRIP_VERTEX_COUNT);
+    InitializeParticleSystem(Context, Arena, ParticleCount);
+    InitializeCulling(Context);
+    SubmitSetup(Context);
+
+    /** Create our pipeline layout. */
+
+    // NOTE[joe] Each draw's render_instance goes in through push constants.
+    VkPushConstantRange PushConstantRange = {};
+    PushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    PushConstantRange.size = sizeof(render_instance);
+
+    VkPipelineLayoutCreateInfo LayoutCreateInfo = {};
+    LayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    LayoutCreateInfo.pushConstantRangeCount = 1;
+    LayoutCreateInfo.pPushConstantRanges = &PushConstantRange;
+
+    VkResult Result =
+        vkCreatePipelineLayout(Context->Device,
+                               &LayoutCreateInfo,
+                               GetHostAllocator(Context, HOST_TAG_PIPELINE),
+                               &Context->PipelineLayout);
+
+    Assert(Result == VK_SUCCESS, "Failed to create pipeline layout.\n");
+
+    /** Create our graphics pipeline. */
+
+    // NOTE[joe] On devices with extended dynamic state, only the shaders and
+    // blending here actually pick a pipeline. The rest is set when GameRender()
+    // binds it.
+    TrianglePipeline.Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    TrianglePipeline.PolygonMode = VK_POLYGON_MODE_FILL;
+    TrianglePipeline.CullMode = VK_CULL_MODE_NONE;
+    TrianglePipeline.FrontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    TrianglePipeline.DepthTestEnable = true;
+    TrianglePipeline.DepthWriteEnable = true;
+    TrianglePipeline.DepthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+    // Create it now rather than on the first frame.
+    task<void> Pipelines = LoadPipelinesAsync(Context, Jobs, IO);
+
+    /** Create what each frame synchronizes with. */
+
+    VkSemaphoreCreateInfo SemaphoreCreateInfo = {};
+    SemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    vkCreateSemaphore(Context->Device,
+                      &SemaphoreCreateInfo,
+                      GetHostAllocator(Context, HOST_TAG_SYNC),
+                      &Context->PresentCompletedSemaphore);
+    vkCreateSemaphore(Context->Device,
+                      &SemaphoreCreateInfo,
+                      GetHostAllocator(Context, HOST_TAG_SYNC),
+                      &Context->RenderingCompletedSemaphore);
+
+    VkFenceCreateInfo FenceCreateInfo = {};
+    FenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    vkCreateFence(Context->Device,
+                  &FenceCreateInfo,
+                  GetHostAllocator(Context, HOST_TAG_SYNC),
+                  &Context->RenderFence);
+
+    WaitForTask(Jobs, &Pipelines);
+}
+
+typedef struct {
+    VkDevice Device;
+    VkFence  Fence;
+} render_fence_wait;
+
+static
+bool IsRenderFenceSignalled(void *Data)
+{
+    render_fence_wait *Wait = (render_fence_wait *)Data;
+
+    return vkGetFenceStatus(Wait->Device, Wait->Fence) == VK_SUCCESS;
+}
+
+static
+void BlockOnRenderFence(void *Data, unsigned int Microseconds)
+{
+    render_fence_wait *Wait = (render_fence_wait *)Data;
+
+    vkWaitForFences(Wait->Device,
+                    1,
+                    &Wait->Fence,
+                    VK_TRUE,
+                    Microseconds * 1000ull);
+}
+
+/** Flushes whatever the pass is waiting on, and begins it in CommandBuffer,
+ * drawing into the present image at ImageIndex and the depth buffer. The
+ * first pass of a frame clears them; any after it carry on from what the last
+ * one drew. */
+static
+void BeginScenePass(vulkan_context *Context,
+                    VkCommandBuffer CommandBuffer,
+                    unsigned int ImageIndex,
+                    bool IsFirst)
+{
+    resource_tracker *Resources = &Context->Resources;
+
+    UseImage(Resources,
+             Context->PresentImages[ImageIndex],
+             RESOURCE_USAGE_COLOR_ATTACHMENT);
+    UseImage(Resources, Context->DepthImage, RESOURCE_USAGE_DEPTH_ATTACHMENT);
+
+    FlushBarriers(Resources, CommandBuffer);
+
+    VkClearValue ClearValues[] = {
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        { 1.0f, 0.0f }
+    };
+
+    VkRect2D RenderArea = { 0, 0, Context->Width, Context->Height };
+
+    if (Context->UseDynamicRendering)
+    {
+        VkAttachmentLoadOp LoadOp = IsFirst ? VK_ATTACHMENT_LOAD_OP_CLEAR :
+                                              VK_ATTACHMENT_LOAD_OP_LOAD;
+
+        VkRenderingAttachmentInfoKHR ColorAttachment = {};
+        ColorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        ColorAttachment.imageView = Context->PresentImageViews[ImageIndex];
+        ColorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        ColorAttachment.loadOp = LoadOp;
+        ColorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        ColorAttachment.clearValue = ClearValues[0];
+
+        VkRenderingAttachmentInfoKHR DepthAttachment = {};
+        DepthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        DepthAttachment.imageView = Context->DepthImageView;
+        DepthAttachment.imageLayout =
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        DepthAttachment.loadOp = LoadOp;
+        DepthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        DepthAttachment.clearValue = ClearValues[1];
+
+        VkRenderingInfoKHR RenderingInfo = {};
+        RenderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+        RenderingInfo.renderArea = RenderArea;
+        RenderingInfo.layerCount = 1;
+        RenderingInfo.colorAttachmentCount = 1;
+        RenderingInfo.pColorAttachments = &ColorAttachment;
+        RenderingInfo.pDepthAttachment = &DepthAttachment;
+
+        // NOTE[joe] Combined depth/stencil formats have to be bound as both.
+        if (Context->DepthAspect & VK_IMAGE_ASPECT_STENCIL_BIT)
+        {
+            RenderingInfo.pStencilAttachment = &DepthAttachment;
+        }
+
+        vkCmdBeginRenderingKHR(CommandBuffer, &RenderingInfo);
+    }
+    else
+    {
+        VkRenderPassBeginInfo RenderPassBeginInfo = {};
+        RenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        RenderPassBeginInfo.renderPass =
+            IsFirst ? Context->RenderPass : Context->LoadRenderPass;
+        RenderPassBeginInfo.framebuffer = Context->Framebuffers[ImageIndex];
+        RenderPassBeginInfo.renderArea = RenderArea;
+        RenderPassBeginInfo.clearValueCount = 2;
+        RenderPassBeginInfo.pClearValues = ClearValues;
+
+        vkCmdBeginRenderPass(CommandBuffer,
+                             &RenderPassBeginInfo,
+                             VK_SUBPASS_CONTENTS_INLINE);
+    }
+
+    BindPipeline(Context, CommandBuffer, &TrianglePipeline);
+
+    VkViewport Viewport = {};
+    Viewport.width = Context->Width;
+    Viewport.height = Context->Height;
+    Viewport.maxDepth = 1;
+    vkCmdSetViewport(CommandBuffer, 0, 1, &Viewport);
+
+    vkCmdSetScissor(CommandBuffer, 0, 1, &RenderArea);
+}
+
+/** Ends the pass BeginScenePass() began. */
+static
+void EndScenePass(vulkan_context *Context, VkCommandBuffer CommandBuffer)
+{
+    if (Context->UseDynamicRendering)
+    {
+        vkCmdEndRenderingKHR(CommandBuffer);
+    }
+    else
+    {
+        vkCmdEndRenderPass(CommandBuffer);
+    }
+}
+
+/** Records the draws of Packet's that Phase's pass could draw into
+ * CommandBuffer: those visible last frame for phase zero, and the rest for
+ * phase one. Each is an indirect draw whose instance count Phase's cull pass
+ * set to one or zero. Only safe once last frame's fence has signalled. */
+static
+void RecordSceneDraws(vulkan_context *Context,
+                      VkCommandBuffer CommandBuffer,
+                      const render_packet *Packet,
+                      unsigned int Phase)
+{
+    VkBuffer SkinnedBuffer = Context->Skinning.SkinnedBuffer;
+    VkBuffer ArgsBuffer = Context->Culling.ArgsBuffer;
+    VkDeviceSize ArgsOffset =
+        Phase * RENDER_MAX_DRAWS * sizeof(VkDrawIndirectCommand);
+
+    // NOTE[joe] Last frame's visibility, which is what the first pass' cull
+    // goes by. Whatever it says is visible gets drawn in the first pass, and
+    // can't be in the second, so each draw only gets recorded into one.
+    const unsigned int *WasVisible = Context->Culling.VisibilityMapped;
+
+    VkDeviceSize Offsets = {};
+    VkBuffer BoundBuffer = VK_NULL_HANDLE;
+
+    for (unsigned int DrawIndex = 0;
+         DrawIndex < Packet->DrawCount;
+         DrawIndex++)
+    {
+        if ((WasVisible[DrawIndex] != 0) != (Phase == 0))
+        {
+            continue;
+        }
+
+        const render_draw *Draw = &Packet->Draws[DrawIndex];
+
+        VkBuffer VertexBuffer =
+            Draw->IsSkinned ? SkinnedBuffer : Context->VertexInputBuffer;
+
+        if (VertexBuffer != BoundBuffer)
+        {
+            vkCmdBindVertexBuffers(CommandBuffer,
+                                   0,
+                                   1,
+                                   &VertexBuffer,
+                                   &Offsets);
+
+            BoundBuffer = VertexBuffer;
+        }
+
+        vkCmdPushConstants(CommandBuffer,
+                           Context->PipelineLayout,
+                           VK_SHADER_STAGE_VERTEX_BIT,
+                           0,
+                           sizeof(render_instance),
+                           &Draw->Instance);
+
+        // NOTE[joe] Every draw has its own push constants, and comes from one
+        // of two vertex buffers, so they can't be batched into one multi-draw.
+        // That's also what keeps us off VK_KHR_draw_indirect_count (which is
+        // fine on 1.1): a count the GPU decides only helps once the transform
+        // comes from a buffer indexed by the draw and every draw's vertices
+        // are in one buffer. So the second pass still records everything
+        // that was hidden last frame, at a push and a draw each, even though
+        // the GPU skips most of them with an instance count of zero.
+        vkCmdDrawIndirect(CommandBuffer,
+                          ArgsBuffer,
+                          ArgsOffset +
+                          DrawIndex * sizeof(VkDrawIndirectCommand),
+                          1,
+                          sizeof(VkDrawIndirectCommand));
+    }
+}
+
+/** Records, submits and presents one frame of Packet. */
+static
+void GameRender(vulkan_context *Context,
+                job_system *Jobs,
+                const render_packet *Packet)
+{
+    // NOTE[joe] Evict before we record anything, so nothing this frame uses
+    // gets pulled out from under it.
+    UpdateMemoryBudget(Context);
+
+    // NOTE[joe] Every frame waits for its submit to finish before it
+    // presents, and the present is queued ahead of our next submit, so these
+    // are free to use again by the time we get here.
+    VkSemaphore PresentCompletedSemaphore =
+        Context->PresentCompletedSemaphore;
+    VkSemaphore RenderingCompletedSemaphore =
+        Context->RenderingCompletedSemaphore;
+
+    unsigned int NextImageIndex;
+    vkAcquireNextImageKHR(Context->Device,
+                          Context->SwapChain,
+                          UINT64_MAX,
+                          PresentCompletedSemaphore,
+                          VK_NULL_HANDLE,
+                          &NextImageIndex);
+
+    VkImage PresentImage = Context->PresentImages[NextImageIndex];
+    resource_tracker *Resources = &Context->Resources;
+
+    // NOTE[joe] The stats only cover the last frame rendered.
+    Resources->Stats = {};
+
+    // The queue submit below waits for the acquire at this stage, so our
+    // first use of the present image has to chain off of it.
+    VkPipelineStageFlags WaitStageMask =
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+    AcquireImage(Resources, PresentImage, WaitStageMask);
+
+    VkCommandBufferBeginInfo BeginInfo = {};
+    BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(Context->DrawCommandBuffer, &BeginInfo);
+
+    /** Skin everything once, for every pass to draw from. */
+
+    VkBuffer SkinnedBuffer = Context->Skinning.SkinnedBuffer;
+
+    if (Packet->JointCount)
+    {
+        RecordSkinning(Context,
+                       Jobs,
+                       Context->DrawCommandBuffer,
+                       Packet->Joints,
+                       Packet->JointCount);
+    }
+
+    /** Move particles while the depth buffer still has last frame in it. */
+
+    particle_system *Particles = &Context->Particles;
+
+    if (Particles->MaxCount)
+    {
+        RecordParticles(Context,
+                        Context->DrawCommandBuffer,
+                        &Packet->Particles);
+    }
+
+    /** Draw whatever was visible last frame. */
+
+    cull_system *Culling = &Context->Culling;
+    VkCommandBuffer CommandBuffer = Context->DrawCommandBuffer;
+
+    WriteCullDraws(Context, Packet);
+    RecordCullPass(Context, CommandBuffer, 0, Packet->DrawCount);
+
+    UseBuffer(Resources, Culling->ArgsBuffer, RESOURCE_USAGE_INDIRECT_BUFFER);
+    UseBuffer(Resources,
+              Context->VertexInputBuffer,
+              RESOURCE_USAGE_VERTEX_BUFFER);
+    UseBuffer(Resources, SkinnedBuffer, RESOURCE_USAGE_VERTEX_BUFFER);
+
+    BeginScenePass(Context, CommandBuffer, NextImageIndex, true);
+    RecordSceneDraws(Context, CommandBuffer, Packet, 0);
+    EndScenePass(Context, CommandBuffer);
+
+    /** Test everything against what that drew, and draw what it missed. */
+
+    RecordDepthPyramid(Context, CommandBuffer);
+    RecordCullPass(Context, CommandBuffer, 1, Packet->DrawCount);
+
+    UseBuffer(Resources, Culling->ArgsBuffer, RESOURCE_USAGE_INDIRECT_BUFFER);
+
+    if (Particles->MaxCount)
+    {
+        UseBuffer(Resources,
+                  Particles->ArgsBuffer,
+                  RESOURCE_USAGE_INDIRECT_BUFFER);
+        UseBuffer(Resources, Particles->PoolBuffer, RESOURCE_USAGE_VERTEX_READ);
+        UseBuffer(Resources,
+                  Particles->AliveBuffer,
+                  RESOURCE_USAGE_VERTEX_READ);
+    }
+
+    BeginScenePass(Context, CommandBuffer, NextImageIndex, false);
+    RecordSceneDraws(Context, CommandBuffer, Packet, 1);
+
+    // NOTE[joe] After everything opaque, since particles test against the
+    // depth it leaves.
+    if (Particles->MaxCount)
+    {
+        DrawParticles(Context, CommandBuffer, &Packet->Particles);
+    }
+
+    EndScenePass(Context, CommandBuffer);
+
+    /** Convert image from attachment layout back to present layout. */
+
+    UseImage(Resources, PresentImage, RESOURCE_USAGE_PRESENT);
+    UseBuffer(Resources, Culling->StatsBuffer, RESOURCE_USAGE_HOST_READ);
+    UseBuffer(Resources, Culling->VisibilityBuffer, RESOURCE_USAGE_HOST_READ);
+    FlushBarriers(Resources, Context->DrawCommandBuffer);
+
+    // NOTE[joe] Resources->Stats now has what this frame cost in barriers.
+    // RecordBarrierBenchFrame() makes the same uses on a reference frame,
+    // for --bench-barriers to check, so keep it in step with this.
+
+    vkEndCommandBuffer(Context->DrawCommandBuffer);
+
+    /** Submit our draw commands and present our image. */
+
+    VkFence RenderFence = Context->RenderFence;
+
+    VkSubmitInfo SubmitInfo = {};
+    SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    SubmitInfo.waitSemaphoreCount = 1;
+    SubmitInfo.pWaitSemaphores = &PresentCompletedSemaphore;
+    SubmitInfo.pWaitDstStageMask = &WaitStageMask;
+    SubmitInfo.commandBufferCount = 1;
+    SubmitInfo.pCommandBuffers = &Context->DrawCommandBuffer;
+    SubmitInfo.signalSemaphoreCount = 1;
+    SubmitInfo.pSignalSemaphores = &RenderingCompletedSemaphore;
+
+    vkQueueSubmit(Context->PresentQueue, 1, &SubmitInfo, RenderFence);
+
+    // NOTE[joe] Rather than block the thread until the GPU is done, get some
+    // other work done in the meantime. We only block on the fence, a little
+    // at a time, once there's none left.
+    render_fence_wait FenceWait = { Context->Device, RenderFence };
+    WaitForJobCondition(Jobs,
+                        IsRenderFenceSignalled,
+                        BlockOnRenderFence,
+                        &FenceWait);
+    vkResetFences(Context->Device, 1, &RenderFence);
+
+    ReadCullStats(Context);
+
+    VkPresentInfoKHR PresentInfo = {};
+    PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    PresentInfo.waitSemaphoreCount = 1;
+    PresentInfo.pWaitSemaphores = &RenderingCompletedSemaphore;
+    PresentInfo.swapchainCount = 1;
+    PresentInfo.pSwapchains = &Context->SwapChain;
+    PresentInfo.pImageIndices = &NextImageIndex;
+
+    // Submits the contents of our presnt queue to be draw to the screen.
+    vkQueuePresentKHR(Context->PresentQueue, &PresentInfo);
+
+    EndHostAllocatorFrame(&Context->HostAllocator);
+}
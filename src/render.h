@@ -10,26 +10,50 @@
 #ifndef _RENDER_H_
 #define _RENDER_H_
 
+#include "vulkan_barrier.h"
+#include "vulkan_upload.h"
+#include "vulkan_memory.h"
+#include "vulkan_pipeline.h"
+#include "vulkan_allocator.h"
+#include "transform.h"
+#include "skinning.h"
+#include "particles.h"
+#include "culling.h"
+
 // TODO[joe] Downsize this so that we're not carrying around all this bloat.
 typedef struct {
     unsigned int    Width;
     unsigned int    Height;
     VkInstance      Instance;
+    // NOTE[joe] The API version we asked for when creating Instance.
+    unsigned int    ApiVersion;
     VkDevice        Device;
     VkQueue         PresentQueue;
     VkCommandBuffer SetupCommandBuffer;
     VkCommandBuffer DrawCommandBuffer;
     VkSwapchainKHR  SwapChain;
     VkImage*        PresentImages;
+    VkImageView*    PresentImageViews;
+    VkFormat        ColorFormat;
     VkImage         DepthImage;
     VkImageView     DepthImageView;
+    VkFormat        DepthFormat;
+    VkImageAspectFlags DepthAspect;
+    // NOTE[joe] These are only created when UseDynamicRendering is false.
+    // LoadRenderPass loads what's there instead of clearing it.
     VkRenderPass    RenderPass;
+    VkRenderPass    LoadRenderPass;
     VkFramebuffer*  Framebuffers;
+    bool            UseDynamicRendering;
     // TODO[joe] Do we want to keep the vertex buffer here?
     // Or would it be more prudent to keep a vertex buffer separately for each
     // model we have?
     VkBuffer        VertexInputBuffer;
-    VkPipeline      Pipeline;
+    // NOTE[joe] Reused every frame, rather than created and destroyed with
+    // it, so that the driver doesn't allocate on every frame.
+    VkSemaphore     PresentCompletedSemaphore;
+    VkSemaphore     RenderingCompletedSemaphore;
+    VkFence         RenderFence;
     VkPipelineLayout                 PipelineLayout;
     VkDebugReportCallbackEXT         Callback;
     VkSurfaceKHR                     Surface;
@@ -37,10 +61,67 @@ typedef struct {
     VkPhysicalDeviceProperties       PhysicalDeviceProperties;
     VkPhysicalDeviceMemoryProperties MemoryProperties;
     unsigned int                     PresentQueueIndex;
+    // NOTE[joe] This needs to outlive a single frame, which is why GameRender()
+    // takes the context by pointer.
+    resource_tracker                 Resources;
+    setup_context                    Setup;
+    memory_tracker                   Memory;
+    host_allocator                   HostAllocator;
+    pipeline_manager                 Pipelines;
+    skin_renderer                    Skinning;
+    particle_system                  Particles;
+    cull_system                      Culling;
 } vulkan_context;
 
 typedef struct {
     float x, y, z, w;
 } vertex;
 
+// NOTE[joe] Every draw that isn't skinned is this triangle, from the start of
+// the vertex buffer. The game culls against it too, so it lives here.
+#define RENDER_TRIANGLE_VERTEX_COUNT 3
+
+static const vertex RenderTriangle[RENDER_TRIANGLE_VERTEX_COUNT] = {
+    { -1.0f, -1.0f, 0.0f, 1.0f },
+    {  1.0f, -1.0f, 0.0f, 1.0f },
+    {  0.0f,  1.0f, 0.0f, 1.0f },
+};
+
+// NOTE[joe] The most draws one render_packet can hold.
+#define RENDER_MAX_DRAWS 1024
+
+/** Per-instance data, handed to the vertex shader as push constants. */
+typedef struct {
+    mat4 Transform;
+} render_instance;
+
+typedef struct {
+    unsigned int    VertexCount;
+    // NOTE[joe] Skinned draws come from the skinned vertex buffer instead.
+    bool            IsSkinned;
+    render_instance Instance;
+    // NOTE[joe] Around every vertex the draw has, in the space Instance's
+    // Transform takes them from. The GPU culls against these.
+    vec3            BoundsMin;
+    vec3            BoundsMax;
+} render_draw;
+
+/** Everything GameRender() needs from the simulation for one frame. The game
+ * builds these, and nothing in here points back into game state, so the
+ * render thread can work from one while the next is being built. */
+typedef struct {
+    unsigned long long Tick;
+    unsigned int       DrawCount;
+    render_draw        Draws[RENDER_MAX_DRAWS];
+
+    // NOTE[joe] Every skinned vertex is skinned by this palette, once for the
+    // whole frame. Zero joints means there's nothing to skin.
+    unsigned int       JointCount;
+    mat4               Joints[SKIN_MAX_JOINTS];
+
+    // NOTE[joe] Particles are simulated every frame whether or not this
+    // emits anything.
+    particle_emitter   Particles;
+} render_packet;
+
 #endif
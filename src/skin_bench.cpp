@@ -0,0 +1,234 @@
+/**
+ * @file skin_bench.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the CPU skinning benchmarks. Every kernel the build can
+ * run is checked against the scalar one and timed on one thread, then the
+ * one the game uses is timed across the job system. Platform layers run them
+ * with --bench-skin, instead of the game, and exit with an error if any
+ * kernel disagrees with the scalar one.
+ *
+ * The GPU path isn't in here, since benchmarks run without a device. Its
+ * counterpart is the skinned draw in a headless run's frame times.
+ */
+
+#include "platform.h"
+#include "job.h"
+#include "skinning.h"
+
+// NOTE[joe] A crowd's worth: 64 characters of 4096 vertices each.
+#define SKIN_BENCH_VERTICES (1 << 18)
+#define SKIN_BENCH_JOINTS 64
+#define SKIN_BENCH_RUNS 16
+
+// NOTE[joe] Largest error allowed, relative to the size of the value (or
+// absolute, below one). FMA and the order things get summed in are all that
+// should differ.
+#define SKIN_BENCH_TOLERANCE 1e-5
+
+typedef struct {
+    mat4        *Palette;
+    skin_vertex *Vertices;
+    vec4        *Reference;
+    vec4        *Result;
+} skin_bench_data;
+
+static
+float SkinBenchRandom(unsigned int *Random, float Low, float High)
+{
+    *Random ^= *Random << 13;
+    *Random ^= *Random >> 17;
+    *Random ^= *Random << 5;
+
+    return Low + (High - Low) * (float)(*Random & 0xFFFFFF) / 16777216.0f;
+}
+
+/** How far Result is from Reference, at worst. */
+static
+double SkinBenchError(skin_bench_data *Data)
+{
+    double Worst = 0.0;
+
+    for (unsigned int i = 0; i < SKIN_BENCH_VERTICES; i++)
+    {
+        const float *Values = &Data->Result[i].x;
+        const float *References = &Data->Reference[i].x;
+
+        for (unsigned int k = 0; k < 4; k++)
+        {
+            double Reference = References[k];
+            double Scale = fabs(Reference) > 1.0 ? fabs(Reference) : 1.0;
+            double Error = fabs((double)Values[k] - Reference) / Scale;
+
+            if (Error > Worst)
+            {
+                Worst = Error;
+            }
+        }
+    }
+
+    return Worst;
+}
+
+/** Checks backend against the scalar kernel and prints how far off it was
+ * and how fast it went. Returns false if it's out of tolerance. */
+template <typename backend>
+static
+bool BenchmarkSkinBackend(skin_bench_data *Data)
+{
+    skin_kernels<backend>::Skin(Data->Palette,
+                                Data->Vertices,
+                                Data->Result,
+                                SKIN_BENCH_VERTICES);
+
+    double Error = SkinBenchError(Data);
+
+    double Best = 1e9;
+
+    for (unsigned int Run = 0; Run < SKIN_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        skin_kernels<backend>::Skin(Data->Palette,
+                                    Data->Vertices,
+                                    Data->Result,
+                                    SKIN_BENCH_VERTICES);
+
+        double Time = PlatformGetTime() - Begin;
+        Best = Time < Best ? Time : Best;
+    }
+
+    printf("skin_%s_error %.3g\n", backend::Name, Error);
+    printf("skin_%s_vertices_per_ms %.0f\n",
+           backend::Name,
+           SKIN_BENCH_VERTICES / (Best * 1000.0));
+
+    return Error <= SKIN_BENCH_TOLERANCE;
+}
+
+/** Runs every skinning check and benchmark and prints the results. Returns
+ * false if any kernel got something wrong. */
+static
+bool BenchmarkSkinning()
+{
+    skin_bench_data Data;
+    Data.Palette = new mat4[SKIN_BENCH_JOINTS];
+    Data.Vertices = new skin_vertex[SKIN_BENCH_VERTICES];
+    Data.Reference = new vec4[SKIN_BENCH_VERTICES];
+    Data.Result = new vec4[SKIN_BENCH_VERTICES];
+
+    unsigned int Random = 0x2545F491;
+
+    for (unsigned int i = 0; i < SKIN_BENCH_JOINTS; i++)
+    {
+        vec3 Axis = {
+            SkinBenchRandom(&Random, -1.0f, 1.0f),
+            SkinBenchRandom(&Random, -1.0f, 1.0f),
+            SkinBenchRandom(&Random, 0.1f, 1.0f)
+        };
+
+        quat Rotation =
+            QuatFromAxisAngle(Normalize(Axis),
+                              SkinBenchRandom(&Random, -MATH_PI, MATH_PI));
+
+        vec3 Translation = {
+            SkinBenchRandom(&Random, -2.0f, 2.0f),
+            SkinBenchRandom(&Random, -2.0f, 2.0f),
+            SkinBenchRandom(&Random, -2.0f, 2.0f)
+        };
+
+        Data.Palette[i] = Mat4FromTransform(Translation,
+                                            Rotation,
+                                            { 1.0f, 1.0f, 1.0f });
+    }
+
+    // NOTE[joe] Neighbouring vertices share joints, like a real mesh's do.
+    for (unsigned int i = 0; i < SKIN_BENCH_VERTICES; i++)
+    {
+        skin_vertex *Vertex = &Data.Vertices[i];
+
+        Vertex->Position = {
+            SkinBenchRandom(&Random, -1.0f, 1.0f),
+            SkinBenchRandom(&Random, -1.0f, 1.0f),
+            SkinBenchRandom(&Random, -1.0f, 1.0f)
+        };
+
+        unsigned int Base = (i / 64) % (SKIN_BENCH_JOINTS - 3);
+        Vertex->Joints = Base |
+                         (Base + 1) << 8 |
+                         (Base + 2) << 16 |
+                         (Base + 3) << 24;
+
+        float *Weights = &Vertex->Weights.x;
+        float Total = 0.0f;
+
+        for (unsigned int k = 0; k < SKIN_INFLUENCES; k++)
+        {
+            Weights[k] = SkinBenchRandom(&Random, 0.0f, 1.0f);
+            Total += Weights[k];
+        }
+
+        Vertex->Weights = Vertex->Weights / Total;
+    }
+
+    skin_kernels<math_scalar>::Skin(Data.Palette,
+                                    Data.Vertices,
+                                    Data.Reference,
+                                    SKIN_BENCH_VERTICES);
+
+    printf("skin_vertices %u\n", SKIN_BENCH_VERTICES);
+    printf("skin_backend %s\n", skin_backend::Name);
+
+    bool IsAccurate = BenchmarkSkinBackend<math_scalar>(&Data);
+
+#if MATH_HAS_SSE
+    IsAccurate &= BenchmarkSkinBackend<math_sse>(&Data);
+#endif
+
+#if MATH_HAS_AVX2
+    IsAccurate &= BenchmarkSkinBackend<math_avx2>(&Data);
+#endif
+
+    /** The game's kernel across the job system, as the CPU path runs it. */
+
+    unsigned int CoreCount = PlatformGetCoreCount();
+
+    job_system *Jobs = new job_system;
+
+    InitializeJobSystem(Jobs, CoreCount);
+
+    double Best = 1e9;
+
+    for (unsigned int Run = 0; Run < SKIN_BENCH_RUNS; Run++)
+    {
+        double Begin = PlatformGetTime();
+
+        SkinVerticesParallel(Jobs,
+                             Data.Palette,
+                             Data.Vertices,
+                             Data.Result,
+                             SKIN_BENCH_VERTICES);
+
+        double Time = PlatformGetTime() - Begin;
+        Best = Time < Best ? Time : Best;
+    }
+
+    ShutdownJobSystem(Jobs);
+
+    delete Jobs;
+
+    IsAccurate &= SkinBenchError(&Data) <= SKIN_BENCH_TOLERANCE;
+
+    printf("skin_parallel_%u_vertices_per_ms %.0f\n",
+           CoreCount,
+           SKIN_BENCH_VERTICES / (Best * 1000.0));
+    printf("skin_accurate %d\n", IsAccurate ? 1 : 0);
+
+    delete[] Data.Palette;
+    delete[] Data.Vertices;
+    delete[] Data.Reference;
+    delete[] Data.Result;
+
+    return IsAccurate;
+}
@@ -0,0 +1,560 @@
+/**
+ * @file skinning.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our skinning: the CPU kernels, and the buffers and
+ * compute pipeline the GPU path runs with. See skinning.h.
+ */
+
+#include "platform.h"
+#include "render.h"
+#include "job.h"
+#include "skinning.h"
+
+template <typename backend>
+struct skin_kernels;
+
+/** The palette entry for the k'th of Vertex's joints. */
+static inline
+const mat4 *GetSkinJoint(const mat4 *Palette,
+                         const skin_vertex *Vertex,
+                         unsigned int k)
+{
+    return &Palette[(Vertex->Joints >> (8 * k)) & 0xFF];
+}
+
+/** Blends each vertex's joints by weight, then transforms it by the blend.
+ * Every other backend is checked against this one. */
+template <>
+struct skin_kernels<math_scalar> {
+    static inline
+    void Skin(const mat4 *Palette,
+              const skin_vertex *Vertices,
+              vec4 *Result,
+              unsigned int Count)
+    {
+        for (unsigned int i = 0; i < Count; i++)
+        {
+            const skin_vertex *Vertex = &Vertices[i];
+            const float *Weights = &Vertex->Weights.x;
+
+            mat4 Blend = {};
+
+            for (unsigned int k = 0; k < SKIN_INFLUENCES; k++)
+            {
+                const mat4 *Joint = GetSkinJoint(Palette, Vertex, k);
+
+                for (unsigned int Column = 0; Column < 4; Column++)
+                {
+                    Blend.Columns[Column] = Blend.Columns[Column] +
+                                            Joint->Columns[Column] * Weights[k];
+                }
+            }
+
+            Result[i] = Blend * Vec4(Vertex->Position, 1.0f);
+        }
+    }
+};
+
+#if MATH_HAS_SSE
+
+/** One column of the blend per register. */
+template <>
+struct skin_kernels<math_sse> {
+    static inline
+    void Skin(const mat4 *Palette,
+              const skin_vertex *Vertices,
+              vec4 *Result,
+              unsigned int Count)
+    {
+        for (unsigned int i = 0; i < Count; i++)
+        {
+            const skin_vertex *Vertex = &Vertices[i];
+            const float *Weights = &Vertex->Weights.x;
+
+            __m128 C0 = _mm_setzero_ps();
+            __m128 C1 = _mm_setzero_ps();
+            __m128 C2 = _mm_setzero_ps();
+            __m128 C3 = _mm_setzero_ps();
+
+            for (unsigned int k = 0; k < SKIN_INFLUENCES; k++)
+            {
+                const mat4 *Joint = GetSkinJoint(Palette, Vertex, k);
+                __m128 Weight = _mm_set1_ps(Weights[k]);
+
+                __m128 J0 = _mm_load_ps(&Joint->Columns[0].x);
+                __m128 J1 = _mm_load_ps(&Joint->Columns[1].x);
+                __m128 J2 = _mm_load_ps(&Joint->Columns[2].x);
+                __m128 J3 = _mm_load_ps(&Joint->Columns[3].x);
+
+                C0 = _mm_add_ps(C0, _mm_mul_ps(J0, Weight));
+                C1 = _mm_add_ps(C1, _mm_mul_ps(J1, Weight));
+                C2 = _mm_add_ps(C2, _mm_mul_ps(J2, Weight));
+                C3 = _mm_add_ps(C3, _mm_mul_ps(J3, Weight));
+            }
+
+            __m128 Position = _mm_setr_ps(Vertex->Position.x,
+                                          Vertex->Position.y,
+                                          Vertex->Position.z,
+                                          1.0f);
+
+            _mm_store_ps(&Result[i].x,
+                         math_kernels<math_sse>::Combine(C0, C1, C2, C3,
+                                                         Position));
+        }
+    }
+};
+
+#endif
+
+#if MATH_HAS_AVX2
+
+/** Two columns of the blend per register, so a joint is two FMAs. */
+template <>
+struct skin_kernels<math_avx2> {
+    static inline
+    void Skin(const mat4 *Palette,
+              const skin_vertex *Vertices,
+              vec4 *Result,
+              unsigned int Count)
+    {
+        // NOTE[joe] Spreads x, y, z across the halves of a register. Lane 3
+        // of a loaded position is Joints, so it's never picked.
+        __m256i SplatXY = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+        __m256i SplatZ = _mm256_set1_epi32(2);
+        __m256 Ones = _mm256_set1_ps(1.0f);
+
+        for (unsigned int i = 0; i < Count; i++)
+        {
+            const skin_vertex *Vertex = &Vertices[i];
+            const float *Weights = &Vertex->Weights.x;
+
+            __m256 C01 = _mm256_setzero_ps();
+            __m256 C23 = _mm256_setzero_ps();
+
+            for (unsigned int k = 0; k < SKIN_INFLUENCES; k++)
+            {
+                const mat4 *Joint = GetSkinJoint(Palette, Vertex, k);
+                __m256 Weight = _mm256_set1_ps(Weights[k]);
+
+                // NOTE[joe] mat4 is only 16 byte aligned.
+                C01 = _mm256_fmadd_ps(_mm256_loadu_ps(&Joint->Columns[0].x),
+                                      Weight,
+                                      C01);
+                C23 = _mm256_fmadd_ps(_mm256_loadu_ps(&Joint->Columns[2].x),
+                                      Weight,
+                                      C23);
+            }
+
+            __m256 Position =
+                _mm256_castps128_ps256(_mm_loadu_ps(&Vertex->Position.x));
+
+            __m256 XY = _mm256_permutevar8x32_ps(Position, SplatXY);
+            __m256 Z1 = _mm256_blend_ps(
+                _mm256_permutevar8x32_ps(Position, SplatZ),
+                Ones,
+                0xF0);
+
+            // NOTE[joe] x * C0 + z * C2 in the low half, y * C1 + C3 in the
+            // high half.
+            __m256 Sum = _mm256_fmadd_ps(C01, XY, _mm256_mul_ps(C23, Z1));
+
+            _mm_store_ps(&Result[i].x,
+                         _mm_add_ps(_mm256_castps256_ps128(Sum),
+                                    _mm256_extractf128_ps(Sum, 1)));
+        }
+    }
+};
+
+#endif
+
+// NOTE[joe] NEON goes through the scalar kernel for now.
+#if MATH_HAS_AVX2
+typedef math_avx2 skin_backend;
+#elif MATH_HAS_SSE
+typedef math_sse skin_backend;
+#else
+typedef math_scalar skin_backend;
+#endif
+
+/** Skins Count vertices by Palette into Result, on this thread. */
+static
+void SkinVertices(const mat4 *Palette,
+                  const skin_vertex *Vertices,
+                  vec4 *Result,
+                  unsigned int Count)
+{
+    skin_kernels<skin_backend>::Skin(Palette, Vertices, Result, Count);
+}
+
+typedef struct {
+    const mat4        *Palette;
+    const skin_vertex *Vertices;
+    vec4              *Result;
+} skin_job_data;
+
+static
+void SkinVerticesJob(void *Data, unsigned int Start, unsigned int End)
+{
+    skin_job_data *Job = (skin_job_data *)Data;
+
+    SkinVertices(Job->Palette,
+                 Job->Vertices + Start,
+                 Job->Result + Start,
+                 End - Start);
+}
+
+/** Skins Count vertices by Palette into Result across Jobs, and waits. */
+static
+void SkinVerticesParallel(job_system *Jobs,
+                          const mat4 *Palette,
+                          const skin_vertex *Vertices,
+                          vec4 *Result,
+                          unsigned int Count)
+{
+    skin_job_data Data = { Palette, Vertices, Result };
+
+    ParallelForAndWait(Jobs, SkinVerticesJob, &Data, Count, SKIN_MIN_CHUNK);
+}
+
+/** Fills Vertices with SKIN_STRIP_VERTEX_COUNT vertices of the strip. It's
+ * one unit tall, rigid on joint 0 at the bottom and on joint 1 at the top,
+ * and blends between the two around joint 1, halfway up. */
+static
+void BuildSkinStrip(skin_vertex *Vertices)
+{
+    unsigned int Count = 0;
+
+    for (unsigned int Segment = 0; Segment < SKIN_STRIP_SEGMENTS; Segment++)
+    {
+        float Bottom = (float)Segment / SKIN_STRIP_SEGMENTS;
+        float Top = (float)(Segment + 1) / SKIN_STRIP_SEGMENTS;
+
+        // NOTE[joe] Two triangles, each counter clockwise.
+        float Corners[6][2] = {
+            { -0.1f, Bottom }, { 0.1f, Bottom }, { 0.1f, Top },
+            { -0.1f, Bottom }, { 0.1f, Top },    { -0.1f, Top },
+        };
+
+        for (unsigned int i = 0; i < 6; i++)
+        {
+            float Blend = (Corners[i][1] - 0.25f) / 0.5f;
+            Blend = Blend < 0.0f ? 0.0f : (Blend > 1.0f ? 1.0f : Blend);
+
+            skin_vertex *Vertex = &Vertices[Count++];
+            Vertex->Position = { Corners[i][0], Corners[i][1], 0.0f };
+            Vertex->Joints = 0 | (1 << 8);
+            Vertex->Weights = { 1.0f - Blend, Blend, 0.0f, 0.0f };
+        }
+    }
+}
+
+/** Creates a buffer of Size bytes and binds it to memory with Flags. */
+static
+VkBuffer CreateSkinBuffer(vulkan_context *Context,
+                          VkDeviceSize Size,
+                          VkBufferUsageFlags Usage,
+                          VkMemoryPropertyFlags Flags,
+                          VkDeviceMemory *Memory)
+{
+    VkBufferCreateInfo BufferInfo = {};
+    BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    BufferInfo.size = Size;
+    BufferInfo.usage = Usage;
+    BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkBuffer Buffer;
+    VkResult Result = vkCreateBuffer(Context->Device,
+                                     &BufferInfo,
+                                     GetHostAllocator(Context, HOST_TAG_BUFFER),
+                                     &Buffer);
+
+    Assert(Result == VK_SUCCESS, "Failed to create skinning buffer.\n");
+
+    *Memory = AllocateBufferMemory(Context, Buffer, Flags, Flags);
+
+    return Buffer;
+}
+
+/** Sets up skinning Count Vertices, and queues their upload on the setup
+ * context. Vertices has to outlive the renderer, since the CPU path skins
+ * straight from it. */
+static
+void InitializeSkinRenderer(vulkan_context *Context,
+                            const skin_vertex *Vertices,
+                            unsigned int Count)
+{
+    skin_renderer *Skin = &Context->Skinning;
+
+    Assert(Count <= SKIN_MAX_VERTICES, "Too many skinned vertices.\n");
+
+    Skin->VertexCount = Count;
+    Skin->Vertices = Vertices;
+
+    // NOTE[joe] A CPU device would just be running our shader on the CPU,
+    // and not as well as the SIMD kernels do.
+    Skin->Path =
+        Context->PhysicalDeviceProperties.deviceType ==
+            VK_PHYSICAL_DEVICE_TYPE_CPU ? SKIN_PATH_CPU : SKIN_PATH_GPU;
+
+    VkDeviceMemory Memory;
+
+    Skin->SkinnedBuffer =
+        CreateSkinBuffer(Context,
+                         Count * sizeof(vec4),
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                         VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                         &Memory);
+
+    TrackBuffer(&Context->Resources, Skin->SkinnedBuffer);
+
+    VkMemoryPropertyFlags Mappable = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    if (Skin->Path == SKIN_PATH_CPU)
+    {
+        // NOTE[joe] Only ever written by us and read by a copy, so the
+        // tracker doesn't need to know about it.
+        Skin->HostBuffer = CreateSkinBuffer(Context,
+                                            Count * sizeof(vec4),
+                                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                            Mappable,
+                                            &Skin->HostMemory);
+
+        VkResult Result = vkMapMemory(Context->Device,
+                                      Skin->HostMemory,
+                                      0,
+                                      VK_WHOLE_SIZE,
+                                      0,
+                                      (void **)&Skin->HostMapped);
+
+        Assert(Result == VK_SUCCESS, "Failed to map skinning buffer.\n");
+
+        return;
+    }
+
+    /** Create the buffers the shader reads. */
+
+    Skin->SourceBuffer =
+        CreateSkinBuffer(Context,
+                         Count * sizeof(skin_vertex),
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                         VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                         &Memory);
+
+    TrackBuffer(&Context->Resources, Skin->SourceBuffer);
+
+    UploadToBuffer(Context,
+                   Skin->SourceBuffer,
+                   0,
+                   Vertices,
+                   Count * sizeof(skin_vertex));
+
+    // NOTE[joe] Same as HostBuffer, host writes are made visible by the
+    // submit, so this one isn't tracked either.
+    Skin->PaletteBuffer = CreateSkinBuffer(Context,
+                                           SKIN_MAX_JOINTS * sizeof(mat4),
+                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                           Mappable,
+                                           &Skin->PaletteMemory);
+
+    VkResult Result = vkMapMemory(Context->Device,
+                                  Skin->PaletteMemory,
+                                  0,
+                                  VK_WHOLE_SIZE,
+                                  0,
+                                  (void **)&Skin->PaletteMapped);
+
+    Assert(Result == VK_SUCCESS, "Failed to map joint palette.\n");
+
+    /** Describe them to the shader. */
+
+    VkDescriptorSetLayoutBinding Bindings[3] = {};
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        Bindings[i].binding = i;
+        Bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        Bindings[i].descriptorCount = 1;
+        Bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo SetLayoutInfo = {};
+    SetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    SetLayoutInfo.bindingCount = 3;
+    SetLayoutInfo.pBindings = Bindings;
+
+    const VkAllocationCallbacks *Allocator =
+        GetHostAllocator(Context, HOST_TAG_PIPELINE);
+
+    Result = vkCreateDescriptorSetLayout(Context->Device,
+                                         &SetLayoutInfo,
+                                         Allocator,
+                                         &Skin->SetLayout);
+
+    Assert(Result == VK_SUCCESS, "Failed to create skinning set layout.\n");
+
+    VkDescriptorPoolSize PoolSize = {};
+    PoolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    PoolSize.descriptorCount = 3;
+
+    VkDescriptorPoolCreateInfo PoolInfo = {};
+    PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    PoolInfo.maxSets = 1;
+    PoolInfo.poolSizeCount = 1;
+    PoolInfo.pPoolSizes = &PoolSize;
+
+    Result = vkCreateDescriptorPool(Context->Device,
+                                    &PoolInfo,
+                                    Allocator,
+                                    &Skin->DescriptorPool);
+
+    Assert(Result == VK_SUCCESS, "Failed to create skinning descriptors.\n");
+
+    VkDescriptorSetAllocateInfo SetInfo = {};
+    SetInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    SetInfo.descriptorPool = Skin->DescriptorPool;
+    SetInfo.descriptorSetCount = 1;
+    SetInfo.pSetLayouts = &Skin->SetLayout;
+
+    Result = vkAllocateDescriptorSets(Context->Device,
+                                      &SetInfo,
+                                      &Skin->DescriptorSet);
+
+    Assert(Result == VK_SUCCESS, "Failed to allocate skinning descriptors.\n");
+
+    // NOTE[joe] The buffers never change, so the set is written once.
+    VkDescriptorBufferInfo BufferInfos[3] = {
+        { Skin->PaletteBuffer, 0, VK_WHOLE_SIZE },
+        { Skin->SourceBuffer, 0, VK_WHOLE_SIZE },
+        { Skin->SkinnedBuffer, 0, VK_WHOLE_SIZE },
+    };
+
+    VkWriteDescriptorSet Writes[3] = {};
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        Writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        Writes[i].dstSet = Skin->DescriptorSet;
+        Writes[i].dstBinding = i;
+        Writes[i].descriptorCount = 1;
+        Writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        Writes[i].pBufferInfo = &BufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(Context->Device, 3, Writes, 0, 0);
+
+    /** The vertex count goes in through a push constant. */
+
+    VkPushConstantRange PushConstantRange = {};
+    PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    PushConstantRange.size = sizeof(unsigned int);
+
+    VkPipelineLayoutCreateInfo LayoutInfo = {};
+    LayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    LayoutInfo.setLayoutCount = 1;
+    LayoutInfo.pSetLayouts = &Skin->SetLayout;
+    LayoutInfo.pushConstantRangeCount = 1;
+    LayoutInfo.pPushConstantRanges = &PushConstantRange;
+
+    Result = vkCreatePipelineLayout(Context->Device,
+                                    &LayoutInfo,
+                                    Allocator,
+                                    &Skin->PipelineLayout);
+
+    Assert(Result == VK_SUCCESS, "Failed to create skinning layout.\n");
+}
+
+/** Creates the GPU path's compute pipeline from Shader. */
+static
+void CreateSkinPipeline(vulkan_context *Context, VkShaderModule Shader)
+{
+    skin_renderer *Skin = &Context->Skinning;
+
+    VkComputePipelineCreateInfo PipelineInfo = {};
+    PipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    PipelineInfo.stage.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    PipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    PipelineInfo.stage.module = Shader;
+    PipelineInfo.stage.pName = "main";
+    PipelineInfo.layout = Skin->PipelineLayout;
+
+    VkResult Result =
+        vkCreateComputePipelines(Context->Device,
+                                 Context->Pipelines.Cache,
+                                 1,
+                                 &PipelineInfo,
+                                 GetHostAllocator(Context, HOST_TAG_PIPELINE),
+                                 &Skin->Pipeline);
+
+    Assert(Result == VK_SUCCESS, "Failed to create skinning pipeline.\n");
+}
+
+/** Skins every skinned vertex by Palette into Context's SkinnedBuffer,
+ * recording whatever that takes into CommandBuffer. Leaves the buffer for
+ * the caller to transition to however it draws from it. */
+static
+void RecordSkinning(vulkan_context *Context,
+                    job_system *Jobs,
+                    VkCommandBuffer CommandBuffer,
+                    const mat4 *Palette,
+                    unsigned int JointCount)
+{
+    skin_renderer *Skin = &Context->Skinning;
+    resource_tracker *Resources = &Context->Resources;
+
+    Assert(JointCount <= SKIN_MAX_JOINTS, "Too many joints.\n");
+
+    if (Skin->Path == SKIN_PATH_CPU)
+    {
+        SkinVerticesParallel(Jobs,
+                             Palette,
+                             Skin->Vertices,
+                             Skin->HostMapped,
+                             Skin->VertexCount);
+
+        UseBuffer(Resources, Skin->SkinnedBuffer, RESOURCE_USAGE_TRANSFER_DST);
+        FlushBarriers(Resources, CommandBuffer);
+
+        VkBufferCopy Region = {};
+        Region.size = Skin->VertexCount * sizeof(vec4);
+
+        vkCmdCopyBuffer(CommandBuffer,
+                        Skin->HostBuffer,
+                        Skin->SkinnedBuffer,
+                        1, &Region);
+
+        return;
+    }
+
+    memcpy(Skin->PaletteMapped, Palette, JointCount * sizeof(mat4));
+
+    UseBuffer(Resources, Skin->SourceBuffer, RESOURCE_USAGE_COMPUTE_READ);
+    UseBuffer(Resources, Skin->SkinnedBuffer, RESOURCE_USAGE_COMPUTE_WRITE);
+    FlushBarriers(Resources, CommandBuffer);
+
+    vkCmdBindPipeline(CommandBuffer,
+                      VK_PIPELINE_BIND_POINT_COMPUTE,
+                      Skin->Pipeline);
+    vkCmdBindDescriptorSets(CommandBuffer,
+                            VK_PIPELINE_BIND_POINT_COMPUTE,
+                            Skin->PipelineLayout,
+                            0,
+                            1, &Skin->DescriptorSet,
+                            0, 0);
+    vkCmdPushConstants(CommandBuffer,
+                       Skin->PipelineLayout,
+                       VK_SHADER_STAGE_COMPUTE_BIT,
+                       0,
+                       sizeof(unsigned int),
+                       &Skin->VertexCount);
+    vkCmdDispatch(CommandBuffer,
+                  (Skin->VertexCount + SKIN_GROUP_SIZE - 1) / SKIN_GROUP_SIZE,
+                  1,
+                  1);
+}
@@ -0,0 +1,82 @@
+/**
+ * @file skinning.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for our skinning. Every skinned vertex
+ * is skinned exactly once a frame, into one buffer of plain vertices that
+ * every pass then draws from like any other vertex buffer, so the cost of
+ * skinning doesn't go up with the number of passes a mesh is drawn in.
+ *
+ * Normally a compute shader does the skinning. On devices where the "GPU" is
+ * really the CPU (lavapipe, SwiftShader) we skin on the CPU instead, with
+ * the widest SIMD the build has, across the job system, and copy the result
+ * in.
+ */
+
+#ifndef _SKINNING_H_
+#define _SKINNING_H_
+
+#include "linear_math.h"
+
+// NOTE[joe] Joint indices are bytes, so a palette can't be bigger than this.
+#define SKIN_MAX_JOINTS 256
+#define SKIN_MAX_VERTICES 65536
+#define SKIN_INFLUENCES 4
+
+// NOTE[joe] Has to match local_size_x in skin.comp.
+#define SKIN_GROUP_SIZE 64
+
+// NOTE[joe] CPU skinning hands out this many vertices per job at least.
+#define SKIN_MIN_CHUNK 1024
+
+/** The same layout as the shader's, under std430. Joints packs one joint
+ * index per byte, lowest byte first; Weights add up to one. */
+typedef struct {
+    vec3         Position;
+    unsigned int Joints;
+    vec4         Weights;
+} skin_vertex;
+
+typedef enum {
+    SKIN_PATH_GPU = 0,
+    SKIN_PATH_CPU,
+} skin_path;
+
+// NOTE[joe] The only skinned mesh we have, for now: a strip standing on the
+// origin with one joint at the bottom and one halfway up.
+#define SKIN_STRIP_SEGMENTS 8
+#define SKIN_STRIP_VERTEX_COUNT (SKIN_STRIP_SEGMENTS * 6)
+#define SKIN_STRIP_JOINT_COUNT 2
+
+typedef struct {
+    skin_path              Path;
+    unsigned int           VertexCount;
+
+    // NOTE[joe] What gets drawn from. Skinned once a frame, on either path.
+    VkBuffer               SkinnedBuffer;
+
+    /** GPU path. */
+
+    VkBuffer               SourceBuffer;
+    // NOTE[joe] Persistently mapped and rewritten every frame. That's only
+    // safe because GameRender() waits for each frame before the next.
+    VkBuffer               PaletteBuffer;
+    VkDeviceMemory         PaletteMemory;
+    mat4                  *PaletteMapped;
+    VkDescriptorSetLayout  SetLayout;
+    VkDescriptorPool       DescriptorPool;
+    VkDescriptorSet        DescriptorSet;
+    VkPipelineLayout       PipelineLayout;
+    VkPipeline             Pipeline;
+
+    /** CPU path. */
+
+    const skin_vertex     *Vertices;
+    // NOTE[joe] Mapped the same way as PaletteBuffer, for the same reason.
+    VkBuffer               HostBuffer;
+    VkDeviceMemory         HostMemory;
+    vec4                  *HostMapped;
+} skin_renderer;
+
+#endif
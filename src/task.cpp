@@ -0,0 +1,99 @@
+/**
+ * @file task.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the things tasks can co_await besides each other: moving
+ * onto a worker, and file reads. See task.h.
+ */
+
+#include "platform.h"
+#include "job.h"
+#include "io.h"
+#include "task.h"
+
+/** Resumes the task whose address is in Data. */
+static
+void ResumeTaskJob(job_system *, job *, void *Data)
+{
+    std::coroutine_handle<>::from_address(*(void **)Data).resume();
+}
+
+/** Hands the rest of the awaiting task to the job system. */
+struct schedule_awaiter {
+    job_system *Jobs;
+
+    bool await_ready() noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> Handle) noexcept
+    {
+        void *Address = Handle.address();
+
+        RunJob(Jobs, CreateJob(Jobs,
+                               ResumeTaskJob,
+                               &Address,
+                               sizeof(Address),
+                               0));
+    }
+
+    void await_resume() noexcept {}
+};
+
+/** co_await this to carry on as a job, e.g. to get off of the thread that
+ * started the task, or to spread work started in a loop across workers. */
+static
+schedule_awaiter ScheduleOn(job_system *Jobs)
+{
+    return schedule_awaiter { Jobs };
+}
+
+/** Resumes the task whose address is Data, once its read is done. */
+static
+void ResumeTaskAfterRead(job_system *, void *Data)
+{
+    std::coroutine_handle<>::from_address(Data).resume();
+}
+
+struct read_file_awaiter {
+    io_queue      *Queue;
+    const char    *FilePath;
+    // NOTE[joe] The awaiter lives in the task's frame while it's suspended,
+    // so the I/O thread can write straight into this.
+    file_contents  Result;
+
+    bool await_ready() noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> Handle) noexcept
+    {
+        QueueFileRead(Queue,
+                      FilePath,
+                      &Result,
+                      ResumeTaskAfterRead,
+                      Handle.address());
+    }
+
+    file_contents await_resume() noexcept { return Result; }
+};
+
+/** co_await this to read all of FilePath without blocking. The task resumes
+ * as a job once the read is done. */
+static
+read_file_awaiter ReadFileAsync(io_queue *Queue, const char *FilePath)
+{
+    return read_file_awaiter { Queue, FilePath, {} };
+}
+
+template <typename type>
+static
+bool IsTaskDone(void *Data)
+{
+    return ((task<type> *)Data)->IsDone();
+}
+
+/** Waits for Task from outside of any task. See WaitForJobCondition(). */
+template <typename type>
+static
+void WaitForTask(job_system *Jobs, task<type> *Task)
+{
+    WaitForJobCondition(Jobs, IsTaskDone<type>, 0, Task);
+}
@@ -0,0 +1,189 @@
+/**
+ * @file task.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for tasks: coroutines that run on the job
+ * system. A task starts running as soon as it's called, on the calling thread,
+ * up until the first thing it has to wait for. Starting a bunch of tasks and
+ * only then co_await-ing them is how you get their waits to overlap.
+ *
+ * Whatever resumes a task (a worker, an I/O thread handing back a read) runs
+ * it from there, so anything that can't be done on an arbitrary job thread
+ * has to happen before the first co_await or after the task's been waited on.
+ */
+
+#ifndef _TASK_H_
+#define _TASK_H_
+
+#include <atomic>
+#include <coroutine>
+#include <type_traits>
+
+// NOTE[joe] Stored in a promise's Continuation once the task has finished.
+#define TASK_DONE ((void *)1)
+
+/** The part of a task's promise that doesn't care what it returns. */
+typedef struct task_promise_base {
+    // NOTE[joe] Zero while nobody is waiting and the task is still running,
+    // the address of whoever is waiting, or TASK_DONE. Whichever of the
+    // waiter and the task gets here second is the one that resumes the
+    // waiter.
+    std::atomic<void *> Continuation;
+
+    std::suspend_never initial_suspend() noexcept { return {}; }
+
+    struct final_awaiter {
+        task_promise_base *Promise;
+
+        bool await_ready() noexcept { return false; }
+
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<> Handle) noexcept;
+
+        void await_resume() noexcept {}
+    };
+
+    // NOTE[joe] Tasks always stop at the end rather than destroying
+    // themselves, so that whoever waited can still get at the result.
+    final_awaiter final_suspend() noexcept { return { this }; }
+
+    // NOTE[joe] We build without exceptions in mind. Anything thrown out of
+    // a task is a bug.
+    void unhandled_exception() noexcept { Abort("Exception in a task.\n"); }
+} task_promise_base;
+
+// NOTE[joe] The finishing task's own handle isn't needed; its promise is
+// already in the awaiter.
+inline std::coroutine_handle<>
+task_promise_base::final_awaiter::await_suspend(
+    std::coroutine_handle<>) noexcept
+{
+    void *Waiter = Promise->Continuation.exchange(TASK_DONE,
+                                                  std::memory_order_acq_rel);
+
+    if (Waiter)
+    {
+        return std::coroutine_handle<>::from_address(Waiter);
+    }
+
+    return std::noop_coroutine();
+}
+
+template <typename type>
+struct task;
+
+template <typename type>
+struct task_promise : task_promise_base {
+    type Result;
+
+    task<type> get_return_object() noexcept;
+
+    void return_value(type Value) noexcept { Result = Value; }
+};
+
+template <>
+struct task_promise<void> : task_promise_base {
+    task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+};
+
+/** A running (or finished) coroutine that returns a type. Move only; the
+ * frame is destroyed along with the task, which must have finished by
+ * then. */
+template <typename type>
+struct task {
+    typedef task_promise<type> promise_type;
+
+    std::coroutine_handle<promise_type> Handle;
+
+    task() : Handle(0) {}
+    explicit task(std::coroutine_handle<promise_type> Handle)
+        : Handle(Handle) {}
+
+    task(task &&Other) : Handle(Other.Handle) { Other.Handle = 0; }
+
+    task &operator=(task &&Other)
+    {
+        if (this != &Other)
+        {
+            Release();
+            Handle = Other.Handle;
+            Other.Handle = 0;
+        }
+
+        return *this;
+    }
+
+    task(const task &) = delete;
+    task &operator=(const task &) = delete;
+
+    ~task() { Release(); }
+
+    void Release()
+    {
+        if (Handle)
+        {
+            Assert(IsDone(), "Destroyed a task that hadn't finished.\n");
+
+            Handle.destroy();
+            Handle = 0;
+        }
+    }
+
+    bool IsDone() const
+    {
+        return Handle.promise().Continuation.load(
+            std::memory_order_acquire) == TASK_DONE;
+    }
+
+    /** co_await-ing a task resumes the awaiting coroutine once the task has
+     * finished, with whatever it returned. */
+    struct awaiter {
+        std::coroutine_handle<promise_type> Handle;
+
+        bool await_ready() noexcept
+        {
+            return Handle.promise().Continuation.load(
+                std::memory_order_acquire) == TASK_DONE;
+        }
+
+        bool await_suspend(std::coroutine_handle<> Waiter) noexcept
+        {
+            void *Expected = 0;
+
+            // If this fails, the task finished in the meantime, and we
+            // carry straight on.
+            return Handle.promise().Continuation.compare_exchange_strong(
+                Expected,
+                Waiter.address(),
+                std::memory_order_acq_rel);
+        }
+
+        type await_resume() noexcept
+        {
+            if constexpr (!std::is_void<type>::value)
+            {
+                return Handle.promise().Result;
+            }
+        }
+    };
+
+    awaiter operator co_await() noexcept { return awaiter { Handle }; }
+};
+
+template <typename type>
+inline task<type> task_promise<type>::get_return_object() noexcept
+{
+    return task<type>(
+        std::coroutine_handle<task_promise<type>>::from_promise(*this));
+}
+
+inline task<void> task_promise<void>::get_return_object() noexcept
+{
+    return task<void>(
+        std::coroutine_handle<task_promise<void>>::from_promise(*this));
+}
+
+#endif
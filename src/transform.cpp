@@ -0,0 +1,338 @@
+/**
+ * @file transform.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our transform hierarchy. See transform.h.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "transform.h"
+
+// NOTE[joe] Below this many dirty nodes, sorting them is an insertion sort.
+#define TRANSFORM_SMALL_SORT 64
+
+/** Sets Hierarchy up to hold up to Capacity nodes, allocated from Arena. */
+static
+void InitializeTransformHierarchy(transform_hierarchy *Hierarchy,
+                                  memory_arena *Arena,
+                                  unsigned int Capacity)
+{
+    *Hierarchy = {};
+    Hierarchy->Capacity = Capacity;
+    Hierarchy->FreeId = TRANSFORM_NONE;
+
+    Hierarchy->Parents = PushArray(Arena, unsigned int, Capacity);
+    Hierarchy->SubtreeSizes = PushArray(Arena, unsigned int, Capacity);
+    Hierarchy->Ids = PushArray(Arena, transform_id, Capacity);
+    Hierarchy->Locals = PushArray(Arena, mat4, Capacity);
+    Hierarchy->Worlds = PushArray(Arena, mat4, Capacity);
+    Hierarchy->Slots = PushArray(Arena, unsigned int, Capacity);
+    Hierarchy->DirtyIds = PushArray(Arena, transform_id, Capacity);
+    Hierarchy->IsDirty = PushArray(Arena, unsigned char, Capacity);
+    Hierarchy->DirtySlots = PushArray(Arena, unsigned int, Capacity);
+    Hierarchy->SortScratch = PushArray(Arena, unsigned int, Capacity);
+
+    memset(Hierarchy->IsDirty, 0, Capacity);
+}
+
+static
+void MarkTransformDirty(transform_hierarchy *Hierarchy, transform_id Id)
+{
+    if (!Hierarchy->IsDirty[Id])
+    {
+        Hierarchy->IsDirty[Id] = 1;
+        Hierarchy->DirtyIds[Hierarchy->DirtyCount++] = Id;
+    }
+}
+
+/** Moves the slots from Slot onwards by Distance (either way), keeping ids
+ * and parents pointing at the right places. */
+static
+void MoveTransformSlots(transform_hierarchy *Hierarchy,
+                        unsigned int Slot,
+                        int Distance)
+{
+    unsigned int Count = Hierarchy->Count - Slot;
+    unsigned int To = Slot + Distance;
+
+    memmove(&Hierarchy->Parents[To],
+            &Hierarchy->Parents[Slot],
+            Count * sizeof(unsigned int));
+    memmove(&Hierarchy->SubtreeSizes[To],
+            &Hierarchy->SubtreeSizes[Slot],
+            Count * sizeof(unsigned int));
+    memmove(&Hierarchy->Ids[To],
+            &Hierarchy->Ids[Slot],
+            Count * sizeof(transform_id));
+    memmove(&Hierarchy->Locals[To],
+            &Hierarchy->Locals[Slot],
+            Count * sizeof(mat4));
+    memmove(&Hierarchy->Worlds[To],
+            &Hierarchy->Worlds[Slot],
+            Count * sizeof(mat4));
+
+    for (unsigned int i = To; i < To + Count; i++)
+    {
+        Hierarchy->Slots[Hierarchy->Ids[i]] = i;
+
+        // NOTE[joe] Only parents that moved along with their children need
+        // fixing; anything before Slot stayed put.
+        if (Hierarchy->Parents[i] != TRANSFORM_NONE &&
+            Hierarchy->Parents[i] >= Slot)
+        {
+            Hierarchy->Parents[i] += Distance;
+        }
+    }
+}
+
+/** Adds a node under Parent (or as a root, given TRANSFORM_NONE), with an
+ * identity local transform. Building a hierarchy in depth first order never
+ * has to move any existing nodes. */
+static
+transform_id CreateTransform(transform_hierarchy *Hierarchy,
+                             transform_id Parent)
+{
+    Assert(Hierarchy->Count < Hierarchy->Capacity,
+           "Transform hierarchy is full.\n");
+
+    unsigned int ParentSlot = TRANSFORM_NONE;
+    unsigned int Slot = Hierarchy->Count;
+
+    if (Parent != TRANSFORM_NONE)
+    {
+        ParentSlot = Hierarchy->Slots[Parent];
+        Slot = ParentSlot + Hierarchy->SubtreeSizes[ParentSlot];
+    }
+
+    if (Slot < Hierarchy->Count)
+    {
+        MoveTransformSlots(Hierarchy, Slot, 1);
+    }
+
+    Hierarchy->Count++;
+
+    for (unsigned int Ancestor = ParentSlot;
+         Ancestor != TRANSFORM_NONE;
+         Ancestor = Hierarchy->Parents[Ancestor])
+    {
+        Hierarchy->SubtreeSizes[Ancestor]++;
+    }
+
+    transform_id Id = Hierarchy->FreeId;
+
+    if (Id != TRANSFORM_NONE)
+    {
+        Hierarchy->FreeId = Hierarchy->Slots[Id];
+    }
+    else
+    {
+        Id = Hierarchy->IdCount++;
+    }
+
+    Hierarchy->Slots[Id] = Slot;
+    Hierarchy->Parents[Slot] = ParentSlot;
+    Hierarchy->SubtreeSizes[Slot] = 1;
+    Hierarchy->Ids[Slot] = Id;
+    Hierarchy->Locals[Slot] = Mat4Identity();
+
+    MarkTransformDirty(Hierarchy, Id);
+
+    return Id;
+}
+
+/** Removes Id and everything under it. */
+static
+void DestroyTransform(transform_hierarchy *Hierarchy, transform_id Id)
+{
+    unsigned int Slot = Hierarchy->Slots[Id];
+    unsigned int Size = Hierarchy->SubtreeSizes[Slot];
+    unsigned int ParentSlot = Hierarchy->Parents[Slot];
+
+    // NOTE[joe] Anything of these still on the dirty list is skipped by the
+    // next update, since their slots won't lead back to them.
+    for (unsigned int i = Slot; i < Slot + Size; i++)
+    {
+        transform_id Dead = Hierarchy->Ids[i];
+
+        Hierarchy->Slots[Dead] = Hierarchy->FreeId;
+        Hierarchy->FreeId = Dead;
+    }
+
+    for (unsigned int Ancestor = ParentSlot;
+         Ancestor != TRANSFORM_NONE;
+         Ancestor = Hierarchy->Parents[Ancestor])
+    {
+        Hierarchy->SubtreeSizes[Ancestor] -= Size;
+    }
+
+    if (Slot + Size < Hierarchy->Count)
+    {
+        MoveTransformSlots(Hierarchy, Slot + Size, -(int)Size);
+    }
+
+    Hierarchy->Count -= Size;
+}
+
+static
+void SetLocalTransform(transform_hierarchy *Hierarchy,
+                       transform_id Id,
+                       const mat4 *Local)
+{
+    Hierarchy->Locals[Hierarchy->Slots[Id]] = *Local;
+
+    MarkTransformDirty(Hierarchy, Id);
+}
+
+/** Returns Id's world transform as of the last UpdateTransforms(). Only good
+ * until the hierarchy next changes shape. */
+static
+const mat4 *GetWorldTransform(transform_hierarchy *Hierarchy,
+                              transform_id Id)
+{
+    return &Hierarchy->Worlds[Hierarchy->Slots[Id]];
+}
+
+/** Sorts Count slots ascending, using Scratch (as big as Slots) on the
+ * way. Slots are all below Limit. */
+static
+void SortTransformSlots(unsigned int *Slots,
+                        unsigned int *Scratch,
+                        unsigned int Count,
+                        unsigned int Limit)
+{
+    if (Count < TRANSFORM_SMALL_SORT)
+    {
+        for (unsigned int i = 1; i < Count; i++)
+        {
+            unsigned int Value = Slots[i];
+            unsigned int j = i;
+
+            for (; j > 0 && Slots[j - 1] > Value; j--)
+            {
+                Slots[j] = Slots[j - 1];
+            }
+
+            Slots[j] = Value;
+        }
+
+        return;
+    }
+
+    // NOTE[joe] A byte at a time, least significant first, stopping once
+    // the rest of the bytes are zero for every slot.
+    unsigned int *From = Slots;
+    unsigned int *To = Scratch;
+
+    for (unsigned int Shift = 0; Shift < 32 && (Limit >> Shift); Shift += 8)
+    {
+        unsigned int Offsets[256] = {};
+
+        for (unsigned int i = 0; i < Count; i++)
+        {
+            Offsets[(From[i] >> Shift) & 0xFF]++;
+        }
+
+        unsigned int Total = 0;
+
+        for (unsigned int Digit = 0; Digit < 256; Digit++)
+        {
+            unsigned int DigitCount = Offsets[Digit];
+            Offsets[Digit] = Total;
+            Total += DigitCount;
+        }
+
+        for (unsigned int i = 0; i < Count; i++)
+        {
+            To[Offsets[(From[i] >> Shift) & 0xFF]++] = From[i];
+        }
+
+        unsigned int *Swap = From;
+        From = To;
+        To = Swap;
+    }
+
+    if (From != Slots)
+    {
+        memcpy(Slots, From, Count * sizeof(unsigned int));
+    }
+}
+
+/** Recomputes the world transforms of [Start, End), which has to be one or
+ * more whole subtrees. */
+static
+void UpdateTransformRange(transform_hierarchy *Hierarchy,
+                          unsigned int Start,
+                          unsigned int End)
+{
+    unsigned int *Parents = Hierarchy->Parents;
+    mat4 *Locals = Hierarchy->Locals;
+    mat4 *Worlds = Hierarchy->Worlds;
+
+    // NOTE[joe] Parents always come first, so each one is done by the time
+    // we get to its children.
+    for (unsigned int i = Start; i < End; i++)
+    {
+        if (Parents[i] == TRANSFORM_NONE)
+        {
+            Worlds[i] = Locals[i];
+        }
+        else
+        {
+            Multiply(&Worlds[Parents[i]], &Locals[i], &Worlds[i]);
+        }
+    }
+}
+
+/** Brings the world transforms of everything set since the last update, and
+ * everything under those, up to date. */
+static
+void UpdateTransforms(transform_hierarchy *Hierarchy)
+{
+    unsigned int SlotCount = 0;
+
+    for (unsigned int i = 0; i < Hierarchy->DirtyCount; i++)
+    {
+        transform_id Id = Hierarchy->DirtyIds[i];
+        unsigned int Slot = Hierarchy->Slots[Id];
+
+        Hierarchy->IsDirty[Id] = 0;
+
+        // NOTE[joe] Nodes destroyed since they were set don't lead back to
+        // themselves any more.
+        if (Slot < Hierarchy->Count && Hierarchy->Ids[Slot] == Id)
+        {
+            Hierarchy->DirtySlots[SlotCount++] = Slot;
+        }
+    }
+
+    Hierarchy->DirtyCount = 0;
+
+    SortTransformSlots(Hierarchy->DirtySlots,
+                       Hierarchy->SortScratch,
+                       SlotCount,
+                       Hierarchy->Count);
+
+    // NOTE[joe] Sorted, a dirty node's subtree starts at its own slot and
+    // takes in any dirty nodes under it, which we skip.
+    unsigned int End = 0;
+    unsigned int UpdatedCount = 0;
+
+    for (unsigned int i = 0; i < SlotCount; i++)
+    {
+        unsigned int Slot = Hierarchy->DirtySlots[i];
+
+        if (Slot < End)
+        {
+            continue;
+        }
+
+        End = Slot + Hierarchy->SubtreeSizes[Slot];
+
+        UpdateTransformRange(Hierarchy, Slot, End);
+        UpdatedCount += End - Slot;
+    }
+
+    Hierarchy->UpdatedCount = UpdatedCount;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file transform.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for our transform hierarchy. Nodes live
+ * in flat arrays in depth first order, so every node comes after its parent
+ * and a node's whole subtree is the run of slots starting at its own.
+ *
+ * Setting a node's local transform marks it dirty. UpdateTransforms() only
+ * recomputes the subtrees under dirty nodes, each in one pass straight down
+ * the arrays, so nodes that never move cost nothing from frame to frame.
+ */
+
+#ifndef _TRANSFORM_H_
+#define _TRANSFORM_H_
+
+#include "linear_math.h"
+
+#define TRANSFORM_NONE 0xFFFFFFFF
+
+/** Stays the same for as long as the node exists, unlike its slot. */
+typedef unsigned int transform_id;
+
+typedef struct {
+    unsigned int   Capacity;
+    unsigned int   Count;
+
+    // NOTE[joe] Indexed by slot. Parents are slots too.
+    unsigned int  *Parents;
+    unsigned int  *SubtreeSizes;
+    transform_id  *Ids;
+    mat4          *Locals;
+    mat4          *Worlds;
+
+    // NOTE[joe] Indexed by id. Free ids are chained through Slots, starting
+    // at FreeId.
+    unsigned int  *Slots;
+    unsigned int   IdCount;
+    transform_id   FreeId;
+
+    // NOTE[joe] Nodes set since the last update, each listed once.
+    transform_id  *DirtyIds;
+    unsigned char *IsDirty;
+    unsigned int   DirtyCount;
+
+    // NOTE[joe] Scratch for sorting the dirty nodes by slot.
+    unsigned int  *DirtySlots;
+    unsigned int  *SortScratch;
+
+    // NOTE[joe] How many nodes the last update recomputed.
+    unsigned int   UpdatedCount;
+} transform_hierarchy;
+
+#endif
@@ -0,0 +1,302 @@
+/**
+ * @file transform_bench.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-19
+ *
+ * This file contains the checks for the transform hierarchy's bookkeeping. A
+ * small tree is built, with a node added to the middle of it so that slots
+ * have to move, and then a subtree with dirty nodes in it is destroyed from
+ * the middle. After every change the arrays have to still be in depth first
+ * order, every id has to lead to its slot, and every world transform has to
+ * be what multiplying the locals down from its root gives. Platform layers
+ * run them with --bench-transforms, instead of the game, and exit with an
+ * error if any check fails.
+ */
+
+#include "platform.h"
+#include "memory.h"
+#include "transform.h"
+
+#define TRANSFORM_BENCH_MAX_NODES 16
+
+/** What the hierarchy should hold, kept by id on the side. */
+typedef struct {
+    transform_id Parents[TRANSFORM_BENCH_MAX_NODES];
+    bool         IsAlive[TRANSFORM_BENCH_MAX_NODES];
+    mat4         Locals[TRANSFORM_BENCH_MAX_NODES];
+    unsigned int IdCount;
+} transform_bench_tree;
+
+/** Adds a node under Parent, to the hierarchy and to Tree, and gives it a
+ * local transform of its own. */
+static
+transform_id AddBenchTransform(transform_hierarchy *Hierarchy,
+                               transform_bench_tree *Tree,
+                               transform_id Parent)
+{
+    transform_id Id = CreateTransform(Hierarchy, Parent);
+
+    Assert(Id < TRANSFORM_BENCH_MAX_NODES, "Too many bench transforms.\n");
+
+    if (Id >= Tree->IdCount)
+    {
+        Tree->IdCount = Id + 1;
+    }
+
+    mat4 Translation = Mat4Translation({ (float)Id, 0.5f * Id, -0.25f * Id });
+    mat4 Rotation = Mat4RotationZ(0.1f * (Id + 1));
+
+    Tree->Parents[Id] = Parent;
+    Tree->IsAlive[Id] = true;
+    Multiply(&Translation, &Rotation, &Tree->Locals[Id]);
+
+    SetLocalTransform(Hierarchy, Id, &Tree->Locals[Id]);
+
+    return Id;
+}
+
+/** Gives Id a new local transform, in the hierarchy and in Tree. */
+static
+void MoveBenchTransform(transform_hierarchy *Hierarchy,
+                        transform_bench_tree *Tree,
+                        transform_id Id,
+                        float Angle)
+{
+    mat4 Rotation = Mat4RotationX(Angle);
+    mat4 Local = Tree->Locals[Id];
+
+    Multiply(&Local, &Rotation, &Tree->Locals[Id]);
+
+    SetLocalTransform(Hierarchy, Id, &Tree->Locals[Id]);
+}
+
+/** Marks Id and everything under it dead in Tree. Parents always have lower
+ * ids than their children here, so one pass over the ids after Id catches
+ * them all. */
+static
+void KillBenchTransform(transform_bench_tree *Tree, transform_id Id)
+{
+    Tree->IsAlive[Id] = false;
+
+    for (unsigned int i = Id + 1; i < Tree->IdCount; i++)
+    {
+        if (Tree->IsAlive[i] &&
+            Tree->Parents[i] != TRANSFORM_NONE &&
+            !Tree->IsAlive[Tree->Parents[i]])
+        {
+            Tree->IsAlive[i] = false;
+        }
+    }
+}
+
+/** Whether the hierarchy holds exactly Tree's living nodes, in depth first
+ * order: every node after its parent and inside its parent's run of slots,
+ * every subtree size one more than its children's, and every id leading to
+ * the slot that holds it. */
+static
+bool CheckBenchTransformOrder(transform_hierarchy *Hierarchy,
+                              transform_bench_tree *Tree)
+{
+    unsigned int AliveCount = 0;
+
+    for (unsigned int Id = 0; Id < Tree->IdCount; Id++)
+    {
+        AliveCount += Tree->IsAlive[Id] ? 1 : 0;
+    }
+
+    if (Hierarchy->Count != AliveCount)
+        return false;
+
+    unsigned int Sizes[TRANSFORM_BENCH_MAX_NODES];
+
+    for (unsigned int Slot = 0; Slot < Hierarchy->Count; Slot++)
+    {
+        transform_id Id = Hierarchy->Ids[Slot];
+        unsigned int Parent = Hierarchy->Parents[Slot];
+
+        if (Id >= Tree->IdCount ||
+            !Tree->IsAlive[Id] ||
+            Hierarchy->Slots[Id] != Slot ||
+            Slot + Hierarchy->SubtreeSizes[Slot] > Hierarchy->Count)
+        {
+            return false;
+        }
+
+        if (Tree->Parents[Id] == TRANSFORM_NONE)
+        {
+            if (Parent != TRANSFORM_NONE)
+                return false;
+        }
+        else if (Parent == TRANSFORM_NONE ||
+                 Parent >= Slot ||
+                 Hierarchy->Ids[Parent] != Tree->Parents[Id] ||
+                 Slot >= Parent + Hierarchy->SubtreeSizes[Parent])
+        {
+            return false;
+        }
+
+        Sizes[Slot] = 1;
+    }
+
+    // NOTE[joe] Children come after their parents, so going backwards every
+    // subtree is summed before it's added to its parent's.
+    for (unsigned int Slot = Hierarchy->Count; Slot-- > 0;)
+    {
+        if (Sizes[Slot] != Hierarchy->SubtreeSizes[Slot])
+            return false;
+
+        if (Hierarchy->Parents[Slot] != TRANSFORM_NONE)
+        {
+            Sizes[Hierarchy->Parents[Slot]] += Sizes[Slot];
+        }
+    }
+
+    return true;
+}
+
+/** Id's world transform, multiplied down from its root the same way
+ * UpdateTransforms() does it. */
+static
+mat4 GetBenchWorldTransform(transform_bench_tree *Tree, transform_id Id)
+{
+    if (Tree->Parents[Id] == TRANSFORM_NONE)
+        return Tree->Locals[Id];
+
+    mat4 Parent = GetBenchWorldTransform(Tree, Tree->Parents[Id]);
+    mat4 World;
+
+    Multiply(&Parent, &Tree->Locals[Id], &World);
+
+    return World;
+}
+
+/** Whether every living node's world transform is what Tree says it is. */
+static
+bool CheckBenchTransformWorlds(transform_hierarchy *Hierarchy,
+                               transform_bench_tree *Tree)
+{
+    for (unsigned int Id = 0; Id < Tree->IdCount; Id++)
+    {
+        if (!Tree->IsAlive[Id])
+            continue;
+
+        mat4 Expected = GetBenchWorldTransform(Tree, Id);
+        const mat4 *World = GetWorldTransform(Hierarchy, Id);
+
+        for (unsigned int Column = 0; Column < 4; Column++)
+        {
+            const float *A = &Expected.Columns[Column].x;
+            const float *B = &World->Columns[Column].x;
+
+            for (unsigned int Row = 0; Row < 4; Row++)
+            {
+                if (A[Row] != B[Row])
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/** Runs the transform checks, printing one line per check, and returns
+ * whether they all passed. */
+bool BenchmarkTransforms()
+{
+    memory_arena Arena;
+    InitializeArena(&Arena, MEGABYTES(1), "transform bench");
+
+    transform_hierarchy Hierarchy;
+    InitializeTransformHierarchy(&Hierarchy,
+                                 &Arena,
+                                 TRANSFORM_BENCH_MAX_NODES);
+
+    transform_bench_tree Tree = {};
+
+    /** Built depth first, then with a node added under A after B and C, so
+     * that B, B1 and C have to move along to make room for it. */
+
+    transform_id Root = AddBenchTransform(&Hierarchy, &Tree, TRANSFORM_NONE);
+    transform_id A = AddBenchTransform(&Hierarchy, &Tree, Root);
+    AddBenchTransform(&Hierarchy, &Tree, A);
+    transform_id A2 = AddBenchTransform(&Hierarchy, &Tree, A);
+    AddBenchTransform(&Hierarchy, &Tree, A2);
+    transform_id B = AddBenchTransform(&Hierarchy, &Tree, Root);
+    transform_id B1 = AddBenchTransform(&Hierarchy, &Tree, B);
+    AddBenchTransform(&Hierarchy, &Tree, Root);
+    AddBenchTransform(&Hierarchy, &Tree, A);
+
+    transform_id Other = AddBenchTransform(&Hierarchy, &Tree, TRANSFORM_NONE);
+    AddBenchTransform(&Hierarchy, &Tree, Other);
+
+    UpdateTransforms(&Hierarchy);
+
+    bool IsBuilt = CheckBenchTransformOrder(&Hierarchy, &Tree) &&
+                   CheckBenchTransformWorlds(&Hierarchy, &Tree) &&
+                   Hierarchy.UpdatedCount == Hierarchy.Count;
+
+    /** A goes, with a dirty node under it, and B1 is dirty alongside it.
+     * Only B1 gets updated, and everything after A moves down into the
+     * hole. */
+
+    MoveBenchTransform(&Hierarchy, &Tree, A2, 0.5f);
+    MoveBenchTransform(&Hierarchy, &Tree, B1, 0.75f);
+
+    unsigned int CountBefore = Hierarchy.Count;
+    unsigned int SizeOfA = Hierarchy.SubtreeSizes[Hierarchy.Slots[A]];
+
+    // NOTE[joe] Ids are freed in slot order, so this one's freed last.
+    transform_id Last = Hierarchy.Ids[Hierarchy.Slots[A] + SizeOfA - 1];
+
+    DestroyTransform(&Hierarchy, A);
+    KillBenchTransform(&Tree, A);
+
+    UpdateTransforms(&Hierarchy);
+
+    bool IsDestroyed = SizeOfA == 5 &&
+                       Hierarchy.Count == CountBefore - SizeOfA &&
+                       CheckBenchTransformOrder(&Hierarchy, &Tree) &&
+                       CheckBenchTransformWorlds(&Hierarchy, &Tree) &&
+                       Hierarchy.UpdatedCount == 1;
+
+    /** A new node takes the last id A's subtree freed, and goes at the end
+     * of B's run of slots. */
+
+    transform_id Reused = AddBenchTransform(&Hierarchy, &Tree, B);
+
+    UpdateTransforms(&Hierarchy);
+
+    unsigned int SlotOfB = Hierarchy.Slots[B];
+
+    bool IsReused = Reused == Last &&
+                    Hierarchy.Slots[Reused] ==
+                    SlotOfB + Hierarchy.SubtreeSizes[SlotOfB] - 1 &&
+                    CheckBenchTransformOrder(&Hierarchy, &Tree) &&
+                    CheckBenchTransformWorlds(&Hierarchy, &Tree) &&
+                    Hierarchy.UpdatedCount == 1;
+
+    /** Moving the root takes everything under it along, and nothing
+     * else. */
+
+    MoveBenchTransform(&Hierarchy, &Tree, Root, 0.25f);
+
+    UpdateTransforms(&Hierarchy);
+
+    bool IsMoved =
+        CheckBenchTransformWorlds(&Hierarchy, &Tree) &&
+        Hierarchy.UpdatedCount ==
+        Hierarchy.SubtreeSizes[Hierarchy.Slots[Root]];
+
+    printf("transform_built %d\n", IsBuilt ? 1 : 0);
+    printf("transform_subtree_destroyed %d\n", IsDestroyed ? 1 : 0);
+    printf("transform_id_reused %d\n", IsReused ? 1 : 0);
+    printf("transform_root_moved %d\n", IsMoved ? 1 : 0);
+
+    bool IsCorrect = IsBuilt && IsDestroyed && IsReused && IsMoved;
+
+    printf("transform_correct %d\n", IsCorrect ? 1 : 0);
+
+    ReleaseArena(&Arena);
+
+    return IsCorrect;
+}
@@ -0,0 +1,485 @@
+/**
+ * @file vulkan_allocator.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the allocator we give the driver for its host memory.
+ * See vulkan_allocator.h. Pass GetHostAllocator() wherever Vulkan takes a
+ * pAllocator.
+ */
+
+#include "platform.h"
+#include "render.h"
+
+// NOTE[joe] Nothing in here switches fibers, so unlike the job system's
+// thread state this is safe to use directly.
+static thread_local host_thread_cache HostThreadCache;
+
+static
+void LockHostAllocator(host_allocator *Allocator)
+{
+    while (Allocator->IsLocked.exchange(true, std::memory_order_acquire))
+    {
+        while (Allocator->IsLocked.load(std::memory_order_relaxed))
+        {
+            PlatformYield();
+        }
+    }
+}
+
+static
+void UnlockHostAllocator(host_allocator *Allocator)
+{
+    Allocator->IsLocked.store(false, std::memory_order_release);
+}
+
+/** Returns the size class for a block of Size bytes, or HOST_CLASS_COUNT if
+ * it's bigger than the biggest block. */
+static
+unsigned int GetHostSizeClass(size_t Size)
+{
+    unsigned int SizeClass = 0;
+
+    while (SizeClass < HOST_CLASS_COUNT &&
+           ((size_t)1 << (HOST_MIN_BLOCK_SHIFT + SizeClass)) < Size)
+    {
+        SizeClass++;
+    }
+
+    return SizeClass;
+}
+
+/** Fills the calling thread's cache for SizeClass, from the shared list if
+ * it has anything, otherwise from a new slab. */
+static
+void RefillHostThreadCache(host_allocator *Allocator,
+                           host_thread_cache *Cache,
+                           unsigned int SizeClass)
+{
+    size_t BlockSize = (size_t)1 << (HOST_MIN_BLOCK_SHIFT + SizeClass);
+
+    LockHostAllocator(Allocator);
+
+    if (Allocator->FreeBlocks[SizeClass])
+    {
+        void *Block = Allocator->FreeBlocks[SizeClass];
+
+        for (unsigned int i = 0; i < HOST_CACHE_BATCH && Block; i++)
+        {
+            void *Next = *(void **)Block;
+
+            *(void **)Block = Cache->FreeBlocks[SizeClass];
+            Cache->FreeBlocks[SizeClass] = Block;
+            Cache->FreeCount[SizeClass]++;
+
+            Block = Next;
+        }
+
+        Allocator->FreeBlocks[SizeClass] = Block;
+
+        UnlockHostAllocator(Allocator);
+
+        return;
+    }
+
+    // NOTE[joe] Slabs are aligned to at least the biggest block, so every
+    // block is aligned to its own size.
+    unsigned char *Slab = (unsigned char *)PushSize(&Allocator->Slabs,
+                                                    HOST_SLAB_SIZE,
+                                                    HOST_MAX_BLOCK_SIZE);
+
+    UnlockHostAllocator(Allocator);
+
+    for (size_t Offset = 0; Offset < HOST_SLAB_SIZE; Offset += BlockSize)
+    {
+        void *Block = Slab + Offset;
+
+        *(void **)Block = Cache->FreeBlocks[SizeClass];
+        Cache->FreeBlocks[SizeClass] = Block;
+        Cache->FreeCount[SizeClass]++;
+    }
+}
+
+/** Takes a block of one of the large size classes off the shared list, or
+ * carves a new one if there aren't any. These skip the thread caches, since
+ * there are only ever a handful. */
+static
+unsigned char *AllocateLargeHostBlock(host_allocator *Allocator,
+                                      unsigned int SizeClass)
+{
+    size_t BlockSize = (size_t)1 << (HOST_MIN_BLOCK_SHIFT + SizeClass);
+
+    LockHostAllocator(Allocator);
+
+    void *Block = Allocator->FreeBlocks[SizeClass];
+
+    if (Block)
+    {
+        Allocator->FreeBlocks[SizeClass] = *(void **)Block;
+    }
+    else
+    {
+        // NOTE[joe] Aligned to its own size, like every other block, which
+        // costs the arena some padding. There aren't enough of these for
+        // that to matter.
+        Block = PushSize(&Allocator->Slabs, BlockSize, BlockSize);
+    }
+
+    UnlockHostAllocator(Allocator);
+
+    return (unsigned char *)Block;
+}
+
+static
+void CountHostAllocation(host_counter *Counter, long long Size)
+{
+    long long Live = Counter->LiveBytes.fetch_add(Size,
+                                                  std::memory_order_relaxed);
+    Live += Size;
+
+    Counter->LiveCount.fetch_add(1, std::memory_order_relaxed);
+
+    long long Peak = Counter->PeakBytes.load(std::memory_order_relaxed);
+
+    while (Live > Peak &&
+           !Counter->PeakBytes.compare_exchange_weak(
+               Peak,
+               Live,
+               std::memory_order_relaxed))
+    {
+    }
+}
+
+static
+void CountHostFree(host_counter *Counter, long long Size)
+{
+    Counter->LiveBytes.fetch_sub(Size, std::memory_order_relaxed);
+    Counter->LiveCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+static
+void *AllocateHostMemory(host_allocator *Allocator,
+                         host_tag Tag,
+                         size_t Size,
+                         size_t Alignment,
+                         VkSystemAllocationScope Scope)
+{
+    // NOTE[joe] The header goes right in front of what we hand out, so
+    // there's always at least its size (or the alignment, if that's bigger)
+    // between the block and the allocation.
+    size_t Offset = sizeof(host_allocation_header);
+
+    if (Alignment > Offset)
+    {
+        Offset = Alignment;
+    }
+
+    unsigned int SizeClass = GetHostSizeClass(Offset + Size);
+    unsigned char *Block;
+
+    if (SizeClass == HOST_CLASS_COUNT)
+    {
+        // NOTE[joe] The driver turns this into VK_ERROR_OUT_OF_HOST_MEMORY.
+        PlatformLog("Host allocation of %zu bytes is bigger than our biggest "
+                    "block.\n",
+                    Size);
+        return 0;
+    }
+
+    if (SizeClass < HOST_SIZE_CLASS_COUNT)
+    {
+        host_thread_cache *Cache = &HostThreadCache;
+
+        if (!Cache->FreeBlocks[SizeClass])
+        {
+            RefillHostThreadCache(Allocator, Cache, SizeClass);
+        }
+
+        Block = (unsigned char *)Cache->FreeBlocks[SizeClass];
+        Cache->FreeBlocks[SizeClass] = *(void **)Block;
+        Cache->FreeCount[SizeClass]--;
+    }
+    else
+    {
+        Block = AllocateLargeHostBlock(Allocator, SizeClass);
+    }
+
+    unsigned char *Memory = Block + Offset;
+
+    host_allocation_header *Header = (host_allocation_header *)Memory - 1;
+    Header->Size = Size;
+    Header->Offset = (unsigned int)Offset;
+    Header->SizeClass = (unsigned char)SizeClass;
+    Header->Scope = (unsigned char)Scope;
+    Header->Tag = (unsigned char)Tag;
+
+    CountHostAllocation(&Allocator->Tags[Tag], Size);
+    CountHostAllocation(&Allocator->Scopes[Scope], Size);
+    CountHostAllocation(&Allocator->Total, Size);
+    Allocator->AllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    return Memory;
+}
+
+static
+void FreeHostMemory(host_allocator *Allocator, void *Memory)
+{
+    host_allocation_header *Header = (host_allocation_header *)Memory - 1;
+
+    CountHostFree(&Allocator->Tags[Header->Tag], Header->Size);
+    CountHostFree(&Allocator->Scopes[Header->Scope], Header->Size);
+    CountHostFree(&Allocator->Total, Header->Size);
+
+    unsigned char *Block = (unsigned char *)Memory - Header->Offset;
+    unsigned int SizeClass = Header->SizeClass;
+
+    if (SizeClass >= HOST_SIZE_CLASS_COUNT)
+    {
+        LockHostAllocator(Allocator);
+
+        *(void **)Block = Allocator->FreeBlocks[SizeClass];
+        Allocator->FreeBlocks[SizeClass] = Block;
+
+        UnlockHostAllocator(Allocator);
+
+        return;
+    }
+
+    host_thread_cache *Cache = &HostThreadCache;
+
+    *(void **)Block = Cache->FreeBlocks[SizeClass];
+    Cache->FreeBlocks[SizeClass] = Block;
+    Cache->FreeCount[SizeClass]++;
+
+    // NOTE[joe] Give some back once we're holding plenty, so that blocks
+    // freed on a different thread than they were allocated on don't pile
+    // up there.
+    if (Cache->FreeCount[SizeClass] >= 2 * HOST_CACHE_BATCH)
+    {
+        void *First = Cache->FreeBlocks[SizeClass];
+        void *Last = First;
+
+        for (unsigned int i = 1; i < HOST_CACHE_BATCH; i++)
+        {
+            Last = *(void **)Last;
+        }
+
+        Cache->FreeBlocks[SizeClass] = *(void **)Last;
+        Cache->FreeCount[SizeClass] -= HOST_CACHE_BATCH;
+
+        LockHostAllocator(Allocator);
+
+        *(void **)Last = Allocator->FreeBlocks[SizeClass];
+        Allocator->FreeBlocks[SizeClass] = First;
+
+        UnlockHostAllocator(Allocator);
+    }
+}
+
+static
+void *VKAPI_CALL HostAllocationCallback(void *UserData,
+                                        size_t Size,
+                                        size_t Alignment,
+                                        VkSystemAllocationScope Scope)
+{
+    host_tag_data *TagData = (host_tag_data *)UserData;
+
+    return AllocateHostMemory(TagData->Allocator,
+                              TagData->Tag,
+                              Size,
+                              Alignment,
+                              Scope);
+}
+
+static
+void *VKAPI_CALL HostReallocationCallback(void *UserData,
+                                          void *Original,
+                                          size_t Size,
+                                          size_t Alignment,
+                                          VkSystemAllocationScope Scope)
+{
+    host_tag_data *TagData = (host_tag_data *)UserData;
+
+    if (!Original)
+    {
+        return AllocateHostMemory(TagData->Allocator,
+                                  TagData->Tag,
+                                  Size,
+                                  Alignment,
+                                  Scope);
+    }
+
+    if (Size == 0)
+    {
+        FreeHostMemory(TagData->Allocator, Original);
+        return 0;
+    }
+
+    // NOTE[joe] Keep counting it under whatever it was first allocated for.
+    host_allocation_header *Header = (host_allocation_header *)Original - 1;
+
+    void *Memory = AllocateHostMemory(TagData->Allocator,
+                                      (host_tag)Header->Tag,
+                                      Size,
+                                      Alignment,
+                                      (VkSystemAllocationScope)Header->Scope);
+
+    // NOTE[joe] Failing leaves the original as it was.
+    if (!Memory)
+    {
+        return 0;
+    }
+
+    memcpy(Memory, Original, Header->Size < Size ? Header->Size : Size);
+
+    FreeHostMemory(TagData->Allocator, Original);
+
+    return Memory;
+}
+
+static
+void VKAPI_CALL HostFreeCallback(void *UserData, void *Memory)
+{
+    if (Memory)
+    {
+        FreeHostMemory(((host_tag_data *)UserData)->Allocator, Memory);
+    }
+}
+
+static
+void VKAPI_CALL HostInternalAllocationCallback(
+    void *UserData,
+    size_t Size,
+    VkInternalAllocationType Type,
+    VkSystemAllocationScope Scope)
+{
+    host_tag_data *TagData = (host_tag_data *)UserData;
+
+    TagData->Allocator->InternalBytes.fetch_add(Size,
+                                                std::memory_order_relaxed);
+}
+
+static
+void VKAPI_CALL HostInternalFreeCallback(
+    void *UserData,
+    size_t Size,
+    VkInternalAllocationType Type,
+    VkSystemAllocationScope Scope)
+{
+    host_tag_data *TagData = (host_tag_data *)UserData;
+
+    TagData->Allocator->InternalBytes.fetch_sub(Size,
+                                                std::memory_order_relaxed);
+}
+
+/** Sets up Allocator before anything is created with it. */
+static
+void InitializeHostAllocator(host_allocator *Allocator)
+{
+    InitializeArena(&Allocator->Slabs, HOST_ARENA_SIZE, "vulkan host");
+
+    Allocator->IsLocked.store(false);
+
+    for (unsigned int i = 0; i < HOST_CLASS_COUNT; i++)
+    {
+        Allocator->FreeBlocks[i] = 0;
+    }
+
+    for (unsigned int i = 0; i < HOST_TAG_COUNT; i++)
+    {
+        Allocator->TagData[i].Allocator = Allocator;
+        Allocator->TagData[i].Tag = (host_tag)i;
+
+        VkAllocationCallbacks *Callbacks = &Allocator->Callbacks[i];
+        Callbacks->pUserData = &Allocator->TagData[i];
+        Callbacks->pfnAllocation = HostAllocationCallback;
+        Callbacks->pfnReallocation = HostReallocationCallback;
+        Callbacks->pfnFree = HostFreeCallback;
+        Callbacks->pfnInternalAllocation = HostInternalAllocationCallback;
+        Callbacks->pfnInternalFree = HostInternalFreeCallback;
+    }
+}
+
+/** Returns the callbacks to create (and destroy) objects of kind Tag with.
+ * Objects can be destroyed with any tag's callbacks; the allocation remembers
+ * which it was counted under. */
+static
+const VkAllocationCallbacks *GetHostAllocator(vulkan_context *Context,
+                                              host_tag Tag)
+{
+    return &Context->HostAllocator.Callbacks[Tag];
+}
+
+/** Marks the end of a frame, for counting how many allocations each frame
+ * makes. Call it from one thread only. */
+static
+void EndHostAllocatorFrame(host_allocator *Allocator)
+{
+    long long Count =
+        Allocator->AllocationCount.load(std::memory_order_relaxed);
+
+    Allocator->LastFrameAllocations = Count - Allocator->FrameStartCount;
+    Allocator->FrameStartCount = Count;
+
+    // NOTE[joe] The first frame is still warming things up, so it's left
+    // out of the totals.
+    if (Allocator->FrameCount++ > 0)
+    {
+        Allocator->FrameAllocationTotal += Allocator->LastFrameAllocations;
+
+        if (Allocator->LastFrameAllocations > Allocator->MaxFrameAllocations)
+        {
+            Allocator->MaxFrameAllocations = Allocator->LastFrameAllocations;
+        }
+    }
+}
+
+/** Writes what the driver has allocated out to the debug log. */
+static
+void LogHostAllocatorStats(host_allocator *Allocator)
+{
+    static const char *TagNames[HOST_TAG_COUNT] = {
+        "instance",
+        "swapchain",
+        "memory",
+        "image",
+        "buffer",
+        "pipeline",
+        "command",
+        "sync"
+    };
+
+    static const char *ScopeNames[HOST_SCOPE_COUNT] = {
+        "command",
+        "object",
+        "cache",
+        "device",
+        "instance"
+    };
+
+    for (unsigned int i = 0; i < HOST_TAG_COUNT; i++)
+    {
+        host_counter *Counter = &Allocator->Tags[i];
+
+        PlatformLog("Host %s: %lld KB in %lld allocations, peak %lld KB.\n",
+                    TagNames[i],
+                    Counter->LiveBytes.load() / 1024,
+                    Counter->LiveCount.load(),
+                    Counter->PeakBytes.load() / 1024);
+    }
+
+    for (unsigned int i = 0; i < HOST_SCOPE_COUNT; i++)
+    {
+        host_counter *Counter = &Allocator->Scopes[i];
+
+        PlatformLog("Host %s scope: %lld KB, peak %lld KB.\n",
+                    ScopeNames[i],
+                    Counter->LiveBytes.load() / 1024,
+                    Counter->PeakBytes.load() / 1024);
+    }
+
+    PlatformLog("Host total: %lld KB, peak %lld KB, internal %lld KB.\n",
+                Allocator->Total.LiveBytes.load() / 1024,
+                Allocator->Total.PeakBytes.load() / 1024,
+                Allocator->InternalBytes.load() / 1024);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file vulkan_allocator.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for the allocator we give the driver for
+ * its host memory. Small allocations come out of per-thread caches of fixed
+ * size blocks; bigger ones come straight off shared lists of bigger blocks.
+ * Either way, blocks are carved out of one arena and never go back to the
+ * system until the allocator's done with. Every allocation is counted
+ * against the kind of object it was made for and the scope the driver gave
+ * it, so we can see what the driver is allocating and when.
+ */
+
+#ifndef _VULKAN_ALLOCATOR_H_
+#define _VULKAN_ALLOCATOR_H_
+
+#include <atomic>
+
+#include "memory.h"
+
+/** What an allocation was made for. Each has its own VkAllocationCallbacks,
+ * since the driver only tells us the scope. */
+typedef enum {
+    HOST_TAG_INSTANCE = 0,  // Instance, device, surface and debug callback.
+    HOST_TAG_SWAPCHAIN,
+    HOST_TAG_MEMORY,
+    HOST_TAG_IMAGE,         // Images, views, samplers, render passes and
+                            // framebuffers.
+    HOST_TAG_BUFFER,
+    HOST_TAG_PIPELINE,      // Pipelines, layouts, caches, shader modules and
+                            // descriptors.
+    HOST_TAG_COMMAND,
+    HOST_TAG_SYNC,          // Fences and semaphores.
+    HOST_TAG_COUNT
+} host_tag;
+
+#define HOST_SCOPE_COUNT (VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1)
+
+// NOTE[joe] Blocks are powers of two from 16 bytes up to 4KB, headers
+// included. Anything bigger is rare enough to skip the thread caches, and
+// keeps going in powers of two up to 16MB.
+#define HOST_MIN_BLOCK_SHIFT 4
+#define HOST_SIZE_CLASS_COUNT 9
+#define HOST_MAX_BLOCK_SIZE (1 << (HOST_MIN_BLOCK_SHIFT + \
+                                   HOST_SIZE_CLASS_COUNT - 1))
+#define HOST_LARGE_CLASS_COUNT 12
+#define HOST_CLASS_COUNT (HOST_SIZE_CLASS_COUNT + HOST_LARGE_CLASS_COUNT)
+
+// NOTE[joe] Threads take blocks from (and give them back to) the shared
+// lists this many at a time.
+#define HOST_CACHE_BATCH 32
+
+#define HOST_SLAB_SIZE KILOBYTES(64)
+#define HOST_ARENA_SIZE MEGABYTES(256)
+
+/** Sits right in front of every allocation we hand out. */
+typedef struct {
+    size_t        Size;
+    // NOTE[joe] From the start of the block to the allocation, which is
+    // more than the header when the driver asks for a bigger alignment.
+    unsigned int  Offset;
+    unsigned char SizeClass;
+    unsigned char Scope;
+    unsigned char Tag;
+    unsigned char Reserved;
+} host_allocation_header;
+
+typedef struct {
+    std::atomic<long long> LiveBytes;
+    std::atomic<long long> LiveCount;
+    std::atomic<long long> PeakBytes;
+} host_counter;
+
+typedef struct host_allocator host_allocator;
+
+typedef struct {
+    host_allocator *Allocator;
+    host_tag        Tag;
+} host_tag_data;
+
+struct host_allocator {
+    VkAllocationCallbacks  Callbacks[HOST_TAG_COUNT];
+    host_tag_data          TagData[HOST_TAG_COUNT];
+
+    // NOTE[joe] Guards Slabs and the shared free lists.
+    std::atomic<bool>      IsLocked;
+    memory_arena           Slabs;
+    void                  *FreeBlocks[HOST_CLASS_COUNT];
+
+    host_counter           Tags[HOST_TAG_COUNT];
+    host_counter           Scopes[HOST_SCOPE_COUNT];
+    host_counter           Total;
+    // NOTE[joe] What the driver tells us it allocated itself, as executable
+    // memory for compiled shaders and the like.
+    std::atomic<long long> InternalBytes;
+
+    // NOTE[joe] Every allocation ever made, including reallocations, for
+    // working out how many each frame makes.
+    std::atomic<long long> AllocationCount;
+    // NOTE[joe] Only touched by EndHostAllocatorFrame().
+    long long              FrameStartCount;
+    long long              FrameCount;
+    long long              FrameAllocationTotal;
+    long long              LastFrameAllocations;
+    long long              MaxFrameAllocations;
+};
+
+/** Blocks a thread has cached, by size class. Only one host allocator per
+ * process can have caches, which is fine since there's one device. */
+typedef struct {
+    void         *FreeBlocks[HOST_SIZE_CLASS_COUNT];
+    unsigned int  FreeCount[HOST_SIZE_CLASS_COUNT];
+} host_thread_cache;
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file vulkan_attachment.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the code for creating render pass attachments (depth
+ * buffers, and later multisampled color buffers).
+ */
+
+#include "platform.h"
+#include "render.h"
+
+// NOTE[joe] Most preferred first. Change the order to trade depth precision
+// for memory.
+static const VkFormat DepthFormatPreference[] = {
+    VK_FORMAT_D32_SFLOAT,
+    VK_FORMAT_D24_UNORM_S8_UINT,
+    VK_FORMAT_D16_UNORM,
+};
+
+/** Picks the first depth format from Candidates that the device can use as
+ * an optimally tiled depth attachment, and sample from in shaders. */
+static
+VkFormat ChooseDepthFormat(vulkan_context *Context,
+                           const VkFormat *Candidates,
+                           unsigned int CandidateCount)
+{
+    for (unsigned int i = 0; i < CandidateCount; i++)
+    {
+        VkFormatProperties Properties = {};
+        vkGetPhysicalDeviceFormatProperties(Context->PhysicalDevice,
+                                            Candidates[i],
+                                            &Properties);
+
+        VkFormatFeatureFlags Required =
+            VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT |
+            VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+
+        if ((Properties.optimalTilingFeatures & Required) == Required)
+        {
+            return Candidates[i];
+        }
+    }
+
+    // NOTE[joe] The spec guarantees D16 as a sampled depth attachment, so we
+    // should never actually get here.
+    Assert(false, "No supported depth format found.\n");
+    return VK_FORMAT_D16_UNORM;
+}
+
+/** Returns the image aspects that make up a depth format. */
+static inline
+VkImageAspectFlags DepthFormatAspect(VkFormat Format)
+{
+    switch (Format)
+    {
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        {
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        }
+
+        default:
+        {
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        }
+    }
+}
+
+/** Creates an attachment image with its memory and view. */
+// NOTE[joe] Every attachment we have is read after its pass (depth is
+// sampled by the particles and the depth pyramid), so none of them can be
+// transient, and there's no lazily allocated path here until one can.
+static
+void CreateAttachment(vulkan_context *Context,
+                      VkFormat Format,
+                      VkImageUsageFlags Usage,
+                      VkImageAspectFlags Aspect,
+                      VkSampleCountFlagBits Samples,
+                      VkImage *Image,
+                      VkImageView *ImageView)
+{
+    VkImageCreateInfo ImageCreateInfo = {};
+    ImageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    ImageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+    ImageCreateInfo.format = Format;
+    ImageCreateInfo.extent = { Context->Width, Context->Height, 1 };
+    ImageCreateInfo.mipLevels = 1;
+    ImageCreateInfo.arrayLayers = 1;
+    ImageCreateInfo.samples = Samples;
+    ImageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ImageCreateInfo.usage = Usage;
+    ImageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ImageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VkResult Result = vkCreateImage(Context->Device,
+                                    &ImageCreateInfo,
+                                    GetHostAllocator(Context, HOST_TAG_IMAGE),
+                                    Image);
+
+    Assert(Result == VK_SUCCESS, "Failed to create attachment image.\n");
+
+    AllocateImageMemory(Context,
+                        *Image,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    VkImageViewCreateInfo ImageViewCreateInfo = {};
+    ImageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    ImageViewCreateInfo.image = *Image;
+    ImageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    ImageViewCreateInfo.format = Format;
+    ImageViewCreateInfo.components = {
+        VK_COMPONENT_SWIZZLE_IDENTITY,
+        VK_COMPONENT_SWIZZLE_IDENTITY,
+        VK_COMPONENT_SWIZZLE_IDENTITY,
+        VK_COMPONENT_SWIZZLE_IDENTITY
+    };
+    ImageViewCreateInfo.subresourceRange.aspectMask = Aspect;
+    ImageViewCreateInfo.subresourceRange.levelCount = 1;
+    ImageViewCreateInfo.subresourceRange.layerCount = 1;
+
+    Result = vkCreateImageView(Context->Device,
+                               &ImageViewCreateInfo,
+                               GetHostAllocator(Context, HOST_TAG_IMAGE),
+                               ImageView);
+
+    Assert(Result == VK_SUCCESS, "Failed to create attachment image view.\n");
+
+    TrackImage(&Context->Resources,
+               *Image,
+               Aspect,
+               1, 1,
+               VK_IMAGE_LAYOUT_UNDEFINED);
+}
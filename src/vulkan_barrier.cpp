@@ -0,0 +1,498 @@
+/**
+ * @file vulkan_barrier.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our resource state tracker. Callers ask for a resource
+ * to be put in a given usage with UseImage()/UseBuffer(), and the tracker
+ * queues up the smallest set of barriers that gets it there. All queued
+ * barriers go out in a single vkCmdPipelineBarrier() call on FlushBarriers().
+ */
+
+#include "platform.h"
+#include "render.h"
+
+typedef struct {
+    VkImageLayout        Layout;
+    VkPipelineStageFlags Stages;
+    VkAccessFlags        Access;
+    bool                 IsWrite;
+} resource_usage_info;
+
+// NOTE[joe] This must stay in the same order as resource_usage.
+static const resource_usage_info ResourceUsageInfo[RESOURCE_USAGE_COUNT] = {
+    // RESOURCE_USAGE_UNDEFINED
+    { VK_IMAGE_LAYOUT_UNDEFINED,
+      0,
+      0,
+      false },
+    // RESOURCE_USAGE_COLOR_ATTACHMENT
+    { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+      VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+      VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+      true },
+    // RESOURCE_USAGE_DEPTH_ATTACHMENT
+    { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+      VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+      VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+      true },
+    // RESOURCE_USAGE_PRESENT
+    // NOTE[joe] The presentation engine makes writes visible by itself, so
+    // we don't need any access flags here.
+    { VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+      0,
+      false },
+    // RESOURCE_USAGE_TRANSFER_SRC
+    { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_ACCESS_TRANSFER_READ_BIT,
+      false },
+    // RESOURCE_USAGE_TRANSFER_DST
+    { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      true },
+    // RESOURCE_USAGE_FRAGMENT_SAMPLED
+    { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+      VK_ACCESS_SHADER_READ_BIT,
+      false },
+    // RESOURCE_USAGE_COMPUTE_SAMPLED
+    { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_ACCESS_SHADER_READ_BIT,
+      false },
+    // RESOURCE_USAGE_COMPUTE_READ
+    { VK_IMAGE_LAYOUT_GENERAL,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_ACCESS_SHADER_READ_BIT,
+      false },
+    // RESOURCE_USAGE_COMPUTE_WRITE
+    { VK_IMAGE_LAYOUT_GENERAL,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+      true },
+    // RESOURCE_USAGE_VERTEX_READ
+    // NOTE[joe] Storage reads from a vertex shader that fetches its own
+    // vertices, as opposed to vertex input.
+    { VK_IMAGE_LAYOUT_GENERAL,
+      VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+      VK_ACCESS_SHADER_READ_BIT,
+      false },
+    // RESOURCE_USAGE_VERTEX_BUFFER
+    { VK_IMAGE_LAYOUT_UNDEFINED,
+      VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+      VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+      false },
+    // RESOURCE_USAGE_INDEX_BUFFER
+    { VK_IMAGE_LAYOUT_UNDEFINED,
+      VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+      VK_ACCESS_INDEX_READ_BIT,
+      false },
+    // RESOURCE_USAGE_INDIRECT_BUFFER
+    { VK_IMAGE_LAYOUT_UNDEFINED,
+      VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+      VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+      false },
+    // RESOURCE_USAGE_UNIFORM_BUFFER
+    { VK_IMAGE_LAYOUT_UNDEFINED,
+      VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+      VK_ACCESS_UNIFORM_READ_BIT,
+      false },
+    // RESOURCE_USAGE_HOST_READ
+    { VK_IMAGE_LAYOUT_UNDEFINED,
+      VK_PIPELINE_STAGE_HOST_BIT,
+      VK_ACCESS_HOST_READ_BIT,
+      false },
+};
+
+/** Puts a subresource state back to "nothing has touched this yet". */
+static inline
+void ResetResourceState(resource_state *State, VkImageLayout Layout)
+{
+    *State = {};
+    State->Layout = Layout;
+}
+
+/** Starts tracking an image. InitialLayout is the layout the image is in
+ * right now (VK_IMAGE_LAYOUT_UNDEFINED for freshly created images). */
+static
+void TrackImage(resource_tracker *Tracker,
+                VkImage Image,
+                VkImageAspectFlags Aspect,
+                unsigned int MipCount,
+                unsigned int LayerCount,
+                VkImageLayout InitialLayout)
+{
+    Assert(Tracker->ImageCount < RESOURCE_MAX_IMAGES,
+           "Too many images tracked.\n");
+    Assert(MipCount * LayerCount <= RESOURCE_MAX_SUBRESOURCES,
+           "Image has too many subresources to track.\n");
+
+    tracked_image *Tracked = &Tracker->Images[Tracker->ImageCount++];
+    Tracked->Image = Image;
+    Tracked->Aspect = Aspect;
+    Tracked->MipCount = MipCount;
+    Tracked->LayerCount = LayerCount;
+
+    for (unsigned int i = 0; i < MipCount * LayerCount; i++)
+    {
+        ResetResourceState(&Tracked->Subresources[i], InitialLayout);
+    }
+}
+
+/** Starts tracking a buffer. */
+static
+void TrackBuffer(resource_tracker *Tracker, VkBuffer Buffer)
+{
+    Assert(Tracker->BufferCount < RESOURCE_MAX_BUFFERS,
+           "Too many buffers tracked.\n");
+
+    tracked_buffer *Tracked = &Tracker->Buffers[Tracker->BufferCount++];
+    Tracked->Buffer = Buffer;
+    ResetResourceState(&Tracked->State, VK_IMAGE_LAYOUT_UNDEFINED);
+}
+
+/** Stops tracking a buffer, before it's destroyed. */
+static
+void UntrackBuffer(resource_tracker *Tracker, VkBuffer Buffer)
+{
+    for (unsigned int i = 0; i < Tracker->BufferCount; i++)
+    {
+        if (Tracker->Buffers[i].Buffer == Buffer)
+        {
+            Tracker->Buffers[i] = Tracker->Buffers[--Tracker->BufferCount];
+            return;
+        }
+    }
+
+    Assert(false, "Buffer is not being tracked.\n");
+}
+
+static
+tracked_image* FindTrackedImage(resource_tracker *Tracker, VkImage Image)
+{
+    for (unsigned int i = 0; i < Tracker->ImageCount; i++)
+    {
+        if (Tracker->Images[i].Image == Image)
+            return &Tracker->Images[i];
+    }
+
+    Assert(false, "Image is not being tracked.\n");
+    return 0;
+}
+
+static
+tracked_buffer* FindTrackedBuffer(resource_tracker *Tracker, VkBuffer Buffer)
+{
+    for (unsigned int i = 0; i < Tracker->BufferCount; i++)
+    {
+        if (Tracker->Buffers[i].Buffer == Buffer)
+            return &Tracker->Buffers[i];
+    }
+
+    Assert(false, "Buffer is not being tracked.\n");
+    return 0;
+}
+
+/** Tells the tracker that an image was just handed to us by a semaphore wait
+ * at WaitStages (i.e. a swapchain image from vkAcquireNextImageKHR). Anything
+ * that touches the image must now chain off of that wait. */
+static
+void AcquireImage(resource_tracker *Tracker,
+                  VkImage Image,
+                  VkPipelineStageFlags WaitStages)
+{
+    tracked_image *Tracked = FindTrackedImage(Tracker, Image);
+
+    for (unsigned int i = 0; i < Tracked->MipCount * Tracked->LayerCount; i++)
+    {
+        ResetResourceState(&Tracked->Subresources[i],
+                           Tracked->Subresources[i].Layout);
+        Tracked->Subresources[i].WriteStages = WaitStages;
+    }
+}
+
+/** Works out what it takes to move State into Usage. Returns true when a
+ * dependency is needed, filling in the source/destination masks. State is
+ * updated to what it will be once the dependency has executed. */
+static
+bool TransitionResourceState(resource_state *State,
+                             resource_usage Usage,
+                             bool IsImage,
+                             VkPipelineStageFlags *SrcStages,
+                             VkAccessFlags *SrcAccess,
+                             VkImageLayout *OldLayout)
+{
+    resource_usage_info Info = ResourceUsageInfo[Usage];
+
+    *SrcStages = 0;
+    *SrcAccess = 0;
+    *OldLayout = State->Layout;
+
+    bool LayoutChange = IsImage && State->Layout != Info.Layout;
+    bool IsNeeded = false;
+
+    if (LayoutChange)
+    {
+        // NOTE[joe] A layout transition is a read and a write, so it has to
+        // wait on everything that came before it.
+        *SrcStages = State->WriteStages | State->ReadStages;
+        *SrcAccess = State->WriteAccess;
+        IsNeeded = true;
+    }
+    else if (Info.IsWrite)
+    {
+        // Write after write, or write after read.
+        if (State->WriteStages || State->ReadStages)
+        {
+            *SrcStages = State->WriteStages | State->ReadStages;
+            *SrcAccess = State->WriteAccess;
+            IsNeeded = true;
+        }
+    }
+    else
+    {
+        // Read after write, unless the write is already visible to us.
+        if (State->WriteStages &&
+            ((Info.Stages & ~State->VisibleStages) ||
+             (Info.Access & ~State->VisibleAccess)))
+        {
+            *SrcStages = State->WriteStages;
+            *SrcAccess = State->WriteAccess;
+            IsNeeded = true;
+        }
+    }
+
+    if (Info.IsWrite || LayoutChange)
+    {
+        // NOTE[joe] A read-only layout transition still counts as a write
+        // that only the destination stages have seen.
+        State->Layout = IsImage ? Info.Layout : State->Layout;
+        State->WriteStages = Info.Stages;
+        State->WriteAccess = Info.IsWrite ? Info.Access : 0;
+        State->ReadStages = Info.IsWrite ? 0 : Info.Stages;
+        State->VisibleStages = Info.IsWrite ? 0 : Info.Stages;
+        State->VisibleAccess = Info.IsWrite ? 0 : Info.Access;
+    }
+    else
+    {
+        State->ReadStages |= Info.Stages;
+
+        if (IsNeeded)
+        {
+            State->VisibleStages |= Info.Stages;
+            State->VisibleAccess |= Info.Access;
+        }
+    }
+
+    return IsNeeded;
+}
+
+/** Queues an image barrier, merging it into an already queued barrier for
+ * the same image when the two cover neighbouring mip levels. */
+static
+void QueueImageBarrier(resource_tracker *Tracker,
+                       tracked_image *Tracked,
+                       VkImageLayout OldLayout,
+                       VkImageLayout NewLayout,
+                       VkAccessFlags SrcAccess,
+                       VkAccessFlags DstAccess,
+                       unsigned int Mip,
+                       unsigned int Layer)
+{
+    for (unsigned int i = 0; i < Tracker->PendingImageBarrierCount; i++)
+    {
+        VkImageMemoryBarrier *Pending = &Tracker->PendingImageBarriers[i];
+        VkImageSubresourceRange *Range = &Pending->subresourceRange;
+
+        if (Pending->image != Tracked->Image ||
+            Range->baseArrayLayer != Layer)
+            continue;
+
+        if (Mip >= Range->baseMipLevel &&
+            Mip < Range->baseMipLevel + Range->levelCount)
+        {
+            // NOTE[joe] Two uses of the same subresource in one sync point.
+            // Barriers within a single call aren't ordered, so the last use
+            // wins and we only transition once.
+            Pending->newLayout = NewLayout;
+            Pending->dstAccessMask |= DstAccess;
+            return;
+        }
+
+        if (Pending->oldLayout == OldLayout &&
+            Pending->newLayout == NewLayout &&
+            Pending->srcAccessMask == SrcAccess &&
+            Pending->dstAccessMask == DstAccess &&
+            Mip == Range->baseMipLevel + Range->levelCount)
+        {
+            Range->levelCount++;
+            return;
+        }
+    }
+
+    Assert(Tracker->PendingImageBarrierCount < RESOURCE_MAX_PENDING_BARRIERS,
+           "Too many barriers queued before flush.\n");
+
+    VkImageMemoryBarrier *Barrier =
+        &Tracker->PendingImageBarriers[Tracker->PendingImageBarrierCount++];
+
+    *Barrier = {};
+    Barrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    Barrier->srcAccessMask = SrcAccess;
+    Barrier->dstAccessMask = DstAccess;
+    Barrier->oldLayout = OldLayout;
+    Barrier->newLayout = NewLayout;
+    Barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    Barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    Barrier->image = Tracked->Image;
+    Barrier->subresourceRange.aspectMask = Tracked->Aspect;
+    Barrier->subresourceRange.baseMipLevel = Mip;
+    Barrier->subresourceRange.levelCount = 1;
+    Barrier->subresourceRange.baseArrayLayer = Layer;
+    Barrier->subresourceRange.layerCount = 1;
+}
+
+/** Requests that mips [BaseMip, BaseMip + MipCount) of every layer of Image
+ * be ready for Usage at the next FlushBarriers(). */
+static
+void UseImageMips(resource_tracker *Tracker,
+                  VkImage Image,
+                  resource_usage Usage,
+                  unsigned int BaseMip,
+                  unsigned int MipCount)
+{
+    tracked_image *Tracked = FindTrackedImage(Tracker, Image);
+    resource_usage_info Info = ResourceUsageInfo[Usage];
+
+    Assert(BaseMip + MipCount <= Tracked->MipCount,
+           "Mip range is outside of the image.\n");
+
+    for (unsigned int Layer = 0; Layer < Tracked->LayerCount; Layer++)
+    {
+        for (unsigned int Mip = BaseMip; Mip < BaseMip + MipCount; Mip++)
+        {
+            resource_state *State =
+                &Tracked->Subresources[Layer * Tracked->MipCount + Mip];
+
+            VkPipelineStageFlags SrcStages;
+            VkAccessFlags SrcAccess;
+            VkImageLayout OldLayout;
+
+            if (!TransitionResourceState(State, Usage, true,
+                                         &SrcStages, &SrcAccess, &OldLayout))
+            {
+                Tracker->Stats.ElidedCount++;
+                continue;
+            }
+
+            Tracker->PendingSrcStages |= SrcStages;
+            Tracker->PendingDstStages |= Info.Stages;
+
+            if (OldLayout != Info.Layout)
+            {
+                QueueImageBarrier(Tracker, Tracked,
+                                  OldLayout, Info.Layout,
+                                  SrcAccess, Info.Access,
+                                  Mip, Layer);
+            }
+            else if (SrcAccess)
+            {
+                // NOTE[joe] No layout change means that a global memory
+                // barrier does the job just as well as an image barrier.
+                Tracker->PendingSrcAccess |= SrcAccess;
+                Tracker->PendingDstAccess |= Info.Access;
+            }
+        }
+    }
+}
+
+/** Requests that the whole of Image be ready for Usage at the next
+ * FlushBarriers(). */
+static inline
+void UseImage(resource_tracker *Tracker, VkImage Image, resource_usage Usage)
+{
+    tracked_image *Tracked = FindTrackedImage(Tracker, Image);
+    UseImageMips(Tracker, Image, Usage, 0, Tracked->MipCount);
+}
+
+/** Requests that Buffer be ready for Usage at the next FlushBarriers(). */
+static
+void UseBuffer(resource_tracker *Tracker, VkBuffer Buffer, resource_usage Usage)
+{
+    tracked_buffer *Tracked = FindTrackedBuffer(Tracker, Buffer);
+    resource_usage_info Info = ResourceUsageInfo[Usage];
+
+    VkPipelineStageFlags SrcStages;
+    VkAccessFlags SrcAccess;
+    VkImageLayout OldLayout;
+
+    if (!TransitionResourceState(&Tracked->State, Usage, false,
+                                 &SrcStages, &SrcAccess, &OldLayout))
+    {
+        Tracker->Stats.ElidedCount++;
+        return;
+    }
+
+    Tracker->PendingSrcStages |= SrcStages;
+    Tracker->PendingDstStages |= Info.Stages;
+
+    if (SrcAccess)
+    {
+        Tracker->PendingSrcAccess |= SrcAccess;
+        Tracker->PendingDstAccess |= Info.Access;
+    }
+}
+
+/** Records every queued barrier into CommandBuffer with a single
+ * vkCmdPipelineBarrier() call. Does nothing if nothing is queued. */
+static
+void FlushBarriers(resource_tracker *Tracker, VkCommandBuffer CommandBuffer)
+{
+    if (!Tracker->PendingSrcStages &&
+        !Tracker->PendingDstStages &&
+        !Tracker->PendingImageBarrierCount)
+    {
+        return;
+    }
+
+    VkPipelineStageFlags SrcStages = Tracker->PendingSrcStages;
+    VkPipelineStageFlags DstStages = Tracker->PendingDstStages;
+
+    // NOTE[joe] Zero stage masks aren't allowed. Nothing to wait on means we
+    // wait on the top of the pipe, nothing waiting means the bottom.
+    if (!SrcStages) SrcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    if (!DstStages) DstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+    VkMemoryBarrier MemoryBarrier = {};
+    MemoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    MemoryBarrier.srcAccessMask = Tracker->PendingSrcAccess;
+    MemoryBarrier.dstAccessMask = Tracker->PendingDstAccess;
+
+    unsigned int MemoryBarrierCount = Tracker->PendingSrcAccess ? 1 : 0;
+
+    vkCmdPipelineBarrier(CommandBuffer,
+                         SrcStages,
+                         DstStages,
+                         0, // Dependency flags
+                         MemoryBarrierCount, &MemoryBarrier,
+                         0, 0, // Buffer barriers are folded into the above.
+                         Tracker->PendingImageBarrierCount,
+                         Tracker->PendingImageBarriers);
+
+    Tracker->Stats.FlushCount++;
+    Tracker->Stats.ImageBarrierCount += Tracker->PendingImageBarrierCount;
+    Tracker->Stats.MemoryBarrierCount += MemoryBarrierCount;
+
+    Tracker->PendingSrcStages = 0;
+    Tracker->PendingDstStages = 0;
+    Tracker->PendingSrcAccess = 0;
+    Tracker->PendingDstAccess = 0;
+    Tracker->PendingImageBarrierCount = 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file vulkan_barrier.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for our resource state tracker. Instead
+ * of hand-picking layouts and access masks at every vkCmdPipelineBarrier()
+ * call, rendering code says how it is about to use an image or buffer and the
+ * tracker works out which barriers (if any) are needed to get it there.
+ */
+
+#ifndef _VULKAN_BARRIER_H_
+#define _VULKAN_BARRIER_H_
+
+// NOTE[joe] These are fixed so that the tracker never allocates.
+#define RESOURCE_MAX_IMAGES 64
+#define RESOURCE_MAX_BUFFERS 64
+#define RESOURCE_MAX_SUBRESOURCES 16
+#define RESOURCE_MAX_PENDING_BARRIERS 32
+
+/** The ways in which we can use a resource. Every usage maps to a layout,
+ * a set of pipeline stages and a set of access flags. */
+typedef enum {
+    RESOURCE_USAGE_UNDEFINED = 0,
+    RESOURCE_USAGE_COLOR_ATTACHMENT,
+    RESOURCE_USAGE_DEPTH_ATTACHMENT,
+    RESOURCE_USAGE_PRESENT,
+    RESOURCE_USAGE_TRANSFER_SRC,
+    RESOURCE_USAGE_TRANSFER_DST,
+    RESOURCE_USAGE_FRAGMENT_SAMPLED,
+    RESOURCE_USAGE_COMPUTE_SAMPLED,
+    RESOURCE_USAGE_COMPUTE_READ,
+    RESOURCE_USAGE_COMPUTE_WRITE,
+    RESOURCE_USAGE_VERTEX_READ,
+    RESOURCE_USAGE_VERTEX_BUFFER,
+    RESOURCE_USAGE_INDEX_BUFFER,
+    RESOURCE_USAGE_INDIRECT_BUFFER,
+    RESOURCE_USAGE_UNIFORM_BUFFER,
+    RESOURCE_USAGE_HOST_READ,
+    RESOURCE_USAGE_COUNT
+} resource_usage;
+
+/** The synchronization state of a single subresource (an image mip/layer or
+ * a whole buffer). */
+typedef struct {
+    VkImageLayout        Layout;
+    // Stages and accesses of the last write, which later uses depend on.
+    VkPipelineStageFlags WriteStages;
+    VkAccessFlags        WriteAccess;
+    // Stages that have read since the last write, which a later write must
+    // wait for.
+    VkPipelineStageFlags ReadStages;
+    // Stages and accesses the last write has already been made visible to.
+    VkPipelineStageFlags VisibleStages;
+    VkAccessFlags        VisibleAccess;
+} resource_state;
+
+typedef struct {
+    VkImage            Image;
+    VkImageAspectFlags Aspect;
+    unsigned int       MipCount;
+    unsigned int       LayerCount;
+    resource_state     Subresources[RESOURCE_MAX_SUBRESOURCES];
+} tracked_image;
+
+typedef struct {
+    VkBuffer       Buffer;
+    resource_state State;
+} tracked_buffer;
+
+/** Counters used to keep an eye on how much synchronization we're doing. */
+typedef struct {
+    unsigned int FlushCount;         // vkCmdPipelineBarrier() calls.
+    unsigned int ImageBarrierCount;  // VkImageMemoryBarriers emitted.
+    unsigned int MemoryBarrierCount; // Global VkMemoryBarriers emitted.
+    unsigned int ElidedCount;        // Requests that needed no barrier.
+} resource_barrier_stats;
+
+typedef struct {
+    unsigned int   ImageCount;
+    tracked_image  Images[RESOURCE_MAX_IMAGES];
+    unsigned int   BufferCount;
+    tracked_buffer Buffers[RESOURCE_MAX_BUFFERS];
+
+    /** Barriers waiting for the next FlushBarriers(). */
+    VkPipelineStageFlags PendingSrcStages;
+    VkPipelineStageFlags PendingDstStages;
+    // NOTE[joe] Buffer hazards are all folded into one global memory barrier,
+    // since drivers don't do anything useful with buffer ranges anyway.
+    VkAccessFlags        PendingSrcAccess;
+    VkAccessFlags        PendingDstAccess;
+    unsigned int         PendingImageBarrierCount;
+    VkImageMemoryBarrier PendingImageBarriers[RESOURCE_MAX_PENDING_BARRIERS];
+
+    resource_barrier_stats Stats;
+} resource_tracker;
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @file vulkan_dispatch.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the code that fills in the Vulkan function handles
+ * listed in vulkan_dispatch.h. The platform layer only has to find
+ * vkGetInstanceProcAddr() in the Vulkan library; the rest is loaded from
+ * here, and every entry point we couldn't find gets logged by name.
+ */
+
+#include "platform.h"
+#include "render.h"
+
+// NOTE[joe] Missing is whatever counter the caller is keeping.
+#define VULKAN_LOAD_GLOBAL_FUNCTION(Name)                                   \
+    Name = (PFN_##Name)vkGetInstanceProcAddr(0, #Name);                     \
+    if (!Name) { PlatformLog("Missing Vulkan function %s.\n", #Name);       \
+                 Missing++; }
+
+#define VULKAN_LOAD_INSTANCE_FUNCTION(Name)                                 \
+    Name = (PFN_##Name)vkGetInstanceProcAddr(Instance, #Name);              \
+    if (!Name) { PlatformLog("Missing Vulkan function %s.\n", #Name);       \
+                 Missing++; }
+
+#define VULKAN_LOAD_DEVICE_FUNCTION(Name)                                   \
+    Name = (PFN_##Name)vkGetDeviceProcAddr(Device, #Name);                  \
+    if (!Name) { PlatformLog("Missing Vulkan function %s.\n", #Name);       \
+                 Missing++; }
+
+/** Loads the functions that don't need an instance. Expects the platform
+ * layer to have set vkGetInstanceProcAddr. Returns how many are missing. */
+static
+unsigned int LoadVulkanGlobalFunctions()
+{
+    unsigned int Missing = 0;
+
+    VULKAN_GLOBAL_FUNCTIONS(VULKAN_LOAD_GLOBAL_FUNCTION)
+
+    vkEnumerateInstanceVersion = (PFN_vkEnumerateInstanceVersion)
+        vkGetInstanceProcAddr(0, "vkEnumerateInstanceVersion");
+
+    return Missing;
+}
+
+/** Loads the instance functions, plus whichever optional instance groups are
+ * set in Groups. Returns how many are missing. */
+static
+unsigned int LoadVulkanInstanceFunctions(VkInstance Instance,
+                                         unsigned int Groups)
+{
+    unsigned int Missing = 0;
+
+    VULKAN_INSTANCE_FUNCTIONS(VULKAN_LOAD_INSTANCE_FUNCTION)
+
+    if (Groups & VULKAN_FUNCTIONS_INSTANCE_1_1)
+    {
+        VULKAN_INSTANCE_1_1_FUNCTIONS(VULKAN_LOAD_INSTANCE_FUNCTION)
+    }
+
+    if (Groups & VULKAN_FUNCTIONS_DEBUG_REPORT)
+    {
+        VULKAN_DEBUG_REPORT_FUNCTIONS(VULKAN_LOAD_INSTANCE_FUNCTION)
+    }
+
+    return Missing;
+}
+
+/** Loads the device functions straight from the driver, plus whichever
+ * optional device groups are set in Groups. Returns how many are missing. */
+static
+unsigned int LoadVulkanDeviceFunctions(VkDevice Device, unsigned int Groups)
+{
+    unsigned int Missing = 0;
+
+    VULKAN_DEVICE_FUNCTIONS(VULKAN_LOAD_DEVICE_FUNCTION)
+
+    if (Groups & VULKAN_FUNCTIONS_DYNAMIC_RENDERING)
+    {
+        VULKAN_DYNAMIC_RENDERING_FUNCTIONS(VULKAN_LOAD_DEVICE_FUNCTION)
+    }
+
+    if (Groups & VULKAN_FUNCTIONS_DYNAMIC_STATE)
+    {
+        VULKAN_DYNAMIC_STATE_FUNCTIONS(VULKAN_LOAD_DEVICE_FUNCTION)
+    }
+
+    if (Groups & VULKAN_FUNCTIONS_DYNAMIC_STATE_2)
+    {
+        VULKAN_DYNAMIC_STATE_2_FUNCTIONS(VULKAN_LOAD_DEVICE_FUNCTION)
+    }
+
+    if (Groups & VULKAN_FUNCTIONS_DYNAMIC_STATE_3)
+    {
+        VULKAN_DYNAMIC_STATE_3_FUNCTIONS(VULKAN_LOAD_DEVICE_FUNCTION)
+    }
+
+    return Missing;
+}
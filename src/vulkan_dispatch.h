@@ -0,0 +1,160 @@
+/**
+ * @file vulkan_dispatch.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file lists every Vulkan function we call, grouped by what they have to
+ * be loaded through. The lists are X-macros: the handles themselves and the
+ * code that loads them (see vulkan_dispatch.cpp) are both generated from
+ * them, so adding a function is a one line change.
+ *
+ * Device functions are loaded with vkGetDeviceProcAddr(), which hands us the
+ * driver's entry points directly instead of the loader's trampolines. That is
+ * every vkCmd* and vkQueue* call we make each frame.
+ */
+
+#ifndef _VULKAN_DISPATCH_H_
+#define _VULKAN_DISPATCH_H_
+
+/** Loaded with vkGetInstanceProcAddr(0, ...). */
+#define VULKAN_GLOBAL_FUNCTIONS(X)                  \
+    X(vkCreateInstance)                             \
+    X(vkEnumerateInstanceLayerProperties)           \
+    X(vkEnumerateInstanceExtensionProperties)
+
+/** Loaded with vkGetInstanceProcAddr(Instance, ...). */
+#define VULKAN_INSTANCE_FUNCTIONS(X)                \
+    X(vkEnumeratePhysicalDevices)                   \
+    X(vkGetPhysicalDeviceProperties)                \
+    X(vkGetPhysicalDeviceQueueFamilyProperties)     \
+    X(vkGetPhysicalDeviceMemoryProperties)          \
+    X(vkGetPhysicalDeviceFormatProperties)          \
+    X(vkEnumerateDeviceExtensionProperties)         \
+    X(vkCreateDevice)                               \
+    X(vkGetDeviceProcAddr)                          \
+    X(vkGetPhysicalDeviceSurfaceSupportKHR)         \
+    X(vkGetPhysicalDeviceSurfaceFormatsKHR)         \
+    X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR)    \
+    X(vkGetPhysicalDeviceSurfacePresentModesKHR)
+
+#define VULKAN_INSTANCE_1_1_FUNCTIONS(X)            \
+    X(vkGetPhysicalDeviceFeatures2)                 \
+    X(vkGetPhysicalDeviceMemoryProperties2)
+
+#define VULKAN_DEBUG_REPORT_FUNCTIONS(X)            \
+    X(vkCreateDebugReportCallbackEXT)               \
+    X(vkDestroyDebugReportCallbackEXT)              \
+    X(vkDebugReportMessageEXT)
+
+/** Loaded with vkGetDeviceProcAddr(Device, ...). */
+#define VULKAN_DEVICE_FUNCTIONS(X)                  \
+    X(vkGetDeviceQueue)                             \
+    X(vkQueueSubmit)                                \
+    X(vkCreateCommandPool)                          \
+    X(vkAllocateCommandBuffers)                     \
+    X(vkBeginCommandBuffer)                         \
+    X(vkEndCommandBuffer)                           \
+    X(vkResetCommandBuffer)                         \
+    X(vkCreateFence)                                \
+    X(vkDestroyFence)                               \
+    X(vkGetFenceStatus)                             \
+    X(vkWaitForFences)                              \
+    X(vkResetFences)                                \
+    X(vkCreateSemaphore)                            \
+    X(vkDestroySemaphore)                           \
+    X(vkAllocateMemory)                             \
+    X(vkFreeMemory)                                 \
+    X(vkMapMemory)                                  \
+    X(vkUnmapMemory)                                \
+    X(vkCreateImage)                                \
+    X(vkCreateImageView)                            \
+    X(vkCreateSampler)                              \
+    X(vkGetImageMemoryRequirements)                 \
+    X(vkBindImageMemory)                            \
+    X(vkCreateBuffer)                               \
+    X(vkDestroyBuffer)                              \
+    X(vkGetBufferMemoryRequirements)                \
+    X(vkBindBufferMemory)                           \
+    X(vkCreateRenderPass)                           \
+    X(vkCreateFramebuffer)                          \
+    X(vkCreateShaderModule)                         \
+    X(vkCreatePipelineLayout)                       \
+    X(vkCreatePipelineCache)                        \
+    X(vkCreateGraphicsPipelines)                    \
+    X(vkCreateComputePipelines)                     \
+    X(vkCreateDescriptorSetLayout)                  \
+    X(vkCreateDescriptorPool)                       \
+    X(vkAllocateDescriptorSets)                     \
+    X(vkUpdateDescriptorSets)                       \
+    X(vkCmdPipelineBarrier)                         \
+    X(vkCmdCopyBuffer)                              \
+    X(vkCmdCopyBufferToImage)                       \
+    X(vkCmdBeginRenderPass)                         \
+    X(vkCmdEndRenderPass)                           \
+    X(vkCmdBindPipeline)                            \
+    X(vkCmdBindVertexBuffers)                       \
+    X(vkCmdBindDescriptorSets)                      \
+    X(vkCmdPushConstants)                           \
+    X(vkCmdSetViewport)                             \
+    X(vkCmdSetScissor)                              \
+    X(vkCmdDraw)                                    \
+    X(vkCmdDrawIndirect)                            \
+    X(vkCmdDispatch)                                \
+    X(vkCmdDispatchIndirect)                        \
+    X(vkCreateSwapchainKHR)                         \
+    X(vkGetSwapchainImagesKHR)                      \
+    X(vkAcquireNextImageKHR)                        \
+    X(vkQueuePresentKHR)
+
+#define VULKAN_DYNAMIC_RENDERING_FUNCTIONS(X)       \
+    X(vkCmdBeginRenderingKHR)                       \
+    X(vkCmdEndRenderingKHR)
+
+#define VULKAN_DYNAMIC_STATE_FUNCTIONS(X)           \
+    X(vkCmdSetCullModeEXT)                          \
+    X(vkCmdSetFrontFaceEXT)                         \
+    X(vkCmdSetPrimitiveTopologyEXT)                 \
+    X(vkCmdSetDepthTestEnableEXT)                   \
+    X(vkCmdSetDepthWriteEnableEXT)                  \
+    X(vkCmdSetDepthCompareOpEXT)
+
+#define VULKAN_DYNAMIC_STATE_2_FUNCTIONS(X)         \
+    X(vkCmdSetDepthBiasEnableEXT)                   \
+    X(vkCmdSetPrimitiveRestartEnableEXT)
+
+#define VULKAN_DYNAMIC_STATE_3_FUNCTIONS(X)         \
+    X(vkCmdSetPolygonModeEXT)                       \
+    X(vkCmdSetColorBlendEnableEXT)
+
+/** The optional groups above. Each is only loaded (and only checked for
+ * missing entry points) when its bit is passed in, meaning the version or
+ * extension it belongs to is actually enabled. */
+typedef enum {
+    VULKAN_FUNCTIONS_INSTANCE_1_1      = 1 << 0,
+    VULKAN_FUNCTIONS_DEBUG_REPORT      = 1 << 1,
+    VULKAN_FUNCTIONS_DYNAMIC_RENDERING = 1 << 2,
+    VULKAN_FUNCTIONS_DYNAMIC_STATE     = 1 << 3,
+    VULKAN_FUNCTIONS_DYNAMIC_STATE_2   = 1 << 4,
+    VULKAN_FUNCTIONS_DYNAMIC_STATE_3   = 1 << 5,
+} vulkan_function_group;
+
+#define VULKAN_DECLARE_FUNCTION(Name) static PFN_##Name Name;
+
+// NOTE[joe] The loader hands us this one; everything else comes from it.
+static PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
+
+// NOTE[joe] This is null on 1.0 loaders, which is how we tell, so it isn't
+// part of the checked global list.
+static PFN_vkEnumerateInstanceVersion vkEnumerateInstanceVersion;
+
+VULKAN_GLOBAL_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+VULKAN_INSTANCE_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+VULKAN_INSTANCE_1_1_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+VULKAN_DEBUG_REPORT_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+VULKAN_DEVICE_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+VULKAN_DYNAMIC_RENDERING_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+VULKAN_DYNAMIC_STATE_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+VULKAN_DYNAMIC_STATE_2_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+VULKAN_DYNAMIC_STATE_3_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+
+#endif
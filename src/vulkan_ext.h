@@ -0,0 +1,227 @@
+/**
+ * @file vulkan_ext.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains definitions for Vulkan extensions that are newer than
+ * the headers we ship in include/vulkan. Everything here is copied from the
+ * Vulkan registry and guarded, so it quietly steps aside once the headers are
+ * updated.
+ */
+
+#ifndef _VULKAN_EXT_H_
+#define _VULKAN_EXT_H_
+
+#ifndef VK_KHR_dynamic_rendering
+#define VK_KHR_dynamic_rendering 1
+#define VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME "VK_KHR_dynamic_rendering"
+
+#define VK_STRUCTURE_TYPE_RENDERING_INFO_KHR \
+    ((VkStructureType)1000044000)
+#define VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR \
+    ((VkStructureType)1000044001)
+#define VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR \
+    ((VkStructureType)1000044002)
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR \
+    ((VkStructureType)1000044003)
+
+typedef VkFlags VkRenderingFlagsKHR;
+
+typedef struct VkRenderingAttachmentInfoKHR {
+    VkStructureType          sType;
+    const void*              pNext;
+    VkImageView              imageView;
+    VkImageLayout            imageLayout;
+    VkResolveModeFlagBitsKHR resolveMode;
+    VkImageView              resolveImageView;
+    VkImageLayout            resolveImageLayout;
+    VkAttachmentLoadOp       loadOp;
+    VkAttachmentStoreOp      storeOp;
+    VkClearValue             clearValue;
+} VkRenderingAttachmentInfoKHR;
+
+typedef struct VkRenderingInfoKHR {
+    VkStructureType                     sType;
+    const void*                         pNext;
+    VkRenderingFlagsKHR                 flags;
+    VkRect2D                            renderArea;
+    uint32_t                            layerCount;
+    uint32_t                            viewMask;
+    uint32_t                            colorAttachmentCount;
+    const VkRenderingAttachmentInfoKHR* pColorAttachments;
+    const VkRenderingAttachmentInfoKHR* pDepthAttachment;
+    const VkRenderingAttachmentInfoKHR* pStencilAttachment;
+} VkRenderingInfoKHR;
+
+typedef struct VkPipelineRenderingCreateInfoKHR {
+    VkStructureType sType;
+    const void*     pNext;
+    uint32_t        viewMask;
+    uint32_t        colorAttachmentCount;
+    const VkFormat* pColorAttachmentFormats;
+    VkFormat        depthAttachmentFormat;
+    VkFormat        stencilAttachmentFormat;
+} VkPipelineRenderingCreateInfoKHR;
+
+typedef struct VkPhysicalDeviceDynamicRenderingFeaturesKHR {
+    VkStructureType sType;
+    void*           pNext;
+    VkBool32        dynamicRendering;
+} VkPhysicalDeviceDynamicRenderingFeaturesKHR;
+
+typedef void (VKAPI_PTR *PFN_vkCmdBeginRenderingKHR)(
+    VkCommandBuffer commandBuffer,
+    const VkRenderingInfoKHR* pRenderingInfo);
+typedef void (VKAPI_PTR *PFN_vkCmdEndRenderingKHR)(
+    VkCommandBuffer commandBuffer);
+#endif
+
+#ifndef VK_EXT_extended_dynamic_state
+#define VK_EXT_extended_dynamic_state 1
+#define VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME \
+    "VK_EXT_extended_dynamic_state"
+
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT \
+    ((VkStructureType)1000267000)
+
+#define VK_DYNAMIC_STATE_CULL_MODE_EXT ((VkDynamicState)1000267000)
+#define VK_DYNAMIC_STATE_FRONT_FACE_EXT ((VkDynamicState)1000267001)
+#define VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT ((VkDynamicState)1000267002)
+#define VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT ((VkDynamicState)1000267006)
+#define VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT ((VkDynamicState)1000267007)
+#define VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT ((VkDynamicState)1000267008)
+
+typedef struct VkPhysicalDeviceExtendedDynamicStateFeaturesEXT {
+    VkStructureType sType;
+    void*           pNext;
+    VkBool32        extendedDynamicState;
+} VkPhysicalDeviceExtendedDynamicStateFeaturesEXT;
+
+typedef void (VKAPI_PTR *PFN_vkCmdSetCullModeEXT)(
+    VkCommandBuffer commandBuffer,
+    VkCullModeFlags cullMode);
+typedef void (VKAPI_PTR *PFN_vkCmdSetFrontFaceEXT)(
+    VkCommandBuffer commandBuffer,
+    VkFrontFace frontFace);
+typedef void (VKAPI_PTR *PFN_vkCmdSetPrimitiveTopologyEXT)(
+    VkCommandBuffer commandBuffer,
+    VkPrimitiveTopology primitiveTopology);
+typedef void (VKAPI_PTR *PFN_vkCmdSetDepthTestEnableEXT)(
+    VkCommandBuffer commandBuffer,
+    VkBool32 depthTestEnable);
+typedef void (VKAPI_PTR *PFN_vkCmdSetDepthWriteEnableEXT)(
+    VkCommandBuffer commandBuffer,
+    VkBool32 depthWriteEnable);
+typedef void (VKAPI_PTR *PFN_vkCmdSetDepthCompareOpEXT)(
+    VkCommandBuffer commandBuffer,
+    VkCompareOp depthCompareOp);
+#endif
+
+#ifndef VK_EXT_extended_dynamic_state2
+#define VK_EXT_extended_dynamic_state2 1
+#define VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME \
+    "VK_EXT_extended_dynamic_state2"
+
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT \
+    ((VkStructureType)1000377000)
+
+#define VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT ((VkDynamicState)1000377002)
+#define VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT \
+    ((VkDynamicState)1000377004)
+
+typedef struct VkPhysicalDeviceExtendedDynamicState2FeaturesEXT {
+    VkStructureType sType;
+    void*           pNext;
+    VkBool32        extendedDynamicState2;
+    VkBool32        extendedDynamicState2LogicOp;
+    VkBool32        extendedDynamicState2PatchControlPoints;
+} VkPhysicalDeviceExtendedDynamicState2FeaturesEXT;
+
+typedef void (VKAPI_PTR *PFN_vkCmdSetDepthBiasEnableEXT)(
+    VkCommandBuffer commandBuffer,
+    VkBool32 depthBiasEnable);
+typedef void (VKAPI_PTR *PFN_vkCmdSetPrimitiveRestartEnableEXT)(
+    VkCommandBuffer commandBuffer,
+    VkBool32 primitiveRestartEnable);
+#endif
+
+#ifndef VK_EXT_extended_dynamic_state3
+#define VK_EXT_extended_dynamic_state3 1
+#define VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME \
+    "VK_EXT_extended_dynamic_state3"
+
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT \
+    ((VkStructureType)1000455000)
+
+#define VK_DYNAMIC_STATE_POLYGON_MODE_EXT ((VkDynamicState)1000455004)
+#define VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT ((VkDynamicState)1000455010)
+
+typedef struct VkPhysicalDeviceExtendedDynamicState3FeaturesEXT {
+    VkStructureType sType;
+    void*           pNext;
+    VkBool32        extendedDynamicState3TessellationDomainOrigin;
+    VkBool32        extendedDynamicState3DepthClampEnable;
+    VkBool32        extendedDynamicState3PolygonMode;
+    VkBool32        extendedDynamicState3RasterizationSamples;
+    VkBool32        extendedDynamicState3SampleMask;
+    VkBool32        extendedDynamicState3AlphaToCoverageEnable;
+    VkBool32        extendedDynamicState3AlphaToOneEnable;
+    VkBool32        extendedDynamicState3LogicOpEnable;
+    VkBool32        extendedDynamicState3ColorBlendEnable;
+    VkBool32        extendedDynamicState3ColorBlendEquation;
+    VkBool32        extendedDynamicState3ColorWriteMask;
+    VkBool32        extendedDynamicState3RasterizationStream;
+    VkBool32        extendedDynamicState3ConservativeRasterizationMode;
+    VkBool32        extendedDynamicState3ExtraPrimitiveOverestimationSize;
+    VkBool32        extendedDynamicState3DepthClipEnable;
+    VkBool32        extendedDynamicState3SampleLocationsEnable;
+    VkBool32        extendedDynamicState3ColorBlendAdvanced;
+    VkBool32        extendedDynamicState3ProvokingVertexMode;
+    VkBool32        extendedDynamicState3LineRasterizationMode;
+    VkBool32        extendedDynamicState3LineStippleEnable;
+    VkBool32        extendedDynamicState3DepthClipNegativeOneToOne;
+    VkBool32        extendedDynamicState3ViewportWScalingEnable;
+    VkBool32        extendedDynamicState3ViewportSwizzle;
+    VkBool32        extendedDynamicState3CoverageToColorEnable;
+    VkBool32        extendedDynamicState3CoverageToColorLocation;
+    VkBool32        extendedDynamicState3CoverageModulationMode;
+    VkBool32        extendedDynamicState3CoverageModulationTableEnable;
+    VkBool32        extendedDynamicState3CoverageModulationTable;
+    VkBool32        extendedDynamicState3CoverageReductionMode;
+    VkBool32        extendedDynamicState3RepresentativeFragmentTestEnable;
+    VkBool32        extendedDynamicState3ShadingRateImageEnable;
+} VkPhysicalDeviceExtendedDynamicState3FeaturesEXT;
+
+typedef void (VKAPI_PTR *PFN_vkCmdSetPolygonModeEXT)(
+    VkCommandBuffer commandBuffer,
+    VkPolygonMode polygonMode);
+typedef void (VKAPI_PTR *PFN_vkCmdSetColorBlendEnableEXT)(
+    VkCommandBuffer commandBuffer,
+    uint32_t firstAttachment,
+    uint32_t attachmentCount,
+    const VkBool32* pColorBlendEnables);
+#endif
+
+#ifndef VK_EXT_headless_surface
+#define VK_EXT_headless_surface 1
+#define VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME "VK_EXT_headless_surface"
+
+#define VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT \
+    ((VkStructureType)1000256000)
+
+typedef VkFlags VkHeadlessSurfaceCreateFlagsEXT;
+
+typedef struct VkHeadlessSurfaceCreateInfoEXT {
+    VkStructureType                 sType;
+    const void*                     pNext;
+    VkHeadlessSurfaceCreateFlagsEXT flags;
+} VkHeadlessSurfaceCreateInfoEXT;
+
+typedef VkResult (VKAPI_PTR *PFN_vkCreateHeadlessSurfaceEXT)(
+    VkInstance instance,
+    const VkHeadlessSurfaceCreateInfoEXT* pCreateInfo,
+    const VkAllocationCallbacks* pAllocator,
+    VkSurfaceKHR* pSurface);
+#endif
+
+#endif
@@ -0,0 +1,308 @@
+/**
+ * @file vulkan_memory.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our device memory helpers. Every image and buffer we
+ * create gets its memory from here, so that there is only one place that
+ * knows how to pick a memory type and one place that counts what we use.
+ */
+
+#include "platform.h"
+#include "render.h"
+
+/** Finds a memory type allowed by TypeBits that has all of DesiredFlags.
+ * Returns -1 if the device doesn't have one. */
+static
+int FindMemoryType(vulkan_context *Context,
+                   unsigned int TypeBits,
+                   VkMemoryPropertyFlags DesiredFlags)
+{
+    for (unsigned int i = 0; i < Context->MemoryProperties.memoryTypeCount; i++)
+    {
+        VkMemoryType MemoryType = Context->MemoryProperties.memoryTypes[i];
+
+        // NOTE[joe] Bit i of TypeBits says whether memory type i is allowed.
+        if ((TypeBits & (1 << i)) &&
+            (MemoryType.propertyFlags & DesiredFlags) == DesiredFlags)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/** Allocates memory for the given requirements, using a memory type with
+ * all of PreferredFlags if there is one and all of RequiredFlags otherwise. */
+static
+VkDeviceMemory AllocateDeviceMemory(vulkan_context *Context,
+                                    VkMemoryRequirements Requirements,
+                                    VkMemoryPropertyFlags PreferredFlags,
+                                    VkMemoryPropertyFlags RequiredFlags)
+{
+    int MemoryType = FindMemoryType(Context,
+                                    Requirements.memoryTypeBits,
+                                    PreferredFlags);
+
+    if (MemoryType < 0)
+    {
+        MemoryType = FindMemoryType(Context,
+                                    Requirements.memoryTypeBits,
+                                    RequiredFlags);
+    }
+
+    Assert(MemoryType >= 0, "No suitable memory type found.\n");
+
+    VkMemoryAllocateInfo AllocateInfo = {};
+    AllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    AllocateInfo.allocationSize = Requirements.size;
+    AllocateInfo.memoryTypeIndex = MemoryType;
+
+    VkDeviceMemory Memory = VK_NULL_HANDLE;
+    VkResult Result =
+        vkAllocateMemory(Context->Device,
+                         &AllocateInfo,
+                         GetHostAllocator(Context, HOST_TAG_MEMORY),
+                         &Memory);
+
+    Assert(Result == VK_SUCCESS, "Failed to allocate device memory.\n");
+
+    /** Record the allocation. */
+
+    memory_tracker *Tracker = &Context->Memory;
+
+    Assert(Tracker->AllocationCount < MEMORY_MAX_ALLOCATIONS,
+           "Too many device memory allocations.\n");
+
+    VkMemoryType Type = Context->MemoryProperties.memoryTypes[MemoryType];
+
+    memory_allocation *Allocation =
+        &Tracker->Allocations[Tracker->AllocationCount++];
+    Allocation->Memory = Memory;
+    Allocation->Size = Requirements.size;
+    Allocation->TypeIndex = MemoryType;
+
+    Tracker->Stats.HeapBytes[Type.heapIndex] += Requirements.size;
+    Tracker->Stats.HeapAllocationCount[Type.heapIndex]++;
+
+    return Memory;
+}
+
+/** Returns what AllocateDeviceMemory() recorded about Memory, or 0 if it
+ * wasn't allocated there. */
+static
+memory_allocation *FindDeviceMemory(vulkan_context *Context,
+                                    VkDeviceMemory Memory)
+{
+    memory_tracker *Tracker = &Context->Memory;
+
+    for (unsigned int i = 0; i < Tracker->AllocationCount; i++)
+    {
+        if (Tracker->Allocations[i].Memory == Memory)
+            return &Tracker->Allocations[i];
+    }
+
+    return 0;
+}
+
+/** Returns the heap an allocation made by AllocateDeviceMemory() is on. */
+static
+unsigned int GetDeviceMemoryHeap(vulkan_context *Context,
+                                 memory_allocation *Allocation)
+{
+    return
+        Context->MemoryProperties.memoryTypes[Allocation->TypeIndex].heapIndex;
+}
+
+/** Frees memory allocated by AllocateDeviceMemory(). */
+static
+void FreeDeviceMemory(vulkan_context *Context, VkDeviceMemory Memory)
+{
+    memory_tracker *Tracker = &Context->Memory;
+    memory_allocation *Allocation = FindDeviceMemory(Context, Memory);
+
+    if (Allocation)
+    {
+        unsigned int Heap = GetDeviceMemoryHeap(Context, Allocation);
+
+        Tracker->Stats.HeapBytes[Heap] -= Allocation->Size;
+        Tracker->Stats.HeapAllocationCount[Heap]--;
+
+        *Allocation = Tracker->Allocations[--Tracker->AllocationCount];
+    }
+
+    vkFreeMemory(Context->Device,
+                 Memory,
+                 GetHostAllocator(Context, HOST_TAG_MEMORY));
+}
+
+/** Writes our memory usage out to the debug log. */
+static
+void LogMemoryStats(vulkan_context *Context)
+{
+    memory_stats *Stats = &Context->Memory.Stats;
+
+    for (unsigned int i = 0; i < Context->MemoryProperties.memoryHeapCount; i++)
+    {
+        PlatformLog("Memory heap %u: %llu KB in %u allocations.\n",
+                    i,
+                    (unsigned long long)(Stats->HeapBytes[i] / 1024),
+                    Stats->HeapAllocationCount[i]);
+    }
+
+    memory_budget *Budget = &Context->Memory.Budget;
+
+    for (unsigned int i = 0; i < Context->MemoryProperties.memoryHeapCount; i++)
+    {
+        PlatformLog("Memory heap %u: %llu of %llu KB budget in use%s.\n",
+                    i,
+                    (unsigned long long)(Budget->HeapUsage[i] / 1024),
+                    (unsigned long long)(Budget->HeapBudget[i] / 1024),
+                    Budget->UseBudgetExtension ? "" : " (estimated)");
+    }
+}
+
+/** Adds a handler to call when a heap goes over budget. Handlers are called
+ * in the order they were registered, so register whatever is cheapest to lose
+ * first (e.g. top mips before whole meshes). */
+static
+void RegisterEvictionHandler(vulkan_context *Context,
+                             memory_eviction_function *Evict,
+                             void *Data)
+{
+    memory_budget *Budget = &Context->Memory.Budget;
+
+    Assert(Budget->HandlerCount < MEMORY_MAX_EVICTION_HANDLERS,
+           "Too many eviction handlers.\n");
+
+    memory_eviction_handler *Handler =
+        &Budget->Handlers[Budget->HandlerCount++];
+    Handler->Evict = Evict;
+    Handler->Data = Data;
+}
+
+/** Refreshes each heap's usage and budget, and evicts from any heap that's
+ * past its high water mark. Called once a frame, from the render thread,
+ * which is where eviction handlers run. */
+static
+void UpdateMemoryBudget(vulkan_context *Context)
+{
+    memory_budget *Budget = &Context->Memory.Budget;
+    VkPhysicalDeviceMemoryProperties *Properties = &Context->MemoryProperties;
+
+    if (Budget->UseBudgetExtension)
+    {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT BudgetProperties = {};
+        BudgetProperties.sType =
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        VkPhysicalDeviceMemoryProperties2 Properties2 = {};
+        Properties2.sType =
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        Properties2.pNext = &BudgetProperties;
+
+        vkGetPhysicalDeviceMemoryProperties2(Context->PhysicalDevice,
+                                             &Properties2);
+
+        for (unsigned int i = 0; i < Properties->memoryHeapCount; i++)
+        {
+            Budget->HeapBudget[i] = BudgetProperties.heapBudget[i];
+            Budget->HeapUsage[i] = BudgetProperties.heapUsage[i];
+        }
+    }
+    else
+    {
+        // NOTE[joe] This only sees what we've allocated ourselves, not what
+        // the driver has allocated on our behalf.
+        for (unsigned int i = 0; i < Properties->memoryHeapCount; i++)
+        {
+            Budget->HeapBudget[i] = (VkDeviceSize)
+                (Properties->memoryHeaps[i].size * MEMORY_BUDGET_FALLBACK);
+            Budget->HeapUsage[i] = Context->Memory.Stats.HeapBytes[i];
+        }
+    }
+
+    for (unsigned int i = 0; i < Properties->memoryHeapCount; i++)
+    {
+        VkDeviceSize HighWater = (VkDeviceSize)
+            (Budget->HeapBudget[i] * MEMORY_BUDGET_HIGH_WATER);
+
+        if (Budget->HeapUsage[i] <= HighWater)
+        {
+            Budget->IsOverBudget[i] = false;
+            continue;
+        }
+
+        VkDeviceSize Target = (VkDeviceSize)
+            (Budget->HeapBudget[i] * MEMORY_BUDGET_TARGET);
+        VkDeviceSize Wanted = Budget->HeapUsage[i] - Target;
+
+        Budget->EvictionCount++;
+
+        // NOTE[joe] What gets freed won't show up in HeapUsage until the next
+        // update, so we go by what the handlers say they freed.
+        for (unsigned int j = 0; j < Budget->HandlerCount && Wanted; j++)
+        {
+            memory_eviction_handler *Handler = &Budget->Handlers[j];
+
+            VkDeviceSize Freed = Handler->Evict(i, Wanted, Handler->Data);
+
+            Wanted -= Freed < Wanted ? Freed : Wanted;
+        }
+
+        if (Wanted && !Budget->IsOverBudget[i])
+        {
+            PlatformLog("Memory heap %u is over budget by %llu KB, and "
+                        "there's nothing left to evict.\n",
+                        i,
+                        (unsigned long long)(Wanted / 1024));
+        }
+
+        Budget->IsOverBudget[i] = Wanted != 0;
+    }
+}
+
+/** Allocates memory for Image and binds it. */
+static
+VkDeviceMemory AllocateImageMemory(vulkan_context *Context,
+                                   VkImage Image,
+                                   VkMemoryPropertyFlags PreferredFlags,
+                                   VkMemoryPropertyFlags RequiredFlags)
+{
+    VkMemoryRequirements Requirements = {};
+    vkGetImageMemoryRequirements(Context->Device, Image, &Requirements);
+
+    VkDeviceMemory Memory = AllocateDeviceMemory(Context,
+                                                 Requirements,
+                                                 PreferredFlags,
+                                                 RequiredFlags);
+
+    VkResult Result = vkBindImageMemory(Context->Device, Image, Memory, 0);
+
+    Assert(Result == VK_SUCCESS, "Failed to bind image memory.\n");
+
+    return Memory;
+}
+
+/** Allocates memory for Buffer and binds it. */
+static
+VkDeviceMemory AllocateBufferMemory(vulkan_context *Context,
+                                    VkBuffer Buffer,
+                                    VkMemoryPropertyFlags PreferredFlags,
+                                    VkMemoryPropertyFlags RequiredFlags)
+{
+    VkMemoryRequirements Requirements = {};
+    vkGetBufferMemoryRequirements(Context->Device, Buffer, &Requirements);
+
+    VkDeviceMemory Memory = AllocateDeviceMemory(Context,
+                                                 Requirements,
+                                                 PreferredFlags,
+                                                 RequiredFlags);
+
+    VkResult Result = vkBindBufferMemory(Context->Device, Buffer, Memory, 0);
+
+    Assert(Result == VK_SUCCESS, "Failed to bind buffer memory.\n");
+
+    return Memory;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file vulkan_memory.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions we use to keep track of the device
+ * memory we've allocated.
+ */
+
+#ifndef _VULKAN_MEMORY_H_
+#define _VULKAN_MEMORY_H_
+
+#define MEMORY_MAX_ALLOCATIONS 256
+
+typedef struct {
+    VkDeviceMemory Memory;
+    VkDeviceSize   Size;
+    unsigned int   TypeIndex;
+} memory_allocation;
+
+typedef struct {
+    VkDeviceSize HeapBytes[VK_MAX_MEMORY_HEAPS];
+    unsigned int HeapAllocationCount[VK_MAX_MEMORY_HEAPS];
+} memory_stats;
+
+#define MEMORY_MAX_EVICTION_HANDLERS 16
+
+// NOTE[joe] Once a heap's usage passes HIGH_WATER of its budget we evict until
+// it's back under TARGET, so that we aren't evicting a little every frame.
+#define MEMORY_BUDGET_HIGH_WATER 0.9
+#define MEMORY_BUDGET_TARGET 0.8
+
+// NOTE[joe] Without VK_EXT_memory_budget, this much of each heap is assumed
+// to be ours. The rest is for the OS and everything else that's running.
+#define MEMORY_BUDGET_FALLBACK 0.8
+
+/** Frees up to Bytes of Heap (e.g. by dropping mips or unloading LODs) and
+ * returns how much it actually freed. */
+typedef VkDeviceSize memory_eviction_function(unsigned int Heap,
+                                              VkDeviceSize Bytes,
+                                              void *Data);
+
+typedef struct {
+    memory_eviction_function *Evict;
+    void                     *Data;
+} memory_eviction_handler;
+
+typedef struct {
+    bool                    UseBudgetExtension;
+    VkDeviceSize            HeapBudget[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize            HeapUsage[VK_MAX_MEMORY_HEAPS];
+    // NOTE[joe] Set while a heap is over budget and nothing more could be
+    // evicted, so we only complain about it once.
+    bool                    IsOverBudget[VK_MAX_MEMORY_HEAPS];
+    unsigned int            EvictionCount;
+    unsigned int            HandlerCount;
+    memory_eviction_handler Handlers[MEMORY_MAX_EVICTION_HANDLERS];
+} memory_budget;
+
+typedef struct {
+    unsigned int      AllocationCount;
+    memory_allocation Allocations[MEMORY_MAX_ALLOCATIONS];
+    memory_stats      Stats;
+    memory_budget     Budget;
+} memory_tracker;
+
+#endif
@@ -0,0 +1,416 @@
+/**
+ * @file vulkan_pipeline.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our pipeline manager. Pipelines are looked up by a hash
+ * of their pipeline_desc, and with VK_EXT_extended_dynamic_state (and 2/3)
+ * most of the fixed-function state is set while recording instead, so
+ * draws that only differ in culling or depth state share one pipeline.
+ */
+
+#include "platform.h"
+#include "render.h"
+
+/** Creates the pipeline cache. Device creation fills in which states are
+ * dynamic, and that has to happen before any pipeline is created. */
+static
+void InitializePipelineManager(vulkan_context *Context)
+{
+    pipeline_manager *Manager = &Context->Pipelines;
+
+    VkPipelineCacheCreateInfo CacheCreateInfo = {};
+    CacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+    VkResult Result =
+        vkCreatePipelineCache(Context->Device,
+                              &CacheCreateInfo,
+                              GetHostAllocator(Context, HOST_TAG_PIPELINE),
+                              &Manager->Cache);
+
+    Assert(Result == VK_SUCCESS, "Failed to create pipeline cache.\n");
+}
+
+/** Returns the first topology of the same class (points, lines, triangles or
+ * patches) as Topology. Dynamic topology can only switch within a class, so
+ * that's all the pipeline needs to know. */
+static inline
+VkPrimitiveTopology TopologyClass(VkPrimitiveTopology Topology)
+{
+    switch (Topology)
+    {
+        case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+        {
+            return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+        }
+
+        case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+        case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+        case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+        case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+        {
+            return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+        }
+
+        case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+        {
+            return VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+        }
+
+        default:
+        {
+            return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        }
+    }
+}
+
+/** Builds the key Desc is cached under, with everything that's dynamic on
+ * this device zeroed out. */
+static
+pipeline_desc MakePipelineKey(pipeline_manager *Manager,
+                              const pipeline_desc *Desc)
+{
+    unsigned int Dynamic = Manager->DynamicStates;
+
+    // NOTE[joe] memset so that padding bytes hash and compare the same.
+    pipeline_desc Key;
+    memset(&Key, 0, sizeof(Key));
+
+    Key.VertexShader = Desc->VertexShader;
+    Key.FragmentShader = Desc->FragmentShader;
+    Key.Layout = Desc->Layout;
+    Key.IsVertexPulled = Desc->IsVertexPulled;
+
+    Key.Topology = (Dynamic & PIPELINE_DYNAMIC_TOPOLOGY) ?
+                   TopologyClass(Desc->Topology) : Desc->Topology;
+
+    if (!(Dynamic & PIPELINE_DYNAMIC_PRIMITIVE_RESTART))
+        Key.PrimitiveRestartEnable = Desc->PrimitiveRestartEnable;
+    if (!(Dynamic & PIPELINE_DYNAMIC_POLYGON_MODE))
+        Key.PolygonMode = Desc->PolygonMode;
+    if (!(Dynamic & PIPELINE_DYNAMIC_CULL_MODE))
+        Key.CullMode = Desc->CullMode;
+    if (!(Dynamic & PIPELINE_DYNAMIC_FRONT_FACE))
+        Key.FrontFace = Desc->FrontFace;
+    if (!(Dynamic & PIPELINE_DYNAMIC_DEPTH_BIAS_ENABLE))
+        Key.DepthBiasEnable = Desc->DepthBiasEnable;
+    if (!(Dynamic & PIPELINE_DYNAMIC_DEPTH_TEST))
+        Key.DepthTestEnable = Desc->DepthTestEnable;
+    if (!(Dynamic & PIPELINE_DYNAMIC_DEPTH_WRITE))
+        Key.DepthWriteEnable = Desc->DepthWriteEnable;
+    if (!(Dynamic & PIPELINE_DYNAMIC_DEPTH_COMPARE))
+        Key.DepthCompareOp = Desc->DepthCompareOp;
+    if (!(Dynamic & PIPELINE_DYNAMIC_BLEND_ENABLE))
+        Key.BlendEnable = Desc->BlendEnable;
+
+    return Key;
+}
+
+/** FNV-1a over the bytes of a pipeline key. */
+static inline
+unsigned long long HashPipelineKey(const pipeline_desc *Key)
+{
+    const unsigned char *Bytes = (const unsigned char *)Key;
+    unsigned long long Hash = 14695981039346656037ULL;
+
+    for (unsigned int i = 0; i < sizeof(pipeline_desc); i++)
+    {
+        Hash ^= Bytes[i];
+        Hash *= 1099511628211ULL;
+    }
+
+    return Hash;
+}
+
+/** Creates the pipeline for Key. Anything dynamic has been zeroed out of Key
+ * and is listed in the pipeline's dynamic state instead. */
+static
+VkPipeline CreatePipeline(vulkan_context *Context, const pipeline_desc *Key)
+{
+    unsigned int Dynamic = Context->Pipelines.DynamicStates;
+
+    VkPipelineShaderStageCreateInfo ShaderStageCreateInfo[2] = {};
+
+    // Vertex shader stage
+    ShaderStageCreateInfo[0].sType =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    ShaderStageCreateInfo[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    ShaderStageCreateInfo[0].module = Key->VertexShader;
+    // NOTE[joe] Name of shader entry point.
+    ShaderStageCreateInfo[0].pName = "main";
+
+    // Fragment shader stage
+    ShaderStageCreateInfo[1].sType =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    ShaderStageCreateInfo[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    ShaderStageCreateInfo[1].module = Key->FragmentShader;
+    // NOTE[joe] Name of shader entry point.
+    ShaderStageCreateInfo[1].pName = "main";
+
+    VkVertexInputBindingDescription VertexBindingDescription = {};
+    VertexBindingDescription.stride = sizeof(vertex);
+    VertexBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    VkVertexInputAttributeDescription VertexAttributeDescription = {};
+    VertexAttributeDescription.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+
+    VkPipelineVertexInputStateCreateInfo VertexInputStateCreateInfo = {};
+    VertexInputStateCreateInfo.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    if (!Key->IsVertexPulled)
+    {
+        VertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
+        VertexInputStateCreateInfo.pVertexBindingDescriptions =
+            &VertexBindingDescription;
+        VertexInputStateCreateInfo.vertexAttributeDescriptionCount = 1;
+        VertexInputStateCreateInfo.pVertexAttributeDescriptions =
+            &VertexAttributeDescription;
+    }
+
+    VkPipelineInputAssemblyStateCreateInfo InputAssemblyStateCreateInfo = {};
+    InputAssemblyStateCreateInfo.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    InputAssemblyStateCreateInfo.topology = Key->Topology;
+    InputAssemblyStateCreateInfo.primitiveRestartEnable =
+        Key->PrimitiveRestartEnable;
+
+    // NOTE[joe] Viewport and scissor are always dynamic, so the pipeline
+    // doesn't care what size the window is.
+    VkPipelineViewportStateCreateInfo ViewportState = {};
+    ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    ViewportState.viewportCount = 1;
+    ViewportState.scissorCount = 1;
+
+    /** Rasterization configuration. */
+
+    VkPipelineRasterizationStateCreateInfo RasterizationStateCreateInfo = {};
+    RasterizationStateCreateInfo.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    RasterizationStateCreateInfo.polygonMode = Key->PolygonMode;
+    RasterizationStateCreateInfo.cullMode = Key->CullMode;
+    RasterizationStateCreateInfo.frontFace = Key->FrontFace;
+    RasterizationStateCreateInfo.depthBiasEnable = Key->DepthBiasEnable;
+    RasterizationStateCreateInfo.lineWidth = 1;
+
+    /** Sampling configuration. */
+
+    VkPipelineMultisampleStateCreateInfo MultisampleStateCreatInfo = {};
+    MultisampleStateCreatInfo.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    MultisampleStateCreatInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    /** Depth testing, stenciling disabled. */
+
+    VkStencilOpState NoOpStencilState = {};
+    NoOpStencilState.failOp = VK_STENCIL_OP_KEEP;
+    NoOpStencilState.passOp = VK_STENCIL_OP_KEEP;
+    NoOpStencilState.depthFailOp = VK_STENCIL_OP_KEEP;
+    NoOpStencilState.compareOp = VK_COMPARE_OP_ALWAYS;
+
+    VkPipelineDepthStencilStateCreateInfo DepthStateCreateInfo = {};
+    DepthStateCreateInfo.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    DepthStateCreateInfo.depthTestEnable = Key->DepthTestEnable;
+    DepthStateCreateInfo.depthWriteEnable = Key->DepthWriteEnable;
+    DepthStateCreateInfo.depthCompareOp = Key->DepthCompareOp;
+    DepthStateCreateInfo.front = NoOpStencilState;
+    DepthStateCreateInfo.back = NoOpStencilState;
+
+    /** Color blending. */
+
+    VkPipelineColorBlendAttachmentState ColorBlendAttachmentState = {};
+    ColorBlendAttachmentState.blendEnable = Key->BlendEnable;
+    ColorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_COLOR;
+    ColorBlendAttachmentState.dstColorBlendFactor =
+        VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR;
+    ColorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+    ColorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+    ColorBlendAttachmentState.colorWriteMask = 0xf;
+
+    VkPipelineColorBlendStateCreateInfo ColorBlendStateCreateInfo = {};
+    ColorBlendStateCreateInfo.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    ColorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_CLEAR;
+    ColorBlendStateCreateInfo.attachmentCount = 1;
+    ColorBlendStateCreateInfo.pAttachments = &ColorBlendAttachmentState;
+
+    /** List the state we'll set while recording. */
+
+    VkDynamicState DynamicStates[12];
+    unsigned int DynamicStateCount = 0;
+
+    DynamicStates[DynamicStateCount++] = VK_DYNAMIC_STATE_VIEWPORT;
+    DynamicStates[DynamicStateCount++] = VK_DYNAMIC_STATE_SCISSOR;
+
+    if (Dynamic & PIPELINE_DYNAMIC_CULL_MODE)
+        DynamicStates[DynamicStateCount++] = VK_DYNAMIC_STATE_CULL_MODE_EXT;
+    if (Dynamic & PIPELINE_DYNAMIC_FRONT_FACE)
+        DynamicStates[DynamicStateCount++] = VK_DYNAMIC_STATE_FRONT_FACE_EXT;
+    if (Dynamic & PIPELINE_DYNAMIC_TOPOLOGY)
+        DynamicStates[DynamicStateCount++] =
+            VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT;
+    if (Dynamic & PIPELINE_DYNAMIC_DEPTH_TEST)
+        DynamicStates[DynamicStateCount++] =
+            VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT;
+    if (Dynamic & PIPELINE_DYNAMIC_DEPTH_WRITE)
+        DynamicStates[DynamicStateCount++] =
+            VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT;
+    if (Dynamic & PIPELINE_DYNAMIC_DEPTH_COMPARE)
+        DynamicStates[DynamicStateCount++] =
+            VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT;
+    if (Dynamic & PIPELINE_DYNAMIC_DEPTH_BIAS_ENABLE)
+        DynamicStates[DynamicStateCount++] =
+            VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT;
+    if (Dynamic & PIPELINE_DYNAMIC_PRIMITIVE_RESTART)
+        DynamicStates[DynamicStateCount++] =
+            VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT;
+    if (Dynamic & PIPELINE_DYNAMIC_POLYGON_MODE)
+        DynamicStates[DynamicStateCount++] = VK_DYNAMIC_STATE_POLYGON_MODE_EXT;
+    if (Dynamic & PIPELINE_DYNAMIC_BLEND_ENABLE)
+        DynamicStates[DynamicStateCount++] =
+            VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT;
+
+    VkPipelineDynamicStateCreateInfo DynamicStateCreateInfo = {};
+    DynamicStateCreateInfo.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    DynamicStateCreateInfo.dynamicStateCount = DynamicStateCount;
+    DynamicStateCreateInfo.pDynamicStates = DynamicStates;
+
+    /** Create the graphics pipeline */
+
+    VkGraphicsPipelineCreateInfo PipelineCreateInfo = {};
+    PipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    PipelineCreateInfo.stageCount = 2;
+    PipelineCreateInfo.pStages = ShaderStageCreateInfo;
+    PipelineCreateInfo.pVertexInputState = &VertexInputStateCreateInfo;
+    PipelineCreateInfo.pInputAssemblyState = &InputAssemblyStateCreateInfo;
+    PipelineCreateInfo.pViewportState = &ViewportState;
+    PipelineCreateInfo.pRasterizationState = &RasterizationStateCreateInfo;
+    PipelineCreateInfo.pMultisampleState = &MultisampleStateCreatInfo;
+    PipelineCreateInfo.pDepthStencilState = &DepthStateCreateInfo;
+    PipelineCreateInfo.pColorBlendState = &ColorBlendStateCreateInfo;
+    PipelineCreateInfo.pDynamicState = &DynamicStateCreateInfo;
+    PipelineCreateInfo.layout =
+        Key->Layout ? Key->Layout : Context->PipelineLayout;
+
+    // NOTE[joe] With dynamic rendering the pipeline only needs to know the
+    // attachment formats, not a render pass object.
+    VkPipelineRenderingCreateInfoKHR RenderingCreateInfo = {};
+    RenderingCreateInfo.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    RenderingCreateInfo.colorAttachmentCount = 1;
+    RenderingCreateInfo.pColorAttachmentFormats = &Context->ColorFormat;
+    RenderingCreateInfo.depthAttachmentFormat = Context->DepthFormat;
+
+    if (Context->DepthAspect & VK_IMAGE_ASPECT_STENCIL_BIT)
+    {
+        RenderingCreateInfo.stencilAttachmentFormat = Context->DepthFormat;
+    }
+
+    if (Context->UseDynamicRendering)
+    {
+        PipelineCreateInfo.pNext = &RenderingCreateInfo;
+    }
+    else
+    {
+        PipelineCreateInfo.renderPass = Context->RenderPass;
+    }
+
+    VkPipeline Pipeline = VK_NULL_HANDLE;
+    VkResult Result =
+        vkCreateGraphicsPipelines(Context->Device,
+                                  Context->Pipelines.Cache,
+                                  1,
+                                  &PipelineCreateInfo,
+                                  GetHostAllocator(Context, HOST_TAG_PIPELINE),
+                                  &Pipeline);
+
+    Assert(Result == VK_SUCCESS, "Failed to create graphics pipeline.\n");
+
+    return Pipeline;
+}
+
+/** Returns the pipeline for Desc, creating it the first time we see its
+ * key. */
+static
+VkPipeline GetPipeline(vulkan_context *Context, const pipeline_desc *Desc)
+{
+    pipeline_manager *Manager = &Context->Pipelines;
+
+    pipeline_desc Key = MakePipelineKey(Manager, Desc);
+    unsigned long long Hash = HashPipelineKey(&Key);
+
+    Manager->RequestCount++;
+
+    unsigned int Mask = PIPELINE_MAX_PIPELINES - 1;
+    unsigned int Slot = (unsigned int)Hash & Mask;
+
+    // NOTE[joe] Linear probing. Pipelines are never evicted, so the first
+    // empty slot means the key isn't in here.
+    while (Manager->Entries[Slot].Pipeline != VK_NULL_HANDLE)
+    {
+        pipeline_entry *Entry = &Manager->Entries[Slot];
+
+        if (Entry->Hash == Hash &&
+            memcmp(&Entry->Key, &Key, sizeof(Key)) == 0)
+        {
+            return Entry->Pipeline;
+        }
+
+        Slot = (Slot + 1) & Mask;
+    }
+
+    Assert(Manager->EntryCount < PIPELINE_MAX_PIPELINES - 1,
+           "Too many pipelines.\n");
+
+    pipeline_entry *Entry = &Manager->Entries[Slot];
+    Entry->Hash = Hash;
+    Entry->Key = Key;
+    Entry->Pipeline = CreatePipeline(Context, &Key);
+
+    Manager->EntryCount++;
+    Manager->CreatedCount++;
+
+    return Entry->Pipeline;
+}
+
+/** Binds the pipeline for Desc, then sets whatever state was left out of it
+ * on this device. */
+static
+void BindPipeline(vulkan_context *Context,
+                  VkCommandBuffer CommandBuffer,
+                  const pipeline_desc *Desc)
+{
+    unsigned int Dynamic = Context->Pipelines.DynamicStates;
+
+    vkCmdBindPipeline(CommandBuffer,
+                      VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      GetPipeline(Context, Desc));
+
+    if (Dynamic & PIPELINE_DYNAMIC_CULL_MODE)
+        vkCmdSetCullModeEXT(CommandBuffer, Desc->CullMode);
+    if (Dynamic & PIPELINE_DYNAMIC_FRONT_FACE)
+        vkCmdSetFrontFaceEXT(CommandBuffer, Desc->FrontFace);
+    if (Dynamic & PIPELINE_DYNAMIC_TOPOLOGY)
+        vkCmdSetPrimitiveTopologyEXT(CommandBuffer, Desc->Topology);
+    if (Dynamic & PIPELINE_DYNAMIC_DEPTH_TEST)
+        vkCmdSetDepthTestEnableEXT(CommandBuffer, Desc->DepthTestEnable);
+    if (Dynamic & PIPELINE_DYNAMIC_DEPTH_WRITE)
+        vkCmdSetDepthWriteEnableEXT(CommandBuffer, Desc->DepthWriteEnable);
+    if (Dynamic & PIPELINE_DYNAMIC_DEPTH_COMPARE)
+        vkCmdSetDepthCompareOpEXT(CommandBuffer, Desc->DepthCompareOp);
+    if (Dynamic & PIPELINE_DYNAMIC_DEPTH_BIAS_ENABLE)
+        vkCmdSetDepthBiasEnableEXT(CommandBuffer, Desc->DepthBiasEnable);
+    if (Dynamic & PIPELINE_DYNAMIC_PRIMITIVE_RESTART)
+        vkCmdSetPrimitiveRestartEnableEXT(CommandBuffer,
+                                          Desc->PrimitiveRestartEnable);
+    if (Dynamic & PIPELINE_DYNAMIC_POLYGON_MODE)
+        vkCmdSetPolygonModeEXT(CommandBuffer, Desc->PolygonMode);
+
+    if (Dynamic & PIPELINE_DYNAMIC_BLEND_ENABLE)
+    {
+        VkBool32 BlendEnable = Desc->BlendEnable;
+        vkCmdSetColorBlendEnableEXT(CommandBuffer, 0, 1, &BlendEnable);
+    }
+}
@@ -0,0 +1,90 @@
+/**
+ * @file vulkan_pipeline.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for our pipeline manager. Rendering code
+ * describes the state it wants to draw with, and the manager hands back a
+ * pipeline for it, only creating one when it hasn't seen the combination
+ * before. Any state the device lets us set while recording is left out of
+ * that combination entirely.
+ */
+
+#ifndef _VULKAN_PIPELINE_H_
+#define _VULKAN_PIPELINE_H_
+
+// NOTE[joe] Must be a power of two, since the cache is an open hash table.
+#define PIPELINE_MAX_PIPELINES 256
+
+/** Pipeline state that the device can let us set at record time instead of
+ * baking into the pipeline. */
+typedef enum {
+    PIPELINE_DYNAMIC_CULL_MODE           = 1 << 0,
+    PIPELINE_DYNAMIC_FRONT_FACE          = 1 << 1,
+    PIPELINE_DYNAMIC_TOPOLOGY            = 1 << 2,
+    PIPELINE_DYNAMIC_DEPTH_TEST          = 1 << 3,
+    PIPELINE_DYNAMIC_DEPTH_WRITE         = 1 << 4,
+    PIPELINE_DYNAMIC_DEPTH_COMPARE       = 1 << 5,
+    // VK_EXT_extended_dynamic_state2
+    PIPELINE_DYNAMIC_DEPTH_BIAS_ENABLE   = 1 << 6,
+    PIPELINE_DYNAMIC_PRIMITIVE_RESTART   = 1 << 7,
+    // VK_EXT_extended_dynamic_state3, which reports these one by one.
+    PIPELINE_DYNAMIC_POLYGON_MODE        = 1 << 8,
+    PIPELINE_DYNAMIC_BLEND_ENABLE        = 1 << 9,
+} pipeline_dynamic_state;
+
+#define PIPELINE_DYNAMIC_STATE_1 (PIPELINE_DYNAMIC_CULL_MODE |     \
+                                  PIPELINE_DYNAMIC_FRONT_FACE |    \
+                                  PIPELINE_DYNAMIC_TOPOLOGY |      \
+                                  PIPELINE_DYNAMIC_DEPTH_TEST |    \
+                                  PIPELINE_DYNAMIC_DEPTH_WRITE |   \
+                                  PIPELINE_DYNAMIC_DEPTH_COMPARE)
+
+#define PIPELINE_DYNAMIC_STATE_2 (PIPELINE_DYNAMIC_DEPTH_BIAS_ENABLE | \
+                                  PIPELINE_DYNAMIC_PRIMITIVE_RESTART)
+
+/** Everything that goes into drawing with a graphics pipeline. The vertex
+ * layout and attachment formats are the same for every pipeline for now, so
+ * they live in the manager rather than in here. */
+typedef struct {
+    VkShaderModule      VertexShader;
+    VkShaderModule      FragmentShader;
+    // NOTE[joe] Zero means the context's PipelineLayout.
+    VkPipelineLayout    Layout;
+    // NOTE[joe] Set when the vertex shader fetches its own vertices from
+    // storage buffers, and so takes no vertex input at all.
+    bool                IsVertexPulled;
+    VkPrimitiveTopology Topology;
+    bool                PrimitiveRestartEnable;
+    VkPolygonMode       PolygonMode;
+    VkCullModeFlags     CullMode;
+    VkFrontFace         FrontFace;
+    bool                DepthBiasEnable;
+    bool                DepthTestEnable;
+    bool                DepthWriteEnable;
+    VkCompareOp         DepthCompareOp;
+    bool                BlendEnable;
+} pipeline_desc;
+
+typedef struct {
+    unsigned long long Hash;
+    pipeline_desc      Key;
+    VkPipeline         Pipeline;
+} pipeline_entry;
+
+typedef struct {
+    // NOTE[joe] Which pipeline_dynamic_state bits the device supports. These
+    // are zeroed out of a pipeline_desc before it gets hashed.
+    unsigned int    DynamicStates;
+    VkPipelineCache Cache;
+
+    unsigned int    EntryCount;
+    pipeline_entry  Entries[PIPELINE_MAX_PIPELINES];
+
+    // NOTE[joe] CreatedCount is the number of distinct pipelines; a high
+    // RequestCount against a low CreatedCount is the whole point.
+    unsigned int    CreatedCount;
+    unsigned int    RequestCount;
+} pipeline_manager;
+
+#endif
@@ -0,0 +1,975 @@
+/**
+ * @file vulkan_setup.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the parts of our Vulkan setup that don't care which
+ * platform we're on. A platform layer loads the Vulkan library, calls
+ * CreateVulkanInstance() with its surface extension, creates its surface and
+ * then hands over to InitializeVulkanDevice() for everything else.
+ */
+
+#include "platform.h"
+#include "render.h"
+#include "memory.h"
+
+#ifdef DEBUG
+// NOTE[joe] Newer SDKs only ship the Khronos layer and older ones only the
+// LunarG one, so take whichever we find first.
+static const char *ValidationLayerCandidates[] = {
+    "VK_LAYER_KHRONOS_validation",
+    "VK_LAYER_LUNARG_standard_validation"
+};
+
+static const char *ValidationLayer;
+#endif
+
+/** Our debug callback for Vulkan. */
+static
+VKAPI_ATTR VkBool32 VKAPI_CALL VulkanDebugReportCallback(
+    VkDebugReportFlagsEXT Flags,
+    VkDebugReportObjectTypeEXT ObjectType,
+    uint64_t Object,
+    size_t Location,
+    int32_t MessageCode,
+    const char* LayerPrefix,
+    const char* Message,
+    void* UserData)
+{
+    PlatformLog("%s\n\t%s\n", LayerPrefix, Message);
+
+    return VK_FALSE;
+}
+
+/** Returns true if Name is in the list of Available extensions. */
+static
+bool IsExtensionAvailable(const VkExtensionProperties *Available,
+                          unsigned int AvailableCount,
+                          const char *Name)
+{
+    for (unsigned int i = 0; i < AvailableCount; i++)
+    {
+        if (strcmp(Available[i].extensionName, Name) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+/** Creates the Vulkan instance with SurfaceExtension (the platform's
+ * VK_KHR_*_surface, or VK_EXT_headless_surface) enabled, and loads the
+ * instance functions. The platform layer has to have loaded the global
+ * functions first. Scratch comes from Memory->Frame. */
+static
+void CreateVulkanInstance(vulkan_context *Context,
+                          game_memory *Memory,
+                          const char *SurfaceExtension)
+{
+    arena_temp Scratch = BeginArenaTemp(&Memory->Frame);
+
+    // NOTE[joe] Everything the driver allocates goes through this, starting
+    // with the instance.
+    InitializeHostAllocator(&Context->HostAllocator);
+
+    /** Find number of layers and extensions. */
+
+#ifdef DEBUG
+    unsigned int TotalLayerCount = 0;
+    vkEnumerateInstanceLayerProperties(&TotalLayerCount, 0);
+
+    VkLayerProperties *AvailableLayers =
+        PushArray(&Memory->Frame, VkLayerProperties, TotalLayerCount);
+    vkEnumerateInstanceLayerProperties(&TotalLayerCount,
+                                       AvailableLayers);
+
+    unsigned int CandidateCount =
+        sizeof(ValidationLayerCandidates)/sizeof(char *);
+
+    for (unsigned int i = 0; i < CandidateCount && !ValidationLayer; i++)
+    {
+        for (unsigned int j = 0; j < TotalLayerCount; j++)
+        {
+            if (strcmp(AvailableLayers[j].layerName,
+                       ValidationLayerCandidates[i]) == 0)
+            {
+                ValidationLayer = ValidationLayerCandidates[i];
+                break;
+            }
+        }
+    }
+
+    Assert(ValidationLayer != 0, "Could not find validation layer.\n");
+#endif
+
+#ifndef DEBUG
+    const char *Extensions[] = { "VK_KHR_surface",
+                                 SurfaceExtension };
+#else
+    const char *Extensions[] = { "VK_KHR_surface",
+                                 SurfaceExtension,
+                                 "VK_EXT_debug_report" };
+#endif
+    unsigned int ExpectedExtensionCount = sizeof(Extensions)/sizeof(char *);
+
+    unsigned int VulkanExtensionCount = 0;
+    vkEnumerateInstanceExtensionProperties(NULL,
+                                           &VulkanExtensionCount,
+                                           NULL);
+
+    VkExtensionProperties *AvailableExtensions =
+        PushArray(&Memory->Frame, VkExtensionProperties, VulkanExtensionCount);
+    vkEnumerateInstanceExtensionProperties(NULL,
+                                           &VulkanExtensionCount,
+                                           AvailableExtensions);
+
+    unsigned int FoundExtensions = 0;
+    for (unsigned int j = 0; j < ExpectedExtensionCount; j++)
+    {
+        if (IsExtensionAvailable(AvailableExtensions,
+                                 VulkanExtensionCount,
+                                 Extensions[j]))
+        {
+            FoundExtensions++;
+        }
+        else
+        {
+            PlatformLog("Missing Vulkan extension %s.\n", Extensions[j]);
+        }
+    }
+
+    Assert(FoundExtensions == ExpectedExtensionCount,
+           "Failed to find all Vulkan extensions.");
+
+    /** Create Vulkan instance. */
+
+    VkApplicationInfo ApplicationInfo = {};
+    ApplicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    ApplicationInfo.pApplicationName = "Full Metal Jacket";
+    ApplicationInfo.engineVersion = 1;
+    ApplicationInfo.apiVersion = VK_MAKE_VERSION(1, 0, 0);
+
+    // NOTE[joe] Ask for 1.1 when the loader has it. Newer device extensions
+    // (like dynamic rendering) lean on what got promoted into 1.1.
+    if (vkEnumerateInstanceVersion)
+    {
+        unsigned int InstanceVersion = VK_MAKE_VERSION(1, 0, 0);
+        vkEnumerateInstanceVersion(&InstanceVersion);
+
+        if (InstanceVersion >= VK_MAKE_VERSION(1, 1, 0))
+        {
+            ApplicationInfo.apiVersion = VK_MAKE_VERSION(1, 1, 0);
+        }
+    }
+
+    Context->ApiVersion = ApplicationInfo.apiVersion;
+
+    VkInstanceCreateInfo InstanceInfo = {};
+    InstanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    InstanceInfo.pApplicationInfo = &ApplicationInfo;
+#ifdef DEBUG
+    InstanceInfo.enabledLayerCount = 1;
+    InstanceInfo.ppEnabledLayerNames = &ValidationLayer;
+#endif
+    InstanceInfo.enabledExtensionCount = ExpectedExtensionCount;
+    InstanceInfo.ppEnabledExtensionNames = Extensions;
+
+    const VkAllocationCallbacks *Allocator =
+        GetHostAllocator(Context, HOST_TAG_INSTANCE);
+
+    VkResult Result = vkCreateInstance(&InstanceInfo,
+                                       Allocator,
+                                       &Context->Instance);
+
+    Assert(Result == VK_SUCCESS, "Failed to create Vulkan instance.\n");
+
+    /** Load instance functions. */
+
+    unsigned int InstanceGroups = 0;
+
+    if (Context->ApiVersion >= VK_MAKE_VERSION(1, 1, 0))
+        InstanceGroups |= VULKAN_FUNCTIONS_INSTANCE_1_1;
+#ifdef DEBUG
+    InstanceGroups |= VULKAN_FUNCTIONS_DEBUG_REPORT;
+#endif
+
+    unsigned int Missing = LoadVulkanInstanceFunctions(Context->Instance,
+                                                       InstanceGroups);
+
+    Assert(Missing == 0, "Missing instance Vulkan functions.\n");
+
+    /** Create Vulkan debug callback. */
+#ifdef DEBUG
+    VkDebugReportCallbackCreateInfoEXT CallbackCreateInfo = {};
+    CallbackCreateInfo.sType =
+        VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
+    CallbackCreateInfo.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT |
+                               VK_DEBUG_REPORT_WARNING_BIT_EXT |
+                               VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT;
+    CallbackCreateInfo.pfnCallback = &VulkanDebugReportCallback;
+
+    Result = vkCreateDebugReportCallbackEXT(Context->Instance,
+                                            &CallbackCreateInfo,
+                                            Allocator,
+                                            &Context->Callback);
+
+    Assert(Result == VK_SUCCESS, "Failed to create debug report callback.\n");
+#endif
+
+    EndArenaTemp(Scratch);
+}
+
+/** Picks a physical device that can present to Context->Surface and sets up
+ * everything else we need to render: the logical device, swapchain,
+ * attachments and our triangle. Context->Surface has to exist already.
+ * Whatever the context keeps comes from Memory->Permanent. */
+static
+void InitializeVulkanDevice(vulkan_context *Context, game_memory *Memory)
+{
+    arena_temp Scratch = BeginArenaTemp(&Memory->Frame);
+
+    VkResult Result;
+
+    /** Get physical display device. */
+
+    unsigned int PhysicalDeviceCount = 0;
+    vkEnumeratePhysicalDevices(Context->Instance,
+                               &PhysicalDeviceCount,
+                               0);
+    VkPhysicalDevice *PhysicalDevices =
+        PushArray(&Memory->Frame, VkPhysicalDevice, PhysicalDeviceCount);
+    vkEnumeratePhysicalDevices(Context->Instance,
+                               &PhysicalDeviceCount,
+                               PhysicalDevices);
+
+    for (unsigned int i = 0; i < PhysicalDeviceCount; i++)
+    {
+        VkPhysicalDeviceProperties DeviceProps = {};
+        vkGetPhysicalDeviceProperties(PhysicalDevices[i],
+                                      &DeviceProps);
+
+        unsigned int QueueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevices[i],
+                                                 &QueueFamilyCount,
+                                                 0);
+
+        VkQueueFamilyProperties *QueueFamilyProperties =
+            PushArray(&Memory->Frame,
+                      VkQueueFamilyProperties,
+                      QueueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevices[i],
+                                                 &QueueFamilyCount,
+                                                 QueueFamilyProperties);
+
+        for (unsigned int j = 0; j < QueueFamilyCount; j++)
+        {
+            VkBool32 SupportsPresent;
+            vkGetPhysicalDeviceSurfaceSupportKHR(PhysicalDevices[i],
+                                                 j,
+                                                 Context->Surface,
+                                                 &SupportsPresent);
+
+            if (SupportsPresent &&
+                (QueueFamilyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+            {
+                Context->PhysicalDevice = PhysicalDevices[i];
+                Context->PhysicalDeviceProperties = DeviceProps;
+                Context->PresentQueueIndex = j;
+
+                break;
+            }
+        }
+
+        if (Context->PhysicalDevice)
+            break;
+    }
+
+    // TODO[joe] This is a big issue. Should we abort in release mode?
+    Assert(Context->PhysicalDevice, "No physical device detected.\n");
+
+    /** Get physical device memory. */
+
+    vkGetPhysicalDeviceMemoryProperties(Context->PhysicalDevice,
+                                        &Context->MemoryProperties);
+
+    /** Create logical display device. */
+
+    VkDeviceQueueCreateInfo QueueCreateInfo = {};
+    QueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    QueueCreateInfo.queueFamilyIndex = Context->PresentQueueIndex;
+    QueueCreateInfo.queueCount = 1;
+
+    // NOTE[joe] Queue priority range is [0, 1].
+    float QueuePriorities[] = { 1.0f };
+    QueueCreateInfo.pQueuePriorities = QueuePriorities;
+
+    VkDeviceCreateInfo DeviceInfo = {};
+    DeviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    DeviceInfo.queueCreateInfoCount = 1;
+    DeviceInfo.pQueueCreateInfos = &QueueCreateInfo;
+#ifdef DEBUG
+    DeviceInfo.enabledLayerCount = 1;
+    DeviceInfo.ppEnabledLayerNames = &ValidationLayer;
+#endif
+
+    /** Pick device extensions. */
+
+    unsigned int DeviceExtensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(Context->PhysicalDevice,
+                                         0,
+                                         &DeviceExtensionCount,
+                                         0);
+
+    VkExtensionProperties *AvailableDeviceExtensions =
+        PushArray(&Memory->Frame, VkExtensionProperties, DeviceExtensionCount);
+    vkEnumerateDeviceExtensionProperties(Context->PhysicalDevice,
+                                         0,
+                                         &DeviceExtensionCount,
+                                         AvailableDeviceExtensions);
+
+    // NOTE[joe] Load swapchain extension so that we can do buffering.
+    const char *DeviceExtensions[16] = { "VK_KHR_swapchain" };
+    unsigned int EnabledDeviceExtensionCount = 1;
+
+    /** Use dynamic rendering when the device has it, so we can render
+     * straight into image views without render pass and framebuffer
+     * objects. */
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR DynamicRenderingFeatures = {};
+    DynamicRenderingFeatures.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    DynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+
+    // NOTE[joe] The dependencies we don't list here are core in 1.1.
+    const char *DynamicRenderingExtensions[] = {
+        "VK_KHR_create_renderpass2",
+        "VK_KHR_depth_stencil_resolve",
+        VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME
+    };
+
+    Context->UseDynamicRendering =
+        Context->ApiVersion >= VK_MAKE_VERSION(1, 1, 0) &&
+        Context->PhysicalDeviceProperties.apiVersion >=
+            VK_MAKE_VERSION(1, 1, 0);
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        Context->UseDynamicRendering =
+            Context->UseDynamicRendering &&
+            IsExtensionAvailable(AvailableDeviceExtensions,
+                                 DeviceExtensionCount,
+                                 DynamicRenderingExtensions[i]);
+    }
+
+    // NOTE[joe] Each feature struct we enable gets pushed onto the front of
+    // this chain.
+    void *DeviceFeatures = 0;
+
+    if (Context->UseDynamicRendering)
+    {
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            DeviceExtensions[EnabledDeviceExtensionCount++] =
+                DynamicRenderingExtensions[i];
+        }
+
+        DynamicRenderingFeatures.pNext = DeviceFeatures;
+        DeviceFeatures = &DynamicRenderingFeatures;
+    }
+
+    /** Use extended dynamic state where we can, so that culling, depth and
+     * topology don't each need their own pipeline. */
+
+    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT DynamicStateFeatures = {};
+    DynamicStateFeatures.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+
+    VkPhysicalDeviceExtendedDynamicState2FeaturesEXT DynamicState2Features = {};
+    DynamicState2Features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT DynamicState3Features = {};
+    DynamicState3Features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+
+    bool HasDynamicState[3] = {
+        IsExtensionAvailable(AvailableDeviceExtensions,
+                             DeviceExtensionCount,
+                             VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME),
+        IsExtensionAvailable(AvailableDeviceExtensions,
+                             DeviceExtensionCount,
+                             VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME),
+        IsExtensionAvailable(AvailableDeviceExtensions,
+                             DeviceExtensionCount,
+                             VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME),
+    };
+
+    // NOTE[joe] Same 1.1 requirement as dynamic rendering, since we need
+    // vkGetPhysicalDeviceFeatures2() to find out what's actually supported.
+    bool CanQueryFeatures =
+        vkGetPhysicalDeviceFeatures2 &&
+        Context->ApiVersion >= VK_MAKE_VERSION(1, 1, 0) &&
+        Context->PhysicalDeviceProperties.apiVersion >=
+            VK_MAKE_VERSION(1, 1, 0);
+
+    if (CanQueryFeatures && HasDynamicState[0])
+    {
+        VkPhysicalDeviceFeatures2 Features = {};
+        Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        Features.pNext = &DynamicStateFeatures;
+        DynamicStateFeatures.pNext =
+            HasDynamicState[1] ? &DynamicState2Features : 0;
+        DynamicState2Features.pNext =
+            HasDynamicState[2] ? &DynamicState3Features : 0;
+
+        vkGetPhysicalDeviceFeatures2(Context->PhysicalDevice, &Features);
+
+        unsigned int DynamicStates = 0;
+
+        if (DynamicStateFeatures.extendedDynamicState)
+        {
+            DynamicStates |= PIPELINE_DYNAMIC_STATE_1;
+
+            DeviceExtensions[EnabledDeviceExtensionCount++] =
+                VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME;
+
+            DynamicStateFeatures.pNext = DeviceFeatures;
+            DeviceFeatures = &DynamicStateFeatures;
+        }
+
+        // NOTE[joe] We don't use the logic op or patch control point parts,
+        // so don't turn them on.
+        DynamicState2Features.extendedDynamicState2LogicOp = VK_FALSE;
+        DynamicState2Features.extendedDynamicState2PatchControlPoints =
+            VK_FALSE;
+
+        if (DynamicStates && DynamicState2Features.extendedDynamicState2)
+        {
+            DynamicStates |= PIPELINE_DYNAMIC_STATE_2;
+
+            DeviceExtensions[EnabledDeviceExtensionCount++] =
+                VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME;
+
+            DynamicState2Features.pNext = DeviceFeatures;
+            DeviceFeatures = &DynamicState2Features;
+        }
+
+        // NOTE[joe] State 3 is a grab bag where every state is its own
+        // feature, so only keep the two we use.
+        VkBool32 PolygonMode =
+            DynamicState3Features.extendedDynamicState3PolygonMode;
+        VkBool32 ColorBlendEnable =
+            DynamicState3Features.extendedDynamicState3ColorBlendEnable;
+
+        DynamicState3Features = {};
+        DynamicState3Features.sType =
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+        DynamicState3Features.extendedDynamicState3PolygonMode = PolygonMode;
+        DynamicState3Features.extendedDynamicState3ColorBlendEnable =
+            ColorBlendEnable;
+
+        if (DynamicStates && (PolygonMode || ColorBlendEnable))
+        {
+            if (PolygonMode)
+                DynamicStates |= PIPELINE_DYNAMIC_POLYGON_MODE;
+            if (ColorBlendEnable)
+                DynamicStates |= PIPELINE_DYNAMIC_BLEND_ENABLE;
+
+            DeviceExtensions[EnabledDeviceExtensionCount++] =
+                VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME;
+
+            DynamicState3Features.pNext = DeviceFeatures;
+            DeviceFeatures = &DynamicState3Features;
+        }
+
+        Context->Pipelines.DynamicStates = DynamicStates;
+    }
+
+    /** Let the driver tell us how much of each heap we can use, when it
+     * can. */
+
+    Context->Memory.Budget.UseBudgetExtension =
+        CanQueryFeatures &&
+        vkGetPhysicalDeviceMemoryProperties2 &&
+        IsExtensionAvailable(AvailableDeviceExtensions,
+                             DeviceExtensionCount,
+                             VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    if (Context->Memory.Budget.UseBudgetExtension)
+    {
+        DeviceExtensions[EnabledDeviceExtensionCount++] =
+            VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+    }
+
+    DeviceInfo.pNext = DeviceFeatures;
+
+    DeviceInfo.enabledExtensionCount = EnabledDeviceExtensionCount;
+    DeviceInfo.ppEnabledExtensionNames = DeviceExtensions;
+
+    Result = vkCreateDevice(Context->PhysicalDevice,
+                            &DeviceInfo,
+                            GetHostAllocator(Context, HOST_TAG_INSTANCE),
+                            &Context->Device);
+
+    Assert(Result == VK_SUCCESS, "Failed to create logical device.\n");
+
+    /** Load device functions straight from the driver. */
+
+    unsigned int DynamicStates = Context->Pipelines.DynamicStates;
+    unsigned int DeviceGroups = 0;
+
+    if (Context->UseDynamicRendering)
+        DeviceGroups |= VULKAN_FUNCTIONS_DYNAMIC_RENDERING;
+    if (DynamicStates & PIPELINE_DYNAMIC_STATE_1)
+        DeviceGroups |= VULKAN_FUNCTIONS_DYNAMIC_STATE;
+    if (DynamicStates & PIPELINE_DYNAMIC_STATE_2)
+        DeviceGroups |= VULKAN_FUNCTIONS_DYNAMIC_STATE_2;
+    if (DynamicStates & (PIPELINE_DYNAMIC_POLYGON_MODE |
+                         PIPELINE_DYNAMIC_BLEND_ENABLE))
+        DeviceGroups |= VULKAN_FUNCTIONS_DYNAMIC_STATE_3;
+
+    unsigned int Missing = LoadVulkanDeviceFunctions(Context->Device,
+                                                     DeviceGroups);
+
+    Assert(Missing == 0, "Missing device Vulkan functions.\n");
+
+    // Get the present queue for the device we just created and store it.
+    vkGetDeviceQueue(Context->Device,
+                     Context->PresentQueueIndex,
+                     0,
+                     &Context->PresentQueue);
+
+    /** Get our surface's preferred pixel format and colorspace. */
+
+    unsigned int SurfaceFormatCount = 0;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(Context->PhysicalDevice,
+                                         Context->Surface,
+                                         &SurfaceFormatCount,
+                                         0);
+
+    VkSurfaceFormatKHR *SurfaceFormats =
+        PushArray(&Memory->Frame, VkSurfaceFormatKHR, SurfaceFormatCount);
+    vkGetPhysicalDeviceSurfaceFormatsKHR(Context->PhysicalDevice,
+                                         Context->Surface,
+                                         &SurfaceFormatCount,
+                                         SurfaceFormats);
+
+    VkFormat ColorFormat;
+    // NOTE[joe] If the format list includes VK_FORMAT_UNDEFINED, we can choose.
+    if (SurfaceFormatCount == 1 &&
+        SurfaceFormats[0].format == VK_FORMAT_UNDEFINED)
+    {
+        // And we choose the most intuitive one.
+        ColorFormat = VK_FORMAT_B8G8R8_UNORM;
+    }
+    else
+    {
+        // Otherwise, we pick the first format returned to us.
+        ColorFormat = SurfaceFormats[0].format;
+    }
+
+    VkColorSpaceKHR ColorSpace;
+    ColorSpace = SurfaceFormats[0].colorSpace;
+
+    /** Retrieve surface capabilities (i.e. how many buffers it can support). */
+
+    VkSurfaceCapabilitiesKHR SurfaceCapabilities = {};
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(Context->PhysicalDevice,
+                                              Context->Surface,
+                                              &SurfaceCapabilities);
+
+    // NOTE[joe] We want double buffering, so we'll query for that.
+    unsigned int DesiredImageCount = 2;
+    // Is this even possible??? Seems ridiculous to think that we could end up
+    // in a situation where we'll be asking for too _few_ images.
+    if (DesiredImageCount < SurfaceCapabilities.minImageCount)
+    {
+        DesiredImageCount = SurfaceCapabilities.minImageCount;
+    }
+    else if (SurfaceCapabilities.maxImageCount != 0 &&
+             DesiredImageCount > SurfaceCapabilities.maxImageCount)
+    {
+        DesiredImageCount = SurfaceCapabilities.maxImageCount;
+    }
+    else
+    {
+        // TODO[joe] Error reporting or abort.
+        // If we get back a maxImageCount of 0, we should assume that something
+        // is horribly wrong and exit as soon as possible.
+    }
+
+    /** Retrieve surface resolution (or set it if undefined). */
+
+    VkExtent2D SurfaceResolution = SurfaceCapabilities.currentExtent;
+    // NOTE[joe] Resolution is undefined when given -1!
+    if (SurfaceResolution.width == -1)
+    {
+        // When width and height are -1 (and they are always both -1), we are
+        // allowed to define whatever resolution we want.
+        SurfaceResolution.width = Context->Width;
+        SurfaceResolution.height = Context->Height;
+    }
+    else
+    {
+        Context->Width = SurfaceResolution.width;
+        Context->Height = SurfaceResolution.height;
+    }
+
+    VkSurfaceTransformFlagBitsKHR PreTransform =
+                                        SurfaceCapabilities.currentTransform;
+    if (SurfaceCapabilities.supportedTransforms &
+        VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR)
+    {
+        PreTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+    }
+
+    /** Get the presentation modes supported. */
+
+    unsigned int PresentModeCount = 0;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(Context->PhysicalDevice,
+                                              Context->Surface,
+                                              &PresentModeCount,
+                                              0);
+
+    VkPresentModeKHR *PresentModes =
+        PushArray(&Memory->Frame, VkPresentModeKHR, PresentModeCount);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(Context->PhysicalDevice,
+                                              Context->Surface,
+                                              &PresentModeCount,
+                                              PresentModes);
+
+    // NOTE[joe] This is always supported and our best option for present mode.
+    // The reason why this is the best is because it keeps a queue of frames
+    // and will perform v-sync, but will not screen-tear if a frame is late.
+    VkPresentModeKHR PresentationMode = VK_PRESENT_MODE_FIFO_KHR;
+    for (unsigned int i = 0; i < PresentModeCount; i++)
+    {
+        // However, if VK_PRESENT_MODE_MAILBOX_KHR is supported, we should opt
+        // for this because it has lower latency. This is due to the fact that
+        // this mode has a 1-entry queue. This means that when a frame is
+        // committed, it overwrites the last committed frame. This eliminates
+        // the device having to chew its way through a backlog of committed
+        // frames. This does mean that instead of latency, we now have frame
+        // skips to contend with.
+        if (PresentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
+        {
+            PresentationMode = VK_PRESENT_MODE_MAILBOX_KHR;
+            break;
+        }
+    }
+
+    /** Create swap chain. */
+
+    VkSwapchainCreateInfoKHR SwapChainCreateInfo = {};
+    SwapChainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    SwapChainCreateInfo.surface = Context->Surface;
+    SwapChainCreateInfo.minImageCount = DesiredImageCount;
+    SwapChainCreateInfo.imageFormat = ColorFormat;
+    SwapChainCreateInfo.imageColorSpace = ColorSpace;
+    SwapChainCreateInfo.imageExtent = SurfaceResolution;
+    SwapChainCreateInfo.imageArrayLayers = 1;
+    SwapChainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    SwapChainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    SwapChainCreateInfo.preTransform = PreTransform;
+    SwapChainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    SwapChainCreateInfo.presentMode = PresentationMode;
+    // NOTE[joe] Toggles clipping outside surface extents.
+    SwapChainCreateInfo.clipped = true;
+
+    Result = vkCreateSwapchainKHR(Context->Device,
+                                  &SwapChainCreateInfo,
+                                  GetHostAllocator(Context, HOST_TAG_SWAPCHAIN),
+                                  &Context->SwapChain);
+
+    Assert(Result == VK_SUCCESS, "Failed to create swapchain.\n");
+
+    /** Create a command pool. */
+
+    VkCommandPoolCreateInfo CommandPoolCreateInfo = {};
+    CommandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    CommandPoolCreateInfo.flags =
+        VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    CommandPoolCreateInfo.queueFamilyIndex = Context->PresentQueueIndex;
+
+    VkCommandPool CommandPool;
+    Result = vkCreateCommandPool(Context->Device,
+                                 &CommandPoolCreateInfo,
+                                 GetHostAllocator(Context, HOST_TAG_COMMAND),
+                                 &CommandPool);
+
+    Assert(Result == VK_SUCCESS, "Failed to create command pool.");
+
+    /** Create a command buffer for setup and drawing. */
+
+    VkCommandBufferAllocateInfo CommandBufferAllocateInfo = {};
+    CommandBufferAllocateInfo.sType =
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    CommandBufferAllocateInfo.commandPool = CommandPool;
+    CommandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    CommandBufferAllocateInfo.commandBufferCount = 1;
+
+    Result = vkAllocateCommandBuffers(Context->Device,
+                                      &CommandBufferAllocateInfo,
+                                      &Context->SetupCommandBuffer);
+
+    Assert(Result == VK_SUCCESS, "Failed to allocate setup command buffer.\n");
+
+    Result = vkAllocateCommandBuffers(Context->Device,
+                                      &CommandBufferAllocateInfo,
+                                      &Context->DrawCommandBuffer);
+
+    Assert(Result == VK_SUCCESS, "Failed to allocate draw command buffer.\n");
+
+    InitializeSetupContext(Context);
+    InitializePipelineManager(Context);
+
+    /** Create and initialize color image handles. */
+
+    unsigned int ImageCount = 0;
+    vkGetSwapchainImagesKHR(Context->Device,
+                            Context->SwapChain,
+                            &ImageCount,
+                            0);
+
+    Context->PresentImages =
+        PushArray(&Memory->Permanent, VkImage, ImageCount);
+
+    vkGetSwapchainImagesKHR(Context->Device,
+                            Context->SwapChain,
+                            &ImageCount,
+                            Context->PresentImages);
+
+    // NOTE[joe] We don't transition the present images here. We can't touch
+    // them until they've been acquired anyway, and the first frame that gets
+    // one moves it out of the undefined layout through the tracker.
+    for (unsigned int i = 0; i < ImageCount; i++)
+    {
+        TrackImage(&Context->Resources,
+                   Context->PresentImages[i],
+                   VK_IMAGE_ASPECT_COLOR_BIT,
+                   1, 1,
+                   VK_IMAGE_LAYOUT_UNDEFINED);
+    }
+
+    VkImageViewCreateInfo PresentImagesViewCreateInfo = {};
+    PresentImagesViewCreateInfo.sType =
+        VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    PresentImagesViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    PresentImagesViewCreateInfo.format = ColorFormat;
+    PresentImagesViewCreateInfo.components = {
+        VK_COMPONENT_SWIZZLE_R,
+        VK_COMPONENT_SWIZZLE_G,
+        VK_COMPONENT_SWIZZLE_B,
+        VK_COMPONENT_SWIZZLE_A
+    };
+    PresentImagesViewCreateInfo.subresourceRange.aspectMask =
+        VK_IMAGE_ASPECT_COLOR_BIT;
+    PresentImagesViewCreateInfo.subresourceRange.levelCount = 1;
+    PresentImagesViewCreateInfo.subresourceRange.layerCount = 1;
+
+    /** Create image views for the presentation color images. */
+
+    // NOTE[joe] Dynamic rendering renders straight into these, so they have to
+    // stick around.
+    Context->PresentImageViews =
+        PushArray(&Memory->Permanent, VkImageView, ImageCount);
+
+    for (unsigned int i = 0; i < ImageCount; i++)
+    {
+        PresentImagesViewCreateInfo.image = Context->PresentImages[i];
+
+        // Create us an image view (finally)
+        Result = vkCreateImageView(Context->Device,
+                                   &PresentImagesViewCreateInfo,
+                                   GetHostAllocator(Context, HOST_TAG_IMAGE),
+                                   &Context->PresentImageViews[i]);
+
+        Assert(Result == VK_SUCCESS, "Could not create image view.\n");
+    }
+
+    /** Create a depth image buffer. (The previously created image is a color
+     * image buffer.) */
+
+    Context->DepthFormat =
+        ChooseDepthFormat(Context,
+                          DepthFormatPreference,
+                          sizeof(DepthFormatPreference)/sizeof(VkFormat));
+    Context->DepthAspect = DepthFormatAspect(Context->DepthFormat);
+
+    // NOTE[joe] Depth is kept after the render pass, for the depth pyramid
+    // and for the next frame's particles to collide with.
+    CreateAttachment(Context,
+                     Context->DepthFormat,
+                     VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                     VK_IMAGE_USAGE_SAMPLED_BIT,
+                     Context->DepthAspect,
+                     VK_SAMPLE_COUNT_1_BIT,
+                     &Context->DepthImage,
+                     &Context->DepthImageView);
+
+    /** Change the layout of our depth buffer image. */
+
+    UseImage(&Context->Resources,
+             Context->DepthImage,
+             RESOURCE_USAGE_DEPTH_ATTACHMENT);
+    FlushBarriers(&Context->Resources, SetupCommands(Context));
+
+    /** Create the render pass and framebuffers, unless dynamic rendering
+     * means we don't need them. */
+
+    Context->ColorFormat = ColorFormat;
+
+    if (!Context->UseDynamicRendering)
+    {
+        /** Create attachments for render pass. */
+
+        VkAttachmentDescription PassAttachments[2] = {};
+
+        PassAttachments[0].format = ColorFormat;
+        PassAttachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+        PassAttachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        PassAttachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        PassAttachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        PassAttachments[0].initialLayout =
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        PassAttachments[0].finalLayout =
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        PassAttachments[1].format = Context->DepthFormat;
+        PassAttachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+        PassAttachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        PassAttachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        PassAttachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        PassAttachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        PassAttachments[1].initialLayout =
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        PassAttachments[1].finalLayout =
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference ColorAttachmentReference = {};
+        ColorAttachmentReference.attachment = 0;
+        ColorAttachmentReference.layout =
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference DepthAttachmentReference = {};
+        DepthAttachmentReference.attachment = 1;
+        DepthAttachmentReference.layout =
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        /** Create render pass and accompanying subpass. */
+
+        VkSubpassDescription Subpass = {};
+        Subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        Subpass.colorAttachmentCount = 1;
+        Subpass.pColorAttachments = &ColorAttachmentReference;
+        Subpass.pDepthStencilAttachment = &DepthAttachmentReference;
+
+        VkRenderPassCreateInfo RenderPassCreateInfo = {};
+        RenderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        RenderPassCreateInfo.attachmentCount = 2;
+        RenderPassCreateInfo.pAttachments = PassAttachments;
+        RenderPassCreateInfo.subpassCount = 1;
+        RenderPassCreateInfo.pSubpasses = &Subpass;
+
+        Result = vkCreateRenderPass(Context->Device,
+                                    &RenderPassCreateInfo,
+                                    GetHostAllocator(Context, HOST_TAG_IMAGE),
+                                    &Context->RenderPass);
+
+        Assert(Result == VK_SUCCESS, "Failed to create render pass.\n");
+
+        // NOTE[joe] The same pass again, but carrying on from what the first
+        // one drew instead of clearing it, for occlusion culling's second
+        // pass. Only load ops differ, so it works with the same framebuffers.
+        PassAttachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+        PassAttachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+
+        Result = vkCreateRenderPass(Context->Device,
+                                    &RenderPassCreateInfo,
+                                    GetHostAllocator(Context, HOST_TAG_IMAGE),
+                                    &Context->LoadRenderPass);
+
+        Assert(Result == VK_SUCCESS, "Failed to create render pass.\n");
+
+        /** Create framebuffers. */
+
+        VkImageView FramebufferAttachments[2];
+        FramebufferAttachments[1] = Context->DepthImageView;
+
+        VkFramebufferCreateInfo FramebufferCreateInfo = {};
+        FramebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        FramebufferCreateInfo.renderPass = Context->RenderPass;
+        FramebufferCreateInfo.attachmentCount = 2;
+        FramebufferCreateInfo.pAttachments = FramebufferAttachments;
+        FramebufferCreateInfo.width = Context->Width;
+        FramebufferCreateInfo.height = Context->Height;
+        FramebufferCreateInfo.layers = 1;
+
+        Context->Framebuffers =
+            PushArray(&Memory->Permanent, VkFramebuffer, ImageCount);
+
+        for (unsigned int i = 0; i < ImageCount; i++)
+        {
+            FramebufferAttachments[0] = Context->PresentImageViews[i];
+
+            Result =
+                vkCreateFramebuffer(Context->Device,
+                                    &FramebufferCreateInfo,
+                                    GetHostAllocator(Context, HOST_TAG_IMAGE),
+                                    &Context->Framebuffers[i]);
+
+            Assert(Result == VK_SUCCESS, "Failed to create framebuffer.\n");
+        }
+    }
+
+    /** Create a vertex buffer for a triangle mesh. */
+
+    VkBufferCreateInfo VertexInputBufferInfo = {};
+    VertexInputBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    // NOTE[joe] Allocate enough memory for a triangle.
+    VertexInputBufferInfo.size = sizeof(RenderTriangle);
+    VertexInputBufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                  VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    VertexInputBufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    Result = vkCreateBuffer(Context->Device,
+                            &VertexInputBufferInfo,
+                            GetHostAllocator(Context, HOST_TAG_BUFFER),
+                            &Context->VertexInputBuffer);
+
+    Assert(Result == VK_SUCCESS, "Failed to create vertex input buffer.\n");
+
+    /** Allocate memory on the rendering device for our vertex buffer.
+     * TODO[joe] Do we want be allocating a vertex buffer for our context?
+     * Or do we want to be doing it for every model individually? */
+
+    AllocateBufferMemory(Context,
+                         Context->VertexInputBuffer,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    TrackBuffer(&Context->Resources, Context->VertexInputBuffer);
+
+    /** Upload our triangle through the setup context. */
+
+    UploadToBuffer(Context,
+                   Context->VertexInputBuffer,
+                   0,
+                   RenderTriangle,
+                   sizeof(RenderTriangle));
+
+    /** Submit all of our setup work at once. */
+
+    // NOTE[joe] This is the one and only time we wait on the GPU during start
+    // up. Anything recorded into the setup context above goes out here.
+    SubmitSetup(Context);
+
+    UpdateMemoryBudget(Context);
+
+#ifdef DEBUG
+    LogMemoryStats(Context);
+    LogHostAllocatorStats(&Context->HostAllocator);
+#endif
+
+    EndArenaTemp(Scratch);
+}
+
@@ -0,0 +1,191 @@
+/**
+ * @file vulkan_upload.cpp
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains our setup/upload command context. Rather than recording,
+ * submitting and waiting on a fence for every little bit of setup work, we
+ * record all of it into one command buffer and submit it in one go with
+ * SubmitSetup(). This is used both at start up and when loading levels.
+ *
+ * There's only the one setup command buffer and staging buffer, and the
+ * setup command buffer comes out of the same command pool as the draw
+ * command buffer, and transitions through the same resource tracker. None of
+ * that is safe to touch while the render thread is recording, so everything
+ * here has to happen on the render thread, or before it starts.
+ */
+
+#include "platform.h"
+#include "render.h"
+
+// NOTE[joe] Keeps staging copies aligned well enough for any buffer or image.
+#define SETUP_STAGING_ALIGNMENT 16
+
+/** Creates the fence and staging buffer used by the setup context. Expects
+ * Context->SetupCommandBuffer to already be allocated. */
+static
+void InitializeSetupContext(vulkan_context *Context)
+{
+    setup_context *Setup = &Context->Setup;
+
+    Setup->CommandBuffer = Context->SetupCommandBuffer;
+
+    VkFenceCreateInfo FenceCreateInfo = {};
+    FenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VkResult Result = vkCreateFence(Context->Device,
+                                    &FenceCreateInfo,
+                                    GetHostAllocator(Context, HOST_TAG_SYNC),
+                                    &Setup->Fence);
+
+    Assert(Result == VK_SUCCESS, "Failed to create setup fence.\n");
+
+    VkBufferCreateInfo StagingBufferInfo = {};
+    StagingBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    StagingBufferInfo.size = SETUP_STAGING_SIZE;
+    StagingBufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    StagingBufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    Result = vkCreateBuffer(Context->Device,
+                            &StagingBufferInfo,
+                            GetHostAllocator(Context, HOST_TAG_BUFFER),
+                            &Setup->StagingBuffer);
+
+    Assert(Result == VK_SUCCESS, "Failed to create staging buffer.\n");
+
+    // NOTE[joe] Coherent memory saves us from flushing before every submit.
+    Setup->StagingMemory =
+        AllocateBufferMemory(Context,
+                             Setup->StagingBuffer,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    Result = vkMapMemory(Context->Device,
+                         Setup->StagingMemory,
+                         0,
+                         VK_WHOLE_SIZE,
+                         0,
+                         (void **)&Setup->StagingMapped);
+
+    Assert(Result == VK_SUCCESS, "Failed to map staging buffer.\n");
+}
+
+/** Returns the setup command buffer, beginning it if this is the first bit
+ * of setup work since the last SubmitSetup(). */
+static
+VkCommandBuffer SetupCommands(vulkan_context *Context)
+{
+    setup_context *Setup = &Context->Setup;
+
+    if (!Setup->IsRecording)
+    {
+        VkCommandBufferBeginInfo BeginInfo = {};
+        BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(Setup->CommandBuffer, &BeginInfo);
+
+        Setup->IsRecording = true;
+    }
+
+    return Setup->CommandBuffer;
+}
+
+/** Submits everything recorded since the last call and waits for it. This is
+ * the only place the setup context waits on the GPU. */
+static
+void SubmitSetup(vulkan_context *Context)
+{
+    setup_context *Setup = &Context->Setup;
+
+    if (!Setup->IsRecording)
+        return;
+
+    vkEndCommandBuffer(Setup->CommandBuffer);
+
+    VkSubmitInfo SubmitInfo = {};
+    SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    SubmitInfo.commandBufferCount = 1;
+    SubmitInfo.pCommandBuffers = &Setup->CommandBuffer;
+
+    VkResult Result = vkQueueSubmit(Context->PresentQueue,
+                                    1,
+                                    &SubmitInfo,
+                                    Setup->Fence);
+
+    Assert(Result == VK_SUCCESS, "Failed to submit setup commands.\n");
+
+    vkWaitForFences(Context->Device, 1, &Setup->Fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(Context->Device, 1, &Setup->Fence);
+    vkResetCommandBuffer(Setup->CommandBuffer, 0);
+
+    Setup->IsRecording = false;
+    Setup->StagingOffset = 0;
+    Setup->SubmitCount++;
+}
+
+/** Reserves Size bytes of staging memory, submitting pending setup work
+ * first if the staging buffer is full. Returns the offset of the space. */
+static
+VkDeviceSize ReserveStaging(vulkan_context *Context, VkDeviceSize Size)
+{
+    setup_context *Setup = &Context->Setup;
+
+    Assert(Size <= SETUP_STAGING_SIZE, "Staging reservation too big.\n");
+
+    VkDeviceSize Offset = (Setup->StagingOffset + SETUP_STAGING_ALIGNMENT - 1) &
+                          ~(VkDeviceSize)(SETUP_STAGING_ALIGNMENT - 1);
+
+    if (Offset + Size > SETUP_STAGING_SIZE)
+    {
+        SubmitSetup(Context);
+        Offset = 0;
+    }
+
+    Setup->StagingOffset = Offset + Size;
+
+    return Offset;
+}
+
+/** Queues a copy of Size bytes of Data into Buffer at DstOffset. The data is
+ * copied out immediately, so Data can be freed as soon as this returns. */
+static
+void UploadToBuffer(vulkan_context *Context,
+                    VkBuffer Buffer,
+                    VkDeviceSize DstOffset,
+                    const void *Data,
+                    VkDeviceSize Size)
+{
+    setup_context *Setup = &Context->Setup;
+    const unsigned char *Source = (const unsigned char *)Data;
+
+    while (Size)
+    {
+        VkDeviceSize ChunkSize =
+            Size < SETUP_STAGING_SIZE ? Size : SETUP_STAGING_SIZE;
+
+        VkDeviceSize StagingOffset = ReserveStaging(Context, ChunkSize);
+        memcpy(Setup->StagingMapped + StagingOffset, Source, ChunkSize);
+
+        VkCommandBuffer CommandBuffer = SetupCommands(Context);
+
+        UseBuffer(&Context->Resources, Buffer, RESOURCE_USAGE_TRANSFER_DST);
+        FlushBarriers(&Context->Resources, CommandBuffer);
+
+        VkBufferCopy Region = {};
+        Region.srcOffset = StagingOffset;
+        Region.dstOffset = DstOffset;
+        Region.size = ChunkSize;
+
+        vkCmdCopyBuffer(CommandBuffer,
+                        Setup->StagingBuffer,
+                        Buffer,
+                        1, &Region);
+
+        Source += ChunkSize;
+        DstOffset += ChunkSize;
+        Size -= ChunkSize;
+    }
+}
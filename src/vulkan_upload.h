@@ -0,0 +1,35 @@
+/**
+ * @file vulkan_upload.h
+ * @author Joseph Miles <josephmiles2015@gmail.com>
+ * @date 2026-10-18
+ *
+ * This file contains the definitions for our setup/upload command context,
+ * which batches one-off GPU work (layout transitions and buffer uploads)
+ * into a single command buffer that is submitted once.
+ */
+
+#ifndef _VULKAN_UPLOAD_H_
+#define _VULKAN_UPLOAD_H_
+
+// NOTE[joe] Uploads bigger than this get split across several submits.
+#define SETUP_STAGING_SIZE (16 * 1024 * 1024)
+
+// NOTE[joe] There's one of these, used from the render thread only. See
+// vulkan_upload.cpp for why.
+typedef struct {
+    VkCommandBuffer CommandBuffer;
+    VkFence         Fence;
+    bool            IsRecording;
+
+    /** Persistently mapped, host-visible buffer that uploads are copied
+     * through. It is only reused once the submit that reads it is done. */
+    VkBuffer        StagingBuffer;
+    VkDeviceMemory  StagingMemory;
+    unsigned char  *StagingMapped;
+    VkDeviceSize    StagingOffset;
+
+    // NOTE[joe] Counts fence round trips, so we can see what loads cost us.
+    unsigned int    SubmitCount;
+} setup_context;
+
+#endif
@@ -10,197 +10,65 @@
 // Include the Windows system specific header, with Unicode support.
 #include <windows.h>
 
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+
 // Include Vulkan headers.
 #define VK_USE_PLATFORM_WIN32_KHR
 #define VK_NO_PROTOTYPES
 #include <vulkan/vulkan.h>
+#include "vulkan_ext.h"
 
 // Include engine headers.
 #include "render.h"
 #include "platform.h"
+#include "memory.h"
+
+// NOTE[joe] Our Vulkan setup allocates from arenas, so this comes first.
+#include "memory.cpp"
 
 // Include Win32 specific vulkan setup.
 #include "win32_vulkan_helper.cpp"
 
+// Include platform independent game code.
+#include "linear_math.cpp"
+#include "job.cpp"
+#include "job_bench.cpp"
+#include "ecs.cpp"
+#include "ecs_bench.cpp"
+#include "math_bench.cpp"
+#include "io.cpp"
+#include "task.cpp"
+#include "transform.cpp"
+#include "transform_bench.cpp"
+#include "skinning.cpp"
+#include "skin_bench.cpp"
+#include "animation.cpp"
+#include "anim_bench.cpp"
+#include "broadphase.cpp"
+#include "broadphase_bench.cpp"
+#include "physics.cpp"
+#include "physics_bench.cpp"
+#include "occlusion.cpp"
+#include "occlusion_bench.cpp"
+#include "particles.cpp"
+#include "culling.cpp"
+#include "render.cpp"
+#include "barrier_bench.cpp"
+#include "budget_bench.cpp"
+#include "game.cpp"
+
 // NOTE[joe] Temporary globals
 static int ApplicationQuit;
 static vulkan_context Context;
-
-/** Render black to the screen instead of white. */
-static
-void GameRender(vulkan_context Context)
-{
-    VkSemaphore PresentCompletedSemaphore, RenderingCompletedSemaphore;
-
-    VkSemaphoreCreateInfo SemaphoreCreateInfo = {};
-    SemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-    vkCreateSemaphore(Context.Device,
-                      &SemaphoreCreateInfo,
-                      0,
-                      &PresentCompletedSemaphore);
-    vkCreateSemaphore(Context.Device,
-                      &SemaphoreCreateInfo,
-                      0,
-                      &RenderingCompletedSemaphore);
-
-    unsigned int NextImageIndex;
-    vkAcquireNextImageKHR(Context.Device,
-                          Context.SwapChain,
-                          UINT64_MAX,
-                          PresentCompletedSemaphore,
-                          VK_NULL_HANDLE,
-                          &NextImageIndex);
-
-    VkCommandBufferBeginInfo BeginInfo = {};
-    BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(Context.DrawCommandBuffer, &BeginInfo);
-
-    /** Change image memory from the present layout to an attachment layout. */
-
-    VkImageMemoryBarrier LayoutTransitionBarrier = {};
-    LayoutTransitionBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    LayoutTransitionBarrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-    LayoutTransitionBarrier.dstAccessMask =
-        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
-        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    LayoutTransitionBarrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-    LayoutTransitionBarrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    LayoutTransitionBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    LayoutTransitionBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    LayoutTransitionBarrier.image = Context.PresentImages[NextImageIndex];
-    LayoutTransitionBarrier.subresourceRange.aspectMask =
-        VK_IMAGE_ASPECT_COLOR_BIT;
-    LayoutTransitionBarrier.subresourceRange.levelCount = 1;
-    LayoutTransitionBarrier.subresourceRange.layerCount = 1;
-
-    vkCmdPipelineBarrier(Context.DrawCommandBuffer,
-                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT |
-                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                         0, // Dependency flags
-                         0, 0, // Memory barrier count and pointer
-                         0, 0, // Buffer memory barrier count and pointer
-                         1, &LayoutTransitionBarrier);
-
-    /** Setup and initialize the render pass. */
-
-    VkClearValue ClearValues[] = {
-        { 1.0f, 1.0f, 1.0f, 1.0f },
-        { 1.0f, 0.0f }
-    };
-
-    VkRenderPassBeginInfo RenderPassBeginInfo = {};
-    RenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    RenderPassBeginInfo.renderPass = Context.RenderPass;
-    RenderPassBeginInfo.framebuffer = Context.Framebuffers[NextImageIndex];
-    RenderPassBeginInfo.renderArea = { 0, 0, Context.Width, Context.Height};
-    RenderPassBeginInfo.clearValueCount = 2;
-    RenderPassBeginInfo.pClearValues = ClearValues;
-
-    vkCmdBeginRenderPass(Context.DrawCommandBuffer,
-                         &RenderPassBeginInfo,
-                         VK_SUBPASS_CONTENTS_INLINE);
-
-    vkCmdBindPipeline(Context.DrawCommandBuffer,
-                      VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      Context.Pipeline);
-
-    /* NOTE[joe] Uncomment when using dynamic state.
-    VkViewport Viewport = { 0, 0, Context.Width, Context.Height };
-    vkCmdSetViewport(Context.DrawCommandBuffer, 0, 1, &Viewport);
-
-    VkRect2D Scissor = { 0, 0, Context.Width, Context.Height };
-    vkCmdSetScissor(Context.DrawCommandBuffer, 0, 1, &Scissor);
-     */
-
-    /** Add draw command to command buffer. */
-
-    VkDeviceSize Offsets = {};
-    vkCmdBindVertexBuffers(Context.DrawCommandBuffer,
-                           0,
-                           1,
-                           &Context.VertexInputBuffer,
-                           &Offsets);
-
-    vkCmdDraw(Context.DrawCommandBuffer,
-              3, // Vertex count.
-              1, // Instance count (what is this?)
-              0, // First vertex index.
-              0); // First instance index (what is this?)
-
-    vkCmdEndRenderPass(Context.DrawCommandBuffer);
-
-    /** Convert image from attachment layout back to present layout. */
-
-    VkImageMemoryBarrier PrePresentBarrier = {};
-    PrePresentBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    PrePresentBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    PrePresentBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-    PrePresentBarrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    PrePresentBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-    PrePresentBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    PrePresentBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    PrePresentBarrier.subresourceRange.aspectMask =
-        VK_IMAGE_ASPECT_COLOR_BIT;
-    PrePresentBarrier.subresourceRange.levelCount = 1;
-    PrePresentBarrier.subresourceRange.layerCount = 1;
-    PrePresentBarrier.image = Context.PresentImages[NextImageIndex];
-
-    vkCmdPipelineBarrier(Context.DrawCommandBuffer,
-                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-                         0, 0, 0, 0, 0, 1,
-                         &PrePresentBarrier);
-
-    vkEndCommandBuffer(Context.DrawCommandBuffer);
-
-    /** Submit our draw commands and present our image. */
-
-    VkFence RenderFence;
-    VkFenceCreateInfo FenceCreateInfo = {};
-    FenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-
-    vkCreateFence(Context.Device,
-                  &FenceCreateInfo,
-                  0,
-                  &RenderFence);
-
-    VkPipelineStageFlags WaitStageMask = {
-        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
-    };
-
-    VkSubmitInfo SubmitInfo = {};
-    SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    SubmitInfo.waitSemaphoreCount = 1;
-    SubmitInfo.pWaitSemaphores = &PresentCompletedSemaphore;
-    SubmitInfo.pWaitDstStageMask = &WaitStageMask;
-    SubmitInfo.commandBufferCount = 1;
-    SubmitInfo.pCommandBuffers = &Context.DrawCommandBuffer;
-    SubmitInfo.signalSemaphoreCount = 1;
-    SubmitInfo.pSignalSemaphores = &RenderingCompletedSemaphore;
-
-    vkQueueSubmit(Context.PresentQueue, 1, &SubmitInfo, RenderFence);
-
-    vkWaitForFences(Context.Device, 1, &RenderFence, VK_TRUE, UINT64_MAX);
-    vkDestroyFence(Context.Device, RenderFence, 0);
-
-    VkPresentInfoKHR PresentInfo = {};
-    PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    PresentInfo.waitSemaphoreCount = 1;
-    PresentInfo.pWaitSemaphores = &RenderingCompletedSemaphore;
-    PresentInfo.swapchainCount = 1;
-    PresentInfo.pSwapchains = &Context.SwapChain;
-    PresentInfo.pImageIndices = &NextImageIndex;
-
-    // Submits the contents of our presnt queue to be draw to the screen.
-    vkQueuePresentKHR(Context.PresentQueue, &PresentInfo);
-
-    vkDestroySemaphore(Context.Device, PresentCompletedSemaphore, 0);
-    vkDestroySemaphore(Context.Device, RenderingCompletedSemaphore, 0);
-}
+static game_loop Loop;
+static render_handoff Handoff;
+static job_system Jobs;
+static io_queue IO;
+static game_memory Memory;
 
 #ifdef DEBUG
 static
@@ -229,56 +97,333 @@ void Abort(const char* Message)
     abort();
 }
 
-/** Loads a compiled shader from the given FilePath and creates a Vulkan shader
- * module from it. */
-static inline
-VkShaderModule PlatformLoadShader(vulkan_context Context,
-                                  const char* FilePath)
+static
+void PlatformLog(const char* Format, ...)
 {
-    unsigned int CodeSize;
-    char Code[PLATFORM_MAX_SHADER_SIZE];
-    HANDLE FileHandle = 0;
-
-    FileHandle = CreateFile(FilePath,
-                            GENERIC_READ,
-                            0,
-                            0,
-                            OPEN_EXISTING,
-                            FILE_ATTRIBUTE_NORMAL,
-                            0);
-
-    // TODO[joe] Report shader name.
-    // TODO[joe] Abort elsewhere?
-#if DEBUG
-    Assert(FileHandle != INVALID_HANDLE_VALUE, "Failed to open shader!");
-#else
-    if (FileHandle != INVALID_HANDLE_VALUE)
-        Abort("Failed to open shader!");
-#endif
+    char Message[1024];
+
+    va_list Arguments;
+    va_start(Arguments, Format);
+    vsnprintf(Message, sizeof(Message), Format, Arguments);
+    va_end(Arguments);
+
+    OutputDebugStringA(Message);
+}
 
-    ReadFile(FileHandle,
-             Code,
-             PLATFORM_MAX_SHADER_SIZE,
-             (LPDWORD) &CodeSize,
-             0);
+static
+unsigned char *PlatformReadEntireFile(const char *FilePath,
+                                      unsigned int *Size)
+{
+    HANDLE FileHandle = CreateFile(FilePath,
+                                   GENERIC_READ,
+                                   FILE_SHARE_READ,
+                                   0,
+                                   OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL,
+                                   0);
+
+    if (FileHandle == INVALID_HANDLE_VALUE)
+    {
+        PlatformLog("Failed to open %s.\n", FilePath);
+        return 0;
+    }
+
+    DWORD FileSize = GetFileSize(FileHandle, 0);
+    unsigned char *Data = new unsigned char[FileSize];
+
+    DWORD BytesRead = 0;
+    BOOL Success = ReadFile(FileHandle, Data, FileSize, &BytesRead, 0);
 
     CloseHandle(FileHandle);
 
-    VkShaderModuleCreateInfo ShaderCreationInfo = {};
-    ShaderCreationInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    ShaderCreationInfo.codeSize = CodeSize;
-    ShaderCreationInfo.pCode = (unsigned int *)Code;
+    if (!Success || BytesRead != FileSize)
+    {
+        PlatformLog("Failed to read %s.\n", FilePath);
+
+        delete[] Data;
+        return 0;
+    }
+
+    *Size = FileSize;
+
+    return Data;
+}
+
+static
+void *PlatformReserveMemory(size_t Size)
+{
+    return VirtualAlloc(0, Size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+static
+bool PlatformCommitMemory(void *Address, size_t Size)
+{
+    return VirtualAlloc(Address, Size, MEM_COMMIT, PAGE_READWRITE) != 0;
+}
+
+static
+void PlatformReleaseMemory(void *Address, size_t Size)
+{
+    // NOTE[joe] Releasing has to cover the whole reservation, which Windows
+    // wants us to say with a size of zero.
+    VirtualFree(Address, 0, MEM_RELEASE);
+}
+
+/** Returns QueryPerformanceCounter() in seconds. */
+static
+double PlatformGetTime()
+{
+    static LARGE_INTEGER Frequency;
+
+    if (Frequency.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&Frequency);
+    }
+
+    LARGE_INTEGER Counter;
+    QueryPerformanceCounter(&Counter);
+
+    return (double)Counter.QuadPart / (double)Frequency.QuadPart;
+}
+
+/** Blocks on a waitable timer until Time. */
+static
+void PlatformSleepUntil(double Time)
+{
+    static HANDLE Timer;
+
+    if (!Timer)
+    {
+        // NOTE[joe] High resolution timers need Windows 10 1803. Older
+        // versions fail here, and get a regular timer with the default
+        // (~15.6ms) scheduler granularity instead.
+        Timer = CreateWaitableTimerExW(0,
+                                       0,
+                                       CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                       TIMER_ALL_ACCESS);
+
+        if (!Timer)
+        {
+            Timer = CreateWaitableTimer(0, TRUE, 0);
+        }
+
+        Assert(Timer != 0, "Failed to create frame timer.\n");
+    }
+
+    double Remaining = Time - PlatformGetTime();
+
+    if (Remaining <= 0)
+        return;
+
+    // NOTE[joe] Negative due times are relative, in 100ns units.
+    LARGE_INTEGER DueTime;
+    DueTime.QuadPart = -(LONGLONG)(Remaining * 1e7);
+
+    if (SetWaitableTimer(Timer, &DueTime, 0, 0, 0, FALSE))
+    {
+        WaitForSingleObject(Timer, INFINITE);
+    }
+}
+
+struct platform_thread {
+    HANDLE                Handle;
+    platform_thread_proc *Proc;
+    void                 *Data;
+};
+
+struct platform_semaphore {
+    HANDLE Handle;
+};
+
+static
+DWORD WINAPI win32_ThreadProc(LPVOID Parameter)
+{
+    platform_thread *Thread = (platform_thread *)Parameter;
+    Thread->Proc(Thread->Data);
+
+    return 0;
+}
+
+static
+platform_thread *PlatformCreateThread(memory_arena *Arena,
+                                      platform_thread_proc *Proc,
+                                      void *Data)
+{
+    platform_thread *Thread = PushStruct(Arena, platform_thread);
+    Thread->Proc = Proc;
+    Thread->Data = Data;
+    Thread->Handle = CreateThread(0, 0, win32_ThreadProc, Thread, 0, 0);
+
+    Assert(Thread->Handle != 0, "Failed to create thread.\n");
+
+    return Thread;
+}
+
+static
+void PlatformJoinThread(platform_thread *Thread)
+{
+    WaitForSingleObject(Thread->Handle, INFINITE);
+    CloseHandle(Thread->Handle);
+}
+
+static
+platform_semaphore *PlatformCreateSemaphore(memory_arena *Arena,
+                                            unsigned int Count)
+{
+    platform_semaphore *Semaphore = PushStruct(Arena, platform_semaphore);
+    Semaphore->Handle = CreateSemaphore(0, Count, 0x7FFFFFFF, 0);
+
+    Assert(Semaphore->Handle != 0, "Failed to create semaphore.\n");
+
+    return Semaphore;
+}
+
+static
+void PlatformWaitSemaphore(platform_semaphore *Semaphore)
+{
+    WaitForSingleObject(Semaphore->Handle, INFINITE);
+}
+
+static
+bool PlatformWaitSemaphoreTimeout(platform_semaphore *Semaphore,
+                                  unsigned int Microseconds)
+{
+    // NOTE[joe] Rounded up, so that short waits still wait.
+    DWORD Milliseconds = (Microseconds + 999) / 1000;
+
+    return WaitForSingleObject(Semaphore->Handle, Milliseconds) ==
+           WAIT_OBJECT_0;
+}
+
+static
+void PlatformSignalSemaphore(platform_semaphore *Semaphore)
+{
+    ReleaseSemaphore(Semaphore->Handle, 1, 0);
+}
+
+static
+void PlatformDestroySemaphore(platform_semaphore *Semaphore)
+{
+    CloseHandle(Semaphore->Handle);
+}
+
+static
+void PlatformYield()
+{
+    SwitchToThread();
+}
+
+struct platform_fiber {
+    LPVOID                Handle;
+    platform_thread_proc *Proc;
+    void                 *Data;
+};
+
+static
+void WINAPI win32_FiberProc(LPVOID Parameter)
+{
+    platform_fiber *Fiber = (platform_fiber *)Parameter;
+    Fiber->Proc(Fiber->Data);
+}
+
+static
+platform_fiber *PlatformConvertThreadToFiber(memory_arena *Arena)
+{
+    platform_fiber *Fiber = PushStruct(Arena, platform_fiber);
+    Fiber->Handle = ConvertThreadToFiberEx(0, FIBER_FLAG_FLOAT_SWITCH);
+    Fiber->Proc = 0;
+    Fiber->Data = 0;
+
+    Assert(Fiber->Handle != 0, "Failed to convert thread to fiber.\n");
+
+    return Fiber;
+}
+
+static
+void PlatformConvertFiberToThread(platform_fiber *Fiber)
+{
+    ConvertFiberToThread();
+}
+
+static
+platform_fiber *PlatformCreateFiber(memory_arena *Arena,
+                                    unsigned int StackSize,
+                                    platform_thread_proc *Proc,
+                                    void *Data)
+{
+    platform_fiber *Fiber = PushStruct(Arena, platform_fiber);
+    Fiber->Proc = Proc;
+    Fiber->Data = Data;
+
+    // NOTE[joe] Windows reserves the stack itself, guard page included.
+    Fiber->Handle = CreateFiberEx(StackSize,
+                                  StackSize,
+                                  FIBER_FLAG_FLOAT_SWITCH,
+                                  win32_FiberProc,
+                                  Fiber);
 
-    VkShaderModule ShaderModule;
+    Assert(Fiber->Handle != 0, "Failed to create fiber.\n");
 
-    VkResult Result = vkCreateShaderModule(Context.Device,
-                                           &ShaderCreationInfo,
-                                           0,
-                                           &ShaderModule);
+    return Fiber;
+}
 
-    Assert(Result == VK_SUCCESS, "Failed to create vertex shader module.");
+static
+void PlatformDestroyFiber(platform_fiber *Fiber)
+{
+    DeleteFiber(Fiber->Handle);
+}
 
-    return ShaderModule;
+static
+void PlatformSwitchToFiber(platform_fiber *From, platform_fiber *To)
+{
+    SwitchToFiber(To->Handle);
+}
+
+static
+unsigned int PlatformGetCoreCount()
+{
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION Info[256];
+    DWORD Size = sizeof(Info);
+
+    unsigned int CoreCount = 0;
+
+    // NOTE[joe] Hyper-threaded cores show up once here, but as two logical
+    // processors everywhere else.
+    if (GetLogicalProcessorInformation(Info, &Size))
+    {
+        for (DWORD i = 0; i < Size / sizeof(Info[0]); i++)
+        {
+            if (Info[i].Relationship == RelationProcessorCore)
+            {
+                CoreCount++;
+            }
+        }
+    }
+
+    if (CoreCount == 0)
+    {
+        SYSTEM_INFO SystemInfo;
+        GetSystemInfo(&SystemInfo);
+
+        CoreCount = SystemInfo.dwNumberOfProcessors;
+    }
+
+    return CoreCount;
+}
+
+/** Gives us somewhere for stdout and stderr to go. We're a GUI subsystem
+ * app, so we don't get a console of our own; this borrows the one we were
+ * run from, or opens a new one if there isn't one. */
+static
+void win32_AttachConsole()
+{
+    if (!AttachConsole(ATTACH_PARENT_PROCESS) && !AllocConsole())
+    {
+        return;
+    }
+
+    freopen("CONOUT$", "w", stdout);
+    freopen("CONOUT$", "w", stderr);
 }
 
 /** Callback invoked by Windows when it needs us to do something. */
@@ -289,11 +434,6 @@ LRESULT CALLBACK WindowProcedure(HWND Window,
 {
     switch (Message)
     {
-        case WM_PAINT:
-        {
-            GameRender(Context);
-        } break;
-
         case WM_CLOSE:
         case WM_QUIT:
         {
@@ -312,6 +452,73 @@ int WINAPI wWinMain(HINSTANCE Instance,     // Current application instance.
                     PWSTR CommandLineArgs,  // Commandline arguments.
                     int ShowCommand)        // Undocumented (unused).
 {
+    // NOTE[joe] --bench-jobs, --bench-ecs, --bench-math, --bench-skin,
+    // --bench-anim, --bench-broadphase, --bench-physics, --bench-occlusion,
+    // --bench-barriers, --bench-budget and --bench-transforms run the job
+    // system, ECS, math, skinning, animation, broadphase, physics, occlusion
+    // culling, barrier, memory budget and transform hierarchy benchmarks
+    // instead of the game, printing their results to the console.
+    if (CommandLineArgs && wcsstr(CommandLineArgs, L"--bench-"))
+    {
+        win32_AttachConsole();
+    }
+
+    if (CommandLineArgs && wcsstr(CommandLineArgs, L"--bench-jobs"))
+    {
+        BenchmarkJobSystem();
+        return 0;
+    }
+
+    if (CommandLineArgs && wcsstr(CommandLineArgs, L"--bench-ecs"))
+    {
+        return BenchmarkEcs() ? 0 : 1;
+    }
+
+    if (CommandLineArgs && wcsstr(CommandLineArgs, L"--bench-math"))
+    {
+        return BenchmarkMath() ? 0 : 1;
+    }
+
+    if (CommandLineArgs && wcsstr(CommandLineArgs, L"--bench-skin"))
+    {
+        return BenchmarkSkinning() ? 0 : 1;
+    }
+
+    if (CommandLineArgs && wcsstr(CommandLineArgs, L"--bench-anim"))
+    {
+        return BenchmarkAnimation() ? 0 : 1;
+    }
+
+    if (CommandLineArgs && wcsstr(CommandLineArgs, L"--bench-broadphase"))
+    {
+        return BenchmarkBroadphase() ? 0 : 1;
+    }
+
+    if (CommandLineArgs && wcsstr(CommandLineArgs, L"--bench-physics"))
+    {
+        return BenchmarkPhysics() ? 0 : 1;
+    }
+
+    if (CommandLineArgs && wcsstr(CommandLineArgs, L"--bench-occlusion"))
+    {
+        return BenchmarkOcclusion() ? 0 : 1;
+    }
+
+    if (CommandLineArgs && wcsstr(CommandLineArgs, L"--bench-barriers"))
+    {
+        return BenchmarkBarriers() ? 0 : 1;
+    }
+
+    if (CommandLineArgs && wcsstr(CommandLineArgs, L"--bench-budget"))
+    {
+        return BenchmarkBudget() ? 0 : 1;
+    }
+
+    if (CommandLineArgs && wcsstr(CommandLineArgs, L"--bench-transforms"))
+    {
+        return BenchmarkTransforms() ? 0 : 1;
+    }
+
     LPCSTR WindowClassName = "FullMetalJacket_WindowClass";
 
     WNDCLASSEX WindowClass = {};
@@ -338,214 +545,94 @@ int WINAPI wWinMain(HINSTANCE Instance,     // Current application instance.
 
         if (Window)
         {
+            InitializeGameMemory(&Memory);
+
             // TODO[joe] Refactor so Context is passed as pointer.
             // Levi abhores that we pass this massive struct by value.
-            Context = win32_InitializeVulkan(Instance, Window);
-
-            /** BEGIN Vulkan graphics pipeline creation. */
-
-            /** Load shaders. */
-
-            // TODO[joe] Figure out how to better get the shader path.
-            VkShaderModule VertexShader =
-                PlatformLoadShader(Context, "../data/spirv/vert.spv");
-
-            VkShaderModule FragShader =
-                PlatformLoadShader(Context, "../data/spirv/frag.spv");
-
-            /** Create our graphics pipeline. */
-
-            VkPipelineLayoutCreateInfo LayoutCreateInfo = {};
-            LayoutCreateInfo.sType =
-                VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-
-            VkResult Result = vkCreatePipelineLayout(Context.Device,
-                                                     &LayoutCreateInfo,
-                                                     0,
-                                                     &Context.PipelineLayout);
-
-            Assert(Result == VK_SUCCESS, "Failed to create pipeline layout.\n");
-
-            VkPipelineShaderStageCreateInfo ShaderStageCreateInfo[2] = {};
-
-            // Vertex shader stage
-            ShaderStageCreateInfo[0].sType =
-                VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-            ShaderStageCreateInfo[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-            ShaderStageCreateInfo[0].module = VertexShader;
-            // NOTE[joe] Name of shader entry point.
-            ShaderStageCreateInfo[0].pName = "main";
-
-            // Fragment shader stage
-            ShaderStageCreateInfo[1].sType =
-                VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-            ShaderStageCreateInfo[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-            ShaderStageCreateInfo[1].module = FragShader;
-            // NOTE[joe] Name of shader entry point.
-            ShaderStageCreateInfo[1].pName = "main";
-
-            VkVertexInputBindingDescription VertexBindingDescription = {};
-            VertexBindingDescription.stride = sizeof(vertex);
-            VertexBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-            VkVertexInputAttributeDescription VertexAttributeDescription = {};
-            VertexAttributeDescription.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-
-            VkPipelineVertexInputStateCreateInfo
-                VertexInputStateCreateInfo = {};
-
-            VertexInputStateCreateInfo.sType =
-                VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-            VertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
-            VertexInputStateCreateInfo.pVertexBindingDescriptions =
-                &VertexBindingDescription;
-            VertexInputStateCreateInfo.vertexAttributeDescriptionCount = 1;
-            VertexInputStateCreateInfo.pVertexAttributeDescriptions =
-                &VertexAttributeDescription;
-
-            VkPipelineInputAssemblyStateCreateInfo
-                InputAssemblyStateCreateInfo = {};
-
-            InputAssemblyStateCreateInfo.sType =
-                VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-            InputAssemblyStateCreateInfo.topology =
-                VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-            InputAssemblyStateCreateInfo.primitiveRestartEnable = VK_FALSE;
-
-            /** Create viewport and clipping "scissors". */
-
-            VkViewport Viewport = {};
-            Viewport.width = Context.Width;
-            Viewport.height = Context.Height;
-            Viewport.maxDepth = 1;
-
-            VkRect2D Scissors = {};
-            Scissors.extent = { Context.Width, Context.Height };
-
-            VkPipelineViewportStateCreateInfo ViewportState = {};
-            ViewportState.sType =
-                VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-            ViewportState.viewportCount = 1;
-            ViewportState.pViewports = &Viewport;
-            ViewportState.scissorCount = 1;
-            ViewportState.pScissors = &Scissors;
-
-            /** Rasterization configuration. */
-
-            VkPipelineRasterizationStateCreateInfo
-                RasterizationStateCreateInfo = {};
-
-            RasterizationStateCreateInfo.sType =
-                VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-            RasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
-            RasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;
-            RasterizationStateCreateInfo.frontFace =
-                VK_FRONT_FACE_COUNTER_CLOCKWISE;
-            RasterizationStateCreateInfo.lineWidth = 1;
-
-            /** Sampling configuration. */
-            VkPipelineMultisampleStateCreateInfo MultisampleStateCreatInfo = {};
-            MultisampleStateCreatInfo.sType =
-                VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-            MultisampleStateCreatInfo.rasterizationSamples =
-                VK_SAMPLE_COUNT_1_BIT;
-
-            /** Enable depth testing and disable stenciling. */
-
-            VkStencilOpState NoOpStencilState = {};
-            NoOpStencilState.failOp = VK_STENCIL_OP_KEEP;
-            NoOpStencilState.passOp = VK_STENCIL_OP_KEEP;
-            NoOpStencilState.depthFailOp = VK_STENCIL_OP_KEEP;
-            NoOpStencilState.compareOp = VK_COMPARE_OP_ALWAYS;
-
-            VkPipelineDepthStencilStateCreateInfo DepthStateCreateInfo = {};
-            DepthStateCreateInfo.sType =
-                VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-            DepthStateCreateInfo.depthTestEnable = VK_TRUE;
-            DepthStateCreateInfo.depthWriteEnable = VK_TRUE;
-            DepthStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
-            DepthStateCreateInfo.front = NoOpStencilState;
-            DepthStateCreateInfo.back = NoOpStencilState;
-
-            /** Disable color blending. */
-
-            VkPipelineColorBlendAttachmentState ColorBlendAttachmentState = {};
-            ColorBlendAttachmentState.srcColorBlendFactor =
-                VK_BLEND_FACTOR_SRC_COLOR;
-            ColorBlendAttachmentState.dstColorBlendFactor =
-                VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR;
-            ColorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
-            ColorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
-            ColorBlendAttachmentState.colorWriteMask = 0xf;
-
-            VkPipelineColorBlendStateCreateInfo ColorBlendStateCreateInfo = {};
-            ColorBlendStateCreateInfo.sType =
-                VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-            ColorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_CLEAR;
-            ColorBlendStateCreateInfo.attachmentCount = 1;
-            ColorBlendStateCreateInfo.pAttachments = &ColorBlendAttachmentState;
-
-            /* NOTE[joe] To make pipeline state (like viewport size) dynamic:
-
-            VkDynamicState DynamicState[2] = {
-                VK_DYNAMIC_STATE_VIEWPORT,
-                VK_DYNAMIC_STATE_SCISSOR,
-            };
-
-            VkPipelineDynamicStateCreateInfo DynamicStateCreateInfo = {};
-            DynamicStateCreateInfo.sType =
-                VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-            DynamicStateCreateInfo.dynamicStateCount = 2;
-            DynamicStateCreateInfo.pDynamicStates = dynamicState;
-             */
-
-            /** Create the graphics pipeline */
-
-            VkGraphicsPipelineCreateInfo PipelineCreateInfo = {};
-            PipelineCreateInfo.sType =
-                VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-            PipelineCreateInfo.stageCount = 2;
-            PipelineCreateInfo.pStages = ShaderStageCreateInfo;
-            PipelineCreateInfo.pVertexInputState = &VertexInputStateCreateInfo;
-            PipelineCreateInfo.pInputAssemblyState =
-                &InputAssemblyStateCreateInfo;
-            PipelineCreateInfo.pViewportState = &ViewportState;
-            PipelineCreateInfo.pRasterizationState =
-                &RasterizationStateCreateInfo;
-            PipelineCreateInfo.pMultisampleState = &MultisampleStateCreatInfo;
-            PipelineCreateInfo.pDepthStencilState = &DepthStateCreateInfo;
-            PipelineCreateInfo.pColorBlendState = &ColorBlendStateCreateInfo;
-            // NOTE[joe] Uncomment for dynamically changing viewport.
-            // PipelineCreateInfo.pDynamicState = &DynamicStateCreateInfo;
-            PipelineCreateInfo.layout = Context.PipelineLayout;
-            PipelineCreateInfo.renderPass = Context.RenderPass;
-
-            Result = vkCreateGraphicsPipelines(Context.Device,
-                                               VK_NULL_HANDLE,
-                                               1,
-                                               &PipelineCreateInfo,
-                                               0,
-                                               &Context.Pipeline);
-
-            Assert(Result == VK_SUCCESS,
-                   "Failed to create graphics pipeline.");
-
-            /** END Vulkan graphics pipeline creation. */
+            win32_LoadVulkan();
+            win32_InitializeVulkanContext(&Context,
+                                          &Memory,
+                                          Instance,
+                                          Window);
+
+            // NOTE[joe] This thread is one of the workers.
+            InitializeJobSystem(&Jobs, 0);
+            InitializeIoQueue(&IO, &Jobs, &Memory.Permanent);
+
+            // NOTE[joe] --particles N sizes the particle pool, and 0 turns
+            // particles off.
+            unsigned int ParticleCount = PARTICLE_DEFAULT_COUNT;
+            wchar_t *ParticleArg = 0;
+
+            if (CommandLineArgs)
+            {
+                ParticleArg = wcsstr(CommandLineArgs, L"--particles ");
+            }
+
+            if (ParticleArg)
+            {
+                ParticleCount = (unsigned int)wcstoul(ParticleArg + 12, 0, 10);
+            }
+
+            if (ParticleCount > PARTICLE_MAX_COUNT)
+            {
+                ParticleCount = PARTICLE_MAX_COUNT;
+            }
+
+            GameInitialize(&Context,
+                           &Jobs,
+                           &IO,
+                           &Memory.Permanent,
+                           ParticleCount);
 
             ShowWindow(Window, ShowCommand);
             UpdateWindow(Window);
 
+            // NOTE[joe] --uncapped renders as fast as we can, for profiling.
+            unsigned int FrameRate = GAME_DEFAULT_FRAME_RATE;
+
+            if (CommandLineArgs && wcsstr(CommandLineArgs, L"--uncapped"))
+            {
+                FrameRate = 0;
+            }
+
+            InitializeGameLoop(&Loop,
+                               &Memory.Level,
+                               &Memory.Frame,
+                               FrameRate,
+                               ParticleCount);
+
+            // NOTE[joe] This thread keeps the window and the simulation; all
+            // Vulkan work from here on happens on the render thread.
+            StartRenderThread(&Context,
+                              &Handoff,
+                              &Jobs,
+                              &Memory.Permanent);
+
             while (!ApplicationQuit)
             {
                 MSG Message = {};
-                if (PeekMessage(&Message, 0, 0, 0, PM_REMOVE))
+                while (PeekMessage(&Message, 0, 0, 0, PM_REMOVE))
                 {
                     TranslateMessage(&Message);
                     DispatchMessage(&Message);
                 }
 
-                RedrawWindow(Window, 0, 0, RDW_INTERNALPAINT);
+                // NOTE[joe] Frame scratch only lives until the end of the frame
+                // that pushed it.
+                ResetArena(&Memory.Frame);
+
+                render_packet *Packet = BeginGamePacket(&Handoff);
+                GameAdvance(&Loop, &Jobs, Packet);
+                EndGamePacket(&Handoff);
+
+                GameWaitForNextFrame(&Loop);
             }
+
+            StopRenderThread(&Handoff);
+            ShutdownIoQueue(&IO);
+            ShutdownJobSystem(&Jobs);
+            ReleaseGameMemory(&Memory);
         }
         else
         {